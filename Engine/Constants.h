@@ -8,19 +8,29 @@
 
 #define SAFE_RELEASE(p) { if ( (p) && (p) != nullptr ) { (p)->Release(); (p) = 0; } }
 
+#ifdef _WIN32
 #define _CRTDBG_MAP_ALLOC
 #define newd new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#else
+#define newd new
+#endif
 
 #define WINDOWED    true
 #define WIREFRAME   false
 #define VSYNC		1 //1 == ON, 0 = OFF
 #define FPS_CAP		600000000 // jvla cod tntar
-#define INSTANCE_CAP 300
+#define INSTANCE_START_CAPACITY 512
+#define INSTANCE_MAX_CAPACITY 65536 // per draw, more than this is drawn in several uploads
 
 #define D3D_DEBUG_INFO
 
 #define TEXTURE_PATH(path) L"Resources/Textures/" path
 #define TEXTURE_PATH_SIMPLE "Resources/Textures/"
+#define TEXTURE_COOKED_PATH_SIMPLE "Resources/Textures/Cooked/" // Tools/TextureCooker
 #define MODEL_PATH(path)   L"Resources/Models/" path
 #define MODEL_PATH_STR(path)   "Resources/Models/" path
-#define SHADER_PATH(path) L"Resources/Shaders/" path
\ No newline at end of file
+#define SHADER_PATH(path) "Resources/Shaders/" path
+#define ASSET_ARCHIVE_PATH "Resources/Assets.pak" // Tools/AssetPacker, loose files are read if it's missing
+#define SHADER_CACHE_STORE "Resources/Shaders/ShaderCache.bin"
+#define SHADER_CACHE_PACK  "Resources/Shaders/Shaders.pack"
+#define UI_ATLAS_PATH "Resources/Data/UIAtlas.lw" // Tools/AtlasPacker, the UI images are drawn on their own if it's missing
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <Graphics\include\Structs.h>
 
 #include "Profiler.h"
+#include <Graphics\include\Resources\HotReloader.h>
 
 #include <Windows.h>
 #include <imgui.h>
@@ -64,6 +65,8 @@ Engine::Engine(HINSTANCE hInstance, int width, int height)
 	this->game.init();
 
 	this->isFullscreen = false;
+	this->renderDevice = nullptr;
+	this->mBackBuffer = nullptr;
 	this->mKeyboard = std::make_unique<DirectX::Keyboard>();
 	this->mMouse = std::make_unique<DirectX::Mouse>();
 	this->mMouse->SetWindow(window);
@@ -74,6 +77,8 @@ Engine::~Engine()
 {
 	ImGui_ImplDX11_Shutdown();
 	delete this->renderer;
+	SAFE_RELEASE(this->mBackBuffer);
+	delete this->renderDevice;
 
 	this->mDevice->Release();
 	this->mContext->Release();
@@ -182,6 +187,10 @@ HRESULT Engine::createSwapChain()
 			MessageBox(0, "RTV creation failed", "error", MB_OK);
 			return hr;
 		}
+
+		// the renderer only sees the device through this
+		this->renderDevice = new Graphics::D3D11RenderDevice(mDevice, mContext);
+		this->mBackBuffer = this->renderDevice->wrap(backBuffer);
 		backBuffer->Release();
 
 		//Creates a debug device to check for memory leaks etc
@@ -223,12 +232,12 @@ int Engine::run()
 {
 	MSG msg = { 0 };
 	this->createSwapChain();
-	Graphics::Camera cam(mDevice, mWidth, mHeight, 250);
-    cam.update({ 0,0,-15 }, { 0,0,1 }, mContext);
+	Graphics::Camera cam(renderDevice, mWidth, mHeight, 250);
+    cam.update({ 0,0,-15 }, { 0,0,1 }, renderDevice);
 
 	ImGui_ImplDX11_Init(window, mDevice, mContext);
 
-	this->renderer = new Graphics::Renderer(mDevice, mContext, mBackBufferRTV, &cam);
+	this->renderer = new Graphics::Renderer(renderDevice, mBackBuffer, &cam);
 
 	long long start = this->timer();
 	long long prev = start;
@@ -240,6 +249,9 @@ int Engine::run()
 	g_Profiler = new Profiler(mDevice, mContext);
 	g_Profiler->registerThread("Main Thread");
 
+	// edited resources are loaded again at the start of the next frame
+	Graphics::HotReloader::singleton().watch("Resources");
+
 	while (WM_QUIT != msg.message)
 	{
 		currentTime = this->timer();
@@ -285,6 +297,10 @@ int Engine::run()
 
 		g_Profiler->start();
 
+		PROFILE_BEGINC("HotReloader::update()", EventColor::Yellow);
+		Graphics::HotReloader::singleton().update();
+		PROFILE_END();
+
 		PROFILE_BEGINC("ImGui_ImplDX11_NewFrame", EventColor::PinkLight);
 		ImGui_ImplDX11_NewFrame();
 		PROFILE_END();
@@ -297,10 +313,10 @@ int Engine::run()
 		game.render(*renderer);
 		PROFILE_END();
 
-        cam.update(game.getPlayerPosition(), game.getPlayerForward(), mContext);
+        cam.update(game.getPlayerPosition(), game.getPlayerForward(), renderDevice);
 
-		//cam.update(DirectX::SimpleMath::Vector3(2, 2, -3), DirectX::SimpleMath::Vector3(-0.5f, -0.5f, 0.5f), mContext);
-        //cam.update({ 0,0,-8 -5*sin(totalTime * 0.001f) }, { 0,0,1 }, mContext);
+		//cam.update(DirectX::SimpleMath::Vector3(2, 2, -3), DirectX::SimpleMath::Vector3(-0.5f, -0.5f, 0.5f), renderDevice);
+        //cam.update({ 0,0,-8 -5*sin(totalTime * 0.001f) }, { 0,0,1 }, renderDevice);
 
         //////////////TEMP/////////////////
         Graphics::RenderInfo staticCube = {
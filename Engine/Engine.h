@@ -3,6 +3,7 @@
 #include <Windows.h>
 #include <Camera.h>
 #include <Renderer.h>
+#include <Device/D3D11RenderDevice.h>
 #include <Game.h>
 #include "Keyboard.h"
 
@@ -22,6 +23,8 @@ private:
 	HINSTANCE hInstance;
 	
 	Graphics::Renderer* renderer;
+	Graphics::D3D11RenderDevice* renderDevice;
+	Graphics::GpuTexture* mBackBuffer;
 
 	ID3D11Device* mDevice;
 	ID3D11DeviceContext* mContext;
@@ -76,7 +76,7 @@ static ImVec4 EVENT_COLORS[] =
 inline void DrawTextLine(ImDrawList *list, ImVec2 start, ImVec2 end, const char *text, const char *len);
 
 Profiler::Profiler(ID3D11Device *device, ID3D11DeviceContext *cxt)
-	: m_Session({1.f}), m_Context(cxt), m_Frame({}), m_CaptureThisFrame(false), m_ThreadCount(0)
+	: m_Session({1.f}), m_Context(cxt), m_Frame({}), m_CaptureThisFrame(false), m_ThreadCount(0), m_CounterCount(0)
 {
 	QueryPerformanceFrequency(&m_Frequency);
 
@@ -263,6 +263,26 @@ void Profiler::unregisterThread()
 	m_ThreadLocalMutex.unlock();
 }
 
+void Profiler::counter(const char * name, double value)
+{
+	m_CounterMutex.lock();
+
+	int i = 0;
+	while (i < m_CounterCount && strncmp(m_Counters[i].name, name, 31) != 0)
+		i++;
+
+	// silently drop new counters when full, it's only debug data
+	if (i == m_CounterCount && m_CounterCount < PROFILER_MAX_COUNTERS) {
+		strncpy_s(m_Counters[i].name, name, 31);
+		m_CounterCount++;
+	}
+
+	if (i < m_CounterCount)
+		m_Counters[i].value = value;
+
+	m_CounterMutex.unlock();
+}
+
 void Profiler::capture()
 {
 	m_CaptureThisFrame = true;
@@ -427,6 +447,29 @@ void Profiler::render()
 	drawList->PopClipRect();
 
 	ImGui::End();
+
+	RenderCounters();
+}
+
+void Profiler::RenderCounters()
+{
+	if (m_CounterCount == 0) return;
+
+	ImGui::SetNextWindowPos(ImVec2(0, 250), ImGuiCond_FirstUseEver);
+	ImGui::Begin("Counters");
+
+	m_CounterMutex.lock();
+	ImGui::Columns(2, "counters", false);
+	for (int i = 0; i < m_CounterCount; i++) {
+		ImGui::Text("%s", m_Counters[i].name);
+		ImGui::NextColumn();
+		ImGui::Text("%.0f", m_Counters[i].value);
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+	m_CounterMutex.unlock();
+
+	ImGui::End();
 }
 
 void Profiler::RenderEventNodes(Thread thread, LARGE_INTEGER base, int idx, int depth, bool children)
@@ -21,6 +21,7 @@
 #define PROFILER_MAX_THREAD_MARKERS 64
 #define PROFILER_MAX_GPU_QUERIES 32
 #define PROFILER_MAX_THREADS 8
+#define PROFILER_MAX_COUNTERS 64
 
 // we use pre-processor macros to invoke the profiler, because it's much
 // simpler to replace a macro with an empty body compared to if-deffing out a
@@ -29,6 +30,10 @@
 #define PROFILE_BEGIN(msg) g_Profiler->begin(msg);
 #define PROFILE_END() g_Profiler->end();
 
+// counters are plain named values that survive between captures, use them for
+// per-frame statistics (counts, bytes, hits) that a timeline can't show
+#define PROFILE_COUNTER(name, value) g_Profiler->counter(name, (double)(value));
+
 
 enum class EventColor {
 	Inherit = 0,
@@ -75,6 +80,11 @@ struct Thread {
 	Marker markers[PROFILER_MAX_THREAD_MARKERS];
 };
 
+struct Counter {
+	char name[32];
+	double value;
+};
+
 struct Frame {
 	Thread m_Threads[PROFILER_MAX_THREADS];
 
@@ -114,6 +124,8 @@ public:
 	void registerThread(const char *fmt, ...);
 	void unregisterThread();
 
+	void counter(const char *name, double value);
+
 	void capture();
 
 	void poll();
@@ -124,6 +136,7 @@ public:
 	size_t getVRAM() const { return m_VRAM; }
 private:
 	void RenderEventNodes(Thread thread, LARGE_INTEGER base, int idx, int depth, bool children);
+	void RenderCounters();
 
 	float ToMilliseconds(LARGE_INTEGER time) const {
 		double ms = double(time.QuadPart) / double(m_Frequency.QuadPart);
@@ -143,6 +156,10 @@ private:
 	std::mutex m_ThreadLocalMutex;
 	std::vector<ProfilingThread*> m_ThreadLocalProfilers;
 
+	std::mutex m_CounterMutex;
+	Counter m_Counters[PROFILER_MAX_COUNTERS];
+	int m_CounterCount;
+
 
 	struct TempRenderData {
 		ImVec2 outerCursor;
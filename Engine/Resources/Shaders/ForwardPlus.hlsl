@@ -1,16 +1,21 @@
 /*
 *  Author: fkaa
 *
+*  CLUSTERED: lights come from a 3D grid of screen tiles and exponential
+*             depth slices (ClusteredLightGrid) instead of 2D tiles
 */
 
-#define BLOCK_SIZE 16.f
+#include "Vertex.hlsl"
+
 #define NUM_LIGHTS 8
+#define SHADOW_CASCADES 4           // SkyRenderer.h has the same
+#define SHADOW_MAP_RESOLUTION 1024
 
 cbuffer Camera : register(b0)
 {
 	float4x4 ViewProjection;
 	float4x4 InvProjection;
-    float4x4 dummy;
+    float4x4 View;
     float4 camPos;
 }
 
@@ -21,9 +26,10 @@ cbuffer LightBuffer : register(b1)
     float dirFade;
 }
 
-cbuffer LightMatBuffer : register(b2)
+cbuffer ShadowCascades : register(b2)
 {
-    float4x4 lightVP;
+    float4x4 lightVP[SHADOW_CASCADES];
+    float4 normalOffsets;   // world units, one for each cascade
 }
 
 struct InstanceData
@@ -31,9 +37,12 @@ struct InstanceData
     float4x4 world;
 };
 StructuredBuffer<InstanceData> instanceData : register(t20);
-cbuffer InstanceOffsetBuffer : register(b3)
+// Renderer::BatchData
+cbuffer BatchBuffer : register(b3)
 {
     uint instanceOffset;
+    float3 boundsMin;       // of the mesh, the compressed positions are within it
+    float3 boundsExtent;
 }
 
 struct Light 
@@ -45,19 +54,9 @@ struct Light
 	float intensity;
 };
 
-struct VSInput
-{
-	float3 position : POSITION;
-	float3 normal : NORMAL;
-	float2 uv : UV;
-	float2 biTangent : BITANGENT;
-	float2 tangent : TANGENT;
-};
-
 struct VSOutput {
 	float4 pos : SV_POSITION;
 	float4 worldPos : POS;
-    float4 lightPos : LIGHT_POS;
 	float3 normal : NORMAL;
 	float2 uv : UV;
     float3 biTangent : BITANGENT;
@@ -70,40 +69,45 @@ struct PSOutput
     float4 glowMap : SV_Target1;
 };
 
-VSOutput VS(VSInput input, uint instanceId : SV_InstanceId) {
+VSOutput VS(CompressedVertex input, uint instanceId : SV_InstanceId) {
 	VSOutput output;
 
     float4x4 world = instanceData[instanceOffset + instanceId].world;
 
-	output.worldPos = mul(world, float4(input.position, 1));
+	output.worldPos = mul(world, float4(decodePosition(input.position, boundsMin, boundsExtent), 1));
     output.pos = mul(ViewProjection, output.worldPos);
 
 	output.uv = input.uv;
-    output.normal = mul(world, float4(input.normal, 0));
+    output.normal = mul(world, float4(decodeOctahedral(input.normal), 0));
     output.normal = normalize(output.normal);
 
-    output.lightPos = output.worldPos + float4(output.normal * 0.15f, 0);
-    output.lightPos = mul(lightVP, output.lightPos);
-
-    output.tangent.xy = input.tangent.xy;
-    output.biTangent.xy = input.biTangent.xy;
-
-
-    output.tangent.z = sqrt(1 - pow(output.tangent.x, 2) + pow(output.tangent.y, 2));
-    output.biTangent.z = sqrt(1 - pow(output.biTangent.x, 2) + pow(output.biTangent.y, 2));
-
-
-    output.biTangent = normalize(mul(world, output.biTangent));
-    output.tangent = normalize(mul(world, output.tangent));
+    output.biTangent = normalize(mul(world, float4(decodeOctahedral(input.biTangent), 0)));
+    output.tangent = normalize(mul(world, float4(decodeOctahedral(input.tangent), 0)));
 
 	return output;
 }
 
 StructuredBuffer<uint> LightIndexList : register(t0);
+#ifdef CLUSTERED
+// LightClusters::Params
+cbuffer ClusterParams : register(b4)
+{
+    uint4 clusterDims;      // tiles x, tiles y, slices, tile size in pixels
+    float4 clusterDepth;    // near, far, slice scale, slice bias
+}
+StructuredBuffer<uint2> LightGrid : register(t1);
+#else
+// DispatchParams of LightGrid, the tile size follows the grid
+cbuffer DispatchParams : register(b4)
+{
+    uint4 numThreadGroups;
+    uint4 numThreads;
+}
 Texture2D<uint2> LightGrid : register(t1);
+#endif
 StructuredBuffer<Light> Lights : register(t2);
 
-Texture2D shadowMap : register(t3);
+Texture2DArray shadowMap : register(t3);
 SamplerState Sampler : register(s0);
 
 SamplerComparisonState cmpSampler : register(s1);
@@ -114,37 +118,58 @@ Texture2D specularMap : register(t12);
 Texture2D glowMap : register(t13);
 
 //Returns the shadow amount of a given position
-float getShadowValue(float4 lightPos, int sampleCount = 1)
+float getShadowValue(float4 worldPos, float3 normal, int sampleCount = 1)
 {
-    lightPos.x = (lightPos.x * 0.5f) + 0.5f;
-    lightPos.y = (lightPos.y * -0.5f) + 0.5f;
-
-    float addedShadow = 0;
+    //The first cascade where all the samples fit, the cascades get bigger further away
+    float margin = (sampleCount + 1) * 2.f / SHADOW_MAP_RESOLUTION;
 
-    for (int y = -sampleCount; y <= sampleCount; y += 1)
+    for (uint i = 0; i < SHADOW_CASCADES; i++)
     {
-        for (int x = -sampleCount; x <= sampleCount; x += 1)
+        float4 lightPos = mul(lightVP[i], worldPos + float4(normal * normalOffsets[i], 0));
+        if (any(abs(lightPos.xy) > 1 - margin) || lightPos.z > 1)
+            continue;
+
+        lightPos.x = (lightPos.x * 0.5f) + 0.5f;
+        lightPos.y = (lightPos.y * -0.5f) + 0.5f;
+
+        float addedShadow = 0;
+
+        for (int y = -sampleCount; y <= sampleCount; y += 1)
         {
-            addedShadow += shadowMap.SampleCmp(cmpSampler, lightPos.xy, lightPos.z, int2(x, y)).r;
+            for (int x = -sampleCount; x <= sampleCount; x += 1)
+            {
+                addedShadow += shadowMap.SampleCmpLevelZero(cmpSampler, float3(lightPos.xy, i), lightPos.z, int2(x, y)).r;
+            }
         }
-    }
 
-    float shadow = addedShadow / pow(sampleCount * 2 + 1, 2);
+        return addedShadow / pow(sampleCount * 2 + 1, 2);
+    }
 
-    return shadow;
+    //Further away than the last cascade
+    return 1;
 }
 
 [earlydepthstencil]
 PSOutput PS(VSOutput input) {
 	PSOutput output;
 
-	uint2 tile = uint2(floor(input.pos.xy / BLOCK_SIZE));
-	uint offset = LightGrid[tile].x;
-	uint count = LightGrid[tile].y;
+#ifdef CLUSTERED
+    float viewDepth = -mul(View, input.worldPos).z;
+    uint slice = (uint)clamp(floor(log(viewDepth) * clusterDepth.z + clusterDepth.w), 0, clusterDims.z - 1);
+    uint2 tile = min(uint2(input.pos.xy / clusterDims.w), clusterDims.xy - 1);
+    uint2 range = LightGrid[tile.x + (tile.y + slice * clusterDims.y) * clusterDims.x];
+#else
+	uint2 tile = uint2(floor(input.pos.xy / (numThreads.x / numThreadGroups.x)));
+	uint2 range = LightGrid[tile];
+#endif
+	uint offset = range.x;
+	uint count = range.y;
 
     float3 colorSample = diffuseMap.Sample(Sampler, input.uv);
     float3 specularSample = specularMap.Sample(Sampler, input.uv);
-    float3 normalSample = normalMap.Sample(Sampler, input.uv);
+    // z from x and y, BC5 normal maps from the texture cooker only have those two
+    float2 normalXY = normalMap.Sample(Sampler, input.uv).xy * 2.0 - 1;
+    float3 normalSample = float3(normalXY, sqrt(saturate(1 - dot(normalXY, normalXY)))) * 0.5 + 0.5;
 
     /////////////////NORMAL MAPPING
     //To make sure the tangent is perpendicular
@@ -169,7 +194,7 @@ PSOutput PS(VSOutput input) {
     float3 directionalSpecularity = pow(saturate(dot(finalNormal, reflectThingDir)), 500) * dirLightColor;
 
     
-    float shadow = getShadowValue(input.lightPos, 2);
+    float shadow = getShadowValue(input.worldPos, normalize(input.normal), 2);
 
     directionalDiffuse *= dirFade * shadow;
     directionalSpecularity *= dirFade * shadow;
@@ -33,9 +33,16 @@
  *    - add option to disable debug texture parts to save memory in release
  */
 
+// LightGrid compiles these with the back buffer size and tile size
+#ifndef BLOCK_SIZE
 #define BLOCK_SIZE 16
+#endif
+#ifndef WIDTH
 #define WIDTH 1280
+#endif
+#ifndef HEIGHT
 #define HEIGHT 720
+#endif
 
 #define NUM_LIGHTS 8
 
@@ -11,9 +11,16 @@
  */
 
 
+// LightGrid compiles these with the back buffer size and tile size
+#ifndef BLOCK_SIZE
 #define BLOCK_SIZE 16
+#endif
+#ifndef WIDTH
 #define WIDTH 1280
+#endif
+#ifndef HEIGHT
 #define HEIGHT 720
+#endif
 
 cbuffer Camera : register(b0)
 {
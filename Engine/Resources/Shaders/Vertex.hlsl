@@ -5,4 +5,28 @@ struct Vertex
     float2 uv : UV;
     float2 biTangent : BITANGENT;
     float2 tangent : TANGENT;
-};
\ No newline at end of file
+};
+
+// VertexCompression.h, what is in the vertex buffers
+struct CompressedVertex
+{
+    float4 position : POSITION;     // 0 to 1 within the mesh bounds
+    float2 normal : NORMAL;         // octahedral
+    float2 uv : UV;
+    float2 biTangent : BITANGENT;   // octahedral
+    float2 tangent : TANGENT;       // octahedral
+};
+
+float3 decodePosition(float4 position, float3 boundsMin, float3 boundsExtent)
+{
+    return boundsMin + position.xyz * boundsExtent;
+}
+
+// a unit vector from a point on the octahedron folded flat
+float3 decodeOctahedral(float2 encoded)
+{
+    float3 direction = float3(encoded, 1 - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-direction.z);
+    direction.xy += direction.xy >= 0 ? -t : t;
+    return normalize(direction);
+}
\ No newline at end of file
@@ -5,12 +5,23 @@
 #include <Game.h>
 #include "Constants.h"
 #include <Resources\ResourceManager.h>
+#include <Resources\Shader.h>
+#include <Device\D3D11RenderDevice.h>
+#include <Resources\VirtualFileSystem.h>
+#include <string.h>
 
 // int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow)
 int main(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow)
 {
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 
+    // everything packed by Tools/AssetPacker, without it the resources are read loose
+    Graphics::VirtualFileSystem::singleton().mount(ASSET_ARCHIVE_PATH);
+
+    // build step: everything in the shader cache store into the pack, no window
+    if (__argc > 1 && strcmp(__argv[1], "-precompileshaders") == 0)
+        return Graphics::precompileShaders(Graphics::D3D11RenderDevice::shaderCompiler()) ? 0 : 1;
+
     Logic::Game gameTest();
 	
 	Engine engine(hInstance, WIN_WIDTH, WIN_HEIGHT);
@@ -1,12 +1,12 @@
 #pragma once
-#include <d3d11.h>
+#include "../Device/RenderDevice.h"
 #include "AnimatedVertex.h"
 #include "Skeleton.h"
 #include "Animation.h"
 
 struct  AnimatedTestCube
 {
-    AnimatedTestCube(ID3D11Device * device)
+    AnimatedTestCube(Graphics::RenderDevice * device)
     {
         AnimatedVertex vertices[] =
         {
@@ -55,15 +55,12 @@ struct  AnimatedTestCube
 
         };
 
-        D3D11_SUBRESOURCE_DATA subData = {};
-        subData.pSysMem = vertices;
+        Graphics::BufferDesc desc = {};
+        desc.byteWidth = sizeof(vertices);
+        desc.usage = Graphics::USAGE_IMMUTABLE;
+        desc.bindFlags = Graphics::BIND_VERTEX_BUFFER;
 
-        D3D11_BUFFER_DESC desc = { 0 };
-        desc.ByteWidth = sizeof(vertices);
-        desc.Usage = D3D11_USAGE_IMMUTABLE;
-        desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-
-        device->CreateBuffer(&desc, &subData, &vertexBuffer);
+        vertexBuffer = device->CreateBuffer(desc, vertices);
 
         offset = 0;
         stride = sizeof(AnimatedVertex);
@@ -79,9 +76,9 @@ struct  AnimatedTestCube
     UINT stride;
     UINT vertexCount;
 
-    ID3D11Buffer * vertexBuffer;
-    inline operator ID3D11Buffer*() { return vertexBuffer; }
-    inline operator ID3D11Buffer**() { return &vertexBuffer; }
+    Graphics::GpuBuffer * vertexBuffer;
+    inline operator Graphics::GpuBuffer*() { return vertexBuffer; }
+    inline operator Graphics::GpuBuffer**() { return &vertexBuffer; }
 };
 
 static Skeleton testSkeleton = []() {
@@ -1,12 +1,12 @@
 #pragma once
-#include <d3d11.h>
 #include <SimpleMath.h>
+#include "../Device/RenderDevice.h"
 
 #define ANIMATED_VERTEX_DESC { \
-    { "POSITION",   0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },  \
-    { "NORMAL",     0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },  \
-    { "JOINTIDS",   0, DXGI_FORMAT_R32G32B32A32_UINT,  0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },  \
-    { "WEIGHTS",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }   \
+    { "POSITION",   0, Graphics::FORMAT_R32G32B32_FLOAT,     0, Graphics::InputElement::APPEND_ALIGNED },  \
+    { "NORMAL",     0, Graphics::FORMAT_R32G32B32_FLOAT,     0, Graphics::InputElement::APPEND_ALIGNED },  \
+    { "JOINTIDS",   0, Graphics::FORMAT_R32G32B32A32_UINT,   0, Graphics::InputElement::APPEND_ALIGNED },  \
+    { "WEIGHTS",    0, Graphics::FORMAT_R32G32B32A32_FLOAT,  0, Graphics::InputElement::APPEND_ALIGNED }   \
 }
 
 using namespace DirectX::SimpleMath;
@@ -1,28 +1,26 @@
-#include <Graphics\include\Camera.h>
+#include <Graphics/include/Camera.h>
+#include <string.h>
 using namespace DirectX::SimpleMath;
 using namespace Graphics;
 
-Camera::Camera(ID3D11Device* device, int width, int height, float drawDistance, float fieldOfView)
+Camera::Camera(RenderDevice* device, int width, int height, float drawDistance, float fieldOfView)
 {
 	this->mFieldOfView = fieldOfView;
 	this->mDrawDistance = drawDistance;
 
-	this->mProjection = DirectX::XMMatrixPerspectiveFovRH(fieldOfView, float(width) / height, 0.1f, drawDistance);
+	this->mProjection = Matrix::CreatePerspectiveFieldOfView(fieldOfView, float(width) / height, 0.1f, drawDistance);
 
 	values.mVP = this->mProjection * this->mView;
 	values.mV = this->mView;
 	values.mInvP = this->mProjection.Invert();
 
-	D3D11_BUFFER_DESC desc = {};
-	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	desc.ByteWidth = sizeof(ShaderValues);
-	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	desc.Usage = D3D11_USAGE_DYNAMIC;
+	BufferDesc desc = {};
+	desc.bindFlags = BIND_CONSTANT_BUFFER;
+	desc.byteWidth = sizeof(ShaderValues);
+	desc.cpuAccessFlags = CPU_ACCESS_WRITE;
+	desc.usage = USAGE_DYNAMIC;
 
-	D3D11_SUBRESOURCE_DATA data = {};
-	data.pSysMem = &values;
-
-	device->CreateBuffer(&desc, &data, &this->mVPBuffer);
+	this->mVPBuffer = device->CreateBuffer(desc, &values);
 }
 
 Camera::~Camera()
@@ -80,21 +78,15 @@ DirectX::SimpleMath::Matrix Graphics::Camera::getProj() const
 	return mProjection;
 }
 
-ID3D11Buffer* Graphics::Camera::getBuffer()
+GpuBuffer* Graphics::Camera::getBuffer()
 {
 	return this->mVPBuffer;
 }
 
-#include <Mouse.h>
-
-void Graphics::Camera::update(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleMath::Vector3 forward, ID3D11DeviceContext* context)
+void Graphics::Camera::update(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleMath::Vector3 forward, RenderDevice* context)
 {
 	forward.Normalize();
-	auto &m = DirectX::Mouse::Get();
-	//pos.x = cosf(m.GetState().x*0.01f)*M_PI;
-	//pos.y = cosf(m.GetState().y*0.025f)*M_PI;
-	//pos.z = sinf(m.GetState().x*0.01f)*M_PI;
-	Matrix newView = DirectX::XMMatrixLookToRH(pos, forward, Vector3(0, 1, 0));
+	Matrix newView = Matrix::CreateLookAt(pos, pos + forward, Vector3(0, 1, 0));
 
 	//if (newView != this->mView)
 	{
@@ -106,20 +98,14 @@ void Graphics::Camera::update(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleM
 		values.mV = this->mView;
 		values.camPos = Vector4(pos.x, pos.y, pos.z, 1);
 
-		D3D11_MAPPED_SUBRESOURCE data;
-		ZeroMemory(&data, sizeof(data));
-
-		context->Map(this->mVPBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &data);
-
-		memcpy(data.pData, &values, sizeof(ShaderValues));
-
-		context->Unmap(this->mVPBuffer, 0);
+		memcpy(context->Map(this->mVPBuffer, sizeof(ShaderValues)), &values, sizeof(ShaderValues));
+		context->Unmap(this->mVPBuffer);
 	}
 }
 
-void Graphics::Camera::updateLookAt(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleMath::Vector3 target, ID3D11DeviceContext * context)
+void Graphics::Camera::updateLookAt(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleMath::Vector3 target, RenderDevice * context)
 {
-    Matrix newView = DirectX::XMMatrixLookAtRH(pos, target, Vector3(0, 1, 0));
+    Matrix newView = Matrix::CreateLookAt(pos, target, Vector3(0, 1, 0));
 
     //if (newView != this->mView)
     {
@@ -131,13 +117,7 @@ void Graphics::Camera::updateLookAt(DirectX::SimpleMath::Vector3 pos, DirectX::S
         values.mV = this->mView;
         values.camPos = Vector4(pos.x, pos.y, pos.z, 1);
 
-        D3D11_MAPPED_SUBRESOURCE data;
-        ZeroMemory(&data, sizeof(data));
-
-        context->Map(this->mVPBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &data);
-
-        memcpy(data.pData, &values, sizeof(ShaderValues));
-
-        context->Unmap(this->mVPBuffer, 0);
+        memcpy(context->Map(this->mVPBuffer, sizeof(ShaderValues)), &values, sizeof(ShaderValues));
+        context->Unmap(this->mVPBuffer);
     }
 }
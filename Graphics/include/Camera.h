@@ -4,19 +4,14 @@
 #include <math.h>
 
 
-#include <d3d11.h>
-#include <d3dcompiler.h>
-
-#pragma comment (lib, "d3d11.lib")
-#pragma comment (lib, "d3dcompiler.lib")
-
 #include <SimpleMath.h>
+#include "Device/RenderDevice.h"
 
 namespace Graphics {
 	class Camera
 	{
 	public:
-		Camera(ID3D11Device* device, int width, int height, float drawDistance = 100, float fieldOfView = M_PI * 0.45);
+		Camera(RenderDevice* device, int width, int height, float drawDistance = 100, float fieldOfView = float(M_PI * 0.45));
 		~Camera();
 
 		void setPos(DirectX::SimpleMath::Vector3 pos);
@@ -30,10 +25,10 @@ namespace Graphics {
 		DirectX::SimpleMath::Vector3 getRight() const;
 		DirectX::SimpleMath::Matrix getView() const;
 		DirectX::SimpleMath::Matrix getProj() const;
-		ID3D11Buffer* getBuffer();
+		GpuBuffer* getBuffer();
 
-		void update(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleMath::Vector3 forward, ID3D11DeviceContext* context);
-        void updateLookAt(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleMath::Vector3 target, ID3D11DeviceContext* context);
+		void update(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleMath::Vector3 forward, RenderDevice* context);
+        void updateLookAt(DirectX::SimpleMath::Vector3 pos, DirectX::SimpleMath::Vector3 target, RenderDevice* context);
 	private:
 		DirectX::SimpleMath::Vector3 mPos;
 		DirectX::SimpleMath::Vector3 mForward;
@@ -54,7 +49,7 @@ namespace Graphics {
 			DirectX::SimpleMath::Vector4 camPos;
 		} values;
 
-		ID3D11Buffer* mVPBuffer;
+		GpuBuffer* mVPBuffer;
 
 	};
 }
\ No newline at end of file
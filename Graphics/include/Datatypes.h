@@ -1,16 +1,26 @@
 #pragma once
 
-#include <d3d11.h>
 #include <SimpleMath.h>
+#include <string>
+#include "Device/RenderDevice.h"
 
 using namespace std;
 
 #define VERTEX_DESC { \
-    { "POSITION",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },  \
-    { "NORMAL",     0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },  \
-    { "UV",         0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },     \
-    { "BITANGENT",  0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },     \
-    { "TANGENT",    0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }      \
+    { "POSITION",   0, Graphics::FORMAT_R32G32B32_FLOAT, 0, Graphics::InputElement::APPEND_ALIGNED },  \
+    { "NORMAL",     0, Graphics::FORMAT_R32G32B32_FLOAT, 0, Graphics::InputElement::APPEND_ALIGNED },  \
+    { "UV",         0, Graphics::FORMAT_R32G32_FLOAT, 0, Graphics::InputElement::APPEND_ALIGNED },     \
+    { "BITANGENT",  0, Graphics::FORMAT_R32G32_FLOAT, 0, Graphics::InputElement::APPEND_ALIGNED },     \
+    { "TANGENT",    0, Graphics::FORMAT_R32G32_FLOAT, 0, Graphics::InputElement::APPEND_ALIGNED }      \
+}
+
+// Graphics::CompressedVertex (Resources/VertexCompression.h), matches the CompressedVertex in Vertex.hlsl
+#define COMPRESSED_VERTEX_DESC { \
+    { "POSITION",   0, Graphics::FORMAT_R16G16B16A16_UNORM, 0, Graphics::InputElement::APPEND_ALIGNED }, \
+    { "NORMAL",     0, Graphics::FORMAT_R16G16_SNORM, 0, Graphics::InputElement::APPEND_ALIGNED },       \
+    { "UV",         0, Graphics::FORMAT_R16G16_FLOAT, 0, Graphics::InputElement::APPEND_ALIGNED },       \
+    { "BITANGENT",  0, Graphics::FORMAT_R16G16_SNORM, 0, Graphics::InputElement::APPEND_ALIGNED },       \
+    { "TANGENT",    0, Graphics::FORMAT_R16G16_SNORM, 0, Graphics::InputElement::APPEND_ALIGNED }        \
 }
 
 struct Float2
@@ -169,7 +179,7 @@ struct Vertex
 
 struct FrameData
 {
-	FrameData() { ZeroMemory(this, sizeof(this)); };
+	FrameData() : frameID(0), time(0) {};
 	FrameData(unsigned int ID, float time)
 	{
 		this->frameID = ID;
@@ -240,11 +250,11 @@ struct Material
 	Float3 diffuseValue;
 	Float3 specularValue;
 
-	//if the id is -1, the material doesn't have a texture
-	int diffuse_ID;
-	int normal_ID;
-	int specular_ID;
-	int glow_ID;
+	//texture handles from the TextureManager, 0 if the material doesn't have a texture
+	unsigned int diffuse_ID;
+	unsigned int normal_ID;
+	unsigned int specular_ID;
+	unsigned int glow_ID;
 };
 struct importedMaterial
 {
@@ -266,8 +276,8 @@ struct NodeType
 	unsigned int materialID;
 	bool isAnimated;
 	unsigned int triangleCount;
-	ID3D11Buffer *vertexBuffer;
-	ID3D11Buffer *indexBuffer;
+	Graphics::GpuBuffer *vertexBuffer;
+	Graphics::GpuBuffer *indexBuffer;
 	UINT VertexCount;
 	UINT IndexCount;
 	NodeType* nodes[4];
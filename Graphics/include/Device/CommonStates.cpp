@@ -0,0 +1,51 @@
+#include "CommonStates.h"
+
+namespace Graphics
+{
+    namespace
+    {
+        SamplerState * createSampler(RenderDevice * device, Filter filter, AddressMode address)
+        {
+            SamplerDesc desc = {};
+            desc.filter = filter;
+            desc.address = address;
+            desc.comparison = COMPARISON_NEVER;
+            desc.maxAnisotropy = 16;
+            return device->CreateSamplerState(desc);
+        }
+    }
+
+    CommonStates::CommonStates(RenderDevice * device)
+    {
+        RasterizerDesc rasterizer = {};
+        rasterizer.depthClip = true;
+        rasterizer.cull = CULL_NONE;
+        cullNone = device->CreateRasterizerState(rasterizer);
+        rasterizer.cull = CULL_BACK;
+        cullCounterClockwise = device->CreateRasterizerState(rasterizer);
+
+        DepthStencilDesc depth = {};
+        depth.depthEnable = true;
+        depth.depthWrite = true;
+        depth.depthFunc = COMPARISON_LESS_EQUAL;
+        depthDefault = device->CreateDepthStencilState(depth);
+        depth.depthEnable = false;
+        depth.depthWrite = false;
+        depthNone = device->CreateDepthStencilState(depth);
+
+        pointClamp = createSampler(device, FILTER_MIN_MAG_MIP_POINT, ADDRESS_CLAMP);
+        linearClamp = createSampler(device, FILTER_MIN_MAG_MIP_LINEAR, ADDRESS_CLAMP);
+        linearWrap = createSampler(device, FILTER_MIN_MAG_MIP_LINEAR, ADDRESS_WRAP);
+    }
+
+    CommonStates::~CommonStates()
+    {
+        cullNone->Release();
+        cullCounterClockwise->Release();
+        depthDefault->Release();
+        depthNone->Release();
+        pointClamp->Release();
+        linearClamp->Release();
+        linearWrap->Release();
+    }
+}
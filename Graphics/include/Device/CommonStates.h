@@ -0,0 +1,41 @@
+#pragma once
+#include "RenderDevice.h"
+
+namespace Graphics
+{
+    /*
+        The states everything shares, like DirectXTK's CommonStates but
+        created through a RenderDevice. Cull counter clockwise culls the
+        back faces.
+
+        HOW TO USE:
+            CommonStates states(device);
+            device->RSSetState(states.CullCounterClockwise());
+            SamplerState * sampler = states.LinearClamp();
+            device->PSSetSamplers(0, 1, &sampler);
+    */
+    class CommonStates
+    {
+    public:
+        CommonStates(RenderDevice * device);
+        ~CommonStates();
+
+        RasterizerState * CullNone() const { return cullNone; }
+        RasterizerState * CullCounterClockwise() const { return cullCounterClockwise; }
+
+        DepthStencilState * DepthDefault() const { return depthDefault; }
+        DepthStencilState * DepthNone() const { return depthNone; }
+
+        SamplerState * PointClamp() const { return pointClamp; }
+        SamplerState * LinearClamp() const { return linearClamp; }
+        SamplerState * LinearWrap() const { return linearWrap; }
+    private:
+        RasterizerState * cullNone;
+        RasterizerState * cullCounterClockwise;
+        DepthStencilState * depthDefault;
+        DepthStencilState * depthNone;
+        SamplerState * pointClamp;
+        SamplerState * linearClamp;
+        SamplerState * linearWrap;
+    };
+}
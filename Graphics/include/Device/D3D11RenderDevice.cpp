@@ -0,0 +1,684 @@
+#include "D3D11RenderDevice.h"
+#include "../ThrowIfFailed.h"
+#include "../Resources/ShaderCache.h"
+#include "../Resources/VirtualFileSystem.h"
+#include <d3dcompiler.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef DEBUG
+#define SHADER_COMPILE_FLAGS D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION
+#else
+#define SHADER_COMPILE_FLAGS 0
+#endif
+
+namespace Graphics
+{
+    namespace
+    {
+        // what the handles are on this device, Release() lets go of the D3D11 object
+        template<typename Handle, typename Object>
+        class D3DObject : public Handle
+        {
+        public:
+            D3DObject(Object * object) : object(object) {}
+
+            virtual void Release()
+            {
+                object->Release();
+                delete this;
+            }
+
+            Object * object;
+        };
+
+        typedef D3DObject<GpuBuffer, ID3D11Buffer> D3DBuffer;
+        typedef D3DObject<GpuTexture, ID3D11Texture2D> D3DTexture;
+        typedef D3DObject<ShaderResourceView, ID3D11ShaderResourceView> D3DShaderResourceView;
+        typedef D3DObject<UnorderedAccessView, ID3D11UnorderedAccessView> D3DUnorderedAccessView;
+        typedef D3DObject<RenderTargetView, ID3D11RenderTargetView> D3DRenderTargetView;
+        typedef D3DObject<DepthStencilView, ID3D11DepthStencilView> D3DDepthStencilView;
+        typedef D3DObject<InputLayout, ID3D11InputLayout> D3DInputLayout;
+        typedef D3DObject<GpuVertexShader, ID3D11VertexShader> D3DVertexShader;
+        typedef D3DObject<GpuPixelShader, ID3D11PixelShader> D3DPixelShader;
+        typedef D3DObject<GpuComputeShader, ID3D11ComputeShader> D3DComputeShader;
+        typedef D3DObject<SamplerState, ID3D11SamplerState> D3DSamplerState;
+        typedef D3DObject<RasterizerState, ID3D11RasterizerState> D3DRasterizerState;
+        typedef D3DObject<DepthStencilState, ID3D11DepthStencilState> D3DDepthStencilState;
+        typedef D3DObject<BlendState, ID3D11BlendState> D3DBlendState;
+
+        template<typename Object, typename Handle>
+        Object * unwrap(Handle * handle)
+        {
+            return handle ? static_cast<D3DObject<Handle, Object>*>(handle)->object : nullptr;
+        }
+
+        ID3D11Resource * unwrapResource(GpuResource * resource)
+        {
+            if (!resource)
+                return nullptr;
+            if (D3DBuffer * buffer = dynamic_cast<D3DBuffer*>(resource))
+                return buffer->object;
+            return static_cast<D3DTexture*>(resource)->object;
+        }
+
+        // the D3D11 objects of an array of handles, on the stack
+        template<typename Object, typename Handle, size_t N>
+        Object * const * unwrapAll(Object * (&objects)[N], Handle * const * handles, UINT count)
+        {
+            if (!handles)
+                return nullptr;
+            for (UINT i = 0; i < count && i < N; i++)
+                objects[i] = unwrap<Object>(handles[i]);
+            return objects;
+        }
+
+        std::string directoryOf(std::string const & path)
+        {
+            size_t slash = path.find_last_of("/\\");
+            return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+        }
+
+        // #include "..." through the VirtualFileSystem, relative to the including
+        // file like D3D_COMPILE_STANDARD_FILE_INCLUDE
+        class VirtualFileInclude : public ID3DInclude
+        {
+        public:
+            VirtualFileInclude(std::string const & path)
+            {
+                rootDirectory = directoryOf(path);
+            }
+
+            HRESULT __stdcall Open(D3D_INCLUDE_TYPE type, LPCSTR fileName, LPCVOID parentData, LPCVOID * data, UINT * bytes) override
+            {
+                // the parent is one we opened, or the shader itself
+                auto parent = opened.find(parentData);
+                std::string path = (parent != opened.end() ? parent->second.directory : rootDirectory) + fileName;
+
+                std::unique_ptr<std::string> text(new std::string);
+                if (!VirtualFileSystem::singleton().read(path, *text))
+                    return E_FAIL;
+
+                *data = text->data();
+                *bytes = (UINT)text->size();
+                opened[*data] = { std::move(text), directoryOf(path) };
+                return S_OK;
+            }
+
+            HRESULT __stdcall Close(LPCVOID data) override
+            {
+                opened.erase(data);
+                return S_OK;
+            }
+        private:
+            struct OpenFile
+            {
+                std::unique_ptr<std::string> text;
+                std::string directory;
+            };
+
+            std::string rootDirectory;
+            std::map<LPCVOID, OpenFile> opened;
+        };
+
+        class D3DShaderCompiler : public ShaderCompiler
+        {
+        public:
+            bool compile(ShaderPermutation const & permutation, std::vector<char> & bytecode, std::string & errors) override
+            {
+                std::string source;
+                if (!VirtualFileSystem::singleton().read(permutation.path, source))
+                {
+                    errors = permutation.path + " can't be read";
+                    return false;
+                }
+
+                std::vector<D3D_SHADER_MACRO> defines;
+                for (auto const & define : permutation.defines)
+                    defines.push_back({ define.first.c_str(), define.second.c_str() });
+                defines.push_back({ nullptr, nullptr });
+
+                VirtualFileInclude include(permutation.path);
+                ID3DBlob *shader = nullptr, *errorMsg = nullptr;
+                HRESULT hr = D3DCompile(source.data(), source.size(), permutation.path.c_str(), defines.data(), &include,
+                    permutation.entry.c_str(), permutation.profile.c_str(), SHADER_COMPILE_FLAGS, 0, &shader, &errorMsg);
+
+                if (errorMsg)
+                {
+                    errors.assign((char*)errorMsg->GetBufferPointer(), errorMsg->GetBufferSize());
+                    errorMsg->Release();
+                }
+
+                if (FAILED(hr))
+                    return false;
+
+                char * code = (char*)shader->GetBufferPointer();
+                bytecode.assign(code, code + shader->GetBufferSize());
+                shader->Release();
+                return true;
+            }
+
+            uint32_t getFlags() const override
+            {
+                return (uint32_t)(SHADER_COMPILE_FLAGS);
+            }
+        };
+    }
+
+    D3D11RenderDevice::D3D11RenderDevice(ID3D11Device * device, ID3D11DeviceContext * context)
+    {
+        this->device = device;
+        this->context = context;
+
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+        noOverwriteSRV = SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) &&
+            options.MapNoOverwriteOnDynamicBufferSRV;
+    }
+
+    D3D11RenderDevice::~D3D11RenderDevice()
+    {
+    }
+
+    GpuTexture * D3D11RenderDevice::wrap(ID3D11Texture2D * texture)
+    {
+        texture->AddRef();
+        return new D3DTexture(texture);
+    }
+
+    ID3D11Device * D3D11RenderDevice::getDevice() const
+    {
+        return device;
+    }
+
+    ID3D11DeviceContext * D3D11RenderDevice::getContext() const
+    {
+        return context;
+    }
+
+    ID3D11ShaderResourceView * D3D11RenderDevice::get(ShaderResourceView * view)
+    {
+        return unwrap<ID3D11ShaderResourceView>(view);
+    }
+
+    ID3D11BlendState * D3D11RenderDevice::get(BlendState * state)
+    {
+        return unwrap<ID3D11BlendState>(state);
+    }
+
+    ID3D11SamplerState * D3D11RenderDevice::get(SamplerState * state)
+    {
+        return unwrap<ID3D11SamplerState>(state);
+    }
+
+    ID3D11RenderTargetView * D3D11RenderDevice::get(RenderTargetView * view)
+    {
+        return unwrap<ID3D11RenderTargetView>(view);
+    }
+
+    GpuBuffer * D3D11RenderDevice::CreateBuffer(BufferDesc const & desc, const void * initialData)
+    {
+        D3D11_BUFFER_DESC bufferDesc = {};
+        bufferDesc.ByteWidth = desc.byteWidth;
+        bufferDesc.Usage = (D3D11_USAGE)desc.usage;
+        bufferDesc.BindFlags = desc.bindFlags;
+        bufferDesc.CPUAccessFlags = desc.cpuAccessFlags;
+        bufferDesc.StructureByteStride = desc.structureStride;
+        bufferDesc.MiscFlags = desc.structureStride ? D3D11_RESOURCE_MISC_BUFFER_STRUCTURED : 0;
+
+        D3D11_SUBRESOURCE_DATA data = {};
+        data.pSysMem = initialData;
+
+        ID3D11Buffer * buffer = nullptr;
+        ThrowIfFailed(device->CreateBuffer(&bufferDesc, initialData ? &data : nullptr, &buffer));
+        return new D3DBuffer(buffer);
+    }
+
+    GpuTexture * D3D11RenderDevice::CreateTexture(TextureDesc const & desc, const SubresourceData * initialData)
+    {
+        D3D11_TEXTURE2D_DESC textureDesc = {};
+        textureDesc.Width = desc.width;
+        textureDesc.Height = desc.height;
+        textureDesc.MipLevels = desc.mipLevels;
+        textureDesc.ArraySize = desc.arraySize;
+        textureDesc.Format = (DXGI_FORMAT)desc.format;
+        textureDesc.SampleDesc.Count = 1;
+        textureDesc.Usage = (D3D11_USAGE)desc.usage;
+        textureDesc.BindFlags = desc.bindFlags;
+        textureDesc.CPUAccessFlags = desc.cpuAccessFlags;
+        textureDesc.MiscFlags = desc.generateMips ? D3D11_RESOURCE_MISC_GENERATE_MIPS : 0;
+
+        std::vector<D3D11_SUBRESOURCE_DATA> data;
+        if (initialData)
+        {
+            data.resize(desc.mipLevels * desc.arraySize);
+            for (size_t i = 0; i < data.size(); i++)
+            {
+                data[i].pSysMem = initialData[i].data;
+                data[i].SysMemPitch = initialData[i].rowPitch;
+            }
+        }
+
+        ID3D11Texture2D * texture = nullptr;
+        ThrowIfFailed(device->CreateTexture2D(&textureDesc, initialData ? data.data() : nullptr, &texture));
+        return new D3DTexture(texture);
+    }
+
+    TextureDesc D3D11RenderDevice::GetDesc(GpuTexture * texture)
+    {
+        D3D11_TEXTURE2D_DESC textureDesc;
+        unwrap<ID3D11Texture2D>(texture)->GetDesc(&textureDesc);
+
+        TextureDesc desc = {};
+        desc.width = textureDesc.Width;
+        desc.height = textureDesc.Height;
+        desc.mipLevels = textureDesc.MipLevels;
+        desc.arraySize = textureDesc.ArraySize;
+        desc.format = (Format)textureDesc.Format;
+        desc.usage = (Usage)textureDesc.Usage;
+        desc.bindFlags = textureDesc.BindFlags;
+        desc.cpuAccessFlags = textureDesc.CPUAccessFlags;
+        desc.generateMips = (textureDesc.MiscFlags & D3D11_RESOURCE_MISC_GENERATE_MIPS) != 0;
+        return desc;
+    }
+
+    ShaderResourceView * D3D11RenderDevice::CreateShaderResourceView(GpuBuffer * buffer)
+    {
+        D3D11_BUFFER_DESC bufferDesc;
+        unwrap<ID3D11Buffer>(buffer)->GetDesc(&bufferDesc);
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = {};
+        viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        viewDesc.Buffer.NumElements = bufferDesc.ByteWidth / bufferDesc.StructureByteStride;
+
+        ID3D11ShaderResourceView * view = nullptr;
+        ThrowIfFailed(device->CreateShaderResourceView(unwrap<ID3D11Buffer>(buffer), &viewDesc, &view));
+        return new D3DShaderResourceView(view);
+    }
+
+    ShaderResourceView * D3D11RenderDevice::CreateShaderResourceView(GpuTexture * texture, Format format)
+    {
+        D3D11_TEXTURE2D_DESC textureDesc;
+        unwrap<ID3D11Texture2D>(texture)->GetDesc(&textureDesc);
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = {};
+        viewDesc.Format = format != FORMAT_UNKNOWN ? (DXGI_FORMAT)format : textureDesc.Format;
+        if (textureDesc.ArraySize > 1)
+        {
+            viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+            viewDesc.Texture2DArray.MipLevels = (UINT)-1;
+            viewDesc.Texture2DArray.ArraySize = textureDesc.ArraySize;
+        }
+        else
+        {
+            viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+            viewDesc.Texture2D.MipLevels = (UINT)-1;
+        }
+
+        ID3D11ShaderResourceView * view = nullptr;
+        ThrowIfFailed(device->CreateShaderResourceView(unwrap<ID3D11Texture2D>(texture), &viewDesc, &view));
+        return new D3DShaderResourceView(view);
+    }
+
+    UnorderedAccessView * D3D11RenderDevice::CreateUnorderedAccessView(GpuBuffer * buffer)
+    {
+        D3D11_BUFFER_DESC bufferDesc;
+        unwrap<ID3D11Buffer>(buffer)->GetDesc(&bufferDesc);
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC viewDesc = {};
+        viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+        viewDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        viewDesc.Buffer.NumElements = bufferDesc.ByteWidth / bufferDesc.StructureByteStride;
+
+        ID3D11UnorderedAccessView * view = nullptr;
+        ThrowIfFailed(device->CreateUnorderedAccessView(unwrap<ID3D11Buffer>(buffer), &viewDesc, &view));
+        return new D3DUnorderedAccessView(view);
+    }
+
+    UnorderedAccessView * D3D11RenderDevice::CreateUnorderedAccessView(GpuTexture * texture)
+    {
+        ID3D11UnorderedAccessView * view = nullptr;
+        ThrowIfFailed(device->CreateUnorderedAccessView(unwrap<ID3D11Texture2D>(texture), nullptr, &view));
+        return new D3DUnorderedAccessView(view);
+    }
+
+    RenderTargetView * D3D11RenderDevice::CreateRenderTargetView(GpuTexture * texture)
+    {
+        ID3D11RenderTargetView * view = nullptr;
+        ThrowIfFailed(device->CreateRenderTargetView(unwrap<ID3D11Texture2D>(texture), nullptr, &view));
+        return new D3DRenderTargetView(view);
+    }
+
+    DepthStencilView * D3D11RenderDevice::CreateDepthStencilView(GpuTexture * texture, Format format, UINT slice)
+    {
+        D3D11_TEXTURE2D_DESC textureDesc;
+        unwrap<ID3D11Texture2D>(texture)->GetDesc(&textureDesc);
+
+        D3D11_DEPTH_STENCIL_VIEW_DESC viewDesc = {};
+        viewDesc.Format = (DXGI_FORMAT)format;
+        if (textureDesc.ArraySize > 1)
+        {
+            viewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+            viewDesc.Texture2DArray.FirstArraySlice = slice == ALL_SLICES ? 0 : slice;
+            viewDesc.Texture2DArray.ArraySize = slice == ALL_SLICES ? textureDesc.ArraySize : 1;
+        }
+        else
+        {
+            viewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+        }
+
+        ID3D11DepthStencilView * view = nullptr;
+        ThrowIfFailed(device->CreateDepthStencilView(unwrap<ID3D11Texture2D>(texture), &viewDesc, &view));
+        return new D3DDepthStencilView(view);
+    }
+
+    GpuVertexShader * D3D11RenderDevice::CreateVertexShader(const void * bytecode, size_t bytes)
+    {
+        ID3D11VertexShader * shader = nullptr;
+        ThrowIfFailed(device->CreateVertexShader(bytecode, bytes, nullptr, &shader));
+        return new D3DVertexShader(shader);
+    }
+
+    GpuPixelShader * D3D11RenderDevice::CreatePixelShader(const void * bytecode, size_t bytes)
+    {
+        ID3D11PixelShader * shader = nullptr;
+        ThrowIfFailed(device->CreatePixelShader(bytecode, bytes, nullptr, &shader));
+        return new D3DPixelShader(shader);
+    }
+
+    GpuComputeShader * D3D11RenderDevice::CreateComputeShader(const void * bytecode, size_t bytes)
+    {
+        ID3D11ComputeShader * shader = nullptr;
+        ThrowIfFailed(device->CreateComputeShader(bytecode, bytes, nullptr, &shader));
+        return new D3DComputeShader(shader);
+    }
+
+    InputLayout * D3D11RenderDevice::CreateInputLayout(const InputElement * elements, UINT count, const void * bytecode, size_t bytes)
+    {
+        std::vector<D3D11_INPUT_ELEMENT_DESC> desc(count);
+        for (UINT i = 0; i < count; i++)
+        {
+            desc[i] = {
+                elements[i].semantic,
+                elements[i].semanticIndex,
+                (DXGI_FORMAT)elements[i].format,
+                elements[i].slot,
+                elements[i].offset,
+                D3D11_INPUT_PER_VERTEX_DATA,
+                0
+            };
+        }
+
+        ID3D11InputLayout * layout = nullptr;
+        ThrowIfFailed(device->CreateInputLayout(desc.data(), count, bytecode, bytes, &layout));
+        return new D3DInputLayout(layout);
+    }
+
+    SamplerState * D3D11RenderDevice::CreateSamplerState(SamplerDesc const & desc)
+    {
+        D3D11_SAMPLER_DESC samplerDesc = {};
+        samplerDesc.Filter = (D3D11_FILTER)desc.filter;
+        samplerDesc.AddressU = (D3D11_TEXTURE_ADDRESS_MODE)desc.address;
+        samplerDesc.AddressV = (D3D11_TEXTURE_ADDRESS_MODE)desc.address;
+        samplerDesc.AddressW = (D3D11_TEXTURE_ADDRESS_MODE)desc.address;
+        samplerDesc.ComparisonFunc = (D3D11_COMPARISON_FUNC)desc.comparison;
+        samplerDesc.MaxAnisotropy = desc.maxAnisotropy;
+        samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+        for (int i = 0; i < 4; i++)
+            samplerDesc.BorderColor[i] = desc.borderColor[i];
+
+        ID3D11SamplerState * state = nullptr;
+        ThrowIfFailed(device->CreateSamplerState(&samplerDesc, &state));
+        return new D3DSamplerState(state);
+    }
+
+    RasterizerState * D3D11RenderDevice::CreateRasterizerState(RasterizerDesc const & desc)
+    {
+        D3D11_RASTERIZER_DESC rasterizerDesc = {};
+        rasterizerDesc.CullMode = (D3D11_CULL_MODE)desc.cull;
+        rasterizerDesc.FillMode = desc.wireframe ? D3D11_FILL_WIREFRAME : D3D11_FILL_SOLID;
+        rasterizerDesc.DepthClipEnable = desc.depthClip;
+        rasterizerDesc.MultisampleEnable = TRUE;
+
+        ID3D11RasterizerState * state = nullptr;
+        ThrowIfFailed(device->CreateRasterizerState(&rasterizerDesc, &state));
+        return new D3DRasterizerState(state);
+    }
+
+    DepthStencilState * D3D11RenderDevice::CreateDepthStencilState(DepthStencilDesc const & desc)
+    {
+        D3D11_DEPTH_STENCIL_DESC depthDesc = {};
+        depthDesc.DepthEnable = desc.depthEnable;
+        depthDesc.DepthWriteMask = desc.depthWrite ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
+        depthDesc.DepthFunc = (D3D11_COMPARISON_FUNC)desc.depthFunc;
+        depthDesc.StencilReadMask = D3D11_DEFAULT_STENCIL_READ_MASK;
+        depthDesc.StencilWriteMask = D3D11_DEFAULT_STENCIL_WRITE_MASK;
+        depthDesc.FrontFace = { D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_KEEP, D3D11_COMPARISON_ALWAYS };
+        depthDesc.BackFace = depthDesc.FrontFace;
+
+        ID3D11DepthStencilState * state = nullptr;
+        ThrowIfFailed(device->CreateDepthStencilState(&depthDesc, &state));
+        return new D3DDepthStencilState(state);
+    }
+
+    BlendState * D3D11RenderDevice::CreateBlendState(BlendDesc const & desc)
+    {
+        D3D11_BLEND_DESC blendDesc = {};
+        blendDesc.RenderTarget[0].BlendEnable = desc.enable;
+        blendDesc.RenderTarget[0].SrcBlend = (D3D11_BLEND)desc.src;
+        blendDesc.RenderTarget[0].DestBlend = (D3D11_BLEND)desc.dest;
+        blendDesc.RenderTarget[0].BlendOp = (D3D11_BLEND_OP)desc.op;
+        blendDesc.RenderTarget[0].SrcBlendAlpha = (D3D11_BLEND)desc.srcAlpha;
+        blendDesc.RenderTarget[0].DestBlendAlpha = (D3D11_BLEND)desc.destAlpha;
+        blendDesc.RenderTarget[0].BlendOpAlpha = (D3D11_BLEND_OP)desc.opAlpha;
+        blendDesc.RenderTarget[0].RenderTargetWriteMask = desc.writeMask;
+
+        ID3D11BlendState * state = nullptr;
+        ThrowIfFailed(device->CreateBlendState(&blendDesc, &state));
+        return new D3DBlendState(state);
+    }
+
+    ShaderCompiler & D3D11RenderDevice::shaderCompiler()
+    {
+        static D3DShaderCompiler compiler;
+        return compiler;
+    }
+
+    ShaderCompiler * D3D11RenderDevice::GetShaderCompiler()
+    {
+        return &shaderCompiler();
+    }
+
+    bool D3D11RenderDevice::SupportsNoOverwriteSRV()
+    {
+        return noOverwriteSRV;
+    }
+
+    void * D3D11RenderDevice::Map(GpuResource * resource, UINT bytes)
+    {
+        D3D11_MAPPED_SUBRESOURCE data = {};
+        context->Map(unwrapResource(resource), 0, D3D11_MAP_WRITE_DISCARD, 0, &data);
+        return data.pData;
+    }
+
+    void * D3D11RenderDevice::MapNoOverwrite(GpuResource * resource, UINT offset, UINT bytes)
+    {
+        D3D11_MAPPED_SUBRESOURCE data = {};
+        context->Map(unwrapResource(resource), 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &data);
+        return (char*)data.pData + offset;
+    }
+
+    void D3D11RenderDevice::Unmap(GpuResource * resource)
+    {
+        context->Unmap(unwrapResource(resource), 0);
+    }
+
+    void D3D11RenderDevice::UpdateBuffer(GpuResource * resource, UINT offset, UINT bytes, const void * data)
+    {
+        D3D11_BOX box = { offset, 0, 0, offset + bytes, 1, 1 };
+        context->UpdateSubresource(unwrapResource(resource), 0, &box, data, 0, 0);
+    }
+
+    void D3D11RenderDevice::CopyResource(GpuResource * destination, GpuResource * source)
+    {
+        context->CopyResource(unwrapResource(destination), unwrapResource(source));
+    }
+
+    void D3D11RenderDevice::UpdateTexture(GpuTexture * texture, UINT mip, const void * data, UINT rowPitch)
+    {
+        context->UpdateSubresource(unwrap<ID3D11Texture2D>(texture), mip, nullptr, data, rowPitch, 0);
+    }
+
+    void D3D11RenderDevice::GenerateMips(ShaderResourceView * view)
+    {
+        context->GenerateMips(unwrap<ID3D11ShaderResourceView>(view));
+    }
+
+    void D3D11RenderDevice::ClearRenderTargetView(RenderTargetView * renderTarget, const float color[4])
+    {
+        context->ClearRenderTargetView(unwrap<ID3D11RenderTargetView>(renderTarget), color);
+    }
+
+    void D3D11RenderDevice::ClearDepthStencilView(DepthStencilView * depthStencil, UINT flags, float depth, uint8_t stencil)
+    {
+        context->ClearDepthStencilView(unwrap<ID3D11DepthStencilView>(depthStencil), flags, depth, stencil);
+    }
+
+    void D3D11RenderDevice::Draw(UINT vertexCount, UINT startVertex)
+    {
+        context->Draw(vertexCount, startVertex);
+    }
+
+    void D3D11RenderDevice::DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance)
+    {
+        context->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+    }
+
+    void D3D11RenderDevice::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+    {
+        context->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+    }
+
+    void D3D11RenderDevice::Dispatch(UINT x, UINT y, UINT z)
+    {
+        context->Dispatch(x, y, z);
+    }
+
+    void D3D11RenderDevice::IASetInputLayout(InputLayout * inputLayout)
+    {
+        context->IASetInputLayout(unwrap<ID3D11InputLayout>(inputLayout));
+    }
+
+    void D3D11RenderDevice::IASetPrimitiveTopology(PrimitiveTopology topology)
+    {
+        context->IASetPrimitiveTopology((D3D11_PRIMITIVE_TOPOLOGY)topology);
+    }
+
+    void D3D11RenderDevice::IASetVertexBuffers(UINT slot, UINT count, GpuBuffer * const * buffers, const UINT * strides, const UINT * offsets)
+    {
+        ID3D11Buffer * objects[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+        context->IASetVertexBuffers(slot, count, unwrapAll(objects, buffers, count), strides, offsets);
+    }
+
+    void D3D11RenderDevice::IASetIndexBuffer(GpuBuffer * buffer, Format format, UINT offset)
+    {
+        context->IASetIndexBuffer(unwrap<ID3D11Buffer>(buffer), (DXGI_FORMAT)format, offset);
+    }
+
+    void D3D11RenderDevice::VSSetShader(GpuVertexShader * shader)
+    {
+        context->VSSetShader(unwrap<ID3D11VertexShader>(shader), nullptr, 0);
+    }
+
+    void D3D11RenderDevice::PSSetShader(GpuPixelShader * shader)
+    {
+        context->PSSetShader(unwrap<ID3D11PixelShader>(shader), nullptr, 0);
+    }
+
+    void D3D11RenderDevice::CSSetShader(GpuComputeShader * shader)
+    {
+        context->CSSetShader(unwrap<ID3D11ComputeShader>(shader), nullptr, 0);
+    }
+
+    void D3D11RenderDevice::VSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers)
+    {
+        ID3D11Buffer * objects[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+        context->VSSetConstantBuffers(slot, count, unwrapAll(objects, buffers, count));
+    }
+
+    void D3D11RenderDevice::PSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers)
+    {
+        ID3D11Buffer * objects[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+        context->PSSetConstantBuffers(slot, count, unwrapAll(objects, buffers, count));
+    }
+
+    void D3D11RenderDevice::CSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers)
+    {
+        ID3D11Buffer * objects[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+        context->CSSetConstantBuffers(slot, count, unwrapAll(objects, buffers, count));
+    }
+
+    void D3D11RenderDevice::VSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views)
+    {
+        ID3D11ShaderResourceView * objects[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+        context->VSSetShaderResources(slot, count, unwrapAll(objects, views, count));
+    }
+
+    void D3D11RenderDevice::PSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views)
+    {
+        ID3D11ShaderResourceView * objects[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+        context->PSSetShaderResources(slot, count, unwrapAll(objects, views, count));
+    }
+
+    void D3D11RenderDevice::CSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views)
+    {
+        ID3D11ShaderResourceView * objects[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+        context->CSSetShaderResources(slot, count, unwrapAll(objects, views, count));
+    }
+
+    void D3D11RenderDevice::CSSetUnorderedAccessViews(UINT slot, UINT count, UnorderedAccessView * const * views, const UINT * initialCounts)
+    {
+        ID3D11UnorderedAccessView * objects[D3D11_1_UAV_SLOT_COUNT];
+        context->CSSetUnorderedAccessViews(slot, count, unwrapAll(objects, views, count), initialCounts);
+    }
+
+    void D3D11RenderDevice::PSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers)
+    {
+        ID3D11SamplerState * objects[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+        context->PSSetSamplers(slot, count, unwrapAll(objects, samplers, count));
+    }
+
+    void D3D11RenderDevice::CSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers)
+    {
+        ID3D11SamplerState * objects[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+        context->CSSetSamplers(slot, count, unwrapAll(objects, samplers, count));
+    }
+
+    void D3D11RenderDevice::RSSetViewports(UINT count, const Viewport * viewports)
+    {
+        static_assert(sizeof(Viewport) == sizeof(D3D11_VIEWPORT), "Viewport has the layout of D3D11_VIEWPORT");
+        context->RSSetViewports(count, reinterpret_cast<const D3D11_VIEWPORT*>(viewports));
+    }
+
+    void D3D11RenderDevice::RSSetState(RasterizerState * state)
+    {
+        context->RSSetState(unwrap<ID3D11RasterizerState>(state));
+    }
+
+    void D3D11RenderDevice::OMSetRenderTargets(UINT count, RenderTargetView * const * renderTargets, DepthStencilView * depthStencil)
+    {
+        ID3D11RenderTargetView * objects[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+        context->OMSetRenderTargets(count, unwrapAll(objects, renderTargets, count), unwrap<ID3D11DepthStencilView>(depthStencil));
+    }
+
+    void D3D11RenderDevice::OMSetDepthStencilState(DepthStencilState * state, UINT stencilRef)
+    {
+        context->OMSetDepthStencilState(unwrap<ID3D11DepthStencilState>(state), stencilRef);
+    }
+
+    void D3D11RenderDevice::OMSetBlendState(BlendState * state, const float blendFactor[4], UINT sampleMask)
+    {
+        context->OMSetBlendState(unwrap<ID3D11BlendState>(state), blendFactor, sampleMask);
+    }
+}
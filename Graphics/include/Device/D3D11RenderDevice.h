@@ -0,0 +1,98 @@
+#pragma once
+#include "RenderDevice.h"
+#include <d3d11.h>
+
+namespace Graphics
+{
+    /*
+        Creates with the ID3D11Device and sends everything straight to the
+        device context. The objects it returns hold the D3D11 ones, get()
+        gives them back for what still talks to D3D11 directly (ImGui,
+        the profiler and DirectXTK's SpriteBatch).
+
+        HOW TO USE:
+            D3D11RenderDevice device(d3dDevice, d3dContext);
+            GpuTexture * backBuffer = device.wrap(swapChainTexture);
+            Renderer renderer(&device, backBuffer, &camera);
+    */
+    class D3D11RenderDevice : public RenderDevice
+    {
+    public:
+        D3D11RenderDevice(ID3D11Device * device, ID3D11DeviceContext * context);
+        virtual ~D3D11RenderDevice();
+
+        // a texture that wasn't created here, like the swap chain's. It holds a reference of its own
+        GpuTexture * wrap(ID3D11Texture2D * texture);
+
+        // the one D3DCompile goes through, there is no state in it. Also for
+        // precompileShaders, which runs without a device
+        static ShaderCompiler & shaderCompiler();
+
+        ID3D11Device * getDevice() const;
+        ID3D11DeviceContext * getContext() const;
+        static ID3D11ShaderResourceView * get(ShaderResourceView * view);
+        static ID3D11BlendState * get(BlendState * state);
+        static ID3D11SamplerState * get(SamplerState * state);
+        static ID3D11RenderTargetView * get(RenderTargetView * view);
+
+        virtual GpuBuffer * CreateBuffer(BufferDesc const & desc, const void * initialData);
+        virtual GpuTexture * CreateTexture(TextureDesc const & desc, const SubresourceData * initialData);
+        virtual TextureDesc GetDesc(GpuTexture * texture);
+        virtual ShaderResourceView * CreateShaderResourceView(GpuBuffer * buffer);
+        virtual ShaderResourceView * CreateShaderResourceView(GpuTexture * texture, Format format = FORMAT_UNKNOWN);
+        virtual UnorderedAccessView * CreateUnorderedAccessView(GpuBuffer * buffer);
+        virtual UnorderedAccessView * CreateUnorderedAccessView(GpuTexture * texture);
+        virtual RenderTargetView * CreateRenderTargetView(GpuTexture * texture);
+        virtual DepthStencilView * CreateDepthStencilView(GpuTexture * texture, Format format, UINT slice = ALL_SLICES);
+        virtual GpuVertexShader * CreateVertexShader(const void * bytecode, size_t bytes);
+        virtual GpuPixelShader * CreatePixelShader(const void * bytecode, size_t bytes);
+        virtual GpuComputeShader * CreateComputeShader(const void * bytecode, size_t bytes);
+        virtual InputLayout * CreateInputLayout(const InputElement * elements, UINT count, const void * bytecode, size_t bytes);
+        virtual SamplerState * CreateSamplerState(SamplerDesc const & desc);
+        virtual RasterizerState * CreateRasterizerState(RasterizerDesc const & desc);
+        virtual DepthStencilState * CreateDepthStencilState(DepthStencilDesc const & desc);
+        virtual BlendState * CreateBlendState(BlendDesc const & desc);
+        virtual ShaderCompiler * GetShaderCompiler();
+        virtual bool SupportsNoOverwriteSRV();
+
+        virtual void * Map(GpuResource * resource, UINT bytes);
+        virtual void * MapNoOverwrite(GpuResource * resource, UINT offset, UINT bytes);
+        virtual void Unmap(GpuResource * resource);
+        virtual void UpdateBuffer(GpuResource * resource, UINT offset, UINT bytes, const void * data);
+        virtual void CopyResource(GpuResource * destination, GpuResource * source);
+        virtual void UpdateTexture(GpuTexture * texture, UINT mip, const void * data, UINT rowPitch);
+        virtual void GenerateMips(ShaderResourceView * view);
+        virtual void ClearRenderTargetView(RenderTargetView * renderTarget, const float color[4]);
+        virtual void ClearDepthStencilView(DepthStencilView * depthStencil, UINT flags, float depth, uint8_t stencil);
+        virtual void Draw(UINT vertexCount, UINT startVertex);
+        virtual void DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance);
+        virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance);
+        virtual void Dispatch(UINT x, UINT y, UINT z);
+        virtual void IASetInputLayout(InputLayout * inputLayout);
+        virtual void IASetPrimitiveTopology(PrimitiveTopology topology);
+        virtual void IASetVertexBuffers(UINT slot, UINT count, GpuBuffer * const * buffers, const UINT * strides, const UINT * offsets);
+        virtual void IASetIndexBuffer(GpuBuffer * buffer, Format format, UINT offset);
+        virtual void VSSetShader(GpuVertexShader * shader);
+        virtual void PSSetShader(GpuPixelShader * shader);
+        virtual void CSSetShader(GpuComputeShader * shader);
+        virtual void VSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers);
+        virtual void PSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers);
+        virtual void CSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers);
+        virtual void VSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views);
+        virtual void PSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views);
+        virtual void CSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views);
+        virtual void CSSetUnorderedAccessViews(UINT slot, UINT count, UnorderedAccessView * const * views, const UINT * initialCounts);
+        virtual void PSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers);
+        virtual void CSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers);
+        virtual void RSSetViewports(UINT count, const Viewport * viewports);
+        virtual void RSSetState(RasterizerState * state);
+        virtual void OMSetRenderTargets(UINT count, RenderTargetView * const * renderTargets, DepthStencilView * depthStencil);
+        virtual void OMSetDepthStencilState(DepthStencilState * state, UINT stencilRef);
+        virtual void OMSetBlendState(BlendState * state, const float blendFactor[4], UINT sampleMask);
+
+    private:
+        ID3D11Device * device;
+        ID3D11DeviceContext * context;
+        bool noOverwriteSRV;
+    };
+}
@@ -0,0 +1,463 @@
+#include "NullRenderDevice.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace Graphics
+{
+    template<typename T>
+    class NullRenderDevice::Object : public T
+    {
+    public:
+        Object(NullRenderDevice * owner) : owner(owner) { owner->liveObjects++; }
+
+        virtual void Release()
+        {
+            owner->liveObjects--;
+            delete this;
+        }
+    protected:
+        NullRenderDevice * owner;
+    };
+
+    // what was uploaded to a released buffer doesn't belong to the next one at the same address
+    class NullRenderDevice::Buffer : public Object<GpuBuffer>
+    {
+    public:
+        Buffer(NullRenderDevice * owner, BufferDesc const & desc) : Object(owner), desc(desc) {}
+
+        virtual void Release()
+        {
+            owner->uploaded.erase(this);
+            Object::Release();
+        }
+
+        BufferDesc desc;
+    };
+
+    class NullRenderDevice::Texture : public Object<GpuTexture>
+    {
+    public:
+        Texture(NullRenderDevice * owner, TextureDesc const & desc) : Object(owner), desc(desc) {}
+
+        virtual void Release()
+        {
+            owner->uploaded.erase(this);
+            Object::Release();
+        }
+
+        TextureDesc desc;
+    };
+
+    NullRenderDevice::NullRenderDevice()
+    {
+        logging = false;
+        liveObjects = 0;
+        beginFrame();
+    }
+
+    NullRenderDevice::~NullRenderDevice()
+    {
+    }
+
+    void NullRenderDevice::beginFrame()
+    {
+        commands.clear();
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    void NullRenderDevice::setLogging(bool logging)
+    {
+        this->logging = logging;
+    }
+
+    const std::vector<NullRenderDevice::Command> & NullRenderDevice::getCommands() const
+    {
+        return commands;
+    }
+
+    const NullRenderDevice::Stats & NullRenderDevice::getStats() const
+    {
+        return stats;
+    }
+
+    const std::vector<char> * NullRenderDevice::getUploaded(GpuResource * resource) const
+    {
+        auto it = uploaded.find(resource);
+        return it != uploaded.end() ? &it->second : nullptr;
+    }
+
+    UINT NullRenderDevice::getLiveObjects() const
+    {
+        return liveObjects;
+    }
+
+    void NullRenderDevice::record(COMMAND type, const char * name, UINT a, UINT b, UINT c)
+    {
+        commands.push_back({ type, name, { a, b, c } });
+        if (logging)
+            printf("%s(%u, %u, %u)\n", name, a, b, c);
+    }
+
+    GpuBuffer * NullRenderDevice::CreateBuffer(BufferDesc const & desc, const void * initialData)
+    {
+        Buffer * buffer = new Buffer(this, desc);
+        if (initialData)
+            uploaded[buffer].assign((const char*)initialData, (const char*)initialData + desc.byteWidth);
+
+        stats.created++;
+        record(CREATE, "CreateBuffer", desc.byteWidth);
+        return buffer;
+    }
+
+    GpuTexture * NullRenderDevice::CreateTexture(TextureDesc const & desc, const SubresourceData * initialData)
+    {
+        stats.created++;
+        record(CREATE, "CreateTexture", desc.width, desc.height);
+        return new Texture(this, desc);
+    }
+
+    TextureDesc NullRenderDevice::GetDesc(GpuTexture * texture)
+    {
+        return static_cast<Texture*>(texture)->desc;
+    }
+
+    ShaderResourceView * NullRenderDevice::CreateShaderResourceView(GpuBuffer * buffer)
+    {
+        stats.created++;
+        record(CREATE, "CreateShaderResourceView");
+        return new Object<ShaderResourceView>(this);
+    }
+
+    ShaderResourceView * NullRenderDevice::CreateShaderResourceView(GpuTexture * texture, Format format)
+    {
+        stats.created++;
+        record(CREATE, "CreateShaderResourceView");
+        return new Object<ShaderResourceView>(this);
+    }
+
+    UnorderedAccessView * NullRenderDevice::CreateUnorderedAccessView(GpuBuffer * buffer)
+    {
+        stats.created++;
+        record(CREATE, "CreateUnorderedAccessView");
+        return new Object<UnorderedAccessView>(this);
+    }
+
+    UnorderedAccessView * NullRenderDevice::CreateUnorderedAccessView(GpuTexture * texture)
+    {
+        stats.created++;
+        record(CREATE, "CreateUnorderedAccessView");
+        return new Object<UnorderedAccessView>(this);
+    }
+
+    RenderTargetView * NullRenderDevice::CreateRenderTargetView(GpuTexture * texture)
+    {
+        stats.created++;
+        record(CREATE, "CreateRenderTargetView");
+        return new Object<RenderTargetView>(this);
+    }
+
+    DepthStencilView * NullRenderDevice::CreateDepthStencilView(GpuTexture * texture, Format format, UINT slice)
+    {
+        stats.created++;
+        record(CREATE, "CreateDepthStencilView", slice);
+        return new Object<DepthStencilView>(this);
+    }
+
+    GpuVertexShader * NullRenderDevice::CreateVertexShader(const void * bytecode, size_t bytes)
+    {
+        stats.created++;
+        record(CREATE, "CreateVertexShader");
+        return new Object<GpuVertexShader>(this);
+    }
+
+    GpuPixelShader * NullRenderDevice::CreatePixelShader(const void * bytecode, size_t bytes)
+    {
+        stats.created++;
+        record(CREATE, "CreatePixelShader");
+        return new Object<GpuPixelShader>(this);
+    }
+
+    GpuComputeShader * NullRenderDevice::CreateComputeShader(const void * bytecode, size_t bytes)
+    {
+        stats.created++;
+        record(CREATE, "CreateComputeShader");
+        return new Object<GpuComputeShader>(this);
+    }
+
+    InputLayout * NullRenderDevice::CreateInputLayout(const InputElement * elements, UINT count, const void * bytecode, size_t bytes)
+    {
+        stats.created++;
+        record(CREATE, "CreateInputLayout", count);
+        return new Object<InputLayout>(this);
+    }
+
+    SamplerState * NullRenderDevice::CreateSamplerState(SamplerDesc const & desc)
+    {
+        stats.created++;
+        record(CREATE, "CreateSamplerState");
+        return new Object<SamplerState>(this);
+    }
+
+    RasterizerState * NullRenderDevice::CreateRasterizerState(RasterizerDesc const & desc)
+    {
+        stats.created++;
+        record(CREATE, "CreateRasterizerState");
+        return new Object<RasterizerState>(this);
+    }
+
+    DepthStencilState * NullRenderDevice::CreateDepthStencilState(DepthStencilDesc const & desc)
+    {
+        stats.created++;
+        record(CREATE, "CreateDepthStencilState");
+        return new Object<DepthStencilState>(this);
+    }
+
+    BlendState * NullRenderDevice::CreateBlendState(BlendDesc const & desc)
+    {
+        stats.created++;
+        record(CREATE, "CreateBlendState");
+        return new Object<BlendState>(this);
+    }
+
+    ShaderCompiler * NullRenderDevice::GetShaderCompiler()
+    {
+        return nullptr;
+    }
+
+    bool NullRenderDevice::SupportsNoOverwriteSRV()
+    {
+        return true;
+    }
+
+    void * NullRenderDevice::Map(GpuResource * resource, UINT bytes)
+    {
+        std::vector<char> &memory = uploaded[resource];
+        memory.resize(bytes);
+
+        stats.maps++;
+        stats.bytesUploaded += bytes;
+        record(MAP, "Map", bytes);
+
+        return memory.data();
+    }
+
+    void * NullRenderDevice::MapNoOverwrite(GpuResource * resource, UINT offset, UINT bytes)
+    {
+        // the rest of the resource is kept, like on the GPU
+        std::vector<char> &memory = uploaded[resource];
+        if (memory.size() < offset + bytes)
+            memory.resize(offset + bytes);
+
+        stats.maps++;
+        stats.bytesUploaded += bytes;
+        record(MAP, "MapNoOverwrite", bytes, offset);
+
+        return memory.data() + offset;
+    }
+
+    void NullRenderDevice::Unmap(GpuResource * resource)
+    {
+        // the data is already in uploaded
+    }
+
+    void NullRenderDevice::UpdateBuffer(GpuResource * resource, UINT offset, UINT bytes, const void * data)
+    {
+        std::vector<char> &memory = uploaded[resource];
+        if (memory.size() < offset + bytes)
+            memory.resize(offset + bytes);
+        memcpy(memory.data() + offset, data, bytes);
+
+        stats.bytesUploaded += bytes;
+        record(UPDATE, "UpdateBuffer", bytes, offset);
+    }
+
+    void NullRenderDevice::CopyResource(GpuResource * destination, GpuResource * source)
+    {
+        stats.copies++;
+        record(COPY, "CopyResource");
+    }
+
+    void NullRenderDevice::UpdateTexture(GpuTexture * texture, UINT mip, const void * data, UINT rowPitch)
+    {
+        TextureDesc const & desc = static_cast<Texture*>(texture)->desc;
+        UINT height = desc.height >> mip ? desc.height >> mip : 1;
+
+        stats.bytesUploaded += rowPitch * height;
+        record(UPDATE, "UpdateTexture", rowPitch * height, mip);
+    }
+
+    void NullRenderDevice::GenerateMips(ShaderResourceView * view)
+    {
+        stats.copies++;
+        record(COPY, "GenerateMips");
+    }
+
+    void NullRenderDevice::ClearRenderTargetView(RenderTargetView * renderTarget, const float color[4])
+    {
+        stats.clears++;
+        record(CLEAR, "ClearRenderTargetView");
+    }
+
+    void NullRenderDevice::ClearDepthStencilView(DepthStencilView * depthStencil, UINT flags, float depth, uint8_t stencil)
+    {
+        stats.clears++;
+        record(CLEAR, "ClearDepthStencilView");
+    }
+
+    void NullRenderDevice::Draw(UINT vertexCount, UINT startVertex)
+    {
+        stats.draws++;
+        stats.instances++;
+        stats.vertices += vertexCount;
+        record(DRAW, "Draw", vertexCount, 1);
+    }
+
+    void NullRenderDevice::DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance)
+    {
+        stats.draws++;
+        stats.instances += instanceCount;
+        stats.vertices += vertexCount * instanceCount;
+        record(DRAW, "DrawInstanced", vertexCount, instanceCount);
+    }
+
+    void NullRenderDevice::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+    {
+        stats.draws++;
+        stats.instances += instanceCount;
+        stats.vertices += indexCount * instanceCount;
+        record(DRAW, "DrawIndexedInstanced", indexCount, instanceCount);
+    }
+
+    void NullRenderDevice::Dispatch(UINT x, UINT y, UINT z)
+    {
+        stats.dispatches++;
+        stats.threadGroups += x * y * z;
+        record(DISPATCH, "Dispatch", x, y, z);
+    }
+
+    void NullRenderDevice::IASetInputLayout(InputLayout * inputLayout)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "IASetInputLayout");
+    }
+
+    void NullRenderDevice::IASetPrimitiveTopology(PrimitiveTopology topology)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "IASetPrimitiveTopology");
+    }
+
+    void NullRenderDevice::IASetVertexBuffers(UINT slot, UINT count, GpuBuffer * const * buffers, const UINT * strides, const UINT * offsets)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "IASetVertexBuffers", slot, count);
+    }
+
+    void NullRenderDevice::IASetIndexBuffer(GpuBuffer * buffer, Format format, UINT offset)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "IASetIndexBuffer");
+    }
+
+    void NullRenderDevice::VSSetShader(GpuVertexShader * shader)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "VSSetShader");
+    }
+
+    void NullRenderDevice::PSSetShader(GpuPixelShader * shader)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "PSSetShader");
+    }
+
+    void NullRenderDevice::CSSetShader(GpuComputeShader * shader)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "CSSetShader");
+    }
+
+    void NullRenderDevice::VSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "VSSetConstantBuffers", slot, count);
+    }
+
+    void NullRenderDevice::PSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "PSSetConstantBuffers", slot, count);
+    }
+
+    void NullRenderDevice::CSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "CSSetConstantBuffers", slot, count);
+    }
+
+    void NullRenderDevice::VSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "VSSetShaderResources", slot, count);
+    }
+
+    void NullRenderDevice::PSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "PSSetShaderResources", slot, count);
+    }
+
+    void NullRenderDevice::CSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "CSSetShaderResources", slot, count);
+    }
+
+    void NullRenderDevice::CSSetUnorderedAccessViews(UINT slot, UINT count, UnorderedAccessView * const * views, const UINT * initialCounts)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "CSSetUnorderedAccessViews", slot, count);
+    }
+
+    void NullRenderDevice::PSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "PSSetSamplers", slot, count);
+    }
+
+    void NullRenderDevice::CSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "CSSetSamplers", slot, count);
+    }
+
+    void NullRenderDevice::RSSetViewports(UINT count, const Viewport * viewports)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "RSSetViewports", count);
+    }
+
+    void NullRenderDevice::RSSetState(RasterizerState * state)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "RSSetState");
+    }
+
+    void NullRenderDevice::OMSetRenderTargets(UINT count, RenderTargetView * const * renderTargets, DepthStencilView * depthStencil)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "OMSetRenderTargets", count);
+    }
+
+    void NullRenderDevice::OMSetDepthStencilState(DepthStencilState * state, UINT stencilRef)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "OMSetDepthStencilState");
+    }
+
+    void NullRenderDevice::OMSetBlendState(BlendState * state, const float blendFactor[4], UINT sampleMask)
+    {
+        stats.stateChanges++;
+        record(SET_STATE, "OMSetBlendState");
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "RenderDevice.h"
+#include <vector>
+#include <unordered_map>
+
+namespace Graphics
+{
+    /*
+        Records the commands instead of sending them anywhere, nothing that is
+        passed in is ever dereferenced. Mapped memory is kept per resource so
+        what was uploaded can be read back with getUploaded().
+
+        HOW TO USE:
+            NullRenderDevice device;
+            Renderer renderer(&device, backBuffer, &camera);
+            device.beginFrame();
+            renderer.render(&camera);
+            device.getStats().draws ...
+    */
+    class NullRenderDevice : public RenderDevice
+    {
+    public:
+        enum COMMAND { MAP, UPDATE, COPY, CLEAR, DRAW, DISPATCH, SET_STATE, CREATE, NR_OF_COMMANDS };
+
+        struct Command
+        {
+            COMMAND type;
+            const char * name;  // the RenderDevice function
+            UINT args[3];       // draw: count, instances / dispatch: x, y, z / map, update: bytes, offset
+        };
+
+        struct Stats
+        {
+            UINT draws;
+            UINT instances;
+            UINT vertices;      // or indices, times instances
+            UINT dispatches;
+            UINT threadGroups;
+            UINT maps;
+            UINT bytesUploaded;
+            UINT copies;
+            UINT clears;
+            UINT stateChanges;
+            UINT created;       // device objects
+        };
+
+        NullRenderDevice();
+        virtual ~NullRenderDevice();
+
+        // clears the recorded commands and stats, mapped memory is kept
+        void beginFrame();
+        void setLogging(bool logging); // printf every command when it is recorded
+
+        const std::vector<Command> & getCommands() const;
+        const Stats & getStats() const;
+        const std::vector<char> * getUploaded(GpuResource * resource) const;
+        // created and not released yet
+        UINT getLiveObjects() const;
+
+        virtual GpuBuffer * CreateBuffer(BufferDesc const & desc, const void * initialData);
+        virtual GpuTexture * CreateTexture(TextureDesc const & desc, const SubresourceData * initialData);
+        virtual TextureDesc GetDesc(GpuTexture * texture);
+        virtual ShaderResourceView * CreateShaderResourceView(GpuBuffer * buffer);
+        virtual ShaderResourceView * CreateShaderResourceView(GpuTexture * texture, Format format = FORMAT_UNKNOWN);
+        virtual UnorderedAccessView * CreateUnorderedAccessView(GpuBuffer * buffer);
+        virtual UnorderedAccessView * CreateUnorderedAccessView(GpuTexture * texture);
+        virtual RenderTargetView * CreateRenderTargetView(GpuTexture * texture);
+        virtual DepthStencilView * CreateDepthStencilView(GpuTexture * texture, Format format, UINT slice = ALL_SLICES);
+        virtual GpuVertexShader * CreateVertexShader(const void * bytecode, size_t bytes);
+        virtual GpuPixelShader * CreatePixelShader(const void * bytecode, size_t bytes);
+        virtual GpuComputeShader * CreateComputeShader(const void * bytecode, size_t bytes);
+        virtual InputLayout * CreateInputLayout(const InputElement * elements, UINT count, const void * bytecode, size_t bytes);
+        virtual SamplerState * CreateSamplerState(SamplerDesc const & desc);
+        virtual RasterizerState * CreateRasterizerState(RasterizerDesc const & desc);
+        virtual DepthStencilState * CreateDepthStencilState(DepthStencilDesc const & desc);
+        virtual BlendState * CreateBlendState(BlendDesc const & desc);
+        virtual ShaderCompiler * GetShaderCompiler();
+        virtual bool SupportsNoOverwriteSRV();
+
+        virtual void * Map(GpuResource * resource, UINT bytes);
+        virtual void * MapNoOverwrite(GpuResource * resource, UINT offset, UINT bytes);
+        virtual void Unmap(GpuResource * resource);
+        virtual void UpdateBuffer(GpuResource * resource, UINT offset, UINT bytes, const void * data);
+        virtual void CopyResource(GpuResource * destination, GpuResource * source);
+        virtual void UpdateTexture(GpuTexture * texture, UINT mip, const void * data, UINT rowPitch);
+        virtual void GenerateMips(ShaderResourceView * view);
+        virtual void ClearRenderTargetView(RenderTargetView * renderTarget, const float color[4]);
+        virtual void ClearDepthStencilView(DepthStencilView * depthStencil, UINT flags, float depth, uint8_t stencil);
+        virtual void Draw(UINT vertexCount, UINT startVertex);
+        virtual void DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance);
+        virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance);
+        virtual void Dispatch(UINT x, UINT y, UINT z);
+        virtual void IASetInputLayout(InputLayout * inputLayout);
+        virtual void IASetPrimitiveTopology(PrimitiveTopology topology);
+        virtual void IASetVertexBuffers(UINT slot, UINT count, GpuBuffer * const * buffers, const UINT * strides, const UINT * offsets);
+        virtual void IASetIndexBuffer(GpuBuffer * buffer, Format format, UINT offset);
+        virtual void VSSetShader(GpuVertexShader * shader);
+        virtual void PSSetShader(GpuPixelShader * shader);
+        virtual void CSSetShader(GpuComputeShader * shader);
+        virtual void VSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers);
+        virtual void PSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers);
+        virtual void CSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers);
+        virtual void VSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views);
+        virtual void PSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views);
+        virtual void CSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views);
+        virtual void CSSetUnorderedAccessViews(UINT slot, UINT count, UnorderedAccessView * const * views, const UINT * initialCounts);
+        virtual void PSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers);
+        virtual void CSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers);
+        virtual void RSSetViewports(UINT count, const Viewport * viewports);
+        virtual void RSSetState(RasterizerState * state);
+        virtual void OMSetRenderTargets(UINT count, RenderTargetView * const * renderTargets, DepthStencilView * depthStencil);
+        virtual void OMSetDepthStencilState(DepthStencilState * state, UINT stencilRef);
+        virtual void OMSetBlendState(BlendState * state, const float blendFactor[4], UINT sampleMask);
+
+    private:
+        std::vector<Command> commands;
+        std::unordered_map<GpuResource*, std::vector<char>> uploaded;
+        Stats stats;
+        bool logging;
+        UINT liveObjects;
+
+        template<typename T> class Object;
+        class Buffer;
+        class Texture;
+
+        void record(COMMAND type, const char * name, UINT a = 0, UINT b = 0, UINT c = 0);
+    };
+}
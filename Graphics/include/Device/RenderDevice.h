@@ -0,0 +1,347 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// the same as Windows.h, the renderer uses them everywhere
+typedef unsigned int UINT;
+typedef int INT;
+
+namespace Graphics
+{
+    class ShaderCompiler;
+
+    // Everything a RenderDevice creates, freed with Release() (SAFE_RELEASE)
+    class DeviceObject
+    {
+    public:
+        virtual void Release() = 0;
+    protected:
+        virtual ~DeviceObject() {}
+    };
+
+    class GpuResource : public DeviceObject {};
+    class GpuBuffer : public GpuResource {};
+    class GpuTexture : public GpuResource {};
+
+    class ShaderResourceView : public DeviceObject {};
+    class UnorderedAccessView : public DeviceObject {};
+    class RenderTargetView : public DeviceObject {};
+    class DepthStencilView : public DeviceObject {};
+
+    class InputLayout : public DeviceObject {};
+    class GpuVertexShader : public DeviceObject {};
+    class GpuPixelShader : public DeviceObject {};
+    class GpuComputeShader : public DeviceObject {};
+
+    class SamplerState : public DeviceObject {};
+    class RasterizerState : public DeviceObject {};
+    class DepthStencilState : public DeviceObject {};
+    class BlendState : public DeviceObject {};
+
+    // The values are the DXGI and D3D11 ones, any DXGI format fits in a Format
+    enum Format : uint32_t
+    {
+        FORMAT_UNKNOWN = 0,
+        FORMAT_R32G32B32A32_FLOAT = 2,
+        FORMAT_R32G32B32A32_UINT = 3,
+        FORMAT_R32G32B32_FLOAT = 6,
+        FORMAT_R16G16B16A16_UNORM = 11,
+        FORMAT_R32G32_FLOAT = 16,
+        FORMAT_R32G32_UINT = 17,
+        FORMAT_R8G8B8A8_UNORM = 28,
+        FORMAT_R16G16_FLOAT = 34,
+        FORMAT_R16G16_SNORM = 37,
+        FORMAT_R32_TYPELESS = 39,
+        FORMAT_D32_FLOAT = 40,
+        FORMAT_R32_FLOAT = 41,
+        FORMAT_R32_UINT = 42,
+        FORMAT_R16_UINT = 57,
+        FORMAT_R8_UINT = 62,
+        FORMAT_BC1_UNORM = 71,
+        FORMAT_BC3_UNORM = 77,
+        FORMAT_BC4_UNORM = 80,
+        FORMAT_BC5_UNORM = 83,
+        FORMAT_BC7_UNORM = 98
+    };
+
+    enum PrimitiveTopology
+    {
+        TOPOLOGY_POINTLIST = 1,
+        TOPOLOGY_LINELIST = 2,
+        TOPOLOGY_LINESTRIP = 3,
+        TOPOLOGY_TRIANGLELIST = 4,
+        TOPOLOGY_TRIANGLESTRIP = 5
+    };
+
+    enum Usage
+    {
+        USAGE_DEFAULT = 0,
+        USAGE_IMMUTABLE = 1,
+        USAGE_DYNAMIC = 2,
+        USAGE_STAGING = 3
+    };
+
+    enum BindFlag
+    {
+        BIND_VERTEX_BUFFER = 0x1,
+        BIND_INDEX_BUFFER = 0x2,
+        BIND_CONSTANT_BUFFER = 0x4,
+        BIND_SHADER_RESOURCE = 0x8,
+        BIND_RENDER_TARGET = 0x20,
+        BIND_DEPTH_STENCIL = 0x40,
+        BIND_UNORDERED_ACCESS = 0x80
+    };
+
+    enum CpuAccessFlag
+    {
+        CPU_ACCESS_WRITE = 0x10000,
+        CPU_ACCESS_READ = 0x20000
+    };
+
+    enum ClearFlag
+    {
+        CLEAR_DEPTH = 0x1,
+        CLEAR_STENCIL = 0x2
+    };
+
+    enum Filter
+    {
+        FILTER_MIN_MAG_MIP_POINT = 0,
+        FILTER_MIN_MAG_MIP_LINEAR = 0x15,
+        FILTER_ANISOTROPIC = 0x55,
+        FILTER_COMPARISON_MIN_MAG_MIP_LINEAR = 0x95
+    };
+
+    enum AddressMode
+    {
+        ADDRESS_WRAP = 1,
+        ADDRESS_MIRROR = 2,
+        ADDRESS_CLAMP = 3,
+        ADDRESS_BORDER = 4
+    };
+
+    enum ComparisonFunc
+    {
+        COMPARISON_NEVER = 1,
+        COMPARISON_LESS = 2,
+        COMPARISON_EQUAL = 3,
+        COMPARISON_LESS_EQUAL = 4,
+        COMPARISON_GREATER = 5,
+        COMPARISON_NOT_EQUAL = 6,
+        COMPARISON_GREATER_EQUAL = 7,
+        COMPARISON_ALWAYS = 8
+    };
+
+    enum CullMode
+    {
+        CULL_NONE = 1,
+        CULL_FRONT = 2,
+        CULL_BACK = 3
+    };
+
+    enum Blend
+    {
+        BLEND_ZERO = 1,
+        BLEND_ONE = 2,
+        BLEND_SRC_COLOR = 3,
+        BLEND_INV_SRC_COLOR = 4,
+        BLEND_SRC_ALPHA = 5,
+        BLEND_INV_SRC_ALPHA = 6,
+        BLEND_DEST_ALPHA = 7,
+        BLEND_INV_DEST_ALPHA = 8
+    };
+
+    enum BlendOp
+    {
+        BLEND_OP_ADD = 1,
+        BLEND_OP_SUBTRACT = 2,
+        BLEND_OP_MIN = 4,
+        BLEND_OP_MAX = 5
+    };
+
+    struct BufferDesc
+    {
+        UINT byteWidth;
+        Usage usage;
+        UINT bindFlags;         // BindFlag
+        UINT cpuAccessFlags;    // CpuAccessFlag
+        UINT structureStride;   // a structured buffer if not 0
+    };
+
+    struct TextureDesc
+    {
+        UINT width;
+        UINT height;
+        UINT mipLevels;         // 0 is the full chain
+        UINT arraySize;
+        Format format;
+        Usage usage;
+        UINT bindFlags;
+        UINT cpuAccessFlags;
+        bool generateMips;      // GenerateMips works on it, needs BIND_RENDER_TARGET
+    };
+
+    // one per mip and slice, mip 0 of slice 0 first
+    struct SubresourceData
+    {
+        const void * data;
+        UINT rowPitch;
+    };
+
+    struct InputElement
+    {
+        static const UINT APPEND_ALIGNED = 0xffffffff;
+
+        const char * semantic;
+        UINT semanticIndex;
+        Format format;
+        UINT slot;
+        UINT offset;            // APPEND_ALIGNED is right after the one before
+    };
+
+    // the layout of D3D11_VIEWPORT
+    struct Viewport
+    {
+        float x, y;
+        float width, height;
+        float minDepth, maxDepth;
+    };
+
+    struct SamplerDesc
+    {
+        Filter filter;
+        AddressMode address;    // u, v and w
+        ComparisonFunc comparison;
+        float borderColor[4];
+        UINT maxAnisotropy;
+    };
+
+    struct RasterizerDesc
+    {
+        CullMode cull;
+        bool wireframe;
+        bool depthClip;
+    };
+
+    struct DepthStencilDesc
+    {
+        bool depthEnable;
+        bool depthWrite;
+        ComparisonFunc depthFunc;
+    };
+
+    // the first render target, the others are the same
+    struct BlendDesc
+    {
+        bool enable;
+        Blend src, dest;
+        BlendOp op;
+        Blend srcAlpha, destAlpha;
+        BlendOp opAlpha;
+        uint8_t writeMask;
+    };
+
+    /*
+        Everything the renderer creates and does to the GPU goes through
+        this, so the frame can be sent to D3D11 (D3D11RenderDevice) or
+        recorded without a GPU at all (NullRenderDevice). Nothing here
+        needs d3d11.h, the objects are the handles above and the enums
+        have the D3D11 values.
+
+        Every function is named like the ID3D11Device or
+        ID3D11DeviceContext one it stands for, the context ones take the
+        same arguments too. The Create functions throw when the device
+        can't create what was asked for, like ThrowIfFailed.
+    */
+    class RenderDevice
+    {
+    public:
+        static const UINT ALL_SLICES = 0xffffffff;
+
+        virtual ~RenderDevice() {}
+
+        // initialData is byteWidth bytes or nullptr
+        virtual GpuBuffer * CreateBuffer(BufferDesc const & desc, const void * initialData) = 0;
+        // initialData has mipLevels * arraySize subresources or is nullptr
+        virtual GpuTexture * CreateTexture(TextureDesc const & desc, const SubresourceData * initialData) = 0;
+        virtual TextureDesc GetDesc(GpuTexture * texture) = 0;
+
+        // every element of a structured buffer
+        virtual ShaderResourceView * CreateShaderResourceView(GpuBuffer * buffer) = 0;
+        // every mip, and every slice as an array if it has more than one.
+        // FORMAT_UNKNOWN is the format of the texture
+        virtual ShaderResourceView * CreateShaderResourceView(GpuTexture * texture, Format format = FORMAT_UNKNOWN) = 0;
+        virtual UnorderedAccessView * CreateUnorderedAccessView(GpuBuffer * buffer) = 0;
+        virtual UnorderedAccessView * CreateUnorderedAccessView(GpuTexture * texture) = 0;
+        virtual RenderTargetView * CreateRenderTargetView(GpuTexture * texture) = 0;
+        // one slice of the texture, ALL_SLICES is all of them
+        virtual DepthStencilView * CreateDepthStencilView(GpuTexture * texture, Format format, UINT slice = ALL_SLICES) = 0;
+
+        virtual GpuVertexShader * CreateVertexShader(const void * bytecode, size_t bytes) = 0;
+        virtual GpuPixelShader * CreatePixelShader(const void * bytecode, size_t bytes) = 0;
+        virtual GpuComputeShader * CreateComputeShader(const void * bytecode, size_t bytes) = 0;
+        // bytecode is the vertex shader the layout is used with
+        virtual InputLayout * CreateInputLayout(const InputElement * elements, UINT count, const void * bytecode, size_t bytes) = 0;
+
+        virtual SamplerState * CreateSamplerState(SamplerDesc const & desc) = 0;
+        virtual RasterizerState * CreateRasterizerState(RasterizerDesc const & desc) = 0;
+        virtual DepthStencilState * CreateDepthStencilState(DepthStencilDesc const & desc) = 0;
+        virtual BlendState * CreateBlendState(BlendDesc const & desc) = 0;
+
+        // What compiles the shaders for this device. nullptr if it doesn't
+        // need any, the shaders are created from empty bytecode then
+        virtual ShaderCompiler * GetShaderCompiler() = 0;
+        // D3D 11.0 can't MapNoOverwrite a buffer with a shader resource view
+        virtual bool SupportsNoOverwriteSRV() = 0;
+
+        // Maps with D3D11_MAP_WRITE_DISCARD, bytes is how much will be written
+        virtual void * Map(GpuResource * resource, UINT bytes) = 0;
+        // Maps with D3D11_MAP_WRITE_NO_OVERWRITE, returns the memory at offset.
+        // Only write where the GPU isn't reading this frame
+        virtual void * MapNoOverwrite(GpuResource * resource, UINT offset, UINT bytes) = 0;
+        virtual void Unmap(GpuResource * resource) = 0;
+        // UpdateSubresource of [offset, offset + bytes) in a buffer with USAGE_DEFAULT
+        virtual void UpdateBuffer(GpuResource * resource, UINT offset, UINT bytes, const void * data) = 0;
+        virtual void CopyResource(GpuResource * destination, GpuResource * source) = 0;
+        // UpdateSubresource of a whole mip of a texture with USAGE_DEFAULT
+        virtual void UpdateTexture(GpuTexture * texture, UINT mip, const void * data, UINT rowPitch) = 0;
+        // every mip from the first one, the texture needs generateMips
+        virtual void GenerateMips(ShaderResourceView * view) = 0;
+
+        virtual void ClearRenderTargetView(RenderTargetView * renderTarget, const float color[4]) = 0;
+        virtual void ClearDepthStencilView(DepthStencilView * depthStencil, UINT flags, float depth, uint8_t stencil) = 0;
+
+        virtual void Draw(UINT vertexCount, UINT startVertex) = 0;
+        virtual void DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance) = 0;
+        virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) = 0;
+        virtual void Dispatch(UINT x, UINT y, UINT z) = 0;
+
+        virtual void IASetInputLayout(InputLayout * inputLayout) = 0;
+        virtual void IASetPrimitiveTopology(PrimitiveTopology topology) = 0;
+        virtual void IASetVertexBuffers(UINT slot, UINT count, GpuBuffer * const * buffers, const UINT * strides, const UINT * offsets) = 0;
+        virtual void IASetIndexBuffer(GpuBuffer * buffer, Format format, UINT offset) = 0;
+
+        virtual void VSSetShader(GpuVertexShader * shader) = 0;
+        virtual void PSSetShader(GpuPixelShader * shader) = 0;
+        virtual void CSSetShader(GpuComputeShader * shader) = 0;
+
+        virtual void VSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers) = 0;
+        virtual void PSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers) = 0;
+        virtual void CSSetConstantBuffers(UINT slot, UINT count, GpuBuffer * const * buffers) = 0;
+
+        virtual void VSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views) = 0;
+        virtual void PSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views) = 0;
+        virtual void CSSetShaderResources(UINT slot, UINT count, ShaderResourceView * const * views) = 0;
+        virtual void CSSetUnorderedAccessViews(UINT slot, UINT count, UnorderedAccessView * const * views, const UINT * initialCounts) = 0;
+
+        virtual void PSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers) = 0;
+        virtual void CSSetSamplers(UINT slot, UINT count, SamplerState * const * samplers) = 0;
+
+        virtual void RSSetViewports(UINT count, const Viewport * viewports) = 0;
+        virtual void RSSetState(RasterizerState * state) = 0;
+
+        virtual void OMSetRenderTargets(UINT count, RenderTargetView * const * renderTargets, DepthStencilView * depthStencil) = 0;
+        virtual void OMSetDepthStencilState(DepthStencilState * state, UINT stencilRef) = 0;
+        virtual void OMSetBlendState(BlendState * state, const float blendFactor[4], UINT sampleMask) = 0;
+    };
+}
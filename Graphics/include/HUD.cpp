@@ -1,30 +1,34 @@
-#include "HUD.H"
-#include <WICTextureLoader.h>
-
-Graphics::HUD::HUD(ID3D11Device * device, ID3D11DeviceContext * context)
-:shader(device, SHADER_PATH("GUIShader.hlsl"), { { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA },{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 8, D3D11_INPUT_PER_VERTEX_DATA } ,{ "ELEMENT", 0, DXGI_FORMAT_R32_UINT, 0, 16, D3D11_INPUT_PER_VERTEX_DATA } })
+#include "HUD.h"
+#include "Resources/TextureManager.h"
+#include "Resources/VirtualFileSystem.h"
+#ifdef _WIN32
+#include "Device/D3D11RenderDevice.h"
+#endif
+
+Graphics::HUD::HUD(Graphics::RenderDevice * device, TextureResidency & residency)
+:batch(device, residency, TextureResidency::SCOPE_HUD)
+,states(std::make_unique<CommonStates>(device))
+,currentInfo(nullptr)
 {
-    createHUDTextures(device, context);
-    createHUDVBS(device);
     setHUDTextRenderPos();
-   sFont[0] = std::make_unique<DirectX::SpriteFont>(device, L"Resources/Fonts/comicsans.spritefont");
-   sBatch = std::make_unique<DirectX::SpriteBatch>(context);
+#ifdef _WIN32
+   if (D3D11RenderDevice * d3d = dynamic_cast<D3D11RenderDevice *>(device))
+   {
+       std::vector<char> font;
+       VirtualFileSystem::singleton().read("Resources/Fonts/comicsans.spritefont", font);
+       sFont[0] = std::make_unique<DirectX::SpriteFont>(d3d->getDevice(), (const uint8_t*)font.data(), font.size());
+       sBatch = std::make_unique<DirectX::SpriteBatch>(d3d->getContext());
+   }
+#endif
 }
 
 Graphics::HUD::~HUD()
 {
-    SAFE_RELEASE(vertexBuffer);
-    SAFE_RELEASE(crosshair);
-    SAFE_RELEASE(HP);
 }
 
-void Graphics::HUD::drawHUD(ID3D11DeviceContext * context, ID3D11RenderTargetView * backBuffer, ID3D11BlendState * blendState)
+void Graphics::HUD::drawHUD(Graphics::RenderDevice * context, Graphics::RenderTargetView * backBuffer, Graphics::BlendState * blendState)
 {
     renderText(blendState);
-    UINT stride = 20, offset = 0;
-    context->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
-    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    context->IASetInputLayout(shader);
 
     float blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
     UINT sampleMask = 0xffffffff;
@@ -32,15 +36,10 @@ void Graphics::HUD::drawHUD(ID3D11DeviceContext * context, ID3D11RenderTargetVie
  
     context->OMSetRenderTargets(1, &backBuffer, nullptr);
 
-    context->VSSetShader(shader, nullptr, 0);
-
-    context->PSSetShaderResources(0, 1, &crosshair);
-    context->PSSetShaderResources(1, 1, &HP);
-    context->PSSetShader(shader, nullptr, 0);
-
-    context->Draw(12, 0);
-    ID3D11ShaderResourceView * SRVNULL = nullptr;
-    context->PSSetShaderResources(0, 1, &SRVNULL);
+    // where the quads were in NDC, the crosshair in the middle and the HP bar in the bottom left corner
+    batch.add("crosshair", WIN_WIDTH * 0.475f, WIN_HEIGHT * 0.475f, WIN_WIDTH * 0.05f, WIN_HEIGHT * 0.05f);
+    batch.add("HPbar", 0.f, WIN_HEIGHT * 0.9f, WIN_WIDTH * 0.1f, WIN_HEIGHT * 0.1f);
+    batch.draw(context, states->LinearClamp());
 }
 
 void Graphics::HUD::queueText(Graphics::TextString * text)
@@ -53,90 +52,16 @@ void Graphics::HUD::fillHUDInfo(HUDInfo * info)
     currentInfo = info;
 }
 
-void Graphics::HUD::createHUDVBS(ID3D11Device * device)
+void Graphics::HUD::renderText(Graphics::BlendState * blendState)
 {
-    struct GUI
+#ifdef _WIN32
+    if (!sBatch)
     {
-        DirectX::SimpleMath::Vector2 verts;
-        DirectX::SimpleMath::Vector2 uv;
-        UINT element;
-    };
-
-    GUI GUIquad[12];
-    GUIquad[0].verts = DirectX::SimpleMath::Vector2{ -0.05f, -0.05f };
-    GUIquad[0].uv = DirectX::SimpleMath::Vector2{ 0.0f, 1.0f };
-
-    GUIquad[1].verts = DirectX::SimpleMath::Vector2{ -0.05f, 0.05f };
-    GUIquad[1].uv = DirectX::SimpleMath::Vector2{ 0.0f, 0.0f };
-
-    GUIquad[2].verts = DirectX::SimpleMath::Vector2{ 0.05f, -0.05f };
-    GUIquad[2].uv = DirectX::SimpleMath::Vector2{ 1.0f, 1.0f };
-
-    GUIquad[3].verts = DirectX::SimpleMath::Vector2{ 0.05f, 0.05f };
-    GUIquad[3].uv = DirectX::SimpleMath::Vector2{ 1.0f, 0.0f };
-
-    GUIquad[4].verts = GUIquad[2].verts;
-    GUIquad[4].uv = DirectX::SimpleMath::Vector2{ 1.0f, 1.0f };
-
-    GUIquad[5].verts = GUIquad[1].verts;
-    GUIquad[5].uv = DirectX::SimpleMath::Vector2{ 0.0f, 0.0f };
-
-    GUIquad[0].element = 0;
-    GUIquad[1].element = 0;
-    GUIquad[2].element = 0;
-    GUIquad[3].element = 0;
-    GUIquad[4].element = 0;
-    GUIquad[5].element = 0;
-
-
-    GUIquad[6].verts = DirectX::SimpleMath::Vector2{ -1.0f, -1.0f };
-    GUIquad[6].uv = DirectX::SimpleMath::Vector2{ 0.0f, 1.0f };
-
-    GUIquad[7].verts = DirectX::SimpleMath::Vector2{ -1.0f, -0.8f };
-    GUIquad[7].uv = DirectX::SimpleMath::Vector2{ 0.0f, 0.0f };
-
-    GUIquad[8].verts = DirectX::SimpleMath::Vector2{ -0.8f, -1.0f };
-    GUIquad[8].uv = DirectX::SimpleMath::Vector2{ 1.0f, 1.0f };
-
-    GUIquad[9].verts = DirectX::SimpleMath::Vector2{ -0.8f, -0.8f };
-    GUIquad[9].uv = DirectX::SimpleMath::Vector2{ 1.0f, 0.0f };
-
-    GUIquad[10].verts = GUIquad[8].verts;
-    GUIquad[10].uv = DirectX::SimpleMath::Vector2{ 1.0f, 1.0f };
-
-    GUIquad[11].verts = GUIquad[7].verts;
-    GUIquad[11].uv = DirectX::SimpleMath::Vector2{ 0.0f, 0.0f };
-
-    GUIquad[6].element = 1;
-    GUIquad[7].element = 1;
-    GUIquad[8].element = 1;
-    GUIquad[9].element = 1;
-    GUIquad[10].element = 1;
-    GUIquad[11].element = 1;
-
-    D3D11_BUFFER_DESC desc;
-    ZeroMemory(&desc, sizeof(D3D11_BUFFER_DESC));
-
-    desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    desc.ByteWidth = sizeof(GUIquad);
-
-    D3D11_SUBRESOURCE_DATA data;
-    ZeroMemory(&data, sizeof(D3D11_SUBRESOURCE_DATA));
-    data.pSysMem = GUIquad;
-
-
-    ThrowIfFailed(device->CreateBuffer(&desc, &data, &vertexBuffer));
-}
-
-void Graphics::HUD::createHUDTextures(ID3D11Device * device, ID3D11DeviceContext * context)
-{
-    ThrowIfFailed(DirectX::CreateWICTextureFromFile(device, context, TEXTURE_PATH("crosshair.png"), nullptr, &crosshair));
-    ThrowIfFailed(DirectX::CreateWICTextureFromFile(device, context, TEXTURE_PATH("HPbar.png"), nullptr, &HP));
-}
+        textQueue.clear();
+        return;
+    }
 
-void Graphics::HUD::renderText(ID3D11BlendState * blendState)
-{
-    sBatch->Begin(DirectX::SpriteSortMode_Deferred, blendState);
+    sBatch->Begin(DirectX::SpriteSortMode_Deferred, D3D11RenderDevice::get(blendState));
 
     for (size_t i = 0; i < textQueue.size(); i++)
     {
@@ -149,6 +74,9 @@ void Graphics::HUD::renderText(ID3D11BlendState * blendState)
     renderHUDText();
 
     sBatch->End();
+#else
+    textQueue.clear();
+#endif
 }
 
 void Graphics::HUD::setHUDTextRenderPos()
@@ -163,6 +91,10 @@ void Graphics::HUD::setHUDTextRenderPos()
 
 void Graphics::HUD::renderHUDText()
 {   
+#ifdef _WIN32
+    if (!currentInfo)
+        return;
+
     if (!currentInfo->sledge)
     {
         std::wstring temp = std::to_wstring(currentInfo->cuttleryAmmo[0]);
@@ -193,5 +125,5 @@ void Graphics::HUD::renderHUDText()
 
         sFont[0]->DrawString(sBatch.get(), temp.c_str(), ammoPos2, DirectX::Colors::Red);
     }
-}
-
+#endif
+}
\ No newline at end of file
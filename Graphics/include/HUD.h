@@ -1,38 +1,45 @@
 #pragma once
-#include "Resources\Shader.h"
-#include <Engine\Constants.h>
-#include "Utility\ShaderResource.h"
-#include <CommonStates.h>
+#include "Resources/Shader.h"
+#include <Engine/Constants.h>
+#include "Utility/ShaderResource.h"
+#include "Device/CommonStates.h"
 #include "Structs.h"
+#include "Device/RenderDevice.h"
+#include "Resources/TextureResidency.h"
+#include "Utility/UIBatch.h"
+#include <memory>
+#include <vector>
+#ifdef _WIN32
 #include <SpriteFont.h>
 #include <SpriteBatch.h>
-#include <vector>
+#endif
 
 namespace Graphics
 {
     class HUD
     {
     public:
-        HUD(ID3D11Device * device, ID3D11DeviceContext * context);
+        // the textures are in the SCOPE_HUD of residency. The text is drawn
+        // with DirectXTK's SpriteFont, only on a D3D11RenderDevice
+        HUD(RenderDevice * device, TextureResidency & residency);
         ~HUD();
-        void drawHUD(ID3D11DeviceContext * context, ID3D11RenderTargetView * backBuffer, ID3D11BlendState * blendState);
+        void drawHUD(RenderDevice * context, RenderTargetView * backBuffer, BlendState * blendState);
         void queueText(Graphics::TextString * text);
         void fillHUDInfo(HUDInfo * info);
 
     private:
-        void createHUDVBS(ID3D11Device * device);
-        void createHUDTextures(ID3D11Device * device, ID3D11DeviceContext * context);
-        void renderText(ID3D11BlendState * blendState);
+        void renderText(BlendState * blendState);
         void setHUDTextRenderPos();
         void renderHUDText();
 
-        Shader shader;
-        ID3D11ShaderResourceView *crosshair;
-        ID3D11ShaderResourceView *HP;
-        ID3D11Buffer * vertexBuffer;
+        // the crosshair and the HP bar from the UI atlas
+        UIBatch batch;
+        std::unique_ptr<CommonStates> states;
 
+#ifdef _WIN32
         std::unique_ptr<DirectX::SpriteFont> sFont[5];
         std::unique_ptr<DirectX::SpriteBatch> sBatch;
+#endif
 
         std::vector<TextString> textQueue;
         HUDInfo * currentInfo;
@@ -0,0 +1,98 @@
+#include "ClusteredLightGrid.h"
+#include <Engine/Constants.h>
+#include <string.h>
+
+namespace Graphics {
+
+	ClusteredLightGrid::ClusteredLightGrid(RenderDevice *device)
+		: m_Clusters(0, 0, CLUSTER_TILE_SIZE, CLUSTER_SLICES)
+		, m_Lights(device, CpuAccess::Write, MAX_LIGHTS)
+		, m_Params(device)
+	{
+		m_Device = device;
+		m_Width = 0;
+		m_Height = 0;
+		m_TileSize = CLUSTER_TILE_SIZE;
+		m_ProjectionSet = false;
+		m_Grid = nullptr;
+		m_LightCount = 0;
+
+		m_IndexCapacity = CLUSTER_INDEX_START_CAPACITY;
+		m_IndexList = newd StructuredBuffer<uint32_t>(device, CpuAccess::Write, m_IndexCapacity);
+
+		m_ClusterLights.reserve(MAX_LIGHTS);
+	}
+
+	ClusteredLightGrid::~ClusteredLightGrid()
+	{
+		delete m_IndexList;
+		delete m_Grid;
+	}
+
+	void ClusteredLightGrid::resize(UINT width, UINT height, UINT tileSize)
+	{
+		m_Width = width;
+		m_Height = height;
+		m_TileSize = tileSize > 0 ? tileSize : 1;
+
+		m_Clusters = LightClusters(m_Width, m_Height, m_TileSize, CLUSTER_SLICES);
+		m_ProjectionSet = false;
+
+		delete m_Grid;
+		m_Grid = newd StructuredBuffer<LightClusters::Range>(m_Device, CpuAccess::Write, m_Clusters.getClusterCount());
+	}
+
+	void ClusteredLightGrid::update(RenderDevice *cxt, Camera *camera, std::vector<Light> const &lights)
+	{
+		DirectX::SimpleMath::Matrix projection = camera->getProj();
+		if (!m_ProjectionSet || projection != m_Projection) {
+			m_Clusters.setProjection(&projection._11);
+			m_Projection = projection;
+			m_ProjectionSet = true;
+
+			LightClusters::Params params = m_Clusters.getParams();
+			m_Params.write(cxt, &params, sizeof(params));
+		}
+
+		m_LightCount = lights.size() < MAX_LIGHTS ? (UINT)lights.size() : MAX_LIGHTS;
+
+		m_ClusterLights.resize(m_LightCount);
+		for (UINT i = 0; i < m_LightCount; i++) {
+			m_ClusterLights[i] = {
+				{ lights[i].positionWS.x, lights[i].positionWS.y, lights[i].positionWS.z },
+				lights[i].range
+			};
+		}
+
+		DirectX::SimpleMath::Matrix view = camera->getView();
+		m_Clusters.assign(&view._11, m_ClusterLights.data(), m_LightCount);
+
+		if (m_LightCount > 0) {
+			Light *ptr = m_Lights.map(cxt);
+			memcpy(ptr, lights.data(), sizeof(Light) * m_LightCount);
+			m_Lights.unmap(cxt);
+		}
+
+		std::vector<LightClusters::Range> const &grid = m_Clusters.getGrid();
+		LightClusters::Range *gridPtr = m_Grid->map(cxt);
+		memcpy(gridPtr, grid.data(), sizeof(LightClusters::Range) * grid.size());
+		m_Grid->unmap(cxt);
+
+		// the index list grows with the lights, it never shrinks
+		std::vector<uint32_t> const &indices = m_Clusters.getIndexList();
+		if (indices.size() > m_IndexCapacity) {
+			while (m_IndexCapacity < indices.size())
+				m_IndexCapacity *= 2;
+
+			delete m_IndexList;
+			m_IndexList = newd StructuredBuffer<uint32_t>(m_Device, CpuAccess::Write, m_IndexCapacity);
+		}
+
+		if (!indices.empty()) {
+			uint32_t *indexPtr = m_IndexList->map(cxt);
+			memcpy(indexPtr, indices.data(), sizeof(uint32_t) * indices.size());
+			m_IndexList->unmap(cxt);
+		}
+	}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SimpleMath.h>
+#include <vector>
+#include "../Camera.h"
+#include "../Structs.h"
+#include "../Utility/StructuredBuffer.h"
+#include "../Utility/ConstantBuffer.h"
+#include "LightClusters.h"
+
+#define CLUSTER_TILE_SIZE 64
+#define CLUSTER_SLICES 24
+#define CLUSTER_INDEX_START_CAPACITY 4096
+
+namespace Graphics {
+
+	/*
+		GPU side of LightClusters. The lights are assigned on the CPU every
+		frame and uploaded with the cluster grid and index list, for
+		ForwardPlus.hlsl compiled with CLUSTERED.
+
+		Registers (ForwardPlus.hlsl):
+			t0: light index list  (StructuredBuffer<uint>)
+			t1: cluster grid      (StructuredBuffer<uint2>, offset and count)
+			t2: lights            (StructuredBuffer<Light>)
+			b4: cluster params    (LightClusters::Params)
+	*/
+	class ClusteredLightGrid {
+	public:
+		ClusteredLightGrid(RenderDevice *device);
+		virtual ~ClusteredLightGrid();
+
+		// the clusters cover width * height pixels (the back buffer), has to be called before update
+		void resize(UINT width, UINT height, UINT tileSize = CLUSTER_TILE_SIZE);
+
+		// any number of lights, more than MAX_LIGHTS are dropped
+		void update(RenderDevice *cxt, Camera *camera, std::vector<Light> const &lights);
+
+		UINT getWidth() const { return m_Width; }
+		UINT getHeight() const { return m_Height; }
+		UINT getTileSize() const { return m_TileSize; }
+		LightClusters const &getClusters() const { return m_Clusters; }
+
+		ShaderResourceView *getIndexListSRV() const { return m_IndexList->getSRV(); }
+		ShaderResourceView *getGridSRV() const { return m_Grid ? m_Grid->getSRV() : nullptr; }
+		ShaderResourceView *getLightsSRV() const { return m_Lights.getSRV(); }
+		GpuBuffer *getParamsBuffer() { return m_Params; }
+
+		UINT getLightCount() const { return m_LightCount; }
+		UINT getIndexCount() const { return (UINT)m_Clusters.getIndexList().size(); }
+	private:
+		RenderDevice *m_Device;
+		UINT m_Width;
+		UINT m_Height;
+		UINT m_TileSize;
+
+		LightClusters m_Clusters;
+		DirectX::SimpleMath::Matrix m_Projection;
+		bool m_ProjectionSet;
+		std::vector<LightClusters::ClusterLight> m_ClusterLights;
+		UINT m_LightCount;
+
+		StructuredBuffer<Light> m_Lights;
+		StructuredBuffer<LightClusters::Range> *m_Grid;
+		StructuredBuffer<uint32_t> *m_IndexList;
+		UINT m_IndexCapacity;
+		ConstantBuffer<LightClusters::Params> m_Params;
+	};
+
+}
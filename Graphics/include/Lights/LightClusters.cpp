@@ -0,0 +1,202 @@
+#include "LightClusters.h"
+#include <math.h>
+
+namespace Graphics {
+
+	namespace {
+		// v * M, M row major
+		void transform(const float v[4], const float m[16], float out[4])
+		{
+			for (int column = 0; column < 4; column++) {
+				out[column] =
+					v[0] * m[column] +
+					v[1] * m[4 + column] +
+					v[2] * m[8 + column] +
+					v[3] * m[12 + column];
+			}
+		}
+
+		float clampf(float value, float low, float high)
+		{
+			return value < low ? low : (value > high ? high : value);
+		}
+	}
+
+	LightClusters::LightClusters(uint32_t width, uint32_t height, uint32_t tileSize, uint32_t slices)
+	{
+		m_Width = width;
+		m_Height = height;
+		m_ScaleX = 1.f;
+		m_ScaleY = 1.f;
+
+		m_Params = {};
+		m_Params.tilesX = (width + tileSize - 1) / tileSize;
+		m_Params.tilesY = (height + tileSize - 1) / tileSize;
+		m_Params.slices = slices;
+		m_Params.tileSize = tileSize;
+
+		m_Bounds.resize(m_Params.tilesX * m_Params.tilesY * slices);
+		m_Grid.resize(m_Bounds.size());
+	}
+
+	LightClusters::~LightClusters()
+	{
+	}
+
+	void LightClusters::setProjection(const float proj[16])
+	{
+		// right handed perspective: _33 = f / (n - f), _43 = n * f / (n - f)
+		m_ScaleX = proj[0];
+		m_ScaleY = proj[5];
+		m_Params.nearZ = proj[14] / proj[10];
+		m_Params.farZ = proj[14] / (proj[10] + 1.f);
+
+		float logRange = logf(m_Params.farZ / m_Params.nearZ);
+		m_Params.sliceScale = m_Params.slices / logRange;
+		m_Params.sliceBias = -(m_Params.slices * logf(m_Params.nearZ)) / logRange;
+
+		for (uint32_t slice = 0; slice < m_Params.slices; slice++) {
+			float depths[2] = {
+				m_Params.nearZ * powf(m_Params.farZ / m_Params.nearZ, slice / (float)m_Params.slices),
+				m_Params.nearZ * powf(m_Params.farZ / m_Params.nearZ, (slice + 1) / (float)m_Params.slices)
+			};
+
+			for (uint32_t y = 0; y < m_Params.tilesY; y++) {
+				for (uint32_t x = 0; x < m_Params.tilesX; x++) {
+					float ndcX[2] = {
+						x * m_Params.tileSize / (float)m_Width * 2.f - 1.f,
+						(x + 1) * m_Params.tileSize / (float)m_Width * 2.f - 1.f
+					};
+					float ndcY[2] = {
+						1.f - y * m_Params.tileSize / (float)m_Height * 2.f,
+						1.f - (y + 1) * m_Params.tileSize / (float)m_Height * 2.f
+					};
+
+					Bounds &bounds = m_Bounds[x + (y + slice * m_Params.tilesY) * m_Params.tilesX];
+					for (int axis = 0; axis < 3; axis++) {
+						bounds.min[axis] = INFINITY;
+						bounds.max[axis] = -INFINITY;
+					}
+
+					// the 8 corners of the frustum piece
+					for (float depth : depths) {
+						for (float nx : ndcX) {
+							for (float ny : ndcY) {
+								float corner[3] = { nx * depth / m_ScaleX, ny * depth / m_ScaleY, -depth };
+								for (int axis = 0; axis < 3; axis++) {
+									bounds.min[axis] = fminf(bounds.min[axis], corner[axis]);
+									bounds.max[axis] = fmaxf(bounds.max[axis], corner[axis]);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	int LightClusters::getSlice(float depth) const
+	{
+		if (depth < m_Params.nearZ || depth > m_Params.farZ)
+			return -1;
+
+		int slice = (int)floorf(logf(depth) * m_Params.sliceScale + m_Params.sliceBias);
+		return slice < 0 ? 0 : (slice >= (int)m_Params.slices ? (int)m_Params.slices - 1 : slice);
+	}
+
+	void LightClusters::tileRange(float ndcMin, float ndcMax, uint32_t pixels, uint32_t tiles, bool flip, uint32_t &first, uint32_t &last) const
+	{
+		// screen y goes down, ndc y goes up
+		float low = flip ? (0.5f - ndcMax * 0.5f) : (ndcMin * 0.5f + 0.5f);
+		float high = flip ? (0.5f - ndcMin * 0.5f) : (ndcMax * 0.5f + 0.5f);
+
+		float firstTile = floorf(clampf(low, 0.f, 1.f) * pixels / m_Params.tileSize);
+		float lastTile = floorf(clampf(high, 0.f, 1.f) * pixels / m_Params.tileSize);
+
+		first = (uint32_t)firstTile;
+		last = (uint32_t)lastTile < tiles ? (uint32_t)lastTile : tiles - 1;
+	}
+
+	void LightClusters::assign(const float view[16], const ClusterLight *lights, size_t lightCount)
+	{
+		m_Assignments.clear();
+
+		for (uint32_t i = 0; i < lightCount; i++) {
+			float radius = lights[i].range;
+			if (radius <= 0.f)
+				continue;
+
+			float position[4] = { lights[i].position[0], lights[i].position[1], lights[i].position[2], 1.f };
+			float center[4];
+			transform(position, view, center);
+
+			float depth = -center[2];
+			if (depth + radius < m_Params.nearZ || depth - radius > m_Params.farZ)
+				continue;
+
+			float nearest = fmaxf(depth - radius, m_Params.nearZ);
+			float farthest = fminf(depth + radius, m_Params.farZ);
+
+			// the screen rect of the sphere, x / depth is largest at the corners of the box around it
+			float ndcMin[2] = { INFINITY, INFINITY }, ndcMax[2] = { -INFINITY, -INFINITY };
+			float scale[2] = { m_ScaleX, m_ScaleY };
+			for (int axis = 0; axis < 2; axis++) {
+				for (float side : { -radius, radius }) {
+					for (float d : { nearest, farthest }) {
+						float ndc = (center[axis] + side) * scale[axis] / d;
+						ndcMin[axis] = fminf(ndcMin[axis], ndc);
+						ndcMax[axis] = fmaxf(ndcMax[axis], ndc);
+					}
+				}
+			}
+
+			if (ndcMin[0] > 1.f || ndcMax[0] < -1.f || ndcMin[1] > 1.f || ndcMax[1] < -1.f)
+				continue;
+
+			uint32_t firstX, lastX, firstY, lastY;
+			tileRange(ndcMin[0], ndcMax[0], m_Width, m_Params.tilesX, false, firstX, lastX);
+			tileRange(ndcMin[1], ndcMax[1], m_Height, m_Params.tilesY, true, firstY, lastY);
+
+			uint32_t firstSlice = (uint32_t)getSlice(nearest);
+			uint32_t lastSlice = (uint32_t)getSlice(farthest);
+
+			for (uint32_t slice = firstSlice; slice <= lastSlice; slice++) {
+				for (uint32_t y = firstY; y <= lastY; y++) {
+					for (uint32_t x = firstX; x <= lastX; x++) {
+						uint32_t cluster = x + (y + slice * m_Params.tilesY) * m_Params.tilesX;
+						Bounds const &bounds = m_Bounds[cluster];
+
+						float distance = 0.f;
+						for (int axis = 0; axis < 3; axis++) {
+							float delta = clampf(center[axis], bounds.min[axis], bounds.max[axis]) - center[axis];
+							distance += delta * delta;
+						}
+
+						if (distance <= radius * radius)
+							m_Assignments.push_back({ cluster, i });
+					}
+				}
+			}
+		}
+
+		// counting sort by cluster, the lights stay in order inside one
+		for (Range &range : m_Grid)
+			range = { 0, 0 };
+		for (Assignment const &assignment : m_Assignments)
+			m_Grid[assignment.cluster].count++;
+
+		uint32_t offset = 0;
+		for (Range &range : m_Grid) {
+			range.offset = offset;
+			offset += range.count;
+			range.count = 0;
+		}
+
+		m_IndexList.resize(m_Assignments.size());
+		for (Assignment const &assignment : m_Assignments) {
+			Range &range = m_Grid[assignment.cluster];
+			m_IndexList[range.offset + range.count++] = assignment.light;
+		}
+	}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace Graphics {
+
+	/*
+		Clustered light assignment on the CPU. The view frustum is split in
+		screen tiles and exponential depth slices, every cluster gets a
+		compact list of the lights touching it. Unlike the 2D tiles a light
+		far behind something only ends up in the clusters around it, not in
+		every tile it covers on screen.
+
+		Cluster index is x + (y + slice * tilesY) * tilesX, the grid has
+		an (offset, count) range into the index list for each.
+
+		Slice of a view depth d (positive, in front of the camera):
+			slice = floor(log(d) * sliceScale + sliceBias)
+		so slice k starts at near * (far / near)^(k / slices).
+
+		Matrices are row major, vectors multiplied from the left (v * M),
+		right handed view with -z forward.
+
+		No D3D or SimpleMath in here on purpose.
+	*/
+	class LightClusters {
+	public:
+		// same layout as the ClusterParams cbuffer in ForwardPlus.hlsl
+		struct Params {
+			uint32_t tilesX, tilesY, slices, tileSize;
+			float nearZ, farZ, sliceScale, sliceBias;
+		};
+
+		struct Range {
+			uint32_t offset, count;
+		};
+
+		// world space, same as positionWS and range of Light
+		struct ClusterLight {
+			float position[3];
+			float range;
+		};
+
+		LightClusters(uint32_t width, uint32_t height, uint32_t tileSize, uint32_t slices);
+		virtual ~LightClusters();
+
+		// rebuilds the cluster bounds, only needed when the projection changes
+		void setProjection(const float proj[16]);
+
+		void assign(const float view[16], const ClusterLight *lights, size_t lightCount);
+
+		// -1 if the depth is outside near/far
+		int getSlice(float depth) const;
+
+		Params const &getParams() const { return m_Params; }
+		uint32_t getClusterCount() const { return (uint32_t)m_Grid.size(); }
+
+		std::vector<Range> const &getGrid() const { return m_Grid; }
+		std::vector<uint32_t> const &getIndexList() const { return m_IndexList; }
+
+	private:
+		struct Bounds {
+			float min[3], max[3];
+		};
+
+		struct Assignment {
+			uint32_t cluster, light;
+		};
+
+		uint32_t m_Width;
+		uint32_t m_Height;
+		float m_ScaleX;     // proj _11
+		float m_ScaleY;     // proj _22
+
+		Params m_Params;
+		std::vector<Bounds> m_Bounds;
+
+		std::vector<Assignment> m_Assignments;
+		std::vector<Range> m_Grid;
+		std::vector<uint32_t> m_IndexList;
+
+		void tileRange(float ndcMin, float ndcMax, uint32_t pixels, uint32_t tiles, bool flip, uint32_t &first, uint32_t &last) const;
+	};
+
+}
@@ -1,48 +1,51 @@
 #include "LightGrid.h"
-#include <WICTextureLoader.h>
-#include <Engine\Constants.h>
+#include "../Resources/TextureManager.h"
+#include <Engine/Constants.h>
+#include <string.h>
+#include <string>
 
 namespace Graphics {
 
 	LightGrid::LightGrid()
 	{
+		m_Width = 0;
+		m_Height = 0;
+		m_TileSize = 0;
+
+		m_ParamsBuffer = nullptr;
+		m_OpaqueIndexList = nullptr;
+		m_TransparentIndexList = nullptr;
+		m_Frustums = nullptr;
+		m_ResetIndexCounter = nullptr;
+		m_OpaqueIndexCounter = nullptr;
+		m_TransparentIndexCounter = nullptr;
+		m_Lights = nullptr;
+
+		m_DebugUAV = nullptr;
+		m_DebugSRV = nullptr;
+		m_OpaqueLightGridUAV = nullptr;
+		m_OpaqueLightGridSRV = nullptr;
+		m_TransparentLightGridUAV = nullptr;
+		m_TransparentLightGridSRV = nullptr;
+		gradientSRV = nullptr;
+
+		m_CullGrids = nullptr;
 	}
 
 	LightGrid::~LightGrid()
 	{
+		releaseSizedResources();
+
 		delete m_ResetIndexCounter;
 		delete m_OpaqueIndexCounter;
 		delete m_TransparentIndexCounter;
-		delete m_OpaqueIndexList;
-		delete m_TransparentIndexList;
-		delete m_Frustums;
 		delete m_Lights;
-		delete m_CullGrids;
-		delete m_FrustumGeneration;
-
-		SAFE_RELEASE(m_ParamsBuffer);
-
-		SAFE_RELEASE(m_DebugUAV);
-		SAFE_RELEASE(m_DebugSRV);
-
-		SAFE_RELEASE(m_OpaqueLightGridUAV);
-		SAFE_RELEASE(m_OpaqueLightGridSRV);
-
-		SAFE_RELEASE(m_TransparentLightGridUAV);
-		SAFE_RELEASE(m_TransparentLightGridSRV);
 
 		SAFE_RELEASE(gradientSRV);
 	}
 
-	void LightGrid::initialize(Camera *camera, ID3D11Device *device, ID3D11DeviceContext *cxt, ResourceManager *shaders)
+	void LightGrid::initialize(Camera *camera, RenderDevice *device, ResourceManager *shaders, UINT width, UINT height, UINT tileSize)
 	{
-		generateFrustumsCPU(camera, device);
-		//
-
-		//generateFrustums(camera, device, cxt, shaders);
-
-		m_CullGrids = newd ComputeShader(device, SHADER_PATH("LightGridCulling.hlsl"));
-		m_FrustumGeneration = newd ComputeShader(device, SHADER_PATH("LightGridGeneration.hlsl"));
 		Light lights[NUM_LIGHTS] = {};
 		lights[0].color = DirectX::SimpleMath::Vector3(1, 0, 0);
 		lights[0].positionWS = DirectX::SimpleMath::Vector3(1, 1, 1);
@@ -61,6 +64,36 @@ namespace Graphics {
 		m_OpaqueIndexCounter = new StructuredBuffer<uint32_t>(device, CpuAccess::None, 1, &initial);
 		m_TransparentIndexCounter = new StructuredBuffer<uint32_t>(device, CpuAccess::None, 1, &initial);
 
+		// only the debug heatmap samples it
+		if (!TextureManager::createTextureFromFile(device, TEXTURE_PATH_SIMPLE "heatmap.png", false, &gradientSRV))
+			gradientSRV = nullptr;
+
+		resize(camera, device, width, height, tileSize);
+	}
+
+	void LightGrid::resize(Camera *camera, RenderDevice *device, UINT width, UINT height, UINT tileSize)
+	{
+		releaseSizedResources();
+
+		m_Width = width;
+		m_Height = height;
+		m_TileSize = tileSize < MAX_TILE_SIZE ? tileSize : MAX_TILE_SIZE;
+
+		// the tile size is the thread group size, so the shaders are compiled for it
+		std::string blockSize = std::to_string(m_TileSize);
+		std::string widthDefine = std::to_string(m_Width);
+		std::string heightDefine = std::to_string(m_Height);
+		ShaderDefine defines[] = {
+			{ "BLOCK_SIZE", blockSize.c_str() },
+			{ "WIDTH", widthDefine.c_str() },
+			{ "HEIGHT", heightDefine.c_str() },
+			{ nullptr, nullptr }
+		};
+
+		m_CullGrids = newd ComputeShader(device, SHADER_PATH("LightGridCulling.hlsl"), defines);
+
+		generateFrustumsCPU(camera, device);
+
 		auto count = m_Params.numThreadGroups[0] * m_Params.numThreadGroups[1] * AVG_TILE_LIGHTS;
 		m_OpaqueIndexList = new StructuredBuffer<uint32_t>(device, CpuAccess::None, count, nullptr);
 		m_TransparentIndexList = new StructuredBuffer<uint32_t>(device, CpuAccess::None, count, nullptr);
@@ -68,37 +101,24 @@ namespace Graphics {
 
 #pragma region Light Grid UAVs
 		{
-			D3D11_TEXTURE2D_DESC desc = {};
-			desc.Format = DXGI_FORMAT_R32G32_UINT;
-			desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-			desc.Width = m_Params.numThreadGroups[0];
-			desc.Height = m_Params.numThreadGroups[1];
-			desc.SampleDesc.Count = 1;
-			desc.MipLevels = 1;
-			desc.ArraySize = 1;
-
-			D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-			ZeroMemory(&uavDesc, sizeof(uavDesc));
-			uavDesc.Format = DXGI_FORMAT_R32G32_UINT;
-			uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-
-			D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-			ZeroMemory(&srvDesc, sizeof(srvDesc));
-			srvDesc.Format = DXGI_FORMAT_R32G32_UINT;
-			srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-			srvDesc.Texture2D.MipLevels = 1;
-
-
-			ID3D11Texture2D *texture;
-
-			ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, &texture));
-			ThrowIfFailed(device->CreateUnorderedAccessView(texture, &uavDesc, &m_OpaqueLightGridUAV));
-			ThrowIfFailed(device->CreateShaderResourceView(texture, &srvDesc, &m_OpaqueLightGridSRV));
+			TextureDesc desc = {};
+			desc.format = FORMAT_R32G32_UINT;
+			desc.bindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+			desc.width = m_Params.numThreadGroups[0];
+			desc.height = m_Params.numThreadGroups[1];
+			desc.mipLevels = 1;
+			desc.arraySize = 1;
+
+			GpuTexture *texture;
+
+			texture = device->CreateTexture(desc, nullptr);
+			m_OpaqueLightGridUAV = device->CreateUnorderedAccessView(texture);
+			m_OpaqueLightGridSRV = device->CreateShaderResourceView(texture);
 			SAFE_RELEASE(texture);
 
-			ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, &texture));
-			ThrowIfFailed(device->CreateUnorderedAccessView(texture, &uavDesc, &m_TransparentLightGridUAV));
-			ThrowIfFailed(device->CreateShaderResourceView(texture, &srvDesc, &m_TransparentLightGridSRV));
+			texture = device->CreateTexture(desc, nullptr);
+			m_TransparentLightGridUAV = device->CreateUnorderedAccessView(texture);
+			m_TransparentLightGridSRV = device->CreateShaderResourceView(texture);
 			SAFE_RELEASE(texture);
 		}
 
@@ -106,62 +126,71 @@ namespace Graphics {
 
 #pragma region Debug heatmap
 
-		ID3D11Texture2D *texture;
-
-		ThrowIfFailed(DirectX::CreateWICTextureFromFile(device, TEXTURE_PATH("heatmap.png"), nullptr, &gradientSRV));
-
 		{
-			D3D11_TEXTURE2D_DESC desc = {};
-			desc.Width = 1280;
-			desc.Height = 720;
-			desc.SampleDesc.Count = 1;
-			desc.ArraySize = 1;
-
-			desc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-			desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-
-			ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, &texture));
+			TextureDesc desc = {};
+			desc.width = m_Width;
+			desc.height = m_Height;
+			desc.mipLevels = 1;
+			desc.arraySize = 1;
+
+			desc.format = FORMAT_R32G32B32A32_FLOAT;
+			desc.bindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+
+			GpuTexture *texture = device->CreateTexture(desc, nullptr);
+			m_DebugUAV = device->CreateUnorderedAccessView(texture);
+			m_DebugSRV = device->CreateShaderResourceView(texture);
+			SAFE_RELEASE(texture);
 		}
+#pragma endregion
+	}
 
-		{
-			D3D11_UNORDERED_ACCESS_VIEW_DESC desc = {};
-			desc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-			desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+	void LightGrid::releaseSizedResources()
+	{
+		delete m_OpaqueIndexList;
+		delete m_TransparentIndexList;
+		delete m_Frustums;
+		delete m_CullGrids;
+		m_OpaqueIndexList = nullptr;
+		m_TransparentIndexList = nullptr;
+		m_Frustums = nullptr;
+		m_CullGrids = nullptr;
 
-			ThrowIfFailed(device->CreateUnorderedAccessView(texture, &desc, &m_DebugUAV));
-		}
+		SAFE_RELEASE(m_ParamsBuffer);
 
-		{
-			D3D11_SHADER_RESOURCE_VIEW_DESC desc = {};
-			desc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-			desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-			desc.Texture2D.MipLevels = 1;
+		SAFE_RELEASE(m_DebugUAV);
+		SAFE_RELEASE(m_DebugSRV);
 
-			ThrowIfFailed(device->CreateShaderResourceView(texture, &desc, &m_DebugSRV));
-		}
+		SAFE_RELEASE(m_OpaqueLightGridUAV);
+		SAFE_RELEASE(m_OpaqueLightGridSRV);
 
-		SAFE_RELEASE(texture);
-#pragma endregion
+		SAFE_RELEASE(m_TransparentLightGridUAV);
+		SAFE_RELEASE(m_TransparentLightGridSRV);
 	}
 
-	void LightGrid::cull(Camera *camera, DirectX::CommonStates *states, ID3D11ShaderResourceView *depth, ID3D11Device *device, ID3D11DeviceContext *cxt, ResourceManager *shaders)
+	void LightGrid::cull(Camera *camera, CommonStates *states, ShaderResourceView *depth, RenderDevice *cxt, ResourceManager *shaders)
 	{
-		//generateFrustums(camera, device, cxt, shaders);
+		// fov changed, the tiles cover other parts of the view
+		if (camera->getProj() != m_Projection) {
+			delete m_Frustums;
+			SAFE_RELEASE(m_ParamsBuffer);
+			generateFrustumsCPU(camera, cxt);
+		}
+
 		m_ResetIndexCounter->CopyTo(cxt, m_OpaqueIndexCounter);
 		m_ResetIndexCounter->CopyTo(cxt, m_TransparentIndexCounter);
 
-		ID3D11SamplerState *sampler = states->LinearClamp();
-		ID3D11Buffer *bufs[] = {
+		SamplerState *sampler = states->LinearClamp();
+		GpuBuffer *bufs[] = {
 			camera->getBuffer(),
 			m_ParamsBuffer
 		};
-		ID3D11ShaderResourceView *SRVs[] = {
+		ShaderResourceView *SRVs[] = {
 			depth,
 			m_Frustums->getSRV(),
 			m_Lights->getSRV(),
 			gradientSRV
 		};
-		ID3D11UnorderedAccessView *UAVs[] = {
+		UnorderedAccessView *UAVs[] = {
 			m_OpaqueIndexCounter->getUAV(),
 			m_TransparentIndexCounter->getUAV(),
 			m_OpaqueIndexList->getUAV(),
@@ -171,7 +200,7 @@ namespace Graphics {
 			m_DebugUAV
 		};
 
-		cxt->CSSetShader(*m_CullGrids, nullptr, 0);
+		cxt->CSSetShader(*m_CullGrids);
 
 
 		cxt->CSSetSamplers(0, 1, &sampler);
@@ -185,174 +214,54 @@ namespace Graphics {
 			1
 		);
 
-		ZeroMemory(UAVs, sizeof(UAVs));
-		ZeroMemory(SRVs, sizeof(SRVs));
+		memset(UAVs, 0, sizeof(UAVs));
+		memset(SRVs, 0, sizeof(SRVs));
 		cxt->CSSetShaderResources(0, 4, SRVs);
 		cxt->CSSetUnorderedAccessViews(0, 7, UAVs, nullptr);
-		cxt->CSSetShader(nullptr, nullptr, 0);
-	}
-
-	inline Plane computePlane(DirectX::SimpleMath::Vector3 a, DirectX::SimpleMath::Vector3 b)
-	{
-		Plane plane;
-
-		auto v = a.Cross(b);
-		v.Normalize();
-
-		plane.pd = DirectX::SimpleMath::Vector4(v);
-		plane.pd.w = 0;
-
-		return plane;
+		cxt->CSSetShader(nullptr);
 	}
 
-	void LightGrid::generateFrustumsCPU(Camera * camera, ID3D11Device * device)
+	void LightGrid::generateFrustumsCPU(Camera * camera, RenderDevice * device)
 	{
-		using namespace DirectX::SimpleMath;
-
-		m_Params.numThreads[0] = ceil(1280 / (float)BLOCK_SIZE);
-		m_Params.numThreads[1] = ceil(720 / (float)BLOCK_SIZE);
-		m_Params.numThreads[2] = 1;
-
-		m_Params.numThreadGroups[0] = ceil(m_Params.numThreads[0] / (float)BLOCK_SIZE);
-		m_Params.numThreadGroups[1] = ceil(m_Params.numThreads[1] / (float)BLOCK_SIZE);
+		m_Params.numThreadGroups[0] = (m_Width + m_TileSize - 1) / m_TileSize;
+		m_Params.numThreadGroups[1] = (m_Height + m_TileSize - 1) / m_TileSize;
 		m_Params.numThreadGroups[2] = 1;
 
-
-
-		auto count = m_Params.numThreads[0] * m_Params.numThreads[1];
-		auto frustums = new Frustum[count];
-
-		auto invProj = camera->getProj().Invert();
-
-		// thread groups
-		for (auto groupY = 0; groupY < m_Params.numThreadGroups[1]; groupY++) {
-			for (auto groupX = 0; groupX < m_Params.numThreadGroups[0]; groupX++) {
-
-				// group threads
-				for (auto threadY = 0; threadY < BLOCK_SIZE; threadY++) {
-					for (auto threadX = 0; threadX < BLOCK_SIZE; threadX++) {
-
-						auto threadIdX = (groupX * BLOCK_SIZE + threadX);
-						auto threadIdY = (groupY * BLOCK_SIZE + threadY);
-
-						Vector4 corners[] = {
-							Vector4(threadIdX      * BLOCK_SIZE,  threadIdY      * BLOCK_SIZE, 1.f, 1.f),
-							Vector4((threadIdX + 1) * BLOCK_SIZE,  threadIdY      * BLOCK_SIZE, 1.f, 1.f),
-							Vector4(threadIdX      * BLOCK_SIZE, (threadIdY + 1) * BLOCK_SIZE, 1.f, 1.f),
-							Vector4((threadIdX + 1) * BLOCK_SIZE, (threadIdY + 1) * BLOCK_SIZE, 1.f, 1.f)
-						};
-
-						Vector3 points[4];
-						for (auto i = 0; i < 4; i++) {
-							auto vec = corners[i];
-							auto coord = Vector2(vec.x, vec.y) / Vector2(1280, 720);
-							auto clip = Vector4(coord.x * 2.f - 1.f, (1.f - coord.y) * 2.f - 1.f, vec.z, vec.w);
-							auto view = Vector4(DirectX::XMVector4Transform(clip, invProj));
-							view = view / view.w;
-
-							points[i] = Vector3(view);
-						}
-
-						Frustum frustum;
-						frustum.planes[0] = computePlane(points[2], points[0]);
-						frustum.planes[1] = computePlane(points[1], points[3]);
-						frustum.planes[2] = computePlane(points[0], points[1]);
-						frustum.planes[3] = computePlane(points[3], points[2]);
-
-						if (threadIdX < m_Params.numThreads[0] && threadIdY < m_Params.numThreads[1]) {
-							auto idx = threadIdX + (threadIdY * m_Params.numThreads[0]);
-							frustums[idx] = frustum;
-						}
-					}
-				}
-			}
-		}
-
-		m_Frustums = new StructuredBuffer<Frustum>(device, CpuAccess::None, count, frustums);
-		delete[] frustums;
-
-
-		m_Params.numThreadGroups[0] = ceil(1280 / (float)BLOCK_SIZE);
-		m_Params.numThreadGroups[1] = ceil(720 / (float)BLOCK_SIZE);
-		m_Params.numThreadGroups[2] = 1;
-
-		m_Params.numThreads[0] = m_Params.numThreadGroups[0] * BLOCK_SIZE;
-		m_Params.numThreads[1] = m_Params.numThreadGroups[1] * BLOCK_SIZE;
+		m_Params.numThreads[0] = m_Params.numThreadGroups[0] * m_TileSize;
+		m_Params.numThreads[1] = m_Params.numThreadGroups[1] * m_TileSize;
 		m_Params.numThreads[2] = 1;
 
-		// Grid params
-		{
-			D3D11_BUFFER_DESC desc = {};
-			desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-			desc.ByteWidth = sizeof(DispatchParams);
-			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-			desc.Usage = D3D11_USAGE_DYNAMIC;
+		auto count = m_Params.numThreadGroups[0] * m_Params.numThreadGroups[1];
+		m_Projection = camera->getProj();
+		auto invProj = m_Projection.Invert();
 
-			D3D11_SUBRESOURCE_DATA data = {};
-			data.pSysMem = &m_Params;
+		// the CPU reference builds them, so both cull against the same frustums
+		TiledLightCuller culler(m_Width, m_Height, m_TileSize);
+		culler.buildFrustums(&invProj._11);
 
-			ThrowIfFailed(device->CreateBuffer(&desc, &data, &m_ParamsBuffer));
+		std::vector<Frustum> frustums(count);
+		std::vector<TiledLightCuller::CullFrustum> const & built = culler.getFrustums();
+		for (size_t i = 0; i < frustums.size(); i++)
+		{
+			for (int p = 0; p < 4; p++)
+			{
+				TiledLightCuller::CullPlane const & plane = built[i].planes[p];
+				frustums[i].planes[p].pd = DirectX::SimpleMath::Vector4(plane.nx, plane.ny, plane.nz, plane.d);
+			}
 		}
-	}
-
-	void LightGrid::generateFrustums(Camera *camera, ID3D11Device *device, ID3D11DeviceContext *cxt, ResourceManager *shaders)
-	{
-		m_Params.numThreads[0] = ceil(1280 / (float)BLOCK_SIZE);
-		m_Params.numThreads[1] = ceil(720 / (float)BLOCK_SIZE);
-		m_Params.numThreads[2] = 1;
-
-		m_Params.numThreadGroups[0] = ceil(m_Params.numThreads[0] / (float)BLOCK_SIZE);
-		m_Params.numThreadGroups[1] = ceil(m_Params.numThreads[1] / (float)BLOCK_SIZE);
-		m_Params.numThreadGroups[2] = 1;
 
+		m_Frustums = new StructuredBuffer<Frustum>(device, CpuAccess::None, count, frustums.data());
 
 		// Grid params
 		{
-			D3D11_BUFFER_DESC desc = {};
-			desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-			desc.ByteWidth = sizeof(DispatchParams);
-			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-			desc.Usage = D3D11_USAGE_DYNAMIC;
-
-			D3D11_SUBRESOURCE_DATA data = {};
-			data.pSysMem = &m_Params;
+			BufferDesc desc = {};
+			desc.bindFlags = BIND_CONSTANT_BUFFER;
+			desc.byteWidth = sizeof(DispatchParams);
+			desc.cpuAccessFlags = CPU_ACCESS_WRITE;
+			desc.usage = USAGE_DYNAMIC;
 
-			ThrowIfFailed(device->CreateBuffer(&desc, &data, &m_ParamsBuffer));
+			m_ParamsBuffer = device->CreateBuffer(desc, &m_Params);
 		}
-
-		// Frustums
-		auto count = m_Params.numThreads[0] * m_Params.numThreads[1];
-		m_Frustums = new StructuredBuffer<Frustum>(device, CpuAccess::None, count);
-
-		cxt->CSSetShader(*m_FrustumGeneration, nullptr, 0);
-
-		ID3D11Buffer *buffers[] = {
-			camera->getBuffer(),
-			m_ParamsBuffer,
-		};
-		cxt->CSSetConstantBuffers(0, 2, buffers);
-
-		auto uav = m_Frustums->getUAV();
-		cxt->CSSetUnorderedAccessViews(0, 1, &uav, 0);
-
-		cxt->Dispatch(m_Params.numThreadGroups[0], m_Params.numThreadGroups[1], 1);
-		ID3D11UnorderedAccessView *reset = nullptr;
-		cxt->CSSetUnorderedAccessViews(0, 1, &reset, 0);
-
-
-		m_Params.numThreadGroups[0] = ceil(1280 / (float)BLOCK_SIZE);
-		m_Params.numThreadGroups[1] = ceil(720 / (float)BLOCK_SIZE);
-		m_Params.numThreadGroups[2] = 1;
-
-		m_Params.numThreads[0] = m_Params.numThreadGroups[0] * BLOCK_SIZE;
-		m_Params.numThreads[1] = m_Params.numThreadGroups[1] * BLOCK_SIZE;
-		m_Params.numThreads[2] = 1;
-
-
-		D3D11_MAPPED_SUBRESOURCE mapped_data;
-		cxt->Map(m_ParamsBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_data);
-		CopyMemory(mapped_data.pData, &m_Params, sizeof(DispatchParams));
-		cxt->Unmap(m_ParamsBuffer, 0);
 	}
 
 }
\ No newline at end of file
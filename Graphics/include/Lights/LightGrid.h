@@ -1,16 +1,17 @@
 #pragma once
 
-#include <d3d11.h>
 #include <SimpleMath.h>
-#include <CommonStates.h>
 #include "../Camera.h"
-#include "../ThrowIfFailed.h"
+#include "../Device/CommonStates.h"
 #include "../Structs.h"
 #include "../Resources/ResourceManager.h"
 #include "../Resources/Shader.h"
 #include "../Utility/StructuredBuffer.h"
+#include "TiledLightCulling.h"
 
 #define BLOCK_SIZE 16
+// BLOCK_SIZE * BLOCK_SIZE threads per group, D3D11 allows 1024
+#define MAX_TILE_SIZE 32
 
 namespace Graphics {
 
@@ -32,8 +33,11 @@ namespace Graphics {
 		LightGrid();
 		virtual ~LightGrid();
 
-		void initialize(Camera *camera, ID3D11Device *device, ID3D11DeviceContext *cxt, ResourceManager *shaders);
-		void cull(Camera *camera, DirectX::CommonStates *states, ID3D11ShaderResourceView *depth, ID3D11Device *device, ID3D11DeviceContext *cxt, ResourceManager *shaders);
+		void initialize(Camera *camera, RenderDevice *device, ResourceManager *shaders, UINT width, UINT height, UINT tileSize = BLOCK_SIZE);
+
+		// rebuilds everything sized by the screen, call when the back buffer or tile size changes
+		void resize(Camera *camera, RenderDevice *device, UINT width, UINT height, UINT tileSize);
+		void cull(Camera *camera, CommonStates *states, ShaderResourceView *depth, RenderDevice *cxt, ResourceManager *shaders);
 
 		StructuredBuffer<uint32_t> *getOpaqueIndexCounter() const { return m_OpaqueIndexCounter; }
 		StructuredBuffer<uint32_t> *getTransparentIndexCounter() const { return m_TransparentIndexCounter; }
@@ -43,17 +47,27 @@ namespace Graphics {
 
 		StructuredBuffer<Frustum> *getFrustums() const { return m_Frustums; }
 		StructuredBuffer<Light> *getLights() const { return m_Lights; }
+		GpuBuffer *getParamsBuffer() const { return m_ParamsBuffer; }
+
+		UINT getWidth() const { return m_Width; }
+		UINT getHeight() const { return m_Height; }
+		UINT getTileSize() const { return m_TileSize; }
 
 		// TEMP:
-		ID3D11ShaderResourceView *getOpaqueLightGridSRV() const { return m_OpaqueLightGridSRV; }
-		ID3D11ShaderResourceView *getTransparentLightGridSRV() const { return m_TransparentLightGridSRV; }
-		ID3D11ShaderResourceView *getDebugSRV() const { return m_DebugSRV; }
+		ShaderResourceView *getOpaqueLightGridSRV() const { return m_OpaqueLightGridSRV; }
+		ShaderResourceView *getTransparentLightGridSRV() const { return m_TransparentLightGridSRV; }
+		ShaderResourceView *getDebugSRV() const { return m_DebugSRV; }
 	private:
-		void generateFrustumsCPU(Camera *camera, ID3D11Device *device);
-		void generateFrustums(Camera *camera, ID3D11Device *device, ID3D11DeviceContext *cxt, ResourceManager *shaders);
+		void generateFrustumsCPU(Camera *camera, RenderDevice *device);
+		void releaseSizedResources();
+
+		UINT m_Width;
+		UINT m_Height;
+		UINT m_TileSize;
+		DirectX::SimpleMath::Matrix m_Projection;
 
 		DispatchParams m_Params;
-		ID3D11Buffer  *m_ParamsBuffer;
+		GpuBuffer  *m_ParamsBuffer;
 
 		StructuredBuffer<uint32_t> *m_ResetIndexCounter;
 		StructuredBuffer<uint32_t> *m_OpaqueIndexCounter;
@@ -65,18 +79,17 @@ namespace Graphics {
 		StructuredBuffer<Frustum>  *m_Frustums;
 		StructuredBuffer<Light>    *m_Lights;
 
-		ID3D11UnorderedAccessView *m_DebugUAV;
-		ID3D11ShaderResourceView  *m_DebugSRV;
+		UnorderedAccessView *m_DebugUAV;
+		ShaderResourceView  *m_DebugSRV;
 
-		ID3D11UnorderedAccessView *m_OpaqueLightGridUAV;
-		ID3D11ShaderResourceView  *m_OpaqueLightGridSRV;
-		ID3D11UnorderedAccessView *m_TransparentLightGridUAV;
-		ID3D11ShaderResourceView  *m_TransparentLightGridSRV;
+		UnorderedAccessView *m_OpaqueLightGridUAV;
+		ShaderResourceView  *m_OpaqueLightGridSRV;
+		UnorderedAccessView *m_TransparentLightGridUAV;
+		ShaderResourceView  *m_TransparentLightGridSRV;
 
-		ID3D11ShaderResourceView  *gradientSRV;
+		ShaderResourceView  *gradientSRV;
 
 		ComputeShader *m_CullGrids;
-		ComputeShader *m_FrustumGeneration;
 	};
 
 }
\ No newline at end of file
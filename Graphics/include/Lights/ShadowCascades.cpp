@@ -0,0 +1,239 @@
+#include "ShadowCascades.h"
+#include <math.h>
+#include <string.h>
+
+namespace Graphics {
+
+	namespace {
+		void normalize(float v[3])
+		{
+			float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+			if (length > 0.f) {
+				v[0] /= length;
+				v[1] /= length;
+				v[2] /= length;
+			}
+		}
+
+		void cross(const float a[3], const float b[3], float out[3])
+		{
+			out[0] = a[1] * b[2] - a[2] * b[1];
+			out[1] = a[2] * b[0] - a[0] * b[2];
+			out[2] = a[0] * b[1] - a[1] * b[0];
+		}
+
+		// a * b, both row major 4x4
+		void multiply(const float a[16], const float b[16], float out[16])
+		{
+			for (int row = 0; row < 4; row++) {
+				for (int column = 0; column < 4; column++) {
+					out[row * 4 + column] =
+						a[row * 4] * b[column] +
+						a[row * 4 + 1] * b[4 + column] +
+						a[row * 4 + 2] * b[8 + column] +
+						a[row * 4 + 3] * b[12 + column];
+				}
+			}
+		}
+	}
+
+	ShadowCascades::ShadowCascades(uint32_t cascadeCount, uint32_t resolution)
+	{
+		m_CascadeCount = cascadeCount < MAX_CASCADES ? cascadeCount : MAX_CASCADES;
+		m_Resolution = resolution;
+		m_Lambda = 0.75f;
+		m_ShadowDistance = 100.f;
+		m_CasterDistance = 100.f;
+
+		for (uint32_t i = 0; i < MAX_CASCADES; i++) {
+			m_Intervals[i] = 1;
+			m_Valid[i] = false;
+		}
+
+		memset(m_Cascades, 0, sizeof(m_Cascades));
+		memset(m_LightView, 0, sizeof(m_LightView));
+	}
+
+	ShadowCascades::~ShadowCascades()
+	{
+	}
+
+	void ShadowCascades::setUpdateInterval(uint32_t cascade, uint32_t frames)
+	{
+		if (cascade < MAX_CASCADES)
+			m_Intervals[cascade] = frames > 0 ? frames : 1;
+	}
+
+	void ShadowCascades::computeSplits(float nearZ, float farZ, uint32_t count, float lambda, float *splits)
+	{
+		for (uint32_t i = 0; i <= count; i++) {
+			float part = i / (float)count;
+			float logarithmic = nearZ * powf(farZ / nearZ, part);
+			float uniform = nearZ + (farZ - nearZ) * part;
+
+			splits[i] = lambda * logarithmic + (1.f - lambda) * uniform;
+		}
+
+		// no rounding at the ends
+		splits[0] = nearZ;
+		splits[count] = farZ;
+	}
+
+	uint32_t ShadowCascades::update(const float view[16], const float proj[16], const float lightDirection[3], uint64_t frame)
+	{
+		// right handed perspective: _33 = f / (n - f), _43 = n * f / (n - f)
+		float nearZ = proj[14] / proj[10];
+		float farZ = proj[14] / (proj[10] + 1.f);
+		float distance = m_ShadowDistance < farZ ? m_ShadowDistance : farZ;
+
+		float splits[MAX_CASCADES + 1];
+		computeSplits(nearZ, distance, m_CascadeCount, m_Lambda, splits);
+
+		buildLightView(lightDirection);
+
+		uint32_t updated = 0;
+		for (uint32_t i = 0; i < m_CascadeCount; i++) {
+			// staggered, so cascades with the same interval don't all land on one frame
+			if (m_Valid[i] && (frame + i) % m_Intervals[i] != 0)
+				continue;
+
+			m_Cascades[i].nearSplit = splits[i];
+			m_Cascades[i].farSplit = splits[i + 1];
+			fitCascade(m_Cascades[i], view, proj[0], proj[5]);
+
+			m_Valid[i] = true;
+			updated |= 1u << i;
+		}
+
+		return updated;
+	}
+
+	void ShadowCascades::buildLightView(const float direction[3])
+	{
+		float forward[3] = { direction[0], direction[1], direction[2] };
+		normalize(forward);
+
+		// up is the world axis furthest from the light, so it is never parallel
+		float up[3] = { 0.f, 0.f, 0.f };
+		int axis = 0;
+		for (int i = 1; i < 3; i++) {
+			if (fabsf(forward[i]) < fabsf(forward[axis]))
+				axis = i;
+		}
+		up[axis] = 1.f;
+
+		// look at, -z is forward
+		float z[3] = { -forward[0], -forward[1], -forward[2] };
+		float x[3], y[3];
+		cross(up, z, x);
+		normalize(x);
+		cross(z, x, y);
+
+		memset(m_LightView, 0, sizeof(m_LightView));
+		for (int i = 0; i < 3; i++) {
+			m_LightView[i * 4] = x[i];
+			m_LightView[i * 4 + 1] = y[i];
+			m_LightView[i * 4 + 2] = z[i];
+		}
+		m_LightView[15] = 1.f;
+	}
+
+	void ShadowCascades::fitCascade(Cascade &cascade, const float view[16], float scaleX, float scaleY) const
+	{
+		float nearSplit = cascade.nearSplit;
+		float farSplit = cascade.farSplit;
+
+		// corners of the slice are at x = d / scaleX, y = d / scaleY, the sphere center is on the view axis
+		// where both ends are as far away
+		float spread = 1.f / (scaleX * scaleX) + 1.f / (scaleY * scaleY);
+		float depth = (farSplit + nearSplit) * (1.f + spread) * 0.5f;
+		if (depth > farSplit)
+			depth = farSplit;
+
+		float nearDistance = (depth - nearSplit) * (depth - nearSplit) + nearSplit * nearSplit * spread;
+		float farDistance = (farSplit - depth) * (farSplit - depth) + farSplit * farSplit * spread;
+		float radius = sqrtf(nearDistance > farDistance ? nearDistance : farDistance);
+
+		// float noise would change the texel size a little every frame
+		radius = ceilf(radius * 16.f) / 16.f;
+
+		// view to world, the view is rigid so the inverse is the transposed rotation
+		float viewCenter[3] = { -view[12], -view[13], -depth - view[14] };
+		float world[3];
+		for (int j = 0; j < 3; j++) {
+			world[j] =
+				viewCenter[0] * view[j * 4] +
+				viewCenter[1] * view[j * 4 + 1] +
+				viewCenter[2] * view[j * 4 + 2];
+		}
+
+		float center[3];
+		for (int column = 0; column < 3; column++) {
+			center[column] =
+				world[0] * m_LightView[column] +
+				world[1] * m_LightView[4 + column] +
+				world[2] * m_LightView[8 + column];
+		}
+
+		// whole texels, the projection only ever moves by a texel
+		float texel = radius * 2.f / m_Resolution;
+		center[0] = floorf(center[0] / texel + 0.5f) * texel;
+		center[1] = floorf(center[1] / texel + 0.5f) * texel;
+
+		cascade.center[0] = center[0];
+		cascade.center[1] = center[1];
+		cascade.center[2] = center[2];
+		cascade.radius = radius;
+		cascade.minZ = center[2] - radius;
+		cascade.maxZ = center[2] + radius + m_CasterDistance;
+		cascade.texelSize = texel;
+
+		// orthographic off center, right handed: near is -maxZ, far is -minZ
+		float zNear = -cascade.maxZ;
+		float zFar = -cascade.minZ;
+
+		float projection[16] = {};
+		projection[0] = 1.f / radius;
+		projection[5] = 1.f / radius;
+		projection[10] = 1.f / (zNear - zFar);
+		projection[12] = -center[0] / radius;
+		projection[13] = -center[1] / radius;
+		projection[14] = zNear / (zNear - zFar);
+		projection[15] = 1.f;
+
+		multiply(m_LightView, projection, cascade.viewProjection);
+	}
+
+	uint32_t ShadowCascades::getCasterMask(const float center[3], float radius, uint32_t mask) const
+	{
+		uint32_t casts = 0;
+
+		for (uint32_t i = 0; i < m_CascadeCount; i++) {
+			if (!(mask & (1u << i)) || !m_Valid[i])
+				continue;
+
+			Cascade const &cascade = m_Cascades[i];
+			const float *m = cascade.viewProjection;
+
+			float clip[3];
+			for (int column = 0; column < 3; column++) {
+				clip[column] =
+					center[0] * m[column] +
+					center[1] * m[4 + column] +
+					center[2] * m[8 + column] +
+					m[12 + column];
+			}
+
+			// the box of the cascade is [-1, 1] in x and y, [0, 1] in depth with 0 toward the light
+			float extentXY = 1.f + radius / cascade.radius;
+			float extentZ = radius / (cascade.maxZ - cascade.minZ);
+
+			if (fabsf(clip[0]) <= extentXY && fabsf(clip[1]) <= extentXY &&
+				clip[2] >= -extentZ && clip[2] <= 1.f + extentZ)
+				casts |= 1u << i;
+		}
+
+		return casts;
+	}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Graphics {
+
+	/*
+		Cascaded shadow maps for a directional light, the CPU part. The view
+		frustum up to the shadow distance is split in depth slices and every
+		slice gets its own orthographic projection from the light.
+
+		Splits blend between uniform and logarithmic:
+			split(i) = lambda * near * (far / near)^(i / n) + (1 - lambda) * (near + (far - near) * i / n)
+
+		Every cascade covers the bounding sphere of its slice. The sphere only
+		changes with the projection, so the texel size stays the same when
+		the camera turns, and the center is snapped to whole texels in light
+		space so the shadow edges don't swim when it moves.
+
+		The light space box of a cascade is extended toward the light by the
+		caster distance, whatever is in there can throw a shadow into the
+		cascade. getCasterMask tests bounding spheres against those boxes.
+
+		Distant cascades can be updated every n frames, update returns which
+		cascades changed this frame. A cascade that wasn't updated keeps its
+		matrix, so it still matches what is in its shadow map.
+
+		Matrices are row major, vectors multiplied from the left (v * M),
+		right handed with -z forward, depth [0, 1] like D3D.
+
+		No D3D or SimpleMath in here on purpose.
+	*/
+	class ShadowCascades {
+	public:
+		static const uint32_t MAX_CASCADES = 4;
+
+		struct Cascade {
+			float viewProjection[16];   // world to light clip space
+			float nearSplit, farSplit;  // view depth range of the camera it covers
+			float center[3];            // light space, snapped
+			float radius;
+			float minZ, maxZ;           // light space, maxZ is toward the light
+			float texelSize;            // world units
+		};
+
+		ShadowCascades(uint32_t cascadeCount, uint32_t resolution);
+		virtual ~ShadowCascades();
+
+		// 0 is uniform, 1 is logarithmic
+		void setSplitLambda(float lambda) { m_Lambda = lambda; }
+		// the last cascade ends here or at the far plane, whichever is closer
+		void setShadowDistance(float distance) { m_ShadowDistance = distance; }
+		// how far toward the light casters are kept
+		void setCasterDistance(float distance) { m_CasterDistance = distance; }
+		// the cascade is updated every frames frames, 1 is every frame
+		void setUpdateInterval(uint32_t cascade, uint32_t frames);
+
+		// lightDirection is where the light goes, it doesn't have to be normalized.
+		// Returns a bit for every cascade updated, the rest kept what they had
+		uint32_t update(const float view[16], const float proj[16], const float lightDirection[3], uint64_t frame);
+
+		// bit i is set if the sphere (world space) can cast into cascade i, only cascades in mask are tested
+		uint32_t getCasterMask(const float center[3], float radius, uint32_t mask) const;
+
+		uint32_t getCascadeCount() const { return m_CascadeCount; }
+		uint32_t getResolution() const { return m_Resolution; }
+		Cascade const &getCascade(uint32_t cascade) const { return m_Cascades[cascade]; }
+
+		// count + 1 depths from near to far
+		static void computeSplits(float nearZ, float farZ, uint32_t count, float lambda, float *splits);
+
+	private:
+		uint32_t m_CascadeCount;
+		uint32_t m_Resolution;
+		float m_Lambda;
+		float m_ShadowDistance;
+		float m_CasterDistance;
+
+		uint32_t m_Intervals[MAX_CASCADES];
+		bool m_Valid[MAX_CASCADES];
+		Cascade m_Cascades[MAX_CASCADES];
+
+		float m_LightView[16];      // rotation only, used by every cascade
+
+		void buildLightView(const float direction[3]);
+		void fitCascade(Cascade &cascade, const float view[16], float scaleX, float scaleY) const;
+	};
+
+}
@@ -1,11 +1,13 @@
 #include "Sun.h"
 #include <algorithm>
+#include <math.h>
+#include <string.h>
 using namespace DirectX::SimpleMath;
 #define PI 3.14159265
 #define SUNSET_TIME 0.5f
 #define DAY_NIGHT_ON true
 
-Sun::Sun(ID3D11Device * device, int width, int height)
+Sun::Sun(Graphics::RenderDevice * device)
 {
 	pos = Vector4(0, 50, 0.5, 1);
 	colors.dayColor = Vector3(1, 1, 0.8);
@@ -14,44 +16,27 @@ Sun::Sun(ID3D11Device * device, int width, int height)
 	isNight = false;
 	
 
-	projection = DirectX::XMMatrixOrthographicRH(100.f, 100.f, 1, 300);
-	view = DirectX::XMMatrixLookAtRH(pos, Vector3(0, 0, 0), Vector3(0, 1, 0));
+	direction = -Vector3(pos.x, pos.y, pos.z);
+	direction.Normalize();
 
-	matrixData.vp = view * projection;
-	
 	shaderData.color = colors.dayColor;
 	shaderData.shadowFade = 1;
 
-	D3D11_BUFFER_DESC desc = {};
-	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	desc.ByteWidth = sizeof(ShaderMatrix);
-	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	desc.Usage = D3D11_USAGE_DYNAMIC;
-
-	D3D11_SUBRESOURCE_DATA data = {};
-	data.pSysMem = &matrixData;
-
-	device->CreateBuffer(&desc, &data, &this->matrixBuffer);
-
-	desc.ByteWidth = sizeof(LightValues);
-	data.pSysMem = &shaderData;
-
-	device->CreateBuffer(&desc, &data, &this->shaderBuffer);
-
+	Graphics::BufferDesc desc = {};
+	desc.bindFlags = Graphics::BIND_CONSTANT_BUFFER;
+	desc.byteWidth = sizeof(LightValues);
+	desc.cpuAccessFlags = Graphics::CPU_ACCESS_WRITE;
+	desc.usage = Graphics::USAGE_DYNAMIC;
 
-	viewPort = { 0 };
-	viewPort.Height = height;
-	viewPort.Width = width;
-	viewPort.MaxDepth = 1.f;
+	this->shaderBuffer = device->CreateBuffer(desc, &shaderData);
 }
 
 Sun::~Sun()
 {
-	SAFE_RELEASE(matrixBuffer);
 	SAFE_RELEASE(shaderBuffer);
 }
 
-void Sun::update(ID3D11DeviceContext * context, float rotationAmount, Vector3 offset)
+void Sun::update(Graphics::RenderDevice * context, float rotationAmount, Vector3 offset)
 {
 	//a little bit temp, might be final
 	static float rotationDeg = 0;
@@ -74,17 +59,18 @@ void Sun::update(ID3D11DeviceContext * context, float rotationAmount, Vector3 of
 	this->shaderData.pos = Vector4::Transform(pos, rotation);
 	
 	//If its nighttime the shadows fade out
-	Vector3 lightDir = -shaderData.pos;
+	Vector3 lightDir = -Vector3(shaderData.pos.x, shaderData.pos.y, shaderData.pos.z);
 	lightDir.Normalize();
+	direction = lightDir;
 
 	Vector3 groundDir(1, 0, 0);
 
-	float fade = snap(1.0 - abs(lightDir.Dot(groundDir)), 0, SUNSET_TIME);
+	float fade = snap(1.0f - fabsf(lightDir.Dot(groundDir)), 0, SUNSET_TIME);
 	shaderData.shadowFade = fade / SUNSET_TIME;
 
 	//Interpolates between colors
-	float dayAmount = min(shaderData.shadowFade, 1);
-	float sundownAmount = 1 - min(shaderData.shadowFade, 1);
+	float dayAmount = std::min(shaderData.shadowFade, 1.f);
+	float sundownAmount = 1 - std::min(shaderData.shadowFade, 1.f);
 
 	if (!isNight)
 		shaderData.color = (colors.dayColor * dayAmount) + (colors.sunDownColor * sundownAmount);
@@ -96,24 +82,12 @@ void Sun::update(ID3D11DeviceContext * context, float rotationAmount, Vector3 of
 	shaderData.color.y = snap(shaderData.color.y, 0, 1);
 	shaderData.color.z = snap(shaderData.color.z, 0, 1);
 	
-	this->shaderData.pos = shaderData.pos + offset;
-	view = DirectX::XMMatrixLookAtRH(shaderData.pos, offset, Vector3(0, 1, 0));
-	matrixData.vp = view * projection;
-
-
-	D3D11_MAPPED_SUBRESOURCE data = {};
-	
-	context->Map(shaderBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &data);
-
-	memcpy(data.pData, &shaderData, sizeof(shaderData));
-
-	context->Unmap(shaderBuffer, 0);
+	this->shaderData.pos = shaderData.pos + Vector4(offset.x, offset.y, offset.z, 0);
 
-	context->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &data);
 
-	memcpy(data.pData, &matrixData, sizeof(matrixData));
+	memcpy(context->Map(shaderBuffer, sizeof(shaderData)), &shaderData, sizeof(shaderData));
 
-	context->Unmap(matrixBuffer, 0);
+	context->Unmap(shaderBuffer);
 
 }
 
@@ -134,6 +108,6 @@ Sun::ColorStruct Sun::getColors() const
 
 float Sun::snap(float value, float minVal, float maxVal)
 {
-	value = max(min(value, maxVal), minVal);
+	value = std::max(std::min(value, maxVal), minVal);
 	return value;
 }
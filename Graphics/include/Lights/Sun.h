@@ -1,9 +1,9 @@
 #pragma once
 
-#include <d3d11.h>
+#include "../Device/RenderDevice.h"
 
 #include <SimpleMath.h>
-#include <Engine\Constants.h>
+#include <Engine/Constants.h>
 class Sun
 {
 public:
@@ -15,32 +15,26 @@ public:
 	};
 
 
-	Sun(ID3D11Device* device, int width, int height);
+	Sun(Graphics::RenderDevice* device);
 	~Sun();
 
-	void update(ID3D11DeviceContext* context, float rotationAmount, DirectX::SimpleMath::Vector3 offset = DirectX::SimpleMath::Vector3(0, 0, 0));
+	void update(Graphics::RenderDevice* context, float rotationAmount, DirectX::SimpleMath::Vector3 offset = DirectX::SimpleMath::Vector3(0, 0, 0));
 
-	ID3D11Buffer* getMatrixBuffer() { return matrixBuffer; };
-	ID3D11Buffer* getShaderBuffer() { return shaderBuffer; };
-	D3D11_VIEWPORT getViewPort() { return viewPort; };
+	Graphics::GpuBuffer* getShaderBuffer() { return shaderBuffer; };
 	float getShadowFade() const;
+	//Where the light goes, normalized
+	DirectX::SimpleMath::Vector3 getDirection() const { return direction; };
 	DirectX::SimpleMath::Vector3 getColor() const;
 
 	//If this is never used, please remove it
 	ColorStruct getColors() const;
 
 private:
-	DirectX::SimpleMath::Matrix view;
-	DirectX::SimpleMath::Matrix projection;
 	DirectX::SimpleMath::Vector4 pos;
+	DirectX::SimpleMath::Vector3 direction;
 	ColorStruct colors;
 	bool isNight;
 
-	struct ShaderMatrix
-	{
-		DirectX::SimpleMath::Matrix vp;
-	};
-
 	struct LightValues
 	{
 		DirectX::SimpleMath::Vector4 pos;
@@ -53,11 +47,7 @@ private:
 	//Clamp a value between min and max
 	float snap(float value, float min, float max);
 
-	ShaderMatrix matrixData;
 	LightValues shaderData;
-	ID3D11Buffer* matrixBuffer;
-	ID3D11Buffer* shaderBuffer;
-
-	D3D11_VIEWPORT viewPort;
+	Graphics::GpuBuffer* shaderBuffer;
 
 };
\ No newline at end of file
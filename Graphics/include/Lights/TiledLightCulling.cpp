@@ -0,0 +1,214 @@
+#include "TiledLightCulling.h"
+#include <string.h>
+#include <math.h>
+
+namespace Graphics {
+
+	namespace {
+		// v * M, M row major
+		void transform(const float v[4], const float m[16], float out[4])
+		{
+			for (int column = 0; column < 4; column++) {
+				out[column] =
+					v[0] * m[column] +
+					v[1] * m[4 + column] +
+					v[2] * m[8 + column] +
+					v[3] * m[12 + column];
+			}
+		}
+
+		uint32_t asUint(float value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		float asFloat(uint32_t bits)
+		{
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		// computePlane in LightGrid.cpp
+		TiledLightCuller::CullPlane computePlane(const float a[3], const float b[3])
+		{
+			float n[3] = {
+				a[1] * b[2] - a[2] * b[1],
+				a[2] * b[0] - a[0] * b[2],
+				a[0] * b[1] - a[1] * b[0]
+			};
+
+			float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length > 0.f) {
+				n[0] /= length;
+				n[1] /= length;
+				n[2] /= length;
+			}
+
+			return { n[0], n[1], n[2], 0.f };
+		}
+
+		// SphereInsidePlane in the shader, it doesn't use the distance of the plane
+		bool sphereInsidePlane(const float center[3], float radius, TiledLightCuller::CullPlane const &plane)
+		{
+			return plane.nx * center[0] + plane.ny * center[1] + plane.nz * center[2] < -radius;
+		}
+
+		bool sphereInsideFrustum(const float center[3], float radius, TiledLightCuller::CullFrustum const &frustum, float zNear, float zFar)
+		{
+			if (center[2] - radius > zNear || center[2] + radius < zFar)
+				return false;
+
+			for (int i = 0; i < 4; i++) {
+				if (sphereInsidePlane(center, radius, frustum.planes[i]))
+					return false;
+			}
+
+			return true;
+		}
+
+		void appendLight(std::vector<uint32_t> &list, uint32_t &count, uint32_t lightIndex)
+		{
+			if (count < TiledLightCuller::MAX_TILE_LIGHTS)
+				list.push_back(lightIndex);
+			count++;
+		}
+
+		// the index list gets count entries even if the groupshared list was full,
+		// on the GPU the rest is whatever groupshared memory had
+		void copyToIndexList(std::vector<uint32_t> &indexList, std::vector<uint32_t> &grid, size_t tile,
+			std::vector<uint32_t> const &tileList, uint32_t count)
+		{
+			grid[tile * 2] = (uint32_t)indexList.size();
+			grid[tile * 2 + 1] = count;
+
+			indexList.insert(indexList.end(), tileList.begin(), tileList.end());
+			indexList.resize(indexList.size() + (count - tileList.size()), UINT32_MAX);
+		}
+	}
+
+	TiledLightCuller::TiledLightCuller(uint32_t width, uint32_t height, uint32_t blockSize)
+	{
+		m_Width = width;
+		m_Height = height;
+		m_BlockSize = blockSize;
+		m_TilesX = (width + blockSize - 1) / blockSize;
+		m_TilesY = (height + blockSize - 1) / blockSize;
+
+		m_Frustums.resize(m_TilesX * m_TilesY);
+		m_OpaqueGrid.resize(m_TilesX * m_TilesY * 2);
+		m_TransparentGrid.resize(m_TilesX * m_TilesY * 2);
+	}
+
+	TiledLightCuller::~TiledLightCuller()
+	{
+	}
+
+	void TiledLightCuller::buildFrustums(const float invProj[16])
+	{
+		for (uint32_t y = 0; y < m_TilesY; y++) {
+			for (uint32_t x = 0; x < m_TilesX; x++) {
+				float corners[4][2] = {
+					{ (float)(x * m_BlockSize),       (float)(y * m_BlockSize) },
+					{ (float)((x + 1) * m_BlockSize), (float)(y * m_BlockSize) },
+					{ (float)(x * m_BlockSize),       (float)((y + 1) * m_BlockSize) },
+					{ (float)((x + 1) * m_BlockSize), (float)((y + 1) * m_BlockSize) }
+				};
+
+				float points[4][3];
+				for (int i = 0; i < 4; i++) {
+					float u = corners[i][0] / m_Width;
+					float v = corners[i][1] / m_Height;
+					float clip[4] = { u * 2.f - 1.f, (1.f - v) * 2.f - 1.f, 1.f, 1.f };
+
+					float view[4];
+					transform(clip, invProj, view);
+					for (int axis = 0; axis < 3; axis++)
+						points[i][axis] = view[axis] / view[3];
+				}
+
+				CullFrustum &frustum = m_Frustums[x + y * m_TilesX];
+				frustum.planes[0] = computePlane(points[2], points[0]);
+				frustum.planes[1] = computePlane(points[1], points[3]);
+				frustum.planes[2] = computePlane(points[0], points[1]);
+				frustum.planes[3] = computePlane(points[3], points[2]);
+			}
+		}
+	}
+
+	float TiledLightCuller::screenToViewZ(const float invProj[16], float depth) const
+	{
+		// ScreenToView(float4(0, 0, depth, 1)), only z is used
+		float clip[4] = { -1.f, 1.f, depth, 1.f };
+		float view[4];
+		transform(clip, invProj, view);
+
+		return view[2] / view[3];
+	}
+
+	void TiledLightCuller::cull(const float view[16], const float invProj[16], const float *depth, const CullLight *lights, size_t lightCount)
+	{
+		m_OpaqueIndexList.clear();
+		m_TransparentIndexList.clear();
+
+		std::vector<uint32_t> opaqueList, transparentList;
+		opaqueList.reserve(MAX_TILE_LIGHTS);
+		transparentList.reserve(MAX_TILE_LIGHTS);
+
+		// the same for every tile, the shader computes them per group
+		float nearClipVS = screenToViewZ(invProj, 0.f);
+
+		std::vector<float> centers(lightCount * 4);
+		for (size_t i = 0; i < lightCount; i++) {
+			float position[4] = { lights[i].position[0], lights[i].position[1], lights[i].position[2], 1.f };
+			transform(position, view, &centers[i * 4]);
+		}
+
+		for (uint32_t tileY = 0; tileY < m_TilesY; tileY++) {
+			for (uint32_t tileX = 0; tileX < m_TilesX; tileX++) {
+				size_t tile = tileX + tileY * m_TilesX;
+
+				// InterlockedMax on the bits, same order as floats for depth >= 0. The min depth
+				// plane of the shader ignores its distance, so the min depth is never used
+				uint32_t maxDepth = 0;
+				for (uint32_t y = tileY * m_BlockSize; y < (tileY + 1) * m_BlockSize; y++) {
+					for (uint32_t x = tileX * m_BlockSize; x < (tileX + 1) * m_BlockSize; x++) {
+						// Load outside the texture returns 0
+						float pixel = x < m_Width && y < m_Height ? depth[x + y * m_Width] : 0.f;
+						if (pixel != 1.f) {
+							uint32_t bits = asUint(pixel);
+							if (bits > maxDepth) maxDepth = bits;
+						}
+					}
+				}
+
+				float maxDepthVS = screenToViewZ(invProj, asFloat(maxDepth));
+				const CullPlane minPlane = { 0.f, 0.f, -1.f, 0.f };
+
+				uint32_t opaqueCount = 0, transparentCount = 0;
+				opaqueList.clear();
+				transparentList.clear();
+
+				for (uint32_t i = 0; i < lightCount; i++) {
+					float range = lights[i].range;
+					if (range == 0)
+						continue;
+
+					const float *center = &centers[i * 4];
+					if (sphereInsideFrustum(center, range, m_Frustums[tile], nearClipVS, maxDepthVS)) {
+						appendLight(transparentList, transparentCount, i);
+
+						if (!sphereInsidePlane(center, range, minPlane))
+							appendLight(opaqueList, opaqueCount, i);
+					}
+				}
+
+				copyToIndexList(m_OpaqueIndexList, m_OpaqueGrid, tile, opaqueList, opaqueCount);
+				copyToIndexList(m_TransparentIndexList, m_TransparentGrid, tile, transparentList, transparentCount);
+			}
+		}
+	}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace Graphics {
+
+	/*
+		CPU version of LightGridCulling.hlsl, step for step. Gives the same
+		light grid (offset, count per tile) and light index lists as the
+		compute shader, so culling can be checked and compared without a GPU.
+
+		Two things are up to the GPU and can't be copied:
+		  - the order of the lights inside a tile (InterlockedAdd order),
+		    here they are always in light order
+		  - the offset of a tile in the index list (global counter), here
+		    the tiles are in row order
+		So compare the tiles as sets, not the raw index list.
+
+		Matrices are row major and vectors are multiplied from the left
+		(v * M, like XMVector4Transform). That is what the shader ends up
+		doing with the camera buffer, which is uploaded without transpose.
+
+		No D3D or SimpleMath in here on purpose.
+	*/
+	class TiledLightCuller {
+	public:
+		// same size as the shader groupshared lists
+		static const uint32_t MAX_TILE_LIGHTS = 1024;
+
+		// same layout as Plane and Frustum in LightGrid.h
+		struct CullPlane {
+			float nx, ny, nz, d;
+		};
+
+		struct CullFrustum {
+			CullPlane planes[4];
+		};
+
+		// world space, what the shader reads from Light
+		struct CullLight {
+			float position[3];
+			float range;
+		};
+
+		TiledLightCuller(uint32_t width, uint32_t height, uint32_t blockSize);
+		virtual ~TiledLightCuller();
+
+		// same as LightGrid::generateFrustumsCPU, one view space frustum per tile
+		void buildFrustums(const float invProj[16]);
+
+		// depth is width * height floats from the depth buffer, 1 is empty
+		void cull(const float view[16], const float invProj[16], const float *depth, const CullLight *lights, size_t lightCount);
+
+		uint32_t getTilesX() const { return m_TilesX; }
+		uint32_t getTilesY() const { return m_TilesY; }
+
+		const std::vector<CullFrustum> &getFrustums() const { return m_Frustums; }
+
+		// two per tile, x + y * getTilesX(): offset in the index list and count
+		const std::vector<uint32_t> &getOpaqueGrid() const { return m_OpaqueGrid; }
+		const std::vector<uint32_t> &getTransparentGrid() const { return m_TransparentGrid; }
+
+		const std::vector<uint32_t> &getOpaqueIndexList() const { return m_OpaqueIndexList; }
+		const std::vector<uint32_t> &getTransparentIndexList() const { return m_TransparentIndexList; }
+
+	private:
+		uint32_t m_Width;
+		uint32_t m_Height;
+		uint32_t m_BlockSize;
+		uint32_t m_TilesX;
+		uint32_t m_TilesY;
+
+		std::vector<CullFrustum> m_Frustums;
+
+		std::vector<uint32_t> m_OpaqueGrid;
+		std::vector<uint32_t> m_TransparentGrid;
+		std::vector<uint32_t> m_OpaqueIndexList;
+		std::vector<uint32_t> m_TransparentIndexList;
+
+		float screenToViewZ(const float invProj[16], float depth) const;
+	};
+
+}
@@ -1,38 +1,31 @@
 #pragma once
-#include "Resources\Shader.h"
-#include <Engine\Constants.h>
-#include "Utility\ShaderResource.h"
-#include <CommonStates.h>
+#include "Resources/Shader.h"
+#include <Engine/Constants.h>
+#include "Utility/ShaderResource.h"
+#include "Device/CommonStates.h"
 #include "Structs.h"
+#include "Resources/TextureResidency.h"
+#include "Device/RenderDevice.h"
+#include "Utility/UIBatch.h"
 
 namespace Graphics
 {
     class Menu
     {
     public:
-        Menu(ID3D11Device * device, ID3D11DeviceContext * contex);
+        // the textures are in the SCOPE_MENU of residency, loaded and kept by it
+        Menu(RenderDevice * device, TextureResidency & residency);
         ~Menu();
 
-        void drawMenu(ID3D11Device * device, ID3D11DeviceContext * contex, Graphics::MenuInfo * info, ID3D11RenderTargetView * backBuffer);
-        
-        void unloadTextures();
+        // the background and the buttons, by the image names in the .lw data, in one batch
+        void drawMenu(RenderDevice * context, Graphics::MenuInfo * info, RenderTargetView * backBuffer);
 
 
     private:
-        void mapButtons(ID3D11DeviceContext * contex, ButtonInfo * info);
-        void createVBuffers(ID3D11Device * device);
-        void loadTextures(ID3D11Device * device, ID3D11DeviceContext * contex);
-        
+        UIBatch batch;
 
-        ID3D11ShaderResourceView * menuTexture;
-        ID3D11ShaderResourceView * buttonTexture;
-        ID3D11Buffer * buttonQuad;
-        ID3D11Buffer * menuQuad;
+        CommonStates * states;
 
-        DirectX::CommonStates * states;
-
-        Shader shader;
         MenuInfo * active;
-        bool loaded;
     };
 }
\ No newline at end of file
@@ -0,0 +1,298 @@
+#pragma once
+#include <math.h>
+#include <string.h>
+
+/*
+    The part of DirectXTK's SimpleMath the renderer uses, for the builds
+    without DirectXMath (CMakeLists.txt puts this folder on the include
+    path when it isn't Windows, the game always gets DirectXTK's).
+
+    Same layout and the same conventions: row vectors (v * M), right
+    handed, Matrix::Forward() is -z. Only what the Graphics code calls is
+    here, add to it the same way when something new is needed.
+*/
+
+namespace DirectX
+{
+    struct XMFLOAT3
+    {
+        float x, y, z;
+
+        XMFLOAT3() : x(0), y(0), z(0) {}
+        XMFLOAT3(float x, float y, float z) : x(x), y(y), z(z) {}
+    };
+
+    namespace SimpleMath
+    {
+        struct Matrix;
+
+        struct Vector2
+        {
+            float x, y;
+
+            Vector2() : x(0), y(0) {}
+            explicit Vector2(float f) : x(f), y(f) {}
+            Vector2(float x, float y) : x(x), y(y) {}
+
+            Vector2 operator+(Vector2 const & v) const { return Vector2(x + v.x, y + v.y); }
+            Vector2 operator-(Vector2 const & v) const { return Vector2(x - v.x, y - v.y); }
+            Vector2 operator*(float f) const { return Vector2(x * f, y * f); }
+            bool operator==(Vector2 const & v) const { return x == v.x && y == v.y; }
+            bool operator!=(Vector2 const & v) const { return !(*this == v); }
+        };
+
+        struct Vector3
+        {
+            float x, y, z;
+
+            Vector3() : x(0), y(0), z(0) {}
+            explicit Vector3(float f) : x(f), y(f), z(f) {}
+            Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+            Vector3 operator+(Vector3 const & v) const { return Vector3(x + v.x, y + v.y, z + v.z); }
+            Vector3 operator-(Vector3 const & v) const { return Vector3(x - v.x, y - v.y, z - v.z); }
+            Vector3 operator*(Vector3 const & v) const { return Vector3(x * v.x, y * v.y, z * v.z); }
+            Vector3 operator*(float f) const { return Vector3(x * f, y * f, z * f); }
+            Vector3 operator/(float f) const { return Vector3(x / f, y / f, z / f); }
+            Vector3 operator-() const { return Vector3(-x, -y, -z); }
+            Vector3 & operator+=(Vector3 const & v) { x += v.x; y += v.y; z += v.z; return *this; }
+            Vector3 & operator-=(Vector3 const & v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+            Vector3 & operator*=(float f) { x *= f; y *= f; z *= f; return *this; }
+            bool operator==(Vector3 const & v) const { return x == v.x && y == v.y && z == v.z; }
+            bool operator!=(Vector3 const & v) const { return !(*this == v); }
+
+            float Length() const { return sqrtf(LengthSquared()); }
+            float LengthSquared() const { return Dot(*this); }
+            float Dot(Vector3 const & v) const { return x * v.x + y * v.y + z * v.z; }
+            Vector3 Cross(Vector3 const & v) const { return Vector3(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x); }
+
+            void Normalize()
+            {
+                float length = Length();
+                if (length > 0)
+                    *this = *this / length;
+            }
+
+            // a point, divided by w like XMVector3TransformCoord
+            static Vector3 Transform(Vector3 const & v, Matrix const & m);
+        };
+
+        inline Vector3 operator*(float f, Vector3 const & v) { return v * f; }
+
+        struct Vector4
+        {
+            float x, y, z, w;
+
+            Vector4() : x(0), y(0), z(0), w(0) {}
+            explicit Vector4(float f) : x(f), y(f), z(f), w(f) {}
+            Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+            Vector4 operator+(Vector4 const & v) const { return Vector4(x + v.x, y + v.y, z + v.z, w + v.w); }
+            Vector4 operator-(Vector4 const & v) const { return Vector4(x - v.x, y - v.y, z - v.z, w - v.w); }
+            Vector4 operator*(float f) const { return Vector4(x * f, y * f, z * f, w * f); }
+            Vector4 operator-() const { return Vector4(-x, -y, -z, -w); }
+            bool operator==(Vector4 const & v) const { return x == v.x && y == v.y && z == v.z && w == v.w; }
+            bool operator!=(Vector4 const & v) const { return !(*this == v); }
+
+            static Vector4 Transform(Vector4 const & v, Matrix const & m);
+        };
+
+        struct Color
+        {
+            float x, y, z, w;   // r, g, b, a like DirectXTK's
+
+            Color() : x(0), y(0), z(0), w(1) {}
+            Color(float r, float g, float b) : x(r), y(g), z(b), w(1) {}
+            Color(float r, float g, float b, float a) : x(r), y(g), z(b), w(a) {}
+
+            float R() const { return x; }
+            float G() const { return y; }
+            float B() const { return z; }
+            float A() const { return w; }
+        };
+
+        struct Rectangle
+        {
+            long x, y;
+            long width, height;
+
+            Rectangle() : x(0), y(0), width(0), height(0) {}
+            Rectangle(long x, long y, long width, long height) : x(x), y(y), width(width), height(height) {}
+        };
+
+        struct Matrix
+        {
+            union
+            {
+                struct
+                {
+                    float _11, _12, _13, _14;
+                    float _21, _22, _23, _24;
+                    float _31, _32, _33, _34;
+                    float _41, _42, _43, _44;
+                };
+                float m[4][4];
+            };
+
+            Matrix() : Matrix(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1) {}
+            Matrix(float m00, float m01, float m02, float m03,
+                   float m10, float m11, float m12, float m13,
+                   float m20, float m21, float m22, float m23,
+                   float m30, float m31, float m32, float m33)
+            {
+                _11 = m00; _12 = m01; _13 = m02; _14 = m03;
+                _21 = m10; _22 = m11; _23 = m12; _24 = m13;
+                _31 = m20; _32 = m21; _33 = m22; _34 = m23;
+                _41 = m30; _42 = m31; _43 = m32; _44 = m33;
+            }
+
+            bool operator==(Matrix const & other) const { return memcmp(m, other.m, sizeof(m)) == 0; }
+            bool operator!=(Matrix const & other) const { return !(*this == other); }
+
+            Matrix operator*(Matrix const & other) const
+            {
+                Matrix result;
+                for (int row = 0; row < 4; row++)
+                    for (int column = 0; column < 4; column++)
+                        result.m[row][column] =
+                            m[row][0] * other.m[0][column] + m[row][1] * other.m[1][column] +
+                            m[row][2] * other.m[2][column] + m[row][3] * other.m[3][column];
+                return result;
+            }
+
+            Vector3 Right() const { return Vector3(_11, _12, _13); }
+            Vector3 Up() const { return Vector3(_21, _22, _23); }
+            Vector3 Backward() const { return Vector3(_31, _32, _33); }
+            Vector3 Forward() const { return Vector3(-_31, -_32, -_33); }
+            Vector3 Translation() const { return Vector3(_41, _42, _43); }
+
+            Matrix Transpose() const
+            {
+                return Matrix(_11, _21, _31, _41, _12, _22, _32, _42, _13, _23, _33, _43, _14, _24, _34, _44);
+            }
+
+            // cofactors over the determinant, a singular matrix gives back the identity
+            Matrix Invert() const
+            {
+                const float * a = &_11;
+                float inv[16];
+                inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+                inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+                inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+                inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+                inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+                inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+                inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+                inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+                inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+                inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+                inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+                inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+                inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+                inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+                inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+                inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+                float determinant = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+                if (determinant == 0)
+                    return Matrix();
+
+                Matrix result;
+                for (int i = 0; i < 16; i++)
+                    (&result._11)[i] = inv[i] / determinant;
+                return result;
+            }
+
+            static Matrix CreateTranslation(Vector3 const & position)
+            {
+                return CreateTranslation(position.x, position.y, position.z);
+            }
+
+            static Matrix CreateTranslation(float x, float y, float z)
+            {
+                Matrix result;
+                result._41 = x; result._42 = y; result._43 = z;
+                return result;
+            }
+
+            static Matrix CreateScale(Vector3 const & scale)
+            {
+                Matrix result;
+                result._11 = scale.x; result._22 = scale.y; result._33 = scale.z;
+                return result;
+            }
+
+            static Matrix CreateScale(float scale)
+            {
+                return CreateScale(Vector3(scale));
+            }
+
+            static Matrix CreateRotationX(float radians)
+            {
+                float c = cosf(radians), s = sinf(radians);
+                return Matrix(1, 0, 0, 0, 0, c, s, 0, 0, -s, c, 0, 0, 0, 0, 1);
+            }
+
+            static Matrix CreateRotationY(float radians)
+            {
+                float c = cosf(radians), s = sinf(radians);
+                return Matrix(c, 0, -s, 0, 0, 1, 0, 0, s, 0, c, 0, 0, 0, 0, 1);
+            }
+
+            static Matrix CreateRotationZ(float radians)
+            {
+                float c = cosf(radians), s = sinf(radians);
+                return Matrix(c, s, 0, 0, -s, c, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+            }
+
+            // right handed, depth 0 at nearPlane and 1 at farPlane
+            static Matrix CreatePerspectiveFieldOfView(float fieldOfView, float aspectRatio, float nearPlane, float farPlane)
+            {
+                float yScale = 1.f / tanf(fieldOfView * 0.5f);
+                float xScale = yScale / aspectRatio;
+                float range = farPlane / (nearPlane - farPlane);
+                return Matrix(
+                    xScale, 0, 0, 0,
+                    0, yScale, 0, 0,
+                    0, 0, range, -1,
+                    0, 0, range * nearPlane, 0
+                );
+            }
+
+            static Matrix CreateLookAt(Vector3 const & position, Vector3 const & target, Vector3 const & up)
+            {
+                Vector3 zAxis = position - target;
+                zAxis.Normalize();
+                Vector3 xAxis = up.Cross(zAxis);
+                xAxis.Normalize();
+                Vector3 yAxis = zAxis.Cross(xAxis);
+
+                return Matrix(
+                    xAxis.x, yAxis.x, zAxis.x, 0,
+                    xAxis.y, yAxis.y, zAxis.y, 0,
+                    xAxis.z, yAxis.z, zAxis.z, 0,
+                    -xAxis.Dot(position), -yAxis.Dot(position), -zAxis.Dot(position), 1
+                );
+            }
+        };
+
+        inline Vector3 Vector3::Transform(Vector3 const & v, Matrix const & m)
+        {
+            float x = v.x * m._11 + v.y * m._21 + v.z * m._31 + m._41;
+            float y = v.x * m._12 + v.y * m._22 + v.z * m._32 + m._42;
+            float z = v.x * m._13 + v.y * m._23 + v.z * m._33 + m._43;
+            float w = v.x * m._14 + v.y * m._24 + v.z * m._34 + m._44;
+            return w != 0 ? Vector3(x / w, y / w, z / w) : Vector3(x, y, z);
+        }
+
+        inline Vector4 Vector4::Transform(Vector4 const & v, Matrix const & m)
+        {
+            return Vector4(
+                v.x * m._11 + v.y * m._21 + v.z * m._31 + v.w * m._41,
+                v.x * m._12 + v.y * m._22 + v.z * m._32 + v.w * m._42,
+                v.x * m._13 + v.y * m._23 + v.z * m._33 + v.w * m._43,
+                v.x * m._14 + v.y * m._24 + v.z * m._34 + v.w * m._44
+            );
+        }
+    }
+}
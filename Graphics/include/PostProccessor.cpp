@@ -1,20 +1,21 @@
 #include "PostProccessor.h"
-#include <WICTextureLoader.h>
-#include "ThrowIfFailed.h"
 #include <string>
 #define _USE_MATH_DEFINES
 #include <math.h>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
 #define KERNELSIZE 7
 #define SIGMA 2
 
-Graphics::PostProcessor::PostProcessor(ID3D11Device * device, ID3D11DeviceContext * context)
+Graphics::PostProcessor::PostProcessor(Graphics::RenderDevice * device)
 	: glow(device, SHADER_PATH("Glow.hlsl"))
 	, glow2(device, SHADER_PATH("GlowSecond.hlsl"))
 	, merger(device, SHADER_PATH("Merger.hlsl"))
 	, glowPass0(device, WIN_WIDTH / 2, WIN_HEIGHT / 2)
 	, glowPass1(device, WIN_WIDTH / 2, WIN_HEIGHT / 2)
 {
-	this->states = new DirectX::CommonStates(device);
+	this->states = new CommonStates(device);
 
 	//Enable this only if you want a new gaussian filter
 	//auto kernels = generateKernel(KERNELSIZE, SIGMA);
@@ -58,17 +59,19 @@ std::vector<float> Graphics::PostProcessor::generateKernel(int kernelSize, float
 		output += L", ";
 	}
 	output += L"\n";
+#ifdef _WIN32
 	OutputDebugStringW(output.c_str());
+#endif
 
 	return kernel;
 }
 
-void Graphics::PostProcessor::addGlow(ID3D11DeviceContext * context, ID3D11ShaderResourceView * backBuffer, ID3D11ShaderResourceView * glowMap, ShaderResource * outputTexture)
+void Graphics::PostProcessor::addGlow(Graphics::RenderDevice * context, Graphics::ShaderResourceView * backBuffer, Graphics::ShaderResourceView * glowMap, ShaderResource * outputTexture)
 {
-	ID3D11UnorderedAccessView * nullUAV = nullptr;
-	ID3D11ShaderResourceView * nullSRV = nullptr;
+	Graphics::UnorderedAccessView * nullUAV = nullptr;
+	Graphics::ShaderResourceView * nullSRV = nullptr;
 
-	context->CSSetShader(glow, nullptr, 0);
+	context->CSSetShader(glow);
 	context->CSSetUnorderedAccessViews(0, 1, glowPass0, nullptr);
 	context->CSSetShaderResources(0, 1, &glowMap);
 	context->Dispatch(WIN_WIDTH / 32, WIN_HEIGHT / 18, 1);
@@ -77,12 +80,12 @@ void Graphics::PostProcessor::addGlow(ID3D11DeviceContext * context, ID3D11Shade
 	context->CSSetUnorderedAccessViews(0, 1, glowPass1, nullptr);
 	context->CSSetShaderResources(0, 1, glowPass0);
 
-	context->CSSetShader(glow2, nullptr, 0);
+	context->CSSetShader(glow2);
 	context->Dispatch(WIN_WIDTH / 32, WIN_HEIGHT / 18, 1);
 
 	context->CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
 
-	context->CSSetShader(merger, nullptr, 0);
+	context->CSSetShader(merger);
 	auto sampler = states->LinearWrap();
 	context->CSSetSamplers(0, 1, &sampler);
 
@@ -1,9 +1,9 @@
 #pragma once
-#include "Resources\Shader.h"
-#include <Engine\Constants.h>
-#include "Utility\ShaderResource.h"
-#include <CommonStates.h>
-#include "Utility\ConstantBuffer.h"
+#include "Resources/Shader.h"
+#include <Engine/Constants.h>
+#include "Utility/ShaderResource.h"
+#include "Device/CommonStates.h"
+#include "Utility/ConstantBuffer.h"
 #include <vector>
 
 namespace Graphics
@@ -11,10 +11,10 @@ namespace Graphics
 	class PostProcessor
 	{
 	public:
-		PostProcessor(ID3D11Device * device, ID3D11DeviceContext * context);
+		PostProcessor(RenderDevice * device);
 		~PostProcessor();
 
-		void addGlow(ID3D11DeviceContext * context, ID3D11ShaderResourceView * backBuffer, ID3D11ShaderResourceView * glowMap, ShaderResource * outputTexture);
+		void addGlow(RenderDevice * context, ShaderResourceView * backBuffer, ShaderResourceView * glowMap, ShaderResource * outputTexture);
 
 		std::vector<float> generateKernel(int kernelSize, float sigma);
 	private:
@@ -25,6 +25,6 @@ namespace Graphics
 		ShaderResource glowPass0;
 		ShaderResource glowPass1;
 
-		DirectX::CommonStates * states;
+		CommonStates * states;
 	};
 }
\ No newline at end of file
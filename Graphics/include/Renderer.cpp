@@ -1,61 +1,99 @@
-#include <Graphics\include\Renderer.h>
+#include <Graphics/include/Renderer.h>
 #include <stdio.h>
-#include <Graphics\include\ThrowIfFailed.h>
-#include <Engine\Constants.h>
+#include <string.h>
+#include <algorithm>
+#include <Engine/Constants.h>
 
-#include <Engine\Profiler.h>
+#ifdef _WIN32
+#include <Windows.h>
+#include <Engine/Profiler.h>
+#else
+#define PROFILE_COUNTER(name, value) // the profiler is D3D11 and ImGui
+#endif
 
 #define USE_TEMP_CUBE false
 #define ANIMATION_HIJACK_RENDER false
+#define USE_CLUSTERED_LIGHTS true // false is the old 2D tiles with NUM_LIGHTS lights
 
 #if USE_TEMP_CUBE
 #include "TempCube.h"
 #endif
 #if ANIMATION_HIJACK_RENDER
-#include "Animation\AnimatedTestCube.h"
+#include "Animation/AnimatedTestCube.h"
 #endif
 
 #define MAX_DEBUG_POINTS 10000
+#define RENDER_DEPTH_RANGE 100.f // same as the default camera draw distance
+#define LOD_MIN_DEPTH 0.1f // closer than this (or behind) is always the full mesh
+#define OCCLUSION_WIDTH 256 // the software depth buffer for the occlusion culling, 16:9 like the window
+#define OCCLUSION_HEIGHT 144
+#define ASSET_UPLOADS_PER_FRAME 4 // models and textures created each frame while loading
+#define UI_TEXTURE_BUDGET (16 * 1024 * 1024) // menu and HUD textures kept loaded, in bytes
+#define SHADOW_LOD_BIAS 1 // shadows are blurry anyway, one LOD coarser than what the camera sees
 
 namespace Graphics
 {
+#if USE_CLUSTERED_LIGHTS
+    static const ShaderDefine FORWARD_PLUS_DEFINES[] = { { "CLUSTERED", "1" }, { nullptr, nullptr } };
+#else
+    static const ShaderDefine * FORWARD_PLUS_DEFINES = nullptr;
+#endif
 
-	Renderer::Renderer(ID3D11Device * device, ID3D11DeviceContext * deviceContext, ID3D11RenderTargetView * backBuffer, Camera *camera)
-		: forwardPlus(device, SHADER_PATH("ForwardPlus.hlsl"), VERTEX_DESC)
-		, fullscreenQuad(device, SHADER_PATH("FullscreenQuad.hlsl"), { { "POSITION", 0, DXGI_FORMAT_R8_UINT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 } })
+	Renderer::Renderer(RenderDevice * device, GpuTexture * backBuffer, Camera *camera)
+		: occlusionCuller(OCCLUSION_WIDTH, OCCLUSION_HEIGHT)
 		, depthStencil(device, WIN_WIDTH, WIN_HEIGHT)
-        , instanceSBuffer(device, CpuAccess::Write, INSTANCE_CAP)
-        , instanceOffsetBuffer(device)
 		, skyRenderer(device, SHADOW_MAP_RESOLUTION)
-		, postProcessor(device, deviceContext)
+		, postProcessor(device)
+		, clusteredLights(device)
+		, fullscreenQuad(device, SHADER_PATH("FullscreenQuad.hlsl"), { { "POSITION", 0, FORMAT_R8_UINT, 0, 0 } })
+		, forwardPlus(device, SHADER_PATH("ForwardPlus.hlsl"), COMPRESSED_VERTEX_DESC, FORWARD_PLUS_DEFINES)
+        , instanceBuffer(device, INSTANCE_START_CAPACITY, INSTANCE_MAX_CAPACITY)
+        , staticInstances(device)
+        , batchBuffer(device)
 		, fakeBackBuffer(device, WIN_WIDTH, WIN_HEIGHT)
 		, fakeBackBufferSwap(device, WIN_WIDTH, WIN_HEIGHT)
 		, glowMap(device, WIN_WIDTH, WIN_HEIGHT)
-        ,menu(device, deviceContext)
-        ,hud(device, deviceContext)
+        ,textureLoader(device, true)
+        ,textureResidency(textureLoader, UI_TEXTURE_BUDGET)
+        ,menu(device, textureResidency)
+        ,hud(device, textureResidency)
     #pragma region RenderDebugInfo
-        , debugPointsBuffer(device, CpuAccess::Write, MAX_DEBUG_POINTS)
         , debugRender(device, SHADER_PATH("DebugRender.hlsl"))
+        , debugPointsBuffer(device, CpuAccess::Write, MAX_DEBUG_POINTS)
         , debugColorBuffer(device)
     #pragma endregion
 
 	{
-		this->device = device;
-		this->deviceContext = deviceContext;
-		this->backBuffer = backBuffer;
+		this->renderDevice = device;
+		this->backBufferTexture = backBuffer;
+		this->backBuffer = device->CreateRenderTargetView(backBuffer);
 		
-		initialize(device, deviceContext);
+		initialize();
 
-        viewPort = { 0 };
-        viewPort.Width = WIN_WIDTH;
-        viewPort.Height = WIN_HEIGHT;
-        viewPort.MaxDepth = 1.0f;
+        viewPort = {};
+        viewPort.width = WIN_WIDTH;
+        viewPort.height = WIN_HEIGHT;
+        viewPort.maxDepth = 1.0f;
 
-		states = new DirectX::CommonStates(device);
-		grid.initialize(camera, device, deviceContext, &resourceManager);
+		states = new CommonStates(device);
+
+		UINT width, height;
+		getBackBufferSize(width, height);
+#if USE_CLUSTERED_LIGHTS
+		lightTileSize = CLUSTER_TILE_SIZE;
+		clusteredLights.resize(width, height, lightTileSize);
+		grid.initialize(camera, device, &resourceManager, width, height, BLOCK_SIZE);
+#else
+		lightTileSize = BLOCK_SIZE;
+		grid.initialize(camera, device, &resourceManager, width, height, lightTileSize);
+#endif
 
         //menuSprite = std::make_unique<DirectX::SpriteBatch>(deviceContext);
         createBlendState();
+
+        instances.reserve(INSTANCE_START_CAPACITY);
+        commandList.reserve(INSTANCE_START_CAPACITY);
+        commandList.setMaxBatchSize(INSTANCE_MAX_CAPACITY);
     }
 
 
@@ -64,115 +102,140 @@ namespace Graphics
 		delete states;
 
 		SAFE_RELEASE(transparencyBlendState);
+		SAFE_RELEASE(backBuffer);
 
 		SAFE_RELEASE(glowTest);
         resourceManager.release();
 
     }
 
-    void Renderer::initialize(ID3D11Device *gDevice, ID3D11DeviceContext* gDeviceContext)
+    void Renderer::initialize()
     {
-        resourceManager.initialize(gDevice, gDeviceContext);
+        resourceManager.initialize(renderDevice);
 
 		//temp
-		DirectX::CreateWICTextureFromFile(device, TEXTURE_PATH("glowMapTree.png"), NULL, &glowTest);
+		if (!TextureManager::createTextureFromFile(renderDevice, TEXTURE_PATH_SIMPLE "glowMapTree.png", false, &glowTest))
+			glowTest = nullptr;
 
 
     }
 
 	void Renderer::updateLight(float deltaTime, Camera * camera)
 	{
-		skyRenderer.update(deviceContext, deltaTime, camera->getPos());
+		skyRenderer.update(renderDevice, deltaTime, camera->getPos());
 	}
 
     void Renderer::render(Camera * camera)
     {
-        menu.unloadTextures();
+        drawCalls = 0;
+        shadowCasters = 0;
+        occlusionTested = 0;
+        occlusionCulled = 0;
+        stateChanges = 0;
+        skippedBinds = 0;
+
+        // render or drawMenu, one of them is called a frame
+        textureResidency.beginFrame();
+        textureResidency.setActiveScopes(TextureResidency::SCOPE_GAME | TextureResidency::SCOPE_HUD);
+        resourceManager.update(ASSET_UPLOADS_PER_FRAME);
 #if ANIMATION_HIJACK_RENDER
 
         renderQueue.clear();
-        static Camera cam(device, WIN_WIDTH, WIN_HEIGHT);
+        static Camera cam(renderDevice, WIN_WIDTH, WIN_HEIGHT);
         static UINT ticks = 0;
         ticks++;
-        cam.updateLookAt({ 5 * sinf(ticks * 0.001f), 5 * cosf(ticks * 0.001f), 5 }, { 0,0,0 }, deviceContext);
+        cam.updateLookAt({ 5 * sinf(ticks * 0.001f), 5 * cosf(ticks * 0.001f), 5 }, { 0,0,0 }, renderDevice);
 
-        ID3D11Buffer *cameraBuffer = cam.getBuffer();
-        deviceContext->VSSetConstantBuffers(0, 1, &cameraBuffer);
-        deviceContext->PSSetConstantBuffers(0, 1, &cameraBuffer);
+        GpuBuffer *cameraBuffer = cam.getBuffer();
+        renderDevice->VSSetConstantBuffers(0, 1, &cameraBuffer);
+        renderDevice->PSSetConstantBuffers(0, 1, &cameraBuffer);
 
         static float clearColor[4] = { 0,0,0,1 };
-        deviceContext->ClearRenderTargetView(backBuffer, clearColor);
-        deviceContext->ClearDepthStencilView(depthStencil, D3D11_CLEAR_DEPTH, 1.f, 0);
+        renderDevice->ClearRenderTargetView(backBuffer, clearColor);
+        renderDevice->ClearDepthStencilView(depthStencil, CLEAR_DEPTH, 1.f, 0);
 
-        deviceContext->RSSetViewports(1, &viewPort);
+        renderDevice->RSSetViewports(1, &viewPort);
 
-        static AnimatedTestCube testCube(device);
-        static Shader testShader(device, SHADER_PATH("AnimationTest.hlsl"), ANIMATED_VERTEX_DESC);
+        static AnimatedTestCube testCube(renderDevice);
+        static Shader testShader(renderDevice, SHADER_PATH("AnimationTest.hlsl"), ANIMATED_VERTEX_DESC);
 
-        deviceContext->IASetInputLayout(testShader);
-        deviceContext->VSSetShader(testShader, nullptr, 0);
-        deviceContext->PSSetShader(testShader, nullptr, 0);
+        renderDevice->IASetInputLayout(testShader);
+        renderDevice->VSSetShader(testShader);
+        renderDevice->PSSetShader(testShader);
 
-        deviceContext->IASetVertexBuffers(0, 1, testCube, &testCube.stride, &testCube.offset);
-        deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        deviceContext->RSSetState(states->CullNone());
+        renderDevice->IASetVertexBuffers(0, 1, testCube, &testCube.stride, &testCube.offset);
+        renderDevice->IASetPrimitiveTopology(TOPOLOGY_TRIANGLELIST);
+        renderDevice->RSSetState(states->CullNone());
 
-        deviceContext->OMSetRenderTargets(1, &backBuffer, depthStencil);
+        renderDevice->OMSetRenderTargets(1, &backBuffer, depthStencil);
 
-        deviceContext->Draw(testCube.vertexCount, 0);
+        renderDevice->Draw(testCube.vertexCount, 0);
 
         auto jointTransforms = testSkeleton.getJointTransforms(testAnimation, testAnimation.getTotalDuration() * ((ticks % 1000) / 1000.f));
 
-        static StructuredBuffer<Matrix> jointBuffer(device, CpuAccess::Write, testSkeleton.getJointCount());
-        Matrix* bufferPtr = jointBuffer.map(deviceContext);
+        static StructuredBuffer<Matrix> jointBuffer(renderDevice, CpuAccess::Write, testSkeleton.getJointCount());
+        Matrix* bufferPtr = jointBuffer.map(renderDevice);
         memcpy(bufferPtr, jointTransforms.data(), sizeof(Matrix) * jointTransforms.size());
-        jointBuffer.unmap(deviceContext);
+        jointBuffer.unmap(renderDevice);
 
-        ID3D11ShaderResourceView * jointView = jointBuffer.getSRV();
-        deviceContext->VSSetShaderResources(0, 1, &jointView);
+        ShaderResourceView * jointView = jointBuffer.getSRV();
+        renderDevice->VSSetShaderResources(0, 1, &jointView);
 
 #else
-        cull();
+        // the cascades have to be fitted before cull, it picks the casters for them
+        skyRenderer.updateShadows(renderDevice, camera);
+        cull(camera);
         writeInstanceData();
 
-		//Drawshadows does not actually draw anything, it just sets up everything for drawing shadows
-		skyRenderer.drawShadows(deviceContext, &forwardPlus);
-		draw();
+		for (UINT i = 0; i < SHADOW_CASCADES; i++)
+		{
+			// the cascades that weren't updated keep their shadow map from an earlier frame
+			if (skyRenderer.getUpdatedCascades() & (1 << i))
+			{
+				//Drawshadows does not actually draw anything, it just sets up everything for drawing shadows
+				skyRenderer.drawShadows(renderDevice, &forwardPlus, i);
+				draw(RenderCommandList::PASS_SHADOW_0 + i, SHADOW_LOD_BIAS);
+			}
+		}
 
 
-		ID3D11Buffer *cameraBuffer = camera->getBuffer();
-		deviceContext->VSSetConstantBuffers(0, 1, &cameraBuffer);
-		deviceContext->PSSetConstantBuffers(0, 1, &cameraBuffer);
+		GpuBuffer *cameraBuffer = camera->getBuffer();
+		renderDevice->VSSetConstantBuffers(0, 1, &cameraBuffer);
+		renderDevice->PSSetConstantBuffers(0, 1, &cameraBuffer);
 
 		static float clearColor[4] = { 0, 0.5, 0.7, 1 };
 		static float blackClearColor[4] = {0};
-		deviceContext->ClearRenderTargetView(fakeBackBuffer, clearColor);
-		deviceContext->ClearRenderTargetView(glowMap, blackClearColor);
-		deviceContext->ClearRenderTargetView(backBuffer, clearColor);
-        deviceContext->ClearDepthStencilView(depthStencil, D3D11_CLEAR_DEPTH, 1.f, 0);
+		renderDevice->ClearRenderTargetView(fakeBackBuffer, clearColor);
+		renderDevice->ClearRenderTargetView(glowMap, blackClearColor);
+		renderDevice->ClearRenderTargetView(backBuffer, clearColor);
+        renderDevice->ClearDepthStencilView(depthStencil, CLEAR_DEPTH, 1.f, 0);
 
 
-		deviceContext->RSSetViewports(1, &viewPort);
-		deviceContext->RSSetState(states->CullCounterClockwise());
+		renderDevice->RSSetViewports(1, &viewPort);
+		renderDevice->RSSetState(states->CullCounterClockwise());
 
-        deviceContext->IASetInputLayout(forwardPlus);
-        deviceContext->VSSetShader(forwardPlus, nullptr, 0);
+        renderDevice->IASetInputLayout(forwardPlus);
+        renderDevice->VSSetShader(forwardPlus);
 
-        deviceContext->PSSetShader(nullptr, nullptr, 0);
-        deviceContext->OMSetRenderTargets(0, nullptr, depthStencil);
-        deviceContext->OMSetDepthStencilState(states->DepthDefault(), 0);
+        renderDevice->PSSetShader(nullptr);
+        renderDevice->OMSetRenderTargets(0, nullptr, depthStencil);
+        renderDevice->OMSetDepthStencilState(states->DepthDefault(), 0);
 
-        draw();
+        draw(RenderCommandList::PASS_OPAQUE);
 
-        deviceContext->OMSetRenderTargets(0, nullptr, nullptr);
+        renderDevice->OMSetRenderTargets(0, nullptr, nullptr);
 
     #pragma region Light Temp
         static 	float f = 59.42542;
         f += 0.001f;
 
+#if USE_CLUSTERED_LIGHTS
+        Light ptr[NUM_LIGHTS];
+#else
         auto lights = grid.getLights();
 
-        Light *ptr = lights->map(deviceContext);
+        Light *ptr = lights->map(renderDevice);
+#endif
         for (int i = 0; i < NUM_LIGHTS; i++) {
             ptr[i].color = DirectX::SimpleMath::Vector3(
                 ((unsigned char)(5 + i * 53 * i + 4)) / 255.f,
@@ -190,85 +253,204 @@ namespace Graphics
             ptr[i].intensity = 1.f;
         }
 
-        lights->unmap(deviceContext);
+#if USE_CLUSTERED_LIGHTS
+        lightQueue.insert(lightQueue.end(), ptr, ptr + NUM_LIGHTS);
+#else
+        lights->unmap(renderDevice);
+#endif
     #pragma endregion
 
-        grid.cull(camera, states, depthStencil, device, deviceContext, &resourceManager);
+        UINT width, height;
+        getBackBufferSize(width, height);
+#if USE_CLUSTERED_LIGHTS
+        if (width != clusteredLights.getWidth() || height != clusteredLights.getHeight() || lightTileSize != clusteredLights.getTileSize())
+            clusteredLights.resize(width, height, lightTileSize);
 
-        deviceContext->IASetInputLayout(forwardPlus);
-        deviceContext->VSSetShader(forwardPlus, nullptr, 0);
-        deviceContext->PSSetShader(forwardPlus, nullptr, 0);
+        clusteredLights.update(renderDevice, camera, lightQueue);
+        lightQueue.clear();
+#else
+        if (width != grid.getWidth() || height != grid.getHeight() || lightTileSize != grid.getTileSize())
+            grid.resize(camera, renderDevice, width, height, lightTileSize);
+
+        grid.cull(camera, states, depthStencil, renderDevice, &resourceManager);
+#endif
+
+        renderDevice->IASetInputLayout(forwardPlus);
+        renderDevice->VSSetShader(forwardPlus);
+        renderDevice->PSSetShader(forwardPlus);
 
 		
 
-		ID3D11ShaderResourceView *SRVs[] = {
+#if USE_CLUSTERED_LIGHTS
+		ShaderResourceView *SRVs[] = {
+			clusteredLights.getIndexListSRV(),
+			clusteredLights.getGridSRV(),
+			clusteredLights.getLightsSRV(),
+			*skyRenderer.getDepthStencil()
+		};
+		GpuBuffer *clusterParams = clusteredLights.getParamsBuffer();
+		renderDevice->PSSetConstantBuffers(4, 1, &clusterParams);
+#else
+		ShaderResourceView *SRVs[] = {
 			grid.getOpaqueIndexList()->getSRV(),
 			grid.getOpaqueLightGridSRV(),
 			grid.getLights()->getSRV(),
 			*skyRenderer.getDepthStencil()
 		};
+		GpuBuffer *gridParams = grid.getParamsBuffer();
+		renderDevice->PSSetConstantBuffers(4, 1, &gridParams);
+#endif
 		auto sampler = states->LinearClamp();
-		deviceContext->PSSetShaderResources(0, 4, SRVs);
-		deviceContext->PSSetSamplers(0, 1, &sampler);
+		renderDevice->PSSetShaderResources(0, 4, SRVs);
+		renderDevice->PSSetSamplers(0, 1, &sampler);
 
-		ID3D11SamplerState * samplers[] = { skyRenderer.getSampler() };
-		deviceContext->PSSetSamplers(1, 1, samplers);
+		SamplerState * samplers[] = { skyRenderer.getSampler() };
+		renderDevice->PSSetSamplers(1, 1, samplers);
 
-		ID3D11Buffer *lightBuffs[] =
+		GpuBuffer *lightBuffs[] =
 		{
 			skyRenderer.getShaderBuffer(),
-			skyRenderer.getLightMatrixBuffer()
+			skyRenderer.getCascadeBuffer()
 		};
 		
-		deviceContext->PSSetConstantBuffers(1, 1, &lightBuffs[0]);
-		deviceContext->VSSetConstantBuffers(2, 1, &lightBuffs[1]);
+		renderDevice->PSSetConstantBuffers(1, 2, lightBuffs);
 
-		ID3D11RenderTargetView * rtvs[] =
+		RenderTargetView * rtvs[] =
 		{
 			fakeBackBuffer,
 			glowMap
 		};
-		deviceContext->OMSetRenderTargets(2, rtvs, depthStencil);
+		renderDevice->OMSetRenderTargets(2, rtvs, depthStencil);
 		
-		draw();
-		skyRenderer.renderSky(deviceContext, camera);
+		draw(RenderCommandList::PASS_OPAQUE);
+		skyRenderer.renderSky(renderDevice, camera);
 
-		ID3D11RenderTargetView * rtvNULL[2] = {nullptr};
+		RenderTargetView * rtvNULL[2] = {nullptr};
 
-        deviceContext->OMSetRenderTargets(2, rtvNULL, nullptr);
+        renderDevice->OMSetRenderTargets(2, rtvNULL, nullptr);
 
-        ZeroMemory(SRVs, sizeof(SRVs));
-        deviceContext->PSSetShaderResources(0, 4, SRVs);
+        memset(SRVs, 0, sizeof(SRVs));
+        renderDevice->PSSetShaderResources(0, 4, SRVs);
 
-        deviceContext->RSSetState(states->CullCounterClockwise());
+        renderDevice->RSSetState(states->CullCounterClockwise());
+#ifdef _WIN32
         SHORT tabKeyState = GetAsyncKeyState(VK_TAB);
         if ((1 << 15) & tabKeyState)
         {
             this->drawToBackbuffer(grid.getDebugSRV());
         }
+#endif
         
 #endif
 
 		///////Post effext
-		postProcessor.addGlow(deviceContext, fakeBackBuffer, glowMap, &fakeBackBufferSwap);
+		postProcessor.addGlow(renderDevice, fakeBackBuffer, glowMap, &fakeBackBufferSwap);
 
 
 		drawToBackbuffer(fakeBackBufferSwap);
 
         renderDebugInfo();
-        hud.drawHUD(deviceContext, backBuffer, transparencyBlendState);
-        
+        hud.drawHUD(renderDevice, backBuffer, transparencyBlendState);
+
+        PROFILE_COUNTER("Render commands", commandList.getCommands().size());
+        PROFILE_COUNTER("UI textures resident KB", textureResidency.getStats().residentBytes / 1024);
+        PROFILE_COUNTER("UI texture loads while drawing", textureResidency.getStats().misses);
+        PROFILE_COUNTER("Draw calls", drawCalls);
+        PROFILE_COUNTER("State changes", stateChanges);
+        PROFILE_COUNTER("Redundant binds skipped", skippedBinds);
+        PROFILE_COUNTER("Instance segments", instanceSegments.size());
+        PROFILE_COUNTER("Instance buffer high water mark", instanceBuffer.getHighWaterMark());
+        PROFILE_COUNTER("Instance bytes uploaded", instanceBytesUploaded);
+        PROFILE_COUNTER("Static instance bytes uploaded", staticInstances.getUploadedBytes());
+        PROFILE_COUNTER("Shadow casters", shadowCasters);
+        PROFILE_COUNTER("Occlusion tested", occlusionTested);
+        PROFILE_COUNTER("Occlusion culled", occlusionCulled);
+        PROFILE_COUNTER("Occluder triangles", occlusionCuller.getTriangleCount());
+        PROFILE_COUNTER("Assets loading", resourceManager.getLoadingCount());
+#if USE_CLUSTERED_LIGHTS
+        PROFILE_COUNTER("Lights", clusteredLights.getLightCount());
+        PROFILE_COUNTER("Cluster light indices", clusteredLights.getIndexCount());
+#endif
     }
 
 
-    void Renderer::queueRender(RenderInfo * renderInfo)
+    RenderDevice * Renderer::getRenderDevice()
+    {
+        return renderDevice;
+    }
+
+    void Renderer::setLightTileSize(UINT tileSize)
+    {
+#if USE_CLUSTERED_LIGHTS
+        // clusters are assigned on the CPU, there is no thread group to fit in
+        lightTileSize = tileSize < 1 ? 1 : tileSize;
+#else
+        lightTileSize = tileSize < 1 ? 1 : (tileSize > MAX_TILE_SIZE ? MAX_TILE_SIZE : tileSize);
+#endif
+    }
+
+    Renderer::FrameStats Renderer::getFrameStats() const
     {
-        if (renderQueue.size() > INSTANCE_CAP)
-            throw "Renderer Exceeded Instance Cap.";
+        FrameStats stats = {};
+        stats.drawCalls = drawCalls;
+        stats.stateChanges = stateChanges;
+        stats.instanceBytesUploaded = instanceBytesUploaded;
+        stats.staticInstanceBytesUploaded = staticInstances.getUploadedBytes();
+        stats.shadowCasters = shadowCasters;
+        for (UINT i = 0; i < SHADOW_CASCADES; i++)
+            stats.staticShadowCasters[i] = staticInstances.getCascadeCount(i);
+        stats.occlusionCulled = occlusionCulled;
+        stats.instanceHighWaterMark = instanceBuffer.getHighWaterMark();
+        return stats;
+    }
 
+    void Renderer::getBackBufferSize(UINT & width, UINT & height)
+    {
+        TextureDesc desc = renderDevice->GetDesc(backBufferTexture);
+        width = desc.width;
+        height = desc.height;
+    }
+
+    int Renderer::registerStatic(RenderInfo * renderInfo)
+    {
+        return staticInstances.add(*renderInfo);
+    }
+
+    void Renderer::updateStatic(int handle, RenderInfo * renderInfo)
+    {
+        staticInstances.update(handle, *renderInfo);
+    }
+
+    void Renderer::unregisterStatic(int handle)
+    {
+        staticInstances.remove(handle);
+    }
+
+    void Renderer::clearStatics()
+    {
+        staticInstances.clear();
+    }
+
+    void Renderer::setLoadingProgressCallback(AssetLoader::ProgressCallback callback)
+    {
+        resourceManager.setProgressCallback(callback);
+    }
+
+    void Renderer::finishLoading()
+    {
+        resourceManager.finishLoading();
+    }
+
+    void Renderer::queueRender(RenderInfo * renderInfo)
+    {
         renderQueue.push_back(renderInfo);
     }
 
+    void Renderer::queueLight(Light const & light)
+    {
+        lightQueue.push_back(light);
+    }
+
     void Renderer::queueRenderDebug(RenderDebugInfo * debugInfo)
     {
         renderDebugQueue.push_back(debugInfo);
@@ -298,103 +480,284 @@ namespace Graphics
 
 
 
-    void Renderer::cull()
+    void Renderer::cull(Camera * camera)
     {
-        instanceQueue.clear();
+        instances.clear();
+        commandList.clear();
+
+        static_assert(RenderCommandList::PASS_SHADOW_0 + SHADOW_CASCADES <= RenderCommandList::NR_OF_PASSES, "A pass for every cascade");
+        Graphics::ShadowCascades const & cascades = skyRenderer.getCascades();
+        uint32_t updatedCascades = skyRenderer.getUpdatedCascades();
+
+        DirectX::SimpleMath::Matrix view = camera->getView();
+
+        // static occluders hide the queued instances, the statics themselves are always drawn
+        DirectX::SimpleMath::Matrix viewProjection = view * camera->getProj();
+        occlusionCuller.clear(&viewProjection._11);
+        staticInstances.getOccluders(occluders);
+        for (RenderInfo const * occluder : occluders)
+        {
+            if (!resourceManager.isModelReady(occluder->meshId))
+                continue;
+
+            ModelInfo model = resourceManager.getModelInfo(occluder->meshId);
+            occlusionCuller.addOccluder(&occluder->translation._11, &model.boundsMin.x, &model.boundsMax.x);
+        }
+        occlusionCuller.buildHierarchy();
+
+        // pixels one unit covers at depth 1, on the back buffer the frame ends up in
+        UINT width, height;
+        getBackBufferSize(width, height);
+        float pixelsPerUnit = camera->getProj()._22 * height * 0.5f;
         for (RenderInfo * info : renderQueue)
         {
-            if (info->render)
+            // still loading, nothing to draw yet
+            if (info->render && resourceManager.isModelReady(info->meshId))
             {
-                instanceQueue[info->meshId].push_back({ info->translation });
+                // right handed view, forward is -z
+                float depth = -DirectX::SimpleMath::Vector3::Transform(info->translation.Translation(), view).z;
+
+                float scale = std::max(info->translation.Right().Length(), std::max(info->translation.Up().Length(), info->translation.Backward().Length()));
+                ModelInfo model = resourceManager.getModelInfo(info->meshId);
+                info->lod = selectMeshLod(model.lods, model.lodCount, scale * pixelsPerUnit / std::max(depth, LOD_MIN_DEPTH), info->lod);
+
+                // hidden or off screen, it can still throw a shadow onto something visible
+                occlusionTested++;
+                if (occlusionCuller.isVisible(&info->translation._11, &model.boundsMin.x, &model.boundsMax.x))
+                {
+                    commandList.push(RenderCommandList::makeKey(
+                        RenderCommandList::PASS_OPAQUE,
+                        info->backFaceCulling,
+                        0, // everything is forward plus for now
+                        info->materialId,
+                        info->meshId,
+                        info->lod,
+                        depth / RENDER_DEPTH_RANGE
+                    ), (UINT)instances.size());
+                }
+                else
+                {
+                    occlusionCulled++;
+                }
+
+                // the same instance again for every cascade it can throw a shadow into
+                DirectX::SimpleMath::Vector3 center = DirectX::SimpleMath::Vector3::Transform(model.boundsCenter, info->translation);
+                uint32_t casts = cascades.getCasterMask(&center.x, model.boundsRadius * scale, updatedCascades);
+                for (UINT i = 0; i < SHADOW_CASCADES; i++)
+                {
+                    if (casts & (1 << i))
+                    {
+                        commandList.push(RenderCommandList::makeKey(
+                            RenderCommandList::PASS_SHADOW_0 + i,
+                            info->backFaceCulling,
+                            0,
+                            info->materialId,
+                            info->meshId,
+                            info->lod,
+                            0.f
+                        ), (UINT)instances.size());
+                        shadowCasters++;
+                    }
+                }
+
+                instances.push_back({ info->translation });
             }
         }
         renderQueue.clear();
+
+        commandList.sort();
     }
 
     void Renderer::writeInstanceData()
     {
-        InstanceData* ptr = instanceSBuffer.map(deviceContext);
-        for (InstanceQueue_t::value_type & pair : instanceQueue)
+        instanceBuffer.beginFrame();
+        instanceSegments.clear();
+        instanceBytesUploaded = staticInstances.upload(renderDevice);
+
+        // statics only go into the cascades they reach, once their models are loaded they have bounds
+        for (RenderCommandList::Batch const & batch : staticInstances.getBatches())
         {
-            void * data = pair.second.data();
-            size_t size = pair.second.size() * sizeof(InstanceData);
-            memcpy(ptr, data, size);
-            ptr = (InstanceData*)((char*)ptr + size);
+            ModelID mesh = (ModelID)RenderCommandList::getMesh(batch.key);
+            if (!staticInstances.hasMeshBounds(mesh) && resourceManager.isModelReady(mesh))
+            {
+                ModelInfo model = resourceManager.getModelInfo(mesh);
+                staticInstances.setMeshBounds(mesh, model.boundsCenter, model.boundsRadius);
+            }
         }
-        instanceSBuffer.unmap(deviceContext);
+        staticInstances.cullCascades(skyRenderer.getCascades(), skyRenderer.getUpdatedCascades());
+
+        // batches are never bigger than INSTANCE_MAX_CAPACITY, so a segment always has at least one
+        const std::vector<RenderCommandList::Batch> & batches = commandList.getBatches();
+        InstanceSegment segment = {};
+        for (UINT i = 0; i < batches.size(); i++)
+        {
+            if (segment.instanceCount + batches[i].count > INSTANCE_MAX_CAPACITY)
+            {
+                instanceSegments.push_back(segment);
+                segment = { i, 0, batches[i].first, 0, 0 };
+            }
+            segment.batchCount++;
+            segment.instanceCount += batches[i].count;
+        }
+        if (segment.batchCount > 0)
+            instanceSegments.push_back(segment);
+
+        // one segment stays in the buffer for every pass, more than one are uploaded again by each draw()
+        if (instanceSegments.size() == 1)
+            uploadInstances(instanceSegments[0]);
     }
 
-    void Renderer::draw()
+    void Renderer::uploadInstances(InstanceSegment & segment)
     {
-        deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        deviceContext->VSSetConstantBuffers(3, 1, instanceOffsetBuffer);
-        deviceContext->VSSetShaderResources(20, 1, instanceSBuffer);
+        const std::vector<RenderCommandList::Command> & commands = commandList.getCommands();
 
+        instanceBytesUploaded += segment.instanceCount * sizeof(InstanceData);
 
-        UINT instanceOffset = 0;
-        for (InstanceQueue_t::value_type & pair : instanceQueue)
+        InstanceData* ptr = instanceBuffer.map(renderDevice, segment.instanceCount, segment.offset);
+        for (UINT i = 0; i < segment.instanceCount; i++)
         {
-            instanceOffsetBuffer.write(deviceContext, &instanceOffset, sizeof(UINT));
-            instanceOffset += pair.second.size();
+            ptr[i] = instances[commands[segment.firstCommand + i].index];
+        }
+        instanceBuffer.unmap(renderDevice);
+    }
 
-#if USE_TEMP_CUBE
-            static TempCube tempCube(device);
-			ModelInfo model = resourceManager.getModelInfo(CUBE);
+    void Renderer::draw(UINT pass, int lodBias)
+    {
+        renderDevice->IASetPrimitiveTopology(TOPOLOGY_TRIANGLELIST);
+        renderDevice->VSSetConstantBuffers(3, 1, batchBuffer);
 
+        // what is bound from the last batch, reset every pass since the passes change state in between
+        BoundState bound = { -1, -1 };
 
+        const std::vector<RenderCommandList::Batch> & batches = commandList.getBatches();
+        for (InstanceSegment & segment : instanceSegments)
+        {
+            // batches are sorted by pass, so a segment has the pass somewhere between its first and last batch
+            UINT lastBatch = segment.firstBatch + segment.batchCount - 1;
+            if (RenderCommandList::getPass(batches[segment.firstBatch].key) > pass ||
+                RenderCommandList::getPass(batches[lastBatch].key) < pass)
+                continue;
+
+            if (instanceSegments.size() > 1)
+                uploadInstances(segment);
+            // after the upload, the buffer might have grown
+            renderDevice->VSSetShaderResources(20, 1, instanceBuffer);
+
+            for (UINT i = segment.firstBatch; i <= lastBatch; i++)
+            {
+                if (RenderCommandList::getPass(batches[i].key) == pass)
+                    drawBatch(batches[i], segment.offset + batches[i].first - segment.firstCommand, lodBias, bound);
+            }
+        }
 
-			static UINT stride = sizeof(Vertex), offset = 0;
-			deviceContext->IASetVertexBuffers(0, 1, &tempCube.vertexBuffer, &stride, &offset);
+        const std::vector<RenderCommandList::Batch> & staticBatches = pass == RenderCommandList::PASS_OPAQUE ?
+            staticInstances.getBatches() : staticInstances.getCascadeBatches(pass - RenderCommandList::PASS_SHADOW_0);
+        if (!staticBatches.empty())
+        {
+            renderDevice->VSSetShaderResources(20, 1, staticInstances.getSRV());
+            for (RenderCommandList::Batch const & batch : staticBatches)
+            {
+                drawBatch(batch, batch.first, lodBias, bound);
+            }
+        }
+
+        // the rest of the frame expects back faces culled
+        if (bound.culling == 0)
+            renderDevice->RSSetState(states->CullCounterClockwise());
+    }
+
+    void Renderer::drawBatch(RenderCommandList::Batch const & batch, UINT instanceOffset, int lodBias, BoundState & bound)
+    {
+        // the static instances are registered before their models are loaded
+        if (!resourceManager.isModelReady((ModelID)RenderCommandList::getMesh(batch.key)))
+            return;
+
+        int culling = RenderCommandList::getCulling(batch.key) ? 1 : 0;
+        if (culling != bound.culling)
+        {
+            renderDevice->RSSetState(culling ? states->CullCounterClockwise() : states->CullNone());
+            bound.culling = culling;
+            stateChanges++;
+        }
+        else skippedBinds++;
+
+        int mesh = (int)RenderCommandList::getMesh(batch.key);
+#if USE_TEMP_CUBE
+        static TempCube tempCube(renderDevice);
+        ModelInfo model = resourceManager.getModelInfo(CUBE);
+
+        BatchData batchData = { instanceOffset, tempCube.boundsMin, tempCube.boundsMax - tempCube.boundsMin, 0.f };
+        batchBuffer.write(renderDevice, &batchData, sizeof(BatchData));
 
-			static ID3D11ShaderResourceView * modelTextures[3] = { nullptr };
-			modelTextures[0] = model.diffuseMap;
-			modelTextures[1] = model.normalMap;
-			modelTextures[2] = model.specularMap;
-			deviceContext->PSSetShaderResources(10, 3, modelTextures);
+        if (mesh != bound.mesh)
+        {
+            static UINT stride = sizeof(CompressedVertex), offset = 0;
+            renderDevice->IASetVertexBuffers(0, 1, &tempCube.vertexBuffer, &stride, &offset);
 
-			deviceContext->DrawInstanced(36, (UINT)pair.second.size(), 0, 0);
+            static ShaderResourceView * modelTextures[3] = { nullptr };
+            modelTextures[0] = model.diffuseMap;
+            modelTextures[1] = model.normalMap;
+            modelTextures[2] = model.specularMap;
+            renderDevice->PSSetShaderResources(10, 3, modelTextures);
+            bound.mesh = mesh;
+            stateChanges++;
+        }
+        else skippedBinds++;
+
+        renderDevice->DrawInstanced(36, batch.count, 0, 0);
 #else
-            ModelInfo model = resourceManager.getModelInfo(pair.first);
+        ModelInfo model = resourceManager.getModelInfo((ModelID)mesh);
+
+        BatchData batchData = { instanceOffset, model.boundsMin, model.boundsMax - model.boundsMin, 0.f };
+        batchBuffer.write(renderDevice, &batchData, sizeof(BatchData));
 
-            static UINT stride = sizeof(Vertex), offset = 0;
-            deviceContext->IASetVertexBuffers(0, 1, &model.vertexBuffer, &stride, &offset);
-            deviceContext->IASetIndexBuffer(model.indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+        if (mesh != bound.mesh)
+        {
+            static UINT stride = sizeof(CompressedVertex), offset = 0;
+            renderDevice->IASetVertexBuffers(0, 1, &model.vertexBuffer, &stride, &offset);
+            renderDevice->IASetIndexBuffer(model.indexBuffer, model.indexFormat, 0);
 
-            static ID3D11ShaderResourceView * modelTextures[4] = { nullptr };
+            static ShaderResourceView * modelTextures[4] = { nullptr };
             modelTextures[0] = model.diffuseMap;
             modelTextures[1] = model.normalMap;
             modelTextures[2] = model.specularMap;
-			modelTextures[3] = glowTest;
-            deviceContext->PSSetShaderResources(10, 4, modelTextures);
+            modelTextures[3] = glowTest;
+            renderDevice->PSSetShaderResources(10, 4, modelTextures);
+            bound.mesh = mesh;
+            stateChanges++;
+        }
+        else skippedBinds++;
 
-            deviceContext->DrawIndexedInstanced((UINT)model.indexCount, (UINT)pair.second.size(), 0, 0, 0);
+        // every LOD is in the same index buffer, only the range changes
+        int lod = (int)RenderCommandList::getLod(batch.key) + lodBias;
+        MeshLod const & range = model.lods[lod < model.lodCount ? lod : model.lodCount - 1];
+        renderDevice->DrawIndexedInstanced(range.indexCount, batch.count, range.startIndex, 0, 0);
 #endif
-        }
+        drawCalls++;
     }
 
-    void Renderer::drawToBackbuffer(ID3D11ShaderResourceView * texture)
+    void Renderer::drawToBackbuffer(ShaderResourceView * texture)
     {
         float clearColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-        deviceContext->ClearRenderTargetView(backBuffer, clearColor);
+        renderDevice->ClearRenderTargetView(backBuffer, clearColor);
 
-        deviceContext->PSSetShaderResources(0, 1, &texture);
+        renderDevice->PSSetShaderResources(0, 1, &texture);
 
-        UINT zero = 0;
-        deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        renderDevice->IASetPrimitiveTopology(TOPOLOGY_TRIANGLESTRIP);
 
-        deviceContext->OMSetRenderTargets(1, &backBuffer, nullptr);
+        renderDevice->OMSetRenderTargets(1, &backBuffer, nullptr);
 
-        deviceContext->IASetInputLayout(fullscreenQuad);
-        deviceContext->VSSetShader(fullscreenQuad, nullptr, 0);
-        deviceContext->PSSetShader(fullscreenQuad, nullptr, 0);
+        renderDevice->IASetInputLayout(fullscreenQuad);
+        renderDevice->VSSetShader(fullscreenQuad);
+        renderDevice->PSSetShader(fullscreenQuad);
 
-        static ID3D11SamplerState * pointClamp = states->PointClamp();
-        deviceContext->PSSetSamplers(0, 1, &pointClamp);
+        SamplerState * pointClamp = states->PointClamp();
+        renderDevice->PSSetSamplers(0, 1, &pointClamp);
 
-        deviceContext->Draw(4, 0);
+        renderDevice->Draw(4, 0);
 
-        ID3D11ShaderResourceView * srvNull = nullptr;
-        deviceContext->PSSetShaderResources(0, 1, &srvNull);
+        ShaderResourceView * srvNull = nullptr;
+        renderDevice->PSSetShaderResources(0, 1, &srvNull);
     }
 
     void Renderer::drawGUI()
@@ -406,11 +769,19 @@ namespace Graphics
     //draws the menu
     void Renderer::drawMenu(Graphics::MenuInfo * info)
     {
-        deviceContext->RSSetViewports(1, &viewPort);
-        menu.drawMenu(device, deviceContext, info, backBuffer);
+        textureResidency.beginFrame();
+        textureResidency.setActiveScopes(TextureResidency::SCOPE_MENU);
+
+        renderDevice->RSSetViewports(1, &viewPort);
+        menu.drawMenu(renderDevice, info, backBuffer);
 
     }
 
+    void Renderer::preloadTextures(uint32_t scopes)
+    {
+        textureResidency.preload(scopes);
+    }
+
     //creates a vetrex buffer for the GUI
     
 
@@ -422,14 +793,14 @@ namespace Graphics
         //PROFILE_BEGIN("Renderer::renderDebugInfo()");
         if (renderDebugQueue.size() == 0) return;
 
-        deviceContext->OMSetRenderTargets(1, &backBuffer, depthStencil);
+        renderDevice->OMSetRenderTargets(1, &backBuffer, depthStencil);
 
-        deviceContext->VSSetShaderResources(0, 1, debugPointsBuffer);
-        deviceContext->PSSetConstantBuffers(1, 1, debugColorBuffer);
+        renderDevice->VSSetShaderResources(0, 1, debugPointsBuffer);
+        renderDevice->PSSetConstantBuffers(1, 1, debugColorBuffer);
 
-        deviceContext->IASetInputLayout(nullptr);
-        deviceContext->VSSetShader(debugRender, nullptr, 0);
-        deviceContext->PSSetShader(debugRender, nullptr, 0);
+        renderDevice->IASetInputLayout(nullptr);
+        renderDevice->VSSetShader(debugRender);
+        renderDevice->PSSetShader(debugRender);
 
         for (RenderDebugInfo * info : renderDebugQueue)
         {
@@ -439,20 +810,20 @@ namespace Graphics
             }
 
             debugPointsBuffer.write( 
-                deviceContext, 
+                renderDevice, 
                 info->points->data(), 
                 info->points->size() * sizeof(DirectX::SimpleMath::Vector3)
             );
 
             debugColorBuffer.write(
-                deviceContext,
+                renderDevice,
                 &info->color,
                 sizeof(DirectX::SimpleMath::Color)
             );
 
-            deviceContext->IASetPrimitiveTopology(info->topology);
-            deviceContext->OMSetDepthStencilState(info->useDepth ? states->DepthDefault() : states->DepthNone(), 0);
-            deviceContext->Draw(info->points->size(), 0);
+            renderDevice->IASetPrimitiveTopology(info->topology);
+            renderDevice->OMSetDepthStencilState(info->useDepth ? states->DepthDefault() : states->DepthNone(), 0);
+            renderDevice->Draw(info->points->size(), 0);
         }
 
         renderDebugQueue.clear();
@@ -461,18 +832,17 @@ namespace Graphics
 
     void Renderer::createBlendState()
     {
-        D3D11_BLEND_DESC BlendState;
-        ZeroMemory(&BlendState, sizeof(D3D11_BLEND_DESC));
-        BlendState.RenderTarget[0].BlendEnable = TRUE;
-        BlendState.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
-        BlendState.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
-        BlendState.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-        BlendState.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_INV_DEST_ALPHA;
-        BlendState.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
-        BlendState.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-        BlendState.RenderTarget[0].RenderTargetWriteMask = 0x0f;
-
-        ThrowIfFailed(this->device->CreateBlendState(&BlendState, &transparencyBlendState));
+        BlendDesc blendState = {};
+        blendState.enable = true;
+        blendState.src = BLEND_SRC_ALPHA;
+        blendState.dest = BLEND_INV_SRC_ALPHA;
+        blendState.op = BLEND_OP_ADD;
+        blendState.srcAlpha = BLEND_INV_DEST_ALPHA;
+        blendState.destAlpha = BLEND_ONE;
+        blendState.opAlpha = BLEND_OP_ADD;
+        blendState.writeMask = 0x0f;
+
+        transparencyBlendState = renderDevice->CreateBlendState(blendState);
     }
 
 
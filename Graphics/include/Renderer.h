@@ -1,26 +1,27 @@
 #pragma once
-#include <d3d11.h>
 #include <SimpleMath.h>
-#include <Windows.h>
 #include <vector>
 #include <unordered_map>
 #include "Camera.h"
 #include "Structs.h"
 #include "Datatypes.h"
-#include "WICTextureLoader.h"
-#include "Lights\LightGrid.h"
-#include "Resources\ResourceManager.h"
-#include "Utility\DepthStencil.h"
-#include "Resources\ResourceManager.h"
-#include "Utility\ConstantBuffer.h"
-#include "Utility\StructuredBuffer.h"
-#include "Utility\ShaderResource.h"
-#include "PostProccessor.h";
+#include "Lights/LightGrid.h"
+#include "Lights/ClusteredLightGrid.h"
+#include "Resources/ResourceManager.h"
+#include "Utility/DepthStencil.h"
+#include "Utility/ConstantBuffer.h"
+#include "Utility/StructuredBuffer.h"
+#include "Utility/RenderCommandList.h"
+#include "Utility/RingBuffer.h"
+#include "Utility/StaticInstanceRegistry.h"
+#include "Utility/OcclusionCuller.h"
+#include "Utility/ShaderResource.h"
+#include "PostProccessor.h"
 #include "SkyRenderer.h"
 #include "Menu.h"
 #include "HUD.h"
-
-#include <SpriteBatch.h>
+#include "Device/RenderDevice.h"
+#include "Device/CommonStates.h"
 
 
 namespace Graphics
@@ -28,23 +29,96 @@ namespace Graphics
     class Renderer
     {
     public:
-        Renderer(ID3D11Device * device, ID3D11DeviceContext * deviceContext, ID3D11RenderTargetView * backBuffer, Camera *camera);
+        // everything is created and drawn through device, backBuffer is what the frame ends up in
+        Renderer(RenderDevice * device, GpuTexture * backBuffer, Camera *camera);
 		virtual ~Renderer();
-        void initialize(ID3D11Device * gDevice, ID3D11DeviceContext * gDeviceContext);
+        void initialize();
 
 
         void render(Camera * camera);
         void queueRender(RenderInfo * renderInfo);
+        // point lights for this frame, only used with clustered lighting
+        void queueLight(Light const & light);
+
+        // Static instances are kept by the renderer instead of queued every frame, returns the handle
+        int registerStatic(RenderInfo * renderInfo);
+        void updateStatic(int handle, RenderInfo * renderInfo);
+        void unregisterStatic(int handle);
+        void clearStatics();
         void queueRenderDebug(RenderDebugInfo * debugInfo);
         void queueText(TextString * text);
         void fillHUDInfo(HUDInfo * info);
 
         void drawMenu(Graphics::MenuInfo * info);
+        // loads the menu, HUD or game textures (TextureResidency::Scope) ahead of a state change
+        void preloadTextures(uint32_t scopes);
 		void updateLight(float deltaTime, Camera * camera);
+
+        RenderDevice * getRenderDevice();
+
+        // what the last render did, the same as its profiler counters
+        struct FrameStats
+        {
+            UINT drawCalls;
+            UINT stateChanges;
+            UINT instanceBytesUploaded;         // queued and static instances
+            UINT staticInstanceBytesUploaded;
+            UINT shadowCasters;
+            UINT staticShadowCasters[SHADOW_CASCADES];  // statics drawn into each cascade, 0 if it wasn't updated
+            UINT occlusionCulled;
+            UINT instanceHighWaterMark;         // most instances in the ring buffer in one frame
+        };
+        FrameStats getFrameStats() const;
+
+        // light tile size in pixels, of the clusters or the 2D tiles, the grid is rebuilt next frame
+        void setLightTileSize(UINT tileSize);
+
+        // Assets load in the background after initialize, this is called by render with
+        // how many are done. Models still loading are not drawn
+        void setLoadingProgressCallback(AssetLoader::ProgressCallback callback);
+        // blocks until every asset is loaded
+        void finishLoading();
     private:
-        typedef  std::unordered_map<ModelID, std::vector<InstanceData>> InstanceQueue_t;
-        InstanceQueue_t instanceQueue;
         std::vector<RenderInfo*> renderQueue;
+        std::vector<InstanceData> instances;    // in queue order, commandList has the draw order
+        RenderCommandList commandList;
+
+        // the map boxes in a small depth buffer, what they hide skips the camera passes
+        OcclusionCuller occlusionCuller;
+        std::vector<RenderInfo const *> occluders;
+
+        // A range of batches whose instances fit in instanceBuffer at once
+        struct InstanceSegment
+        {
+            UINT firstBatch, batchCount;
+            UINT firstCommand, instanceCount;
+            UINT offset;    // in instanceBuffer, set by uploadInstances
+        };
+        std::vector<InstanceSegment> instanceSegments;
+
+        // this frame, all passes
+        UINT drawCalls;
+        UINT stateChanges;
+        UINT skippedBinds;
+        UINT instanceBytesUploaded;
+        UINT shadowCasters;
+        UINT occlusionTested;
+        UINT occlusionCulled;
+
+        struct BoundState
+        {
+            int mesh;
+            int culling;
+        };
+
+        // b3 in ForwardPlus.hlsl, written for every batch
+        struct BatchData
+        {
+            UINT instanceOffset;
+            DirectX::SimpleMath::Vector3 boundsMin;     // of the mesh, what the compressed positions are relative to
+            DirectX::SimpleMath::Vector3 boundsExtent;
+            float padding;
+        };
 
         DepthStencil depthStencil;
 
@@ -52,22 +126,26 @@ namespace Graphics
 		PostProcessor postProcessor;
 
 		LightGrid grid;
-		DirectX::CommonStates *states;
+		ClusteredLightGrid clusteredLights;
+		std::vector<Light> lightQueue;
+		UINT lightTileSize;
+		CommonStates *states;
 
         Shader fullscreenQuad;
         Shader forwardPlus;
 
         //ComputeShader lightGridGen; 
 
-        StructuredBuffer<InstanceData> instanceSBuffer;
-        ConstantBuffer<UINT> instanceOffsetBuffer;
+        RingBuffer<InstanceData> instanceBuffer;
+        StaticInstanceRegistry staticInstances;
+        ConstantBuffer<BatchData> batchBuffer;
         ResourceManager resourceManager;
-        D3D11_VIEWPORT viewPort;
+        Viewport viewPort;
 
         // Lnade Pekare
-        ID3D11Device * device;
-        ID3D11DeviceContext * deviceContext;
-        ID3D11RenderTargetView * backBuffer;
+        RenderDevice * renderDevice;
+        GpuTexture * backBufferTexture;
+        RenderTargetView * backBuffer;     // made from backBufferTexture, released by the renderer
 
 
 
@@ -83,8 +161,11 @@ namespace Graphics
 		
 
 
-        ID3D11BlendState *transparencyBlendState;
+        BlendState *transparencyBlendState;
 
+        // menu and HUD textures, kept between states within UI_TEXTURE_BUDGET
+        TextureFileLoader textureLoader;
+        TextureResidency textureResidency;
 
         Menu menu;
         HUD hud;
@@ -93,12 +174,15 @@ namespace Graphics
 
 
 
-		ID3D11ShaderResourceView * glowTest;
+		ShaderResourceView * glowTest;
 
        
-        void cull();
+        void cull(Camera * camera);
         void writeInstanceData();
-        void draw();
+        void uploadInstances(InstanceSegment & segment);
+        // only the batches of pass, static instances go in every pass
+        void draw(UINT pass, int lodBias = 0);
+        void drawBatch(RenderCommandList::Batch const & batch, UINT instanceOffset, int lodBias, BoundState & bound);
         void drawGUI();
 		
 
@@ -107,9 +191,10 @@ namespace Graphics
         
 		
 
-        void drawToBackbuffer(ID3D11ShaderResourceView * texture);
+        void drawToBackbuffer(ShaderResourceView * texture);
 
         void createBlendState();
+        void getBackBufferSize(UINT & width, UINT & height);
 
 
 
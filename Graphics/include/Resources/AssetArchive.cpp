@@ -0,0 +1,265 @@
+#include "AssetArchive.h"
+#include "LZ4.h"
+#include <string.h>
+#include <algorithm>
+
+#define ASSET_ARCHIVE_VERSION 1
+
+namespace Graphics
+{
+    namespace
+    {
+        const char MAGIC[4] = { 'S', 'S', 'P', 'K' };
+
+        bool entryLess(AssetArchive::Entry const & a, std::string const & aName, AssetArchive::Entry const & b, std::string const & bName)
+        {
+            return a.hash != b.hash ? a.hash < b.hash : aName < bName;
+        }
+
+        void append(std::vector<char> & archive, const void * bytes, size_t count)
+        {
+            archive.insert(archive.end(), (const char *)bytes, (const char *)bytes + count);
+        }
+
+        void alignTo(std::vector<char> & archive, uint32_t alignment)
+        {
+            archive.resize((archive.size() + alignment - 1) & ~(size_t)(alignment - 1), 0);
+        }
+    }
+
+    AssetArchive::AssetArchive()
+    {
+        close();
+    }
+
+    bool AssetArchive::open(const char * data, size_t size)
+    {
+        close();
+
+        Header header;
+        if (size < sizeof(header))
+            return false;
+        memcpy(&header, data, sizeof(header));
+
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != ASSET_ARCHIVE_VERSION)
+            return false;
+
+        // everything the lookups touch is checked here, once
+        if (header.entriesOffset > size || header.entryCount > (size - header.entriesOffset) / sizeof(Entry) ||
+            header.entriesOffset % alignof(Entry) != 0 || (uintptr_t)data % alignof(Entry) != 0 ||
+            header.namesOffset > size || header.namesSize > size - header.namesOffset)
+        {
+            return false;
+        }
+
+        const Entry * entries = (const Entry *)(data + header.entriesOffset);
+        for (uint32_t i = 0; i < header.entryCount; i++)
+        {
+            Entry const & entry = entries[i];
+            if ((uint64_t)entry.nameOffset + entry.nameSize > header.namesSize ||
+                entry.offset > size || entry.storedSize > size - entry.offset ||
+                (!(entry.flags & ENTRY_LZ4) && entry.storedSize != entry.size) ||
+                ((entry.flags & ENTRY_LZ4) && entry.size / 256 > entry.storedSize))     // more than LZ4 can expand to
+            {
+                return false;
+            }
+        }
+
+        this->data = data;
+        this->size = size;
+        this->entries = entries;
+        this->names = data + header.namesOffset;
+        this->entryCount = header.entryCount;
+        return true;
+    }
+
+    void AssetArchive::close()
+    {
+        data = nullptr;
+        size = 0;
+        entries = nullptr;
+        names = nullptr;
+        entryCount = 0;
+    }
+
+    bool AssetArchive::isOpen() const
+    {
+        return data != nullptr;
+    }
+
+    const AssetArchive::Entry * AssetArchive::find(std::string const & name) const
+    {
+        std::string normalized = normalizeName(name);
+        uint64_t hash = hashName(normalized);
+
+        const Entry * end = entries + entryCount;
+        const Entry * entry = std::lower_bound(entries, end, hash,
+            [](Entry const & entry, uint64_t hash) { return entry.hash < hash; });
+
+        for (; entry != end && entry->hash == hash; entry++)
+        {
+            if (entry->nameSize == normalized.size() && memcmp(names + entry->nameOffset, normalized.data(), normalized.size()) == 0)
+                return entry;
+        }
+
+        return nullptr;
+    }
+
+    bool AssetArchive::read(Entry const & entry, std::vector<char> & bytes) const
+    {
+        const char * stored = data + entry.offset;
+
+        if (!(entry.flags & ENTRY_LZ4))
+        {
+            bytes.assign(stored, stored + entry.size);
+            return true;
+        }
+
+        bytes.resize((size_t)entry.size);
+        return LZ4::decompress(stored, (size_t)entry.storedSize, bytes.data(), bytes.size());
+    }
+
+    const char * AssetArchive::getData(Entry const & entry) const
+    {
+        return entry.flags & ENTRY_LZ4 ? nullptr : data + entry.offset;
+    }
+
+    uint32_t AssetArchive::getEntryCount() const
+    {
+        return entryCount;
+    }
+
+    AssetArchive::Entry const & AssetArchive::getEntry(uint32_t index) const
+    {
+        return entries[index];
+    }
+
+    std::string AssetArchive::getName(Entry const & entry) const
+    {
+        return std::string(names + entry.nameOffset, entry.nameSize);
+    }
+
+    std::string AssetArchive::normalizeName(std::string const & name)
+    {
+        std::string normalized;
+        normalized.reserve(name.size());
+
+        for (char c : name)
+        {
+            if (c == '\\')
+                c = '/';
+            else if (c >= 'A' && c <= 'Z')
+                c = c - 'A' + 'a';
+            normalized += c;
+        }
+
+        while (normalized.compare(0, 2, "./") == 0)
+            normalized.erase(0, 2);
+
+        return normalized;
+    }
+
+    uint64_t AssetArchive::hashName(std::string const & normalizedName)
+    {
+        // FNV-1a, 64 bit
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : normalizedName)
+        {
+            hash ^= (unsigned char)c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool AssetArchive::build(std::vector<Input> const & inputs, uint32_t alignment, std::vector<char> & archive, std::string & errors)
+    {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        {
+            errors = "the alignment has to be a power of two";
+            return false;
+        }
+
+        std::vector<std::string> normalized(inputs.size());
+        std::vector<Entry> entries(inputs.size());
+        std::vector<size_t> order(inputs.size());
+
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            normalized[i] = normalizeName(inputs[i].name);
+            entries[i] = {};
+            entries[i].hash = hashName(normalized[i]);
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            return entryLess(entries[a], normalized[a], entries[b], normalized[b]);
+        });
+
+        for (size_t i = 1; i < order.size(); i++)
+        {
+            if (normalized[order[i]] == normalized[order[i - 1]])
+            {
+                errors = inputs[order[i]].name + " is in the archive twice";
+                return false;
+            }
+        }
+
+        // names, then the data after the header, entries and names
+        std::string names;
+        for (size_t i : order)
+        {
+            entries[i].nameOffset = (uint32_t)names.size();
+            entries[i].nameSize = (uint32_t)normalized[i].size();
+            names += normalized[i];
+        }
+
+        Header header = {};
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = ASSET_ARCHIVE_VERSION;
+        header.entryCount = (uint32_t)inputs.size();
+        header.alignment = alignment;
+        header.entriesOffset = sizeof(Header);
+        header.namesOffset = header.entriesOffset + inputs.size() * sizeof(Entry);
+        header.namesSize = names.size();
+
+        archive.clear();
+        archive.resize((size_t)(header.namesOffset + header.namesSize));
+        memcpy(archive.data() + header.namesOffset, names.data(), names.size());
+
+        std::vector<char> compressed;
+        for (size_t i : order)
+        {
+            Input const & input = inputs[i];
+            Entry & entry = entries[i];
+            const char * bytes = input.bytes.data();
+            size_t stored = input.bytes.size();
+
+            entry.size = input.bytes.size();
+
+            // compressed only if it's at least an eighth smaller, not worth decompressing otherwise
+            if (input.compress && !input.bytes.empty())
+            {
+                compressed.resize(LZ4::getMaxCompressedSize(input.bytes.size()));
+                size_t compressedSize = LZ4::compress(input.bytes.data(), input.bytes.size(), compressed.data(), compressed.size());
+                if (compressedSize > 0 && compressedSize <= input.bytes.size() - input.bytes.size() / 8)
+                {
+                    bytes = compressed.data();
+                    stored = compressedSize;
+                    entry.flags |= ENTRY_LZ4;
+                }
+            }
+
+            alignTo(archive, alignment);
+            entry.offset = archive.size();
+            entry.storedSize = stored;
+            append(archive, bytes, stored);
+        }
+
+        memcpy(archive.data(), &header, sizeof(header));
+        for (size_t i = 0; i < order.size(); i++)
+            memcpy(archive.data() + header.entriesOffset + i * sizeof(Entry), &entries[order[i]], sizeof(Entry));
+
+        return true;
+    }
+}
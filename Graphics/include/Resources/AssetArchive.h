@@ -0,0 +1,95 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace Graphics
+{
+    /*
+        Every resource file in one archive, so startup opens one file instead
+        of dozens. Layout:
+
+            header      magic, version, counts, where the rest starts
+            entries     sorted on (hash, name), found with a binary search
+            names       every name back to back, no terminators
+            data        each entry aligned, optionally LZ4 compressed
+
+        Names are the paths the game asks for, from the Engine folder, with
+        forward slashes and in lower case (see normalizeName), so
+        "Resources\Textures\Wood.jpg" and "Resources/Textures/wood.jpg" are
+        the same entry.
+
+        AssetArchive only reads an archive somebody else keeps in memory
+        (VirtualFileSystem maps it), and builds new ones. Pure CPU.
+    */
+    class AssetArchive
+    {
+    public:
+        enum EntryFlags
+        {
+            ENTRY_LZ4 = 1 << 0
+        };
+
+        struct Entry
+        {
+            uint64_t hash;          // of the normalized name
+            uint32_t nameOffset;    // into the names
+            uint32_t nameSize;
+            uint64_t offset;        // from the start of the archive
+            uint64_t storedSize;    // in the archive
+            uint64_t size;          // decompressed
+            uint32_t flags;
+            uint32_t reserved;
+        };
+
+        struct Input
+        {
+            std::string name;
+            std::vector<char> bytes;
+            bool compress;          // only kept if it saves something
+        };
+
+        AssetArchive();
+
+        // the archive is read in place and has to outlive this, false if it isn't one
+        bool open(const char * data, size_t size);
+        void close();
+        bool isOpen() const;
+
+        // null if it isn't in the archive
+        const Entry * find(std::string const & name) const;
+        // decompressed if it has to be, false if the entry is broken
+        bool read(Entry const & entry, std::vector<char> & bytes) const;
+        // straight into the archive for entries that aren't compressed, null for the rest
+        const char * getData(Entry const & entry) const;
+
+        uint32_t getEntryCount() const;
+        Entry const & getEntry(uint32_t index) const;
+        std::string getName(Entry const & entry) const;
+
+        // forward slashes, lower case, no leading ./
+        static std::string normalizeName(std::string const & name);
+        static uint64_t hashName(std::string const & normalizedName);
+
+        // alignment is a power of two, false if two inputs have the same name
+        static bool build(std::vector<Input> const & inputs, uint32_t alignment, std::vector<char> & archive, std::string & errors);
+    private:
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t entryCount;
+            uint32_t alignment;
+            uint64_t entriesOffset;
+            uint64_t namesOffset;
+            uint64_t namesSize;
+        };
+
+        const char * data;
+        size_t size;
+        const Entry * entries;
+        const char * names;
+        uint32_t entryCount;
+    };
+}
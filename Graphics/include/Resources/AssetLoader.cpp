@@ -0,0 +1,242 @@
+#include "AssetLoader.h"
+#include "VirtualFileSystem.h"
+
+namespace Graphics
+{
+    namespace
+    {
+        bool readWholeFile(std::string const & path, std::vector<char> & bytes)
+        {
+            return VirtualFileSystem::singleton().read(path, bytes);
+        }
+    }
+
+    AssetLoader::AssetLoader(uint32_t workerCount)
+    {
+        stopping = false;
+        finished = 0;
+        reader = readWholeFile;
+
+        if (workerCount == 0)
+        {
+            unsigned int hardware = std::thread::hardware_concurrency();
+            workerCount = hardware > 1 ? hardware - 1 : 1;
+        }
+
+        for (uint32_t i = 0; i < workerCount; i++)
+            workers.push_back(std::thread(&AssetLoader::work, this));
+    }
+
+    AssetLoader::~AssetLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workSignal.notify_all();
+
+        for (std::thread & worker : workers)
+            worker.join();
+    }
+
+    void AssetLoader::setType(int type, Decoder decoder, Uploader uploader, bool ordered, bool readFile)
+    {
+        if (type < 0)
+            return;
+
+        if ((size_t)type >= types.size())
+            types.resize(type + 1, { nullptr, nullptr, false, true });
+
+        types[type] = { decoder, uploader, ordered, readFile };
+    }
+
+    void AssetLoader::setReader(Reader reader)
+    {
+        this->reader = reader;
+    }
+
+    void AssetLoader::setProgressCallback(ProgressCallback callback)
+    {
+        progressCallback = callback;
+    }
+
+    AssetLoader::Handle AssetLoader::load(int type, std::string const & path, Priority priority, int id)
+    {
+        if (type < 0 || (size_t)type >= types.size())
+            return INVALID_HANDLE;
+
+        std::unique_ptr<Entry> entry(new Entry);
+        entry->asset.type = type;
+        entry->asset.path = path;
+        entry->asset.id = id;
+        entry->priority = priority;
+        entry->state = STATE_QUEUED;
+
+        Handle handle;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.push_back(std::move(entry));
+            handle = (Handle)entries.size();
+            queued.push_back(handle);
+            waiting.push_back(handle);
+        }
+        workSignal.notify_one();
+
+        return handle;
+    }
+
+    uint32_t AssetLoader::update(uint32_t maxUploads)
+    {
+        uint32_t uploads = 0;
+
+        while (uploads < maxUploads)
+        {
+            Entry * entry;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                size_t index = findUpload();
+                if (index == NOT_FOUND)
+                    break;
+
+                entry = entries[waiting[index] - 1].get();
+                waiting.erase(waiting.begin() + index);
+            }
+
+            // outside the lock, uploaders can load more (a model asking for its textures)
+            State state = STATE_FAILED;
+            if (entry->state == STATE_DECODED)
+            {
+                Uploader const & uploader = types[entry->asset.type].uploader;
+                state = !uploader || uploader(entry->asset) ? STATE_READY : STATE_FAILED;
+                uploads++;
+            }
+
+            uint32_t finishedCount, total;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                entry->state = state;
+                entry->asset.decoded.reset();
+                finishedCount = ++finished;
+                total = (uint32_t)entries.size();
+            }
+
+            if (progressCallback)
+                progressCallback(finishedCount, total);
+        }
+
+        return uploads;
+    }
+
+    void AssetLoader::finish()
+    {
+        for (;;)
+        {
+            update(UINT32_MAX);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if (waiting.empty())
+                return;
+
+            // until a worker has something that can be uploaded
+            decodedSignal.wait(lock, [this]() { return findUpload() != NOT_FOUND; });
+        }
+    }
+
+    AssetLoader::State AssetLoader::getState(Handle handle) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (handle == INVALID_HANDLE || handle > entries.size())
+            return STATE_FAILED;
+
+        return entries[handle - 1]->state;
+    }
+
+    bool AssetLoader::isReady(Handle handle) const
+    {
+        return getState(handle) == STATE_READY;
+    }
+
+    uint32_t AssetLoader::getFinishedCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return finished;
+    }
+
+    uint32_t AssetLoader::getRequestedCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (uint32_t)entries.size();
+    }
+
+    void AssetLoader::work()
+    {
+        for (;;)
+        {
+            Entry * entry;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workSignal.wait(lock, [this]() { return stopping || !queued.empty(); });
+                if (stopping)
+                    return;
+
+                entry = entries[takeQueued() - 1].get();
+                entry->state = STATE_LOADING;
+            }
+
+            // only this worker touches the asset until it is decoded
+            Asset & asset = entry->asset;
+            TypeInfo const & type = types[asset.type];
+
+            bool loaded = !type.readFile || reader(asset.path, asset.bytes);
+            if (loaded && type.decoder)
+                loaded = type.decoder(asset);
+            std::vector<char>().swap(asset.bytes);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                entry->state = loaded ? STATE_DECODED : STATE_FAILED;
+            }
+            decodedSignal.notify_all();
+        }
+    }
+
+    AssetLoader::Handle AssetLoader::takeQueued()
+    {
+        // highest priority, the oldest of those
+        size_t best = 0;
+        for (size_t i = 1; i < queued.size(); i++)
+        {
+            if (entries[queued[i] - 1]->priority > entries[queued[best] - 1]->priority)
+                best = i;
+        }
+
+        Handle handle = queued[best];
+        queued.erase(queued.begin() + best);
+        return handle;
+    }
+
+    size_t AssetLoader::findUpload() const
+    {
+        std::vector<bool> blocked(types.size(), false);
+        size_t best = NOT_FOUND;
+
+        for (size_t i = 0; i < waiting.size(); i++)
+        {
+            Entry const & entry = *entries[waiting[i] - 1];
+            int type = entry.asset.type;
+            bool done = entry.state == STATE_DECODED || entry.state == STATE_FAILED;
+
+            // an ordered type waits for the oldest of its kind
+            if (done && !blocked[type] &&
+                (best == NOT_FOUND || entry.priority > entries[waiting[best] - 1]->priority))
+            {
+                best = i;
+            }
+
+            if (types[type].ordered)
+                blocked[type] = true;
+        }
+
+        return best;
+    }
+}
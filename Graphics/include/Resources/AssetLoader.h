@@ -0,0 +1,142 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Graphics
+{
+    // what the engine loads, the type given to AssetLoader
+    enum AssetType
+    {
+        ASSET_MODEL = 0,
+        ASSET_TEXTURE,
+        NR_OF_ASSET_TYPES
+    };
+
+    /*
+        Loads assets on worker threads. Every load goes through three stages:
+            read    worker, the whole file into memory (can be turned off per type)
+            decode  worker, the bytes into something ready for the GPU
+            upload  the thread calling update, creates the GPU resources
+
+        Nothing in here knows about D3D, decoders and uploaders are given per
+        type. A fake uploader (and reader) is all it takes to run it headless.
+
+        Workers take the highest priority first, then the oldest. Uploads go
+        the same way, except for ordered types that are uploaded in the order
+        they were requested, whatever finished decoding first.
+
+        Types are set up before the first load, they are read by the workers
+        without locking.
+
+        HOW TO USE:
+            loader.setType(ASSET_TEXTURE, decoder, uploader);
+            Handle handle = loader.load(ASSET_TEXTURE, path, AssetLoader::PRIORITY_NORMAL, id);
+            loader.update(maxUploads);  // once a frame on the owning thread
+            loader.getState(handle) == AssetLoader::STATE_READY
+    */
+    class AssetLoader
+    {
+    public:
+        typedef uint32_t Handle;
+        static const Handle INVALID_HANDLE = 0;
+
+        enum Priority
+        {
+            PRIORITY_LOW = 0,
+            PRIORITY_NORMAL,
+            PRIORITY_HIGH
+        };
+
+        enum State
+        {
+            STATE_QUEUED = 0,
+            STATE_LOADING,      // on a worker
+            STATE_DECODED,      // waiting for update
+            STATE_READY,
+            STATE_FAILED
+        };
+
+        struct Asset
+        {
+            int type;
+            std::string path;
+            int id;                         // from load, whatever the requester needs back
+            std::vector<char> bytes;        // the file, if the type reads it
+            std::shared_ptr<void> decoded;  // left by the decoder for the uploader
+        };
+
+        // all of them return false to fail the asset
+        typedef std::function<bool(std::string const & path, std::vector<char> & bytes)> Reader;
+        typedef std::function<bool(Asset & asset)> Decoder;     // worker thread
+        typedef std::function<bool(Asset & asset)> Uploader;    // update thread
+        typedef std::function<void(uint32_t finished, uint32_t total)> ProgressCallback;
+
+        // workerCount 0 is one less than the hardware threads, at least one
+        AssetLoader(uint32_t workerCount = 0);
+        // waits for the workers to finish what they are on, the rest is dropped
+        ~AssetLoader();
+
+        // readFile false leaves bytes empty, for decoders that open the file themselves
+        void setType(int type, Decoder decoder, Uploader uploader, bool ordered = false, bool readFile = true);
+        // the default reads through the VirtualFileSystem
+        void setReader(Reader reader);
+        // called from update when an asset is ready or failed, for loading screens
+        void setProgressCallback(ProgressCallback callback);
+
+        Handle load(int type, std::string const & path, Priority priority = PRIORITY_NORMAL, int id = 0);
+
+        // uploads at most maxUploads decoded assets, returns how many
+        uint32_t update(uint32_t maxUploads);
+        // update until everything requested is ready or failed
+        void finish();
+
+        State getState(Handle handle) const;
+        bool isReady(Handle handle) const;
+        uint32_t getFinishedCount() const;
+        uint32_t getRequestedCount() const;
+    private:
+        struct TypeInfo
+        {
+            Decoder decoder;
+            Uploader uploader;
+            bool ordered;
+            bool readFile;
+        };
+
+        struct Entry
+        {
+            Asset asset;
+            Priority priority;
+            State state;
+        };
+
+        std::vector<TypeInfo> types;
+        Reader reader;
+        ProgressCallback progressCallback;
+
+        mutable std::mutex mutex;
+        std::condition_variable workSignal;
+        std::condition_variable decodedSignal;
+        std::vector<std::thread> workers;
+        bool stopping;
+
+        std::vector<std::unique_ptr<Entry>> entries;    // handle - 1
+        std::vector<Handle> queued;                     // not picked by a worker yet
+        std::vector<Handle> waiting;                    // not uploaded yet, in request order
+        uint32_t finished;
+
+        static const size_t NOT_FOUND = (size_t)-1;
+
+        void work();
+        // with the lock held, queued is not empty
+        Handle takeQueued();
+        // with the lock held, the index in waiting of the next upload
+        size_t findUpload() const;
+    };
+}
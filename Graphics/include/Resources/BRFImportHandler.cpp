@@ -1,6 +1,55 @@
 #include "BRFImportHandler.h"
+#include "VirtualFileSystem.h"
+#include "IndexOptimizer.h"
+#include <string.h>
+
+// two uints before the main header, the importer skips them too
+#define BRF_PREAMBLE_SIZE 8
+
 namespace Graphics
 {
+	namespace
+	{
+		// the headers are read as they are in memory, like the importer does
+		class FileReader
+		{
+		public:
+			FileReader(vector<char> const & bytes) : bytes(bytes), offset(0) {}
+
+			bool read(void * data, size_t size)
+			{
+				if (size > bytes.size() - offset)
+					return false;
+
+				memcpy(data, bytes.data() + offset, size);
+				offset += size;
+				return true;
+			}
+
+			template <typename T>
+			bool read(T & data) { return read(&data, sizeof(T)); }
+
+			bool skip(size_t size)
+			{
+				if (size > bytes.size() - offset)
+					return false;
+
+				offset += size;
+				return true;
+			}
+		private:
+			vector<char> const & bytes;
+			size_t offset;
+		};
+
+		// the names can be garbage after their terminator, or have none at all
+		template <size_t size>
+		string getString(const char (&text)[size])
+		{
+			return string(text, strnlen(text, size));
+		}
+	}
+
 	BRFImportHandler::BRFImportHandler()
 	{
 		materialID = 0;
@@ -8,112 +57,189 @@ namespace Graphics
 
 	BRFImportHandler::~BRFImportHandler()
 	{
-		delete this->currentFile;
 	}
 
 	void BRFImportHandler::loadFile(int id, string fileName, bool mesh, bool material, bool skeleton, bool isScene)
 	{
-		this->currentFile->LoadFile(fileName, mesh, skeleton, material);
+		Model model;
+		if (decodeFile(fileName, mesh, material, skeleton, model))
+			addModel(id, model, isScene);
+	}
+
+	bool BRFImportHandler::decodeFile(string fileName, bool mesh, bool material, bool skeleton, Model & model, bool optimize)
+	{
+		// read with the importer's own headers, so it works with the archive
+		// and on every platform. The meshes come first, then the materials
+		vector<char> bytes;
+		if (!VirtualFileSystem::singleton().read(fileName, bytes))
+			return false;
+
+		FileReader file(bytes);
+		BRFImporterLib::MainHeader main;
+		if (!file.skip(BRF_PREAMBLE_SIZE) || !file.read(main))
+			return false;
 
-		unsigned int meshSize = currentFile->fetch->Main()->meshAmount;
+		unsigned int meshSize = main.meshAmount;
+		model.meshes.resize(mesh ? meshSize : 0);
 
 		for (unsigned int i = 0; i < meshSize; i++)
 		{
-#pragma region handle material
-			int tempMaterialID = 0;
+			BRFImporterLib::MeshHeader meshHeader;
+			if (!file.read(meshHeader))
+				return false;
 
-			if (material == true)
-			{
-				tempMaterialID = currentFile->fetch->Material(i)->Id;
-			}
-			else
+			// none of the models have these, the importer would read more after each vertex
+			if (meshHeader.hasSkeleton || meshHeader.boundingBox)
+				return false;
+
+			if (!mesh)
 			{
-				tempMaterialID = -1;
+				if (!file.skip(meshHeader.vertexCount * sizeof(BRFImporterLib::VertexHeader) + meshHeader.indexCount * sizeof(BRFImporterLib::IndexHeader)))
+					return false;
+				continue;
 			}
-#pragma endregion
+
 #pragma region Statements handling vertices.
 
-			unsigned int tempVertexCount = currentFile->fetch->Mesh(i)->GetMeshData()->vertexCount;
-			vector <Vertex> tempVertices;
+			unsigned int tempVertexCount = meshHeader.vertexCount;
+			vector <Vertex> & tempVertices = model.meshes[i].vertices;
+			tempVertices.reserve(tempVertexCount);
 
 			for (unsigned int j = 0; j < tempVertexCount; j++)
 			{
+				BRFImporterLib::VertexHeader vertex;
+				if (!file.read(vertex))
+					return false;
+
 				Vertex tempVert;
 				tempVert.position = {
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).pos[0],
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).pos[1],
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).pos[2],
+					(float)vertex.pos[0],
+					(float)vertex.pos[1],
+					(float)vertex.pos[2],
 				};
 				tempVert.normal = {
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).normal[0],
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).normal[1],
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).normal[2],
+					(float)vertex.normal[0],
+					(float)vertex.normal[1],
+					(float)vertex.normal[2],
 				};
 				tempVert.uv = {
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).uv[0],
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).uv[1]
+					(float)vertex.uv[0],
+					(float)vertex.uv[1]
 				};
 				tempVert.tangent = {
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).tangent[0],
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).tangent[1]
+					(float)vertex.tangent[0],
+					(float)vertex.tangent[1]
 				};
 				tempVert.biTangent = {
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).biTangent[0],
-					(float)currentFile->fetch->Mesh(i)->GetVertexData(j).biTangent[1]
+					(float)vertex.biTangent[0],
+					(float)vertex.biTangent[1]
 				};
 				tempVertices.push_back(tempVert);
 			}
-			tempVertices.shrink_to_fit();
 #pragma endregion
 
 #pragma region statements handling indices
 
-			UINT tempIndexCount = currentFile->fetch->Mesh(i)->GetMeshData()->indexCount;
-			vector <UINT> tempIndices;
-			for (unsigned int j = 0; j < tempIndexCount; j++)
-			{
-				UINT tempIndex;
-				tempIndex = currentFile->fetch->Mesh(i)->GetIndexData(j).vertIndex;
-				tempIndices.push_back(tempIndex);
-			}
-			tempIndices.shrink_to_fit();
-
-
-			meshManager->addMesh(id, false, 0, 0, tempVertexCount, tempIndexCount, tempVertices, tempIndices, isScene);
-
+			UINT tempIndexCount = meshHeader.indexCount;
+			vector <UINT> & tempIndices = model.meshes[i].indices;
+			tempIndices.resize(tempIndexCount);
+			if (!file.read(tempIndices.data(), sizeof(UINT) * tempIndexCount))
+				return false;
+#pragma endregion
 
+			model.meshes[i].lods[0] = { 0, tempIndexCount, 0.f };
+			model.meshes[i].lodCount = 1;
+			if (optimize)
+				optimizeMesh(model.meshes[i]);
 		}
 
-#pragma endregion
-
 #pragma region ImportMaterials
-		vector<importedMaterial> importedMaterials;
-		vector<Mesh>* meshes = meshManager->getMeshes();
-		unsigned int materialSize = currentFile->fetch->Main()->materialAmount;
+		unsigned int materialSize = material ? main.materialAmount : 0;
+		model.materials.resize(materialSize);
+		model.materialIds.resize(materialSize);
 
 		for (unsigned int i = 0; i < materialSize; i++)
 		{
-			importedMaterial tempMaterial;
-			tempMaterial.materialName = (std::string)currentFile->fetch->Material(i)->matName;
+			BRFImporterLib::MaterialHeader materialHeader;
+			if (!file.read(materialHeader))
+				return false;
+
+			importedMaterial & tempMaterial = model.materials[i];
+			tempMaterial.materialName = getString(materialHeader.matName);
 
 			tempMaterial.diffuseValue = {
-				(float)currentFile->fetch->Material(i)->diffuseVal[0],
-				(float)currentFile->fetch->Material(i)->diffuseVal[1],
-				(float)currentFile->fetch->Material(i)->diffuseVal[2]
+				(float)materialHeader.diffuseVal[0],
+				(float)materialHeader.diffuseVal[1],
+				(float)materialHeader.diffuseVal[2]
 			};
 
 			tempMaterial.specularValue = {
-				(float)currentFile->fetch->Material(i)->specularVal[0],
-				(float)currentFile->fetch->Material(i)->specularVal[1],
-				(float)currentFile->fetch->Material(i)->specularVal[2]
+				(float)materialHeader.specularVal[0],
+				(float)materialHeader.specularVal[1],
+				(float)materialHeader.specularVal[2]
 			};
 
-			tempMaterial.diffuseTex = (std::string)currentFile->fetch->Material(i)->diffMap;
-			tempMaterial.specularTex = (std::string)currentFile->fetch->Material(i)->specMap;
-			tempMaterial.normalTex = (std::string)currentFile->fetch->Material(i)->normalMap;
-			tempMaterial.glowTex = (std::string)currentFile->fetch->Material(i)->glowMap;
+			tempMaterial.diffuseTex = getString(materialHeader.diffMap);
+			tempMaterial.specularTex = getString(materialHeader.specMap);
+			tempMaterial.normalTex = getString(materialHeader.normalMap);
+			tempMaterial.glowTex = getString(materialHeader.glowMap);
+
+			model.materialIds[i] = materialHeader.Id;
+		}
+#pragma endregion
+
+		return true;
+	}
+
+	void BRFImportHandler::optimizeMesh(Model::MeshData & mesh)
+	{
+		unsigned int vertexCount = (unsigned int)mesh.vertices.size();
+		if (vertexCount == 0)
+			return;
+
+		// the simplified LODs go after the full mesh in the same index buffer
+		vector<UINT> allIndices;
+		mesh.lodCount = buildMeshLods(&mesh.vertices[0].position, vertexCount, sizeof(Vertex), mesh.indices, allIndices, mesh.lods);
+
+		// every pass draws it, reuse the transformed vertices and draw the outside first
+		for (int i = 0; i < mesh.lodCount; i++)
+		{
+			optimizeVertexCache(&allIndices[mesh.lods[i].startIndex], mesh.lods[i].indexCount, vertexCount);
+			optimizeOverdraw(&allIndices[mesh.lods[i].startIndex], mesh.lods[i].indexCount, &mesh.vertices[0].position, vertexCount, sizeof(Vertex), INDEX_OVERDRAW_THRESHOLD);
+		}
+
+		// then the vertices in the order they are used
+		vector<UINT> remap;
+		optimizeVertexFetch(allIndices.data(), allIndices.size(), vertexCount, remap);
+		vector<Vertex> orderedVertices(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; i++)
+			orderedVertices[remap[i]] = mesh.vertices[i];
+
+		mesh.vertices.swap(orderedVertices);
+		mesh.indices.swap(allIndices);
+	}
+
+	void BRFImportHandler::addModel(int id, Model & model, bool isScene)
+	{
+		unsigned int meshSize = (unsigned int)model.meshes.size();
+
+		for (unsigned int i = 0; i < meshSize; i++)
+		{
+			Model::MeshData & meshData = model.meshes[i];
+			meshManager->addMesh(id, false, 0, 0, (unsigned int)meshData.vertices.size(), (UINT)meshData.indices.size(), meshData.vertices, meshData.indices,
+				meshData.lods, meshData.lodCount, isScene);
+		}
+
+#pragma region ImportMaterials
+		vector<importedMaterial> importedMaterials;
+		vector<Mesh>* meshes = meshManager->getMeshes();
+		unsigned int materialSize = (unsigned int)model.materials.size();
+
+		for (unsigned int i = 0; i < materialSize; i++)
+		{
+			importedMaterial tempMaterial = model.materials[i];
 
-			unsigned int tempMaterialID = currentFile->fetch->Material(i)->Id;
+			unsigned int tempMaterialID = model.materialIds[i];
 			tempMaterial.materialID = materialID;
 			if (materialManager->compareImportMaterials(&tempMaterial))
 			{
@@ -150,7 +276,6 @@ namespace Graphics
 
 	void BRFImportHandler::initialize(MeshManager & meshManager, MaterialManager & materialManager)
 	{
-		this->currentFile = newd BRFImporterLib::FileData;
 		this->meshManager = &meshManager;
 		this->materialManager = &materialManager;
 	}
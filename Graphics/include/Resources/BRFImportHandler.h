@@ -1,14 +1,10 @@
 #pragma once
 
-#include <BRF\FileData.h>
-#include <BRF\Fetch.h>
-#include <BRF\MeshData.h>
-#include <BRF\MaterialData.h>
-#include <BRF\SkeletonData.h>
+#include <BRF/BRFImporterStructs.h>
 
 #include "MeshManager.h"
 #include "MaterialManager.h"
-#include <Graphics\Include\Datatypes.h>
+#include <Graphics/include/Datatypes.h>
 #include "Mesh.h"
 namespace Graphics
 {
@@ -18,14 +14,40 @@ namespace Graphics
 		BRFImportHandler();
 		~BRFImportHandler();
 
+		// A file read into memory, nothing on the GPU yet
+		struct Model
+		{
+			struct MeshData
+			{
+				vector<Vertex> vertices;
+				vector<UINT> indices;	// every LOD after each other
+				MeshLod lods[MESH_LOD_COUNT];
+				int lodCount;
+			};
+
+			vector<MeshData> meshes;
+			vector<importedMaterial> materials;
+			vector<unsigned int> materialIds;	// as they are in the file
+		};
+
+		// decodeFile and addModel after each other
 		void loadFile(int id, string fileName, bool mesh, bool material, bool skeleton, bool isScene);
 
+		// Reads and converts the file, safe on any thread. Returns false if it can't be opened or is cut short.
+		// With optimize the meshes get their LODs and the index and vertex order for the GPU, without it
+		// they are as the exporter wrote them with only LOD 0
+		static bool decodeFile(string fileName, bool mesh, bool material, bool skeleton, Model & model, bool optimize = true);
+		// Creates the meshes and materials, on the thread that owns the device context.
+		// Material ids depend on what was added before, models have to come in the same order every time
+		void addModel(int id, Model & model, bool isScene);
+
 		void initialize(MeshManager & meshManager, MaterialManager & materialManager);
 
 	private:
 		unsigned int materialID;
 
-		BRFImporterLib::FileData* currentFile;
+		static void optimizeMesh(Model::MeshData & mesh);
+
 		MeshManager * meshManager;
 		MaterialManager* materialManager;
 
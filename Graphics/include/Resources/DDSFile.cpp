@@ -0,0 +1,319 @@
+#include "DDSFile.h"
+#include <string.h>
+
+#define DDS_MAGIC               0x20534444  // "DDS "
+#define DDS_HEADER_SIZE         124
+#define DDS_PIXELFORMAT_SIZE    32
+#define DDS_DX10_HEADER_SIZE    20
+
+// header flags
+#define DDSD_CAPS               0x1
+#define DDSD_HEIGHT             0x2
+#define DDSD_WIDTH              0x4
+#define DDSD_PITCH              0x8
+#define DDSD_PIXELFORMAT        0x1000
+#define DDSD_MIPMAPCOUNT        0x20000
+#define DDSD_LINEARSIZE         0x80000
+#define DDSD_DEPTH              0x800000
+
+// pixel format flags
+#define DDPF_ALPHAPIXELS        0x1
+#define DDPF_FOURCC             0x4
+#define DDPF_RGB                0x40
+
+#define DDSCAPS_COMPLEX         0x8
+#define DDSCAPS_TEXTURE         0x1000
+#define DDSCAPS_MIPMAP          0x400000
+#define DDSCAPS2_CUBEMAP        0x200
+#define DDSCAPS2_VOLUME         0x200000
+
+#define DDS_DIMENSION_TEXTURE2D 3
+#define DDS_MISC_TEXTURECUBE    0x4
+
+#define FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+namespace Graphics
+{
+    namespace
+    {
+        // the offsets in the header, after the magic
+        enum HeaderField
+        {
+            HEADER_SIZE = 0,
+            HEADER_FLAGS = 1,
+            HEADER_HEIGHT = 2,
+            HEADER_WIDTH = 3,
+            HEADER_PITCH = 4,
+            HEADER_DEPTH = 5,
+            HEADER_MIPS = 6,
+            HEADER_PF_SIZE = 18,
+            HEADER_PF_FLAGS = 19,
+            HEADER_PF_FOURCC = 20,
+            HEADER_PF_BITS = 21,
+            HEADER_PF_RMASK = 22,
+            HEADER_PF_GMASK = 23,
+            HEADER_PF_BMASK = 24,
+            HEADER_PF_AMASK = 25,
+            HEADER_CAPS = 26,
+            HEADER_CAPS2 = 27,
+            HEADER_FIELDS = 31
+        };
+
+        enum DX10Field
+        {
+            DX10_FORMAT = 0,
+            DX10_DIMENSION = 1,
+            DX10_MISC = 2,
+            DX10_ARRAY_SIZE = 3,
+            DX10_MISC2 = 4,
+            DX10_FIELDS = 5
+        };
+
+        uint32_t readU32(const char * bytes)
+        {
+            uint32_t value;
+            memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+
+        void writeU32(std::vector<char> & bytes, uint32_t value)
+        {
+            const char * data = (const char *)&value;
+            bytes.insert(bytes.end(), data, data + sizeof(value));
+        }
+
+        DDSFormat fromFourCC(uint32_t fourCC)
+        {
+            switch (fourCC)
+            {
+            case FOURCC('D', 'X', 'T', '1'): return DDS_FORMAT_BC1;
+            case FOURCC('D', 'X', 'T', '2'):
+            case FOURCC('D', 'X', 'T', '3'): return DDS_FORMAT_BC2;
+            case FOURCC('D', 'X', 'T', '4'):
+            case FOURCC('D', 'X', 'T', '5'): return DDS_FORMAT_BC3;
+            case FOURCC('A', 'T', 'I', '1'):
+            case FOURCC('B', 'C', '4', 'U'): return DDS_FORMAT_BC4;
+            case FOURCC('A', 'T', 'I', '2'):
+            case FOURCC('B', 'C', '5', 'U'): return DDS_FORMAT_BC5;
+            default: return DDS_FORMAT_UNKNOWN;
+            }
+        }
+
+        // typeless, unorm and unorm srgb are next to each other in DXGI_FORMAT
+        DDSFormat fromDXGI(uint32_t format)
+        {
+            switch (format)
+            {
+            case 27: case 28: case 29: return DDS_FORMAT_R8G8B8A8;
+            case 70: case 71: case 72: return DDS_FORMAT_BC1;
+            case 73: case 74: case 75: return DDS_FORMAT_BC2;
+            case 76: case 77: case 78: return DDS_FORMAT_BC3;
+            case 79: case 80:          return DDS_FORMAT_BC4;
+            case 82: case 83:          return DDS_FORMAT_BC5;
+            case 97: case 98: case 99: return DDS_FORMAT_BC7;
+            default: return DDS_FORMAT_UNKNOWN;
+            }
+        }
+    }
+
+    DDSFile::DDSFile()
+    {
+        width = 0;
+        height = 0;
+        format = DDS_FORMAT_UNKNOWN;
+    }
+
+    void DDSFile::create(uint32_t width, uint32_t height, DDSFormat format, uint32_t mipCount)
+    {
+        this->width = width;
+        this->height = height;
+        this->format = format;
+
+        uint32_t fullCount = getFullMipCount(width, height);
+        if (mipCount == 0 || mipCount > fullCount)
+            mipCount = fullCount;
+
+        uint32_t elementSize = getBytesPerElement(format);
+        bool blocks = isBlockCompressed(format);
+        size_t offset = 0;
+
+        mips.resize(mipCount);
+        for (uint32_t i = 0; i < mipCount; i++)
+        {
+            Mip & mip = mips[i];
+            mip.width = width >> i ? width >> i : 1;
+            mip.height = height >> i ? height >> i : 1;
+
+            // mips smaller than a block still take a whole one
+            uint32_t columns = blocks ? (mip.width + 3) / 4 : mip.width;
+            mip.rows = blocks ? (mip.height + 3) / 4 : mip.height;
+            mip.rowPitch = columns * elementSize;
+            mip.offset = offset;
+            mip.size = (size_t)mip.rowPitch * mip.rows;
+
+            offset += mip.size;
+        }
+
+        data.assign(offset, 0);
+    }
+
+    bool DDSFile::read(const char * bytes, size_t size)
+    {
+        *this = DDSFile();
+
+        size_t headerEnd = 4 + DDS_HEADER_SIZE;
+        if (size < headerEnd || readU32(bytes) != DDS_MAGIC)
+            return false;
+
+        uint32_t header[HEADER_FIELDS];
+        memcpy(header, bytes + 4, sizeof(header));
+        if (header[HEADER_SIZE] != DDS_HEADER_SIZE || header[HEADER_PF_SIZE] != DDS_PIXELFORMAT_SIZE)
+            return false;
+
+        if ((header[HEADER_CAPS2] & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) || (header[HEADER_FLAGS] & DDSD_DEPTH && header[HEADER_DEPTH] > 1))
+            return false;
+
+        DDSFormat fileFormat = DDS_FORMAT_UNKNOWN;
+        uint32_t pixelFlags = header[HEADER_PF_FLAGS];
+
+        if ((pixelFlags & DDPF_FOURCC) && header[HEADER_PF_FOURCC] == FOURCC('D', 'X', '1', '0'))
+        {
+            if (size < headerEnd + DDS_DX10_HEADER_SIZE)
+                return false;
+
+            uint32_t dx10[DX10_FIELDS];
+            memcpy(dx10, bytes + headerEnd, sizeof(dx10));
+            headerEnd += DDS_DX10_HEADER_SIZE;
+
+            if (dx10[DX10_DIMENSION] != DDS_DIMENSION_TEXTURE2D || dx10[DX10_ARRAY_SIZE] > 1 || (dx10[DX10_MISC] & DDS_MISC_TEXTURECUBE))
+                return false;
+
+            fileFormat = fromDXGI(dx10[DX10_FORMAT]);
+        }
+        else if (pixelFlags & DDPF_FOURCC)
+        {
+            fileFormat = fromFourCC(header[HEADER_PF_FOURCC]);
+        }
+        else if ((pixelFlags & DDPF_RGB) && header[HEADER_PF_BITS] == 32 &&
+            header[HEADER_PF_RMASK] == 0x000000ff && header[HEADER_PF_GMASK] == 0x0000ff00 &&
+            header[HEADER_PF_BMASK] == 0x00ff0000)
+        {
+            // without alpha the fourth byte is still there, it just isn't read as alpha
+            fileFormat = DDS_FORMAT_R8G8B8A8;
+        }
+
+        uint32_t fileWidth = header[HEADER_WIDTH];
+        uint32_t fileHeight = header[HEADER_HEIGHT];
+        uint32_t mipCount = (header[HEADER_FLAGS] & DDSD_MIPMAPCOUNT) && header[HEADER_MIPS] > 0 ? header[HEADER_MIPS] : 1;
+
+        if (fileFormat == DDS_FORMAT_UNKNOWN || fileWidth == 0 || fileHeight == 0 || mipCount > getFullMipCount(fileWidth, fileHeight))
+            return false;
+
+        create(fileWidth, fileHeight, fileFormat, mipCount);
+        if (size - headerEnd < data.size())
+        {
+            *this = DDSFile();
+            return false;
+        }
+
+        memcpy(data.data(), bytes + headerEnd, data.size());
+        return true;
+    }
+
+    void DDSFile::write(std::vector<char> & bytes) const
+    {
+        bool blocks = isBlockCompressed(format);
+        uint32_t header[HEADER_FIELDS] = {};
+
+        header[HEADER_SIZE] = DDS_HEADER_SIZE;
+        header[HEADER_FLAGS] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | (blocks ? DDSD_LINEARSIZE : DDSD_PITCH);
+        header[HEADER_HEIGHT] = height;
+        header[HEADER_WIDTH] = width;
+        header[HEADER_PITCH] = mips.empty() ? 0 : (blocks ? (uint32_t)mips[0].size : mips[0].rowPitch);
+        header[HEADER_DEPTH] = 1;
+        header[HEADER_MIPS] = (uint32_t)mips.size();
+        header[HEADER_PF_SIZE] = DDS_PIXELFORMAT_SIZE;
+        header[HEADER_PF_FLAGS] = DDPF_FOURCC;
+        header[HEADER_PF_FOURCC] = FOURCC('D', 'X', '1', '0');
+        header[HEADER_CAPS] = DDSCAPS_TEXTURE | (mips.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+        bytes.clear();
+        bytes.reserve(4 + DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE + data.size());
+
+        writeU32(bytes, DDS_MAGIC);
+        for (uint32_t field : header)
+            writeU32(bytes, field);
+
+        writeU32(bytes, format);
+        writeU32(bytes, DDS_DIMENSION_TEXTURE2D);
+        writeU32(bytes, 0);
+        writeU32(bytes, 1);
+        writeU32(bytes, 0);
+
+        bytes.insert(bytes.end(), data.begin(), data.end());
+    }
+
+    uint32_t DDSFile::getWidth() const
+    {
+        return width;
+    }
+
+    uint32_t DDSFile::getHeight() const
+    {
+        return height;
+    }
+
+    DDSFormat DDSFile::getFormat() const
+    {
+        return format;
+    }
+
+    uint32_t DDSFile::getMipCount() const
+    {
+        return (uint32_t)mips.size();
+    }
+
+    DDSFile::Mip const & DDSFile::getMip(uint32_t mip) const
+    {
+        return mips[mip];
+    }
+
+    char * DDSFile::getData(uint32_t mip)
+    {
+        return data.data() + mips[mip].offset;
+    }
+
+    const char * DDSFile::getData(uint32_t mip) const
+    {
+        return data.data() + mips[mip].offset;
+    }
+
+    uint32_t DDSFile::getFullMipCount(uint32_t width, uint32_t height)
+    {
+        uint32_t count = 1;
+        for (uint32_t size = width > height ? width : height; size > 1; size >>= 1)
+            count++;
+
+        return count;
+    }
+
+    bool DDSFile::isBlockCompressed(DDSFormat format)
+    {
+        return format != DDS_FORMAT_UNKNOWN && format != DDS_FORMAT_R8G8B8A8;
+    }
+
+    uint32_t DDSFile::getBytesPerElement(DDSFormat format)
+    {
+        switch (format)
+        {
+        case DDS_FORMAT_R8G8B8A8: return 4;
+        case DDS_FORMAT_BC1:
+        case DDS_FORMAT_BC4: return 8;
+        case DDS_FORMAT_BC2:
+        case DDS_FORMAT_BC3:
+        case DDS_FORMAT_BC5:
+        case DDS_FORMAT_BC7: return 16;
+        default: return 0;
+        }
+    }
+}
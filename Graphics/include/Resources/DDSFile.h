@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace Graphics
+{
+    // the DXGI_FORMAT values, so they can be given to D3D as they are
+    enum DDSFormat
+    {
+        DDS_FORMAT_UNKNOWN  = 0,
+        DDS_FORMAT_R8G8B8A8 = 28,
+        DDS_FORMAT_BC1      = 71,
+        DDS_FORMAT_BC2      = 74,
+        DDS_FORMAT_BC3      = 77,
+        DDS_FORMAT_BC4      = 80,
+        DDS_FORMAT_BC5      = 83,
+        DDS_FORMAT_BC7      = 98
+    };
+
+    /*
+        A 2D texture with all its mips, laid out the way a .dds file has them.
+
+        Only what the cooker writes and what is in Resources is handled: one
+        2D texture (no arrays, cubes or volumes) in one of the formats above.
+        Legacy DXT1-5/ATI1/ATI2 headers and DX10 headers are read, DX10
+        headers are written. The sRGB and typeless variants are read as the
+        UNORM format, nothing in the renderer samples through sRGB views.
+
+        Pure CPU, no D3D. The textures are decoded on loader workers with it
+        and written by the texture cooker in Tools.
+    */
+    class DDSFile
+    {
+    public:
+        struct Mip
+        {
+            uint32_t width;
+            uint32_t height;
+            uint32_t rowPitch;  // bytes in a row of pixels, or of 4x4 blocks
+            uint32_t rows;      // of pixels, or of blocks
+            size_t offset;      // in data
+            size_t size;
+        };
+
+        DDSFile();
+
+        // mips from width and height down, 0 is the whole chain. data is sized to fit, zeroed
+        void create(uint32_t width, uint32_t height, DDSFormat format, uint32_t mipCount = 0);
+
+        // false if it isn't a .dds this can read, the file is left empty
+        bool read(const char * bytes, size_t size);
+        void write(std::vector<char> & bytes) const;
+
+        uint32_t getWidth() const;
+        uint32_t getHeight() const;
+        DDSFormat getFormat() const;
+        uint32_t getMipCount() const;
+        Mip const & getMip(uint32_t mip) const;
+
+        char * getData(uint32_t mip);
+        const char * getData(uint32_t mip) const;
+
+        // levels down to 1x1
+        static uint32_t getFullMipCount(uint32_t width, uint32_t height);
+        static bool isBlockCompressed(DDSFormat format);
+        // per 4x4 block, or per pixel when it isn't block compressed, 0 if unknown
+        static uint32_t getBytesPerElement(DDSFormat format);
+    private:
+        uint32_t width;
+        uint32_t height;
+        DDSFormat format;
+        std::vector<Mip> mips;
+        std::vector<char> data;
+    };
+}
@@ -0,0 +1,262 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#endif
+
+#define WATCH_BUFFER_SIZE 16384
+
+namespace Graphics
+{
+#ifdef _WIN32
+    struct FileWatcher::Folder
+    {
+        std::string path;
+        HANDLE handle;
+        OVERLAPPED overlapped;
+        DWORD buffer[WATCH_BUFFER_SIZE / sizeof(DWORD)];   // DWORD aligned, like ReadDirectoryChangesW wants
+
+        bool read()
+        {
+            return ReadDirectoryChangesW(handle, buffer, sizeof(buffer), TRUE,
+                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE, nullptr, &overlapped, nullptr) != FALSE;
+        }
+    };
+#else
+    struct FileWatcher::Folder
+    {
+        std::string path;
+        int watch;
+    };
+#endif
+
+    namespace
+    {
+        std::string withoutTrailingSlash(std::string path)
+        {
+            while (path.size() > 1 && (path.back() == '/' || path.back() == '\\'))
+                path.pop_back();
+            return path;
+        }
+    }
+
+    FileWatcher::FileWatcher()
+    {
+        descriptor = -1;
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        unwatchAll();
+    }
+
+    bool FileWatcher::isWatching() const
+    {
+        return !folders.empty();
+    }
+
+    void FileWatcher::report(std::string const & path, std::vector<std::string> & changed, size_t firstNew) const
+    {
+        if (std::find(changed.begin() + firstNew, changed.end(), path) == changed.end())
+            changed.push_back(path);
+    }
+
+#ifdef _WIN32
+    bool FileWatcher::watch(std::string const & folder)
+    {
+        std::unique_ptr<Folder> watched(new Folder());
+        watched->path = withoutTrailingSlash(folder);
+        watched->handle = CreateFileA(watched->path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (watched->handle == INVALID_HANDLE_VALUE)
+            return false;
+
+        watched->overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        if (!watched->overlapped.hEvent || !watched->read())
+        {
+            if (watched->overlapped.hEvent)
+                CloseHandle(watched->overlapped.hEvent);
+            CloseHandle(watched->handle);
+            return false;
+        }
+
+        folders.push_back(std::move(watched));
+        return true;
+    }
+
+    void FileWatcher::unwatchAll()
+    {
+        for (auto & folder : folders)
+        {
+            // the buffer can't go away while the read still writes into it
+            DWORD bytes;
+            CancelIoEx(folder->handle, &folder->overlapped);
+            GetOverlappedResult(folder->handle, &folder->overlapped, &bytes, TRUE);
+
+            CloseHandle(folder->overlapped.hEvent);
+            CloseHandle(folder->handle);
+        }
+        folders.clear();
+    }
+
+    void FileWatcher::poll(std::vector<std::string> & changed)
+    {
+        size_t firstNew = changed.size();
+
+        for (auto & folder : folders)
+        {
+            DWORD bytes = 0;
+            if (!GetOverlappedResult(folder->handle, &folder->overlapped, &bytes, FALSE))
+            {
+                if (GetLastError() == ERROR_IO_INCOMPLETE)
+                    continue;
+                bytes = 0;
+            }
+
+            // zero bytes is an overflow, whatever changed is lost
+            const char * event = (const char *)folder->buffer;
+            while (bytes > 0)
+            {
+                const FILE_NOTIFY_INFORMATION * info = (const FILE_NOTIFY_INFORMATION *)event;
+                if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+                {
+                    int wideLength = (int)(info->FileNameLength / sizeof(WCHAR));
+                    int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, nullptr, 0, nullptr, nullptr);
+                    std::string name(length, '\0');
+                    WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, &name[0], length, nullptr, nullptr);
+                    std::replace(name.begin(), name.end(), '\\', '/');
+
+                    // folders are "modified" when something in them is
+                    std::string path = folder->path + "/" + name;
+                    DWORD attributes = GetFileAttributesA(path.c_str());
+                    if (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY))
+                        report(path, changed, firstNew);
+                }
+
+                if (info->NextEntryOffset == 0)
+                    break;
+                event += info->NextEntryOffset;
+            }
+
+            ResetEvent(folder->overlapped.hEvent);
+            folder->read();
+        }
+    }
+#else
+    bool FileWatcher::watch(std::string const & folder)
+    {
+        if (descriptor < 0)
+        {
+            descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (descriptor < 0)
+                return false;
+        }
+
+        return addFolder(withoutTrailingSlash(folder), nullptr);
+    }
+
+    bool FileWatcher::addFolder(std::string const & path, std::vector<std::string> * created)
+    {
+        int watch = inotify_add_watch(descriptor, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+        if (watch < 0)
+            return false;
+
+        // the same folder twice is the same watch
+        for (auto const & folder : folders)
+        {
+            if (folder->watch == watch)
+                return true;
+        }
+
+        folders.push_back(std::unique_ptr<Folder>(new Folder{ path, watch }));
+
+        DIR * directory = opendir(path.c_str());
+        if (!directory)
+            return true;
+
+        while (dirent * entry = readdir(directory))
+        {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..")
+                continue;
+
+            struct stat info;
+            std::string child = path + "/" + name;
+            if (stat(child.c_str(), &info) != 0)
+                continue;
+
+            if (S_ISDIR(info.st_mode))
+                addFolder(child, created);
+            else if (created)   // written before the watch was there
+                created->push_back(child);
+        }
+
+        closedir(directory);
+        return true;
+    }
+
+    void FileWatcher::unwatchAll()
+    {
+        if (descriptor >= 0)
+            ::close(descriptor);
+
+        descriptor = -1;
+        folders.clear();
+    }
+
+    void FileWatcher::poll(std::vector<std::string> & changed)
+    {
+        if (descriptor < 0)
+            return;
+
+        size_t firstNew = changed.size();
+        alignas(inotify_event) char buffer[WATCH_BUFFER_SIZE];
+
+        ssize_t size;
+        while ((size = read(descriptor, buffer, sizeof(buffer))) > 0)
+        {
+            for (char * event = buffer; event < buffer + size; )
+            {
+                const inotify_event * info = (const inotify_event *)event;
+                event += sizeof(inotify_event) + info->len;
+
+                // an overflow (watch -1) loses whatever changed, nothing to do about it
+                auto folder = std::find_if(folders.begin(), folders.end(), [&](std::unique_ptr<Folder> const & folder) { return folder->watch == info->wd; });
+                if (folder == folders.end())
+                    continue;
+
+                if (info->mask & IN_IGNORED)
+                {
+                    folders.erase(folder);
+                    continue;
+                }
+
+                if (info->len == 0)
+                    continue;
+
+                std::string path = (*folder)->path + "/" + info->name;
+                if (info->mask & IN_ISDIR)
+                {
+                    if (info->mask & (IN_CREATE | IN_MOVED_TO))
+                    {
+                        std::vector<std::string> created;
+                        addFolder(path, &created);
+                        for (std::string const & file : created)
+                            report(file, changed, firstNew);
+                    }
+                }
+                else if (info->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                {
+                    report(path, changed, firstNew);
+                }
+            }
+        }
+    }
+#endif
+}
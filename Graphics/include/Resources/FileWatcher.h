@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace Graphics
+{
+    /*
+        Tells which files under some folders were written since it was last
+        asked. ReadDirectoryChangesW on Windows, inotify on Linux. Folders
+        created under a watched one are watched too.
+
+        Nothing happens in the background, poll never blocks and is meant to
+        be called once a frame. A file is reported once per poll however many
+        times it was written, saving from an editor is usually a few writes.
+
+        Paths are the watched folder as it was given, then the path under it
+        with forward slashes: watch("Resources") reports
+        "Resources/Shaders/ForwardPlus.hlsl".
+
+        HOW TO USE:
+            watcher.watch("Resources");
+            std::vector<std::string> changed;
+            watcher.poll(changed);
+    */
+    class FileWatcher
+    {
+    public:
+        FileWatcher();
+        ~FileWatcher();
+
+        // false if the folder is missing or can't be watched
+        bool watch(std::string const & folder);
+        void unwatchAll();
+        bool isWatching() const;
+
+        // files written, created or moved in since the last poll, appended to changed
+        void poll(std::vector<std::string> & changed);
+    private:
+        // a directory handle and its pending read on Windows, a watch descriptor elsewhere
+        struct Folder;
+        std::vector<std::unique_ptr<Folder>> folders;
+        int descriptor;
+
+        void report(std::string const & path, std::vector<std::string> & changed, size_t firstNew) const;
+#ifndef _WIN32
+        bool addFolder(std::string const & path, std::vector<std::string> * created);
+#endif
+    };
+}
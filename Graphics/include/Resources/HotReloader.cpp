@@ -0,0 +1,161 @@
+#include "HotReloader.h"
+#include "AssetArchive.h"
+#include <iostream>
+#include <exception>
+#include <algorithm>
+
+#define HOT_RELOAD_SETTLE_MS 100
+
+namespace Graphics
+{
+    HotReloader & HotReloader::singleton()
+    {
+        static HotReloader instance;
+        return instance;
+    }
+
+    HotReloader::HotReloader()
+    {
+        nextSubscription = INVALID_SUBSCRIPTION + 1;
+        settleTime = std::chrono::milliseconds(HOT_RELOAD_SETTLE_MS);
+    }
+
+    bool HotReloader::watch(std::string const & folder)
+    {
+        return watcher.watch(folder);
+    }
+
+    void HotReloader::unwatchAll()
+    {
+        watcher.unwatchAll();
+    }
+
+    void HotReloader::setSettleTime(uint32_t milliseconds)
+    {
+        settleTime = std::chrono::milliseconds(milliseconds);
+    }
+
+    HotReloader::Subscription HotReloader::subscribe(std::string const & path, Callback callback, std::vector<std::string> const & extensions)
+    {
+        Listener listener;
+        listener.subscription = nextSubscription++;
+        listener.path = AssetArchive::normalizeName(path);
+        listener.folder = !listener.path.empty() && listener.path.back() == '/';
+        for (std::string const & extension : extensions)
+            listener.extensions.push_back(AssetArchive::normalizeName(extension));
+        listener.callback = std::move(callback);
+
+        if (nextSubscription == INVALID_SUBSCRIPTION)
+            nextSubscription++;
+
+        listeners.push_back(std::move(listener));
+        return listeners.back().subscription;
+    }
+
+    void HotReloader::unsubscribe(Subscription subscription)
+    {
+        listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+            [subscription](Listener const & listener) { return listener.subscription == subscription; }), listeners.end());
+    }
+
+    void HotReloader::queue(std::string const & path)
+    {
+        // written again, the wait starts over
+        pending[AssetArchive::normalizeName(path)] = { path, Clock::now() };
+    }
+
+    uint32_t HotReloader::update()
+    {
+        changed.clear();
+        watcher.poll(changed);
+        for (std::string const & path : changed)
+            queue(path);
+
+        if (pending.empty())
+            return 0;
+
+        Clock::time_point now = Clock::now();
+        std::vector<std::pair<std::string, std::string>> settled;
+        for (auto change = pending.begin(); change != pending.end(); )
+        {
+            if (now - change->second.time >= settleTime)
+            {
+                settled.push_back({ change->first, change->second.path });
+                change = pending.erase(change);
+            }
+            else
+            {
+                change++;
+            }
+        }
+
+        // the same order every time, whatever order the files were saved in
+        std::sort(settled.begin(), settled.end());
+
+        uint32_t reloaded = 0;
+        for (auto const & change : settled)
+            reloaded += dispatch(change.first, change.second);
+
+        return reloaded;
+    }
+
+    uint32_t HotReloader::getPendingCount() const
+    {
+        return (uint32_t)pending.size();
+    }
+
+    bool HotReloader::matches(Listener const & listener, std::string const & normalized)
+    {
+        if (!listener.folder)
+            return normalized == listener.path;
+        if (normalized.compare(0, listener.path.size(), listener.path) != 0)
+            return false;
+        if (listener.extensions.empty())
+            return true;
+
+        for (std::string const & extension : listener.extensions)
+        {
+            if (normalized.size() >= extension.size() &&
+                normalized.compare(normalized.size() - extension.size(), extension.size(), extension) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    uint32_t HotReloader::dispatch(std::string const & normalized, std::string const & path)
+    {
+        std::vector<Subscription> matching;
+        for (Listener const & listener : listeners)
+        {
+            if (matches(listener, normalized))
+                matching.push_back(listener.subscription);
+        }
+
+        uint32_t reloaded = 0;
+        for (Subscription subscription : matching)
+        {
+            // a callback can unsubscribe itself or the ones after it
+            auto listener = std::find_if(listeners.begin(), listeners.end(),
+                [subscription](Listener const & listener) { return listener.subscription == subscription; });
+            if (listener == listeners.end())
+                continue;
+
+            Callback callback = listener->callback;
+            try
+            {
+                callback(path);
+                reloaded++;
+            }
+            catch (const char * error)
+            {
+                std::cout << "Reloading " << path << " failed: " << error << std::endl;
+            }
+            catch (std::exception const & error)
+            {
+                std::cout << "Reloading " << path << " failed: " << error.what() << std::endl;
+            }
+        }
+
+        return reloaded;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <chrono>
+#include "FileWatcher.h"
+
+namespace Graphics
+{
+    /*
+        Reloads resources when their files change, without restarting. The
+        owner of a resource subscribes to its file (or a whole folder) and
+        swaps the new version in from the callback, behind the handle or
+        object everything else already holds.
+
+        Changes are queued as the FileWatcher reports them and the callbacks
+        run from update, called once a frame where nothing is using the
+        resources (before the game updates). A file is only reloaded once it
+        has stopped changing for the settle time, so a save that is a few
+        writes is one reload and nothing reads a half written file.
+
+        A callback that throws (a data file with a typo, a shader that
+        doesn't compile) is reported and the rest still run. Callbacks should
+        load into something new and only swap when that worked, so the old
+        version stays if it didn't.
+
+        Everything is on the thread calling update. Reading goes through the
+        VirtualFileSystem, so loose override has to be on for edits to files
+        that are also in the asset archive (it is in DEBUG builds).
+
+        HOW TO USE:
+            HotReloader::singleton().watch("Resources");
+            Subscription subscription = HotReloader::singleton().subscribe("Resources/Data/Cards.lw", [this](std::string const & path) { reload(); });
+            HotReloader::singleton().update();      // once a frame
+            HotReloader::singleton().unsubscribe(subscription);
+    */
+    class HotReloader
+    {
+    public:
+        typedef uint32_t Subscription;
+        typedef std::function<void(std::string const & path)> Callback;
+        static const Subscription INVALID_SUBSCRIPTION = 0;
+
+        static HotReloader & singleton();
+
+        HotReloader();
+
+        // everything under folder, false if it can't be watched
+        bool watch(std::string const & folder);
+        void unwatchAll();
+        void setSettleTime(uint32_t milliseconds);
+
+        // path is a file, or a folder ending in / for everything under it. A folder can be narrowed to
+        // files ending in one of extensions (".hlsl"), empty is every file.
+        // Paths are compared like the asset archive does, case and slashes don't matter
+        Subscription subscribe(std::string const & path, Callback callback, std::vector<std::string> const & extensions = {});
+        void unsubscribe(Subscription subscription);
+
+        // reloads path as if it had changed on disk
+        void queue(std::string const & path);
+        // polls the watcher and runs the callbacks of the files that settled, returns how many ran
+        uint32_t update();
+        uint32_t getPendingCount() const;
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Listener
+        {
+            Subscription subscription;
+            std::string path;       // normalized
+            bool folder;
+            std::vector<std::string> extensions;   // normalized, empty for every file
+            Callback callback;
+        };
+
+        struct Change
+        {
+            std::string path;       // as it was reported, what the callbacks get
+            Clock::time_point time;
+        };
+
+        FileWatcher watcher;
+        std::vector<Listener> listeners;
+        std::unordered_map<std::string, Change> pending;   // on the normalized path
+        std::vector<std::string> changed;
+        Subscription nextSubscription;
+        Clock::duration settleTime;
+
+        uint32_t dispatch(std::string const & normalized, std::string const & path);
+        static bool matches(Listener const & listener, std::string const & normalized);
+    };
+}
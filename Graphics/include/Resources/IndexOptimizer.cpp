@@ -0,0 +1,427 @@
+#include "IndexOptimizer.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+// Forsyth's scoring, the cache size is what is scored, not the hardware's
+#define FORSYTH_CACHE_SIZE 32
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+#define FORSYTH_MAX_VALENCE 64
+
+namespace Graphics
+{
+    namespace
+    {
+        // vertex scores only depend on cache position and valence, they are looked up
+        struct ScoreTable
+        {
+            float cache[FORSYTH_CACHE_SIZE];
+            float valence[FORSYTH_MAX_VALENCE];
+
+            ScoreTable()
+            {
+                for (int i = 0; i < FORSYTH_CACHE_SIZE; i++)
+                {
+                    if (i < 3)
+                    {
+                        // the triangle just drawn, which of its vertices doesn't matter
+                        cache[i] = FORSYTH_LAST_TRIANGLE_SCORE;
+                    }
+                    else
+                    {
+                        float scale = 1.f / (FORSYTH_CACHE_SIZE - 3);
+                        cache[i] = powf(1.f - (i - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+                    }
+                }
+
+                valence[0] = 0.f;
+                for (int i = 1; i < FORSYTH_MAX_VALENCE; i++)
+                    valence[i] = FORSYTH_VALENCE_BOOST_SCALE * powf((float)i, -FORSYTH_VALENCE_BOOST_POWER);
+            }
+
+            float score(int cachePosition, unsigned int remaining) const
+            {
+                // nothing left to draw, never picked again
+                if (remaining == 0)
+                    return -1.f;
+
+                float result = valence[remaining < FORSYTH_MAX_VALENCE ? remaining : FORSYTH_MAX_VALENCE - 1];
+                if (cachePosition >= 0)
+                    result += cache[cachePosition];
+                return result;
+            }
+        };
+
+        // triangles using each vertex, flattened
+        struct Adjacency
+        {
+            std::vector<unsigned int> counts;
+            std::vector<unsigned int> offsets;
+            std::vector<unsigned int> triangles;
+
+            Adjacency(unsigned int const * indices, size_t indexCount, size_t vertexCount)
+                : counts(vertexCount, 0), offsets(vertexCount, 0), triangles(indexCount)
+            {
+                for (size_t i = 0; i < indexCount; i++)
+                    counts[indices[i]]++;
+
+                unsigned int offset = 0;
+                for (size_t i = 0; i < vertexCount; i++)
+                {
+                    offsets[i] = offset;
+                    offset += counts[i];
+                }
+
+                std::vector<unsigned int> filled(vertexCount, 0);
+                for (size_t i = 0; i < indexCount; i++)
+                {
+                    unsigned int vertex = indices[i];
+                    triangles[offsets[vertex] + filled[vertex]++] = (unsigned int)(i / 3);
+                }
+            }
+        };
+
+        struct Float3
+        {
+            float x, y, z;
+        };
+
+        Float3 position(const void * positions, size_t stride, unsigned int vertex)
+        {
+            Float3 result;
+            memcpy(&result, (const char *)positions + vertex * stride, sizeof(result));
+            return result;
+        }
+
+        // the vertices of a triangle that weren't in the FIFO cache. A vertex is in it
+        // if it went in less than INDEX_CACHE_SIZE misses ago
+        unsigned int countMisses(unsigned int const * triangle, std::vector<unsigned int> & timestamps, unsigned int & time)
+        {
+            unsigned int misses = 0;
+            for (int corner = 0; corner < 3; corner++)
+            {
+                if (time - timestamps[triangle[corner]] > INDEX_CACHE_SIZE)
+                {
+                    timestamps[triangle[corner]] = time++;
+                    misses++;
+                }
+            }
+            return misses;
+        }
+
+        void flushCache(unsigned int & time)
+        {
+            time += INDEX_CACHE_SIZE + 1;
+        }
+
+        unsigned int countMisses(unsigned int const * indices, size_t triangleCount, std::vector<unsigned int> & timestamps, unsigned int & time)
+        {
+            unsigned int misses = 0;
+            flushCache(time);
+            for (size_t i = 0; i < triangleCount; i++)
+                misses += countMisses(&indices[i * 3], timestamps, time);
+            return misses;
+        }
+    }
+
+    void optimizeVertexCache(unsigned int * indices, size_t indexCount, size_t vertexCount)
+    {
+        size_t triangleCount = indexCount / 3;
+        if (triangleCount < 2)
+            return;
+
+        static const ScoreTable table;
+        Adjacency adjacency(indices, indexCount, vertexCount);
+
+        std::vector<float> vertexScores(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+            vertexScores[i] = table.score(-1, adjacency.counts[i]);
+
+        std::vector<bool> drawn(triangleCount, false);
+        std::vector<unsigned int> result;
+        result.reserve(indexCount);
+
+        // three more while the drawn triangle is pushed in front
+        unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+        unsigned int cacheCount = 0;
+
+        size_t nextUndrawn = 0;
+        size_t best = 0;
+
+        while (result.size() < indexCount)
+        {
+            unsigned int const * triangle = &indices[best * 3];
+            drawn[best] = true;
+            result.insert(result.end(), triangle, triangle + 3);
+
+            // the drawn triangle first, then what was in the cache before
+            unsigned int newCache[FORSYTH_CACHE_SIZE + 3];
+            unsigned int newCount = 0;
+            for (int corner = 0; corner < 3; corner++)
+            {
+                unsigned int vertex = triangle[corner];
+                if (std::find(newCache, newCache + newCount, vertex) == newCache + newCount)
+                    newCache[newCount++] = vertex;
+
+                // it's drawn, take it out of what the vertex is still used by
+                unsigned int * used = &adjacency.triangles[adjacency.offsets[vertex]];
+                unsigned int & count = adjacency.counts[vertex];
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    if (used[i] == best)
+                    {
+                        used[i] = used[--count];
+                        break;
+                    }
+                }
+            }
+            for (unsigned int i = 0; i < cacheCount; i++)
+            {
+                unsigned int vertex = cache[i];
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                    newCache[newCount++] = vertex;
+            }
+
+            // the ones pushed out the back aren't in the cache any more
+            for (unsigned int i = FORSYTH_CACHE_SIZE; i < newCount; i++)
+                vertexScores[newCache[i]] = table.score(-1, adjacency.counts[newCache[i]]);
+            cacheCount = newCount < FORSYTH_CACHE_SIZE ? newCount : FORSYTH_CACHE_SIZE;
+            memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+
+            for (unsigned int i = 0; i < cacheCount; i++)
+                vertexScores[cache[i]] = table.score((int)i, adjacency.counts[cache[i]]);
+
+            // only triangles around the cache changed score, the best next one is one of them
+            float bestScore = -1.f;
+            for (unsigned int i = 0; i < cacheCount; i++)
+            {
+                unsigned int vertex = cache[i];
+                unsigned int const * used = &adjacency.triangles[adjacency.offsets[vertex]];
+                for (unsigned int j = 0; j < adjacency.counts[vertex]; j++)
+                {
+                    unsigned int candidate = used[j];
+                    unsigned int const * corners = &indices[candidate * 3];
+                    float score = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        best = candidate;
+                    }
+                }
+            }
+
+            // nothing in the cache is used any more, carry on where the mesh hasn't been drawn
+            if (bestScore < 0.f)
+            {
+                while (nextUndrawn < triangleCount && drawn[nextUndrawn])
+                    nextUndrawn++;
+                best = nextUndrawn;
+            }
+        }
+
+        memcpy(indices, result.data(), indexCount * sizeof(unsigned int));
+    }
+
+    void optimizeOverdraw(unsigned int * indices, size_t indexCount, const void * positions, size_t vertexCount, size_t stride, float threshold)
+    {
+        size_t triangleCount = indexCount / 3;
+        if (triangleCount < 2)
+            return;
+
+        std::vector<unsigned int> timestamps(vertexCount, 0);
+        unsigned int time = 0;
+        flushCache(time);
+
+        // hard boundaries, where the cache order started over anyway
+        std::vector<size_t> hard;
+        for (size_t i = 0; i < triangleCount; i++)
+        {
+            // the first triangle can be degenerate and miss less
+            unsigned int misses = countMisses(&indices[i * 3], timestamps, time);
+            if (i == 0 || misses == 3)
+                hard.push_back(i);
+        }
+        hard.push_back(triangleCount);
+
+        // soft boundaries, cut as soon as what came before is about as good as the whole cluster
+        std::vector<size_t> split;
+        for (size_t c = 0; c + 1 < hard.size(); c++)
+        {
+            size_t first = hard[c], last = hard[c + 1];
+
+            unsigned int misses = 0;
+            flushCache(time);
+            for (size_t i = first; i < last; i++)
+                misses += countMisses(&indices[i * 3], timestamps, time);
+            float clusterAcmr = (float)misses / (last - first);
+
+            split.push_back(first);
+            size_t start = first;
+            misses = 0;
+            flushCache(time);
+            for (size_t i = first; i + 1 < last; i++)
+            {
+                misses += countMisses(&indices[i * 3], timestamps, time);
+                if ((float)misses / (i + 1 - start) <= clusterAcmr * threshold)
+                {
+                    split.push_back(i + 1);
+                    start = i + 1;
+                    misses = 0;
+                    flushCache(time);
+                }
+            }
+
+            // what is left after the last cut wasn't checked, if it's worse it goes with the one before
+            if (start > first)
+            {
+                misses += countMisses(&indices[(last - 1) * 3], timestamps, time);
+                if ((float)misses / (last - start) > clusterAcmr * threshold)
+                    split.pop_back();
+            }
+        }
+        split.push_back(triangleCount);
+
+        Float3 meshCenter = { 0.f, 0.f, 0.f };
+        float meshArea = 0.f;
+
+        struct Cluster
+        {
+            size_t first, last;
+            Float3 center;
+            Float3 normal;
+            float area;
+            float sortKey;
+        };
+        std::vector<Cluster> sorted(split.size() - 1);
+
+        for (size_t c = 0; c + 1 < split.size(); c++)
+        {
+            Cluster & cluster = sorted[c];
+            cluster = { split[c], split[c + 1], { 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f }, 0.f, 0.f };
+
+            for (size_t i = cluster.first; i < cluster.last; i++)
+            {
+                Float3 a = position(positions, stride, indices[i * 3]);
+                Float3 b = position(positions, stride, indices[i * 3 + 1]);
+                Float3 d = position(positions, stride, indices[i * 3 + 2]);
+
+                Float3 ab = { b.x - a.x, b.y - a.y, b.z - a.z };
+                Float3 ad = { d.x - a.x, d.y - a.y, d.z - a.z };
+                Float3 normal = { ab.y * ad.z - ab.z * ad.y, ab.z * ad.x - ab.x * ad.z, ab.x * ad.y - ab.y * ad.x };
+                float area = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+                // area weighted, big triangles say more about where it faces
+                cluster.center.x += (a.x + b.x + d.x) / 3.f * area;
+                cluster.center.y += (a.y + b.y + d.y) / 3.f * area;
+                cluster.center.z += (a.z + b.z + d.z) / 3.f * area;
+                cluster.normal.x += normal.x;
+                cluster.normal.y += normal.y;
+                cluster.normal.z += normal.z;
+                cluster.area += area;
+            }
+
+            meshCenter.x += cluster.center.x;
+            meshCenter.y += cluster.center.y;
+            meshCenter.z += cluster.center.z;
+            meshArea += cluster.area;
+
+            if (cluster.area > 0.f)
+            {
+                cluster.center.x /= cluster.area;
+                cluster.center.y /= cluster.area;
+                cluster.center.z /= cluster.area;
+            }
+        }
+
+        if (meshArea > 0.f)
+        {
+            meshCenter.x /= meshArea;
+            meshCenter.y /= meshArea;
+            meshCenter.z /= meshArea;
+        }
+
+        // facing away from the center is outside, seen from most directions it's in front of the rest
+        for (Cluster & cluster : sorted)
+        {
+            Float3 & n = cluster.normal;
+            float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+            if (length > 0.f)
+            {
+                cluster.sortKey = ((cluster.center.x - meshCenter.x) * n.x + (cluster.center.y - meshCenter.y) * n.y +
+                    (cluster.center.z - meshCenter.z) * n.z) / length;
+            }
+        }
+
+        std::stable_sort(sorted.begin(), sorted.end(), [](Cluster const & a, Cluster const & b) { return a.sortKey > b.sortKey; });
+
+        std::vector<unsigned int> result;
+        result.reserve(indexCount);
+        for (Cluster const & cluster : sorted)
+            result.insert(result.end(), indices + cluster.first * 3, indices + cluster.last * 3);
+
+        // the clusters were measured starting empty, drawn after each other they can still lose more than threshold
+        unsigned int cacheMisses = countMisses(indices, triangleCount, timestamps, time);
+        if ((float)countMisses(result.data(), triangleCount, timestamps, time) > cacheMisses * threshold)
+            return;
+
+        memcpy(indices, result.data(), triangleCount * 3 * sizeof(unsigned int));
+    }
+
+    void optimizeVertexFetch(unsigned int * indices, size_t indexCount, size_t vertexCount, std::vector<unsigned int> & remap)
+    {
+        const unsigned int unused = ~0u;
+        remap.assign(vertexCount, unused);
+
+        unsigned int next = 0;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            unsigned int & vertex = remap[indices[i]];
+            if (vertex == unused)
+                vertex = next++;
+            indices[i] = vertex;
+        }
+
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            if (remap[i] == unused)
+                remap[i] = next++;
+        }
+    }
+
+    VertexCacheStats analyzeVertexCache(unsigned int const * indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+    {
+        VertexCacheStats stats = { 0.f, 0.f };
+        if (indexCount < 3)
+            return stats;
+
+        std::vector<unsigned int> cache;
+        std::vector<bool> used(vertexCount, false);
+        size_t misses = 0, usedCount = 0;
+
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            unsigned int vertex = indices[i];
+            if (!used[vertex])
+            {
+                used[vertex] = true;
+                usedCount++;
+            }
+
+            if (std::find(cache.begin(), cache.end(), vertex) == cache.end())
+            {
+                misses++;
+                // FIFO, a hit doesn't move it to the front
+                cache.insert(cache.begin(), vertex);
+                if (cache.size() > cacheSize)
+                    cache.pop_back();
+            }
+        }
+
+        stats.acmr = (float)misses / (indexCount / 3);
+        stats.atvr = (float)misses / usedCount;
+        return stats;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <stddef.h>
+
+#define INDEX_OVERDRAW_THRESHOLD 1.05f  // the overdraw ordering may make the vertex cache this much worse
+#define INDEX_CACHE_SIZE 16             // FIFO post-transform cache the ordering is measured against
+
+namespace Graphics
+{
+    // how well an index order uses the post-transform cache, lower is better
+    struct VertexCacheStats
+    {
+        float acmr;     // vertices transformed per triangle, 0.5 at best and 3 at worst
+        float atvr;     // vertices transformed per vertex used, 1 at best
+    };
+
+    /*
+        Reorders the triangles of an index list so the vertices the last
+        ones used are still in the post-transform cache, with Tom Forsyth's
+        "Linear-Speed Vertex Cache Optimisation". Every vertex gets a score
+        from where it is in a simulated cache and how many triangles still
+        use it, the triangle with the highest score is drawn next.
+
+        Works on one LOD range at a time, the triangles stay the same.
+    */
+    void optimizeVertexCache(unsigned int * indices, size_t indexCount, size_t vertexCount);
+
+    /*
+        Reorders clusters of triangles so the outward facing ones are drawn
+        first and hide what is behind them (Sander, Nehab and Barczak, "Fast
+        Triangle Reordering for Vertex Locality and Reduced Overdraw").
+        Clusters start where the cache order already starts over, and are
+        split further as long as that keeps the vertex cache within
+        threshold of what it was. Run after optimizeVertexCache.
+
+        positions are three floats every stride bytes.
+    */
+    void optimizeOverdraw(unsigned int * indices, size_t indexCount, const void * positions, size_t vertexCount, size_t stride, float threshold);
+
+    /*
+        Numbers the vertices in the order the indices first use them, so the
+        vertex buffer is read front to back. The indices are rewritten,
+        remap[old vertex] is where the vertex goes. Unused vertices go last.
+        Run after the index order is final, over every LOD together.
+    */
+    void optimizeVertexFetch(unsigned int * indices, size_t indexCount, size_t vertexCount, std::vector<unsigned int> & remap);
+
+    // simulates a FIFO cache of cacheSize vertices
+    VertexCacheStats analyzeVertexCache(unsigned int const * indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize);
+}
@@ -0,0 +1,194 @@
+#include "LZ4.h"
+#include <stdint.h>
+#include <string.h>
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_MAX_OFFSET 65535
+// the format wants the last match to start at least this far from the end,
+// and the last bytes to be literals
+#define LZ4_MATCH_LIMIT 12
+#define LZ4_LAST_LITERALS 5
+#define LZ4_HASH_BITS 12
+
+namespace Graphics
+{
+    namespace
+    {
+        uint32_t read32(const char * p)
+        {
+            uint32_t value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint32_t hash4(const char * p)
+        {
+            return (read32(p) * 2654435761u) >> (32 - LZ4_HASH_BITS);
+        }
+
+        // 15 in the token and the rest in 255s, false if it doesn't fit
+        bool writeLength(char *& out, char * end, size_t length)
+        {
+            for (; length >= 255; length -= 255)
+            {
+                if (out >= end)
+                    return false;
+                *out++ = (char)255;
+            }
+            if (out >= end)
+                return false;
+            *out++ = (char)length;
+            return true;
+        }
+
+        bool readLength(const unsigned char *& in, const unsigned char * end, size_t & length)
+        {
+            unsigned char byte;
+            do
+            {
+                if (in >= end)
+                    return false;
+                byte = *in++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+
+        bool writeSequence(char *& out, char * end, const char * literals, size_t literalCount, size_t matchLength, size_t offset)
+        {
+            if (out >= end)
+                return false;
+
+            char * token = out++;
+            size_t matchCode = matchLength >= LZ4_MIN_MATCH ? matchLength - LZ4_MIN_MATCH : 0;
+            *token = (char)(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+
+            if (literalCount >= 15 && !writeLength(out, end, literalCount - 15))
+                return false;
+            if ((size_t)(end - out) < literalCount)
+                return false;
+            memcpy(out, literals, literalCount);
+            out += literalCount;
+
+            // the last sequence has no match
+            if (matchLength == 0)
+                return true;
+
+            if (end - out < 2)
+                return false;
+            *out++ = (char)(offset & 0xFF);
+            *out++ = (char)(offset >> 8);
+
+            return matchCode < 15 || writeLength(out, end, matchCode - 15);
+        }
+    }
+
+    size_t LZ4::getMaxCompressedSize(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    size_t LZ4::compress(const char * source, size_t size, char * destination, size_t capacity)
+    {
+        char * out = destination;
+        char * outEnd = destination + capacity;
+        const char * anchor = source;
+
+        if (size > LZ4_MATCH_LIMIT)
+        {
+            // positions + 1, 0 is nothing there yet
+            uint32_t table[1 << LZ4_HASH_BITS] = {};
+            const char * matchEnd = source + size - LZ4_LAST_LITERALS;
+            const char * searchEnd = source + size - LZ4_MATCH_LIMIT;
+            const char * p = source;
+
+            while (p <= searchEnd)
+            {
+                uint32_t h = hash4(p);
+                const char * candidate = table[h] ? source + table[h] - 1 : nullptr;
+                table[h] = (uint32_t)(p - source) + 1;
+
+                if (!candidate || p - candidate > LZ4_MAX_OFFSET || read32(candidate) != read32(p))
+                {
+                    p++;
+                    continue;
+                }
+
+                // back over literals that match too
+                while (p > anchor && candidate > source && p[-1] == candidate[-1])
+                {
+                    p--;
+                    candidate--;
+                }
+
+                const char * end = p + LZ4_MIN_MATCH;
+                const char * from = candidate + LZ4_MIN_MATCH;
+                while (end < matchEnd && *end == *from)
+                {
+                    end++;
+                    from++;
+                }
+
+                if (!writeSequence(out, outEnd, anchor, p - anchor, end - p, p - candidate))
+                    return 0;
+
+                anchor = p = end;
+                if (p <= searchEnd)
+                    table[hash4(p - 2)] = (uint32_t)(p - 2 - source) + 1;
+            }
+        }
+
+        if (!writeSequence(out, outEnd, anchor, source + size - anchor, 0, 0))
+            return 0;
+
+        return out - destination;
+    }
+
+    bool LZ4::decompress(const char * source, size_t sourceSize, char * destination, size_t size)
+    {
+        const unsigned char * in = (const unsigned char *)source;
+        const unsigned char * inEnd = in + sourceSize;
+        char * out = destination;
+        char * outEnd = destination + size;
+
+        while (in < inEnd)
+        {
+            unsigned char token = *in++;
+
+            size_t literalCount = token >> 4;
+            if (literalCount == 15 && !readLength(in, inEnd, literalCount))
+                return false;
+            if ((size_t)(inEnd - in) < literalCount || (size_t)(outEnd - out) < literalCount)
+                return false;
+            memcpy(out, in, literalCount);
+            in += literalCount;
+            out += literalCount;
+
+            // the last sequence ends after its literals
+            if (in == inEnd)
+                break;
+
+            if (inEnd - in < 2)
+                return false;
+            size_t offset = in[0] | (in[1] << 8);
+            in += 2;
+            if (offset == 0 || offset > (size_t)(out - destination))
+                return false;
+
+            size_t matchLength = token & 15;
+            if (matchLength == 15 && !readLength(in, inEnd, matchLength))
+                return false;
+            matchLength += LZ4_MIN_MATCH;
+            if ((size_t)(outEnd - out) < matchLength)
+                return false;
+
+            // overlapping copies repeat the pattern, byte by byte on purpose
+            const char * from = out - offset;
+            for (size_t i = 0; i < matchLength; i++)
+                out[i] = from[i];
+            out += matchLength;
+        }
+
+        return out == outEnd;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stddef.h>
+
+namespace Graphics
+{
+    /*
+        LZ4 block format (no frame header), the same bytes the reference
+        LZ4_compress_default / LZ4_decompress_safe read and write. The
+        compressor is the simple greedy one, fast rather than small.
+
+        Pure CPU, no allocations.
+    */
+    class LZ4
+    {
+    public:
+        // the most compress can write for size bytes
+        static size_t getMaxCompressedSize(size_t size);
+
+        // 0 if it doesn't fit in capacity
+        static size_t compress(const char * source, size_t size, char * destination, size_t capacity);
+        // false on broken input or if it doesn't decompress to exactly size bytes
+        static bool decompress(const char * source, size_t sourceSize, char * destination, size_t size);
+    };
+}
@@ -15,9 +15,9 @@ namespace Graphics
 		delete textureManager;
 	}
 
-	void MaterialManager::initialize(ID3D11Device * gDevice, ID3D11DeviceContext* gDeviceContext)
+	void MaterialManager::initialize(RenderDevice * gDevice, AssetLoader* assetLoader)
 	{
-		textureManager->initilize(gDevice);
+		textureManager->initilize(gDevice, assetLoader);
 	}
 
 	void MaterialManager::release()
@@ -27,90 +27,46 @@ namespace Graphics
 
 	bool MaterialManager::compareMaterials(importedMaterial * import, unsigned int materialID)
 	{
-		if (import->materialName == materials->at(materialID).materialName)
-		{
-			if (materials->at(materialID).diffuse_ID == textureManager->findDiffuseID(import->diffuseTex))
-			{
-				if (materials->at(materialID).normal_ID == textureManager->findNormalID(import->normalTex))
-				{
-					if (materials->at(materialID).specular_ID == textureManager->findSpeularID(import->specularTex))
-					{
-						if (materials->at(materialID).glow_ID == textureManager->findGloowID(import->glowTex))
-						{
-							return true;
-						}
-					}
-				}
-			}
-		}
+		Material & material = materials->at(materialID);
 
-		return false;
+		return import->materialName == material.materialName &&
+			material.diffuse_ID == textureManager->findTexture(import->diffuseTex) &&
+			material.normal_ID == textureManager->findTexture(import->normalTex) &&
+			material.specular_ID == textureManager->findTexture(import->specularTex) &&
+			material.glow_ID == textureManager->findTexture(import->glowTex);
 	}
 
 	bool MaterialManager::compareImportMaterials(importedMaterial * import)
 	{
-		for (unsigned int i = 0; i < materials->size(); i++)
-		{
-			if (import->materialName == materials->at(i).materialName)
-			{
-				if (materials->at(i).diffuse_ID == textureManager->findDiffuseID(import->diffuseTex))
-				{
-					if (materials->at(i).normal_ID == textureManager->findNormalID(import->normalTex))
-					{
-						if (materials->at(i).specular_ID == textureManager->findSpeularID(import->specularTex))
-						{
-							if (materials->at(i).glow_ID == textureManager->findGloowID(import->glowTex))
-							{
-								return true;
-							}
-						}
-					}
-				}
-			}
-		}
-
-		return false;
+		return materialKeys.find(getMaterialKey(import->materialName,
+			textureManager->findTexture(import->diffuseTex),
+			textureManager->findTexture(import->normalTex),
+			textureManager->findTexture(import->specularTex),
+			textureManager->findTexture(import->glowTex))) != ResourceRegistry::INVALID_HANDLE;
 	}
 
 	void MaterialManager::addMaterials(vector<importedMaterial>* import)
 	{
+		materials->reserve(materials->size() + import->size());
+
 		for (unsigned int i = 0; i < import->size(); i++)
 		{
-			if (!compareImportMaterials(&import->at(i)))
-			{
-				Material tempMat;
-
-				tempMat.materialName = import->at(i).materialName;
-				tempMat.materialID = import->at(i).materialID;
+			Material tempMat;
 
-				tempMat.diffuseValue = import->at(i).diffuseValue;
-				tempMat.specularValue = import->at(i).specularValue;
+			tempMat.materialName = import->at(i).materialName;
+			tempMat.materialID = import->at(i).materialID;
 
-				tempMat.diffuse_ID = textureManager->getDiffuseID(import->at(i).diffuseTex);
-				tempMat.normal_ID = textureManager->getNormalID(import->at(i).normalTex);
-				tempMat.specular_ID = textureManager->getSpecularID(import->at(i).specularTex);
-				tempMat.glow_ID = textureManager->getGlowID(import->at(i).glowTex);
+			tempMat.diffuseValue = import->at(i).diffuseValue;
+			tempMat.specularValue = import->at(i).specularValue;
 
-				materials->push_back(tempMat);
-				materials->shrink_to_fit();
-			}
-			else
-			{
-				Material tempMat;
+			tempMat.diffuse_ID = textureManager->acquireTexture(import->at(i).diffuseTex);
+			tempMat.normal_ID = textureManager->acquireTexture(import->at(i).normalTex);
+			tempMat.specular_ID = textureManager->acquireTexture(import->at(i).specularTex);
+			tempMat.glow_ID = textureManager->acquireTexture(import->at(i).glowTex);
 
-				tempMat.materialName = import->at(i).materialName;
-				tempMat.materialID = import->at(i).materialID;
-
-				tempMat.diffuseValue = import->at(i).diffuseValue;
-				tempMat.specularValue = import->at(i).specularValue;
-
-				tempMat.diffuse_ID = textureManager->getDiffuseID(import->at(i).diffuseTex);
-				tempMat.normal_ID = textureManager->getNormalID(import->at(i).normalTex);
-				tempMat.specular_ID = textureManager->getSpecularID(import->at(i).specularTex);
-				tempMat.glow_ID = textureManager->getGlowID(import->at(i).glowTex);
-
-				materials->push_back(tempMat);
-			}
+			// duplicates are still added, the meshes index materials by the order they came in
+			materialKeys.acquire(getMaterialKey(tempMat.materialName, tempMat.diffuse_ID, tempMat.normal_ID, tempMat.specular_ID, tempMat.glow_ID));
+			materials->push_back(tempMat);
 		}
 	}
 
@@ -121,4 +77,13 @@ namespace Graphics
 		modelInfo.specularMap = textureManager->GetSpecularTexture(materials->at(iD).specular_ID);
 	}
 
+	string MaterialManager::getMaterialKey(string const & name, unsigned int diffuse, unsigned int normal, unsigned int specular, unsigned int glow)
+	{
+		// the handles are always the last 16 bytes, so two different materials can't make the same key
+		string key = name;
+		unsigned int handles[] = { diffuse, normal, specular, glow };
+		key.append((const char*)handles, sizeof(handles));
+		return key;
+	}
+
 }
\ No newline at end of file
@@ -1,8 +1,8 @@
 #pragma once
 #include <vector>
-#include <Graphics\include\Datatypes.h>
+#include <Graphics/include/Datatypes.h>
 #include "TextureManager.h"
-#include <Graphics\include\Structs.h>
+#include <Graphics/include/Structs.h>
 
 namespace Graphics
 {
@@ -11,7 +11,7 @@ namespace Graphics
 	public:
 		MaterialManager();
 		~MaterialManager();
-		void initialize(ID3D11Device* gDevice, ID3D11DeviceContext * gDeviceContext);
+		void initialize(RenderDevice* gDevice, AssetLoader* assetLoader);
 		void release();
 		void getMaterialInfo(ModelInfo & modelInfo, int iD);
 
@@ -22,10 +22,14 @@ namespace Graphics
 	private:
 		std::vector<Material>* materials;
 		TextureManager* textureManager;
+		// the name and texture handles of every material added, for compareImportMaterials
+		ResourceRegistry materialKeys;
+
+		static string getMaterialKey(string const & name, unsigned int diffuse, unsigned int normal, unsigned int specular, unsigned int glow);
 	
-		ID3D11ShaderResourceView*   diffuseMap = nullptr;
-		ID3D11ShaderResourceView*   normalMap = nullptr;
-		ID3D11ShaderResourceView*   specularMap = nullptr;
+		ShaderResourceView*   diffuseMap = nullptr;
+		ShaderResourceView*   normalMap = nullptr;
+		ShaderResourceView*   specularMap = nullptr;
 
 	};
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "Mesh.h"
+#include <vector>
+#include <string.h>
 
 
 namespace Graphics
@@ -21,10 +23,9 @@ namespace Graphics
 			delete[] vertices;
 	}
 
-	void Mesh::initialize(ID3D11Device * gDevice, ID3D11DeviceContext * gDeviceContext)
+	void Mesh::initialize(RenderDevice * gDevice)
 	{
 		this->gDevice = gDevice;
-		this->gDeviceContext = gDeviceContext;
 	}
 
 	void Mesh::Release()
@@ -50,23 +51,18 @@ namespace Graphics
 			}
 
 
-			D3D11_BUFFER_DESC bufferDesc;
-			memset(&bufferDesc, 0, sizeof(bufferDesc));
-			bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-			bufferDesc.Usage = D3D11_USAGE_DEFAULT;
-			bufferDesc.ByteWidth = sizeof(Vertex)* amount;
-
+			// the shader decodes them with the same box, from the ModelInfo
+			vector<CompressedVertex> compressed(amount);
+			static_assert(sizeof(Vertex) == sizeof(FloatVertex), "Vertex has the layout of FloatVertex");
+			compressVertices((FloatVertex const *)vertices, amount, &boundsMin.x, &boundsMax.x, compressed.data());
 
-			D3D11_SUBRESOURCE_DATA data;
-
-			data.pSysMem = vertices;
-			HRESULT hr;
-			hr = gDevice->CreateBuffer(&bufferDesc, &data, &vertexBuffer);
+			BufferDesc bufferDesc;
+			memset(&bufferDesc, 0, sizeof(bufferDesc));
+			bufferDesc.bindFlags = BIND_VERTEX_BUFFER;
+			bufferDesc.usage = USAGE_DEFAULT;
+			bufferDesc.byteWidth = sizeof(CompressedVertex)* amount;
 
-			if (FAILED(hr))
-			{
-				//MessageBox(NULL, L"Error creating vertexbuffer", L"Error in mesh class", MB_ICONERROR | MB_OK);
-			}
+			vertexBuffer = gDevice->CreateBuffer(bufferDesc, compressed.data());
 
 			this->vertCount = amount;
 			this->isScene = isScene;
@@ -91,27 +87,38 @@ namespace Graphics
 			this->sceneIndex = indices;
 			this->indexCount = (UINT)amount;
 			this->isScene = isScene;
+			this->lods[0] = { 0, (UINT)amount, 0.f };
+			this->lodCount = 1;
 
-			D3D11_BUFFER_DESC ibd;
-
-			ibd.Usage = D3D11_USAGE_IMMUTABLE;
-			ibd.ByteWidth = sizeof(UINT) * amount;
-			ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-			ibd.CPUAccessFlags = 0;
-			ibd.MiscFlags = 0;
-			ibd.StructureByteStride = 0;
+			// half the memory and bandwidth when every vertex fits in 16 bits
+			vector<uint16_t> shortIndices;
+			if (this->vertCount <= 0x10000)
+			{
+				shortIndices.assign(indices, indices + amount);
+				this->indexFormat = FORMAT_R16_UINT;
+			}
+			else
+			{
+				this->indexFormat = FORMAT_R32_UINT;
+			}
 
-			D3D11_SUBRESOURCE_DATA ibdData;
-			ibdData.pSysMem = indices;
+			BufferDesc ibd = {};
 
-			HRESULT hr;
-			hr = gDevice->CreateBuffer(&ibd, &ibdData, &indexBuffer);
+			ibd.usage = USAGE_IMMUTABLE;
+			ibd.byteWidth = (UINT)((this->indexFormat == FORMAT_R16_UINT ? sizeof(uint16_t) : sizeof(UINT)) * amount);
+			ibd.bindFlags = BIND_INDEX_BUFFER;
 
-			if (FAILED(hr))
-				//MessageBox(NULL, L"Error creating indexbuffer", L"Error in mesh class", MB_ICONERROR | MB_OK);
+			indexBuffer = gDevice->CreateBuffer(ibd, this->indexFormat == FORMAT_R16_UINT ? (const void *)shortIndices.data() : (const void *)indices);
 
-				this->indexCount = (UINT)amount;
+			this->indexCount = (UINT)amount;
 			this->isScene = isScene;
 		}
 	}
+
+	void Mesh::SetLods(const MeshLod * lods, int lodCount)
+	{
+		for (int i = 0; i < lodCount && i < MESH_LOD_COUNT; i++)
+			this->lods[i] = lods[i];
+		this->lodCount = lodCount < MESH_LOD_COUNT ? lodCount : MESH_LOD_COUNT;
+	}
 }
\ No newline at end of file
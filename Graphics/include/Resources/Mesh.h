@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../Datatypes.h"
-#include <Engine\Constants.h>
+#include "MeshLod.h"
+#include "VertexCompression.h"
+#include <Engine/Constants.h>
 namespace Graphics
 {
 	class Mesh
@@ -14,12 +16,26 @@ namespace Graphics
 		Mesh();
 		~Mesh();
 
-		void initialize(ID3D11Device *gDevice, ID3D11DeviceContext* gDeviceContext);
+		void initialize(RenderDevice *gDevice);
 		void Release();
 
 		unsigned int GetVertexCount() { return this->vertCount; };
 		UINT GetIndexCount() { return this->indexCount; };
 
+		// the index buffer has every LOD after each other, lods[0] is the full mesh
+		const MeshLod* GetLods() { return this->lods; };
+		int GetLodCount() { return this->lodCount; };
+		void SetLods(const MeshLod* lods, int lodCount);
+
+		// bounding sphere in mesh space
+		Float3 GetBoundsCenter() { return this->boundsCenter; };
+		float GetBoundsRadius() { return this->boundsRadius; };
+		void SetBounds(Float3 center, float radius) { this->boundsCenter = center; this->boundsRadius = radius; };
+		// bounding box in mesh space
+		Float3 GetBoundsMin() { return this->boundsMin; };
+		Float3 GetBoundsMax() { return this->boundsMax; };
+		void SetBoundingBox(Float3 low, Float3 high) { this->boundsMin = low; this->boundsMax = high; };
+
 		int GetMaterialID() { return this->materialID; }
 		void SetMaterialID(int id) { this->materialID = id; }
 
@@ -29,12 +45,15 @@ namespace Graphics
 		UINT* GetIndices() { return this->sceneIndex; };
 
 
+		// compressed within the bounding box, set it first
 		void CreateVertexBuffer(Vertex* vertices, unsigned int amount, bool isScene);
 
+		// 16 bit on the GPU when the vertices allow it, create the vertex buffer first
 		void CreateIndexBuffer(UINT* indices, unsigned int amount, bool isScene);
 
-		ID3D11Buffer* getVertexBuffer() { return vertexBuffer; };
-		ID3D11Buffer* getIndexBuffer() { return indexBuffer; };
+		GpuBuffer* getVertexBuffer() { return vertexBuffer; };
+		GpuBuffer* getIndexBuffer() { return indexBuffer; };
+		Format getIndexFormat() { return indexFormat; };
 
 	private:
 		bool	        hasSkeleton = false;
@@ -46,10 +65,17 @@ namespace Graphics
 		bool	        isBlendShape = false;
 
 
-		ID3D11Buffer*   vertexBuffer = nullptr;
-		ID3D11Buffer*   indexBuffer = nullptr;
+		GpuBuffer*      vertexBuffer = nullptr;
+		GpuBuffer*      indexBuffer = nullptr;
+		Format			indexFormat = FORMAT_R32_UINT;
 		unsigned int    vertCount = 0;
 		UINT			indexCount = 0;
+		MeshLod			lods[MESH_LOD_COUNT] = {};
+		int				lodCount = 1;
+		Float3			boundsCenter = Float3(0, 0, 0);
+		float			boundsRadius = 0;
+		Float3			boundsMin = Float3(0, 0, 0);
+		Float3			boundsMax = Float3(0, 0, 0);
 
 		unsigned int  skeletonID = 0;
 		int  materialID = 0;
@@ -58,7 +84,6 @@ namespace Graphics
 		UINT* sceneIndex = nullptr;
 		bool isScene = false;
 
-		ID3D11DeviceContext* gDeviceContext; //a pointer to the device. (not sure if it will be needed her in the end)
-		ID3D11Device *gDevice;
+		RenderDevice *gDevice = nullptr;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "MeshLod.h"
+#include "MeshSimplifier.h"
+
+namespace Graphics
+{
+    int buildMeshLods(const void * positions, size_t vertexCount, size_t stride, std::vector<unsigned int> const & indices,
+        std::vector<unsigned int> & allIndices, MeshLod lods[MESH_LOD_COUNT])
+    {
+        allIndices = indices;
+        lods[0] = { 0, (unsigned int)indices.size(), 0.f };
+        int lodCount = 1;
+
+        MeshSimplifier simplifier(positions, vertexCount, stride, indices);
+        float maxError = simplifier.getExtent() * MESH_LOD_MAX_ERROR;
+
+        for (int level = 1; level < MESH_LOD_COUNT; level++)
+        {
+            size_t target = (indices.size() >> level) / 3 * 3;
+            std::vector<unsigned int> lod = simplifier.simplify(target, maxError);
+
+            // locked outlines or the error limit stopped it, not worth the memory
+            if (lod.empty() || lod.size() > lods[lodCount - 1].indexCount * MESH_LOD_MIN_REDUCTION)
+                break;
+
+            lods[lodCount++] = { (unsigned int)allIndices.size(), (unsigned int)lod.size(), simplifier.getError() };
+            allIndices.insert(allIndices.end(), lod.begin(), lod.end());
+        }
+
+        return lodCount;
+    }
+
+    int selectMeshLod(MeshLod const * lods, int lodCount, float pixelsPerUnit, int currentLod)
+    {
+        for (int lod = lodCount - 1; lod > 0; lod--)
+        {
+            float threshold = lod > currentLod ? MESH_LOD_PIXEL_ERROR * MESH_LOD_HYSTERESIS : MESH_LOD_PIXEL_ERROR;
+            if (lods[lod].error * pixelsPerUnit <= threshold)
+                return lod;
+        }
+
+        return 0;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <stddef.h>
+
+#define MESH_LOD_COUNT 4
+#define MESH_LOD_MAX_ERROR 0.05f        // of the mesh size, coarser than that looks like another mesh
+#define MESH_LOD_MIN_REDUCTION 0.85f    // a LOD has to drop at least 15% of the indices to be kept
+#define MESH_LOD_PIXEL_ERROR 1.f        // how far a LOD may move the surface on screen
+#define MESH_LOD_HYSTERESIS 0.75f       // switching to a coarser LOD needs error below this part of the threshold
+
+namespace Graphics
+{
+    // index range in the index buffer of the mesh, every LOD uses the same vertices
+    struct MeshLod
+    {
+        unsigned int startIndex;
+        unsigned int indexCount;
+        float error;                    // in mesh units, 0 for the full mesh
+    };
+
+    /*
+        Builds up to MESH_LOD_COUNT LODs with half, a quarter and an eighth of
+        the triangles. LOD 0 is the mesh itself. allIndices gets every LOD
+        after each other, that is what goes in the index buffer.
+        Returns how many LODs there are (at least 1).
+    */
+    int buildMeshLods(const void * positions, size_t vertexCount, size_t stride, std::vector<unsigned int> const & indices,
+        std::vector<unsigned int> & allIndices, MeshLod lods[MESH_LOD_COUNT]);
+
+    /*
+        The coarsest LOD whose error covers at most MESH_LOD_PIXEL_ERROR pixels.
+        pixelsPerUnit is how many pixels one mesh unit is at the distance of
+        the instance. currentLod is what was used last frame, going coarser
+        needs a margin so an instance standing on the edge doesn't flicker.
+    */
+    int selectMeshLod(MeshLod const * lods, int lodCount, float pixelsPerUnit, int currentLod);
+}
@@ -1,4 +1,5 @@
 #include "MeshManager.h"
+#include <math.h>
 
 namespace Graphics
 {
@@ -11,10 +12,9 @@ namespace Graphics
 	{
 	}
 
-	void MeshManager::initialize(ID3D11Device * gDevice, ID3D11DeviceContext * gDeviceContext)
+	void MeshManager::initialize(RenderDevice * gDevice)
 	{
 		this->gDevice = gDevice;
-		this->gDeviceContext = gDeviceContext;
 
 	}
 
@@ -30,7 +30,7 @@ namespace Graphics
 		}
 	}
 
-	void MeshManager::addMesh(int id, bool hasSkeleton, unsigned int skeletonID, int materialID, unsigned int vertexCount, UINT indexCount, vector<Vertex> vertices, vector<UINT> indices, bool isScene)
+	void MeshManager::addMesh(int id, bool hasSkeleton, unsigned int skeletonID, int materialID, unsigned int vertexCount, UINT indexCount, vector<Vertex> vertices, vector<UINT> indices, const MeshLod * lods, int lodCount, bool isScene)
 	{
 		Vertex* newVertices = new Vertex[vertexCount];
 		for (unsigned int i = 0; i < vertexCount; i++)
@@ -44,13 +44,42 @@ namespace Graphics
 			newIndices[i] = indices[i];
 		}
 		Mesh newMesh = Mesh(hasSkeleton, skeletonID, materialID);
-		newMesh.initialize(this->gDevice, this->gDeviceContext);
-		newMesh.CreateVertexBuffer(newVertices, vertexCount, isScene);
-		newMesh.CreateIndexBuffer(newIndices, indexCount, isScene);
+		newMesh.initialize(this->gDevice);
+
+		// the box is used by the occlusion culling and to compress the vertices, the sphere around its center to cull shadow casters
+		if (vertexCount > 0)
+		{
+			Float3 low = newVertices[0].position, high = newVertices[0].position;
+			for (unsigned int i = 1; i < vertexCount; i++)
+			{
+				Float3 const & position = newVertices[i].position;
+				low = Float3(fminf(low.x, position.x), fminf(low.y, position.y), fminf(low.z, position.z));
+				high = Float3(fmaxf(high.x, position.x), fmaxf(high.y, position.y), fmaxf(high.z, position.z));
+			}
+
+			Float3 center((low.x + high.x) * 0.5f, (low.y + high.y) * 0.5f, (low.z + high.z) * 0.5f);
+			float radius = 0;
+			for (unsigned int i = 0; i < vertexCount; i++)
+			{
+				Float3 const & position = newVertices[i].position;
+				float dx = position.x - center.x, dy = position.y - center.y, dz = position.z - center.z;
+				radius = fmaxf(radius, dx * dx + dy * dy + dz * dz);
+			}
+			newMesh.SetBounds(center, sqrtf(radius));
+			newMesh.SetBoundingBox(low, high);
+		}
 		if (isScene == true)
+		{
+			newMesh.CreateVertexBuffer(newVertices, vertexCount, isScene);
+			newMesh.CreateIndexBuffer(newIndices, lodCount > 0 ? lods[0].indexCount : indexCount, isScene);
 			this->sceneMeshes.push_back(newMesh);
+		}
 		else
 		{
+			// the LODs and the order were made when the file was decoded
+			newMesh.CreateVertexBuffer(newVertices, vertexCount, isScene);
+			newMesh.CreateIndexBuffer(newIndices, indexCount, isScene);
+			newMesh.SetLods(lods, lodCount);
 			meshes.push_back(newMesh);
 			this->gameMeshes.insert_or_assign(id, &meshes[meshes.size() - 1]);
 			delete[] newVertices;
@@ -1,7 +1,7 @@
 #pragma once
 #include <vector>
 #include <map>
-#include <Graphics\include\Datatypes.h>
+#include <Graphics/include/Datatypes.h>
 #include "Mesh.h"
 namespace Graphics
 {
@@ -12,7 +12,7 @@ namespace Graphics
 	public:
 		MeshManager();
 		~MeshManager();
-		void initialize(ID3D11Device* gDevice, ID3D11DeviceContext* gDeviceContext);
+		void initialize(RenderDevice* gDevice);
 		void release();
 
 		void addMesh(
@@ -23,7 +23,9 @@ namespace Graphics
 			unsigned int vertexCount,
 			UINT indexCount,
 			vector<Vertex> vertices,
-			vector<UINT> indices,
+			vector<UINT> indices,		// every LOD after each other, the scenes only use LOD 0
+			const MeshLod * lods,
+			int lodCount,
 			bool isScene
 		);
 
@@ -31,8 +33,7 @@ namespace Graphics
 		vector<Mesh>* getMeshes() { return &meshes; }
 
 	private:
-		ID3D11Device *gDevice = nullptr;
-		ID3D11DeviceContext *gDeviceContext = nullptr;
+		RenderDevice *gDevice = nullptr;
 
 		map<int,Mesh*> gameMeshes;
 		vector<Mesh> meshes;
@@ -0,0 +1,338 @@
+#include "MeshSimplifier.h"
+#include <unordered_map>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+namespace Graphics
+{
+    namespace
+    {
+        struct PositionKey
+        {
+            float x, y, z;
+            bool operator==(PositionKey const & other) const
+            {
+                return x == other.x && y == other.y && z == other.z;
+            }
+        };
+
+        struct PositionHash
+        {
+            size_t operator()(PositionKey const & key) const
+            {
+                uint32_t bits[3];
+                memcpy(bits, &key, sizeof(bits));
+                return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+            }
+        };
+
+        uint64_t edgeKey(unsigned int a, unsigned int b)
+        {
+            return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+        }
+
+        void cross(const float * a, const float * b, const float * c, double * normal)
+        {
+            double e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            double e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            normal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+            normal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+            normal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+        }
+    }
+
+    void MeshSimplifier::Quadric::add(Quadric const & other)
+    {
+        a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+        b2 += other.b2; bc += other.bc; bd += other.bd;
+        c2 += other.c2; cd += other.cd;
+        d2 += other.d2;
+        weight += other.weight;
+    }
+
+    double MeshSimplifier::Quadric::evaluate(const float * p) const
+    {
+        double x = p[0], y = p[1], z = p[2];
+        double result =
+            a2 * x * x + b2 * y * y + c2 * z * z +
+            2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+            2.0 * (ad * x + bd * y + cd * z) +
+            d2;
+
+        // squared distance to the planes, averaged by area
+        return weight > 0.0 && result > 0.0 ? result / weight : 0.0;
+    }
+
+    MeshSimplifier::MeshSimplifier(const void * positions, size_t vertexCount, size_t stride, std::vector<unsigned int> const & indices)
+    {
+        error = 0.f;
+        extent = 0.f;
+
+        // weld the vertices sharing a position
+        std::unordered_map<PositionKey, unsigned int, PositionHash> welded;
+        welded.reserve(vertexCount);
+        weld.resize(vertexCount);
+
+        float low[3] = { INFINITY, INFINITY, INFINITY }, high[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const float * p = reinterpret_cast<const float *>(static_cast<const char *>(positions) + i * stride);
+            auto result = welded.insert({ { p[0], p[1], p[2] }, (unsigned int)(this->positions.size() / 3) });
+            if (result.second)
+            {
+                this->positions.insert(this->positions.end(), p, p + 3);
+                firstVertex.push_back((unsigned int)i);
+            }
+            weld[i] = result.first->second;
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                low[axis] = std::min(low[axis], p[axis]);
+                high[axis] = std::max(high[axis], p[axis]);
+            }
+        }
+
+        if (vertexCount > 0)
+            extent = std::max(high[0] - low[0], std::max(high[1] - low[1], high[2] - low[2]));
+
+        size_t weldedCount = firstVertex.size();
+        quadrics.assign(weldedCount, {});
+        locked.assign(weldedCount, false);
+
+        // the plane of every triangle goes to its corners, weighted by the area
+        std::unordered_map<uint64_t, int> edgeUses;
+        triangles.reserve(indices.size() / 3);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            Triangle triangle;
+            for (int c = 0; c < 3; c++)
+            {
+                triangle.corner[c] = indices[i + c];
+                triangle.vertex[c] = weld[indices[i + c]];
+            }
+
+            // already degenerate, nothing to keep
+            if (triangle.vertex[0] == triangle.vertex[1] ||
+                triangle.vertex[1] == triangle.vertex[2] ||
+                triangle.vertex[2] == triangle.vertex[0])
+                continue;
+
+            triangle.alive = true;
+            triangles.push_back(triangle);
+
+            const float * p0 = &this->positions[triangle.vertex[0] * 3];
+            double normal[3];
+            cross(p0, &this->positions[triangle.vertex[1] * 3], &this->positions[triangle.vertex[2] * 3], normal);
+
+            double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length > 0.0)
+            {
+                double area = length * 0.5;
+                double a = normal[0] / length, b = normal[1] / length, c = normal[2] / length;
+                double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+
+                Quadric plane = {
+                    a * a * area, a * b * area, a * c * area, a * d * area,
+                    b * b * area, b * c * area, b * d * area,
+                    c * c * area, c * d * area,
+                    d * d * area,
+                    area
+                };
+
+                for (int c = 0; c < 3; c++)
+                    quadrics[triangle.vertex[c]].add(plane);
+            }
+
+            for (int c = 0; c < 3; c++)
+                edgeUses[edgeKey(triangle.vertex[c], triangle.vertex[(c + 1) % 3])]++;
+        }
+
+        aliveTriangles = triangles.size();
+
+        // open edges are the outline, collapsing them would eat holes in it
+        for (auto const & edge : edgeUses)
+        {
+            if (edge.second == 1)
+            {
+                locked[(unsigned int)(edge.first >> 32)] = true;
+                locked[(unsigned int)(edge.first & 0xffffffff)] = true;
+            }
+        }
+    }
+
+    MeshSimplifier::~MeshSimplifier()
+    {
+    }
+
+    bool MeshSimplifier::flips(unsigned int from, unsigned int to, std::vector<unsigned int> const & around) const
+    {
+        const float * target = &positions[to * 3];
+
+        for (unsigned int t : around)
+        {
+            Triangle const & triangle = triangles[t];
+            if (!triangle.alive)
+                continue;
+
+            if (triangle.vertex[0] == to || triangle.vertex[1] == to || triangle.vertex[2] == to)
+                continue;
+
+            const float * before[3], * after[3];
+            for (int c = 0; c < 3; c++)
+            {
+                before[c] = &positions[triangle.vertex[c] * 3];
+                after[c] = triangle.vertex[c] == from ? target : before[c];
+            }
+
+            double n0[3], n1[3];
+            cross(before[0], before[1], before[2], n0);
+            cross(after[0], after[1], after[2], n1);
+
+            double dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+            if (dot <= 0.0)
+                return true;
+        }
+
+        return false;
+    }
+
+    std::vector<unsigned int> MeshSimplifier::simplify(size_t targetIndexCount, float maxError)
+    {
+        size_t targetTriangles = targetIndexCount / 3;
+        double maxCost = (double)maxError * maxError;
+
+        std::vector<std::vector<unsigned int>> around(firstVertex.size());
+        std::vector<Collapse> collapses;
+        std::vector<bool> touched(firstVertex.size());
+
+        while (aliveTriangles > targetTriangles)
+        {
+            for (auto & list : around)
+                list.clear();
+
+            for (unsigned int t = 0; t < triangles.size(); t++)
+            {
+                if (triangles[t].alive)
+                    for (int c = 0; c < 3; c++)
+                        around[triangles[t].vertex[c]].push_back(t);
+            }
+
+            // the cheapest direction of every edge, the same edge is seen from both triangles
+            collapses.clear();
+            for (Triangle const & triangle : triangles)
+            {
+                if (!triangle.alive)
+                    continue;
+
+                for (int c = 0; c < 3; c++)
+                {
+                    unsigned int a = triangle.vertex[c], b = triangle.vertex[(c + 1) % 3];
+                    if (a > b)
+                        continue;
+
+                    Quadric sum = quadrics[a];
+                    sum.add(quadrics[b]);
+
+                    Collapse best = { 0, 0, INFINITY };
+                    if (!locked[a])
+                        best = { a, b, sum.evaluate(&positions[b * 3]) };
+                    if (!locked[b])
+                    {
+                        double cost = sum.evaluate(&positions[a * 3]);
+                        if (cost < best.cost)
+                            best = { b, a, cost };
+                    }
+
+                    if (best.cost <= maxCost)
+                        collapses.push_back(best);
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](Collapse const & a, Collapse const & b) {
+                return a.cost < b.cost;
+            });
+
+            // a vertex next to a collapse has stale neighbours, it waits for the next round
+            std::fill(touched.begin(), touched.end(), false);
+            size_t collapsedThisRound = 0;
+            for (Collapse const & collapse : collapses)
+            {
+                if (aliveTriangles <= targetTriangles)
+                    break;
+
+                if (touched[collapse.from] || touched[collapse.to])
+                    continue;
+
+                if (flips(collapse.from, collapse.to, around[collapse.from]))
+                    continue;
+
+                quadrics[collapse.to].add(quadrics[collapse.from]);
+                error = std::max(error, (float)sqrt(collapse.cost));
+
+                for (unsigned int t : around[collapse.from])
+                {
+                    Triangle & triangle = triangles[t];
+                    if (!triangle.alive)
+                        continue;
+
+                    bool degenerate = false;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        touched[triangle.vertex[c]] = true;
+                        if (triangle.vertex[c] == collapse.to)
+                            degenerate = true;
+                    }
+
+                    if (degenerate)
+                    {
+                        triangle.alive = false;
+                        aliveTriangles--;
+                    }
+                    else
+                    {
+                        for (int c = 0; c < 3; c++)
+                            if (triangle.vertex[c] == collapse.from)
+                                triangle.vertex[c] = collapse.to;
+                    }
+                }
+                for (unsigned int t : around[collapse.to])
+                    for (int c = 0; c < 3; c++)
+                        touched[triangles[t].vertex[c]] = true;
+
+                collapsedThisRound++;
+            }
+
+            if (collapsedThisRound == 0)
+                break;
+        }
+
+        // corners that didn't move keep their own vertex (and uv), moved ones take the one they collapsed into
+        std::vector<unsigned int> result;
+        result.reserve(aliveTriangles * 3);
+        for (Triangle const & triangle : triangles)
+        {
+            if (!triangle.alive)
+                continue;
+
+            for (int c = 0; c < 3; c++)
+            {
+                unsigned int original = triangle.corner[c];
+                result.push_back(weld[original] == triangle.vertex[c] ? original : firstVertex[triangle.vertex[c]]);
+            }
+        }
+
+        return result;
+    }
+
+    float MeshSimplifier::getError() const
+    {
+        return error;
+    }
+
+    float MeshSimplifier::getExtent() const
+    {
+        return extent;
+    }
+}
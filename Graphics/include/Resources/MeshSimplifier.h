@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <stddef.h>
+
+namespace Graphics
+{
+    /*
+        Quadric error metric simplification (Garland & Heckbert), with half
+        edge collapses so every vertex that is left is one of the original
+        ones. The simplified index lists can use the vertex buffer of the
+        full mesh.
+
+        Vertices with the same position are welded before simplifying, so
+        uv seams don't stop collapses. Vertices on an open edge are locked,
+        the outline of a mesh never moves.
+
+        Every simplify() continues from where the last one stopped, call it
+        with smaller and smaller targets to get a LOD chain.
+
+        Pure CPU, no D3D.
+    */
+    class MeshSimplifier
+    {
+    public:
+        // positions are three floats every stride bytes
+        MeshSimplifier(const void * positions, size_t vertexCount, size_t stride, std::vector<unsigned int> const & indices);
+        ~MeshSimplifier();
+
+        // Collapses until there are targetIndexCount indices or less, or the next collapse
+        // would move the surface more than maxError. Returns the indices of what is left
+        std::vector<unsigned int> simplify(size_t targetIndexCount, float maxError);
+
+        // largest distance any collapse so far moved the surface, in mesh units
+        float getError() const;
+        // longest side of the bounding box
+        float getExtent() const;
+    private:
+        struct Quadric
+        {
+            double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+            double weight;
+
+            void add(Quadric const & other);
+            double evaluate(const float * p) const;
+        };
+
+        struct Triangle
+        {
+            unsigned int corner[3];     // original vertices
+            unsigned int vertex[3];     // welded vertices
+            bool alive;
+        };
+
+        struct Collapse
+        {
+            unsigned int from, to;
+            double cost;
+        };
+
+        std::vector<float> positions;           // xyz for every welded vertex
+        std::vector<unsigned int> weld;         // original -> welded
+        std::vector<unsigned int> firstVertex;  // welded -> first original vertex with that position
+        std::vector<Quadric> quadrics;
+        std::vector<bool> locked;
+        std::vector<Triangle> triangles;
+        size_t aliveTriangles;
+        float error;
+        float extent;
+
+        bool flips(unsigned int from, unsigned int to, std::vector<unsigned int> const & around) const;
+    };
+}
@@ -1,5 +1,5 @@
 #include "ResourceManager.h"
-#include <Engine\Constants.h>
+#include <Engine/Constants.h>
 
 namespace Graphics
 {
@@ -13,28 +13,82 @@ namespace Graphics
 		
     }
 
-	void ResourceManager::initialize(ID3D11Device * gDevice, ID3D11DeviceContext * gDeviceContext)
+	void ResourceManager::initialize(RenderDevice * gDevice)
 	{
-		meshManager.initialize(gDevice, gDeviceContext);
-		materialManager.initialize(gDevice, gDeviceContext);
+		meshManager.initialize(gDevice);
+		materialManager.initialize(gDevice, &assetLoader);
 		brfImporterHandler.initialize(meshManager, materialManager);
 
-		brfImporterHandler.loadFile(CUBE, MODEL_PATH_STR("kubfixadtextur.brf"), true, true, false, false);
-		brfImporterHandler.loadFile(SPHERE, MODEL_PATH_STR("sphere.brf"), true, true, false, false);
-        brfImporterHandler.loadFile(CROSSBOW, MODEL_PATH_STR("CrossBow.brf"), true, true, false, false);
-		brfImporterHandler.loadFile(AMMOBOX, MODEL_PATH_STR("ammoBox.brf"), true, true, false, false);
-		brfImporterHandler.loadFile(CUTTLERY, MODEL_PATH_STR("cuttlery.brf"), true, true, false, false);
-		brfImporterHandler.loadFile(JUMPPAD, MODEL_PATH_STR("jumpPad.brf"), true, true, false, false);
-		brfImporterHandler.loadFile(ENEMYGRUNT, MODEL_PATH_STR("enemyGrunt.brf"), true, true, false, false);
-		brfImporterHandler.loadFile(GRAPPLEPOINT, MODEL_PATH_STR("grapplePoint.brf"), true, true, false, false);
-		brfImporterHandler.loadFile(GRASS, MODEL_PATH_STR("grass.brf"), true, true, false, false);
-		brfImporterHandler.loadFile(BUSH, MODEL_PATH_STR("bushgreen.brf"), true, true, false, false);
+		// The importer opens the files itself. Models are added in the order they are
+		// requested, the mesh and material ids are the ModelID
+		assetLoader.setType(ASSET_MODEL,
+			[](AssetLoader::Asset & asset)
+			{
+				std::shared_ptr<BRFImportHandler::Model> model = std::make_shared<BRFImportHandler::Model>();
+				if (!BRFImportHandler::decodeFile(asset.path, true, true, false, *model))
+					return false;
+
+				asset.decoded = model;
+				return true;
+			},
+			[this](AssetLoader::Asset & asset)
+			{
+				brfImporterHandler.addModel(asset.id, *(BRFImportHandler::Model*)asset.decoded.get(), false);
+				modelsReady[asset.id] = true;
+				return true;
+			},
+			true, false);
+
+		// the map is made of cubes
+		loadModel(CUBE, MODEL_PATH_STR("kubfixadtextur.brf"), AssetLoader::PRIORITY_HIGH);
+		loadModel(SPHERE, MODEL_PATH_STR("sphere.brf"));
+		loadModel(CROSSBOW, MODEL_PATH_STR("CrossBow.brf"));
+		loadModel(AMMOBOX, MODEL_PATH_STR("ammoBox.brf"));
+		loadModel(CUTTLERY, MODEL_PATH_STR("cuttlery.brf"));
+		loadModel(JUMPPAD, MODEL_PATH_STR("jumpPad.brf"));
+		loadModel(ENEMYGRUNT, MODEL_PATH_STR("enemyGrunt.brf"));
+		loadModel(GRAPPLEPOINT, MODEL_PATH_STR("grapplePoint.brf"));
+		loadModel(GRASS, MODEL_PATH_STR("grass.brf"));
+		loadModel(BUSH, MODEL_PATH_STR("bushgreen.brf"));
 
 
 
 		//brfImporterHandler.loadFile(MODEL_PATH_STR("kub2.brf"), true, true, false, false);
     }
 
+	void ResourceManager::loadModel(ModelID modelID, std::string fileName, AssetLoader::Priority priority)
+	{
+		if ((size_t)modelID >= modelsReady.size())
+			modelsReady.resize(modelID + 1, false);
+
+		assetLoader.load(ASSET_MODEL, fileName, priority, modelID);
+	}
+
+	void ResourceManager::update(uint32_t maxUploads)
+	{
+		assetLoader.update(maxUploads);
+	}
+
+	void ResourceManager::finishLoading()
+	{
+		assetLoader.finish();
+	}
+
+	void ResourceManager::setProgressCallback(AssetLoader::ProgressCallback callback)
+	{
+		assetLoader.setProgressCallback(callback);
+	}
+
+	uint32_t ResourceManager::getLoadingCount() const
+	{
+		return assetLoader.getRequestedCount() - assetLoader.getFinishedCount();
+	}
+
+	bool ResourceManager::isModelReady(ModelID modelID) const
+	{
+		return (size_t)modelID < modelsReady.size() && modelsReady[modelID];
+	}
+
     ModelInfo ResourceManager::getModelInfo(ModelID modelID)
     {
         Mesh * mesh = &meshManager.getMeshes()->at(modelID);
@@ -42,13 +96,22 @@ namespace Graphics
 
 		ModelInfo info = {
 
-			mesh->GetIndexCount(),
+			mesh->GetLods()[0].indexCount,
 			mesh->getIndexBuffer(),
 			mesh->getVertexBuffer()
 
         };
 
 		materialManager.getMaterialInfo(info, modelID);
+		info.lods = mesh->GetLods();
+		info.lodCount = mesh->GetLodCount();
+		Float3 center = mesh->GetBoundsCenter();
+		info.boundsCenter = DirectX::SimpleMath::Vector3(center.x, center.y, center.z);
+		info.boundsRadius = mesh->GetBoundsRadius();
+		Float3 low = mesh->GetBoundsMin(), high = mesh->GetBoundsMax();
+		info.boundsMin = DirectX::SimpleMath::Vector3(low.x, low.y, low.z);
+		info.boundsMax = DirectX::SimpleMath::Vector3(high.x, high.y, high.z);
+		info.indexFormat = mesh->getIndexFormat();
 		
 
         return info;
@@ -3,7 +3,8 @@
 #include "MeshManager.h"
 #include "BRFImportHandler.h"
 #include "MaterialManager.h"
-#include <Graphics\include\Structs.h>
+#include "AssetLoader.h"
+#include <Graphics/include/Structs.h>
 
 namespace Graphics
 {
@@ -43,17 +44,33 @@ namespace Graphics
 		ResourceManager();
 		~ResourceManager();
 
-	void initialize(ID3D11Device *gDevice, ID3D11DeviceContext* gDeviceContext);
+	// Starts loading the models and their textures, nothing is ready when it returns
+	void initialize(RenderDevice *gDevice);
 	void release();
 
+	// Creates what finished loading, on the thread that owns the device context
+	void update(uint32_t maxUploads);
+	// Blocks until everything is loaded
+	void finishLoading();
+	// Called from update with how many assets are done, for the menu
+	void setProgressCallback(AssetLoader::ProgressCallback callback);
+	uint32_t getLoadingCount() const;
+
+	// Models are skipped by the renderer until they are ready, textures get placeholders
+	bool isModelReady(ModelID modelID) const;
     ModelInfo getModelInfo(ModelID modelID);
 
 
 	private:
+		AssetLoader assetLoader;
+		std::vector<bool> modelsReady;
+
 		MeshManager meshManager;
 		BRFImportHandler brfImporterHandler;
 		MaterialManager materialManager;
 		TextureManager textureManager;
 
+		void loadModel(ModelID modelID, std::string fileName, AssetLoader::Priority priority = AssetLoader::PRIORITY_NORMAL);
+
 	};
 }
\ No newline at end of file
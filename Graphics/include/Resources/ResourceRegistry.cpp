@@ -0,0 +1,240 @@
+#include "ResourceRegistry.h"
+
+// low bits are the slot, the rest the generation
+#define REGISTRY_INDEX_BITS 20
+#define REGISTRY_INDEX_MASK ((1u << REGISTRY_INDEX_BITS) - 1)
+#define REGISTRY_GENERATION_MASK ((1u << (32 - REGISTRY_INDEX_BITS)) - 1)
+#define REGISTRY_MIN_TABLE_SIZE 64
+
+namespace Graphics
+{
+    ResourceRegistry::ResourceRegistry()
+    {
+        count = 0;
+        table.resize(REGISTRY_MIN_TABLE_SIZE, 0);
+    }
+
+    ResourceRegistry::Handle ResourceRegistry::acquire(std::string const & name, bool * created)
+    {
+        uint32_t hash = hashName(name);
+        size_t entry = findEntry(name, hash);
+
+        if (table[entry] != 0)
+        {
+            slots[table[entry] - 1].refCount++;
+            if (created)
+                *created = false;
+            return makeHandle(table[entry] - 1);
+        }
+
+        uint32_t slot;
+        if (!freeSlots.empty())
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            if (slots.size() > REGISTRY_INDEX_MASK)
+                return INVALID_HANDLE;
+
+            slot = (uint32_t)slots.size();
+            slots.push_back({ std::string(), 0, 1, 0, false });
+        }
+
+        Slot & added = slots[slot];
+        added.name = name;
+        added.hash = hash;
+        added.refCount = 1;
+        added.used = true;
+        count++;
+
+        // the entry found above is still right unless the table grows
+        if ((count * 2) > table.size())
+            growTable();
+        else
+            table[entry] = slot + 1;
+
+        if (created)
+            *created = true;
+        return makeHandle(slot);
+    }
+
+    ResourceRegistry::Handle ResourceRegistry::find(std::string const & name) const
+    {
+        size_t entry = findEntry(name, hashName(name));
+        return table[entry] != 0 ? makeHandle(table[entry] - 1) : INVALID_HANDLE;
+    }
+
+    bool ResourceRegistry::addRef(Handle handle)
+    {
+        if (!isValid(handle))
+            return false;
+
+        slots[getIndex(handle)].refCount++;
+        return true;
+    }
+
+    bool ResourceRegistry::release(Handle handle)
+    {
+        if (!isValid(handle))
+            return false;
+
+        Slot & slot = slots[getIndex(handle)];
+        if (slot.refCount > 0)
+            slot.refCount--;
+        return true;
+    }
+
+    uint32_t ResourceRegistry::evictUnused(std::function<void(Handle handle)> const & evicted)
+    {
+        uint32_t removed = 0;
+
+        for (uint32_t i = 0; i < (uint32_t)slots.size(); i++)
+        {
+            Slot & slot = slots[i];
+            if (!slot.used || slot.refCount > 0)
+                continue;
+
+            if (evicted)
+                evicted(makeHandle(i));
+
+            removeEntry(i);
+            slot.used = false;
+            slot.name.clear();
+            slot.generation = (slot.generation + 1) & REGISTRY_GENERATION_MASK;
+            if (slot.generation == 0)
+                slot.generation = 1;
+
+            freeSlots.push_back(i);
+            count--;
+            removed++;
+        }
+
+        return removed;
+    }
+
+    void ResourceRegistry::clear()
+    {
+        for (uint32_t i = 0; i < (uint32_t)slots.size(); i++)
+            slots[i].refCount = 0;
+        evictUnused();
+    }
+
+    bool ResourceRegistry::isValid(Handle handle) const
+    {
+        uint32_t index = handle & REGISTRY_INDEX_MASK;
+        return handle != INVALID_HANDLE && index < slots.size() && slots[index].used &&
+            slots[index].generation == (handle >> REGISTRY_INDEX_BITS);
+    }
+
+    uint32_t ResourceRegistry::getIndex(Handle handle) const
+    {
+        return handle & REGISTRY_INDEX_MASK;
+    }
+
+    uint32_t ResourceRegistry::getRefCount(Handle handle) const
+    {
+        return isValid(handle) ? slots[getIndex(handle)].refCount : 0;
+    }
+
+    std::string const & ResourceRegistry::getName(Handle handle) const
+    {
+        return slots[getIndex(handle)].name;
+    }
+
+    ResourceRegistry::Handle ResourceRegistry::getHandle(uint32_t index) const
+    {
+        return index < slots.size() && slots[index].used ? makeHandle(index) : INVALID_HANDLE;
+    }
+
+    uint32_t ResourceRegistry::getCapacity() const
+    {
+        return (uint32_t)slots.size();
+    }
+
+    uint32_t ResourceRegistry::getCount() const
+    {
+        return count;
+    }
+
+    uint32_t ResourceRegistry::hashName(std::string const & name)
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for (char c : name)
+        {
+            hash ^= (unsigned char)c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    size_t ResourceRegistry::findEntry(std::string const & name, uint32_t hash) const
+    {
+        size_t mask = table.size() - 1;
+        size_t entry = hash & mask;
+
+        while (table[entry] != 0)
+        {
+            Slot const & slot = slots[table[entry] - 1];
+            if (slot.hash == hash && slot.name == name)
+                break;
+            entry = (entry + 1) & mask;
+        }
+
+        return entry;
+    }
+
+    void ResourceRegistry::insertEntry(uint32_t slot)
+    {
+        size_t mask = table.size() - 1;
+        size_t entry = slots[slot].hash & mask;
+
+        while (table[entry] != 0)
+            entry = (entry + 1) & mask;
+
+        table[entry] = slot + 1;
+    }
+
+    void ResourceRegistry::removeEntry(uint32_t slot)
+    {
+        size_t mask = table.size() - 1;
+        size_t entry = slots[slot].hash & mask;
+
+        while (table[entry] != slot + 1)
+            entry = (entry + 1) & mask;
+
+        // move back whatever further along the chain would be cut off by the hole
+        size_t hole = entry;
+        size_t next = (hole + 1) & mask;
+        while (table[next] != 0)
+        {
+            size_t home = slots[table[next] - 1].hash & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                table[hole] = table[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+
+        table[hole] = 0;
+    }
+
+    void ResourceRegistry::growTable()
+    {
+        table.assign(table.size() * 2, 0);
+
+        for (uint32_t i = 0; i < (uint32_t)slots.size(); i++)
+        {
+            if (slots[i].used)
+                insertEntry(i);
+        }
+    }
+
+    ResourceRegistry::Handle ResourceRegistry::makeHandle(uint32_t slot) const
+    {
+        return (slots[slot].generation << REGISTRY_INDEX_BITS) | slot;
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace Graphics
+{
+    /*
+        Names (texture files, material keys) to stable handles, with a
+        reference count each. The registry only owns the names, the owner
+        keeps what they stand for in its own arrays at getIndex(handle).
+
+        A handle is a slot index and the generation of that slot. Evicting
+        bumps the generation, so old handles to a reused slot are stale
+        instead of pointing at something else. Handle 0 is never given out.
+
+        Lookup is open addressing with linear probing on a hash of the name,
+        the table is kept at most half full and removals shift the probe
+        chain back so there are no tombstones.
+
+        Nothing is freed when a count reaches zero, evictUnused does that
+        when the owner says so (after a level is unloaded, say).
+
+        HOW TO USE:
+            bool created;
+            Handle handle = registry.acquire(path, &created);
+            if (created) things.resize(registry.getCapacity()), load(things[registry.getIndex(handle)]);
+            registry.release(handle);
+            registry.evictUnused([](Handle handle) { free(things[registry.getIndex(handle)]); });
+    */
+    class ResourceRegistry
+    {
+    public:
+        typedef uint32_t Handle;
+        static const Handle INVALID_HANDLE = 0;
+
+        ResourceRegistry();
+
+        // registers the name if it isn't, one more reference either way.
+        // created is true when the caller has to load what the name stands for
+        Handle acquire(std::string const & name, bool * created = nullptr);
+        // no reference, INVALID_HANDLE if it isn't registered
+        Handle find(std::string const & name) const;
+
+        // both false for stale handles, release doesn't go below zero
+        bool addRef(Handle handle);
+        bool release(Handle handle);
+
+        // removes every name without references, evicted is called with each first.
+        // returns how many
+        uint32_t evictUnused(std::function<void(Handle handle)> const & evicted = nullptr);
+        void clear();
+
+        bool isValid(Handle handle) const;
+        // only for valid handles
+        uint32_t getIndex(Handle handle) const;
+        uint32_t getRefCount(Handle handle) const;
+        std::string const & getName(Handle handle) const;
+        // the handle of what is at index, INVALID_HANDLE for free slots
+        Handle getHandle(uint32_t index) const;
+
+        // one past the highest index in use, what the owner's arrays need
+        uint32_t getCapacity() const;
+        uint32_t getCount() const;
+
+        static uint32_t hashName(std::string const & name);
+    private:
+        struct Slot
+        {
+            std::string name;
+            uint32_t hash;
+            uint32_t generation;
+            uint32_t refCount;
+            bool used;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        std::vector<uint32_t> table;        // slot index + 1, 0 is empty
+        uint32_t count;
+
+        // where the name is in table, or the empty entry it would go in
+        size_t findEntry(std::string const & name, uint32_t hash) const;
+        void insertEntry(uint32_t slot);
+        void removeEntry(uint32_t slot);
+        void growTable();
+        Handle makeHandle(uint32_t slot) const;
+    };
+}
@@ -1,57 +1,143 @@
 #include "Shader.h"
-#include "../ThrowIfFailed.h"
-#include <Engine\Constants.h>
-#include <d3dcompiler.h>
+#include "ShaderCache.h"
+#include "VirtualFileSystem.h"
+#include <Engine/Constants.h>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#ifdef _WIN32
 #include <Windows.h>
-#ifdef DEBUG
-#define SHADER_COMPILE_FLAGS D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION
-#else
-#define SHADER_COMPILE_FLAGS NULL
 #endif
 
 namespace Graphics
 {
-
-    Shader::Shader(ID3D11Device * device, LPCWSTR shaderPath, std::initializer_list<D3D11_INPUT_ELEMENT_DESC> inputDesc)
+    namespace
     {
-        inputLayout = nullptr;
-        vertexShader = nullptr;
-        pixelShader = nullptr;
-
+        // the sources and includes, not the cache store that is written next to them on every miss
+        const std::vector<std::string> SHADER_SOURCE_EXTENSIONS = { ".hlsl", ".h" };
 
-        ID3DBlob *vsShader, *psShader, *errorMsg;
+        std::string directoryOf(std::string const & path)
+        {
+            size_t slash = path.find_last_of("/\\");
+            return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+        }
 
-        HRESULT vshr = D3DCompileFromFile(shaderPath, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, "VS", "vs_5_0", SHADER_COMPILE_FLAGS, NULL, &vsShader, &errorMsg);
-        if FAILED(vshr)
+        // one per compiler, the devices' compilers live as long as the program
+        ShaderCache & getShaderCache(ShaderCompiler & compiler)
         {
-            OutputDebugString((char*)errorMsg->GetBufferPointer());
-            throw "Failed to compile Vertex Shader";
+            static std::map<ShaderCompiler *, std::unique_ptr<ShaderCache>> caches;
+
+            std::unique_ptr<ShaderCache> & cache = caches[&compiler];
+            if (!cache)
+            {
+                cache.reset(new ShaderCache(compiler, SHADER_CACHE_STORE, compiler.getFlags()));
+                // the pack is read once, the store already is by the cache. Both the pack and
+                // the sources (hashed for the keys) can come from the asset archive
+                cache->setReader([](std::string const & path, std::string & text) { return VirtualFileSystem::singleton().read(path, text); });
+                cache->loadPack(SHADER_CACHE_PACK);
+            }
+
+            return *cache;
         }
 
-        HRESULT pshr = D3DCompileFromFile(shaderPath, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, "PS", "ps_5_0", SHADER_COMPILE_FLAGS, NULL, &psShader, &errorMsg);
-        if FAILED(pshr)
+        // the file and defines, entry and profile are filled in per stage
+        ShaderPermutation makePermutation(const char * shaderPath, const ShaderDefine * defines)
         {
-            OutputDebugString((char*)errorMsg->GetBufferPointer());
-            throw "Failed to compile Pixel Shader";
+            ShaderPermutation permutation;
+            permutation.path = shaderPath;
+
+            for (const ShaderDefine * define = defines; define && define->name; define++)
+                permutation.defines.push_back({ define->name, define->value ? define->value : "" });
+
+            return permutation;
         }
 
-        if (inputDesc.size() > 0)
+        // throws failMessage when it doesn't compile, like D3DCompileFromFile did.
+        // Empty without a compiler
+        void getBytecode(RenderDevice * device, std::vector<char> & bytecode, ShaderPermutation permutation, const char * entry, const char * profile, const char * failMessage)
         {
-            ThrowIfFailed(device->CreateInputLayout(inputDesc.begin(), inputDesc.size(), vsShader->GetBufferPointer(), vsShader->GetBufferSize(), &inputLayout));
+            bytecode.clear();
+            ShaderCompiler * compiler = device->GetShaderCompiler();
+            if (!compiler)
+                return;
+
+            permutation.entry = entry;
+            permutation.profile = profile;
+
+            std::string errors;
+            if (!getShaderCache(*compiler).get(permutation, bytecode, errors))
+            {
+#ifdef _WIN32
+                OutputDebugString(errors.c_str());
+#endif
+                std::cout << errors;
+                throw failMessage;
+            }
         }
+    }
 
-        ThrowIfFailed(device->CreateVertexShader(vsShader->GetBufferPointer(), vsShader->GetBufferSize(), NULL, &vertexShader));
-        ThrowIfFailed(device->CreatePixelShader(psShader->GetBufferPointer(), psShader->GetBufferSize(), NULL, &pixelShader));
+    Shader::Shader(RenderDevice * device, const char * shaderPath, std::initializer_list<InputElement> inputDesc, const ShaderDefine * defines)
+    {
+        inputLayout = nullptr;
+        vertexShader = nullptr;
+        pixelShader = nullptr;
+
+        this->device = device;
+        this->permutation = makePermutation(shaderPath, defines);
+        this->inputDesc.assign(inputDesc.begin(), inputDesc.end());
+
+        reload();
+
+        // an edited include is a different cache key too, so every source in the folder
+        reloadSubscription = HotReloader::singleton().subscribe(directoryOf(permutation.path), [this](std::string const &) { reload(); }, SHADER_SOURCE_EXTENSIONS);
     }
 
     Shader::~Shader()
     {
+        HotReloader::singleton().unsubscribe(reloadSubscription);
+
         SAFE_RELEASE(inputLayout);
         SAFE_RELEASE(vertexShader);
         SAFE_RELEASE(pixelShader);
     }
 
+    void Shader::reload()
+    {
+        // the cache only compiles the ones that changed
+        std::vector<char> vsShader, psShader;
+        getBytecode(device, vsShader, permutation, "VS", "vs_5_0", "Failed to compile Vertex Shader");
+        getBytecode(device, psShader, permutation, "PS", "ps_5_0", "Failed to compile Pixel Shader");
+
+        InputLayout     * newInputLayout = nullptr;
+        GpuVertexShader * newVertexShader = nullptr;
+        GpuPixelShader  * newPixelShader = nullptr;
+
+        try
+        {
+            if (inputDesc.size() > 0)
+                newInputLayout = device->CreateInputLayout(inputDesc.data(), (UINT)inputDesc.size(), vsShader.data(), vsShader.size());
+            newVertexShader = device->CreateVertexShader(vsShader.data(), vsShader.size());
+            newPixelShader = device->CreatePixelShader(psShader.data(), psShader.size());
+        }
+        catch (...)
+        {
+            SAFE_RELEASE(newInputLayout);
+            SAFE_RELEASE(newVertexShader);
+            SAFE_RELEASE(newPixelShader);
+            throw;
+        }
+
+        SAFE_RELEASE(inputLayout);
+        SAFE_RELEASE(vertexShader);
+        SAFE_RELEASE(pixelShader);
+
+        inputLayout = newInputLayout;
+        vertexShader = newVertexShader;
+        pixelShader = newPixelShader;
+    }
+
     //void Shader::setShader(ID3D11DeviceContext * deviceContext, int flags)
     //{
     //    if (flags & VS)
@@ -66,23 +152,31 @@ namespace Graphics
     //}
 
 
-    ComputeShader::ComputeShader(ID3D11Device * device, LPCWSTR shaderPath)
+    ComputeShader::ComputeShader(RenderDevice * device, const char * shaderPath, const ShaderDefine * defines)
     {
-        ID3DBlob *csShader, *errorMsg;
+        computeShader = nullptr;
 
-        HRESULT cshr = D3DCompileFromFile(shaderPath, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, "CS", "cs_5_0", SHADER_COMPILE_FLAGS, NULL, &csShader, &errorMsg);
-        if FAILED(cshr)
-        {
-            OutputDebugString((char*)errorMsg->GetBufferPointer());
-            throw "Failed to compile Compute Shader";
-        }
+        this->device = device;
+        this->permutation = makePermutation(shaderPath, defines);
 
-        ThrowIfFailed(device->CreateComputeShader(csShader->GetBufferPointer(), csShader->GetBufferSize(), NULL, &computeShader));
+        reload();
+        reloadSubscription = HotReloader::singleton().subscribe(directoryOf(permutation.path), [this](std::string const &) { reload(); }, SHADER_SOURCE_EXTENSIONS);
     }
 
+    void ComputeShader::reload()
+    {
+        std::vector<char> csShader;
+        getBytecode(device, csShader, permutation, "CS", "cs_5_0", "Failed to compile Compute Shader");
+
+        GpuComputeShader * newComputeShader = device->CreateComputeShader(csShader.data(), csShader.size());
+
+        SAFE_RELEASE(computeShader);
+        computeShader = newComputeShader;
+    }
 
     ComputeShader::~ComputeShader()
     {
+        HotReloader::singleton().unsubscribe(reloadSubscription);
         computeShader->Release();
     }
 
@@ -90,4 +184,14 @@ namespace Graphics
     //{
     //    deviceContext->CSSetShader(computeShader, nullptr, 0);
     //}
+
+    bool precompileShaders(ShaderCompiler & compiler)
+    {
+        std::string errors;
+        bool built = getShaderCache(compiler).buildPack(SHADER_CACHE_PACK, errors);
+
+        std::cout << errors;
+        std::cout << (built ? "Shaders written to " : "Some shaders failed, the rest are in ") << SHADER_CACHE_PACK << std::endl;
+        return built;
+    }
 }
@@ -1,9 +1,19 @@
 #pragma once
-#include <d3d11.h>
 #include <initializer_list>
+#include <vector>
+#include "ShaderCache.h"
+#include "HotReloader.h"
+#include "../Device/RenderDevice.h"
 
 namespace Graphics
 {
+    // a #define for the shader, the lists end with { nullptr, nullptr }
+    struct ShaderDefine
+    {
+        const char * name;
+        const char * value;
+    };
+
     class Shader
     {
     public:
@@ -13,30 +23,54 @@ namespace Graphics
         //    PS = 1 << 1
         //};
 
-        Shader(ID3D11Device * device, LPCWSTR shaderPath, std::initializer_list<D3D11_INPUT_ELEMENT_DESC> inputDesc = {});
+        // defines ends with { nullptr, nullptr }. Compiled again in place when
+        // anything in the shader's folder changes, see HotReloader. A device
+        // without a compiler (NullRenderDevice) gets empty bytecode
+        Shader(RenderDevice * device, const char * shaderPath, std::initializer_list<InputElement> inputDesc = {}, const ShaderDefine * defines = nullptr);
         virtual ~Shader();
 
         // second argument is flags for which shaders to bind bitwise from Shader::Flags enum
         //void setShader(ID3D11DeviceContext * deviceContext, int flags = VS | PS);
 
-        inline operator ID3D11InputLayout*()  { return inputLayout  ? inputLayout  : throw "Shader has no Input Layout"; }
-        inline operator ID3D11VertexShader*() { return vertexShader ? vertexShader : throw "Shader has no Vertex Shader"; }
-        inline operator ID3D11PixelShader*()  { return pixelShader  ? pixelShader  : throw "Shader has no Pixel Shader"; }
+        // the old shaders are kept if the new ones don't compile, throws then
+        void reload();
+
+        inline operator InputLayout*()     { return inputLayout  ? inputLayout  : throw "Shader has no Input Layout"; }
+        inline operator GpuVertexShader*() { return vertexShader ? vertexShader : throw "Shader has no Vertex Shader"; }
+        inline operator GpuPixelShader*()  { return pixelShader  ? pixelShader  : throw "Shader has no Pixel Shader"; }
     private:
-        ID3D11InputLayout  * inputLayout;
-        ID3D11VertexShader * vertexShader;
-        ID3D11PixelShader  * pixelShader;
+        InputLayout     * inputLayout;
+        GpuVertexShader * vertexShader;
+        GpuPixelShader  * pixelShader;
+
+        // what it takes to compile it again
+        RenderDevice * device;
+        ShaderPermutation permutation;
+        std::vector<InputElement> inputDesc;
+        HotReloader::Subscription reloadSubscription;
     };
 
     class ComputeShader
     {
     public:
-        ComputeShader(ID3D11Device * device, LPCWSTR shaderPath);
+        ComputeShader(RenderDevice * device, const char * shaderPath, const ShaderDefine * defines = nullptr);
         virtual ~ComputeShader();
 
         //void setShader(ID3D11DeviceContext * deviceContext);
-        inline operator ID3D11ComputeShader*() { return computeShader; };
+
+        // the old shader is kept if the new one doesn't compile, throws then
+        void reload();
+
+        inline operator GpuComputeShader*() { return computeShader; };
     private:
-        ID3D11ComputeShader * computeShader;
+        GpuComputeShader * computeShader;
+
+        RenderDevice * device;
+        ShaderPermutation permutation;
+        HotReloader::Subscription reloadSubscription;
     };
-}
\ No newline at end of file
+
+    // Compiles every shader the game has compiled before (from the cache store)
+    // into the pack that is read at startup. False if one of them failed
+    bool precompileShaders(ShaderCompiler & compiler);
+}
@@ -0,0 +1,387 @@
+#include "ShaderCache.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+// bump when the file layout or what goes in the key changes
+#define SHADER_CACHE_VERSION 1
+#define SHADER_CACHE_MAX_INCLUDE_DEPTH 32
+
+namespace Graphics
+{
+    namespace
+    {
+        const char MAGIC[4] = { 'S', 'H', 'D', 'C' };
+
+        // FNV-1a, 64 bit
+        const uint64_t HASH_START = 14695981039346656037ull;
+
+        void hashBytes(uint64_t & hash, const void * data, size_t size)
+        {
+            const unsigned char * bytes = (const unsigned char *)data;
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+        }
+
+        void hashValue(uint64_t & hash, uint64_t value)
+        {
+            hashBytes(hash, &value, sizeof(value));
+        }
+
+        // with the length first, so "ab" + "c" is not "a" + "bc"
+        void hashString(uint64_t & hash, std::string const & text)
+        {
+            hashValue(hash, text.size());
+            hashBytes(hash, text.data(), text.size());
+        }
+
+        bool readWholeFile(std::string const & path, std::string & text)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+                return false;
+
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            text = buffer.str();
+            return true;
+        }
+
+        std::string directoryOf(std::string const & path)
+        {
+            size_t slash = path.find_last_of("/\\");
+            return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+        }
+
+        // the name in #include "name" or #include <name>, empty if the line is something else
+        std::string includeName(std::string const & line)
+        {
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line.compare(start, 1, "#") != 0)
+                return std::string();
+
+            start = line.find_first_not_of(" \t", start + 1);
+            if (start == std::string::npos || line.compare(start, 7, "include") != 0)
+                return std::string();
+
+            size_t open = line.find_first_of("\"<", start + 7);
+            if (open == std::string::npos)
+                return std::string();
+
+            size_t close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+            if (close == std::string::npos)
+                return std::string();
+
+            return line.substr(open + 1, close - open - 1);
+        }
+
+        void writeHeader(std::ofstream & file)
+        {
+            uint32_t version = SHADER_CACHE_VERSION;
+            file.write(MAGIC, sizeof(MAGIC));
+            file.write((const char *)&version, sizeof(version));
+        }
+
+        void writeRecord(std::ofstream & file, uint64_t key, std::string const & permutation, std::vector<char> const & bytecode)
+        {
+            uint32_t textSize = (uint32_t)permutation.size();
+            uint32_t codeSize = (uint32_t)bytecode.size();
+
+            file.write((const char *)&key, sizeof(key));
+            file.write((const char *)&textSize, sizeof(textSize));
+            file.write(permutation.data(), textSize);
+            file.write((const char *)&codeSize, sizeof(codeSize));
+            file.write(bytecode.data(), codeSize);
+        }
+    }
+
+    ShaderCache::ShaderCache(ShaderCompiler & compiler, std::string const & storePath, uint32_t compileFlags)
+        : compiler(compiler)
+    {
+        this->storePath = storePath;
+        this->compileFlags = compileFlags;
+        reader = readWholeFile;
+        hits = 0;
+        misses = 0;
+
+        // a store cut short (or from another version) is written again with what could be read,
+        // so appends land after a whole record
+        if (!readRecords(storePath) && std::ifstream(storePath, std::ios::binary))
+        {
+            std::ofstream file(storePath, std::ios::binary | std::ios::trunc);
+            writeHeader(file);
+            for (auto const & record : records)
+                writeRecord(file, record.first, record.second.permutation, record.second.bytecode);
+        }
+    }
+
+    ShaderCache::~ShaderCache()
+    {
+    }
+
+    void ShaderCache::setReader(Reader reader)
+    {
+        this->reader = reader;
+    }
+
+    bool ShaderCache::loadPack(std::string const & packPath)
+    {
+        std::string pack;
+        if (!reader(packPath, pack))
+            return false;
+
+        std::istringstream file(pack);
+        return readRecords(file);
+    }
+
+    bool ShaderCache::get(ShaderPermutation const & permutation, std::vector<char> & bytecode, std::string & errors)
+    {
+        uint64_t key = computeKey(permutation);
+
+        auto found = records.find(key);
+        if (key != 0 && found != records.end())
+        {
+            bytecode = found->second.bytecode;
+            hits++;
+            return true;
+        }
+
+        misses++;
+        if (!compiler.compile(permutation, bytecode, errors))
+            return false;
+
+        // without a key (the source couldn't be read here) it is compiled every time
+        if (key != 0)
+        {
+            Record & record = records[key];
+            record.permutation = serialize(permutation);
+            record.bytecode = bytecode;
+            appendRecord(key, record);
+        }
+
+        return true;
+    }
+
+    bool ShaderCache::buildPack(std::string const & packPath, std::string & errors)
+    {
+        // the same permutation can be in the store under old keys, once is enough
+        std::vector<std::string> permutations;
+        for (auto const & record : records)
+            permutations.push_back(record.second.permutation);
+
+        std::sort(permutations.begin(), permutations.end());
+        permutations.erase(std::unique(permutations.begin(), permutations.end()), permutations.end());
+
+        std::vector<uint64_t> keys;
+        bool built = true;
+
+        for (std::string const & text : permutations)
+        {
+            ShaderPermutation permutation;
+            std::vector<char> bytecode;
+            std::string error;
+
+            if (!deserialize(text, permutation))
+                continue;
+
+            if (computeKey(permutation) == 0)
+            {
+                errors += "Can't read " + permutation.path + "\n";
+                built = false;
+            }
+            else if (!get(permutation, bytecode, error))
+            {
+                errors += permutation.path + " " + permutation.entry + ": " + error + "\n";
+                built = false;
+            }
+            else
+            {
+                keys.push_back(computeKey(permutation));
+            }
+        }
+
+        // sorted, the same sources always give the same pack
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::ofstream file(packPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            errors += "Can't write " + packPath + "\n";
+            return false;
+        }
+
+        writeHeader(file);
+        for (uint64_t key : keys)
+        {
+            Record const & record = records[key];
+            writeRecord(file, key, record.permutation, record.bytecode);
+        }
+
+        return built && (bool)file;
+    }
+
+    uint64_t ShaderCache::computeKey(ShaderPermutation const & permutation) const
+    {
+        uint64_t hash = HASH_START;
+        hashValue(hash, SHADER_CACHE_VERSION);
+        hashValue(hash, compileFlags);
+        hashString(hash, permutation.entry);
+        hashString(hash, permutation.profile);
+
+        hashValue(hash, permutation.defines.size());
+        for (auto const & define : permutation.defines)
+        {
+            hashString(hash, define.first);
+            hashString(hash, define.second);
+        }
+
+        std::vector<std::string> visited;
+        if (!hashFile(permutation.path, hash, visited, 0))
+            return 0;
+
+        // 0 means no key
+        return hash != 0 ? hash : 1;
+    }
+
+    uint32_t ShaderCache::getHits() const
+    {
+        return hits;
+    }
+
+    uint32_t ShaderCache::getMisses() const
+    {
+        return misses;
+    }
+
+    bool ShaderCache::hashFile(std::string const & path, uint64_t & hash, std::vector<std::string> & visited, int depth) const
+    {
+        std::string text;
+        if (depth > SHADER_CACHE_MAX_INCLUDE_DEPTH || !reader(path, text))
+        {
+            // the compiler will complain about it, the key only has to change when the file shows up
+            hashString(hash, "missing " + path);
+            return false;
+        }
+
+        hashString(hash, text);
+        visited.push_back(path);
+
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            std::string name = includeName(line);
+            if (name.empty())
+                continue;
+
+            std::string includePath = directoryOf(path) + name;
+            hashString(hash, name);
+
+            // included twice is hashed once, include guards or not
+            if (std::find(visited.begin(), visited.end(), includePath) == visited.end())
+                hashFile(includePath, hash, visited, depth + 1);
+        }
+
+        return true;
+    }
+
+    bool ShaderCache::readRecords(std::string const & path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        return readRecords(file);
+    }
+
+    bool ShaderCache::readRecords(std::istream & file)
+    {
+        char magic[sizeof(MAGIC)];
+        uint32_t version = 0;
+        file.read(magic, sizeof(magic));
+        file.read((char *)&version, sizeof(version));
+        if (!file || !std::equal(magic, magic + sizeof(magic), MAGIC) || version != SHADER_CACHE_VERSION)
+            return false;
+
+        for (;;)
+        {
+            uint64_t key;
+            uint32_t textSize, codeSize;
+            Record record;
+
+            file.read((char *)&key, sizeof(key));
+            if (file.gcount() == 0 && file.eof())
+                return true;
+            if (!file)
+                return false;
+
+            file.read((char *)&textSize, sizeof(textSize));
+            if (!file)
+                return false;
+            record.permutation.resize(textSize);
+            file.read(&record.permutation[0], textSize);
+
+            file.read((char *)&codeSize, sizeof(codeSize));
+            if (!file)
+                return false;
+            record.bytecode.resize(codeSize);
+            file.read(record.bytecode.data(), codeSize);
+            if (!file)
+                return false;
+
+            records[key] = record;
+        }
+    }
+
+    bool ShaderCache::appendRecord(uint64_t key, Record const & record)
+    {
+        std::ifstream existing(storePath, std::ios::binary | std::ios::ate);
+        bool empty = !existing || existing.tellg() <= 0;
+        existing.close();
+
+        std::ofstream file(storePath, std::ios::binary | std::ios::app);
+        if (!file)
+            return false;
+
+        if (empty)
+            writeHeader(file);
+        writeRecord(file, key, record.permutation, record.bytecode);
+
+        return (bool)file;
+    }
+
+    std::string ShaderCache::serialize(ShaderPermutation const & permutation)
+    {
+        std::string text = permutation.path + "\n" + permutation.entry + "\n" + permutation.profile + "\n";
+        for (auto const & define : permutation.defines)
+            text += define.first + "=" + define.second + "\n";
+
+        return text;
+    }
+
+    bool ShaderCache::deserialize(std::string const & text, ShaderPermutation & permutation)
+    {
+        std::istringstream lines(text);
+        if (!std::getline(lines, permutation.path) ||
+            !std::getline(lines, permutation.entry) ||
+            !std::getline(lines, permutation.profile))
+            return false;
+
+        permutation.defines.clear();
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            size_t equals = line.find('=');
+            if (equals == std::string::npos)
+                return false;
+
+            permutation.defines.push_back({ line.substr(0, equals), line.substr(equals + 1) });
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+#include <istream>
+
+namespace Graphics
+{
+    // one compiled shader: a file, an entry point, a profile and the defines
+    struct ShaderPermutation
+    {
+        std::string path;
+        std::string entry;      // VS, PS, CS
+        std::string profile;    // vs_5_0 ...
+        std::vector<std::pair<std::string, std::string>> defines;
+    };
+
+    // what actually compiles, D3DCompile on Windows, anything in tests
+    class ShaderCompiler
+    {
+    public:
+        virtual ~ShaderCompiler() {}
+        // bytecode on success, errors on failure
+        virtual bool compile(ShaderPermutation const & permutation, std::vector<char> & bytecode, std::string & errors) = 0;
+        // part of the cache key, bytecode from other flags is recompiled
+        virtual uint32_t getFlags() const { return 0; }
+    };
+
+    /*
+        Compiled shader bytecode keyed on a hash of everything that goes into
+        the compile: the source, every file it includes (followed through
+        #include "..." relative to the including file), the entry point, the
+        profile, the defines and the compile flags. Changing any of them is
+        a different key, nothing has to be invalidated by hand.
+
+        Bytecode is looked up in:
+            memory  what was loaded or compiled this run
+            pack    read only, written by buildPack as an offline step
+            store   every miss is compiled and appended here, survives restarts
+
+        The store also remembers the permutations, so buildPack can compile
+        everything the game has asked for into one pack without knowing the
+        shaders itself. Old keys are left in the store when the sources
+        change, the pack only gets the current ones.
+
+        Both files are records of: key, permutation, bytecode. A record cut
+        short (a crash while writing) ends the file, what came before is kept.
+
+        Pure CPU, no D3D.
+    */
+    class ShaderCache
+    {
+    public:
+        typedef std::function<bool(std::string const & path, std::string & text)> Reader;
+
+        // storePath is created on the first miss, compileFlags go in the key
+        ShaderCache(ShaderCompiler & compiler, std::string const & storePath, uint32_t compileFlags);
+        ~ShaderCache();
+
+        // the default reads sources with fstream
+        void setReader(Reader reader);
+
+        // read with the reader like the sources, the store is always a file.
+        // False if the pack is missing or broken, what could be read is kept
+        bool loadPack(std::string const & packPath);
+
+        // compiles on a miss, errors from the compiler on failure
+        bool get(ShaderPermutation const & permutation, std::vector<char> & bytecode, std::string & errors);
+
+        // Offline: every permutation in the store with its current key, compiled
+        // if needed, into a pack. False if one failed, errors has why
+        bool buildPack(std::string const & packPath, std::string & errors);
+
+        // 0 if the file itself can't be read, missing includes are left to the compiler
+        uint64_t computeKey(ShaderPermutation const & permutation) const;
+
+        uint32_t getHits() const;
+        uint32_t getMisses() const;    // compiled
+    private:
+        struct Record
+        {
+            std::string permutation;    // serialized
+            std::vector<char> bytecode;
+        };
+
+        ShaderCompiler & compiler;
+        std::string storePath;
+        uint32_t compileFlags;
+        Reader reader;
+
+        std::unordered_map<uint64_t, Record> records;
+        uint32_t hits, misses;
+
+        // false if the file couldn't be read, its includes are followed either way
+        bool hashFile(std::string const & path, uint64_t & hash, std::vector<std::string> & visited, int depth) const;
+        bool readRecords(std::string const & path);
+        bool readRecords(std::istream & file);
+        bool appendRecord(uint64_t key, Record const & record);
+
+        static std::string serialize(ShaderPermutation const & permutation);
+        static bool deserialize(std::string const & text, ShaderPermutation & permutation);
+    };
+}
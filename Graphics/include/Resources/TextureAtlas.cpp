@@ -0,0 +1,132 @@
+#include "TextureAtlas.h"
+#include "VirtualFileSystem.h"
+#include <stdlib.h>
+#include <map>
+
+#define SPACE " \t\r\n"
+
+namespace Graphics
+{
+    namespace
+    {
+        typedef std::map<std::string, std::string> Block;
+
+        std::string trim(std::string const & text)
+        {
+            size_t start = text.find_first_not_of(SPACE);
+            if (start == std::string::npos)
+                return std::string();
+            return text.substr(start, text.find_last_not_of(SPACE) - start + 1);
+        }
+
+        // "name" : value; lines, strings without their quotes and floats without their f
+        bool parseBlock(std::string const & text, Block & block)
+        {
+            size_t start = 0, end;
+            while ((end = text.find(';', start)) != std::string::npos)
+            {
+                std::string line = text.substr(start, end - start);
+                start = end + 1;
+
+                size_t nameStart = line.find('"');
+                size_t nameEnd = nameStart == std::string::npos ? nameStart : line.find('"', nameStart + 1);
+                size_t assign = nameEnd == std::string::npos ? nameEnd : line.find(':', nameEnd);
+                if (assign == std::string::npos)
+                    return false;
+
+                std::string value = trim(line.substr(assign + 1));
+                if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+                    value = value.substr(1, value.size() - 2);
+                else if (!value.empty() && value.back() == 'f')
+                    value.pop_back();
+
+                block[line.substr(nameStart + 1, nameEnd - nameStart - 1)] = value;
+            }
+            return trim(text.substr(start)).empty();
+        }
+
+        bool getFloat(Block const & block, const char * name, float & value)
+        {
+            auto it = block.find(name);
+            if (it == block.end() || it->second.empty())
+                return false;
+
+            char * end = nullptr;
+            value = strtof(it->second.c_str(), &end);
+            return *end == '\0';
+        }
+    }
+
+    bool TextureAtlas::load(std::string const & path)
+    {
+        std::string text;
+        if (!VirtualFileSystem::singleton().read(path, text))
+        {
+            texture.clear();
+            regions.clear();
+            return false;
+        }
+        return parse(text);
+    }
+
+    bool TextureAtlas::parse(std::string const & text)
+    {
+        texture.clear();
+        regions.clear();
+
+        size_t start = 0;
+        bool valid = true;
+        while (valid && (start = text.find('{', start)) != std::string::npos)
+        {
+            size_t end = text.find('}', start);
+            Block block;
+            valid = end != std::string::npos && parseBlock(text.substr(start + 1, end - start - 1), block);
+            start = end;
+
+            if (!valid)
+                break;
+
+            if (texture.empty())
+            {
+                valid = block.count("texture") && !block["texture"].empty();
+                if (valid)
+                    texture = block["texture"];
+                continue;
+            }
+
+            Region region;
+            valid = block.count("name") && block.count("file") &&
+                getFloat(block, "uStart", region.uStart) && getFloat(block, "vStart", region.vStart) &&
+                getFloat(block, "uEnd", region.uEnd) && getFloat(block, "vEnd", region.vEnd);
+            if (valid)
+            {
+                region.file = block["file"];
+                regions[block["name"]] = region;
+            }
+        }
+
+        if (!valid || texture.empty())
+        {
+            texture.clear();
+            regions.clear();
+            return false;
+        }
+        return true;
+    }
+
+    TextureAtlas::Region const * TextureAtlas::find(std::string const & name) const
+    {
+        auto it = regions.find(name);
+        return it == regions.end() ? nullptr : &it->second;
+    }
+
+    std::string const & TextureAtlas::getTexture() const
+    {
+        return texture;
+    }
+
+    size_t TextureAtlas::getRegionCount() const
+    {
+        return regions.size();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+namespace Graphics
+{
+    /*
+        The table Tools/AtlasPacker writes next to an atlas: the atlas
+        texture, and for every image that was packed into it its name, the
+        file it came from and its UV rect in the atlas. The .lw data names
+        the images ("texture" : "button"), this turns that into where to
+        sample.
+
+        The file is a .lw like the rest of Resources/Data, the first block is
+        the atlas and every block with a name after it is an image. Paths are
+        from TEXTURE_PATH_SIMPLE. Pure parsing, no D3D.
+
+        HOW TO USE:
+            TextureAtlas atlas;
+            atlas.load(UI_ATLAS_PATH);
+            TextureAtlas::Region const * region = atlas.find("button");
+            if (region)
+                // region->uStart ... in the texture atlas.getTexture()
+    */
+    class TextureAtlas
+    {
+    public:
+        struct Region
+        {
+            std::string file;           // the image on its own
+            float uStart, vStart;       // top left
+            float uEnd, vEnd;           // bottom right
+        };
+
+        // false if it can't be read or isn't an atlas table, it's empty then
+        bool load(std::string const & path);
+        bool parse(std::string const & text);
+
+        // null if there is no image with that name
+        Region const * find(std::string const & name) const;
+        std::string const & getTexture() const;
+        size_t getRegionCount() const;
+    private:
+        std::string texture;
+        std::unordered_map<std::string, Region> regions;
+    };
+}
@@ -1,348 +1,360 @@
 #include "TextureManager.h" 
+#include "VirtualFileSystem.h"
+#ifdef _WIN32
+#include <wincodec.h>
+#endif
 
-using namespace DirectX;
 namespace Graphics
 {
-	TextureManager::TextureManager()
+	namespace
 	{
+		// On a loader worker, the bytes to a DDSFile, decoded to RGBA with WIC if they aren't
+		// one already. Only creating the texture needs the device
+		bool decodeTexture(AssetLoader::Asset& asset)
+		{
+			std::shared_ptr<DDSFile> texture = std::make_shared<DDSFile>();
 
-	}
+			// cooked, or a .dds in Resources, is ready for the GPU as it is
+			if (texture->read(asset.bytes.data(), asset.bytes.size()))
+			{
+				asset.decoded = texture;
+				return true;
+			}
 
-	TextureManager::~TextureManager()
-	{
-		for (unsigned int i = 0; i < diffuseTextures.size(); i++)
-		{
-			delete diffuseTextures.at(i);
+#ifdef _WIN32
+			// once per worker, never uninitialized since the workers live as long as the loader
+			static thread_local bool comInitialized = false;
+			if (!comInitialized)
+			{
+				HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+				if (FAILED(hr) && hr != RPC_E_CHANGED_MODE)
+					return false;
+				comInitialized = true;
+			}
+
+			IWICImagingFactory* factory = nullptr;
+			IWICStream* stream = nullptr;
+			IWICBitmapDecoder* decoder = nullptr;
+			IWICBitmapFrameDecode* frame = nullptr;
+			IWICFormatConverter* converter = nullptr;
+			UINT width = 0, height = 0;
+
+			HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+			if (SUCCEEDED(hr))
+				hr = factory->CreateStream(&stream);
+			if (SUCCEEDED(hr))
+				hr = stream->InitializeFromMemory((BYTE*)asset.bytes.data(), (DWORD)asset.bytes.size());
+			if (SUCCEEDED(hr))
+				hr = factory->CreateDecoderFromStream(stream, nullptr, WICDecodeMetadataCacheOnDemand, &decoder);
+			if (SUCCEEDED(hr))
+				hr = decoder->GetFrame(0, &frame);
+			if (SUCCEEDED(hr))
+				hr = factory->CreateFormatConverter(&converter);
+			if (SUCCEEDED(hr))
+				hr = converter->Initialize(frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+			if (SUCCEEDED(hr))
+				hr = converter->GetSize(&width, &height);
+			if (SUCCEEDED(hr))
+			{
+				texture->create(width, height, DDS_FORMAT_R8G8B8A8, 1);
+				hr = converter->CopyPixels(nullptr, width * 4, (UINT)texture->getMip(0).size, (BYTE*)texture->getData(0));
+			}
+
+			SAFE_RELEASE(converter);
+			SAFE_RELEASE(frame);
+			SAFE_RELEASE(decoder);
+			SAFE_RELEASE(stream);
+			SAFE_RELEASE(factory);
+
+			if (FAILED(hr))
+				return false;
+
+			asset.decoded = texture;
+			return true;
+#else
+			return false;
+#endif
 		}
-		for (unsigned int i = 0; i < normalTextures.size(); i++)
+
+		// formats DDSFile doesn't know are counted as 4 bytes a pixel
+		uint64_t getTextureBytes(DDSFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
 		{
-			delete normalTextures.at(i);
+			bool blocks = DDSFile::isBlockCompressed(format);
+			uint64_t elementSize = DDSFile::getBytesPerElement(format) ? DDSFile::getBytesPerElement(format) : 4;
+
+			uint64_t bytes = 0;
+			for (uint32_t mip = 0; mip < mipCount; mip++)
+			{
+				uint64_t mipWidth = width >> mip ? width >> mip : 1;
+				uint64_t mipHeight = height >> mip ? height >> mip : 1;
+				bytes += (blocks ? ((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) : mipWidth * mipHeight) * elementSize;
+			}
+			return bytes;
 		}
-		for (unsigned int i = 0; i < specularTextures.size(); i++)
+
+		// immutable with the mips the file has, or the whole chain generated on the GPU
+		// from mip 0 when generateMips and the format can be rendered to
+		ShaderResourceView* createTexture(RenderDevice* device, DDSFile const& file, bool generateMips, uint64_t* bytes)
 		{
-			delete specularTextures.at(i);
+			bool generate = generateMips && file.getMipCount() == 1 && !DDSFile::isBlockCompressed(file.getFormat());
+
+			TextureDesc desc = {};
+			desc.width = file.getWidth();
+			desc.height = file.getHeight();
+			desc.arraySize = 1;
+			desc.format = (Format)file.getFormat();
+
+			GpuTexture* texture = nullptr;
+			if (generate)
+			{
+				desc.mipLevels = DDSFile::getFullMipCount(desc.width, desc.height);
+				desc.usage = USAGE_DEFAULT;
+				desc.bindFlags = BIND_SHADER_RESOURCE | BIND_RENDER_TARGET;
+				desc.generateMips = true;
+
+				texture = device->CreateTexture(desc, nullptr);
+				device->UpdateTexture(texture, 0, file.getData(0), file.getMip(0).rowPitch);
+			}
+			else
+			{
+				desc.mipLevels = file.getMipCount();
+				desc.usage = USAGE_IMMUTABLE;
+				desc.bindFlags = BIND_SHADER_RESOURCE;
+
+				std::vector<SubresourceData> data(desc.mipLevels);
+				for (UINT i = 0; i < desc.mipLevels; i++)
+				{
+					data[i].data = file.getData(i);
+					data[i].rowPitch = file.getMip(i).rowPitch;
+				}
+				texture = device->CreateTexture(desc, data.data());
+			}
+
+			ShaderResourceView* view = device->CreateShaderResourceView(texture);
+			texture->Release();
+
+			if (generate)
+				device->GenerateMips(view);
+			if (bytes)
+				*bytes = getTextureBytes(file.getFormat(), desc.width, desc.height, desc.mipLevels);
+
+			return view;
 		}
-		for (unsigned int i = 0; i < glowTextures.size(); i++)
+
+		// normalized and without the extension, a cooked .dds and its source are the same texture
+		string getTextureKey(string const& fileName)
 		{
-			delete glowTextures.at(i);
+			string key = AssetArchive::normalizeName(fileName);
+			size_t dot = key.find_last_of('.');
+			if (dot != string::npos && (key.find_last_of('/') == string::npos || dot > key.find_last_of('/')))
+				key.erase(dot);
+			return key;
 		}
 	}
 
-	void TextureManager::initilize(ID3D11Device * gDevice)
+	TextureManager::TextureManager()
+	{
+
+	}
+
+	TextureManager::~TextureManager()
+	{
+
+	}
+
+	void TextureManager::initilize(RenderDevice * gDevice, AssetLoader* assetLoader)
 	{
 		this->gDevice = gDevice;
+		this->assetLoader = assetLoader;
 		//CoInitialize((LPVOID)0);
+
+		diffusePlaceholder = createPlaceholder(0xFFFFFFFF);
+		normalPlaceholder = createPlaceholder(0xFFFF8080);
+		specularPlaceholder = createPlaceholder(0xFF000000);
+		glowPlaceholder = createPlaceholder(0xFF000000);
+
+		assetLoader->setType(ASSET_TEXTURE, decodeTexture, [this](AssetLoader::Asset& asset) { return uploadTexture(asset); });
+		reloadSubscription = HotReloader::singleton().subscribe(TEXTURE_PATH_SIMPLE, [this](string const& path) { reloadTexture(path); });
 	}
 
 	void TextureManager::release()
 	{
-		for (unsigned int i = 0; i < diffuseTextures.size(); i++)
-		{
-			SAFE_RELEASE(*diffuseTextures.at(i));
-		}
-		for (unsigned int i = 0; i < normalTextures.size(); i++)
-		{
-			SAFE_RELEASE(*normalTextures.at(i));
-		}
-		for (unsigned int i = 0; i < specularTextures.size(); i++)
-		{
-			SAFE_RELEASE(*specularTextures.at(i));
-		}
-		for (unsigned int i = 0; i < glowTextures.size(); i++)
+		HotReloader::singleton().unsubscribe(reloadSubscription);
+		reloadSubscription = HotReloader::INVALID_SUBSCRIPTION;
+
+		for (unsigned int i = 0; i < textures.size(); i++)
 		{
-			SAFE_RELEASE(*glowTextures.at(i));
+			SAFE_RELEASE(textures.at(i));
 		}
+		registry.clear();
+
+		SAFE_RELEASE(diffusePlaceholder);
+		SAFE_RELEASE(normalPlaceholder);
+		SAFE_RELEASE(specularPlaceholder);
+		SAFE_RELEASE(glowPlaceholder);
 	}
 
-	int TextureManager::getDiffuseID(string diffuseTex)
+	TextureManager::Handle TextureManager::acquireTexture(string fileName)
 	{
-		if (diffuseTex == "")
-		{
-			return -1;
-		}
-		if (this->diffuseTex.size() == 0)
+		if (fileName == "")
+			return ResourceRegistry::INVALID_HANDLE;
+
+		bool created = false;
+		Handle handle = registry.acquire(fileName, &created);
+		if (created)
 		{
-			this->diffuseTex.push_back(diffuseTex);
-			AddDiffuseTexture(diffuseTex);
-			return 0;
+			if (textures.size() < registry.getCapacity())
+				textures.resize(registry.getCapacity(), nullptr);
+			requestTexture(handle);
 		}
-		else
-		{
-			for (unsigned int i = 0; i < this->diffuseTex.size(); i++)
-			{
-				if (this->diffuseTex.at(i) == diffuseTex)
-				{
-					return i;
-				}
-			}
-		}
-		this->diffuseTex.push_back(diffuseTex);
-		this->diffuseTex.shrink_to_fit();
-		AddDiffuseTexture(diffuseTex);
-		return (int)(this->diffuseTex.size() - 1);
+
+		return handle;
 	}
 
-	int TextureManager::getNormalID(string normalTex)
+	TextureManager::Handle TextureManager::findTexture(string fileName) const
 	{
-		if (normalTex == "")
-			return -1;
-		if (this->normalTex.size() == 0)
-		{
-			this->normalTex.push_back(normalTex);
-			AddNormalTexture(normalTex);
-			return 0;
-		}
-		else
-		{
-			for (unsigned int i = 0; i < this->normalTex.size(); i++)
-			{
-				if (this->normalTex.at(i) == normalTex)
-					return i;
-			}
-		}
-		this->normalTex.push_back(normalTex);
-		this->normalTex.shrink_to_fit();
-		AddNormalTexture(normalTex);
-		return (int)(this->normalTex.size() - 1);
+		if (fileName == "")
+			return ResourceRegistry::INVALID_HANDLE;
+
+		return registry.find(fileName);
 	}
 
-	int TextureManager::getSpecularID(string specularTex)
+	void TextureManager::releaseTexture(Handle handle)
 	{
-		if (specularTex == "")
-			return -1;
-		if (this->specularTex.size() == 0)
-		{
-			this->specularTex.push_back(specularTex);
-			AddSpecularTexture(specularTex);
-			return 0;
-		}
-		else
-		{
-			for (unsigned int i = 0; i < this->specularTex.size(); i++)
-			{
-				if (this->specularTex.at(i) == specularTex)
-					return i;
-			}
-		}
-		this->specularTex.push_back(specularTex);
-		this->specularTex.shrink_to_fit();
-		AddSpecularTexture(specularTex);
-		return (int)(this->specularTex.size() - 1);
+		registry.release(handle);
 	}
 
-	int TextureManager::getGlowID(string glowTex)
+	uint32_t TextureManager::evictUnused()
 	{
-		if (glowTex == "")
-			return -1;
-		if (this->glowTex.size() == 0)
-		{
-			this->glowTex.push_back(glowTex);
-			AddGlowTexture(glowTex);
-			return 0;
-		}
-		else
+		return registry.evictUnused([this](Handle handle)
 		{
-			for (unsigned int i = 0; i < this->glowTex.size(); i++)
-			{
-				if (this->glowTex.at(i) == glowTex)
-					return i;
-			}
-		}
-		this->glowTex.push_back(glowTex);
-		this->glowTex.shrink_to_fit();
-		AddGlowTexture(glowTex);
-		return (int)(this->glowTex.size() - 1);
+			SAFE_RELEASE(textures.at(registry.getIndex(handle)));
+		});
 	}
 
-	int TextureManager::findDiffuseID(string diffuseTex)
+	ShaderResourceView * TextureManager::GetDiffuseTexture(Handle diffuseID)
 	{
-		for (unsigned int i = 0; i < this->diffuseTex.size(); i++)
-		{
-			if (this->diffuseTex.at(i) == diffuseTex)
-			{
-				return i;
-			}
-		}
-
-		return -1;
+		return getTexture(diffuseID, diffusePlaceholder);
 	}
 
-	int TextureManager::findNormalID(string normalTex)
+	ShaderResourceView * TextureManager::GetNormalTexture(Handle normalID)
 	{
-		for (unsigned int i = 0; i < this->normalTex.size(); i++)
-		{
-			if (this->normalTex.at(i) == normalTex)
-			{
-				return i;
-			}
-		}
-
-		return -1;
+		return getTexture(normalID, normalPlaceholder);
 	}
 
-	int TextureManager::findSpeularID(string specualrTex)
+	ShaderResourceView * TextureManager::GetSpecularTexture(Handle specularID)
 	{
-		for (unsigned int i = 0; i < this->specularTex.size(); i++)
-		{
-			if (this->specularTex.at(i) == specualrTex)
-			{
-				return i;
-			}
-		}
-
-		return -1;
+		return getTexture(specularID, specularPlaceholder);
 	}
 
-	int TextureManager::findGloowID(string glowTex)
+	ShaderResourceView * TextureManager::GetGlowTexture(Handle glowID)
 	{
-		for (unsigned int i = 0; i < this->glowTex.size(); i++)
-		{
-			if (this->glowTex.at(i) == glowTex)
-			{
-				return i;
-			}
-		}
-
-		return -1;
+		return getTexture(glowID, glowPlaceholder);
 	}
 
-	ID3D11ShaderResourceView * TextureManager::GetDiffuseTexture(int diffuseID)
+	bool TextureManager::createTextureFromFile(RenderDevice * device, string path, bool generateMips, ShaderResourceView ** view, uint64_t * bytes)
 	{
-		if (diffuseID == -1)
-		{
-			return nullptr;
-		}
-		else
-		{
-			try
-			{
-				return *diffuseTextures.at(diffuseID);
-			}
-			catch (...)
-			{
-				return nullptr;
-			}
-		}
+		AssetLoader::Asset asset = {};
+		if (!VirtualFileSystem::singleton().read(path, asset.bytes) || !decodeTexture(asset))
+			return false;
 
-		return nullptr;
+		*view = createTexture(device, *(DDSFile*)asset.decoded.get(), generateMips, bytes);
+		return true;
 	}
 
-	ID3D11ShaderResourceView * TextureManager::GetNormalTexture(int normalID)
+	ShaderResourceView * TextureManager::getTexture(Handle handle, ShaderResourceView * placeholder)
 	{
-		if (normalID == -1)
-		{
+		if (!registry.isValid(handle))
 			return nullptr;
-		}
-		else
-		{
-			try
-			{
-				return *normalTextures.at(normalID);
-			}
-			catch (...)
-			{
-				return nullptr;
-			}
-		}
 
-		return nullptr;
+		ShaderResourceView* texture = textures.at(registry.getIndex(handle));
+		return texture ? texture : placeholder;
 	}
 
-	ID3D11ShaderResourceView * TextureManager::GetSpecularTexture(int specularID)
+	void TextureManager::requestTexture(Handle handle)
 	{
-		if (specularID == -1)
-		{
-			return nullptr;
-		}
-		else
-		{
-			try
-			{
-				return *specularTextures.at(specularID);
-			}
-			catch (...)
-			{
-				return nullptr;
-			}
-		}
-
-		return nullptr;
+		string fileName = registry.getName(handle);
+		string path = TEXTURE_PATH_SIMPLE + fileName;
+		string cooked = TEXTURE_COOKED_PATH_SIMPLE + fileName.substr(0, fileName.find_last_of('.')) + ".dds";
+		if (VirtualFileSystem::singleton().exists(cooked))
+			path = cooked;
+
+		// the handle comes back as the id, a texture evicted before it's done is dropped by uploadTexture
+		assetLoader->load(ASSET_TEXTURE, path, AssetLoader::PRIORITY_NORMAL, (int)handle);
 	}
 
-	ID3D11ShaderResourceView * TextureManager::GetGlowTexture(int glowID)
+	void TextureManager::reloadTexture(string path)
 	{
-		if (glowID == -1)
+		// the names in the registry are from TEXTURE_PATH_SIMPLE, or TEXTURE_COOKED_PATH_SIMPLE for a cooked one.
+		// An edited source with a cooked version still loads the cooked one, it has to be cooked again
+		string normalized = AssetArchive::normalizeName(path);
+		string folder = AssetArchive::normalizeName(TEXTURE_COOKED_PATH_SIMPLE);
+		if (normalized.compare(0, folder.size(), folder) != 0)
+			folder = AssetArchive::normalizeName(TEXTURE_PATH_SIMPLE);
+		string key = getTextureKey(normalized.substr(folder.size()));
+
+		for (uint32_t i = 0; i < registry.getCapacity(); i++)
 		{
-			return nullptr;
+			Handle handle = registry.getHandle(i);
+			if (handle != ResourceRegistry::INVALID_HANDLE && getTextureKey(registry.getName(handle)) == key)
+				requestTexture(handle);
 		}
-		else
-		{
-			try
-			{
-				return *glowTextures.at(glowID);
-			}
-			catch (...)
-			{
-				return nullptr;
-			}
-		}
-
-		return nullptr;
 	}
 
-	void TextureManager::AddDiffuseTexture(string diffuseTex)
+	bool TextureManager::uploadTexture(AssetLoader::Asset & asset)
 	{
-		ID3D11ShaderResourceView** texture = newd ID3D11ShaderResourceView*;
+		Handle handle = (Handle)asset.id;
+		if (!registry.isValid(handle))
+			return true;
 
-		diffuseTex = TEXTURE_PATH_SIMPLE + diffuseTex;
-		wstring widestr = wstring(diffuseTex.begin(), diffuseTex.end());
-		const wchar_t* fileName = widestr.c_str();
+		// cooked textures have their mips, the rest are drawn without
+		ShaderResourceView* view = createTexture(gDevice, *(DDSFile*)asset.decoded.get(), false, nullptr);
 
-		hr = CreateWICTextureFromFile(gDevice, fileName, nullptr, texture);
+		// reloaded textures replace the old one in place
+		ShaderResourceView*& slot = textures.at(registry.getIndex(handle));
+		SAFE_RELEASE(slot);
+		slot = view;
 
-		diffuseTextures.push_back(texture);
-		diffuseTextures.shrink_to_fit();
+		return true;
 	}
 
-	void TextureManager::AddNormalTexture(string normalTex)
+	ShaderResourceView * TextureManager::createPlaceholder(UINT rgba)
 	{
-		ID3D11ShaderResourceView** texture = newd ID3D11ShaderResourceView*;
-
-		normalTex = TEXTURE_PATH_SIMPLE + normalTex;
-		wstring widestr = wstring(normalTex.begin(), normalTex.end());
-		const wchar_t* fileName = widestr.c_str();
-
-		hr = CreateWICTextureFromFile(gDevice, fileName, nullptr, texture);
-
-		normalTextures.push_back(texture);
-		normalTextures.shrink_to_fit();
+		TextureDesc desc = {};
+		desc.width = 1;
+		desc.height = 1;
+		desc.mipLevels = 1;
+		desc.arraySize = 1;
+		desc.format = FORMAT_R8G8B8A8_UNORM;
+		desc.usage = USAGE_IMMUTABLE;
+		desc.bindFlags = BIND_SHADER_RESOURCE;
+
+		SubresourceData data = { &rgba, 4 };
+
+		GpuTexture* texture = gDevice->CreateTexture(desc, &data);
+		ShaderResourceView* view = gDevice->CreateShaderResourceView(texture);
+		texture->Release();
+
+		return view;
 	}
 
-	void TextureManager::AddSpecularTexture(string specularTex)
+	TextureFileLoader::TextureFileLoader(RenderDevice * device, bool generateMips)
 	{
-		ID3D11ShaderResourceView** texture = newd ID3D11ShaderResourceView*;
-
-		specularTex = TEXTURE_PATH_SIMPLE + specularTex;
-		wstring widestr = wstring(specularTex.begin(), specularTex.end());
-		const wchar_t* fileName = widestr.c_str();
-
-		hr = CreateWICTextureFromFile(gDevice, fileName, nullptr, texture);
-
-		specularTextures.push_back(texture);
-		specularTextures.shrink_to_fit();
+		this->device = device;
+		this->generateMips = generateMips;
 	}
 
-	void TextureManager::AddGlowTexture(string glowTex)
+	void * TextureFileLoader::load(std::string const & path, uint64_t & bytes)
 	{
-		ID3D11ShaderResourceView** texture = newd ID3D11ShaderResourceView*;
-
-		glowTex = TEXTURE_PATH_SIMPLE + glowTex;
-		wstring widestr = wstring(glowTex.begin(), glowTex.end());
-		const wchar_t* fileName = widestr.c_str();
+		ShaderResourceView* view = nullptr;
+		if (!TextureManager::createTextureFromFile(device, path, generateMips, &view, &bytes))
+			return nullptr;
 
-		hr = CreateWICTextureFromFile(gDevice, fileName, nullptr, texture);
+		return view;
+	}
 
-		glowTextures.push_back(texture);
-		glowTextures.shrink_to_fit();
+	void TextureFileLoader::unload(void * texture)
+	{
+		((ShaderResourceView*)texture)->Release();
 	}
 }
\ No newline at end of file
@@ -4,7 +4,12 @@
 #include "../Datatypes.h"
 #include <vector>
 
-#include "WICTextureLoader.h"
+#include "../Device/RenderDevice.h"
+#include "AssetLoader.h"
+#include "DDSFile.h"
+#include "ResourceRegistry.h"
+#include "HotReloader.h"
+#include "TextureResidency.h"
 
 namespace Graphics
 {
@@ -14,41 +19,67 @@ namespace Graphics
 		TextureManager();
 		~TextureManager();
 
-		void initilize(ID3D11Device* gDevice);
+		// textures are decoded on the loader workers and created by loader.update,
+		// until then the getters return a 1x1 placeholder. A texture cooked to
+		// TEXTURE_COOKED_PATH_SIMPLE is loaded instead of the source, mips and all.
+		// A texture file that changes on disk is loaded again behind the same handle
+		void initilize(RenderDevice* gDevice, AssetLoader* assetLoader);
 		void release();
 
-		int getDiffuseID(string diffuseTex);
-		int getNormalID(string normalTex);
-		int getSpecularID(string specularTex);
-		int getGlowID(string GlowTex);
+		typedef ResourceRegistry::Handle Handle;
 
-		int findDiffuseID(string diffuseTex);
-		int findNormalID(string normalTex);
-		int findSpeularID(string specualrTex);
-		int findGloowID(string glowTex);
+		// a reference to the texture, loaded the first time it's acquired.
+		// The same file is one texture whatever it's used as, "" is INVALID_HANDLE
+		Handle acquireTexture(string fileName);
+		// no reference, INVALID_HANDLE if it was never acquired
+		Handle findTexture(string fileName) const;
+		void releaseTexture(Handle handle);
+		// releases the textures nothing has a reference to, their handles go stale
+		uint32_t evictUnused();
 
-		ID3D11ShaderResourceView* GetDiffuseTexture(int diffuseID);
-		ID3D11ShaderResourceView* GetNormalTexture(int normalID);
-		ID3D11ShaderResourceView* GetSpecularTexture(int specularID);
-		ID3D11ShaderResourceView* GetGlowTexture(int glowID);
+		// null for invalid and stale handles
+		ShaderResourceView* GetDiffuseTexture(Handle diffuseID);
+		ShaderResourceView* GetNormalTexture(Handle normalID);
+		ShaderResourceView* GetSpecularTexture(Handle specularID);
+		ShaderResourceView* GetGlowTexture(Handle glowID);
 
+		// For textures that don't go through the manager (HUD, menu), read through the
+		// VirtualFileSystem. A DDS, or anything WIC reads on Windows. Mips are generated
+		// for an uncompressed one without them if generateMips, bytes gets what it takes on the GPU
+		static bool createTextureFromFile(RenderDevice* device, string path, bool generateMips, ShaderResourceView** view, uint64_t* bytes = nullptr);
+
+	private:
+		RenderDevice* gDevice;
+		AssetLoader* assetLoader;
+
+		// white, flat normal, no specular, no glow
+		ShaderResourceView* diffusePlaceholder = nullptr;
+		ShaderResourceView* normalPlaceholder = nullptr;
+		ShaderResourceView* specularPlaceholder = nullptr;
+		ShaderResourceView* glowPlaceholder = nullptr;
+
+		// file names to handles, textures is indexed by registry.getIndex
+		ResourceRegistry registry;
+		std::vector<ShaderResourceView*> textures;
+		HotReloader::Subscription reloadSubscription = HotReloader::INVALID_SUBSCRIPTION;
+
+		ShaderResourceView* getTexture(Handle handle, ShaderResourceView* placeholder);
+		void requestTexture(Handle handle);
+		void reloadTexture(string path);
+		bool uploadTexture(AssetLoader::Asset& asset);
+		ShaderResourceView* createPlaceholder(UINT rgba);
+	};
+
+	// Textures for TextureResidency, made with createTextureFromFile
+	class TextureFileLoader : public TextureResidency::Loader
+	{
+	public:
+		TextureFileLoader(RenderDevice* device, bool generateMips);
+
+		void* load(std::string const& path, uint64_t& bytes) override;
+		void unload(void* texture) override;
 	private:
-		ID3D11Device* gDevice;
-		HRESULT hr;
-
-		vector<string> diffuseTex;
-		vector<string> normalTex;
-		vector<string> specularTex;
-		vector<string> glowTex;
-
-		std::vector<ID3D11ShaderResourceView**> diffuseTextures;
-		std::vector<ID3D11ShaderResourceView**> normalTextures;
-		std::vector<ID3D11ShaderResourceView**> specularTextures;
-		std::vector<ID3D11ShaderResourceView**> glowTextures;
-
-		void AddDiffuseTexture(string diffuseTex);
-		void AddNormalTexture(string normalTex);
-		void AddSpecularTexture(string specularTex);
-		void AddGlowTexture(string glowTex);
+		RenderDevice* device;
+		bool generateMips;
 	};
 }
\ No newline at end of file
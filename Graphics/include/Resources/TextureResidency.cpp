@@ -0,0 +1,217 @@
+#include "TextureResidency.h"
+#include <string.h>
+
+namespace Graphics
+{
+    TextureResidency::TextureResidency(Loader & loader, uint64_t budget)
+        : loader(loader)
+    {
+        this->budget = budget;
+        frame = 1;
+        activeScopes = 0;
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    TextureResidency::~TextureResidency()
+    {
+        unloadAll();
+    }
+
+    TextureResidency::Handle TextureResidency::add(std::string const & path, uint32_t scopes)
+    {
+        bool created = false;
+        Handle handle = registry.acquire(path, &created);
+        if (created)
+        {
+            if (textures.size() < registry.getCapacity())
+                textures.resize(registry.getCapacity());
+            textures[registry.getIndex(handle)] = { 0, nullptr, 0, 0, false, false };
+        }
+
+        Texture & texture = textures[registry.getIndex(handle)];
+        texture.scopes |= scopes;
+
+        // added to a scope that is already drawn
+        if ((scopes & activeScopes) && !texture.texture && !texture.failed)
+        {
+            texture.lastUsed = frame;
+            if (load(texture, path))
+                stats.preloads++;
+            evict();
+        }
+
+        return handle;
+    }
+
+    void TextureResidency::setBudget(uint64_t budget)
+    {
+        this->budget = budget;
+        evict();
+    }
+
+    uint64_t TextureResidency::getBudget() const
+    {
+        return budget;
+    }
+
+    void TextureResidency::setActiveScopes(uint32_t scopes)
+    {
+        if (scopes == activeScopes)
+            return;
+
+        activeScopes = scopes;
+        loadScopes(scopes);
+    }
+
+    uint32_t TextureResidency::getActiveScopes() const
+    {
+        return activeScopes;
+    }
+
+    void TextureResidency::preload(uint32_t scopes)
+    {
+        loadScopes(scopes);
+    }
+
+    void * TextureResidency::get(Handle handle)
+    {
+        if (!registry.isValid(handle))
+            return nullptr;
+
+        Texture & texture = textures[registry.getIndex(handle)];
+        texture.lastUsed = frame;
+        texture.preloaded = false;
+
+        if (texture.texture)
+        {
+            stats.hits++;
+            return texture.texture;
+        }
+
+        if (texture.failed)
+            return nullptr;
+
+        stats.misses++;
+        load(texture, registry.getName(handle));
+        evict();
+
+        return texture.texture;
+    }
+
+    bool TextureResidency::isResident(Handle handle) const
+    {
+        return registry.isValid(handle) && textures[registry.getIndex(handle)].texture != nullptr;
+    }
+
+    void TextureResidency::beginFrame()
+    {
+        frame++;
+        evict();
+    }
+
+    void TextureResidency::unloadAll()
+    {
+        for (Texture & texture : textures)
+        {
+            unload(texture);
+            texture.failed = false;
+        }
+    }
+
+    TextureResidency::Stats const & TextureResidency::getStats() const
+    {
+        return stats;
+    }
+
+    void TextureResidency::resetStats()
+    {
+        stats.hits = 0;
+        stats.misses = 0;
+        stats.preloads = 0;
+        stats.evictions = 0;
+        stats.failures = 0;
+        stats.peakBytes = stats.residentBytes;
+    }
+
+    bool TextureResidency::load(Texture & texture, std::string const & path)
+    {
+        uint64_t bytes = 0;
+        texture.texture = loader.load(path, bytes);
+        if (!texture.texture)
+        {
+            texture.failed = true;
+            stats.failures++;
+            return false;
+        }
+
+        texture.bytes = bytes;
+        stats.residentCount++;
+        stats.residentBytes += bytes;
+        if (stats.residentBytes > stats.peakBytes)
+            stats.peakBytes = stats.residentBytes;
+
+        return true;
+    }
+
+    void TextureResidency::unload(Texture & texture)
+    {
+        if (!texture.texture)
+            return;
+
+        loader.unload(texture.texture);
+        stats.residentCount--;
+        stats.residentBytes -= texture.bytes;
+
+        texture.texture = nullptr;
+        texture.bytes = 0;
+        texture.preloaded = false;
+    }
+
+    void TextureResidency::loadScopes(uint32_t scopes)
+    {
+        for (uint32_t i = 0; i < textures.size(); i++)
+        {
+            Handle handle = registry.getHandle(i);
+            Texture & texture = textures[i];
+            if (handle == ResourceRegistry::INVALID_HANDLE || !(texture.scopes & scopes) || texture.failed)
+                continue;
+
+            // counts as used, it's wanted now and shouldn't be the first to go
+            texture.lastUsed = frame;
+            texture.preloaded = !(texture.scopes & activeScopes);
+            if (!texture.texture && load(texture, registry.getName(handle)))
+            {
+                stats.preloads++;
+            }
+        }
+
+        evict();
+    }
+
+    void TextureResidency::evict()
+    {
+        while (stats.residentBytes > budget)
+        {
+            // preloaded last frame is kept too, the state it's for is drawn from this one
+            Texture * oldest = nullptr;
+            for (Texture & texture : textures)
+            {
+                if (!texture.texture || (texture.scopes & activeScopes) || texture.lastUsed == frame ||
+                    (texture.preloaded && texture.lastUsed + 1 == frame))
+                {
+                    continue;
+                }
+
+                if (!oldest || texture.lastUsed < oldest->lastUsed)
+                    oldest = &texture;
+            }
+
+            // everything left is needed now, over budget it is
+            if (!oldest)
+                return;
+
+            unload(*oldest);
+            stats.evictions++;
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ResourceRegistry.h"
+
+namespace Graphics
+{
+    /*
+        Keeps the textures that aren't streamed through the TextureManager
+        (menu, HUD) loaded between the times they are used, within a memory
+        budget.
+
+        Every texture is added with the scopes it's used in. The active
+        scopes are what is being drawn, their textures are loaded when they
+        become active and never evicted while they are. Textures of inactive
+        scopes stay loaded for when they are needed again, until the budget
+        runs out, then the least recently used go first.
+
+        preload loads the textures of scopes that are about to be active, the
+        menu machine calls it during the transition to the next state so
+        nothing is loaded the frame it's first drawn.
+
+        The loader creates the textures, TextureFileLoader on the GPU or a
+        fake one in tests. Everything is on the render thread.
+
+        HOW TO USE:
+            Handle handle = residency.add(TEXTURE_PATH_SIMPLE "button.png", TextureResidency::SCOPE_MENU);
+            residency.beginFrame();
+            residency.setActiveScopes(TextureResidency::SCOPE_MENU);
+            ShaderResourceView * view = (ShaderResourceView *)residency.get(handle);
+    */
+    class TextureResidency
+    {
+    public:
+        enum Scope
+        {
+            SCOPE_MENU = 1 << 0,
+            SCOPE_HUD  = 1 << 1,
+            SCOPE_GAME = 1 << 2
+        };
+
+        typedef ResourceRegistry::Handle Handle;
+
+        class Loader
+        {
+        public:
+            virtual ~Loader() {}
+            // null if it can't be loaded, bytes is about what it takes in memory
+            virtual void * load(std::string const & path, uint64_t & bytes) = 0;
+            virtual void unload(void * texture) = 0;
+        };
+
+        struct Stats
+        {
+            uint32_t hits;          // get on a loaded texture
+            uint32_t misses;        // get that had to load there and then
+            uint32_t preloads;      // loaded before they were asked for
+            uint32_t evictions;
+            uint32_t failures;
+            uint32_t residentCount;
+            uint64_t residentBytes;
+            uint64_t peakBytes;
+        };
+
+        TextureResidency(Loader & loader, uint64_t budget);
+        ~TextureResidency();
+
+        // not loaded until a scope it's in is active or it's asked for.
+        // The same path again is the same texture, in the scopes of both
+        Handle add(std::string const & path, uint32_t scopes);
+        // evicts what it takes to get under the new one
+        void setBudget(uint64_t budget);
+        uint64_t getBudget() const;
+
+        // loads what the new scopes need, what they don't is kept for later
+        void setActiveScopes(uint32_t scopes);
+        uint32_t getActiveScopes() const;
+        // loads the textures of scopes that aren't active yet
+        void preload(uint32_t scopes);
+
+        // the texture, loaded now if it wasn't. Null if it can't be loaded
+        void * get(Handle handle);
+        bool isResident(Handle handle) const;
+
+        // once a frame before the gets, textures used last frame are then the most recent
+        void beginFrame();
+        void unloadAll();
+
+        Stats const & getStats() const;
+        // the counters, not what is resident
+        void resetStats();
+    private:
+        struct Texture
+        {
+            uint32_t scopes;
+            void * texture;
+            uint64_t bytes;
+            uint64_t lastUsed;      // frame
+            bool failed;            // not tried again until unloadAll
+            bool preloaded;         // for a scope that isn't active yet, not drawn since
+        };
+
+        Loader & loader;
+        ResourceRegistry registry;
+        std::vector<Texture> textures;      // at registry.getIndex
+        uint64_t budget;
+        uint64_t frame;
+        uint32_t activeScopes;
+        Stats stats;
+
+        bool load(Texture & texture, std::string const & path);
+        void unload(Texture & texture);
+        void loadScopes(uint32_t scopes);
+        // least recently used first, never the active scopes or what was used (or preloaded) too recently
+        void evict();
+    };
+}
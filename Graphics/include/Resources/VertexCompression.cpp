@@ -0,0 +1,310 @@
+#include "VertexCompression.h"
+#include <math.h>
+#include <string.h>
+
+#define POSITION_STEPS 65535.f
+#define SNORM_STEPS 32767.f
+// the octahedral encoding with the best of the four neighbours, measured worst is 0.00013 (0.0074 degrees)
+#define OCTAHEDRAL_MAX_ERROR 0.00015f
+// half has 10 stored bits, rounding is off by at most half the last
+#define HALF_RELATIVE_ERROR (1.f / 2048.f)
+#define HALF_SMALLEST_STEP (1.f / 16777216.f)
+
+namespace Graphics
+{
+    namespace
+    {
+        struct Vector
+        {
+            float x, y, z;
+        };
+
+        Vector makeVector(float x, float y, float z)
+        {
+            Vector v = { x, y, z };
+            return v;
+        }
+
+        float clamp(float value, float low, float high)
+        {
+            return value < low ? low : value > high ? high : value;
+        }
+
+        float signNotZero(float value)
+        {
+            return value < 0.f ? -1.f : 1.f;
+        }
+
+        float length(Vector const & v)
+        {
+            return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+        }
+
+        Vector normalized(Vector const & v)
+        {
+            float l = length(v);
+            return l > 0.f ? makeVector(v.x / l, v.y / l, v.z / l) : makeVector(0.f, 0.f, 1.f);
+        }
+
+        float angle(Vector const & a, Vector const & b)
+        {
+            // atan2 of the cross and dot is accurate for small angles, acos of the dot isn't
+            Vector cross = makeVector(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+            return atan2f(length(cross), a.x * b.x + a.y * b.y + a.z * b.z);
+        }
+
+        // x and y of a unit vector, z is the positive one
+        Vector fromXY(float const v[2])
+        {
+            float z2 = 1.f - v[0] * v[0] - v[1] * v[1];
+            return normalized(makeVector(v[0], v[1], z2 > 0.f ? sqrtf(z2) : 0.f));
+        }
+
+        uint16_t toUnorm(float value, float low, float extent)
+        {
+            if (extent <= 0.f)
+                return 0;
+            return (uint16_t)(clamp((value - low) / extent, 0.f, 1.f) * POSITION_STEPS + 0.5f);
+        }
+
+        float fromUnorm(uint16_t value, float low, float extent)
+        {
+            return low + value / POSITION_STEPS * extent;
+        }
+
+        float fromSnorm(int16_t value)
+        {
+            // like D3D, both -32768 and -32767 are -1
+            float f = value / SNORM_STEPS;
+            return f < -1.f ? -1.f : f;
+        }
+
+        // the octahedron point of a direction, both in [-1, 1]
+        void foldOctahedral(Vector const & direction, float & u, float & v)
+        {
+            float l1 = fabsf(direction.x) + fabsf(direction.y) + fabsf(direction.z);
+            u = direction.x / l1;
+            v = direction.y / l1;
+            if (direction.z < 0.f)
+            {
+                float x = u;
+                u = (1.f - fabsf(v)) * signNotZero(x);
+                v = (1.f - fabsf(x)) * signNotZero(v);
+            }
+        }
+
+        Vector decode(int16_t const encoded[2])
+        {
+            Vector v;
+            decodeOctahedral(encoded, &v.x);
+            return v;
+        }
+
+        void encode(Vector const & direction, int16_t encoded[2])
+        {
+            encodeOctahedral(&direction.x, encoded);
+        }
+    }
+
+    void encodeOctahedral(float const input[3], int16_t encoded[2])
+    {
+        Vector direction = makeVector(input[0], input[1], input[2]);
+        if (length(direction) <= 0.f)
+            direction = makeVector(0.f, 0.f, 1.f);
+        direction = normalized(direction);
+
+        float u, v;
+        foldOctahedral(direction, u, v);
+
+        // rounding both isn't always closest on the sphere, try every way of rounding
+        float lowU = floorf(clamp(u, -1.f, 1.f) * SNORM_STEPS), lowV = floorf(clamp(v, -1.f, 1.f) * SNORM_STEPS);
+        float best = -2.f;
+        for (int i = 0; i < 4; i++)
+        {
+            int16_t candidate[2] = {
+                (int16_t)clamp(lowU + (i & 1), -SNORM_STEPS, SNORM_STEPS),
+                (int16_t)clamp(lowV + (i >> 1), -SNORM_STEPS, SNORM_STEPS)
+            };
+            Vector decoded = decode(candidate);
+            float dot = decoded.x * direction.x + decoded.y * direction.y + decoded.z * direction.z;
+            if (dot > best)
+            {
+                best = dot;
+                encoded[0] = candidate[0];
+                encoded[1] = candidate[1];
+            }
+        }
+    }
+
+    void decodeOctahedral(int16_t const encoded[2], float output[3])
+    {
+        float u = fromSnorm(encoded[0]), v = fromSnorm(encoded[1]);
+        Vector direction = makeVector(u, v, 1.f - fabsf(u) - fabsf(v));
+
+        // the lower half is folded out over the corners
+        float t = clamp(-direction.z, 0.f, 1.f);
+        direction.x += direction.x >= 0.f ? -t : t;
+        direction.y += direction.y >= 0.f ? -t : t;
+
+        direction = normalized(direction);
+        output[0] = direction.x;
+        output[1] = direction.y;
+        output[2] = direction.z;
+    }
+
+    uint16_t floatToHalf(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+        uint32_t exponent = (bits >> 23) & 0xff;
+        uint32_t mantissa = bits & 0x7fffff;
+
+        if (exponent == 0xff)
+            return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+        int32_t halfExponent = (int32_t)exponent - 127 + 15;
+        if (halfExponent >= 31)
+            return sign | 0x7c00;
+
+        if (halfExponent <= 0)
+        {
+            // subnormal, or too small for even that
+            if (halfExponent < -10)
+                return sign;
+
+            mantissa |= 0x800000;
+            uint32_t shift = (uint32_t)(14 - halfExponent);
+            uint32_t half = mantissa >> shift;
+            uint32_t rest = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1)))
+                half++;
+            return sign | (uint16_t)half;
+        }
+
+        uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+        uint32_t rest = mantissa & 0x1fff;
+        // a carry out of the mantissa goes into the exponent, up to infinity
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+            half++;
+        return sign | (uint16_t)half;
+    }
+
+    float halfToFloat(uint16_t value)
+    {
+        uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+        uint32_t exponent = (value >> 10) & 0x1f;
+        uint32_t mantissa = value & 0x3ff;
+
+        uint32_t bits;
+        if (exponent == 0x1f)
+        {
+            bits = sign | 0x7f800000 | (mantissa << 13);
+        }
+        else if (exponent == 0)
+        {
+            float f = mantissa * HALF_SMALLEST_STEP;
+            return sign ? -f : f;
+        }
+        else
+        {
+            bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+        }
+
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    void compressVertices(FloatVertex const * vertices, uint32_t count, float const boundsMin[3], float const boundsMax[3], CompressedVertex * compressed)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            FloatVertex const & vertex = vertices[i];
+            CompressedVertex & out = compressed[i];
+
+            for (int axis = 0; axis < 3; axis++)
+                out.position[axis] = toUnorm(vertex.position[axis], boundsMin[axis], boundsMax[axis] - boundsMin[axis]);
+            out.position[3] = 0;
+
+            encodeOctahedral(vertex.normal, out.normal);
+            encode(fromXY(vertex.tangent), out.tangent);
+            encode(fromXY(vertex.biTangent), out.biTangent);
+
+            out.uv[0] = floatToHalf(vertex.uv[0]);
+            out.uv[1] = floatToHalf(vertex.uv[1]);
+        }
+    }
+
+    FloatVertex decompressVertex(CompressedVertex const & compressed, float const boundsMin[3], float const boundsMax[3])
+    {
+        FloatVertex vertex;
+        for (int axis = 0; axis < 3; axis++)
+            vertex.position[axis] = fromUnorm(compressed.position[axis], boundsMin[axis], boundsMax[axis] - boundsMin[axis]);
+        decodeOctahedral(compressed.normal, vertex.normal);
+
+        Vector tangent = decode(compressed.tangent);
+        Vector biTangent = decode(compressed.biTangent);
+        vertex.tangent[0] = tangent.x;
+        vertex.tangent[1] = tangent.y;
+        vertex.biTangent[0] = biTangent.x;
+        vertex.biTangent[1] = biTangent.y;
+
+        vertex.uv[0] = halfToFloat(compressed.uv[0]);
+        vertex.uv[1] = halfToFloat(compressed.uv[1]);
+        return vertex;
+    }
+
+    VertexCompressionError measureCompressionError(FloatVertex const * vertices, uint32_t count, float const boundsMin[3], float const boundsMax[3])
+    {
+        VertexCompressionError error = {};
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            FloatVertex const & vertex = vertices[i];
+            CompressedVertex compressed;
+            compressVertices(&vertex, 1, boundsMin, boundsMax, &compressed);
+            FloatVertex decompressed = decompressVertex(compressed, boundsMin, boundsMax);
+
+            for (int axis = 0; axis < 3; axis++)
+                error.position = fmaxf(error.position, fabsf(decompressed.position[axis] - vertex.position[axis]));
+
+            // a zero normal has no direction to lose
+            Vector normal = makeVector(vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+            if (length(normal) > 0.f)
+                error.normal = fmaxf(error.normal, angle(normalized(normal), decode(compressed.normal)));
+            error.tangent = fmaxf(error.tangent, angle(fromXY(vertex.tangent), decode(compressed.tangent)));
+            error.biTangent = fmaxf(error.biTangent, angle(fromXY(vertex.biTangent), decode(compressed.biTangent)));
+
+            error.uv = fmaxf(error.uv, fabsf(decompressed.uv[0] - vertex.uv[0]));
+            error.uv = fmaxf(error.uv, fabsf(decompressed.uv[1] - vertex.uv[1]));
+        }
+
+        return error;
+    }
+
+    VertexCompressionError getCompressionErrorBound(FloatVertex const * vertices, uint32_t count, float const boundsMin[3], float const boundsMax[3])
+    {
+        float extent = 0.f, magnitude = 0.f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            extent = fmaxf(extent, boundsMax[axis] - boundsMin[axis]);
+            magnitude = fmaxf(magnitude, fmaxf(fabsf(boundsMin[axis]), fabsf(boundsMax[axis])));
+        }
+
+        float uv = 0.f;
+        for (uint32_t i = 0; i < count; i++)
+            uv = fmaxf(uv, fmaxf(fabsf(vertices[i].uv[0]), fabsf(vertices[i].uv[1])));
+
+        VertexCompressionError bound;
+        // half a step, and what float rounding adds to the decode
+        bound.position = extent / POSITION_STEPS * 0.5f + (extent + magnitude) * 4.f * 1.2e-7f;
+        bound.normal = OCTAHEDRAL_MAX_ERROR;
+        bound.tangent = OCTAHEDRAL_MAX_ERROR;
+        bound.biTangent = OCTAHEDRAL_MAX_ERROR;
+        bound.uv = uv * HALF_RELATIVE_ERROR + HALF_SMALLEST_STEP;
+        return bound;
+    }
+}
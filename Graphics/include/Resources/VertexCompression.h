@@ -0,0 +1,74 @@
+#pragma once
+#include <stdint.h>
+
+namespace Graphics
+{
+    /*
+        The vertex in the vertex buffers, 24 bytes instead of the 48 of a
+        Vertex. COMPRESSED_VERTEX_DESC in Datatypes.h is its input layout.
+
+        Positions are 16 bit fractions of the mesh bounding box, the vertex
+        shader gets the box with every draw. A position is off by at most
+        half a step, the size of the box / 65535 / 2 on every axis.
+
+        Normals, tangents and bitangents are unit vectors folded onto an
+        octahedron and stored as two 16 bit signed fractions. Of the four
+        closest encodings the one that decodes nearest the original is
+        kept. A Vertex only has x and y of the tangents, z is the positive
+        one that makes them unit length, like the shader always assumed.
+
+        UVs are half floats, 11 significant bits.
+
+        measureCompressionError and getCompressionErrorBound are for
+        checking the compression against the models, the tests do it for
+        every model in Resources/Models. Plain floats, no D3D, a Vertex is
+        passed as the FloatVertex with the same layout.
+
+        HOW TO USE:
+            std::vector<CompressedVertex> compressed(count);
+            compressVertices((FloatVertex const *)vertices, count, &boundsMin.x, &boundsMax.x, compressed.data());
+            FloatVertex vertex = decompressVertex(compressed[0], &boundsMin.x, &boundsMax.x);
+    */
+    struct FloatVertex
+    {
+        float position[3];
+        float normal[3];
+        float uv[2];
+        float biTangent[2];     // x and y, z is the positive one
+        float tangent[2];       // x and y
+    };
+
+    struct CompressedVertex
+    {
+        uint16_t position[4];   // UNORM within the bounds, w is always 0
+        int16_t normal[2];      // SNORM, octahedral
+        uint16_t uv[2];         // half
+        int16_t biTangent[2];   // SNORM, octahedral
+        int16_t tangent[2];     // SNORM, octahedral
+    };
+
+    // largest difference between a FloatVertex and its compressed version, per attribute
+    struct VertexCompressionError
+    {
+        float position;     // on any axis, mesh units
+        float normal;       // angle in radians
+        float tangent;      // angle in radians, of the reconstructed vectors
+        float biTangent;
+        float uv;           // on either axis
+    };
+
+    void compressVertices(FloatVertex const * vertices, uint32_t count, float const boundsMin[3], float const boundsMax[3], CompressedVertex * compressed);
+    FloatVertex decompressVertex(CompressedVertex const & compressed, float const boundsMin[3], float const boundsMax[3]);
+
+    // direction doesn't have to be unit length, zero comes back as +z
+    void encodeOctahedral(float const direction[3], int16_t encoded[2]);
+    void decodeOctahedral(int16_t const encoded[2], float direction[3]);
+
+    // round to nearest even, out of range is infinity
+    uint16_t floatToHalf(float value);
+    float halfToFloat(uint16_t value);
+
+    VertexCompressionError measureCompressionError(FloatVertex const * vertices, uint32_t count, float const boundsMin[3], float const boundsMax[3]);
+    // what measureCompressionError should stay within for these vertices
+    VertexCompressionError getCompressionErrorBound(FloatVertex const * vertices, uint32_t count, float const boundsMin[3], float const boundsMax[3]);
+}
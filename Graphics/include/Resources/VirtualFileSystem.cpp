@@ -0,0 +1,243 @@
+#include "VirtualFileSystem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Graphics
+{
+    namespace
+    {
+        std::string getTempFolder()
+        {
+#ifdef _WIN32
+            char folder[MAX_PATH + 1];
+            DWORD length = GetTempPathA(sizeof(folder), folder);
+            return length > 0 && length < sizeof(folder) ? std::string(folder, length) : std::string();
+#else
+            const char * folder = getenv("TMPDIR");
+            return std::string(folder && *folder ? folder : "/tmp") + "/";
+#endif
+        }
+    }
+
+    VirtualFileSystem & VirtualFileSystem::singleton()
+    {
+        static VirtualFileSystem instance;
+        return instance;
+    }
+
+    VirtualFileSystem::VirtualFileSystem()
+    {
+        view = nullptr;
+        viewSize = 0;
+        file = nullptr;
+        mapping = nullptr;
+        extractFolder = getTempFolder();
+#ifdef DEBUG
+        looseOverride = true;
+#else
+        looseOverride = false;
+#endif
+    }
+
+    VirtualFileSystem::~VirtualFileSystem()
+    {
+        unmount();
+    }
+
+    bool VirtualFileSystem::mount(std::string const & archivePath)
+    {
+        unmount();
+
+#ifdef _WIN32
+        HANDLE fileHandle = CreateFileA(archivePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        HANDLE mappingHandle = nullptr;
+        if (GetFileSizeEx(fileHandle, &fileSize) && fileSize.QuadPart > 0)
+            mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        const char * mapped = mappingHandle ? (const char *)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!mapped)
+        {
+            if (mappingHandle)
+                CloseHandle(mappingHandle);
+            CloseHandle(fileHandle);
+            return false;
+        }
+
+        file = fileHandle;
+        mapping = mappingHandle;
+        view = mapped;
+        viewSize = (size_t)fileSize.QuadPart;
+#else
+        int descriptor = open(archivePath.c_str(), O_RDONLY);
+        if (descriptor < 0)
+            return false;
+
+        struct stat info;
+        void * mapped = MAP_FAILED;
+        if (fstat(descriptor, &info) == 0 && info.st_size > 0)
+            mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        if (mapped == MAP_FAILED)
+        {
+            ::close(descriptor);
+            return false;
+        }
+
+        file = (void *)(intptr_t)descriptor;
+        view = (const char *)mapped;
+        viewSize = (size_t)info.st_size;
+#endif
+
+        if (!archive.open(view, viewSize))
+        {
+            unmount();
+            return false;
+        }
+
+        return true;
+    }
+
+    void VirtualFileSystem::unmount()
+    {
+        archive.close();
+
+        {
+            std::lock_guard<std::mutex> lock(extractMutex);
+            extracted.clear();
+        }
+
+        if (!view)
+            return;
+
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+        CloseHandle((HANDLE)mapping);
+        CloseHandle((HANDLE)file);
+#else
+        munmap((void *)view, viewSize);
+        ::close((int)(intptr_t)file);
+#endif
+
+        view = nullptr;
+        viewSize = 0;
+        file = nullptr;
+        mapping = nullptr;
+    }
+
+    bool VirtualFileSystem::isMounted() const
+    {
+        return archive.isOpen();
+    }
+
+    void VirtualFileSystem::setLooseOverride(bool looseOverride)
+    {
+        this->looseOverride = looseOverride;
+    }
+
+    void VirtualFileSystem::setExtractFolder(std::string const & folder)
+    {
+        std::lock_guard<std::mutex> lock(extractMutex);
+        extractFolder = folder;
+        if (!extractFolder.empty() && extractFolder.back() != '/' && extractFolder.back() != '\\')
+            extractFolder += '/';
+        extracted.clear();
+    }
+
+    bool VirtualFileSystem::exists(std::string const & path) const
+    {
+        return findEntry(path) || isLooseFile(path);
+    }
+
+    bool VirtualFileSystem::read(std::string const & path, std::vector<char> & bytes) const
+    {
+        if (looseOverride && readLooseFile(path, bytes))
+            return true;
+
+        const AssetArchive::Entry * entry = findEntry(path);
+        if (entry)
+            return archive.read(*entry, bytes);
+
+        return !looseOverride && readLooseFile(path, bytes);
+    }
+
+    bool VirtualFileSystem::read(std::string const & path, std::string & text) const
+    {
+        std::vector<char> bytes;
+        if (!read(path, bytes))
+            return false;
+
+        text.assign(bytes.begin(), bytes.end());
+        return true;
+    }
+
+    bool VirtualFileSystem::getLocalPath(std::string const & path, std::string & localPath)
+    {
+        const AssetArchive::Entry * entry = findEntry(path);
+        if (!entry || (looseOverride && isLooseFile(path)))
+        {
+            localPath = path;
+            return isLooseFile(path);
+        }
+
+        // the hash keeps files with the same name in different folders apart
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "%016llx-", (unsigned long long)entry->hash);
+        std::string name = archive.getName(*entry);
+
+        std::lock_guard<std::mutex> lock(extractMutex);
+        localPath = extractFolder + prefix + name.substr(name.find_last_of('/') + 1);
+
+        // written again every run, the archive could have changed since the last one
+        if (extracted.count(localPath))
+            return true;
+
+        std::vector<char> bytes;
+        if (!archive.read(*entry, bytes))
+            return false;
+
+        std::ofstream output(localPath, std::ios::binary | std::ios::trunc);
+        if (!output || !output.write(bytes.data(), bytes.size()))
+            return false;
+
+        extracted.insert(localPath);
+        return true;
+    }
+
+    const AssetArchive::Entry * VirtualFileSystem::findEntry(std::string const & path) const
+    {
+        return archive.isOpen() ? archive.find(path) : nullptr;
+    }
+
+    bool VirtualFileSystem::isLooseFile(std::string const & path)
+    {
+        return (bool)std::ifstream(path, std::ios::binary);
+    }
+
+    bool VirtualFileSystem::readLooseFile(std::string const & path, std::vector<char> & bytes)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+
+        std::streamoff size = file.tellg();
+        if (size < 0)
+            return false;
+
+        bytes.resize((size_t)size);
+        file.seekg(0);
+        return size == 0 || (bool)file.read(bytes.data(), size);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include "AssetArchive.h"
+
+namespace Graphics
+{
+    /*
+        Where the game reads its resources from. A mounted archive is mapped
+        into memory once, reading a file out of it is a copy (or an LZ4
+        decompress) and no file system calls.
+
+        Files that aren't in the archive, or everything when nothing is
+        mounted, are read loose like before. With loose override on (the
+        default in DEBUG builds) loose files are looked for first, so an edited
+        shader or texture is picked up without packing the archive again.
+
+        Everything but mount and unmount can be called from any thread, the
+        asset loader workers read through it.
+
+        HOW TO USE:
+            VirtualFileSystem::singleton().mount(ASSET_ARCHIVE_PATH);
+            std::vector<char> bytes;
+            VirtualFileSystem::singleton().read("Resources/Models/sphere.brf", bytes);
+    */
+    class VirtualFileSystem
+    {
+    public:
+        static VirtualFileSystem & singleton();
+
+        VirtualFileSystem();
+        ~VirtualFileSystem();
+
+        // false if the archive is missing or broken, files are then only read loose
+        bool mount(std::string const & archivePath);
+        void unmount();
+        bool isMounted() const;
+
+        void setLooseOverride(bool looseOverride);
+        // where getLocalPath puts files from the archive, the temp folder by default
+        void setExtractFolder(std::string const & folder);
+
+        bool exists(std::string const & path) const;
+        bool read(std::string const & path, std::vector<char> & bytes) const;
+        bool read(std::string const & path, std::string & text) const;
+
+        // A file on disk with the contents of path, for libraries that only open
+        // files by name. Loose files are given as they are, archived ones are
+        // written to the extract folder the first time they are asked for
+        bool getLocalPath(std::string const & path, std::string & localPath);
+    private:
+        AssetArchive archive;
+        bool looseOverride;
+
+        // the mapping, HANDLEs on Windows and a file descriptor elsewhere
+        const char * view;
+        size_t viewSize;
+        void * file;
+        void * mapping;
+
+        std::mutex extractMutex;
+        std::string extractFolder;
+        std::set<std::string> extracted;
+
+        const AssetArchive::Entry * findEntry(std::string const & path) const;
+        static bool isLooseFile(std::string const & path);
+        static bool readLooseFile(std::string const & path, std::vector<char> & bytes);
+    };
+}
@@ -1,19 +1,42 @@
 #include "SkyRenderer.h"
-#include <Engine\Constants.h>
-#include <DDSTextureLoader.h>
-#include "ThrowIfFailed.h"
+#include <Engine/Constants.h>
+#include "Resources/TextureManager.h"
 
+#define SHADOW_NORMAL_OFFSET 1.5f // texels, the receiver is moved along the normal to avoid acne
 
 using namespace DirectX::SimpleMath;
 
-SkyRenderer::SkyRenderer(ID3D11Device * device, int shadowRes) :
-	shader(device, SHADER_PATH("SkyShader.hlsl"), { { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 } }),
+SkyRenderer::SkyRenderer(Graphics::RenderDevice * device, int shadowRes) :
+	shader(device, SHADER_PATH("SkyShader.hlsl"), { { "POSITION", 0, Graphics::FORMAT_R32G32B32_FLOAT, 0, 0 } }),
+	shadowDepthStencil(device, shadowRes, shadowRes, SHADOW_CASCADES),
+	cascades(SHADOW_CASCADES, shadowRes),
+	cascadeBuffer(device),
+	casterBuffer(device),
 	cube(device),
-	shadowDepthStencil(device, SHADOW_MAP_RESOLUTION, SHADOW_MAP_RESOLUTION),
-	sun(device, shadowRes, shadowRes)
+	sun(device)
 {
-	ThrowIfFailed(DirectX::CreateDDSTextureFromFile(device, TEXTURE_PATH("skyBox.dds"), nullptr, &srv));
+	//Without the texture the sky is drawn black
+	if (!Graphics::TextureManager::createTextureFromFile(device, TEXTURE_PATH_SIMPLE "skyBox.dds", false, &srv))
+		srv = nullptr;
 	createSampler(device);
+
+	static_assert(SHADOW_CASCADES <= Graphics::ShadowCascades::MAX_CASCADES, "Too many shadow cascades");
+	UINT intervals[SHADOW_CASCADES] = SHADOW_CASCADE_INTERVALS;
+	for (UINT i = 0; i < SHADOW_CASCADES; i++)
+		cascades.setUpdateInterval(i, intervals[i]);
+
+	cascades.setShadowDistance(SHADOW_DISTANCE);
+	cascades.setCasterDistance(SHADOW_CASTER_DISTANCE);
+	cascades.setSplitLambda(SHADOW_SPLIT_LAMBDA);
+
+	updatedCascades = 0;
+	frame = 0;
+	cascadeData = {};
+
+	shadowViewPort = {};
+	shadowViewPort.width = (float)shadowRes;
+	shadowViewPort.height = (float)shadowRes;
+	shadowViewPort.maxDepth = 1.f;
 }
 
 SkyRenderer::~SkyRenderer()
@@ -22,17 +45,17 @@ SkyRenderer::~SkyRenderer()
 	SAFE_RELEASE(srv);
 }
 
-void SkyRenderer::renderSky(ID3D11DeviceContext * context, Graphics::Camera * cam)
+void SkyRenderer::renderSky(Graphics::RenderDevice * context, Graphics::Camera * cam)
 {
 	static UINT stride = sizeof(DirectX::SimpleMath::Vector3), offset = 0;
 
 	context->IASetInputLayout(shader);
 	context->IASetVertexBuffers(0, 1, &cube.vertexBuffer, &stride, &offset);
-	context->VSSetShader(shader, nullptr, 0);
-	context->PSSetShader(shader, nullptr, 0);
+	context->VSSetShader(shader);
+	context->PSSetShader(shader);
 	context->PSSetShaderResources(0, 1, &srv);
 	
-	ID3D11Buffer * buffers[] =
+	Graphics::GpuBuffer * buffers[] =
 	{
 		cam->getBuffer(),
 		cube.transformBuffer
@@ -40,7 +63,7 @@ void SkyRenderer::renderSky(ID3D11DeviceContext * context, Graphics::Camera * ca
 
 	context->VSSetConstantBuffers(0, 2, buffers);
 
-	ID3D11Buffer * temp = sun.getShaderBuffer();
+	Graphics::GpuBuffer * temp = sun.getShaderBuffer();
 
 	context->PSSetConstantBuffers(2, 1, &temp);
 
@@ -48,7 +71,7 @@ void SkyRenderer::renderSky(ID3D11DeviceContext * context, Graphics::Camera * ca
 	context->Draw(36, 0);
 }
 
-void SkyRenderer::update(ID3D11DeviceContext * context, float deltaTime, Vector3 pos)
+void SkyRenderer::update(Graphics::RenderDevice * context, float deltaTime, Vector3 pos)
 {
 	float radiansPerSecond = 0.01745 * deltaTime * 0.005f;
 
@@ -57,45 +80,55 @@ void SkyRenderer::update(ID3D11DeviceContext * context, float deltaTime, Vector3
 
 	Matrix temp = Matrix::CreateTranslation(pos);
 
-	D3D11_MAPPED_SUBRESOURCE data = {};
+	memcpy(context->Map(cube.transformBuffer, sizeof(Matrix)), &temp, sizeof(Matrix));
 
-	context->Map(cube.transformBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &data);
+	context->Unmap(cube.transformBuffer);
+}
 
-	memcpy(data.pData, &temp, sizeof(Matrix));
+void SkyRenderer::updateShadows(Graphics::RenderDevice * context, Graphics::Camera * cam)
+{
+	Matrix view = cam->getView();
+	Matrix projection = cam->getProj();
+	Vector3 direction = sun.getDirection();
+
+	updatedCascades = cascades.update(&view._11, &projection._11, &direction.x, frame++);
+
+	for (UINT i = 0; i < SHADOW_CASCADES; i++)
+	{
+		Graphics::ShadowCascades::Cascade const & cascade = cascades.getCascade(i);
+		memcpy(&cascadeData.viewProjection[i], cascade.viewProjection, sizeof(Matrix));
+		(&cascadeData.normalOffsets.x)[i] = cascade.texelSize * SHADOW_NORMAL_OFFSET;
+	}
 
-	context->Unmap(cube.transformBuffer, 0);
+	cascadeBuffer.write(context, &cascadeData, sizeof(cascadeData));
 }
 
-void SkyRenderer::drawShadows(ID3D11DeviceContext * context, Graphics::Shader * shader)
+void SkyRenderer::drawShadows(Graphics::RenderDevice * context, Graphics::Shader * shader, UINT cascade)
 {
-	context->ClearDepthStencilView(shadowDepthStencil, D3D11_CLEAR_DEPTH, 1.f, 0);
+	Graphics::DepthStencilView * slice = shadowDepthStencil.getBuffer(cascade);
+	context->ClearDepthStencilView(slice, Graphics::CLEAR_DEPTH, 1.f, 0);
 
-	context->RSSetViewports(1, &sun.getViewPort());
+	context->RSSetViewports(1, &shadowViewPort);
 	context->IASetInputLayout(*shader);
-	context->VSSetShader(*shader, nullptr, 0);
-	context->PSSetShader(nullptr, nullptr, 0);
-	context->OMSetRenderTargets(0, nullptr, shadowDepthStencil);
+	context->VSSetShader(*shader);
+	context->PSSetShader(nullptr);
+	context->OMSetRenderTargets(0, nullptr, slice);
 
-	ID3D11Buffer* light = sun.getMatrixBuffer();
-	context->VSSetConstantBuffers(0, 1, &light);
+	casterBuffer.write(context, &cascadeData.viewProjection[cascade], sizeof(Matrix));
+	context->VSSetConstantBuffers(0, 1, casterBuffer);
 }
 
-void SkyRenderer::createSampler(ID3D11Device * device)
+void SkyRenderer::createSampler(Graphics::RenderDevice * device)
 {
-	D3D11_SAMPLER_DESC sDesc = {};
-	sDesc.AddressU = D3D11_TEXTURE_ADDRESS_BORDER;
-	sDesc.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
-	sDesc.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
-	sDesc.BorderColor[0] = 1;
-	sDesc.BorderColor[1] = 1;
-	sDesc.BorderColor[2] = 1;
-	sDesc.BorderColor[3] = 1;
-	sDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
-	sDesc.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_MIP_LINEAR;
-	sDesc.MaxAnisotropy = 0;
-	sDesc.MinLOD = 0;
-	sDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	sDesc.MipLODBias = 0;
-
-	ThrowIfFailed(device->CreateSamplerState(&sDesc, &shadowSampler));
+	Graphics::SamplerDesc sDesc = {};
+	sDesc.address = Graphics::ADDRESS_BORDER;
+	sDesc.borderColor[0] = 1;
+	sDesc.borderColor[1] = 1;
+	sDesc.borderColor[2] = 1;
+	sDesc.borderColor[3] = 1;
+	sDesc.comparison = Graphics::COMPARISON_LESS_EQUAL;
+	sDesc.filter = Graphics::FILTER_COMPARISON_MIN_MAG_MIP_LINEAR;
+	sDesc.maxAnisotropy = 0;
+
+	shadowSampler = device->CreateSamplerState(sDesc);
 }
\ No newline at end of file
@@ -1,33 +1,48 @@
 #pragma once
-#include "Resources\Shader.h"
+#include "Resources/Shader.h"
 #include "Camera.h"
-#include "Lights\Sun.h"
-#include "Utility\DepthStencil.h"
-#define SHADOW_MAP_RESOLUTION 2048
+#include "Lights/Sun.h"
+#include "Lights/ShadowCascades.h"
+#include "Utility/DepthStencil.h"
+#include "Utility/ConstantBuffer.h"
+#define SHADOW_MAP_RESOLUTION 1024          // per cascade
+#define SHADOW_CASCADES 4                   // ForwardPlus.hlsl has the same
+#define SHADOW_DISTANCE 80.f                // the last cascade ends here
+#define SHADOW_CASTER_DISTANCE 100.f        // how far toward the sun casters are kept
+#define SHADOW_SPLIT_LAMBDA 0.75f           // 0 is uniform splits, 1 is logarithmic
+#define SHADOW_CASCADE_INTERVALS { 1, 1, 2, 4 } // frames between updates of each cascade
 
 class SkyRenderer
 {
 public:
-	SkyRenderer(ID3D11Device * device, int shadowRes);
+	SkyRenderer(Graphics::RenderDevice * device, int shadowRes);
 	~SkyRenderer();
 
-	void renderSky(ID3D11DeviceContext * context, Graphics::Camera * cam);
-	void update(ID3D11DeviceContext * context, float deltaTime, DirectX::SimpleMath::Vector3 pos);
+	void renderSky(Graphics::RenderDevice * context, Graphics::Camera * cam);
+	void update(Graphics::RenderDevice * context, float deltaTime, DirectX::SimpleMath::Vector3 pos);
 
-	ID3D11Buffer* getLightMatrixBuffer() { return sun.getMatrixBuffer(); };
-	ID3D11Buffer* getShaderBuffer() { return sun.getShaderBuffer(); };
-	D3D11_VIEWPORT getViewPort() { return sun.getViewPort(); };
+	//Fits the cascades to the camera, once per frame before the shadows are drawn
+	void updateShadows(Graphics::RenderDevice * context, Graphics::Camera * cam);
+
+	Graphics::GpuBuffer* getShaderBuffer() { return sun.getShaderBuffer(); };
+	//The cascade matrices for the shaders sampling the shadows
+	Graphics::GpuBuffer* getCascadeBuffer() { return cascadeBuffer; };
 	Graphics::DepthStencil * getDepthStencil() { return &this->shadowDepthStencil; };
-	ID3D11SamplerState * getSampler() { return this->shadowSampler; };
+	Graphics::SamplerState * getSampler() { return this->shadowSampler; };
+
+	Graphics::ShadowCascades const & getCascades() const { return cascades; };
+	//A bit for every cascade updateShadows fitted this frame, the others keep what they had
+	uint32_t getUpdatedCascades() const { return updatedCascades; };
 
-	void drawShadows(ID3D11DeviceContext * context, Graphics::Shader * shader);
+	//Does not draw anything, it sets up everything for drawing the casters of one cascade
+	void drawShadows(Graphics::RenderDevice * context, Graphics::Shader * shader, UINT cascade);
 
 private:
 	struct  SkyCube
 	{
-		ID3D11Buffer * vertexBuffer;
-		ID3D11Buffer * transformBuffer;
-		SkyCube(ID3D11Device * device)
+		Graphics::GpuBuffer * vertexBuffer;
+		Graphics::GpuBuffer * transformBuffer;
+		SkyCube(Graphics::RenderDevice * device)
 		{
 			DirectX::SimpleMath::Vector3 vertices[] =
 			{
@@ -75,22 +90,19 @@ private:
 				 {  1, -1,  1}			
 			};
 
-			D3D11_SUBRESOURCE_DATA subData = {};
-			subData.pSysMem = vertices;
+			Graphics::BufferDesc desc = {};
+			desc.byteWidth = sizeof(vertices);
+			desc.usage = Graphics::USAGE_IMMUTABLE;
+			desc.bindFlags = Graphics::BIND_VERTEX_BUFFER;
 
-			D3D11_BUFFER_DESC desc = { 0 };
-			desc.ByteWidth = sizeof(vertices);
-			desc.Usage = D3D11_USAGE_IMMUTABLE;
-			desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+			vertexBuffer = device->CreateBuffer(desc, vertices);
 
-			device->CreateBuffer(&desc, &subData, &vertexBuffer);
+			desc.byteWidth = sizeof(DirectX::SimpleMath::Matrix);
+			desc.usage = Graphics::USAGE_DYNAMIC;
+			desc.cpuAccessFlags = Graphics::CPU_ACCESS_WRITE;
+			desc.bindFlags = Graphics::BIND_CONSTANT_BUFFER;
 
-			desc.ByteWidth = sizeof(DirectX::SimpleMath::Matrix);
-			desc.Usage = D3D11_USAGE_DYNAMIC;
-			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-			desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-
-			device->CreateBuffer(&desc, NULL, &transformBuffer);
+			transformBuffer = device->CreateBuffer(desc, NULL);
 		}
 
 		~SkyCube()
@@ -101,14 +113,29 @@ private:
 	};
 
 	Graphics::Shader shader;
-	ID3D11ShaderResourceView * srv;
+	Graphics::ShaderResourceView * srv;
 	Graphics::DepthStencil shadowDepthStencil;
-	ID3D11SamplerState* shadowSampler;
+	Graphics::SamplerState* shadowSampler;
+
+	//Same layout as the ShadowCascades cbuffer in ForwardPlus.hlsl
+	struct CascadeData
+	{
+		DirectX::SimpleMath::Matrix viewProjection[SHADOW_CASCADES];
+		DirectX::SimpleMath::Vector4 normalOffsets;
+	};
+
+	Graphics::ShadowCascades cascades;
+	uint32_t updatedCascades;
+	uint64_t frame;
+	CascadeData cascadeData;
+	ConstantBuffer<CascadeData> cascadeBuffer;
+	ConstantBuffer<DirectX::SimpleMath::Matrix> casterBuffer;
+	Graphics::Viewport shadowViewPort;
 
 
 	SkyCube cube;
 	Sun sun;
 
-	void createSampler(ID3D11Device * device);
+	void createSampler(Graphics::RenderDevice * device);
 
 };
\ No newline at end of file
@@ -1,10 +1,11 @@
 #pragma once
 
-#include <d3d11.h>
 #include <SimpleMath.h>
 #include <Engine/Constants.h>
 #include <vector>
 #include <string>
+#include "Resources/MeshLod.h"
+#include "Device/RenderDevice.h"
 
 #define AVG_TILE_LIGHTS 200
 #define BLOCK_SIZE 16
@@ -27,11 +28,18 @@ namespace Graphics
 	struct ModelInfo
 	{
 		size_t indexCount;
-        ID3D11Buffer * indexBuffer;
-        ID3D11Buffer * vertexBuffer;
-		ID3D11ShaderResourceView * diffuseMap;
-		ID3D11ShaderResourceView * normalMap;
-		ID3D11ShaderResourceView * specularMap;
+        GpuBuffer * indexBuffer;
+        GpuBuffer * vertexBuffer;
+		ShaderResourceView * diffuseMap;
+		ShaderResourceView * normalMap;
+		ShaderResourceView * specularMap;
+        const MeshLod * lods;   // lods[0] is the full mesh, indexCount is its count
+        int lodCount;
+        DirectX::SimpleMath::Vector3 boundsCenter;  // bounding sphere in mesh space
+        float boundsRadius;
+        DirectX::SimpleMath::Vector3 boundsMin;     // bounding box in mesh space
+        DirectX::SimpleMath::Vector3 boundsMax;
+        Format indexFormat;                         // R16 when the mesh has few enough vertices
 	};
 
 	struct RenderInfo
@@ -41,6 +49,8 @@ namespace Graphics
 		int materialId;
 		DirectX::SimpleMath::Matrix translation;
 		bool backFaceCulling = true;
+		int lod = 0;    // set by the renderer, kept so the next frame knows what was used
+		bool occluder = false;  // a solid box (the map), hides what is behind it from the occlusion culling
 	};
 
     struct RenderDebugInfo
@@ -48,11 +58,12 @@ namespace Graphics
         bool useDepth;
         DirectX::SimpleMath::Color color;
         std::vector<DirectX::SimpleMath::Vector3>* points;
-        D3D11_PRIMITIVE_TOPOLOGY topology;
+        PrimitiveTopology topology;
     };
 
 	// TODO: Change
 #define NUM_LIGHTS 8
+#define MAX_LIGHTS 1024 // clustered lighting, per frame
 
 	struct Light {
 		DirectX::SimpleMath::Vector4 positionVS;
@@ -1,10 +1,13 @@
 #pragma once
-#include <d3d11.h>
 #include "Datatypes.h"
+#include "Device/RenderDevice.h"
+#include "Resources/VertexCompression.h"
 struct  TempCube
 {
-    ID3D11Buffer * vertexBuffer;
-    TempCube(ID3D11Device * device)
+    Graphics::GpuBuffer * vertexBuffer;
+    DirectX::SimpleMath::Vector3 boundsMin;
+    DirectX::SimpleMath::Vector3 boundsMax;
+    TempCube(Graphics::RenderDevice * device)
     {
         Vertex vertices[] =
         {
@@ -52,15 +55,18 @@ struct  TempCube
             { {  0.5, -0.5,  0.5 * -1 },		{ 0, -1,  0 * -1 },		{ 1, 1 },		{ 1,0 },{ 0,1 } }
         };
 
-        D3D11_SUBRESOURCE_DATA subData = {};
-        subData.pSysMem = vertices;
+        // compressed like the meshes, the shader is the same
+        boundsMin = DirectX::SimpleMath::Vector3(-0.5f, -0.5f, -0.5f);
+        boundsMax = DirectX::SimpleMath::Vector3(0.5f, 0.5f, 0.5f);
+        Graphics::CompressedVertex compressed[sizeof(vertices) / sizeof(*vertices)];
+        Graphics::compressVertices((Graphics::FloatVertex const *)vertices, sizeof(vertices) / sizeof(*vertices), &boundsMin.x, &boundsMax.x, compressed);
 
-        D3D11_BUFFER_DESC desc = { 0 };
-        desc.ByteWidth = sizeof(vertices);
-        desc.Usage = D3D11_USAGE_IMMUTABLE;
-        desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        Graphics::BufferDesc desc = {};
+        desc.byteWidth = sizeof(compressed);
+        desc.usage = Graphics::USAGE_IMMUTABLE;
+        desc.bindFlags = Graphics::BIND_VERTEX_BUFFER;
 
-        device->CreateBuffer(&desc, &subData, &vertexBuffer);
+        vertexBuffer = device->CreateBuffer(desc, compressed);
     }
 
     ~TempCube()
@@ -1,33 +1,35 @@
 #pragma once
+#include "../Device/RenderDevice.h"
+#include <string.h>
 
 template<typename T, size_t size = 1>
 class ConstantBuffer
 {
 public:
-    ConstantBuffer(ID3D11Device * device);
+    ConstantBuffer(Graphics::RenderDevice * device);
     ~ConstantBuffer();
 
-    T* map(ID3D11DeviceContext * context);
-    void unmap(ID3D11DeviceContext * context);
-    void write(ID3D11DeviceContext * context, T* data, UINT size);
+    T* map(Graphics::RenderDevice * device);
+    void unmap(Graphics::RenderDevice * device);
+    void write(Graphics::RenderDevice * device, T* data, UINT bytes);
 
-    operator ID3D11Buffer*() { return cbuffer; }
-    operator ID3D11Buffer**() { return &cbuffer; }
+    operator Graphics::GpuBuffer*() { return cbuffer; }
+    operator Graphics::GpuBuffer**() { return &cbuffer; }
 
 private:
-    ID3D11Buffer * cbuffer;
+    Graphics::GpuBuffer * cbuffer;
 };
 
 template<typename T, size_t size>
-inline ConstantBuffer<T, size>::ConstantBuffer(ID3D11Device * device)
+inline ConstantBuffer<T, size>::ConstantBuffer(Graphics::RenderDevice * device)
 {
-    D3D11_BUFFER_DESC desc = {};
-    desc.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_CONSTANT_BUFFER;
-    desc.Usage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
-    desc.CPUAccessFlags = D3D11_CPU_ACCESS_FLAG::D3D11_CPU_ACCESS_WRITE;
-    desc.ByteWidth = max(sizeof(T) * size, 16);
+    Graphics::BufferDesc desc = {};
+    desc.bindFlags = Graphics::BIND_CONSTANT_BUFFER;
+    desc.usage = Graphics::USAGE_DYNAMIC;
+    desc.cpuAccessFlags = Graphics::CPU_ACCESS_WRITE;
+    desc.byteWidth = sizeof(T) * size > 16 ? (UINT)(sizeof(T) * size) : 16;
 
-    ThrowIfFailed(device->CreateBuffer(&desc, nullptr, &cbuffer));
+    cbuffer = device->CreateBuffer(desc, nullptr);
 }
 
 template<typename T, size_t size>
@@ -37,24 +39,20 @@ inline ConstantBuffer<T, size>::~ConstantBuffer()
 }
 
 template<typename T, size_t size>
-inline T * ConstantBuffer<T, size>::map(ID3D11DeviceContext * context)
+inline T * ConstantBuffer<T, size>::map(Graphics::RenderDevice * device)
 {
-    D3D11_MAPPED_SUBRESOURCE sub = {};
-    context->Map(cbuffer, 0, D3D11_MAP::D3D11_MAP_WRITE_DISCARD, 0, &sub);
-    return (T*)sub.pData;
+    return (T*)device->Map(cbuffer, sizeof(T) * size);
 }
 
 template<typename T, size_t size>
-inline void ConstantBuffer<T, size>::unmap(ID3D11DeviceContext * context)
+inline void ConstantBuffer<T, size>::unmap(Graphics::RenderDevice * device)
 {
-    context->Unmap(cbuffer, 0);
+    device->Unmap(cbuffer);
 }
 
 template<typename T, size_t size>
-inline void ConstantBuffer<T, size>::write(ID3D11DeviceContext * context, T * data, UINT size)
+inline void ConstantBuffer<T, size>::write(Graphics::RenderDevice * device, T * data, UINT bytes)
 {
-    D3D11_MAPPED_SUBRESOURCE sub = {};
-    context->Map(cbuffer, 0, D3D11_MAP::D3D11_MAP_WRITE_DISCARD, 0, &sub);
-    memcpy(sub.pData, data, size);
-    context->Unmap(cbuffer, 0);
+    memcpy(device->Map(cbuffer, bytes), data, bytes);
+    device->Unmap(cbuffer);
 }
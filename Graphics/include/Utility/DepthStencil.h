@@ -1,23 +1,28 @@
 #pragma once
-#include <d3d11.h>
+#include <vector>
+#include "../Device/RenderDevice.h"
 
 namespace Graphics
 {
     class DepthStencil
     {
     public:
-        DepthStencil(ID3D11Device * device, UINT width, UINT height);
+        // more than one slice makes a texture array, one view per slice and the resource sees all of them
+        DepthStencil(RenderDevice * device, UINT width, UINT height, UINT arraySize = 1);
         virtual ~DepthStencil();
 
-        inline ID3D11DepthStencilView * getBuffer() { return depthStencil; }
-        inline ID3D11ShaderResourceView * getResource() { return shaderResource; }
+        inline DepthStencilView * getBuffer() { return depthStencil; }
+        inline DepthStencilView * getBuffer(UINT slice) { return slices[slice]; }
+        inline ShaderResourceView * getResource() { return shaderResource; }
 
-        operator ID3D11DepthStencilView*() const { return depthStencil; }
-        operator ID3D11ShaderResourceView*() const { return shaderResource; }
+        operator DepthStencilView*() const { return depthStencil; }
+        operator ShaderResourceView*() const { return shaderResource; }
 
     private:
         
-        ID3D11DepthStencilView * depthStencil;
-        ID3D11ShaderResourceView * shaderResource;
+        DepthStencilView * depthStencil;
+        ShaderResourceView * shaderResource;
+
+        std::vector<DepthStencilView*> slices;
     };
 }
\ No newline at end of file
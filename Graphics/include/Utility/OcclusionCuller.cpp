@@ -0,0 +1,432 @@
+#include "OcclusionCuller.h"
+#include <xmmintrin.h>
+#include <math.h>
+#include <string.h>
+
+namespace Graphics
+{
+    namespace
+    {
+        // a * b, both row major 4x4
+        void multiply(const float a[16], const float b[16], float out[16])
+        {
+            for (int row = 0; row < 4; row++)
+            {
+                for (int column = 0; column < 4; column++)
+                {
+                    out[row * 4 + column] =
+                        a[row * 4] * b[column] +
+                        a[row * 4 + 1] * b[4 + column] +
+                        a[row * 4 + 2] * b[8 + column] +
+                        a[row * 4 + 3] * b[12 + column];
+                }
+            }
+        }
+
+        void boxCorners(const float boxMin[3], const float boxMax[3], float corners[8][3])
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                corners[i][0] = i & 1 ? boxMax[0] : boxMin[0];
+                corners[i][1] = i & 2 ? boxMax[1] : boxMin[1];
+                corners[i][2] = i & 4 ? boxMax[2] : boxMin[2];
+            }
+        }
+
+        // how far past the screen edges triangles are kept, in screen sizes
+        const float GUARD_BAND = 2.f;
+        // a triangle clipped by 5 planes
+        const int MAX_CLIPPED = 8;
+
+        // >= 0 on the inside of the plane, near plane first then the guard band
+        float clipDistance(const float v[4], int plane)
+        {
+            switch (plane)
+            {
+            case 0:  return v[2];
+            case 1:  return GUARD_BAND * v[3] + v[0];
+            case 2:  return GUARD_BAND * v[3] - v[0];
+            case 3:  return GUARD_BAND * v[3] + v[1];
+            default: return GUARD_BAND * v[3] - v[1];
+            }
+        }
+
+        // corners as boxCorners puts them
+        const uint32_t BOX_INDICES[36] =
+        {
+            0, 2, 1,  1, 2, 3,  // -z
+            4, 5, 6,  5, 7, 6,  // +z
+            0, 1, 4,  1, 5, 4,  // -y
+            2, 6, 3,  3, 6, 7,  // +y
+            0, 4, 2,  2, 4, 6,  // -x
+            1, 3, 5,  3, 7, 5   // +x
+        };
+    }
+
+    OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+    {
+        tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+        tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+        this->width = tilesX * TILE_SIZE;
+        this->height = tilesY * TILE_SIZE;
+
+        depth.resize(this->width * this->height, 1.f);
+        tiles.resize(tilesX * tilesY, 1.f);
+
+        memset(viewProjection, 0, sizeof(viewProjection));
+        triangleCount = 0;
+    }
+
+    OcclusionCuller::~OcclusionCuller()
+    {
+    }
+
+    void OcclusionCuller::clear(const float viewProjection[16])
+    {
+        memcpy(this->viewProjection, viewProjection, sizeof(this->viewProjection));
+
+        for (float & d : depth)
+            d = 1.f;
+        for (float & d : tiles)
+            d = 1.f;
+
+        triangleCount = 0;
+    }
+
+    void OcclusionCuller::addOccluder(const float world[16], const float boxMin[3], const float boxMax[3])
+    {
+        float corners[8][3];
+        boxCorners(boxMin, boxMax, corners);
+
+        addOccluderMesh(world, &corners[0][0], 8, BOX_INDICES, 36);
+    }
+
+    void OcclusionCuller::addOccluderMesh(const float world[16], const float * positions, size_t vertexCount, const uint32_t * indices, size_t indexCount)
+    {
+        transform(world, positions, vertexCount);
+
+        const float * clip = clipPositions.data();
+        for (size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            clipTriangle(clip + indices[i] * 4, clip + indices[i + 1] * 4, clip + indices[i + 2] * 4);
+        }
+    }
+
+    void OcclusionCuller::transform(const float world[16], const float * positions, size_t vertexCount)
+    {
+        float m[16];
+        multiply(world, viewProjection, m);
+
+        clipPositions.resize(vertexCount * 4);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const float * p = positions + i * 3;
+            for (int column = 0; column < 4; column++)
+            {
+                clipPositions[i * 4 + column] =
+                    p[0] * m[column] +
+                    p[1] * m[4 + column] +
+                    p[2] * m[8 + column] +
+                    m[12 + column];
+            }
+        }
+    }
+
+    void OcclusionCuller::clipTriangle(const float * a, const float * b, const float * c)
+    {
+        // against the near plane (z >= 0) and a guard band around the screen,
+        // so huge triangles like the ground don't lose their depth to rounding
+        float buffers[2][MAX_CLIPPED][4];
+        memcpy(buffers[0][0], a, sizeof(float) * 4);
+        memcpy(buffers[0][1], b, sizeof(float) * 4);
+        memcpy(buffers[0][2], c, sizeof(float) * 4);
+        int count = 3;
+        int current = 0;
+
+        for (int plane = 0; plane < 5; plane++)
+        {
+            float (*input)[4] = buffers[current];
+            float (*output)[4] = buffers[current ^ 1];
+            int outputCount = 0;
+
+            for (int i = 0; i < count; i++)
+            {
+                const float * from = input[i];
+                const float * to = input[(i + 1) % count];
+                float fromDistance = clipDistance(from, plane);
+                float toDistance = clipDistance(to, plane);
+
+                if (fromDistance >= 0.f)
+                    memcpy(output[outputCount++], from, sizeof(float) * 4);
+
+                if ((fromDistance >= 0.f) != (toDistance >= 0.f))
+                {
+                    float t = fromDistance / (fromDistance - toDistance);
+                    for (int axis = 0; axis < 4; axis++)
+                        output[outputCount][axis] = from[axis] + (to[axis] - from[axis]) * t;
+                    outputCount++;
+                }
+            }
+
+            count = outputCount;
+            current ^= 1;
+            if (count < 3)
+                return;
+        }
+
+        float screen[MAX_CLIPPED][3];
+        for (int i = 0; i < count; i++)
+        {
+            const float * v = buffers[current][i];
+            screen[i][0] = (v[0] / v[3] * 0.5f + 0.5f) * width;
+            screen[i][1] = (0.5f - v[1] / v[3] * 0.5f) * height;
+            screen[i][2] = v[2] / v[3];
+        }
+
+        for (int i = 1; i + 1 < count; i++)
+        {
+            float triangle[3][3];
+            memcpy(triangle[0], screen[0], sizeof(triangle[0]));
+            memcpy(triangle[1], screen[i], sizeof(triangle[1]));
+            memcpy(triangle[2], screen[i + 1], sizeof(triangle[2]));
+            drawTriangle(triangle);
+        }
+    }
+
+    void OcclusionCuller::drawTriangle(const float screen[3][3])
+    {
+        const float * v0 = screen[0];
+        const float * v1 = screen[1];
+        const float * v2 = screen[2];
+
+        float area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]);
+        if (fabsf(area) < 1e-6f)
+            return;
+
+        // the winding doesn't matter, turn it so the inside is positive
+        if (area < 0.f)
+        {
+            const float * swap = v1;
+            v1 = v2;
+            v2 = swap;
+            area = -area;
+        }
+
+        float minX = fminf(v0[0], fminf(v1[0], v2[0]));
+        float maxX = fmaxf(v0[0], fmaxf(v1[0], v2[0]));
+        float minY = fminf(v0[1], fminf(v1[1], v2[1]));
+        float maxY = fmaxf(v0[1], fmaxf(v1[1], v2[1]));
+
+        if (maxX < 0.f || maxY < 0.f || minX >= width || minY >= height)
+            return;
+
+        int x0 = minX > 0.f ? (int)minX : 0;
+        int y0 = minY > 0.f ? (int)minY : 0;
+        int x1 = maxX < width - 1 ? (int)maxX : (int)width - 1;
+        int y1 = maxY < height - 1 ? (int)maxY : (int)height - 1;
+
+        triangleCount++;
+
+        // pixels go in groups of 4, the width is a multiple of the tile size
+
+        // edge i is opposite of vertex i, e(p) = a * x + b * y + c is >= 0 inside
+        const float * from[3] = { v1, v2, v0 };
+        const float * to[3] = { v2, v0, v1 };
+        float a[3], b[3], c[3];
+        for (int i = 0; i < 3; i++)
+        {
+            a[i] = from[i][1] - to[i][1];
+            b[i] = to[i][0] - from[i][0];
+            c[i] = -(a[i] * from[i][0] + b[i] * from[i][1]);
+        }
+
+        // z = e0 / area * z0 + e1 / area * z1 + e2 / area * z2, a plane in x and y
+        float zA = (a[0] * v0[2] + a[1] * v1[2] + a[2] * v2[2]) / area;
+        float zB = (b[0] * v0[2] + b[1] * v1[2] + b[2] * v2[2]) / area;
+        float zC = (c[0] * v0[2] + c[1] * v1[2] + c[2] * v2[2]) / area;
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        __m128 edgeA[3], edgeB[3], edgeC[3];
+        for (int i = 0; i < 3; i++)
+        {
+            edgeA[i] = _mm_set1_ps(a[i]);
+            edgeB[i] = _mm_set1_ps(b[i]);
+            edgeC[i] = _mm_set1_ps(c[i]);
+        }
+        const __m128 depthA = _mm_set1_ps(zA);
+        const __m128 depthB = _mm_set1_ps(zB);
+        const __m128 depthC = _mm_set1_ps(zC);
+
+        for (int y = y0; y <= y1; y++)
+        {
+            __m128 py = _mm_set1_ps(y + 0.5f);
+            float * row = depth.data() + y * width;
+
+            // the part of every function that only depends on y
+            __m128 rowEdge[3];
+            for (int i = 0; i < 3; i++)
+                rowEdge[i] = _mm_add_ps(_mm_mul_ps(edgeB[i], py), edgeC[i]);
+            __m128 rowDepth = _mm_add_ps(_mm_mul_ps(depthB, py), depthC);
+
+            // where the row crosses the edges, a pixel wider on both ends for the rounding
+            float spanStart = (float)x0, spanEnd = (float)x1;
+            for (int i = 0; i < 3; i++)
+            {
+                float rowValue = b[i] * (y + 0.5f) + c[i];
+                if (a[i] > 0.f)
+                    spanStart = fmaxf(spanStart, -rowValue / a[i] - 1.5f);
+                else if (a[i] < 0.f)
+                    spanEnd = fminf(spanEnd, -rowValue / a[i] + 0.5f);
+                else if (rowValue < 0.f)
+                    spanEnd = -1.f;
+            }
+            if (spanStart > spanEnd)
+                continue;
+
+            int start = (int)spanStart & ~3;
+            int end = (int)spanEnd;
+
+            for (int x = start; x <= end; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], px), rowEdge[0]), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[1], px), rowEdge[1]), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[2], px), rowEdge[2]), zero));
+
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(depthA, px), rowDepth);
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_min_ps(old, z);
+
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+        }
+    }
+
+    void OcclusionCuller::buildHierarchy()
+    {
+        for (uint32_t ty = 0; ty < tilesY; ty++)
+        {
+            for (uint32_t tx = 0; tx < tilesX; tx++)
+            {
+                const float * corner = depth.data() + ty * TILE_SIZE * width + tx * TILE_SIZE;
+
+                __m128 farthest = _mm_setzero_ps();
+                for (uint32_t y = 0; y < TILE_SIZE; y++)
+                {
+                    for (uint32_t x = 0; x < TILE_SIZE; x += 4)
+                        farthest = _mm_max_ps(farthest, _mm_loadu_ps(corner + y * width + x));
+                }
+
+                float lanes[4];
+                _mm_storeu_ps(lanes, farthest);
+                tiles[ty * tilesX + tx] = fmaxf(fmaxf(lanes[0], lanes[1]), fmaxf(lanes[2], lanes[3]));
+            }
+        }
+    }
+
+    bool OcclusionCuller::isVisible(const float world[16], const float boxMin[3], const float boxMax[3]) const
+    {
+        float m[16];
+        multiply(world, viewProjection, m);
+
+        float corners[8][3];
+        boxCorners(boxMin, boxMax, corners);
+
+        float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+        float nearest = INFINITY;
+        int behind = 0;
+
+        for (int i = 0; i < 8; i++)
+        {
+            float clip[4];
+            for (int column = 0; column < 4; column++)
+            {
+                clip[column] =
+                    corners[i][0] * m[column] +
+                    corners[i][1] * m[4 + column] +
+                    corners[i][2] * m[8 + column] +
+                    m[12 + column];
+            }
+
+            if (clip[2] < 0.f)
+            {
+                behind++;
+                continue;
+            }
+
+            float x = (clip[0] / clip[3] * 0.5f + 0.5f) * width;
+            float y = (0.5f - clip[1] / clip[3] * 0.5f) * height;
+            minX = fminf(minX, x);
+            maxX = fmaxf(maxX, x);
+            minY = fminf(minY, y);
+            maxY = fmaxf(maxY, y);
+            nearest = fminf(nearest, clip[2] / clip[3]);
+        }
+
+        if (behind == 8)
+            return false;
+        // crosses the near plane, the rect can't be trusted
+        if (behind > 0)
+            return true;
+
+        if (maxX < 0.f || maxY < 0.f || minX >= width || minY >= height || nearest > 1.f)
+            return false;
+
+        // every pixel the rect touches
+        uint32_t x0 = minX > 0.f ? (uint32_t)minX : 0;
+        uint32_t y0 = minY > 0.f ? (uint32_t)minY : 0;
+        uint32_t x1 = maxX < width - 1 ? (uint32_t)maxX : width - 1;
+        uint32_t y1 = maxY < height - 1 ? (uint32_t)maxY : height - 1;
+
+        for (uint32_t ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++)
+        {
+            for (uint32_t tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++)
+            {
+                // everything in the tile is in front of the box
+                if (tiles[ty * tilesX + tx] < nearest)
+                    continue;
+
+                uint32_t startX = tx * TILE_SIZE > x0 ? tx * TILE_SIZE : x0;
+                uint32_t startY = ty * TILE_SIZE > y0 ? ty * TILE_SIZE : y0;
+                uint32_t endX = (tx + 1) * TILE_SIZE - 1 < x1 ? (tx + 1) * TILE_SIZE - 1 : x1;
+                uint32_t endY = (ty + 1) * TILE_SIZE - 1 < y1 ? (ty + 1) * TILE_SIZE - 1 : y1;
+
+                for (uint32_t y = startY; y <= endY; y++)
+                {
+                    for (uint32_t x = startX; x <= endX; x++)
+                    {
+                        if (depth[y * width + x] >= nearest)
+                            return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    uint32_t OcclusionCuller::getWidth() const
+    {
+        return width;
+    }
+
+    uint32_t OcclusionCuller::getHeight() const
+    {
+        return height;
+    }
+
+    uint32_t OcclusionCuller::getTriangleCount() const
+    {
+        return triangleCount;
+    }
+
+    const std::vector<float> & OcclusionCuller::getDepth() const
+    {
+        return depth;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace Graphics
+{
+    /*
+        Software occlusion culling on the CPU. A few big occluders (the map
+        boxes) are rasterized with SSE into a small depth buffer, then
+        instances are tested with the screen rect and nearest depth of their
+        bounding box.
+
+        The depth buffer is split in TILE_SIZE x TILE_SIZE tiles that keep the
+        farthest depth in them (hierarchical z). A box is hidden when its
+        nearest depth is behind the farthest depth of every tile its rect
+        touches, only the tiles that can't decide it are tested per pixel.
+
+        Depth is D3D style, [0, 1] with 0 at the near plane. Matrices are row
+        major, vectors multiplied from the left (v * M).
+
+        Occluders only cover the pixels whose centers they cover, something
+        peeking out less than a pixel of the small buffer past an edge can
+        be culled. Boxes crossing the near plane are always visible.
+
+        HOW TO USE:
+            culler.clear(viewProjection);
+            culler.addOccluder(world, boxMin, boxMax);   // for every occluder
+            culler.buildHierarchy();
+            culler.isVisible(world, boxMin, boxMax);     // for every instance
+    */
+    class OcclusionCuller
+    {
+    public:
+        static const uint32_t TILE_SIZE = 8;
+
+        // width and height are rounded up to whole tiles
+        OcclusionCuller(uint32_t width, uint32_t height);
+        ~OcclusionCuller();
+
+        void clear(const float viewProjection[16]);
+
+        // a solid box, boxMin and boxMax are in the space world transforms from
+        void addOccluder(const float world[16], const float boxMin[3], const float boxMax[3]);
+        // a closed mesh, 3 floats per position, no back face culling
+        void addOccluderMesh(const float world[16], const float * positions, size_t vertexCount, const uint32_t * indices, size_t indexCount);
+
+        // after the occluders, before isVisible
+        void buildHierarchy();
+
+        // false if the box is behind the occluders or outside the screen
+        bool isVisible(const float world[16], const float boxMin[3], const float boxMax[3]) const;
+
+        uint32_t getWidth() const;
+        uint32_t getHeight() const;
+        uint32_t getTriangleCount() const;  // rasterized since clear
+        const std::vector<float> & getDepth() const;
+    private:
+        uint32_t width, height;
+        uint32_t tilesX, tilesY;
+        float viewProjection[16];
+        uint32_t triangleCount;
+
+        std::vector<float> depth;
+        std::vector<float> tiles;           // farthest depth of each tile
+        std::vector<float> clipPositions;   // scratch, 4 floats per vertex
+
+        void transform(const float world[16], const float * positions, size_t vertexCount);
+        void clipTriangle(const float * a, const float * b, const float * c);
+        void drawTriangle(const float screen[3][3]);
+    };
+}
@@ -0,0 +1,136 @@
+#include "RenderCommandList.h"
+#include <string.h>
+
+#define KEY_DEPTH_BITS 12
+#define KEY_LOD_BITS 2
+#define KEY_MESH_BITS 16
+#define KEY_MATERIAL_BITS 16
+#define KEY_SHADER_BITS 8
+#define KEY_PASS_BITS 4
+
+#define KEY_DEPTH_SHIFT 0
+#define KEY_LOD_SHIFT (KEY_DEPTH_SHIFT + KEY_DEPTH_BITS)
+#define KEY_MESH_SHIFT (KEY_LOD_SHIFT + KEY_LOD_BITS)
+#define KEY_MATERIAL_SHIFT (KEY_MESH_SHIFT + KEY_MESH_BITS)
+#define KEY_SHADER_SHIFT (KEY_MATERIAL_SHIFT + KEY_MATERIAL_BITS)
+#define KEY_CULLING_SHIFT (KEY_SHADER_SHIFT + KEY_SHADER_BITS)
+#define KEY_PASS_SHIFT (KEY_CULLING_SHIFT + 1)
+
+#define KEY_FIELD(value, bits, shift) (((uint64_t)(value) & ((1ull << (bits)) - 1)) << (shift))
+#define KEY_GET(key, bits, shift) ((uint32_t)(((key) >> (shift)) & ((1ull << (bits)) - 1)))
+
+namespace Graphics
+{
+    RenderCommandList::RenderCommandList()
+    {
+        maxBatchSize = UINT32_MAX;
+    }
+
+    RenderCommandList::~RenderCommandList()
+    {
+    }
+
+    uint64_t RenderCommandList::makeKey(uint32_t pass, bool culling, uint32_t shader, uint32_t material, uint32_t mesh, uint32_t lod, float depth)
+    {
+        if (depth < 0.f) depth = 0.f;
+        if (depth > 1.f) depth = 1.f;
+        uint32_t bucket = (uint32_t)(depth * ((1 << KEY_DEPTH_BITS) - 1));
+
+        return KEY_FIELD(pass, KEY_PASS_BITS, KEY_PASS_SHIFT) |
+            KEY_FIELD(culling ? 1 : 0, 1, KEY_CULLING_SHIFT) |
+            KEY_FIELD(shader, KEY_SHADER_BITS, KEY_SHADER_SHIFT) |
+            KEY_FIELD(material, KEY_MATERIAL_BITS, KEY_MATERIAL_SHIFT) |
+            KEY_FIELD(mesh, KEY_MESH_BITS, KEY_MESH_SHIFT) |
+            KEY_FIELD(lod, KEY_LOD_BITS, KEY_LOD_SHIFT) |
+            KEY_FIELD(bucket, KEY_DEPTH_BITS, KEY_DEPTH_SHIFT);
+    }
+
+    uint32_t RenderCommandList::getPass(uint64_t key)     { return KEY_GET(key, KEY_PASS_BITS, KEY_PASS_SHIFT); }
+    bool RenderCommandList::getCulling(uint64_t key)      { return KEY_GET(key, 1, KEY_CULLING_SHIFT) != 0; }
+    uint32_t RenderCommandList::getShader(uint64_t key)   { return KEY_GET(key, KEY_SHADER_BITS, KEY_SHADER_SHIFT); }
+    uint32_t RenderCommandList::getMaterial(uint64_t key) { return KEY_GET(key, KEY_MATERIAL_BITS, KEY_MATERIAL_SHIFT); }
+    uint32_t RenderCommandList::getMesh(uint64_t key)     { return KEY_GET(key, KEY_MESH_BITS, KEY_MESH_SHIFT); }
+    uint32_t RenderCommandList::getLod(uint64_t key)      { return KEY_GET(key, KEY_LOD_BITS, KEY_LOD_SHIFT); }
+    uint32_t RenderCommandList::getDepth(uint64_t key)    { return KEY_GET(key, KEY_DEPTH_BITS, KEY_DEPTH_SHIFT); }
+
+    void RenderCommandList::clear()
+    {
+        commands.clear();
+        batches.clear();
+    }
+
+    void RenderCommandList::reserve(size_t count)
+    {
+        commands.reserve(count);
+        scratch.reserve(count);
+        batches.reserve(count);
+    }
+
+    void RenderCommandList::push(uint64_t key, uint32_t index)
+    {
+        commands.push_back({ key, index });
+    }
+
+    void RenderCommandList::setMaxBatchSize(uint32_t commands)
+    {
+        maxBatchSize = commands > 0 ? commands : 1;
+    }
+
+    void RenderCommandList::sort()
+    {
+        size_t count = commands.size();
+        scratch.resize(count);
+
+        uint32_t histogram[256];
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            memset(histogram, 0, sizeof(histogram));
+            for (Command const &command : commands)
+                histogram[(command.key >> shift) & 0xff]++;
+
+            // every key has the same byte here, the order wouldn't change
+            if (count == 0 || histogram[(commands[0].key >> shift) & 0xff] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (int i = 0; i < 256; i++)
+            {
+                uint32_t bucket = histogram[i];
+                histogram[i] = offset;
+                offset += bucket;
+            }
+
+            for (Command const &command : commands)
+                scratch[histogram[(command.key >> shift) & 0xff]++] = command;
+
+            commands.swap(scratch);
+        }
+
+        buildBatches();
+    }
+
+    void RenderCommandList::buildBatches()
+    {
+        batches.clear();
+
+        const uint64_t stateMask = ~KEY_FIELD(~0u, KEY_DEPTH_BITS, KEY_DEPTH_SHIFT);
+        for (uint32_t i = 0; i < commands.size(); i++)
+        {
+            uint64_t state = commands[i].key & stateMask;
+            if (!batches.empty() && batches.back().key == state && batches.back().count < maxBatchSize)
+                batches.back().count++;
+            else
+                batches.push_back({ state, i, 1 });
+        }
+    }
+
+    const std::vector<RenderCommandList::Command> & RenderCommandList::getCommands() const
+    {
+        return commands;
+    }
+
+    const std::vector<RenderCommandList::Batch> & RenderCommandList::getBatches() const
+    {
+        return batches;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace Graphics
+{
+    /*
+        One command per instance, ordered by a 64 bit key so that everything
+        sharing state ends up next to each other. After sort() the commands
+        with the same key (ignoring depth) are merged into batches, one batch
+        is one draw.
+
+        Key, high to low bits:
+            pass        4
+            culling     1   backFaceCulling, 1 = cull
+            shader      8
+            material    16
+            mesh        16
+            lod         2   of the mesh, 0 is the full one
+            depth       12  bucket of the view depth, front to back
+
+        Depth is at the bottom so it never splits a batch, it only orders the
+        instances inside one (front to back helps early z).
+
+        An instance can be pushed more than once with different passes, the
+        shadow casters are pushed again for every cascade they reach.
+
+        HOW TO USE:
+            list.clear();
+            list.push(RenderCommandList::makeKey(...), instanceIndex);
+            list.sort();
+            for (auto &batch : list.getBatches()) ...
+    */
+    class RenderCommandList
+    {
+    public:
+        enum PASS { PASS_OPAQUE, PASS_SHADOW_0, PASS_SHADOW_1, PASS_SHADOW_2, PASS_SHADOW_3, NR_OF_PASSES };
+
+        struct Command
+        {
+            uint64_t key;
+            uint32_t index;  // into the instances of the caller
+        };
+
+        struct Batch
+        {
+            uint64_t key;
+            uint32_t first;  // index of the first command
+            uint32_t count;
+        };
+
+        RenderCommandList();
+        ~RenderCommandList();
+
+        // depth is [0, 1] of the view range, it is clamped
+        static uint64_t makeKey(uint32_t pass, bool culling, uint32_t shader, uint32_t material, uint32_t mesh, uint32_t lod, float depth);
+        static uint32_t getPass(uint64_t key);
+        static bool getCulling(uint64_t key);
+        static uint32_t getShader(uint64_t key);
+        static uint32_t getMaterial(uint64_t key);
+        static uint32_t getMesh(uint64_t key);
+        static uint32_t getLod(uint64_t key);
+        static uint32_t getDepth(uint64_t key);
+
+        void clear();
+        void reserve(size_t count);
+        void push(uint64_t key, uint32_t index);
+
+        // batches are split so none has more commands than this, default is no limit
+        void setMaxBatchSize(uint32_t commands);
+
+        // LSD radix sort, 8 bits per pass, passes where every key has the same byte are skipped
+        void sort();
+
+        const std::vector<Command> & getCommands() const;
+        const std::vector<Batch> & getBatches() const;
+    private:
+        std::vector<Command> commands;
+        std::vector<Command> scratch;
+        std::vector<Batch> batches;
+        uint32_t maxBatchSize;
+
+        void buildBatches();
+    };
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "../Device/RenderDevice.h"
+#include <Engine/Constants.h>
+
+/*
+    Dynamic structured buffer that is written as a ring. Every map()
+    takes the next free range with NO_OVERWRITE, so what was written
+    earlier in the frame is still there for the draws using it. When the
+    end is reached it starts over from 0 with DISCARD.
+
+    If one map() is bigger than the whole buffer it grows to twice the
+    size (or what was asked for), never above maxCapacity. Anything
+    bigger than maxCapacity has to be split by the caller.
+
+    D3D 11.0 can't NO_OVERWRITE a buffer with a shader resource view,
+    on those drivers (SupportsNoOverwriteSRV) every map() is a DISCARD
+    from 0.
+*/
+template<typename T>
+class RingBuffer
+{
+public:
+    RingBuffer(Graphics::RenderDevice * device, UINT capacity, UINT maxCapacity);
+    ~RingBuffer();
+
+    // offset gets the element index of the returned memory, count <= getMaxCapacity()
+    T * map(Graphics::RenderDevice * renderDevice, UINT count, UINT & offset);
+    void unmap(Graphics::RenderDevice * renderDevice);
+
+    // resets the per frame usage, call once per frame before any map()
+    void beginFrame();
+
+    inline UINT getCapacity() const { return m_Capacity; }
+    inline UINT getMaxCapacity() const { return m_MaxCapacity; }
+    inline UINT getUsedThisFrame() const { return m_UsedThisFrame; }
+    inline UINT getHighWaterMark() const { return m_HighWaterMark; } // most elements used in one frame
+    inline UINT getGrowCount() const { return m_GrowCount; }
+
+    inline Graphics::ShaderResourceView *getSRV() const { return m_SRV; }
+    operator Graphics::ShaderResourceView**() { return &m_SRV; }
+
+private:
+    Graphics::RenderDevice       *m_Device;
+    Graphics::GpuBuffer          *m_Buffer;
+    Graphics::ShaderResourceView *m_SRV;
+
+    UINT m_Capacity;
+    UINT m_MaxCapacity;
+    UINT m_Head;
+    UINT m_UsedThisFrame;
+    UINT m_HighWaterMark;
+    UINT m_GrowCount;
+    bool m_NoOverwrite;
+
+    void create(UINT capacity);
+};
+
+template<typename T>
+inline RingBuffer<T>::RingBuffer(Graphics::RenderDevice * device, UINT capacity, UINT maxCapacity)
+{
+    m_Device = device;
+    m_Buffer = nullptr;
+    m_SRV = nullptr;
+    m_MaxCapacity = maxCapacity;
+    m_Head = 0;
+    m_UsedThisFrame = 0;
+    m_HighWaterMark = 0;
+    m_GrowCount = 0;
+
+    m_NoOverwrite = device->SupportsNoOverwriteSRV();
+
+    create(capacity < maxCapacity ? capacity : maxCapacity);
+}
+
+template<typename T>
+inline RingBuffer<T>::~RingBuffer()
+{
+    SAFE_RELEASE(m_Buffer);
+    SAFE_RELEASE(m_SRV);
+}
+
+template<typename T>
+inline void RingBuffer<T>::create(UINT capacity)
+{
+    SAFE_RELEASE(m_Buffer);
+    SAFE_RELEASE(m_SRV);
+
+    Graphics::BufferDesc desc = {};
+    desc.byteWidth = sizeof(T) * capacity;
+    desc.cpuAccessFlags = Graphics::CPU_ACCESS_WRITE;
+    desc.bindFlags = Graphics::BIND_SHADER_RESOURCE;
+    desc.usage = Graphics::USAGE_DYNAMIC;
+    desc.structureStride = sizeof(T);
+
+    m_Buffer = m_Device->CreateBuffer(desc, nullptr);
+    m_SRV = m_Device->CreateShaderResourceView(m_Buffer);
+
+    m_Capacity = capacity;
+    m_Head = capacity; // the first map of a new buffer has to DISCARD
+}
+
+template<typename T>
+inline void RingBuffer<T>::beginFrame()
+{
+    m_UsedThisFrame = 0;
+}
+
+template<typename T>
+inline T * RingBuffer<T>::map(Graphics::RenderDevice * renderDevice, UINT count, UINT & offset)
+{
+    if (count > m_MaxCapacity)
+        count = m_MaxCapacity;
+
+    m_UsedThisFrame += count;
+    if (m_UsedThisFrame > m_HighWaterMark)
+        m_HighWaterMark = m_UsedThisFrame;
+
+    // a new buffer is empty, the old one is released but the draws already made keep it alive
+    if (count > m_Capacity)
+    {
+        UINT capacity = m_Capacity * 2 > count ? m_Capacity * 2 : count;
+        create(capacity < m_MaxCapacity ? capacity : m_MaxCapacity);
+        m_GrowCount++;
+    }
+
+    if (m_NoOverwrite && m_Head + count <= m_Capacity)
+    {
+        offset = m_Head;
+        m_Head += count;
+        return static_cast<T*>(renderDevice->MapNoOverwrite(m_Buffer, offset * sizeof(T), count * sizeof(T)));
+    }
+
+    offset = 0;
+    m_Head = count;
+    return static_cast<T*>(renderDevice->Map(m_Buffer, count * sizeof(T)));
+}
+
+template<typename T>
+inline void RingBuffer<T>::unmap(Graphics::RenderDevice * renderDevice)
+{
+    renderDevice->Unmap(m_Buffer);
+}
@@ -1,22 +1,21 @@
 #pragma once
-#include <d3d11.h>
-#include "../ThrowIfFailed.h"
+#include "../Device/RenderDevice.h"
 #include <Engine/Constants.h>
 class ShaderResource
 {
 public:
-	ShaderResource(ID3D11Device * device, UINT width, UINT height);
+	ShaderResource(Graphics::RenderDevice * device, UINT width, UINT height);
 	~ShaderResource();
 
-	operator ID3D11RenderTargetView*() const { return renderTarget; }
-	operator ID3D11RenderTargetView*const*() const { return &renderTarget; }
-	operator ID3D11ShaderResourceView*() const { return shaderResource; }
-	operator ID3D11ShaderResourceView*const*() const { return &shaderResource; }
-	operator ID3D11UnorderedAccessView*() const { return unorderedAccess; }
-	operator ID3D11UnorderedAccessView*const*() const { return &unorderedAccess; }
+	operator Graphics::RenderTargetView*() const { return renderTarget; }
+	operator Graphics::RenderTargetView*const*() const { return &renderTarget; }
+	operator Graphics::ShaderResourceView*() const { return shaderResource; }
+	operator Graphics::ShaderResourceView*const*() const { return &shaderResource; }
+	operator Graphics::UnorderedAccessView*() const { return unorderedAccess; }
+	operator Graphics::UnorderedAccessView*const*() const { return &unorderedAccess; }
 
 private:
-	ID3D11RenderTargetView * renderTarget;
-	ID3D11ShaderResourceView * shaderResource;
-	ID3D11UnorderedAccessView * unorderedAccess;
+	Graphics::RenderTargetView * renderTarget;
+	Graphics::ShaderResourceView * shaderResource;
+	Graphics::UnorderedAccessView * unorderedAccess;
 };
@@ -0,0 +1,300 @@
+#include "StaticInstanceRegistry.h"
+#include <Engine/Constants.h>
+#include <algorithm>
+
+#define STATIC_START_CAPACITY 64
+
+namespace Graphics
+{
+    StaticInstanceRegistry::StaticInstanceRegistry(RenderDevice * device)
+    {
+        this->device = device;
+        buffer = nullptr;
+        srv = nullptr;
+        orderChanged = false;
+        uploadedBytes = 0;
+        for (UINT i = 0; i < ShadowCascades::MAX_CASCADES; i++)
+            cascadeCounts[i] = 0;
+
+        createBuffer(STATIC_START_CAPACITY);
+    }
+
+    StaticInstanceRegistry::~StaticInstanceRegistry()
+    {
+        SAFE_RELEASE(buffer);
+        SAFE_RELEASE(srv);
+    }
+
+    int StaticInstanceRegistry::add(RenderInfo const & info)
+    {
+        int handle;
+        if (freeHandles.empty())
+        {
+            handle = (int)entries.size();
+            entries.push_back({});
+        }
+        else
+        {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        }
+
+        entries[handle] = { info, true, 0 };
+        orderChanged = true;
+
+        return handle;
+    }
+
+    void StaticInstanceRegistry::update(int handle, RenderInfo const & info)
+    {
+        if (handle < 0 || handle >= (int)entries.size() || !entries[handle].used)
+            return;
+
+        Entry & entry = entries[handle];
+        if (entry.info.render != info.render ||
+            entry.info.meshId != info.meshId ||
+            entry.info.materialId != info.materialId ||
+            entry.info.backFaceCulling != info.backFaceCulling)
+        {
+            orderChanged = true;
+        }
+        else if (info.render && !orderChanged)
+        {
+            instances[entry.index].translation = info.translation;
+            dirty.push_back(entry.index);
+        }
+
+        entry.info = info;
+        if (info.render && !orderChanged)
+            updateBounds(entry);
+    }
+
+    void StaticInstanceRegistry::remove(int handle)
+    {
+        if (handle < 0 || handle >= (int)entries.size() || !entries[handle].used)
+            return;
+
+        entries[handle].used = false;
+        freeHandles.push_back(handle);
+        orderChanged = true;
+    }
+
+    void StaticInstanceRegistry::clear()
+    {
+        entries.clear();
+        freeHandles.clear();
+        instances.clear();
+        bounds.clear();
+        dirty.clear();
+        commandList.clear();
+        orderChanged = false;
+
+        for (UINT i = 0; i < ShadowCascades::MAX_CASCADES; i++)
+        {
+            cascadeBatches[i].clear();
+            cascadeCounts[i] = 0;
+        }
+    }
+
+    void StaticInstanceRegistry::rebuild()
+    {
+        commandList.clear();
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            RenderInfo const & info = entries[i].info;
+            if (entries[i].used && info.render)
+            {
+                // no depth or lod, the camera moves but these don't
+                commandList.push(RenderCommandList::makeKey(
+                    RenderCommandList::PASS_OPAQUE, info.backFaceCulling, 0, info.materialId, info.meshId, 0, 0.f
+                ), (uint32_t)i);
+            }
+        }
+        commandList.sort();
+
+        const std::vector<RenderCommandList::Command> & commands = commandList.getCommands();
+        instances.resize(commands.size());
+        bounds.resize(commands.size());
+        for (UINT i = 0; i < commands.size(); i++)
+        {
+            Entry & entry = entries[commands[i].index];
+            entry.index = i;
+            instances[i].translation = entry.info.translation;
+            updateBounds(entry);
+        }
+    }
+
+    void StaticInstanceRegistry::updateBounds(Entry const & entry)
+    {
+        Sphere & sphere = bounds[entry.index];
+        int mesh = (int)entry.info.meshId;
+        if (mesh >= (int)meshBounds.size() || meshBounds[mesh].radius < 0.f)
+        {
+            sphere.radius = -1.f;
+            return;
+        }
+
+        DirectX::SimpleMath::Matrix const & world = entry.info.translation;
+        float scale = std::max(world.Right().Length(), std::max(world.Up().Length(), world.Backward().Length()));
+        sphere.center = DirectX::SimpleMath::Vector3::Transform(meshBounds[mesh].center, world);
+        sphere.radius = meshBounds[mesh].radius * scale;
+    }
+
+    void StaticInstanceRegistry::setMeshBounds(int meshId, DirectX::SimpleMath::Vector3 const & center, float radius)
+    {
+        if (meshId < 0)
+            return;
+        if (meshId >= (int)meshBounds.size())
+            meshBounds.resize(meshId + 1, { DirectX::SimpleMath::Vector3(), -1.f });
+        meshBounds[meshId] = { center, radius };
+
+        // a rebuild is coming, it sets them all
+        if (orderChanged)
+            return;
+
+        for (Entry const & entry : entries)
+        {
+            if (entry.used && entry.info.render && (int)entry.info.meshId == meshId)
+                updateBounds(entry);
+        }
+    }
+
+    bool StaticInstanceRegistry::hasMeshBounds(int meshId) const
+    {
+        return meshId >= 0 && meshId < (int)meshBounds.size() && meshBounds[meshId].radius >= 0.f;
+    }
+
+    void StaticInstanceRegistry::cullCascades(ShadowCascades const & cascades, uint32_t updatedCascades)
+    {
+        for (UINT i = 0; i < ShadowCascades::MAX_CASCADES; i++)
+        {
+            cascadeBatches[i].clear();
+            cascadeCounts[i] = 0;
+        }
+
+        if (!updatedCascades)
+            return;
+
+        // instances next to each other in a batch that reach the same cascade are one run, one draw
+        for (RenderCommandList::Batch const & batch : commandList.getBatches())
+        {
+            for (UINT index = batch.first; index < batch.first + batch.count; index++)
+            {
+                Sphere const & sphere = bounds[index];
+                uint32_t casts = sphere.radius < 0.f ? updatedCascades :
+                    cascades.getCasterMask(&sphere.center.x, sphere.radius, updatedCascades);
+
+                for (UINT i = 0; casts; i++, casts >>= 1)
+                {
+                    if (!(casts & 1))
+                        continue;
+
+                    std::vector<RenderCommandList::Batch> & runs = cascadeBatches[i];
+                    if (!runs.empty() && runs.back().key == batch.key && runs.back().first + runs.back().count == index)
+                        runs.back().count++;
+                    else
+                        runs.push_back({ batch.key, index, 1 });
+                    cascadeCounts[i]++;
+                }
+            }
+        }
+    }
+
+    const std::vector<RenderCommandList::Batch> & StaticInstanceRegistry::getCascadeBatches(UINT cascade) const
+    {
+        return cascadeBatches[cascade];
+    }
+
+    UINT StaticInstanceRegistry::getCascadeCount(UINT cascade) const
+    {
+        return cascadeCounts[cascade];
+    }
+
+    void StaticInstanceRegistry::createBuffer(UINT capacity)
+    {
+        SAFE_RELEASE(buffer);
+        SAFE_RELEASE(srv);
+
+        BufferDesc desc = {};
+        desc.byteWidth = sizeof(InstanceData) * capacity;
+        desc.bindFlags = BIND_SHADER_RESOURCE;
+        desc.usage = USAGE_DEFAULT;
+        desc.structureStride = sizeof(InstanceData);
+
+        buffer = device->CreateBuffer(desc, nullptr);
+        srv = device->CreateShaderResourceView(buffer);
+
+        this->capacity = capacity;
+    }
+
+    UINT StaticInstanceRegistry::upload(RenderDevice * renderDevice)
+    {
+        uploadedBytes = 0;
+
+        if (orderChanged)
+        {
+            rebuild();
+            orderChanged = false;
+            dirty.clear();
+
+            if (instances.size() > capacity)
+            {
+                UINT grown = capacity * 2;
+                createBuffer(grown > instances.size() ? grown : (UINT)instances.size());
+            }
+
+            uploadedBytes = (UINT)(instances.size() * sizeof(InstanceData));
+            if (uploadedBytes > 0)
+                renderDevice->UpdateBuffer(buffer, 0, uploadedBytes, instances.data());
+        }
+        else if (!dirty.empty())
+        {
+            // neighbours are uploaded together
+            std::sort(dirty.begin(), dirty.end());
+            size_t i = 0;
+            while (i < dirty.size())
+            {
+                UINT first = dirty[i], last = dirty[i];
+                while (++i < dirty.size() && dirty[i] <= last + 1)
+                    last = dirty[i];
+
+                UINT bytes = (last - first + 1) * sizeof(InstanceData);
+                renderDevice->UpdateBuffer(buffer, first * sizeof(InstanceData), bytes, &instances[first]);
+                uploadedBytes += bytes;
+            }
+            dirty.clear();
+        }
+
+        return uploadedBytes;
+    }
+
+    const std::vector<RenderCommandList::Batch> & StaticInstanceRegistry::getBatches() const
+    {
+        return commandList.getBatches();
+    }
+
+    ShaderResourceView * const * StaticInstanceRegistry::getSRV() const
+    {
+        return &srv;
+    }
+
+    UINT StaticInstanceRegistry::getCount() const
+    {
+        return (UINT)instances.size();
+    }
+
+    UINT StaticInstanceRegistry::getUploadedBytes() const
+    {
+        return uploadedBytes;
+    }
+
+    void StaticInstanceRegistry::getOccluders(std::vector<RenderInfo const *> & occluders) const
+    {
+        occluders.clear();
+        for (Entry const & entry : entries)
+        {
+            if (entry.used && entry.info.render && entry.info.occluder)
+                occluders.push_back(&entry.info);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <vector>
+#include "../Structs.h"
+#include "../Device/RenderDevice.h"
+#include "RenderCommandList.h"
+#include "../Lights/ShadowCascades.h"
+
+namespace Graphics
+{
+    /*
+        Instances that (almost) never move, the map and such. They are added
+        once and the transforms stay in a GPU buffer, only what changed is
+        uploaded again.
+
+        The buffer is kept in sort key order so the batches are ready to
+        draw. Changing only the transform uploads that instance, changing
+        mesh, material, culling or render rebuilds the order and uploads
+        everything (this is also what add and remove do).
+
+        Every instance has a bounding sphere, from the bounds of its mesh set
+        with setMeshBounds. cullCascades splits the batches into runs of the
+        instances that can throw a shadow into each cascade, the shadow passes
+        draw those runs straight from the same buffer. Instances of a mesh
+        without bounds yet go into every cascade.
+
+        HOW TO USE:
+            int handle = registry.add(info);
+            registry.update(handle, info); // when it changed
+            registry.upload(renderDevice); // once per frame, before drawing
+            registry.cullCascades(cascades, updated); // after upload
+            registry.getBatches(), batch.first is the index in getSRV()
+            registry.getCascadeBatches(i), the same for the shadow pass of cascade i
+    */
+    class StaticInstanceRegistry
+    {
+    public:
+        StaticInstanceRegistry(RenderDevice * device);
+        ~StaticInstanceRegistry();
+
+        // returns the handle
+        int add(RenderInfo const & info);
+        void update(int handle, RenderInfo const & info);
+        void remove(int handle);
+        void clear();
+
+        // returns the bytes uploaded
+        UINT upload(RenderDevice * renderDevice);
+
+        const std::vector<RenderCommandList::Batch> & getBatches() const;
+        ShaderResourceView * const * getSRV() const;
+        UINT getCount() const;
+        UINT getUploadedBytes() const;  // by the last upload
+        // the ones rendered with occluder set, for the occlusion culling
+        void getOccluders(std::vector<RenderInfo const *> & occluders) const;
+
+        // bounding sphere in mesh space
+        void setMeshBounds(int meshId, DirectX::SimpleMath::Vector3 const & center, float radius);
+        bool hasMeshBounds(int meshId) const;
+
+        // cascades not in updatedCascades get no runs
+        void cullCascades(ShadowCascades const & cascades, uint32_t updatedCascades);
+        const std::vector<RenderCommandList::Batch> & getCascadeBatches(UINT cascade) const;
+        UINT getCascadeCount(UINT cascade) const;   // instances in getCascadeBatches
+    private:
+        struct Entry
+        {
+            RenderInfo info;
+            bool used;
+            UINT index;     // in instances, if it is rendered
+        };
+
+        struct Sphere
+        {
+            DirectX::SimpleMath::Vector3 center;
+            float radius;   // < 0 without bounds
+        };
+
+        RenderDevice * device;
+        GpuBuffer * buffer;
+        ShaderResourceView * srv;
+        UINT capacity;
+
+        std::vector<Entry> entries;
+        std::vector<int> freeHandles;
+        std::vector<InstanceData> instances;
+        std::vector<Sphere> bounds;     // world space, same order as instances
+        std::vector<Sphere> meshBounds; // mesh space, by mesh id
+        std::vector<UINT> dirty;        // indices in instances
+        bool orderChanged;
+        UINT uploadedBytes;
+
+        RenderCommandList commandList;
+        std::vector<RenderCommandList::Batch> cascadeBatches[ShadowCascades::MAX_CASCADES];
+        UINT cascadeCounts[ShadowCascades::MAX_CASCADES];
+
+        void rebuild();
+        void updateBounds(Entry const & entry);
+        void createBuffer(UINT capacity);
+    };
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include "../Device/RenderDevice.h"
+#include <Engine/Constants.h>
+#include <string.h>
 
 enum class CpuAccess
 {
@@ -13,95 +16,74 @@ class StructuredBuffer
 {
 public:
 #pragma region Constructors/Destructors
-    StructuredBuffer(ID3D11Device *device, CpuAccess access, size_t count, T* ptr = nullptr);
+    StructuredBuffer(Graphics::RenderDevice *device, CpuAccess access, size_t count, T* ptr = nullptr);
     ~StructuredBuffer();
 #pragma endregion
 
 #pragma region Public Functions
-    void CopyTo(ID3D11DeviceContext *cxt, StructuredBuffer<T> *other);
-    T* map(ID3D11DeviceContext *cxt);
-    void unmap(ID3D11DeviceContext *cxt);
-    void write(ID3D11DeviceContext * context, T * data, UINT size);
+    void CopyTo(Graphics::RenderDevice *device, StructuredBuffer<T> *other);
+    T* map(Graphics::RenderDevice *device);
+    void unmap(Graphics::RenderDevice *device);
+    void write(Graphics::RenderDevice * device, T * data, UINT size);
 #pragma endregion
 
 #pragma region Getters and Setters
-    inline ID3D11Buffer *getBuffer() const { return m_Buffer; }
-    inline ID3D11ShaderResourceView *getSRV() const { return m_SRV; }
-    inline ID3D11UnorderedAccessView *getUAV() const { return m_UAV; }
+    inline Graphics::GpuBuffer *getBuffer() const { return m_Buffer; }
+    inline Graphics::ShaderResourceView *getSRV() const { return m_SRV; }
+    inline Graphics::UnorderedAccessView *getUAV() const { return m_UAV; }
 #pragma endregion
 
 #pragma region Implicit Conversion Operators
-    operator ID3D11Buffer*()               { return m_Buffer;  }
-    operator ID3D11Buffer**()              { return &m_Buffer; }
-    operator ID3D11ShaderResourceView*()   { return m_SRV;     }
-    operator ID3D11ShaderResourceView**()  { return &m_SRV;    }
-    operator ID3D11UnorderedAccessView*()  { return m_UAV;     }
-    operator ID3D11UnorderedAccessView**() { return &m_UAV;    }
+    operator Graphics::GpuBuffer*()            { return m_Buffer;  }
+    operator Graphics::GpuBuffer**()           { return &m_Buffer; }
+    operator Graphics::ShaderResourceView*()   { return m_SRV;     }
+    operator Graphics::ShaderResourceView**()  { return &m_SRV;    }
+    operator Graphics::UnorderedAccessView*()  { return m_UAV;     }
+    operator Graphics::UnorderedAccessView**() { return &m_UAV;    }
 #pragma endregion
 
 private:
-    ID3D11Buffer              *m_Buffer;
-    ID3D11ShaderResourceView  *m_SRV;
-    ID3D11UnorderedAccessView *m_UAV;
+    Graphics::GpuBuffer           *m_Buffer;
+    Graphics::ShaderResourceView  *m_SRV;
+    Graphics::UnorderedAccessView *m_UAV;
+    UINT                           m_Size;
 };
 
 #pragma region Constructors/Destructors
 template<typename T>
-inline StructuredBuffer<T>::StructuredBuffer(ID3D11Device * device, CpuAccess access, size_t count, T * ptr)
+inline StructuredBuffer<T>::StructuredBuffer(Graphics::RenderDevice * device, CpuAccess access, size_t count, T * ptr)
 {
-    D3D11_BUFFER_DESC desc = {};
-    desc.ByteWidth = sizeof(T) * count;
+    Graphics::BufferDesc desc = {};
+    desc.byteWidth = (UINT)(sizeof(T) * count);
+    m_Size = desc.byteWidth;
+    m_SRV = nullptr;
+    m_UAV = nullptr;
 
     if ((int)access & (int)CpuAccess::Read)
     {
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE | D3D11_CPU_ACCESS_READ;
-        desc.Usage = D3D11_USAGE_STAGING;
+        desc.cpuAccessFlags = Graphics::CPU_ACCESS_WRITE | Graphics::CPU_ACCESS_READ;
+        desc.usage = Graphics::USAGE_STAGING;
     }
     else if ((int)access & (int)CpuAccess::Write)
     {
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.cpuAccessFlags = Graphics::CPU_ACCESS_WRITE;
+        desc.bindFlags = Graphics::BIND_SHADER_RESOURCE;
+        desc.usage = Graphics::USAGE_DYNAMIC;
     }
     else 
     {
-        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+        desc.bindFlags = Graphics::BIND_SHADER_RESOURCE | Graphics::BIND_UNORDERED_ACCESS;
     }
 
-    desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-    desc.StructureByteStride = sizeof(T);
+    desc.structureStride = sizeof(T);
 
-    if (ptr) 
-    {
-        D3D11_SUBRESOURCE_DATA data = {};
-        data.pSysMem = ptr;
+    m_Buffer = device->CreateBuffer(desc, ptr);
 
-        ThrowIfFailed(device->CreateBuffer(&desc, &data, &m_Buffer));
-    }
-    else 
-    {
-        ThrowIfFailed(device->CreateBuffer(&desc, nullptr, &m_Buffer));
-    }
-
-    if (desc.BindFlags & D3D11_BIND_SHADER_RESOURCE)
-    {
-        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
-        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
-        srvDesc.Buffer.NumElements = count;
+    if (desc.bindFlags & Graphics::BIND_SHADER_RESOURCE)
+        m_SRV = device->CreateShaderResourceView(m_Buffer);
 
-        ThrowIfFailed(device->CreateShaderResourceView(m_Buffer, &srvDesc, &m_SRV));
-    }
-
-    if (desc.BindFlags & D3D11_BIND_UNORDERED_ACCESS)
-    {
-        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-        uavDesc.Format = DXGI_FORMAT_UNKNOWN;
-        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
-        uavDesc.Buffer.NumElements = count;
-
-        ThrowIfFailed(device->CreateUnorderedAccessView(m_Buffer, &uavDesc, &m_UAV));
-    }
+    if (desc.bindFlags & Graphics::BIND_UNORDERED_ACCESS)
+        m_UAV = device->CreateUnorderedAccessView(m_Buffer);
 }
 
 template<typename T>
@@ -114,27 +96,24 @@ inline StructuredBuffer<T>::~StructuredBuffer() {
 
 #pragma region Public Functions
 template<typename T>
-inline void StructuredBuffer<T>::CopyTo(ID3D11DeviceContext * cxt, StructuredBuffer<T>* other) {
-    cxt->CopyResource(other->getBuffer(), this->getBuffer());
+inline void StructuredBuffer<T>::CopyTo(Graphics::RenderDevice * device, StructuredBuffer<T>* other) {
+    device->CopyResource(other->getBuffer(), this->getBuffer());
 }
 
 template<typename T>
-inline T * StructuredBuffer<T>::map(ID3D11DeviceContext * cxt) {
-    D3D11_MAPPED_SUBRESOURCE data = {};
-    cxt->Map(m_Buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &data);
-
-    return static_cast<T*>(data.pData);
+inline T * StructuredBuffer<T>::map(Graphics::RenderDevice * device) {
+    return static_cast<T*>(device->Map(m_Buffer, m_Size));
 }
 
 template<typename T>
-inline void StructuredBuffer<T>::unmap(ID3D11DeviceContext * cxt) {
-    cxt->Unmap(m_Buffer, 0);
+inline void StructuredBuffer<T>::unmap(Graphics::RenderDevice * device) {
+    device->Unmap(m_Buffer);
 }
 
 template<typename T>
-inline void StructuredBuffer<T>::write(ID3D11DeviceContext * context, T * data, UINT size)
+inline void StructuredBuffer<T>::write(Graphics::RenderDevice * device, T * data, UINT size)
 {
-    memcpy(map(context), data, size);
-    unmap(context);
+    memcpy(map(device), data, size);
+    unmap(device);
 }
 #pragma endregion
\ No newline at end of file
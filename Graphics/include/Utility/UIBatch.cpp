@@ -0,0 +1,117 @@
+#include "UIBatch.h"
+#include "../Structs.h"
+#include <Engine/Constants.h>
+
+namespace Graphics
+{
+    UIBatch::UIBatch(RenderDevice * device, TextureResidency & residency, uint32_t scopes)
+        : residency(residency)
+        , scopes(scopes)
+        , atlasTexture(ResourceRegistry::INVALID_HANDLE)
+        , shader(device, SHADER_PATH("MenuShader.hlsl"), { { "POSITION", 0, FORMAT_R32G32B32_FLOAT, 0, 0 },{ "TEXCOORD", 0, FORMAT_R32G32_FLOAT, 0, 12 } })
+        , vertexBuffer(nullptr)
+    {
+        // without the table every image is drawn from its own file
+        if (atlas.load(UI_ATLAS_PATH))
+            atlasTexture = residency.add(TEXTURE_PATH_SIMPLE + atlas.getTexture(), scopes);
+
+        BufferDesc desc = {};
+        desc.bindFlags = BIND_VERTEX_BUFFER;
+        desc.byteWidth = sizeof(TriangleVertex) * 6 * UI_BATCH_MAX_QUADS;
+        desc.cpuAccessFlags = CPU_ACCESS_WRITE;
+        desc.usage = USAGE_DYNAMIC;
+
+        vertexBuffer = device->CreateBuffer(desc, nullptr);
+    }
+
+    UIBatch::~UIBatch()
+    {
+        SAFE_RELEASE(vertexBuffer);
+    }
+
+    void UIBatch::add(std::string const & image, float x, float y, float width, float height)
+    {
+        // a menu without a background has no image
+        if (image.empty() || quads.size() >= UI_BATCH_MAX_QUADS)
+            return;
+
+        Quad quad = { ResourceRegistry::INVALID_HANDLE, x, y, width, height, 0.f, 0.f, 1.f, 1.f };
+
+        TextureAtlas::Region const * region = atlas.find(image);
+        if (region && residency.get(atlasTexture))
+        {
+            quad.texture = atlasTexture;
+            quad.uStart = region->uStart;
+            quad.vStart = region->vStart;
+            quad.uEnd = region->uEnd;
+            quad.vEnd = region->vEnd;
+        }
+        else
+        {
+            // images that aren't packed yet are found by name, like the atlas was made from them
+            quad.texture = getImage(region ? region->file : image + ".png");
+        }
+
+        quads.push_back(quad);
+    }
+
+    void UIBatch::draw(RenderDevice * context, SamplerState * sampler)
+    {
+        if (quads.empty())
+            return;
+
+        TriangleVertex * vertices = (TriangleVertex *)context->Map(vertexBuffer, (UINT)(sizeof(TriangleVertex) * 6 * quads.size()));
+        for (Quad const & quad : quads)
+        {
+            float left = 2 * quad.x / WIN_WIDTH - 1;
+            float right = 2 * (quad.x + quad.width) / WIN_WIDTH - 1;
+            float top = 1 - 2 * quad.y / WIN_HEIGHT;
+            float bottom = 1 - 2 * (quad.y + quad.height) / WIN_HEIGHT;
+
+            // clockwise, like the quads were before
+            *vertices++ = { right, bottom, 0.f, quad.uEnd,   quad.vEnd };
+            *vertices++ = { left,  bottom, 0.f, quad.uStart, quad.vEnd };
+            *vertices++ = { left,  top,    0.f, quad.uStart, quad.vStart };
+            *vertices++ = { left,  top,    0.f, quad.uStart, quad.vStart };
+            *vertices++ = { right, top,    0.f, quad.uEnd,   quad.vStart };
+            *vertices++ = { right, bottom, 0.f, quad.uEnd,   quad.vEnd };
+        }
+        context->Unmap(vertexBuffer);
+
+        UINT stride = sizeof(TriangleVertex), offset = 0;
+        context->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+        context->IASetInputLayout(shader);
+        context->IASetPrimitiveTopology(TOPOLOGY_TRIANGLELIST);
+        context->VSSetShader(shader);
+        context->PSSetShader(shader);
+        context->PSSetSamplers(0, 1, &sampler);
+
+        // one draw for every run of quads with the same texture, all of them with the atlas
+        for (size_t start = 0, end; start < quads.size(); start = end)
+        {
+            for (end = start + 1; end < quads.size() && quads[end].texture == quads[start].texture; end++);
+
+            ShaderResourceView * view = (ShaderResourceView *)residency.get(quads[start].texture);
+            if (!view)
+                continue;
+
+            context->PSSetShaderResources(0, 1, &view);
+            context->Draw((UINT)(end - start) * 6, (UINT)start * 6);
+        }
+
+        ShaderResourceView * srvNull = nullptr;
+        context->PSSetShaderResources(0, 1, &srvNull);
+        quads.clear();
+    }
+
+    TextureResidency::Handle UIBatch::getImage(std::string const & file)
+    {
+        auto it = images.find(file);
+        if (it != images.end())
+            return it->second;
+
+        TextureResidency::Handle handle = residency.add(TEXTURE_PATH_SIMPLE + file, scopes);
+        images[file] = handle;
+        return handle;
+    }
+}
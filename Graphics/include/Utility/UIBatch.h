@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Resources/Shader.h"
+#include "../Resources/TextureAtlas.h"
+#include "../Resources/TextureResidency.h"
+#include "../Device/RenderDevice.h"
+
+#define UI_BATCH_MAX_QUADS 256  // a frame, more than this are dropped
+
+namespace Graphics
+{
+    /*
+        Textured quads of the menu and the HUD, drawn in as few draws as
+        their textures allow. Images are named like in the .lw data and
+        looked up in the UI atlas (UI_ATLAS_PATH, Tools/AtlasPacker), every
+        quad of an image in it uses the one atlas texture, so a frame is
+        one draw.
+
+        An image that isn't in the atlas, or every image when the atlas
+        texture can't be loaded (not packed yet), is drawn from its own file
+        instead, then a draw ends wherever the texture changes. A texture
+        that can't be loaded isn't drawn.
+
+        The textures are in the scopes of residency it is made with.
+
+        HOW TO USE:
+            batch.add("button", 400, 300, 450, 100);   // pixels from the top left
+            batch.draw(renderDevice, states->PointClamp());
+    */
+    class UIBatch
+    {
+    public:
+        UIBatch(RenderDevice * device, TextureResidency & residency, uint32_t scopes);
+        ~UIBatch();
+
+        // drawn in the order they are added, later ones on top
+        void add(std::string const & image, float x, float y, float width, float height);
+        // what was added since the last draw. The render target and blend state are the caller's
+        void draw(RenderDevice * context, SamplerState * sampler);
+    private:
+        struct Quad
+        {
+            TextureResidency::Handle texture;
+            float x, y, width, height;
+            float uStart, vStart, uEnd, vEnd;
+        };
+
+        TextureResidency & residency;
+        uint32_t scopes;
+
+        TextureAtlas atlas;
+        TextureResidency::Handle atlasTexture;
+        // images drawn from their own file, added when they are first needed
+        std::unordered_map<std::string, TextureResidency::Handle> images;
+
+        std::vector<Quad> quads;
+        Shader shader;
+        GpuBuffer * vertexBuffer;
+
+        TextureResidency::Handle getImage(std::string const & file);
+    };
+}
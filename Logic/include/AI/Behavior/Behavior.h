@@ -7,21 +7,13 @@
 
 namespace Logic {
 	class Enemy;
+	// Data driven trees are in BehaviorTree, used through TreeBehavior
 	class Behavior {
-		protected: // ye this is protected, hater
-			struct BehaviorNode
-			{
-				std::vector<BehaviorNode> children;
-			//	std::function<bool> condition;
-			//	std::function<void> update;
-			};
-		private:
-			BehaviorNode root;
 		public:
 			virtual void update(Enemy &enemy, Player const &player, float deltaTime) = 0;
 			virtual void updatePath(Entity const &from, Entity const &to) = 0;
 			virtual void debugRendering(Graphics::Renderer &renderer) = 0;
-			BehaviorNode& getRoot() { return root; }
+			virtual void reset() = 0; // called when a pooled enemy is spawned again
 	};
 }
 
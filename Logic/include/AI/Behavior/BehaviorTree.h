@@ -0,0 +1,151 @@
+#ifndef BEHAVIOR_TREE_H
+#define BEHAVIOR_TREE_H
+
+#include <string>
+#include <vector>
+#include <LinearMath/btVector3.h>
+
+#pragma region ClassDesc
+	/*
+		CLASS: BehaviorTree
+		AUTHOR: Lukas Westling
+
+		A behavior tree compiled into one array of nodes in
+		pre-order, the children of node i are [i + 1, next) so
+		the tree is walked by jumping with next instead of
+		following pointers.
+
+		The tree itself is shared and never changes after compile,
+		everything an enemy needs to remember (cooldown timers,
+		last tick, random state) is in its Blackboard.
+
+		Enemies are not ticked one by one, they are queued during
+		the enemy update and the whole batch is ticked at once by
+		BehaviorTreeManager, same nodes for every enemy in a row.
+
+		Timers count down with the time since that enemy last
+		ticked, not with frames, so a cooldown of 1000 ms is
+		1000 ms no matter the frame rate or the AI LOD band.
+
+		The nodes only reach the enemy through an Agent, the
+		game's is EnemyTreeAgent in TreeBehavior. Everything else
+		needs nothing but Bullet's math, to run the trees without
+		the physics (tests).
+	*/
+#pragma endregion
+
+#define BT_MAX_TIMERS 4 // cooldown nodes per tree
+
+namespace Logic
+{
+	class VisibilityService;
+
+	class BehaviorTree
+	{
+	public:
+		enum NODE_TYPE
+		{
+			SELECTOR,	// first child that succeeds
+			SEQUENCE,	// all children until one fails
+			PARALLEL,	// every child, succeeds if any did
+			CONDITION,
+			ACTION,
+			NR_OF_NODE_TYPES
+		};
+
+		enum CONDITION_ID
+		{
+			PLAYER_FURTHER_THAN,	// value = distance
+			PLAYER_CLOSER_THAN,		// value = distance
+			HEALTH_BELOW,			// value = health
+			COOLDOWN,				// ready every [value, valueMax] ms
+			CAN_SEE_PLAYER,			// asks the VisibilityService, always true without one
+			NR_OF_CONDITIONS
+		};
+
+		enum ACTION_ID
+		{
+			MOVE_TO_PLAYER,	// value = speed, 0 uses the enemy move speed
+			USE_ABILITY,
+			PUSH_AWAY,		// value = force
+			NR_OF_ACTIONS
+		};
+
+		// One struct in BehaviorTrees.lw, depth is the indentation in the tree
+		struct NodeDefinition
+		{
+			int depth;
+			std::string type;	// selector, sequence, parallel, condition or action
+			std::string name;	// the condition/action, empty for the rest
+			float value, valueMax;
+		};
+
+		struct Node
+		{
+			NODE_TYPE type;
+			int id;			// CONDITION_ID or ACTION_ID
+			int next;		// index after the subtree of this node
+			int slot;		// timer slot for COOLDOWN, -1 otherwise
+			float value, valueMax;
+		};
+
+		struct Blackboard
+		{
+			float timers[BT_MAX_TIMERS];	// ms left
+			float lastTick;					// BehaviorTreeManager time of the last tick
+			unsigned int seed;
+		};
+
+		// What the conditions and actions ask and tell an enemy
+		class Agent
+		{
+		public:
+			Blackboard blackboard;
+
+			virtual ~Agent() {}
+
+			virtual btVector3 getPosition() const = 0;
+			virtual float getHealth() const = 0;
+
+			// called before the tree runs, actions that move set the movement again
+			virtual void beginTick() = 0;
+			// speed is units per second, 0 uses the enemy move speed
+			virtual bool moveToPlayer(float speed, float deltaTime) = 0;
+			virtual bool useAbility() = 0;
+			virtual bool pushAway(float force) = 0;
+		};
+
+		BehaviorTree();
+		~BehaviorTree();
+
+		// returns 0 on success, -1 if the definitions doesn't form a tree
+		int compile(std::string const &name, std::vector<NodeDefinition> const &definitions);
+
+		// every timer starts somewhere in its range so enemies spawned together don't sync up
+		void initBlackboard(Blackboard &blackboard, unsigned int seed, float time) const;
+
+		// the agent has to live until the next tickBatch
+		void queue(Agent *agent);
+		// returns how many agents were ticked, the queue is empty afterwards
+		int tickBatch(btVector3 const &playerPosition, float deltaTime, float time, VisibilityService *visibility = nullptr);
+
+		std::string const & getName() const;
+		std::vector<Node> const & getNodes() const;
+		int getQueued() const;
+	private:
+		std::string m_name;
+		std::vector<Node> m_nodes;
+		std::vector<Agent*> m_queue;
+		int m_timerCount;
+		VisibilityService *m_visibility; // only set during tickBatch
+
+		bool run(int index, Agent &agent, btVector3 const &playerPosition, float deltaTime) const;
+		bool condition(Node const &node, Agent &agent, btVector3 const &playerPosition) const;
+		bool action(Node const &node, Agent &agent, float deltaTime) const;
+
+		static float nextRandom(Blackboard &blackboard); // [0, 1)
+		static int findName(char const * const *names, int count, std::string const &name);
+	};
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef BEHAVIOR_TREE_MANAGER_H
+#define BEHAVIOR_TREE_MANAGER_H
+
+#include <string>
+#include <vector>
+#include <AI/Behavior/BehaviorTree.h>
+
+#pragma region ClassDesc
+	/*
+		CLASS: BehaviorTreeManager
+		AUTHOR: Lukas Westling
+
+		Singleton that loads every tree in BehaviorTrees.lw and
+		ticks the enemies queued on them, one tree at a time.
+
+		Owns the AI clock, it is advanced by tick() every frame
+		so blackboards can tell how long it was since they ticked.
+
+		HOW TO USE:
+			new TreeBehavior(BehaviorTreeManager::singleton().getTree("ranged"));
+			...
+			BehaviorTreeManager::singleton().tick(player.getPositionBT(), deltaTime); // once per frame, after the enemies update
+	*/
+#pragma endregion
+
+#define BT_FILE_NAME "BehaviorTrees"
+
+namespace Logic
+{
+	class BehaviorTreeManager
+	{
+	public:
+		static BehaviorTreeManager& singleton()
+		{
+			static BehaviorTreeManager manager;
+			return manager;
+		}
+
+		~BehaviorTreeManager();
+
+		// returns the FileLoader result, or -1 if a tree failed to compile
+		// trees that already exist are compiled in place so TreeBehaviors keep their pointer
+		int loadTrees(std::string const &fileName = BT_FILE_NAME);
+
+		// nullptr if there is no tree with the name
+		BehaviorTree* getTree(std::string const &name);
+
+		// visibility is used by canSeePlayer conditions, flush it after this
+		void tick(btVector3 const &playerPosition, float deltaTime, VisibilityService *visibility = nullptr);
+
+		float getTime() const;
+		int getTicksThisFrame() const;
+		unsigned int nextSeed();
+	private:
+		BehaviorTreeManager();
+
+		std::vector<BehaviorTree*> m_trees;
+		float m_time;
+		int m_ticks;
+		unsigned int m_seed;
+	};
+}
+
+#endif
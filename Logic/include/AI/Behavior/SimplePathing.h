@@ -26,6 +26,7 @@ namespace Logic
 			Entity const &from, Entity const &to);
 
 			void loadPath(Entity const &from, Entity const &to);
+			void clear(); // keeps the capacity, next update loads a new path
 			std::vector<const DirectX::SimpleMath::Vector3*>& getPath();
 
 			const DirectX::SimpleMath::Vector3* getNode() const;
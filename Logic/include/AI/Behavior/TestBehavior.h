@@ -17,6 +17,7 @@ namespace Logic
 		virtual void update(Enemy &enemy, Player const &player, float deltaTime);
 		virtual void updatePath(Entity const &from, Entity const &to);
 		virtual void debugRendering(Graphics::Renderer &renderer);
+		virtual void reset();
 	};
 }
 
@@ -0,0 +1,46 @@
+#ifndef TREE_BEHAVIOR_H
+#define TREE_BEHAVIOR_H
+
+#include "Behavior.h"
+#include "BehaviorTree.h"
+
+namespace Logic
+{
+	// The enemy as the BehaviorTree sees it, walks it along its own path
+	class EnemyTreeAgent : public BehaviorTree::Agent
+	{
+	public:
+		Enemy *enemy;			// set every time it is queued
+		Player const *player;
+		SimplePathing path;
+
+		EnemyTreeAgent();
+
+		virtual btVector3 getPosition() const;
+		virtual float getHealth() const;
+
+		virtual void beginTick();
+		virtual bool moveToPlayer(float speed, float deltaTime);
+		virtual bool useAbility();
+		virtual bool pushAway(float force);
+	};
+
+	// Behavior that runs a BehaviorTree from data, update only queues
+	// the enemy, the tree is ticked later by BehaviorTreeManager
+	class TreeBehavior : public Behavior
+	{
+	private:
+		BehaviorTree *m_tree;
+		EnemyTreeAgent m_agent;
+	public:
+		TreeBehavior(BehaviorTree *tree);
+		virtual ~TreeBehavior() {}
+
+		virtual void update(Enemy &enemy, Player const &player, float deltaTime);
+		virtual void updatePath(Entity const &from, Entity const &to);
+		virtual void debugRendering(Graphics::Renderer &renderer);
+		virtual void reset();
+	};
+}
+
+#endif
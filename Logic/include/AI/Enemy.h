@@ -4,6 +4,7 @@
 #include <Entity\Entity.h>
 #include <Player\Player.h>
 #include <AI\Behavior\Behavior.h>
+#include <AI\LodScheduler.h>
 #include <Projectile\ProjectileManager.h>
 
 #pragma region Comment
@@ -30,16 +31,22 @@ namespace Logic
 			float m_moveSpeedMod;									// Variables for effect modifiers
 			int m_enemyType;
 			ProjectileManager *m_projectiles;
+			LodScheduler::Agent m_lod;							// Set by EntityManager when spawned
 			// Animation m_animation;
 		public:	
-			enum BEHAVIOR_ID { TEST, RANGED };
+			enum BEHAVIOR_ID { TEST, RANGED }; // RANGED is the "ranged" tree in BehaviorTrees.lw
+			enum ENEMY_TYPE { NECROMANCER, ENEMY_TEST, NR_OF_ENEMY_TYPES };
 
 			Enemy(Graphics::ModelID modelID, btRigidBody* body, btVector3 halfExtent, float maxHealth, float baseDamage, float moveSpeed, int enemyType, int animationId);
 			virtual ~Enemy();
 
 			void setProjectileManager(ProjectileManager *projectileManager);
+			// Puts the enemy back to its spawn state without reallocating anything (used by EnemyPool)
+			void reset(btVector3 const &position);
 
 			virtual void update(Player const &player, float deltaTime, bool updatePath = false);
+			// Used on frames the LodScheduler skips, moves the enemy like the last think without running the behavior
+			void updateExtrapolated(Player const &player, float deltaTime);
 			virtual void useAbility(Entity const &target) {};
 			virtual void updateDead(float deltaTime) = 0;
 			virtual void updateSpecific(Player const &player, float deltaTime) = 0;
@@ -57,6 +64,7 @@ namespace Logic
 			float getBaseDamage() const;
 			float getMoveSpeed() const;
 			int getEnemyType() const;
+			LodScheduler::Agent& getLodAgent();
 
 			void spawnProjectile(btVector3 dir, Graphics::ModelID id, float speed);
 			ProjectileManager* getProjectileManager() const;
@@ -0,0 +1,71 @@
+#ifndef ENEMY_POOL_H
+#define ENEMY_POOL_H
+
+#include <vector>
+#include <AI\Enemy.h>
+#include <Physics\Physics.h>
+#include <Projectile\ProjectileManager.h>
+
+#pragma region ClassDesc
+	/*
+		CLASS: EnemyPool
+		AUTHOR: Lukas Westling
+
+		Owns every enemy, one free list per enemy type.
+
+		Enemies are created once (prewarm) together with their
+		body, shape, behavior and status manager, and after that
+		only reset in place. Bodies of enemies that are not
+		spawned are kept out of the physics world.
+
+		Life of an enemy:
+			spawn()		- taken from the free list, reset and added to the world
+			kill()		- removed from the world, still rendered as a corpse
+			release()	- back on the free list
+	*/
+#pragma endregion
+
+namespace Logic
+{
+	class EnemyPool
+	{
+	public:
+		struct Stats
+		{
+			int active;		// spawned or dead but not released
+			int free;		// ready to be spawned
+			int created;	// total, only grows on prewarm or a pool miss
+		};
+
+		EnemyPool();
+		EnemyPool(EnemyPool const &other) = delete;
+		EnemyPool* operator=(EnemyPool const &other) = delete;
+		~EnemyPool();
+
+		void init(Physics *physics, ProjectileManager *projectiles);
+		// Deletes everything, enemies still in the physics world have their body deleted by Physics
+		void clear();
+
+		// makes sure at least count enemies of this type exists
+		void prewarm(Enemy::ENEMY_TYPE type, int count);
+
+		Enemy* spawn(Enemy::ENEMY_TYPE type, btVector3 const &position);
+		void kill(Enemy *enemy);
+		void release(Enemy *enemy);
+
+		Stats getStats(Enemy::ENEMY_TYPE type) const;
+		int getMisses() const;
+		static const char* getTypeName(Enemy::ENEMY_TYPE type);
+	private:
+		Physics *m_physics;
+		ProjectileManager *m_projectiles;
+
+		std::vector<Enemy*> m_created[Enemy::NR_OF_ENEMY_TYPES];
+		std::vector<Enemy*> m_free[Enemy::NR_OF_ENEMY_TYPES];
+		int m_misses;
+
+		Enemy* create(Enemy::ENEMY_TYPE type);
+	};
+}
+
+#endif
@@ -5,7 +5,11 @@
 
 #include <AI/Enemy.h>
 #include <AI/WaveManager.h>
+#include <AI/SpawnScheduler.h>
 #include <AI/TriggerManager.h>
+#include <AI/LodScheduler.h>
+#include <AI/EnemyPool.h>
+#include <AI/VisibilityService.h>
 
 #include <Player\Player.h>
 #include <Projectile\ProjectileManager.h>
@@ -22,6 +26,9 @@
 		with the help of WaveManager.
 
 		It also handles triggers and how it spawns. (WaveManager?)
+
+		Waves are read from Waves.lw, and spawned over a few
+		frames by the SpawnScheduler.
 	*/
 #pragma endregion
 
@@ -35,20 +42,35 @@ namespace Logic
 
 		TriggerManager m_triggerManager;
 		WaveManager m_waveManager;
+		SpawnScheduler m_spawnScheduler;
+		VisibilityService m_visibility;
+		WorldLineOfSight m_lineOfSight;
+		Physics *m_physics;
+		LodScheduler m_lodScheduler;
+		EnemyPool m_enemyPool;
+		std::vector<std::string> m_lodCounterNames, m_poolCounterNames; // profiler needs the names to stay alive
 		int m_currentWave, m_frame;
 
 		void reserveData(); // reserve space in vectors
+		Enemy* spawnEnemy(Enemy::ENEMY_TYPE type, btVector3 const &position);
+		void releaseDeadEnemies();
+		void updateSpawns(float deltaTime);
 	public:
 		EntityManager();
 		EntityManager(EntityManager const &entityManager) = delete;
 		~EntityManager();
 
+		// Creates all enemies the waves will need, call during load
+		void initialize(Physics &physics, ProjectileManager *projectiles);
 		void update(Player const &player, float deltaTime);
 		void clear();
 
 		void spawnWave(Physics &physics, ProjectileManager *projectiles);
 
 		void setCurrentWave(int currentWave);
+		LodScheduler& getLodScheduler();
+		WaveManager const & getWaveManager() const;
+		EnemyPool const & getEnemyPool() const;
 		void render(Graphics::Renderer &renderer);
 
 		int getEnemiesAlive() const;
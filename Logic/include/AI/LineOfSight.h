@@ -0,0 +1,86 @@
+#ifndef LINE_OF_SIGHT_H
+#define LINE_OF_SIGHT_H
+
+#include <vector>
+#include <string>
+#include <LinearMath/btVector3.h>
+#include <LinearMath/btMatrix3x3.h>
+
+class btCollisionWorld;
+
+#pragma region ClassDesc
+	/*
+		CLASS: LineOfSight
+		AUTHOR: Lukas Westling
+
+		What VisibilityService casts its rays against. Every ray
+		of a tick goes to the same point (the player), so they
+		are all asked for in one call.
+
+		WorldLineOfSight is the game's, rays through the physics
+		world where only static bodies block. BoxLineOfSight is a
+		list of boxes and needs nothing but Bullet's math, to run
+		the AI without the physics (tests and benchmarks).
+
+		HOW TO USE:
+			BoxLineOfSight boxes;
+			boxes.load(MAP_HITBOX_FILE);	// or addBox for each
+			visibility.init(&boxes);
+	*/
+#pragma endregion
+
+#define MAP_HITBOX_FILE "MapHitboxes" // the buildings of the map, Map makes its hitboxes from it
+
+namespace Logic
+{
+	class LineOfSight
+	{
+	public:
+		struct Ray
+		{
+			btVector3 from;
+			bool visible;	// the answer, nothing between from and to
+		};
+
+		virtual ~LineOfSight() {}
+
+		virtual void castRays(Ray *rays, int count, btVector3 const &to) = 0;
+	};
+
+	class WorldLineOfSight : public LineOfSight
+	{
+	public:
+		WorldLineOfSight();
+
+		void init(btCollisionWorld *world);
+		virtual void castRays(Ray *rays, int count, btVector3 const &to);
+	private:
+		btCollisionWorld *m_world;
+	};
+
+	class BoxLineOfSight : public LineOfSight
+	{
+	public:
+		// the boxes of a .lw like MAP_HITBOX_FILE, returns the FileLoader error
+		int load(std::string const &fileName);
+		// rotation is in radians, the same euler angles as a Cube
+		void addBox(btVector3 const &position, btVector3 const &rotation, btVector3 const &halfExtent);
+		void clear();
+		int getBoxCount() const;
+
+		virtual void castRays(Ray *rays, int count, btVector3 const &to);
+	private:
+		struct Box
+		{
+			btVector3 position, halfExtent;
+			btMatrix3x3 toLocal;
+			btVector3 min, max; // world bounds, most rays miss most boxes
+		};
+
+		std::vector<Box> m_boxes;
+
+		static bool intersects(Box const &box, btVector3 const &from, btVector3 const &to);
+	};
+}
+
+#endif
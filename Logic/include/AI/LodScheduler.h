@@ -0,0 +1,87 @@
+#ifndef LOD_SCHEDULER_H
+#define LOD_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <LinearMath/btVector3.h>
+
+#pragma region ClassDesc
+	/*
+		CLASS: LodScheduler
+		AUTHOR: Lukas Westling
+
+		Decides how often an enemy is allowed to run its
+		behavior (think) depending on the distance to the player
+		and if it is inside the players view cone.
+
+		Bands are loaded from AILod.lw, the first band that
+		contains the distance is used. Each enemy gets a phase
+		when spawned so enemies in the same band think on
+		different frames instead of all at once.
+
+		Phases come from a seeded generator owned by this class
+		and not rand(), so the same seed gives the same schedule.
+	*/
+#pragma endregion
+
+#define LOD_FILE_NAME		"AILod"
+#define LOD_DEFAULT_SEED	1337u
+#define LOD_VIEW_CONE_COS	0.5f	// cos(60 deg), outside this the enemy counts as hidden
+
+namespace Logic
+{
+	class LodScheduler
+	{
+	public:
+		struct Band
+		{
+			std::string name;
+			float maxDistance;	// in world units, bands should be sorted by this
+			int interval;		// think every interval frames when visible
+			int hiddenInterval;	// think every hiddenInterval frames when behind the player
+		};
+
+		// Per enemy state, lives in the enemy so it follows it through the swap-pops
+		struct Agent
+		{
+			int phase;
+			int band;
+			btVector3 velocity; // movement per ms from the last think, used in between
+		};
+
+		LodScheduler(unsigned int seed = LOD_DEFAULT_SEED);
+		~LodScheduler();
+
+		// returns the FileLoader result, the default bands are kept on failure
+		int loadBands(std::string const &fileName = LOD_FILE_NAME);
+		void setBands(std::vector<Band> const &bands);
+		void setSeed(unsigned int seed);
+
+		void initAgent(Agent &agent);
+
+		// call once per frame before schedule()
+		void beginFrame(btVector3 const &viewPosition, btVector3 const &viewForward);
+		bool schedule(Agent &agent, btVector3 const &position);
+		// how far a skipped agent moves this frame, keeps going like its last think
+		static btVector3 getExtrapolatedStep(Agent const &agent, float deltaTime);
+
+		int getBandCount() const;
+		int getAgentsInBand(int band) const;
+		int getThinksThisFrame() const;
+		Band const & getBand(int band) const;
+		int getFrame() const;
+	private:
+		std::vector<Band> m_bands;
+		std::vector<int> m_agentsInBand;
+		int m_thinks;
+		int m_frame;
+
+		unsigned int m_seed, m_state;
+		btVector3 m_viewPosition, m_viewForward;
+
+		unsigned int nextRandom();
+		void setDefaultBands();
+	};
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef SPAWN_SCHEDULER_H
+#define SPAWN_SCHEDULER_H
+
+#include <vector>
+#include <AI/WaveManager.h>
+
+#pragma region ClassDesc
+	/*
+		CLASS: SpawnScheduler
+		AUTHOR: Lukas Westling
+
+		Turns a wave into a timeline of spawn events and hands
+		them out a few per frame, so a wave start doesn't create
+		every body (and trigger) on the same frame.
+
+		Enemy groups are interleaved so the types mix, and the
+		times follow the curve of the wave. Positions are spread
+		on a spiral around the group position, no randomness, the
+		same wave always gives the same timeline.
+
+		A wave that starts before the last one is done spawning
+		doesn't drop what's left of it, those spawns keep their
+		time and are merged into the new timeline.
+
+		HOW TO USE:
+			scheduler.start(*wave);
+			scheduler.update(deltaTime);
+			while (scheduler.popEvent(event)) spawn(event);
+	*/
+#pragma endregion
+
+#define SPAWN_MAX_PER_FRAME 2
+
+namespace Logic
+{
+	class SpawnScheduler
+	{
+	public:
+		struct SpawnEvent
+		{
+			enum KIND { ENEMY, TRIGGER };
+
+			float time;			// ms after the wave started
+			KIND kind;
+			int index;			// enemy type or index into wave->triggers
+			btVector3 position;
+			WaveManager::Wave const *wave;	// the one it's from, not always the current one
+		};
+
+		SpawnScheduler(int maxPerFrame = SPAWN_MAX_PER_FRAME);
+		~SpawnScheduler();
+
+		// reserve once during load so start() doesn't allocate mid-game,
+		// events is the most any wave has
+		void reserve(int events);
+
+		// Times are from now on, the spawns not popped yet are kept
+		void start(WaveManager::Wave const &wave);
+		void clear();
+		void update(float deltaTime);
+		bool popEvent(SpawnEvent &event);
+
+		bool isDone() const;
+		int getPending() const;
+		float getTime() const;
+		std::vector<SpawnEvent> const & getTimeline() const;
+
+		static float applyCurve(WaveManager::SPAWN_CURVE curve, float t);
+	private:
+		std::vector<SpawnEvent> m_timeline;
+		std::vector<SpawnEvent> m_carried; // what's left of the last wave while a new one starts
+		size_t m_next;
+		float m_time;
+		int m_maxPerFrame, m_poppedThisFrame;
+
+		void merge();
+	};
+}
+
+#endif
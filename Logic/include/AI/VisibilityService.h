@@ -0,0 +1,93 @@
+#ifndef VISIBILITY_SERVICE_H
+#define VISIBILITY_SERVICE_H
+
+#include <vector>
+#include <unordered_map>
+#include <AI/LineOfSight.h>
+
+#pragma region ClassDesc
+	/*
+		CLASS: VisibilityService
+		AUTHOR: Lukas Westling
+
+		Answers "can this position see the player" for the
+		enemies without one ray per enemy per think.
+
+		Positions are snapped to cells, every enemy standing in
+		the same cell shares the answer. Answers are kept for a
+		few ticks, and all of them are thrown away when the
+		player has moved far from where they were cast to.
+
+		A question that isn't cached is queued and answered as
+		not visible, the queued cells are cast together in
+		flush() and are cached for the next tick.
+
+		The rays are cast by a LineOfSight, the physics world in
+		the game (only static bodies block, so enemies and the
+		player don't hide the player from each other), or boxes
+		to run it without the rest of the game.
+
+		HOW TO USE:
+			visibility.beginFrame(playerPosition);
+			bool visible = visibility.isVisible(enemyPosition); // any number of times
+			visibility.flush();
+	*/
+#pragma endregion
+
+#define LOS_CELL_SIZE			2.f		// world units
+#define LOS_CACHE_TICKS			6		// ticks an answer is kept
+#define LOS_INVALIDATE_DISTANCE 2.f		// player movement before the whole cache is dropped
+
+namespace Logic
+{
+	class VisibilityService
+	{
+	public:
+		struct Stats
+		{
+			int hits;	// answered from the cache
+			int misses;	// had to be queued
+			int rays;	// cast in the last flush
+		};
+
+		VisibilityService(float cellSize = LOS_CELL_SIZE, int cacheTicks = LOS_CACHE_TICKS,
+			float invalidateDistance = LOS_INVALIDATE_DISTANCE);
+		~VisibilityService();
+
+		void init(LineOfSight *lineOfSight);
+		void clear();
+
+		// call once per tick with where the rays should go to
+		void beginFrame(btVector3 const &target);
+		bool isVisible(btVector3 const &from);
+		// casts every queued cell, returns how many rays were cast
+		int flush();
+
+		Stats const & getStats() const; // for this tick
+		int getCachedCells() const;
+	private:
+		struct Cell
+		{
+			int tick;		// tick it was cast, -1 while queued
+			bool visible;
+			btVector3 from;
+		};
+
+		LineOfSight *m_lineOfSight;
+		std::unordered_map<unsigned long long, Cell> m_cells;
+		std::vector<unsigned long long> m_queued;
+		std::vector<LineOfSight::Ray> m_rays;
+
+		float m_cellSize;
+		int m_cacheTicks;
+		float m_invalidateDistance;
+
+		int m_tick;
+		btVector3 m_target, m_castTarget;
+		Stats m_stats;
+
+		unsigned long long getKey(btVector3 const &position) const;
+	};
+}
+
+#endif
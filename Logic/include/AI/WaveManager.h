@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <LinearMath/btVector3.h>
 
 #pragma region ClassDesc
 	/*
@@ -12,24 +13,84 @@
 		This class loads the wave from a file,
 		and is used by EntityManager to spawn the
 		wave.
+
+		A wave is split into three files so every struct
+		stays flat (FileLoader can't nest):
+			<name>.lw			- one struct per wave, in order: start time, spawn time and curve
+			<name>Spawns.lw		- enemy groups, "wave" is the 1-based wave they belong to
+			<name>Triggers.lw	- jump pads, ammo refills etc. for a wave
+
+		Ids (enemy type, model, effects, upgrades) are kept
+		as ints here so this can be loaded without graphics,
+		EntityManager casts them when spawning.
 	*/
 #pragma endregion
 
+#define WAVE_FILE_NAME "Waves"
+
 namespace Logic
 {
 	class WaveManager
 	{
-		private:
-			std::string m_waveFileName;
 		public:
+			// How the spawns are spread over the spawn time
+			enum SPAWN_CURVE
+			{
+				CURVE_LINEAR,	// evenly
+				CURVE_EASE_IN,	// few at the start, more at the end
+				CURVE_EASE_OUT,	// most at the start
+				CURVE_BURST		// everything at once (still capped per frame)
+			};
+
+			struct SpawnGroup
+			{
+				int enemyType;
+				int count;
+				btVector3 position;
+				float spread; // radius the group is spread out on
+			};
+
+			struct TriggerDefinition
+			{
+				int modelID;
+				btVector3 position;
+				btVector3 halfExtent;
+				float cooldown;
+				bool reusable;
+				std::vector<int> upgrades;
+				std::vector<int> effects;
+			};
+
+			struct Wave
+			{
+				float time;			// ms from game start when the wave begins
+				float spawnTime;	// ms the spawns are spread over
+				SPAWN_CURVE curve;
+				std::vector<SpawnGroup> spawns;
+				std::vector<TriggerDefinition> triggers;
+			};
+
 			WaveManager(std::string waveFileName = "");
 			~WaveManager();
 
+			// returns the FileLoader error of the first file that failed, 0 on success
+			int loadWaves();
+
+			// waveId is 1-based like EntityManager::m_currentWave, 0 or out of range gives an empty list
 			std::vector<int> getEnemies(int waveId);
+			Wave const * getWave(int waveId) const;
+			int getWaveCount() const;
+			float getWaveTime(int index) const; // index is 0-based, the time wave index + 1 starts
+			int getEnemyCount(int enemyType) const; // over all waves
 
 			void setName(std::string name);
 			std::string getWaveFileName() const;
+		private:
+			std::string m_waveFileName;
+			std::vector<Wave> m_waves;
+
+			static SPAWN_CURVE getCurve(std::string const &name);
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
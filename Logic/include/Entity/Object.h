@@ -15,17 +15,30 @@ namespace Logic
 		virtual ~Object();
 		virtual void render(Graphics::Renderer& renderer);
 
+		// Static objects are registered with the renderer on the first render and
+		// only sent again when they change. Whoever deletes them has to call
+		// Renderer::clearStatics, see Game
+		void setStatic(bool isStatic);
+		// Solid boxes that hide what is behind them, the renderer skips
+		// instances they cover. Only used on static objects
+		void setOccluder(bool occluder);
+
 		void setShouldRender(bool render);
 		void setMaterialID(int id);
 		void setModelID(Graphics::ModelID modelID);
 		void setWorldTranslation(DirectX::SimpleMath::Matrix translation);
 		bool getShouldRender() const;
+		bool isStatic() const;
 		int getMaterialID() const;
 		Graphics::ModelID getModelID() const;
 		DirectX::SimpleMath::Matrix getWorldTranslation() const;
 
 	private:
 		Graphics::RenderInfo m_renderInfo;
+
+		bool m_static;
+		bool m_staticDirty;
+		int m_staticHandle;	// -1 until registered
 	};
 }
 
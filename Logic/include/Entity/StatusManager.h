@@ -57,6 +57,10 @@ namespace Logic
 		static const int NR_OF_EFFECTS = EFFECT_ID::LAST_ITEM_IN_EFFECTS, NR_OF_UPGRADES = UPGRADE_ID::LAST_ITEM_IN_UPGRADES;
 		static Effect s_effects[NR_OF_EFFECTS];
 		static Upgrade s_upgrades[NR_OF_UPGRADES];
+		static bool s_loaded;
+
+		// reads Effects.lw into s_effects
+		static void loadEffects();
 
 		// m_effectStacksIds[i] = id of the effect at m_effectsStacks[i]
 		std::vector<EffectStack> m_effectStacks; // fast loop speed bad lookup, but worth it? :<
@@ -29,14 +29,8 @@
 #define PLAYER_START_POS	btVector3(0.0f, 6.0f, 0.0f)
 #define PLAYER_START_ROT	btVector3(0.0f, 0.0f, 0.0f)
 
-// Init Waves (wave times are in ms)
-#define MAX_WAVES			5
+// Init Waves (wave times are in Waves.lw)
 #define WAVE_START			0		// If you wanna test certain waves for debugging
-#define WAVE_1_TIME			3000.f
-#define WAVE_2_TIME			15000.f
-#define WAVE_3_TIME			25000.f
-#define WAVE_4_TIME			35000.f
-#define WAVE_5_TIME			60000.f
 
 
 
@@ -71,11 +65,11 @@ namespace Logic
 		EntityManager		m_entityManager;
 		GameTime			m_gameTime;
 		CardManager*		m_cardManager;
+		bool				m_clearStatics;	// the map was deleted, the renderer still has its static objects
 
 		// Wave
 		int		m_waveCurrent;
 		float	m_waveTimer;
-		float	m_waveTime[MAX_WAVES];
 	};
 }
 
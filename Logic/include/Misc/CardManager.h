@@ -18,6 +18,9 @@ namespace Logic
 		void clear();
 		void init();
 		void restart();
+		// Cards.lw again, while playing. Deck and hand are kept if the cards still exist,
+		// nothing changes if the file can't be read or has no cards
+		void reload();
 
 		void createDeck(int nrOfEach);
 		void pickThree(bool damaged);
@@ -31,6 +34,10 @@ namespace Logic
 		std::vector<Card> m_cards;
 		std::vector<int> m_deck;
 		int m_hand[CardManager::handSize];
+		unsigned int m_watch;
+
+		// the FileLoader result, 0 on success
+		int loadCards(std::vector<Card> &cards);
 	};
 }
 
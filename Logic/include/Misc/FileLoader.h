@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <functional>
 
 #pragma region ClassDesc
 	/*
@@ -42,6 +43,11 @@ namespace Logic {
 		not exceptions due to various reasons. */
 		int loadStructsFromFile(std::vector<LoadedStruct> &loadedStructs, std::string const &fileName, int offset = 0, int fileOffset = 0, int filePadding = 0);
 		int saveStructsToFile(std::vector<LoadedStruct> &loadedStructs, std::string const &fileName);
+
+		/* onChange is called when the file is changed on disk, at the start of a frame, to load it again (see Graphics::HotReloader).
+		@returns: what unwatchFile takes */
+		unsigned int watchFile(std::string const &fileName, std::function<void()> onChange);
+		void unwatchFile(unsigned int watch);
 	};
 }
 
@@ -40,6 +40,7 @@ namespace Logic
 		void clear();						//< Clears current menu layout
 		void update(float dt);
         void render(Graphics::Renderer& renderer);
+		void preloadTextures(Graphics::Renderer& renderer);	//< Loads what the state being switched to draws
 
 		void showMenu(GameState state);		//< Creates a menu layout
 		GameState currentState();
@@ -130,8 +130,8 @@ namespace Logic
 		float getMoveSpeed() const;
 		void setMoveSpeed(float speed);
 		void setMoveDirection(btVector3 moveDir);
-		btVector3 getForwardBT();
-		DirectX::SimpleMath::Vector3 getForward();
+		btVector3 getForwardBT() const;
+		DirectX::SimpleMath::Vector3 getForward() const;
 		btVector3 getMoveDirection();
 	};
 
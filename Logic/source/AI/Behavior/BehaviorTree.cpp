@@ -0,0 +1,242 @@
+#include <AI/Behavior/BehaviorTree.h>
+#include <AI/VisibilityService.h>
+#include <stdio.h>
+using namespace Logic;
+
+// same order as the enums, these are the names used in BehaviorTrees.lw
+static char const * const NODE_TYPE_NAMES[] = { "selector", "sequence", "parallel", "condition", "action" };
+static char const * const CONDITION_NAMES[] = { "playerFurtherThan", "playerCloserThan", "healthBelow", "cooldown", "canSeePlayer" };
+static char const * const ACTION_NAMES[] = { "moveToPlayer", "useAbility", "pushAway" };
+
+BehaviorTree::BehaviorTree()
+{
+	m_timerCount = 0;
+	m_visibility = nullptr;
+}
+
+BehaviorTree::~BehaviorTree()
+{
+}
+
+int BehaviorTree::findName(char const * const *names, int count, std::string const &name)
+{
+	for (int i = 0; i < count; i++)
+		if (name == names[i])
+			return i;
+	return -1;
+}
+
+int BehaviorTree::compile(std::string const &name, std::vector<NodeDefinition> const &definitions)
+{
+	m_name = name;
+	m_nodes.clear();
+	m_queue.clear();
+	m_timerCount = 0;
+
+	if (definitions.empty() || definitions[0].depth != 0)
+	{
+		printf("Behavior tree %s has no root (BehaviorTree.cpp:%d)\n", name.c_str(), __LINE__);
+		return -1;
+	}
+
+	m_nodes.reserve(definitions.size());
+	for (size_t i = 0; i < definitions.size(); i++)
+	{
+		NodeDefinition const &definition = definitions[i];
+		int type = findName(NODE_TYPE_NAMES, NR_OF_NODE_TYPES, definition.type);
+		if (type < 0)
+		{
+			printf("Behavior tree %s, unknown node type %s (BehaviorTree.cpp:%d)\n", name.c_str(), definition.type.c_str(), __LINE__);
+			return -1;
+		}
+
+		Node node;
+		node.type = static_cast<NODE_TYPE> (type);
+		node.id = 0;
+		node.slot = -1;
+		node.value = definition.value;
+		node.valueMax = definition.valueMax < definition.value ? definition.value : definition.valueMax;
+		if (node.type == CONDITION)
+			node.id = findName(CONDITION_NAMES, NR_OF_CONDITIONS, definition.name);
+		else if (node.type == ACTION)
+			node.id = findName(ACTION_NAMES, NR_OF_ACTIONS, definition.name);
+		if (node.id < 0)
+		{
+			printf("Behavior tree %s, unknown %s %s (BehaviorTree.cpp:%d)\n", name.c_str(), definition.type.c_str(), definition.name.c_str(), __LINE__);
+			return -1;
+		}
+
+		if (node.type == CONDITION && node.id == COOLDOWN)
+		{
+			if (m_timerCount >= BT_MAX_TIMERS)
+			{
+				printf("Behavior tree %s has more than %d cooldowns (BehaviorTree.cpp:%d)\n", name.c_str(), BT_MAX_TIMERS, __LINE__);
+				return -1;
+			}
+			node.slot = m_timerCount++;
+		}
+
+		// depth can only go one step down at a time, and only below a composite
+		if (i > 0 && (definition.depth < 1 || definition.depth > definitions[i - 1].depth + 1 ||
+			(definition.depth > definitions[i - 1].depth && m_nodes.back().type >= CONDITION)))
+		{
+			printf("Behavior tree %s, node %d has a bad depth (BehaviorTree.cpp:%d)\n", name.c_str(), (int)i, __LINE__);
+			return -1;
+		}
+
+		m_nodes.push_back(node);
+	}
+
+	// the subtree ends at the first node that isn't deeper
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		size_t next = i + 1;
+		while (next < m_nodes.size() && definitions[next].depth > definitions[i].depth)
+			next++;
+		m_nodes[i].next = (int)next;
+	}
+
+	return 0;
+}
+
+void BehaviorTree::initBlackboard(Blackboard &blackboard, unsigned int seed, float time) const
+{
+	blackboard.seed = seed;
+	blackboard.lastTick = time;
+	for (int i = 0; i < BT_MAX_TIMERS; i++)
+		blackboard.timers[i] = 0.f;
+
+	for (Node const &node : m_nodes)
+		if (node.slot >= 0)
+			blackboard.timers[node.slot] = node.valueMax * nextRandom(blackboard);
+}
+
+// Simple LCG, kept in the blackboard so every enemy has its own sequence
+float BehaviorTree::nextRandom(Blackboard &blackboard)
+{
+	blackboard.seed = blackboard.seed * 1664525u + 1013904223u;
+	return (blackboard.seed >> 8) / float(1 << 24);
+}
+
+void BehaviorTree::queue(Agent *agent)
+{
+	m_queue.push_back(agent);
+}
+
+int BehaviorTree::tickBatch(btVector3 const &playerPosition, float deltaTime, float time, VisibilityService *visibility)
+{
+	int ticked = 0;
+	m_visibility = visibility;
+
+	for (Agent *agent : m_queue)
+	{
+		if (agent->getHealth() <= 0) // killed after it was queued
+			continue;
+
+		Blackboard &blackboard = agent->blackboard;
+		float elapsed = time - blackboard.lastTick;
+		blackboard.lastTick = time;
+		for (int i = 0; i < m_timerCount; i++)
+		{
+			// a ready timer that nobody asked stays ready, it doesn't bank time
+			if (blackboard.timers[i] < 0.f)
+				blackboard.timers[i] = 0.f;
+			blackboard.timers[i] -= elapsed;
+		}
+
+		agent->beginTick();
+		if (!m_nodes.empty())
+			run(0, *agent, playerPosition, deltaTime);
+		ticked++;
+	}
+
+	m_queue.clear();
+	m_visibility = nullptr;
+	return ticked;
+}
+
+bool BehaviorTree::run(int index, Agent &agent, btVector3 const &playerPosition, float deltaTime) const
+{
+	Node const &node = m_nodes[index];
+	bool success;
+
+	switch (node.type)
+	{
+		case SELECTOR:
+			for (int child = index + 1; child < node.next; child = m_nodes[child].next)
+				if (run(child, agent, playerPosition, deltaTime))
+					return true;
+			return false;
+		case SEQUENCE:
+			for (int child = index + 1; child < node.next; child = m_nodes[child].next)
+				if (!run(child, agent, playerPosition, deltaTime))
+					return false;
+			return true;
+		case PARALLEL:
+			success = false;
+			for (int child = index + 1; child < node.next; child = m_nodes[child].next)
+				success |= run(child, agent, playerPosition, deltaTime);
+			return success;
+		case CONDITION:
+			return condition(node, agent, playerPosition);
+		case ACTION:
+			return action(node, agent, deltaTime);
+		default:
+			return false;
+	}
+}
+
+bool BehaviorTree::condition(Node const &node, Agent &agent, btVector3 const &playerPosition) const
+{
+	Blackboard &blackboard = agent.blackboard;
+
+	switch (node.id)
+	{
+		case PLAYER_FURTHER_THAN:
+			return (agent.getPosition() - playerPosition).length() > node.value;
+		case PLAYER_CLOSER_THAN:
+			return (agent.getPosition() - playerPosition).length() < node.value;
+		case HEALTH_BELOW:
+			return agent.getHealth() < node.value;
+		case COOLDOWN:
+			if (blackboard.timers[node.slot] > 0.f)
+				return false;
+			// added, so the part of the frame it went past zero counts towards the next one
+			blackboard.timers[node.slot] += node.value + (node.valueMax - node.value) * nextRandom(blackboard);
+			return true;
+		case CAN_SEE_PLAYER:
+			return !m_visibility || m_visibility->isVisible(agent.getPosition());
+		default:
+			return false;
+	}
+}
+
+bool BehaviorTree::action(Node const &node, Agent &agent, float deltaTime) const
+{
+	switch (node.id)
+	{
+		case MOVE_TO_PLAYER:
+			return agent.moveToPlayer(node.value, deltaTime);
+		case USE_ABILITY:
+			return agent.useAbility();
+		case PUSH_AWAY:
+			return agent.pushAway(node.value);
+		default:
+			return false;
+	}
+}
+
+std::string const & BehaviorTree::getName() const
+{
+	return m_name;
+}
+
+std::vector<BehaviorTree::Node> const & BehaviorTree::getNodes() const
+{
+	return m_nodes;
+}
+
+int BehaviorTree::getQueued() const
+{
+	return (int)m_queue.size();
+}
@@ -0,0 +1,101 @@
+#include <AI/Behavior/BehaviorTreeManager.h>
+#include <Misc/FileLoader.h>
+#include <Engine/Constants.h>
+#include <stdio.h>
+using namespace Logic;
+
+#define BT_DEFAULT_SEED 7331u
+
+BehaviorTreeManager::BehaviorTreeManager()
+{
+	m_time = 0.f;
+	m_ticks = 0;
+	m_seed = BT_DEFAULT_SEED;
+
+	if (loadTrees() != 0)
+		printf("Could not load behavior trees from %s (BehaviorTreeManager.cpp:%d)\n", BT_FILE_NAME, __LINE__);
+}
+
+BehaviorTreeManager::~BehaviorTreeManager()
+{
+	for (BehaviorTree *tree : m_trees)
+		delete tree;
+}
+
+int BehaviorTreeManager::loadTrees(std::string const &fileName)
+{
+	std::vector<FileLoader::LoadedStruct> loaded;
+	int result = FileLoader::singleton().loadStructsFromFile(loaded, fileName);
+	if (result != 0)
+		return result;
+
+	// nodes of a tree are next to each other in the file, in pre-order
+	std::vector<std::string> names;
+	std::vector<std::vector<BehaviorTree::NodeDefinition>> definitions;
+	for (auto const &fileStruct : loaded)
+	{
+		std::string const &name = fileStruct.strings.at("tree");
+		if (names.empty() || names.back() != name)
+		{
+			names.push_back(name);
+			definitions.push_back({});
+		}
+
+		BehaviorTree::NodeDefinition definition;
+		definition.depth	= fileStruct.ints.at("depth");
+		definition.type		= fileStruct.strings.at("type");
+		definition.name		= fileStruct.strings.count("name") ? fileStruct.strings.at("name") : "";
+		definition.value	= fileStruct.floats.count("value") ? fileStruct.floats.at("value") : 0.f;
+		definition.valueMax = fileStruct.floats.count("valueMax") ? fileStruct.floats.at("valueMax") : 0.f;
+		definitions.back().push_back(definition);
+	}
+
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		BehaviorTree *tree = getTree(names[i]);
+		if (!tree)
+		{
+			tree = newd BehaviorTree();
+			m_trees.push_back(tree);
+		}
+
+		if (tree->compile(names[i], definitions[i]) != 0)
+			result = -1;
+	}
+
+	return result;
+}
+
+BehaviorTree* BehaviorTreeManager::getTree(std::string const &name)
+{
+	for (BehaviorTree *tree : m_trees)
+		if (tree->getName() == name)
+			return tree;
+	return nullptr;
+}
+
+void BehaviorTreeManager::tick(btVector3 const &playerPosition, float deltaTime, VisibilityService *visibility)
+{
+	m_time += deltaTime;
+	m_ticks = 0;
+
+	for (BehaviorTree *tree : m_trees)
+		m_ticks += tree->tickBatch(playerPosition, deltaTime, m_time, visibility);
+}
+
+float BehaviorTreeManager::getTime() const
+{
+	return m_time;
+}
+
+int BehaviorTreeManager::getTicksThisFrame() const
+{
+	return m_ticks;
+}
+
+// Same LCG as the blackboards, only used to give every blackboard its own seed
+unsigned int BehaviorTreeManager::nextSeed()
+{
+	m_seed = m_seed * 1664525u + 1013904223u;
+	return m_seed;
+}
@@ -41,6 +41,12 @@ void SimplePathing::loadPath(Entity const &from, Entity const &to)
 	m_path = AStar::singleton().getPath(from, to);
 }
 
+void SimplePathing::clear()
+{
+	m_path.clear();
+	m_currentNode = -1;
+}
+
 std::vector<const DirectX::SimpleMath::Vector3*>& SimplePathing::getPath()
 {
 	return m_path;
@@ -7,7 +7,7 @@ TestBehavior::TestBehavior()
 {
 	debugInfo.color = DirectX::SimpleMath::Color(1, 0, 0);
 	debugInfo.useDepth = true;
-	debugInfo.topology = D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP;
+	debugInfo.topology = Graphics::TOPOLOGY_LINESTRIP;
 	debugInfo.points = new std::vector<DirectX::SimpleMath::Vector3>();
 }
 
@@ -52,6 +52,12 @@ void TestBehavior::updatePath(Entity const &from, Entity const &to)
 	}
 }
 
+void TestBehavior::reset()
+{
+	m_path.clear();
+	debugInfo.points->clear();
+}
+
 void TestBehavior::debugRendering(Graphics::Renderer &renderer)
 {
 	if (debugInfo.points)
@@ -0,0 +1,101 @@
+#include <AI\Behavior\TreeBehavior.h>
+#include <AI\Behavior\BehaviorTreeManager.h>
+#include <AI\Enemy.h>
+
+using namespace Logic;
+
+#define BT_NODE_REACHED 0.3f // distance before going to the next path node
+
+EnemyTreeAgent::EnemyTreeAgent()
+{
+	enemy = nullptr;
+	player = nullptr;
+}
+
+btVector3 EnemyTreeAgent::getPosition() const
+{
+	return enemy->getPositionBT();
+}
+
+float EnemyTreeAgent::getHealth() const
+{
+	return enemy->getHealth();
+}
+
+void EnemyTreeAgent::beginTick()
+{
+	// actions that move set this again, used by the LOD in between ticks
+	enemy->getLodAgent().velocity = { 0, 0, 0 };
+}
+
+bool EnemyTreeAgent::moveToPlayer(float speed, float deltaTime)
+{
+	btVector3 pathNode = path.updateAndReturnCurrentNode(*enemy, *player);
+	btVector3 dir = pathNode - enemy->getPositionBT();
+	if (dir.length2() < SIMD_EPSILON) // already on the node
+	{
+		path.setCurrentNode(path.getCurrentNode() + 1);
+		return true;
+	}
+
+	dir = dir.normalize();
+	dir *= deltaTime / 1000.f;
+	dir *= speed > 0.f ? speed : enemy->getMoveSpeed();
+
+	enemy->getRigidbody()->translate(dir);
+	if (deltaTime > 0.f)
+		enemy->getLodAgent().velocity = dir / deltaTime;
+
+	if ((pathNode - enemy->getPositionBT()).length() < BT_NODE_REACHED)
+		path.setCurrentNode(path.getCurrentNode() + 1);
+	return true;
+}
+
+bool EnemyTreeAgent::useAbility()
+{
+	enemy->useAbility(*player);
+	return true;
+}
+
+bool EnemyTreeAgent::pushAway(float force)
+{
+	btVector3 dir = enemy->getPositionBT() - player->getPositionBT();
+	if (dir.length2() < SIMD_EPSILON)
+		return false;
+
+	enemy->getRigidbody()->applyCentralForce(dir.normalize() * force);
+	return true;
+}
+
+TreeBehavior::TreeBehavior(BehaviorTree *tree)
+{
+	m_tree = tree;
+	reset();
+}
+
+void TreeBehavior::update(Enemy &enemy, Player const &player, float deltaTime)
+{
+	m_agent.enemy = &enemy;
+	m_agent.player = &player;
+	if (m_tree)
+		m_tree->queue(&m_agent);
+}
+
+void TreeBehavior::updatePath(Entity const &from, Entity const &to)
+{
+	m_agent.path.loadPath(from, to);
+	m_agent.path.setCurrentNode(0);
+}
+
+void TreeBehavior::debugRendering(Graphics::Renderer &renderer)
+{
+}
+
+void TreeBehavior::reset()
+{
+	m_agent.path.clear();
+
+	BehaviorTreeManager &manager = BehaviorTreeManager::singleton();
+	if (m_tree)
+		m_tree->initBlackboard(m_agent.blackboard, manager.nextSeed(), manager.getTime());
+}
@@ -1,6 +1,7 @@
 #include <AI\Enemy.h>
 #include <AI\Behavior\TestBehavior.h>
-#include <AI\Behavior\RangedBehavior.h>
+#include <AI\Behavior\TreeBehavior.h>
+#include <AI\Behavior\BehaviorTreeManager.h>
 using namespace Logic;
 
 Enemy::Enemy(Graphics::ModelID modelID, btRigidBody* body, btVector3 halfExtent, float health, float baseDamage, float moveSpeed, int enemyType, int animationId)
@@ -9,10 +10,16 @@ Enemy::Enemy(Graphics::ModelID modelID, btRigidBody* body, btVector3 halfExtent,
 	m_behavior = nullptr;
 
 	m_health = health;
+	m_maxHealth = health;
+	m_moveSpeedMod = 0.f;
 	m_baseDamage = baseDamage;
 	m_moveSpeed = moveSpeed;
 	m_enemyType = enemyType;
 
+	m_lod.phase = 0;
+	m_lod.band = 0;
+	m_lod.velocity = { 0, 0, 0 };
+
 	//animation todo
 }
 
@@ -28,7 +35,7 @@ void Enemy::setBehavior(BEHAVIOR_ID id)
 			m_behavior = new TestBehavior();
 			break;
 		case RANGED:
-			m_behavior = new RangedBehavior();
+			m_behavior = new TreeBehavior(BehaviorTreeManager::singleton().getTree("ranged"));
 			break;
 	}
 }
@@ -43,20 +50,61 @@ void Enemy::setProjectileManager(ProjectileManager * projectileManager)
 	m_projectiles = projectileManager;
 }
 
+void Enemy::reset(btVector3 const &position)
+{
+	m_health = m_maxHealth;
+	m_moveSpeedMod = 0.f;
+	m_lod.velocity = { 0, 0, 0 };
+
+	getStatusManager().clear();
+	if (m_behavior)
+		m_behavior->reset();
+
+	btTransform transform;
+	transform.setIdentity();
+	transform.setOrigin(position);
+
+	btRigidBody *body = getRigidbody();
+	body->setWorldTransform(transform);
+	if (body->getMotionState())
+		body->getMotionState()->setWorldTransform(transform);
+	body->setLinearVelocity({ 0, 0, 0 });
+	body->setAngularVelocity({ 0, 0, 0 });
+	body->clearForces();
+
+	updateGraphics();
+}
+
 void Enemy::update(Player const &player, float deltaTime, bool updatePath) {
 	Entity::update(deltaTime);
 	updateSpecific(player, deltaTime);
 
 	if (m_behavior) // remove later for better perf
 	{
+		btVector3 before = getPositionBT();
+
 		if (updatePath)
 			m_behavior->updatePath(*this, player);
 		m_behavior->update(*this, player, deltaTime); // BEHAVIOR IS NOT DONE, FIX LATER K
+
+		// save how the behavior moved us so skipped frames can keep going
+		if (deltaTime > 0.f)
+			m_lod.velocity = (getPositionBT() - before) / deltaTime;
 	}
 
 	m_moveSpeedMod = 0.f; // Reset effect variables, should be in function if more variables are added.
 }
 
+void Enemy::updateExtrapolated(Player const &player, float deltaTime)
+{
+	Entity::update(deltaTime);
+	updateSpecific(player, deltaTime);
+
+	getRigidbody()->translate(LodScheduler::getExtrapolatedStep(m_lod, deltaTime));
+
+	m_moveSpeedMod = 0.f;
+}
+
 void Enemy::debugRendering(Graphics::Renderer & renderer)
 {
 	if (m_behavior)
@@ -107,6 +155,11 @@ int Enemy::getEnemyType() const
 	return m_enemyType;
 }
 
+LodScheduler::Agent & Enemy::getLodAgent()
+{
+	return m_lod;
+}
+
 // projectiles
 void Enemy::spawnProjectile(btVector3 dir, Graphics::ModelID id, float speed)
 {
@@ -1,12 +1,11 @@
 #include <AI\EnemyNecromancer.h>
-#include <AI\Behavior\RangedBehavior.h>
 #include <Misc\RandomGenerator.h>
 
 using namespace Logic;
 
 EnemyNecromancer::EnemyNecromancer(Graphics::ModelID modelID,
 	btRigidBody* body, btVector3 halfExtent)
-	: Enemy(modelID, body, halfExtent, 5, 5, 10, 0, 0) {
+	: Enemy(modelID, body, halfExtent, 5, 5, 10, NECROMANCER, 0) {
 	setBehavior(RANGED);
 }
 
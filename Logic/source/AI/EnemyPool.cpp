@@ -0,0 +1,127 @@
+#include <AI\EnemyPool.h>
+#include <AI\EnemyTest.h>
+#include <AI\EnemyNecromancer.h>
+#include <stdio.h>
+using namespace Logic;
+
+#define ENEMY_MASS 100.f
+#define ENEMY_RADIUS 0.5f
+
+static const char* ENEMY_TYPE_NAMES[] = { "necromancer", "test" };
+
+EnemyPool::EnemyPool()
+{
+	m_physics = nullptr;
+	m_projectiles = nullptr;
+	m_misses = 0;
+}
+
+EnemyPool::~EnemyPool()
+{
+	clear();
+}
+
+void EnemyPool::init(Physics *physics, ProjectileManager *projectiles)
+{
+	m_physics = physics;
+	m_projectiles = projectiles;
+}
+
+void EnemyPool::clear()
+{
+	for (int type = 0; type < Enemy::NR_OF_ENEMY_TYPES; ++type)
+	{
+		// free bodies are not in the world so Physics won't delete them
+		for (Enemy *enemy : m_free[type])
+			enemy->destroyBody();
+		for (Enemy *enemy : m_created[type])
+			delete enemy;
+
+		m_free[type].clear();
+		m_created[type].clear();
+	}
+}
+
+Enemy* EnemyPool::create(Enemy::ENEMY_TYPE type)
+{
+	btRigidBody *body = m_physics->createBody(Sphere({ 0, 0, 0 }, { 0, 0, 0 }, ENEMY_RADIUS), ENEMY_MASS, false);
+	m_physics->removeRigidBody(body); // createBody adds it, pooled bodies stay out of the world
+
+	Enemy *enemy = nullptr;
+	switch (type)
+	{
+		case Enemy::NECROMANCER:
+			enemy = newd EnemyNecromancer(Graphics::ModelID::ENEMYGRUNT, body, { ENEMY_RADIUS, ENEMY_RADIUS, ENEMY_RADIUS });
+			break;
+		case Enemy::ENEMY_TEST:
+		default:
+			enemy = newd EnemyTest(Graphics::ModelID::GRASS, body, { ENEMY_RADIUS, ENEMY_RADIUS, ENEMY_RADIUS });
+			break;
+	}
+
+	enemy->setProjectileManager(m_projectiles);
+	m_created[type].push_back(enemy);
+
+	return enemy;
+}
+
+void EnemyPool::prewarm(Enemy::ENEMY_TYPE type, int count)
+{
+	m_created[type].reserve(count);
+	m_free[type].reserve(count);
+
+	while ((int)m_created[type].size() < count)
+		m_free[type].push_back(create(type));
+}
+
+Enemy* EnemyPool::spawn(Enemy::ENEMY_TYPE type, btVector3 const &position)
+{
+	Enemy *enemy;
+	if (m_free[type].empty())
+	{
+		// should not happen if the waves prewarmed correctly
+		printf("EnemyPool miss on %s, allocating during wave (EnemyPool.cpp:%d)\n", getTypeName(type), __LINE__);
+		m_misses++;
+		enemy = create(type);
+	}
+	else
+	{
+		enemy = m_free[type].back();
+		m_free[type].pop_back();
+	}
+
+	enemy->reset(position);
+	m_physics->addRigidBody(enemy->getRigidbody());
+
+	return enemy;
+}
+
+void EnemyPool::kill(Enemy *enemy)
+{
+	m_physics->removeRigidBody(enemy->getRigidbody());
+}
+
+void EnemyPool::release(Enemy *enemy)
+{
+	m_free[enemy->getEnemyType()].push_back(enemy);
+}
+
+EnemyPool::Stats EnemyPool::getStats(Enemy::ENEMY_TYPE type) const
+{
+	Stats stats;
+	stats.created = (int)m_created[type].size();
+	stats.free = (int)m_free[type].size();
+	stats.active = stats.created - stats.free;
+
+	return stats;
+}
+
+int EnemyPool::getMisses() const
+{
+	return m_misses;
+}
+
+const char* EnemyPool::getTypeName(Enemy::ENEMY_TYPE type)
+{
+	return ENEMY_TYPE_NAMES[type];
+}
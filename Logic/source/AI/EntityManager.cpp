@@ -3,7 +3,6 @@ using namespace Logic;
 
 #define ENEMY_START_COUNT 16
 #define ENEMIES_PATH_UPDATE_PER_FRAME 3
-#define TEST_NAME "helloWave"
 #define DEBUG_ASTAR false
 #define DEBUG_PATH false
 
@@ -11,6 +10,7 @@ using namespace Logic;
 #include <AI/EnemyNecromancer.h>
 
 #include <AI\Behavior\AStar.h>
+#include <AI\Behavior\BehaviorTreeManager.h>
 #include <Engine\Profiler.h>
 #include <ctime>
 #include <stdio.h>
@@ -19,21 +19,66 @@ EntityManager::EntityManager()
 {
 	m_currentWave = 0;
 	m_frame = 0;
+	m_physics = nullptr;
 
 	reserveData();
 
-	m_waveManager.setName(TEST_NAME);
+	m_waveManager.setName(WAVE_FILE_NAME);
+	if (m_waveManager.loadWaves() != 0)
+		printf("Could not load waves from %s (EntityManager.cpp:%d)\n", WAVE_FILE_NAME, __LINE__);
+
+	if (m_lodScheduler.loadBands() != 0)
+		printf("Could not load AI LOD bands, using defaults (EntityManager.cpp:%d)\n", __LINE__);
+	for (int i = 0; i < m_lodScheduler.getBandCount(); i++)
+		m_lodCounterNames.push_back("AI LOD " + m_lodScheduler.getBand(i).name);
+
+	for (int i = 0; i < Enemy::NR_OF_ENEMY_TYPES; i++)
+	{
+		std::string name = EnemyPool::getTypeName(static_cast<Enemy::ENEMY_TYPE> (i));
+		m_poolCounterNames.push_back("Pool " + name + " active");
+		m_poolCounterNames.push_back("Pool " + name + " free");
+	}
 }
 
 
 EntityManager::~EntityManager()
 {
-	for (Enemy *enemy : m_enemies)
-		delete enemy;
+	// m_enemies & m_deadEnemies are owned by the pool
 	for (Enemy *enemy : m_bossEnemies)
 		delete enemy;
-	for (Enemy *enemy : m_deadEnemies)
-		delete enemy;
+
+	releaseDeadEnemies();
+}
+
+void EntityManager::initialize(Physics &physics, ProjectileManager *projectiles)
+{
+	m_physics = &physics;
+	m_enemyPool.init(&physics, projectiles);
+	m_lineOfSight.init(&physics);
+	m_visibility.init(&m_lineOfSight);
+
+	// enough for every wave to be alive at the same time, dead ones are recycled on each new wave
+	int total = 0;
+	for (int type = 0; type < Enemy::NR_OF_ENEMY_TYPES; type++)
+	{
+		int needed = m_waveManager.getEnemyCount(type);
+		m_enemyPool.prewarm(static_cast<Enemy::ENEMY_TYPE> (type), needed);
+		total += needed;
+	}
+
+	int events = 0;
+	for (int wave = 1; wave <= m_waveManager.getWaveCount(); wave++)
+	{
+		WaveManager::Wave const *definition = m_waveManager.getWave(wave);
+		int waveEvents = (int)definition->triggers.size();
+		for (WaveManager::SpawnGroup const &group : definition->spawns)
+			waveEvents += group.count;
+		if (waveEvents > events) events = waveEvents;
+	}
+
+	m_spawnScheduler.reserve(events);
+	m_enemies.reserve(total);
+	m_deadEnemies.reserve(total);
 }
 
 void EntityManager::reserveData()
@@ -43,17 +88,83 @@ void EntityManager::reserveData()
 	m_deadEnemies.reserve(ENEMY_START_COUNT);
 }
 
+Enemy* EntityManager::spawnEnemy(Enemy::ENEMY_TYPE type, btVector3 const &position)
+{
+	Enemy *enemy = m_enemyPool.spawn(type, position);
+	m_lodScheduler.initAgent(enemy->getLodAgent());
+	m_enemies.push_back(enemy);
+
+	return enemy;
+}
+
+void EntityManager::updateSpawns(float deltaTime)
+{
+	SpawnScheduler::SpawnEvent event;
+
+	m_spawnScheduler.update(deltaTime);
+	while (m_spawnScheduler.popEvent(event))
+	{
+		if (event.kind == SpawnScheduler::SpawnEvent::TRIGGER)
+		{
+			WaveManager::TriggerDefinition const &trigger = event.wave->triggers[event.index];
+
+			std::vector<StatusManager::UPGRADE_ID> upgrades;
+			for (int upgrade : trigger.upgrades)
+				upgrades.push_back(static_cast<StatusManager::UPGRADE_ID> (upgrade));
+			std::vector<StatusManager::EFFECT_ID> effects;
+			for (int effect : trigger.effects)
+				effects.push_back(static_cast<StatusManager::EFFECT_ID> (effect));
+
+			Cube cube(trigger.position, { 0, 0, 0 }, trigger.halfExtent);
+			m_triggerManager.addTrigger(static_cast<Graphics::ModelID> (trigger.modelID), cube, trigger.cooldown,
+				*m_physics, upgrades, effects, trigger.reusable);
+		}
+		else if (event.index >= 0 && event.index < Enemy::NR_OF_ENEMY_TYPES)
+		{
+			spawnEnemy(static_cast<Enemy::ENEMY_TYPE> (event.index), event.position);
+		}
+		else
+		{
+			printf("Unknown enemy type %d in wave %d (EntityManager.cpp:%d)\n", event.index, m_currentWave, __LINE__);
+		}
+	}
+}
+
+void EntityManager::releaseDeadEnemies()
+{
+	for (Enemy *enemy : m_deadEnemies)
+		m_enemyPool.release(enemy);
+	m_deadEnemies.clear();
+}
+
 void EntityManager::update(Player const &player, float deltaTime) 
 {
 	clock_t begin = clock();
 	m_frame++;
 	PROFILE_BEGIN("EntityManager::update()");
 	
+	updateSpawns(deltaTime);
+
 	AStar::singleton().loadTargetIndex(player);
+	m_visibility.beginFrame(player.getPositionBT());
+	m_lodScheduler.beginFrame(player.getPositionBT(), player.getForwardBT());
 	for (int i = 0; i < m_enemies.size(); ++i)
 	{
-		m_enemies[i]->update(player, deltaTime, (i + m_frame) % ENEMIES_PATH_UPDATE_PER_FRAME == 0);
+		Enemy *enemy = m_enemies[i];
+		if (m_lodScheduler.schedule(enemy->getLodAgent(), enemy->getPositionBT()))
+		{
+			// enemies that don't think every frame get a new path every think instead
+			bool updatePath = m_lodScheduler.getBand(enemy->getLodAgent().band).interval > 1 ||
+				(i + m_frame) % ENEMIES_PATH_UPDATE_PER_FRAME == 0;
+			enemy->update(player, deltaTime, updatePath);
+		}
+		else
+		{
+			enemy->updateExtrapolated(player, deltaTime);
+		}
+
 		if (m_enemies[i]->getHealth() <= 0) {
+			m_enemyPool.kill(m_enemies[i]);
 			m_deadEnemies.push_back(m_enemies[i]);
 			std::swap(m_enemies[i], m_enemies[m_enemies.size() - 1]);
 			m_enemies.pop_back();
@@ -65,6 +176,10 @@ void EntityManager::update(Player const &player, float deltaTime)
 		m_bossEnemies[i]->update(player, deltaTime);
 	}
 
+	// enemies with a tree only queued themselves above
+	BehaviorTreeManager::singleton().tick(player.getPositionBT(), deltaTime, &m_visibility);
+	m_visibility.flush();
+
 	for (int i = 0; i < m_deadEnemies.size(); ++i)
 	{
 		m_deadEnemies[i]->updateDead(deltaTime);
@@ -76,50 +191,36 @@ void EntityManager::update(Player const &player, float deltaTime)
 	//printf("Entity Time Elapsed: %f seconds, (EntityManager.cpp:%d)\n", elapsed_secs, __LINE__);
 
 	m_triggerManager.update(deltaTime);
+
+	for (int i = 0; i < m_lodScheduler.getBandCount(); i++)
+		PROFILE_COUNTER(m_lodCounterNames[i].c_str(), m_lodScheduler.getAgentsInBand(i));
+	PROFILE_COUNTER("AI LOD thinks", m_lodScheduler.getThinksThisFrame());
+	PROFILE_COUNTER("Behavior tree ticks", BehaviorTreeManager::singleton().getTicksThisFrame());
+	PROFILE_COUNTER("LOS cache hits", m_visibility.getStats().hits);
+	PROFILE_COUNTER("LOS cache misses", m_visibility.getStats().misses);
+	PROFILE_COUNTER("LOS rays", m_visibility.getStats().rays);
+
+	for (int i = 0; i < Enemy::NR_OF_ENEMY_TYPES; i++)
+	{
+		EnemyPool::Stats stats = m_enemyPool.getStats(static_cast<Enemy::ENEMY_TYPE> (i));
+		PROFILE_COUNTER(m_poolCounterNames[i * 2].c_str(), stats.active);
+		PROFILE_COUNTER(m_poolCounterNames[i * 2 + 1].c_str(), stats.free);
+	}
+	PROFILE_COUNTER("Pool misses", m_enemyPool.getMisses());
 	PROFILE_END();
 }
 
 void EntityManager::spawnWave(Physics &physics, ProjectileManager *projectiles) 
 {
-	std::vector<int> enemies = m_waveManager.getEnemies(m_currentWave);
-	m_enemies.reserve(enemies.size() + m_enemies.size());
 	m_frame = 0;
 
-	if (m_currentWave == 1)
-	{
-		Enemy *enemy;/* NO ENEMIES BECAUSE PEOPLE ARE HATERS AND COMPLAIN IF ENEMIES IS KILLING THEM; LIKE DUUH THAT IS THEIR POINT <.<<.<.<.<<
-		for (int i = 0; i < enemies.size(); i++)
-		{
-			i += 1;
-			//m_enemies.push_back(new EnemyTest(physics.createBody(Cube({ i * 8.f, i * 10.f, i * 1.f }, { 0, 0, 0 }, { 0.5f, 0.5f, 0.5f}), 100, false), { 0.5f, 0.5f, 0.5f}));
-			enemy = new EnemyNecromancer(Graphics::ModelID::ENEMYGRUNT, physics.createBody(Sphere({ 0, 0, 0 }, { 0, 0, 0 }, 0.5f), 100, false), { 0.5f, 0.5f, 0.5f });
-			enemy->setProjectileManager(projectiles);
-			m_enemies.push_back(enemy);
-		}
-		enemy = new EnemyTest(Graphics::ModelID::GRASS, physics.createBody(Sphere({ 0, 0, 0 }, { 0, 0, 0 }, 0.5f), 100, false), { 0.5f, 0.5f, 0.5f });
-		enemy->setProjectileManager(projectiles);
-		m_enemies.push_back(enemy);
-		*/
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 10, 0.1f, 10 }, { 0, 0, 0 }, { 2, 0.1f, 2 }), 500.f, physics, { StatusManager::UPGRADE_ID::BOUNCE }, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ -10, 0.1f, 10 }, { 0, 0, 0 }, { 2, 0.1f, 2 }), 500.f, physics, { StatusManager::UPGRADE_ID::BOUNCE }, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ -10, 0.1f, -10 }, { 0, 0, 0 }, { 2, 0.1f, 2 }), 500.f, physics, { StatusManager::UPGRADE_ID::BOUNCE }, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 10, 0.1f, -10 }, { 0, 0, 0 }, { 2, 0.1f, 2 }), 500.f, physics, { StatusManager::UPGRADE_ID::BOUNCE }, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 15, 10.f, 5 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 20, 15.f, 10 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 25, 18.f, -5 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 30, 25.f, -0 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 45, 30.f, 12 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 50, 40.f, -5 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 40, 30.f, 2 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 70, 54.f, 10 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 80, 80.f, -2 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP, StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 50, 65.f, 5 }, { 0, 0, 0 }, { 2, 1.f, 2 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP }, true);
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 130, 128.f, 5 }, { 0, 0, 0 }, { 10, 1.f, 10 }), 500.f, physics, {}, { StatusManager::EFFECT_ID::BOOST_UP, StatusManager::EFFECT_ID::BOOST_UP, StatusManager::EFFECT_ID::BOOST_UP, StatusManager::EFFECT_ID::BOOST_UP });
-
-		// Ammo refiller
-		m_triggerManager.addTrigger(Graphics::ModelID::JUMPPAD, Cube({ 0, 10, 40 }, { 0, 0, 0 }, { 10, 10, 10 }), 1000.f, physics, { }, { StatusManager::EFFECT_ID::AMMO_PICK_UP });
-	}
+	// corpses of the last wave go back to the pool before anything is spawned
+	releaseDeadEnemies();
+
+	// enemies & triggers of the wave are spawned over the next frames in update()
+	WaveManager::Wave const *wave = m_waveManager.getWave(m_currentWave);
+	if (wave)
+		m_spawnScheduler.start(*wave);
 }
 
 int EntityManager::getEnemiesAlive() const 
@@ -129,7 +230,15 @@ int EntityManager::getEnemiesAlive() const
 
 void EntityManager::clear() 
 {
-	m_deadEnemies.clear();
+	for (Enemy *enemy : m_enemies)
+	{
+		m_enemyPool.kill(enemy);
+		m_enemyPool.release(enemy);
+	}
+	releaseDeadEnemies();
+	m_spawnScheduler.clear();
+	m_visibility.clear();
+
 	m_enemies.clear();
 	m_bossEnemies.clear();
 
@@ -166,6 +275,21 @@ void EntityManager::render(Graphics::Renderer &renderer)
 		AStar::singleton().renderNavigationMesh(renderer);
 }
 
+LodScheduler & EntityManager::getLodScheduler()
+{
+	return m_lodScheduler;
+}
+
+WaveManager const & EntityManager::getWaveManager() const
+{
+	return m_waveManager;
+}
+
+EnemyPool const & EntityManager::getEnemyPool() const
+{
+	return m_enemyPool;
+}
+
 int EntityManager::getCurrentWave() const 
 {
 	return m_currentWave;
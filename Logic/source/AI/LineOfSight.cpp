@@ -0,0 +1,118 @@
+#include <AI/LineOfSight.h>
+#include <Misc/FileLoader.h>
+#include <LinearMath/btQuaternion.h>
+#include <math.h>
+using namespace Logic;
+
+int BoxLineOfSight::load(std::string const &fileName)
+{
+	std::vector<FileLoader::LoadedStruct> boxes;
+	int result = FileLoader::singleton().loadStructsFromFile(boxes, fileName);
+	if (result != 0)
+		return result;
+
+	for (auto const &box : boxes)
+	{
+		addBox({ box.floats.at("x"), box.floats.at("y"), box.floats.at("z") },
+			{ box.floats.at("rotX"), box.floats.at("rotY"), box.floats.at("rotZ") },
+			{ box.floats.at("width"), box.floats.at("height"), box.floats.at("depth") });
+	}
+
+	return 0;
+}
+
+void BoxLineOfSight::addBox(btVector3 const &position, btVector3 const &rotation, btVector3 const &halfExtent)
+{
+	// the same rotation Physics::createBody gives a Cube
+	btQuaternion quaternion;
+	quaternion.setEulerZYX(rotation.getZ(), rotation.getY(), rotation.getX());
+	btMatrix3x3 toWorld(quaternion);
+
+	Box box;
+	box.position = position;
+	box.halfExtent = halfExtent;
+	box.toLocal = toWorld.transpose();
+
+	btMatrix3x3 absolute = toWorld.absolute();
+	btVector3 extent(absolute[0].dot(halfExtent), absolute[1].dot(halfExtent), absolute[2].dot(halfExtent));
+	box.min = position - extent;
+	box.max = position + extent;
+
+	m_boxes.push_back(box);
+}
+
+void BoxLineOfSight::clear()
+{
+	m_boxes.clear();
+}
+
+int BoxLineOfSight::getBoxCount() const
+{
+	return (int)m_boxes.size();
+}
+
+void BoxLineOfSight::castRays(Ray *rays, int count, btVector3 const &to)
+{
+	for (int i = 0; i < count; i++)
+	{
+		btVector3 const &from = rays[i].from;
+		btVector3 rayMin = from, rayMax = from;
+		rayMin.setMin(to);
+		rayMax.setMax(to);
+
+		rays[i].visible = true;
+		for (Box const &box : m_boxes)
+		{
+			if (rayMin.x() > box.max.x() || rayMax.x() < box.min.x() ||
+				rayMin.y() > box.max.y() || rayMax.y() < box.min.y() ||
+				rayMin.z() > box.max.z() || rayMax.z() < box.min.z())
+				continue;
+
+			if (intersects(box, from, to))
+			{
+				rays[i].visible = false;
+				break;
+			}
+		}
+	}
+}
+
+// Slabs in the space of the box. Like Bullet's ray test, a ray that starts
+// inside a box isn't blocked by it
+bool BoxLineOfSight::intersects(Box const &box, btVector3 const &from, btVector3 const &to)
+{
+	btVector3 start = box.toLocal * (from - box.position);
+	btVector3 direction = box.toLocal * (to - from);
+	float enter = 0.f, exit = 1.f;
+	bool inside = true;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = box.halfExtent[axis];
+		if (fabsf(start[axis]) > extent)
+			inside = false;
+
+		if (fabsf(direction[axis]) < 1e-6f)
+		{
+			if (fabsf(start[axis]) > extent)
+				return false;
+			continue;
+		}
+
+		float first = (-extent - start[axis]) / direction[axis];
+		float second = (extent - start[axis]) / direction[axis];
+		if (first > second)
+		{
+			float swap = first;
+			first = second;
+			second = swap;
+		}
+
+		if (first > enter) enter = first;
+		if (second < exit) exit = second;
+		if (enter > exit)
+			return false;
+	}
+
+	return !inside;
+}
@@ -0,0 +1,156 @@
+#include <AI/LodScheduler.h>
+#include <Misc/FileLoader.h>
+#include <float.h>
+using namespace Logic;
+
+#define LOD_PHASE_RANGE 0xFFFF
+
+LodScheduler::LodScheduler(unsigned int seed)
+{
+	m_frame = 0;
+	m_thinks = 0;
+	m_viewPosition = { 0, 0, 0 };
+	m_viewForward = { 0, 0, 1 };
+
+	setSeed(seed);
+	setDefaultBands();
+}
+
+LodScheduler::~LodScheduler()
+{
+}
+
+void LodScheduler::setDefaultBands()
+{
+	// same as AILod.lw, used if the file is missing
+	setBands({
+		{ "near",	30.f,		1,	2 },
+		{ "medium",	80.f,		4,	8 },
+		{ "far",	FLT_MAX,	16, 32 }
+	});
+}
+
+int LodScheduler::loadBands(std::string const &fileName)
+{
+	std::vector<FileLoader::LoadedStruct> loaded;
+	int result = FileLoader::singleton().loadStructsFromFile(loaded, fileName);
+	if (result != 0 || loaded.empty())
+		return result;
+
+	std::vector<Band> bands;
+	for (auto const &fileStruct : loaded)
+	{
+		Band band;
+		band.name			= fileStruct.strings.at("name");
+		band.maxDistance	= fileStruct.floats.at("maxDistance");
+		band.interval		= fileStruct.ints.at("interval");
+		band.hiddenInterval = fileStruct.ints.at("hiddenInterval");
+		bands.push_back(band);
+	}
+
+	// last band always catches everything
+	bands.back().maxDistance = FLT_MAX;
+	setBands(bands);
+
+	return 0;
+}
+
+void LodScheduler::setBands(std::vector<Band> const &bands)
+{
+	m_bands = bands;
+	for (Band &band : m_bands) // never divide by zero in schedule()
+	{
+		if (band.interval < 1) band.interval = 1;
+		if (band.hiddenInterval < band.interval) band.hiddenInterval = band.interval;
+	}
+
+	m_agentsInBand.assign(m_bands.size(), 0);
+}
+
+void LodScheduler::setSeed(unsigned int seed)
+{
+	m_seed = seed;
+	m_state = seed;
+}
+
+// Simple LCG, owned by the scheduler so it doesn't interfere with rand()
+unsigned int LodScheduler::nextRandom()
+{
+	m_state = m_state * 1664525u + 1013904223u;
+	return m_state >> 8;
+}
+
+void LodScheduler::initAgent(Agent &agent)
+{
+	agent.phase = nextRandom() % LOD_PHASE_RANGE;
+	agent.band = 0;
+	agent.velocity = { 0, 0, 0 };
+}
+
+void LodScheduler::beginFrame(btVector3 const &viewPosition, btVector3 const &viewForward)
+{
+	m_frame++;
+	m_thinks = 0;
+	m_viewPosition = viewPosition;
+	m_viewForward = viewForward;
+	if (m_viewForward.length2() > FLT_EPSILON)
+		m_viewForward.normalize();
+
+	for (int &count : m_agentsInBand)
+		count = 0;
+}
+
+bool LodScheduler::schedule(Agent &agent, btVector3 const &position)
+{
+	btVector3 toAgent = position - m_viewPosition;
+	float distance = toAgent.length();
+
+	int band = 0;
+	while (band < (int)m_bands.size() - 1 && distance > m_bands[band].maxDistance)
+		band++;
+
+	// length is checked so an enemy standing inside the player is never "hidden"
+	bool visible = distance < FLT_EPSILON ||
+		toAgent.dot(m_viewForward) >= LOD_VIEW_CONE_COS * distance;
+
+	Band const &current = m_bands[band];
+	int interval = visible ? current.interval : current.hiddenInterval;
+
+	agent.band = band;
+	m_agentsInBand[band]++;
+
+	bool think = (m_frame + agent.phase) % interval == 0;
+	if (think) m_thinks++;
+
+	return think;
+}
+
+btVector3 LodScheduler::getExtrapolatedStep(Agent const &agent, float deltaTime)
+{
+	return agent.velocity * deltaTime;
+}
+
+int LodScheduler::getBandCount() const
+{
+	return (int)m_bands.size();
+}
+
+int LodScheduler::getAgentsInBand(int band) const
+{
+	return m_agentsInBand[band];
+}
+
+int LodScheduler::getThinksThisFrame() const
+{
+	return m_thinks;
+}
+
+LodScheduler::Band const & LodScheduler::getBand(int band) const
+{
+	return m_bands[band];
+}
+
+int LodScheduler::getFrame() const
+{
+	return m_frame;
+}
@@ -0,0 +1,161 @@
+#include <AI/SpawnScheduler.h>
+#include <math.h>
+using namespace Logic;
+
+#define SPAWN_GOLDEN_ANGLE 2.39996323f
+
+SpawnScheduler::SpawnScheduler(int maxPerFrame)
+{
+	m_maxPerFrame = maxPerFrame;
+	m_poppedThisFrame = 0;
+	m_next = 0;
+	m_time = 0.f;
+}
+
+SpawnScheduler::~SpawnScheduler()
+{
+}
+
+void SpawnScheduler::reserve(int events)
+{
+	// a wave can start with all of the last one still left
+	m_timeline.reserve(events * 2);
+	m_carried.reserve(events * 2);
+}
+
+// t is [0, 1] of the spawns, returns [0, 1] of the spawn time
+float SpawnScheduler::applyCurve(WaveManager::SPAWN_CURVE curve, float t)
+{
+	switch (curve)
+	{
+		case WaveManager::CURVE_EASE_IN:	return sqrtf(t);
+		case WaveManager::CURVE_EASE_OUT:	return 1.f - sqrtf(1.f - t);
+		case WaveManager::CURVE_BURST:		return 0.f;
+		case WaveManager::CURVE_LINEAR:
+		default:							return t;
+	}
+}
+
+void SpawnScheduler::start(WaveManager::Wave const &wave)
+{
+	// spawns of the last wave that are still to come happen when they would have
+	m_carried.assign(m_timeline.begin() + m_next, m_timeline.end());
+	for (SpawnEvent &event : m_carried)
+		event.time = event.time > m_time ? event.time - m_time : 0.f;
+
+	m_timeline.clear();
+	m_next = 0;
+	m_time = 0.f;
+
+	SpawnEvent event;
+	event.wave = &wave;
+
+	// triggers first, they are the level layout for this wave
+	event.kind = SpawnEvent::TRIGGER;
+	event.time = 0.f;
+	for (size_t i = 0; i < wave.triggers.size(); i++)
+	{
+		event.index = (int)i;
+		event.position = wave.triggers[i].position;
+		m_timeline.push_back(event);
+	}
+
+	int total = 0, maxCount = 0;
+	for (WaveManager::SpawnGroup const &group : wave.spawns)
+	{
+		total += group.count;
+		if (group.count > maxCount) maxCount = group.count;
+	}
+
+	// round robin over the groups, so the order is mixed and the times can just follow the index
+	event.kind = SpawnEvent::ENEMY;
+	int spawned = 0;
+	for (int i = 0; i < maxCount; i++)
+	{
+		for (WaveManager::SpawnGroup const &group : wave.spawns)
+		{
+			if (i >= group.count) continue;
+
+			float t = total > 1 ? spawned / float(total - 1) : 0.f;
+			float radius = group.count > 1 ? group.spread * sqrtf(i / float(group.count - 1)) : 0.f;
+			float angle = i * SPAWN_GOLDEN_ANGLE;
+
+			event.time = applyCurve(wave.curve, t) * wave.spawnTime;
+			event.index = group.enemyType;
+			event.position = group.position + btVector3(cosf(angle) * radius, 0.f, sinf(angle) * radius);
+			m_timeline.push_back(event);
+
+			spawned++;
+		}
+	}
+
+	merge();
+}
+
+// both are in time order, merged from the back into the timeline so nothing
+// allocates. On the same time the last wave's spawn goes first
+void SpawnScheduler::merge()
+{
+	if (m_carried.empty())
+		return;
+
+	size_t count = m_timeline.size();
+	m_timeline.resize(count + m_carried.size());
+
+	size_t carried = m_carried.size(), out = m_timeline.size();
+	while (carried > 0)
+	{
+		if (count > 0 && m_timeline[count - 1].time >= m_carried[carried - 1].time)
+			m_timeline[--out] = m_timeline[--count];
+		else
+			m_timeline[--out] = m_carried[--carried];
+	}
+
+	m_carried.clear();
+}
+
+void SpawnScheduler::clear()
+{
+	m_timeline.clear();
+	m_next = 0;
+	m_time = 0.f;
+}
+
+void SpawnScheduler::update(float deltaTime)
+{
+	m_time += deltaTime;
+	m_poppedThisFrame = 0;
+}
+
+bool SpawnScheduler::popEvent(SpawnEvent &event)
+{
+	if (m_next >= m_timeline.size() ||
+		m_poppedThisFrame >= m_maxPerFrame ||
+		m_timeline[m_next].time > m_time)
+		return false;
+
+	event = m_timeline[m_next++];
+	m_poppedThisFrame++;
+
+	return true;
+}
+
+bool SpawnScheduler::isDone() const
+{
+	return m_next >= m_timeline.size();
+}
+
+int SpawnScheduler::getPending() const
+{
+	return (int)(m_timeline.size() - m_next);
+}
+
+float SpawnScheduler::getTime() const
+{
+	return m_time;
+}
+
+std::vector<SpawnScheduler::SpawnEvent> const & SpawnScheduler::getTimeline() const
+{
+	return m_timeline;
+}
@@ -0,0 +1,127 @@
+#include <AI/VisibilityService.h>
+#include <math.h>
+using namespace Logic;
+
+#define LOS_KEY_BITS 21
+#define LOS_KEY_MASK ((1ull << LOS_KEY_BITS) - 1)
+
+VisibilityService::VisibilityService(float cellSize, int cacheTicks, float invalidateDistance)
+{
+	m_lineOfSight = nullptr;
+	m_cellSize = cellSize;
+	m_cacheTicks = cacheTicks;
+	m_invalidateDistance = invalidateDistance;
+
+	m_tick = 0;
+	m_target = { 0, 0, 0 };
+	m_castTarget = { 0, 0, 0 };
+	m_stats = { 0, 0, 0 };
+}
+
+VisibilityService::~VisibilityService()
+{
+}
+
+void VisibilityService::init(LineOfSight *lineOfSight)
+{
+	m_lineOfSight = lineOfSight;
+	clear();
+}
+
+void VisibilityService::clear()
+{
+	m_cells.clear();
+	m_queued.clear();
+}
+
+// 21 bits per axis, cells wrap after ~2 million cells which is far outside any map
+unsigned long long VisibilityService::getKey(btVector3 const &position) const
+{
+	unsigned long long x = (unsigned long long)(long long)floorf(position.x() / m_cellSize) & LOS_KEY_MASK;
+	unsigned long long y = (unsigned long long)(long long)floorf(position.y() / m_cellSize) & LOS_KEY_MASK;
+	unsigned long long z = (unsigned long long)(long long)floorf(position.z() / m_cellSize) & LOS_KEY_MASK;
+
+	return x | (y << LOS_KEY_BITS) | (z << (LOS_KEY_BITS * 2));
+}
+
+void VisibilityService::beginFrame(btVector3 const &target)
+{
+	m_tick++;
+	m_target = target;
+	m_stats.hits = 0;
+	m_stats.misses = 0;
+
+	// everything was cast towards the old position, none of it can be trusted anymore
+	if ((target - m_castTarget).length2() > m_invalidateDistance * m_invalidateDistance)
+	{
+		m_cells.clear();
+		m_queued.clear();
+		m_castTarget = target;
+	}
+}
+
+bool VisibilityService::isVisible(btVector3 const &from)
+{
+	unsigned long long key = getKey(from);
+	auto it = m_cells.find(key);
+
+	if (it != m_cells.end())
+	{
+		Cell &cell = it->second;
+		if (cell.tick < 0 || m_tick - cell.tick <= m_cacheTicks)
+		{
+			m_stats.hits++;
+			return cell.visible;
+		}
+
+		// too old, cast it again but keep answering with the old result until then
+		m_stats.misses++;
+		cell.tick = -1;
+		m_queued.push_back(key);
+		return cell.visible;
+	}
+
+	m_stats.misses++;
+	m_cells[key] = { -1, false, from };
+	m_queued.push_back(key);
+
+	return false;
+}
+
+int VisibilityService::flush()
+{
+	m_stats.rays = 0;
+	if (!m_lineOfSight)
+	{
+		m_queued.clear();
+		return 0;
+	}
+
+	m_rays.resize(m_queued.size());
+	for (size_t i = 0; i < m_queued.size(); i++)
+		m_rays[i].from = m_cells[m_queued[i]].from;
+
+	// all of them at once, they share the target
+	m_lineOfSight->castRays(m_rays.data(), (int)m_rays.size(), m_target);
+
+	for (size_t i = 0; i < m_queued.size(); i++)
+	{
+		Cell &cell = m_cells[m_queued[i]];
+		cell.visible = m_rays[i].visible;
+		cell.tick = m_tick;
+	}
+	m_stats.rays = (int)m_queued.size();
+	m_queued.clear();
+
+	return m_stats.rays;
+}
+
+VisibilityService::Stats const & VisibilityService::getStats() const
+{
+	return m_stats;
+}
+
+int VisibilityService::getCachedCells() const
+{
+	return (int)m_cells.size();
+}
@@ -1,6 +1,10 @@
 #include <AI/WaveManager.h>
+#include <Misc/FileLoader.h>
 using namespace Logic;
 
+#define SPAWN_FILE_SUFFIX "Spawns"
+#define TRIGGER_FILE_SUFFIX "Triggers"
+
 WaveManager::WaveManager(std::string waveFileName)
 {
 	m_waveFileName = waveFileName;
@@ -10,13 +14,118 @@ WaveManager::~WaveManager()
 {
 }
 
+WaveManager::SPAWN_CURVE WaveManager::getCurve(std::string const &name)
+{
+	if (name == "easeIn")	return CURVE_EASE_IN;
+	if (name == "easeOut")	return CURVE_EASE_OUT;
+	if (name == "burst")	return CURVE_BURST;
+	return CURVE_LINEAR;
+}
+
+int WaveManager::loadWaves()
+{
+	std::vector<FileLoader::LoadedStruct> loadedWaves, loadedSpawns, loadedTriggers;
+	int result;
+
+	m_waves.clear();
+
+	if ((result = FileLoader::singleton().loadStructsFromFile(loadedWaves, m_waveFileName)) != 0)
+		return result;
+
+	for (auto const &fileStruct : loadedWaves)
+	{
+		Wave wave;
+		wave.time		= fileStruct.floats.at("time");
+		wave.spawnTime	= fileStruct.floats.at("spawnTime");
+		wave.curve		= getCurve(fileStruct.strings.at("curve"));
+		m_waves.push_back(wave);
+	}
+
+	if ((result = FileLoader::singleton().loadStructsFromFile(loadedSpawns, m_waveFileName + SPAWN_FILE_SUFFIX)) != 0)
+		return result;
+
+	for (auto const &fileStruct : loadedSpawns)
+	{
+		int waveId = fileStruct.ints.at("wave");
+		if (waveId < 1 || waveId > (int)m_waves.size())
+			continue;
+
+		SpawnGroup group;
+		group.enemyType = fileStruct.ints.at("enemyType");
+		group.count		= fileStruct.ints.at("count");
+		group.position	= btVector3(fileStruct.floats.at("x"), fileStruct.floats.at("y"), fileStruct.floats.at("z"));
+		group.spread	= fileStruct.floats.at("spread");
+		m_waves[waveId - 1].spawns.push_back(group);
+	}
+
+	if ((result = FileLoader::singleton().loadStructsFromFile(loadedTriggers, m_waveFileName + TRIGGER_FILE_SUFFIX)) != 0)
+		return result;
+
+	for (auto const &fileStruct : loadedTriggers)
+	{
+		int waveId = fileStruct.ints.at("wave");
+		if (waveId < 1 || waveId > (int)m_waves.size())
+			continue;
+
+		TriggerDefinition trigger;
+		trigger.modelID		= fileStruct.ints.at("model");
+		trigger.position	= btVector3(fileStruct.floats.at("x"), fileStruct.floats.at("y"), fileStruct.floats.at("z"));
+		trigger.halfExtent	= btVector3(fileStruct.floats.at("width"), fileStruct.floats.at("height"), fileStruct.floats.at("depth"));
+		trigger.cooldown	= fileStruct.floats.at("cooldown");
+		trigger.reusable	= fileStruct.ints.at("reusable") != 0;
+
+		// same list layout as Cards.lw, "effectAmount" followed by effect1, effect2...
+		for (int i = 1; i <= fileStruct.ints.at("upgradeAmount"); i++)
+			trigger.upgrades.push_back(fileStruct.ints.at("upgrade" + std::to_string(i)));
+		for (int i = 1; i <= fileStruct.ints.at("effectAmount"); i++)
+			trigger.effects.push_back(fileStruct.ints.at("effect" + std::to_string(i)));
+
+		m_waves[waveId - 1].triggers.push_back(trigger);
+	}
+
+	return 0;
+}
+
 std::vector<int> Logic::WaveManager::getEnemies(int waveId)
 {
 	std::vector<int> enemies;
-	enemies.resize(1);
+
+	Wave const *wave = getWave(waveId);
+	if (wave)
+		for (SpawnGroup const &group : wave->spawns)
+			enemies.insert(enemies.end(), group.count, group.enemyType);
+
 	return enemies;
 }
 
+WaveManager::Wave const * WaveManager::getWave(int waveId) const
+{
+	if (waveId < 1 || waveId > (int)m_waves.size())
+		return nullptr;
+	return &m_waves[waveId - 1];
+}
+
+int WaveManager::getWaveCount() const
+{
+	return (int)m_waves.size();
+}
+
+float WaveManager::getWaveTime(int index) const
+{
+	return m_waves[index].time;
+}
+
+int WaveManager::getEnemyCount(int enemyType) const
+{
+	int count = 0;
+	for (Wave const &wave : m_waves)
+		for (SpawnGroup const &group : wave.spawns)
+			if (group.enemyType == enemyType)
+				count += group.count;
+
+	return count;
+}
+
 void Logic::WaveManager::setName(std::string name)
 {
 	m_waveFileName = name;
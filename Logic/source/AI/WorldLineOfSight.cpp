@@ -0,0 +1,43 @@
+#include <AI/LineOfSight.h>
+#include <btBulletCollisionCommon.h>
+using namespace Logic;
+
+// Only lets static bodies (the map) block the ray
+class StaticRayResultCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+public:
+	StaticRayResultCallback(btVector3 const &from, btVector3 const &to)
+		: btCollisionWorld::ClosestRayResultCallback(from, to) {}
+
+	virtual bool needsCollision(btBroadphaseProxy *proxy) const
+	{
+		btCollisionObject const *object = static_cast<btCollisionObject const*> (proxy->m_clientObject);
+		return object->isStaticObject() && ClosestRayResultCallback::needsCollision(proxy);
+	}
+};
+
+WorldLineOfSight::WorldLineOfSight()
+{
+	m_world = nullptr;
+}
+
+void WorldLineOfSight::init(btCollisionWorld *world)
+{
+	m_world = world;
+}
+
+void WorldLineOfSight::castRays(Ray *rays, int count, btVector3 const &to)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (!m_world)
+		{
+			rays[i].visible = false;
+			continue;
+		}
+
+		StaticRayResultCallback callback(rays[i].from, to);
+		m_world->rayTest(rays[i].from, to, callback);
+		rays[i].visible = !callback.hasHit();
+	}
+}
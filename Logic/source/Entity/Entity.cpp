@@ -109,8 +109,8 @@ DirectX::SimpleMath::Vector3 Entity::getScale() const
 
 DirectX::SimpleMath::Matrix Entity::getTransformMatrix() const
 {
-	// Making memory for a matrix
-	float* m = new float[4 * 16];
+	// Making memory for a matrix, on the stack since this is called every frame for every entity
+	float m[16];
 
 	// Getting this entity's matrix
 	m_transform->getOpenGLMatrix((btScalar*)(m));
@@ -121,8 +121,5 @@ DirectX::SimpleMath::Matrix Entity::getTransformMatrix() const
 	//Find the scaling matrix
 	auto scale = DirectX::SimpleMath::Matrix::CreateScale(m_halfextent.getX() * 2, m_halfextent.getY() * 2, m_halfextent.getZ() * 2);
 
-	// Deleting the old created variables from memory
-	delete m;
-
 	return scale * transformMatrix;
 }
@@ -8,6 +8,10 @@ Object::Object()
 	m_renderInfo.render = true;
 	m_renderInfo.meshId = Graphics::ModelID::CUBE;
 	m_renderInfo.materialId = 0;
+
+	m_static = false;
+	m_staticDirty = false;
+	m_staticHandle = -1;
 }
 
 // This constructor should be used on release (add materialID here aswell, when implemented)
@@ -16,6 +20,10 @@ Object::Object(Graphics::ModelID modelID)
 	m_renderInfo.render = true;
 	m_renderInfo.meshId = modelID;
 	m_renderInfo.materialId = 0;
+
+	m_static = false;
+	m_staticDirty = false;
+	m_staticHandle = -1;
 }
 
 Object::~Object() 
@@ -27,27 +35,51 @@ Object::~Object()
 
 void Object::render(Graphics::Renderer& renderer)
 {
-	if (m_renderInfo.render)
+	if (m_static)
+	{
+		// the renderer keeps the render flag too, so this is done even when not rendering
+		if (m_staticHandle < 0)
+			m_staticHandle = renderer.registerStatic(&m_renderInfo);
+		else if (m_staticDirty)
+			renderer.updateStatic(m_staticHandle, &m_renderInfo);
+		m_staticDirty = false;
+	}
+	else if (m_renderInfo.render)
 		renderer.queueRender(&m_renderInfo);
 }
 
+void Object::setStatic(bool isStatic)
+{
+	m_static = isStatic;
+}
+
+void Object::setOccluder(bool occluder)
+{
+	m_staticDirty |= m_renderInfo.occluder != occluder;
+	m_renderInfo.occluder = occluder;
+}
+
 void Object::setShouldRender(bool render)
 {
+	m_staticDirty |= m_renderInfo.render != render;
 	m_renderInfo.render = render;
 }
 
 void Object::setMaterialID(int id)
 {
+	m_staticDirty |= m_renderInfo.materialId != id;
 	m_renderInfo.materialId = id;
 }
 
 void Object::setModelID(Graphics::ModelID modelID)
 {
+	m_staticDirty |= m_renderInfo.meshId != modelID;
 	m_renderInfo.meshId = modelID;
 }
 
 void Object::setWorldTranslation(DirectX::SimpleMath::Matrix translation)
 {
+	m_staticDirty |= m_renderInfo.translation != translation;
 	m_renderInfo.translation = translation;
 }
 
@@ -69,4 +101,9 @@ DirectX::SimpleMath::Matrix Object::getWorldTranslation() const
 bool Object::getShouldRender() const
 {
 	return m_renderInfo.render;
+}
+
+bool Object::isStatic() const
+{
+	return m_static;
 }
\ No newline at end of file
@@ -8,51 +8,19 @@ using namespace Logic;
 
 Effect StatusManager::s_effects[StatusManager::NR_OF_EFFECTS];
 Upgrade StatusManager::s_upgrades[StatusManager::NR_OF_UPGRADES];
+bool StatusManager::s_loaded = false;
  
 StatusManager::StatusManager() 
 { 
+	// the ifndefs below are compile time only, this stops every entity from reading the file again
+	if (s_loaded) return;
+	s_loaded = true;
+
 	#ifndef BUFFS_CREATED
 	#define BUFFS_CREATED
-		std::vector<FileLoader::LoadedStruct> loadedEffects;
-		FileLoader::singleton().loadStructsFromFile(loadedEffects, FILE_NAME);
-		Effect::Standards standards;
-		Effect::Modifiers modifiers;
-		Effect::Specifics spec;
-		int id = 0;
-
-		for (auto const &fileStruct : loadedEffects)
-		{
-			Effect creating;
-
-			standards.flags = fileStruct.ints.at("flags");
-			standards.duration = fileStruct.floats.at("duration");
-
-			if (fileStruct.ints.at("modifiers"))
-			{
-				memset(&modifiers, 0, sizeof(modifiers));
-
-				modifiers.modifyDmgGiven =		fileStruct.floats.at("mDmgGiven");
-				modifiers.modifyDmgTaken =		fileStruct.floats.at("mDmgTaken");
-				modifiers.modifyFirerate =		fileStruct.floats.at("mFirerate");
-				modifiers.modifyHP =			fileStruct.floats.at("mHP");
-				modifiers.modifyMovementSpeed = fileStruct.floats.at("mMovementSpeed");
-
-				creating.setModifiers(modifiers);
-			}
-
-			if (fileStruct.ints.at("specifics"))
-			{
-				memset(&spec, 0, sizeof(spec));
-			
-				spec.isBulletTime = fileStruct.floats.at("sBulletTime");
-				spec.isFreezing =	fileStruct.floats.at("sFreezing");
-
-				creating.setSpecifics(spec);
-			}
-
-			creating.setStandards(standards);
-			s_effects[id++] = creating;
-		}
+		loadEffects();
+		// loaded again when Effects.lw is saved, in place so the Effect pointers out there stay good
+		FileLoader::singleton().watchFile(FILE_NAME, loadEffects);
 	#endif // !buffsCreated
 
 	#ifndef UPGRADES_CREATED
@@ -75,6 +43,56 @@ StatusManager::StatusManager()
 	#endif // !UPGRADES_CREATED
 }
 
+void StatusManager::loadEffects()
+{
+	std::vector<FileLoader::LoadedStruct> loadedEffects;
+	FileLoader::singleton().loadStructsFromFile(loadedEffects, FILE_NAME);
+	Effect::Standards standards;
+	Effect::Modifiers modifiers;
+	Effect::Specifics spec;
+	Effect loaded[NR_OF_EFFECTS];
+	int id = 0;
+
+	for (auto const &fileStruct : loadedEffects)
+	{
+		if (id == NR_OF_EFFECTS) break;
+		Effect creating;
+
+		standards.flags = fileStruct.ints.at("flags");
+		standards.duration = fileStruct.floats.at("duration");
+
+		if (fileStruct.ints.at("modifiers"))
+		{
+			memset(&modifiers, 0, sizeof(modifiers));
+
+			modifiers.modifyDmgGiven =		fileStruct.floats.at("mDmgGiven");
+			modifiers.modifyDmgTaken =		fileStruct.floats.at("mDmgTaken");
+			modifiers.modifyFirerate =		fileStruct.floats.at("mFirerate");
+			modifiers.modifyHP =			fileStruct.floats.at("mHP");
+			modifiers.modifyMovementSpeed = fileStruct.floats.at("mMovementSpeed");
+
+			creating.setModifiers(modifiers);
+		}
+
+		if (fileStruct.ints.at("specifics"))
+		{
+			memset(&spec, 0, sizeof(spec));
+		
+			spec.isBulletTime = fileStruct.floats.at("sBulletTime");
+			spec.isFreezing =	fileStruct.floats.at("sFreezing");
+
+			creating.setSpecifics(spec);
+		}
+
+		creating.setStandards(standards);
+		loaded[id++] = creating;
+	}
+
+	// a file missing something throws above, then the old effects are kept
+	for (int i = 0; i < id; i++)
+		s_effects[i] = loaded[i];
+}
+
 StatusManager::~StatusManager() {
 	clear();
 }
@@ -8,6 +8,7 @@ Game::Game()
 	m_player			= nullptr;
 	m_map				= nullptr;
 	m_projectileManager = nullptr;
+	m_clearStatics		= false;
 }
 
 Game::~Game() 
@@ -32,6 +33,9 @@ void Game::init()
 	m_player = new Player(Graphics::ModelID::CUBE, m_physics->createBody(Cylinder(PLAYER_START_POS, PLAYER_START_ROT, PLAYER_START_SCA), 75.f), PLAYER_START_SCA);
 	m_player->init(m_physics, m_projectileManager, &m_gameTime);
 
+	// Creating every enemy the waves will use, so nothing is allocated mid-wave
+	m_entityManager.initialize(*m_physics, m_projectileManager);
+
 	// Initializing Menu's
 	m_menu = newd MenuMachine();
 	m_menu->initialize(STARTING_STATE); 
@@ -43,11 +47,6 @@ void Game::init()
 	// Load these from a file at a later dates
 	m_waveTimer		= NULL;
 	m_waveCurrent	= WAVE_START;
-	m_waveTime[0]	= WAVE_1_TIME;
-	m_waveTime[1]	= WAVE_2_TIME;
-	m_waveTime[2]	= WAVE_3_TIME;
-	m_waveTime[3]	= WAVE_4_TIME;
-	m_waveTime[4]	= WAVE_5_TIME;
 
 	// Initializing Card Manager
 	m_cardManager = newd CardManager();
@@ -62,6 +61,7 @@ void Game::clear()
 	m_menu->clear();
 	delete m_menu;
 	delete m_map;
+	m_clearStatics = true;
 	delete m_cardManager;
 	m_projectileManager->clear();
 	delete m_projectileManager;
@@ -71,10 +71,11 @@ void Game::clear()
 void Game::waveUpdater()
 {
 	static bool	end = false;
-	if (!end)
+	WaveManager const &waves = m_entityManager.getWaveManager();
+	if (!end && m_waveCurrent < waves.getWaveCount())
 	{
 		m_waveTimer += m_gameTime.dt;
-		if (m_waveTimer > m_waveTime[m_waveCurrent])
+		if (m_waveTimer > waves.getWaveTime(m_waveCurrent))
 		{
 			// Spawning next wave
 			m_waveCurrent++;
@@ -83,13 +84,14 @@ void Game::waveUpdater()
 			m_entityManager.spawnWave(*m_physics, m_projectileManager);
 
 			// If the player have completed all the waves
-			if (m_waveCurrent == MAX_WAVES)
+			if (m_waveCurrent == waves.getWaveCount())
 			{
 				printf("No more waves.");
 				end = true;
+				return;
 			}
 		}
-        m_player->updateWaveInfo(m_waveCurrent + 1, m_entityManager.getEnemiesAlive(), (float)((m_waveTime[m_waveCurrent] - m_waveTimer) * 0.001));
+        m_player->updateWaveInfo(m_waveCurrent + 1, m_entityManager.getEnemiesAlive(), (float)((waves.getWaveTime(m_waveCurrent) - m_waveTimer) * 0.001));
 	}
 }
 
@@ -130,9 +132,16 @@ void Game::update(float deltaTime)
 
 void Game::render(Graphics::Renderer& renderer)
 {
+	if (m_clearStatics)
+	{
+		renderer.clearStatics();
+		m_clearStatics = false;
+	}
+
 	switch (m_menu->currentState())
 	{
 	case gameStateGame:
+		m_menu->preloadTextures(renderer);
 		m_player->render(renderer);
 		m_map->render(renderer);
 		m_entityManager.render(renderer);
@@ -1,4 +1,6 @@
 #include "Map.h"
+#include <Misc/FileLoader.h>
+#include <AI/LineOfSight.h>
 
 using namespace Logic;
 
@@ -17,6 +19,15 @@ void Map::init(Physics* physics, Player* player)
 //	initGrapplingPoints(physics, player);
 
 	m_drawHitboxes = true;
+
+	// nothing here moves, the renderer keeps them between frames
+	for (Entity* e : m_hitboxes)
+	{
+		e->setStatic(true);
+		e->setOccluder(true);
+	}
+	for (GrapplingPoint* g : m_grapplingPoints)
+		g->setStatic(true);
 }
 
 void Map::initProps()
@@ -34,77 +45,28 @@ void Map::initHitboxes(Physics* physics)
 	//Entity* headboxTest = new TestHeadShot(physics->createBody(Cube({ 30, 3, 5 }, { 0, 0, 0 }, { 1, 1, 1}), 0.f, false), { 1, 1, 1 });
 	//m_hitboxes.push_back(headboxTest);
 
-	Entity* house;
-
-	house = new Entity(physics->createBody(Cube({ 60, 0.75, 60 }, { 0, 0, 0 }, { 45, 0.75, 45 }), 0.f, false), { 45, 1.5f, 45 });
-	m_hitboxes.push_back(house);
-	
-	house = new Entity(physics->createBody(Cube({ 45, 1.5f, 45 }, { 0, 0, 0 }, { 10, 1.5f, 10 }), 0.f, false), { 10, 1.5f, 10 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 60, 2, 60 }, { 0, 0, 0 }, { 10, 2, 10 }), 0.f, false), { 10, 2, 10 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 80, 3, 80 }, { 0, 0, 0 }, { 15, 3, 15 }), 0.f, false), { 15, 3, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 50, 1, 80 }, { 0, 90, 90 }, { 15, 3, 15 }), 0.f, false), { 15, 3, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 80, 1, 40 }, { 40, -90, -90 }, { 15, 3, 15 }), 0.f, false), { 15, 3, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 120, 1, 180 }, { 40, 0, -90 }, { 60, 10, 45 }), 0.f, false), { 60, 10, 45 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 125, 5, 100 }, { 0, 0, 0 }, { 15, 5, 15 }), 0.f, false), { 15, 5, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 100, 4, 100 }, { 0, 0, 0 }, { 15, 4, 15 }), 0.f, false), { 15, 4, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 120, 4, 60 }, { 0, 0, 0 }, { 15, 4, 15 }), 0.f, false), { 15, 4, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 130, 4, 110 }, { 45, 0, 45 }, { 15, 4, 15 }), 0.f, false), { 15, 4, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 150, 6, 150 }, { 0, 0, 0 }, { 40, 6, 40 }), 0.f, false), { 40, 6, 40 });
-	m_hitboxes.push_back(house); 
-
-	house = new Entity(physics->createBody(Cube({ 60, 80, 60 }, { 0, 0, 0 }, { 45, 0.75, 45 }), 0.f, false), { 45, 1.5f, 45 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 45, 70, 45 }, { 0, 0, 0 }, { 10, 1.5f, 10 }), 0.f, false), { 10, 1.5f, 10 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 60, 50, 60 }, { 0, 0, 0 }, { 10, 2, 10 }), 0.f, false), { 10, 2, 10 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 80, 42, 80 }, { 0, 0, 0 }, { 15, 3, 15 }), 0.f, false), { 15, 3, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 50, 40, 80 }, { 0, 90, 90 }, { 15, 3, 15 }), 0.f, false), { 15, 3, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 125, 35, 100 }, { 0, 0, 0 }, { 15, 5, 15 }), 0.f, false), { 15, 5, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 100, 40, 100 }, { 0, 0, 0 }, { 15, 4, 15 }), 0.f, false), { 15, 4, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 120, 50, 60 }, { 0, 0, 0 }, { 15, 4, 15 }), 0.f, false), { 15, 4, 15 });
-	m_hitboxes.push_back(house);
-
-	house = new Entity(physics->createBody(Cube({ 130, 40, 110 }, { 45, 0, 45 }, { 15, 4, 15 }), 0.f, false), { 15, 4, 15 });
-	m_hitboxes.push_back(house);
+	// the buildings, the AI's line of sight tests read the same file
+	std::vector<FileLoader::LoadedStruct> boxes;
+	if (FileLoader::singleton().loadStructsFromFile(boxes, MAP_HITBOX_FILE) != 0)
+	{
+		printf("Can't load %s.lw, the map is only the ground (Map.cpp:%d)\n", MAP_HITBOX_FILE, __LINE__);
+		return;
+	}
 
-	house = new Entity(physics->createBody(Cube({ 150, 60, 150 }, { 0, 0, 0 }, { 40, 6, 40 }), 0.f, false), { 40, 6, 40 });
-	m_hitboxes.push_back(house);
+	for (auto const &box : boxes)
+	{
+		Cube cube(
+			{ box.floats.at("x"), box.floats.at("y"), box.floats.at("z") },
+			{ box.floats.at("rotX"), box.floats.at("rotY"), box.floats.at("rotZ") },
+			{ box.floats.at("width"), box.floats.at("height"), box.floats.at("depth") });
 
-	house = new Entity(physics->createBody(Cube({ -60, 6, -60 }, { 0.5f, 0, 0 }, { 25, 3, 25 }), 0.f, false), {25, 3, 25 });
-	m_hitboxes.push_back(house);
+		// a few are drawn thicker than they collide
+		btVector3 drawn = cube.getDimensions();
+		if (box.floats.count("drawHeight"))
+			drawn.setY(box.floats.at("drawHeight"));
 
+		m_hitboxes.push_back(new Entity(physics->createBody(cube, 0.f, false), drawn));
+	}
 }
 
 void Map::initObjects(Physics * physics)
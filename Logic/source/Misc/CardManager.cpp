@@ -1,5 +1,7 @@
 #include "../Misc/CardManager.h"
 #include <Misc\FileLoader.h>
+#include <algorithm>
+#include <stdio.h>
 
 using namespace Logic;
 
@@ -9,9 +11,14 @@ CardManager::CardManager()
 	{
 		m_hand[i] = -1; //is default
 	}
+
+	m_watch = FileLoader::singleton().watchFile("Cards", [this]() { reload(); });
 }
 
-CardManager::~CardManager() { }
+CardManager::~CardManager()
+{
+	FileLoader::singleton().unwatchFile(m_watch);
+}
 
 void CardManager::clear()
 {
@@ -19,9 +26,16 @@ void CardManager::clear()
 }
 
 void CardManager::init() 
+{
+	loadCards(m_cards);
+}
+
+int CardManager::loadCards(std::vector<Card> &cards)
 {
 	std::vector<FileLoader::LoadedStruct> cardFile;
-	FileLoader::singleton().loadStructsFromFile(cardFile, "Cards");
+	int result = FileLoader::singleton().loadStructsFromFile(cardFile, "Cards");
+	if (result != 0)
+		return result;
 
 	for (auto const& struc : cardFile)
 	{
@@ -33,8 +47,10 @@ void CardManager::init()
 
 		DirectX::SimpleMath::Vector2 texStart(struc.floats.at("xTexStart"), struc.floats.at("yTexStart"));
 		DirectX::SimpleMath::Vector2 texEnd(struc.floats.at("xTexEnd"), struc.floats.at("yTexEnd"));;
-		m_cards.push_back(Card(struc.strings.at("cardName"), struc.strings.at("texture"), struc.strings.at("description"), upgrades, texStart, texEnd, struc.ints.at("isEffect"))); //something wrong here
+		cards.push_back(Card(struc.strings.at("cardName"), struc.strings.at("texture"), struc.strings.at("description"), upgrades, texStart, texEnd, struc.ints.at("isEffect"))); //something wrong here
 	}
+
+	return 0;
 }
 
 void CardManager::restart()
@@ -43,6 +59,29 @@ void CardManager::restart()
 	init();
 }
 
+void CardManager::reload()
+{
+	// read completely before anything is replaced, a card missing a field throws
+	std::vector<Card> cards;
+	int result = loadCards(cards);
+	if (result != 0 || cards.empty())
+	{
+		// saved half way or emptied by mistake, playing on with the old cards beats an empty deck
+		printf("Can't reload Cards.lw (%d, %d cards), the old cards are kept (CardManager.cpp:%d)\n", result, (int)cards.size(), __LINE__);
+		return;
+	}
+	m_cards.swap(cards);
+
+	// indices to cards that were removed from the file
+	int count = (int)m_cards.size();
+	m_deck.erase(std::remove_if(m_deck.begin(), m_deck.end(), [count](int card) { return card >= count; }), m_deck.end());
+	for (int i = 0; i < handSize; i++)
+	{
+		if (m_hand[i] >= count)
+			m_hand[i] = -1;
+	}
+}
+
 void Logic::CardManager::createDeck(int nrOfEach)
 {
 	for (int i = 0; i < nrOfEach; i++)
@@ -1,9 +1,12 @@
 #include <Misc/FileLoader.h>
+#include <Graphics/include/Resources/VirtualFileSystem.h>
+#include <Graphics/include/Resources/HotReloader.h>
 
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <ctype.h>
+#include <algorithm>
 
 #define LINE_END ';'
 #define LINE_ASSIGN ':'
@@ -61,10 +64,15 @@ int FileLoader::parseString(LoadedStruct &loaded, std::string const &str)
 
 int FileLoader::loadStructsFromFile(std::vector<LoadedStruct> &loadedStructs, std::string const &fileName, int offset, int fileOffset, int filePadding)
 {
-	std::ifstream inf(FILE_PATH + fileName + FILE_EXT);
-	if (!inf.is_open())
+	// from the asset archive if it's in there, saved files are read loose
+	std::string text;
+	if (!Graphics::VirtualFileSystem::singleton().read(FILE_PATH + fileName + FILE_EXT, text))
 		return -1; // see .h for error stuff
 
+	// what reading it in text mode did, the parsing doesn't expect \r
+	text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+	std::istringstream inf(text);
+
 	std::string temp;
 	inf.seekg(1); // first symbol should always be { so that is why. That can be skipped. Better solution would be to find it and use the index, but unnecessary for the moment
 	for (int i = 0; i < fileOffset; i++) getline(inf, temp, START); // go through offset
@@ -77,8 +85,6 @@ int FileLoader::loadStructsFromFile(std::vector<LoadedStruct> &loadedStructs, st
 		for (int i = 0; i < filePadding; ++i) getline(inf, temp, START); // go through padding
 	}
 
-	inf.close();
-
 	return 0;
 }
 
@@ -113,4 +119,14 @@ int FileLoader::saveStructsToFile(std::vector<LoadedStruct> &loadedStructs, std:
 	outFile.close();
 
 	return 0;
+}
+
+unsigned int FileLoader::watchFile(std::string const &fileName, std::function<void()> onChange)
+{
+	return Graphics::HotReloader::singleton().subscribe(FILE_PATH + fileName + FILE_EXT, [onChange](std::string const &path) { onChange(); });
+}
+
+void FileLoader::unwatchFile(unsigned int watch)
+{
+	Graphics::HotReloader::singleton().unsubscribe(watch);
 }
\ No newline at end of file
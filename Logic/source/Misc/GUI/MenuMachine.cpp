@@ -128,6 +128,7 @@ void Logic::MenuMachine::update(float dt)
 
 void Logic::MenuMachine::render(Graphics::Renderer & renderer)
 {
+    preloadTextures(renderer);
     Graphics::MenuInfo temp = this->currentActiveMenu->getMenuInfo();
 
     renderer.drawMenu(&temp);
@@ -135,6 +136,18 @@ void Logic::MenuMachine::render(Graphics::Renderer & renderer)
 }
 
 
+//Loads the textures of the next state during the transition animation, not the frame it is first drawn
+void Logic::MenuMachine::preloadTextures(Graphics::Renderer & renderer)
+{
+	if (stateToBe == gameStateDefault)
+		return;
+
+	if (stateToBe == gameStateGame)
+		renderer.preloadTextures(Graphics::TextureResidency::SCOPE_GAME | Graphics::TextureResidency::SCOPE_HUD);
+	else
+		renderer.preloadTextures(Graphics::TextureResidency::SCOPE_MENU);
+}
+
 //Switches the currentState used 
 void Logic::MenuMachine::showMenu(GameState state)
 {
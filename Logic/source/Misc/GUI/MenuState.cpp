@@ -23,6 +23,8 @@ void Logic::MenuState::initialize(std::vector<ButtonStruct> buttonStruct, std::s
 		m_buttons.push_back(newd Button());
 		m_buttons.at(m_buttons.size() - 1)->initialize(pos, texCoordStart, texCoordEnd, struc.height, struc.width, struc.texture, struc.m_CallBackFunction);
     }
+
+	m_menu.m_menuTexture = background;
 }
 
 void Logic::MenuState::updateOnPress(int posX, int posY)
@@ -537,12 +537,12 @@ void Player::setMoveDirection(btVector3 moveDir)
 	m_moveDir = moveDir;
 }
 
-btVector3 Player::getForwardBT()
+btVector3 Player::getForwardBT() const
 {
 	return btVector3(m_forward.x, m_forward.y, m_forward.z);
 }
 
-DirectX::SimpleMath::Vector3 Player::getForward()
+DirectX::SimpleMath::Vector3 Player::getForward() const
 {
 	return m_forward;
 }
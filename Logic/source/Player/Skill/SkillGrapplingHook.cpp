@@ -14,7 +14,7 @@ SkillGrapplingHook::SkillGrapplingHook(Physics* physics)
 	// Debug draw ray
 	renderDebug.points = new std::vector<DirectX::SimpleMath::Vector3>;
 	renderDebug.color = DirectX::SimpleMath::Color(1, 1, 1);
-	renderDebug.topology = D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+	renderDebug.topology = Graphics::TOPOLOGY_LINELIST;
 	renderDebug.useDepth = true;
 }
 
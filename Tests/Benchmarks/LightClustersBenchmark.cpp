@@ -0,0 +1,70 @@
+#include <Test.h>
+#include <Lights/ClusteredLightGrid.h>
+#include "../Graphics/Projection.h"
+#include <chrono>
+
+using namespace Graphics;
+
+/*
+    Assigning 1024 lights to the game's clusters every frame, what a big
+    wave with muzzle flashes, projectiles and explosions would need. The
+    lights move a bit every frame like they would in the game.
+*/
+
+#define LIGHTS  1024
+#define FRAMES  60
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Random
+    {
+        unsigned int state;
+
+        float next(float min, float max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return min + (max - min) * ((state >> 8) / float(1 << 24));
+        }
+    };
+}
+
+TEST(LightClusters1024Lights)
+{
+    uint32_t resolutions[][2] = { { 1280, 720 }, { 1920, 1080 } };
+    int frames = FRAMES * Test::getBenchmarkScale();
+
+    for (auto const & resolution : resolutions)
+    {
+        float proj[16], view[16];
+        Projection::perspective(float(M_PI * 0.45), resolution[0] / (float)resolution[1], 0.1f, 250.f, proj);
+        Projection::identity(view);
+
+        LightClusters clusters(resolution[0], resolution[1], CLUSTER_TILE_SIZE, CLUSTER_SLICES);
+        clusters.setProjection(proj);
+
+        Random random = { 1024 };
+        std::vector<LightClusters::ClusterLight> lights(LIGHTS);
+        for (LightClusters::ClusterLight & light : lights)
+            light = { { random.next(-80.f, 80.f), random.next(0.f, 6.f), random.next(-160.f, 20.f) }, random.next(1.f, 8.f) };
+
+        size_t indices = 0;
+        Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            for (LightClusters::ClusterLight & light : lights)
+                light.position[2] += frame & 1 ? 0.1f : -0.1f;
+            clusters.assign(view, lights.data(), lights.size());
+            indices += clusters.getIndexList().size();
+        }
+        double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+
+        printf("    %ux%u, %u clusters, %d lights: %.3f ms a frame, %.0f light indices\n", resolution[0], resolution[1],
+            clusters.getClusterCount(), LIGHTS, time, indices / (double)frames);
+
+        CHECK(clusters.getIndexList().size() > 0);
+        // far less than every light in every tile
+        CHECK(clusters.getIndexList().size() < (size_t)LIGHTS * clusters.getClusterCount() / 100);
+    }
+}
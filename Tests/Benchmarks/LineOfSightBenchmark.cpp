@@ -0,0 +1,131 @@
+#include <Test.h>
+#include <AI/LineOfSight.h>
+#include <AI/VisibilityService.h>
+#include <chrono>
+#include <math.h>
+
+using namespace Logic;
+
+/*
+    300 ranged enemies asking if they can see the player every AI tick,
+    in the map's buildings (MapHitboxes.lw). One ray each, against the
+    service with its cells and cache. The enemies are in groups like a
+    wave spawns them and walk slowly, the player runs around the map.
+*/
+
+#define ENEMIES         300
+#define GROUP_SIZE      10
+#define TICKS           600
+#define TICK_SECONDS    0.05f
+#define PLAYER_SPEED    8.f     // units a second
+#define ENEMY_SPEED     2.f
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Random
+    {
+        unsigned int state;
+
+        float next(float min, float max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return min + (max - min) * ((state >> 8) / float(1 << 24));
+        }
+    };
+
+    struct World
+    {
+        std::vector<btVector3> enemies, headings;
+        Random random;
+
+        World()
+        {
+            random = { 1234 };
+            for (int group = 0; group < ENEMIES / GROUP_SIZE; group++)
+            {
+                btVector3 center(random.next(-80.f, 200.f), 1.f, random.next(-80.f, 200.f));
+                for (int i = 0; i < GROUP_SIZE; i++)
+                {
+                    enemies.push_back(center + btVector3(random.next(-4.f, 4.f), 0.f, random.next(-4.f, 4.f)));
+                    float angle = random.next(0.f, SIMD_2_PI);
+                    headings.push_back(btVector3(cosf(angle), 0.f, sinf(angle)) * ENEMY_SPEED * TICK_SECONDS);
+                }
+            }
+        }
+
+        btVector3 getPlayer(int tick) const
+        {
+            // around the middle of the buildings
+            float angle = tick * TICK_SECONDS * PLAYER_SPEED / 70.f;
+            return btVector3(80.f + 70.f * cosf(angle), 2.f, 80.f + 70.f * sinf(angle));
+        }
+
+        void move()
+        {
+            for (size_t i = 0; i < enemies.size(); i++)
+                enemies[i] += headings[i];
+        }
+    };
+}
+
+TEST(LineOfSight300Enemies)
+{
+    BoxLineOfSight boxes;
+    REQUIRE(boxes.load(MAP_HITBOX_FILE) == 0);
+    REQUIRE(boxes.getBoxCount() > 0);
+
+    int ticks = TICKS * Test::getBenchmarkScale();
+
+    // every enemy casts its own ray every tick
+    World direct;
+    std::vector<LineOfSight::Ray> rays(ENEMIES);
+    std::vector<std::vector<bool>> truth(ticks, std::vector<bool>(ENEMIES));
+    long long directRays = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        for (int i = 0; i < ENEMIES; i++)
+            rays[i].from = direct.enemies[i];
+        boxes.castRays(rays.data(), ENEMIES, direct.getPlayer(tick));
+        directRays += ENEMIES;
+
+        for (int i = 0; i < ENEMIES; i++)
+            truth[tick][i] = rays[i].visible;
+        direct.move();
+    }
+    double directTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // the service, the same enemies and the same player
+    World cached;
+    VisibilityService visibility;
+    visibility.init(&boxes);
+    long long serviceRays = 0, hits = 0, misses = 0, wrong = 0;
+
+    start = Clock::now();
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        visibility.beginFrame(cached.getPlayer(tick));
+        for (int i = 0; i < ENEMIES; i++)
+            wrong += visibility.isVisible(cached.enemies[i]) != truth[tick][i];
+        hits += visibility.getStats().hits;
+        misses += visibility.getStats().misses;
+        serviceRays += visibility.flush();
+        cached.move();
+    }
+    double serviceTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    long long questions = (long long)ticks * ENEMIES;
+    printf("    %d enemies, %d ticks, %d boxes\n", ENEMIES, ticks, boxes.getBoxCount());
+    printf("    direct:  %lld rays, %.3f ms a tick\n", directRays, directTime / ticks);
+    printf("    service: %lld rays, %.3f ms a tick, %.1f%% hits, %.1f%% answered differently\n",
+        serviceRays, serviceTime / ticks, 100.0 * hits / questions, 100.0 * wrong / questions);
+
+    CHECK(hits + misses == questions);
+    // groups share cells and answers last a few ticks
+    CHECK(serviceRays * 4 < directRays);
+    // a stale or not yet cast answer now and then, not a different game
+    CHECK(wrong * 10 < questions);
+}
@@ -0,0 +1,151 @@
+#include <Test.h>
+#include <Utility/OcclusionCuller.h>
+#include <AI/LineOfSight.h>
+#include <Misc/FileLoader.h>
+#include "../Graphics/Projection.h"
+#include <chrono>
+
+using namespace Graphics;
+
+/*
+    The map's buildings (MapHitboxes.lw) and ground as occluders, like
+    Renderer::cull draws them, and 2000 enemy sized boxes walking between
+    them. 32 camera positions around the map at head height, every one
+    clears, rasterizes and tests everything.
+*/
+
+#define INSTANCES   2000
+#define CAMERAS     32
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Random
+    {
+        unsigned int state;
+
+        float next(float min, float max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return min + (max - min) * ((state >> 8) / float(1 << 24));
+        }
+    };
+
+    struct Box
+    {
+        float min[3], max[3];
+    };
+
+    // right handed look at from eye to target, like SimpleMath's CreateLookAt
+    void lookAt(const float eye[3], const float target[3], float view[16])
+    {
+        float z[3] = { eye[0] - target[0], eye[1] - target[1], eye[2] - target[2] };
+        float length = sqrtf(z[0] * z[0] + z[1] * z[1] + z[2] * z[2]);
+        for (float & v : z) v /= length;
+
+        float x[3] = { z[2], 0.f, -z[0] };
+        length = sqrtf(x[0] * x[0] + x[2] * x[2]);
+        x[0] /= length;
+        x[2] /= length;
+        float y[3] = { z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0] };
+
+        Projection::identity(view);
+        for (int i = 0; i < 3; i++)
+        {
+            view[i * 4] = x[i];
+            view[i * 4 + 1] = y[i];
+            view[i * 4 + 2] = z[i];
+        }
+        view[12] = -(x[0] * eye[0] + x[1] * eye[1] + x[2] * eye[2]);
+        view[13] = -(y[0] * eye[0] + y[1] * eye[1] + y[2] * eye[2]);
+        view[14] = -(z[0] * eye[0] + z[1] * eye[1] + z[2] * eye[2]);
+    }
+
+    // v * m for whole matrices
+    void multiply(const float a[16], const float b[16], float out[16])
+    {
+        for (int row = 0; row < 4; row++)
+            Projection::transform(a + row * 4, b, out + row * 4);
+    }
+}
+
+TEST(OcclusionCullerMap)
+{
+    // the buildings as axis aligned boxes, the same as the line of sight tests use them
+    std::vector<Logic::FileLoader::LoadedStruct> loaded;
+    REQUIRE(Logic::FileLoader::singleton().loadStructsFromFile(loaded, MAP_HITBOX_FILE) == 0);
+
+    std::vector<Box> occluders;
+    occluders.push_back({ { -1000.f, -0.0001f, -1000.f }, { 1000.f, 0.0001f, 1000.f } });
+    for (auto const & box : loaded)
+    {
+        float center[3] = { box.floats.at("x"), box.floats.at("y"), box.floats.at("z") };
+        float extent[3] = { box.floats.at("width"), box.floats.at("height"), box.floats.at("depth") };
+        occluders.push_back({ { center[0] - extent[0], center[1] - extent[1], center[2] - extent[2] },
+                              { center[0] + extent[0], center[1] + extent[1], center[2] + extent[2] } });
+    }
+
+    Random random = { 2000 };
+    std::vector<Box> instances(INSTANCES);
+    for (Box & box : instances)
+    {
+        float x = random.next(-80.f, 200.f), z = random.next(-80.f, 200.f);
+        box = { { x - 0.5f, 0.f, z - 0.5f }, { x + 0.5f, 2.f, z + 0.5f } };
+    }
+
+    float proj[16], world[16];
+    Projection::perspective(float(M_PI * 0.45), 16.f / 9.f, 0.1f, 250.f, proj);
+    Projection::identity(world);
+
+    OcclusionCuller culler(256, 144), screen(256, 144);
+    int rounds = Test::getBenchmarkScale();
+    double rasterizeTime = 0.0, testTime = 0.0;
+    size_t triangles = 0, onScreen = 0, culled = 0;
+
+    for (int round = 0; round < rounds; round++)
+    {
+        for (int camera = 0; camera < CAMERAS; camera++)
+        {
+            float angle = camera * float(2.0 * M_PI / CAMERAS);
+            float eye[3] = { 60.f + 90.f * cosf(angle), 2.f, 60.f + 90.f * sinf(angle) };
+            float target[3] = { 60.f, 2.f, 60.f };
+            float view[16], viewProjection[16];
+            lookAt(eye, target, view);
+            multiply(view, proj, viewProjection);
+
+            Clock::time_point start = Clock::now();
+            culler.clear(viewProjection);
+            for (Box const & box : occluders)
+                culler.addOccluder(world, box.min, box.max);
+            culler.buildHierarchy();
+            Clock::time_point rasterized = Clock::now();
+
+            size_t visible = 0;
+            for (Box const & box : instances)
+                visible += culler.isVisible(world, box.min, box.max);
+            Clock::time_point tested = Clock::now();
+
+            rasterizeTime += std::chrono::duration<double, std::milli>(rasterized - start).count();
+            testTime += std::chrono::duration<double, std::micro>(tested - rasterized).count();
+            triangles += culler.getTriangleCount();
+
+            // off screen doesn't count, only what the buildings hide
+            screen.clear(viewProjection);
+            screen.buildHierarchy();
+            size_t inView = 0;
+            for (Box const & box : instances)
+                inView += screen.isVisible(world, box.min, box.max);
+            onScreen += inView;
+            culled += inView - visible;
+        }
+    }
+
+    int frames = rounds * CAMERAS;
+    printf("    %zu occluders, %.0f triangles: %.3f ms to rasterize, %.3f us per instance, %.1f%% of %.0f on screen culled\n",
+        occluders.size(), triangles / (double)frames, rasterizeTime / frames, testTime / frames / INSTANCES,
+        100.0 * culled / onScreen, onScreen / (double)frames);
+
+    // the buildings hide a good part of the map from head height
+    CHECK(culled > onScreen / 4);
+}
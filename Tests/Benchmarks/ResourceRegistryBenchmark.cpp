@@ -0,0 +1,78 @@
+#include <Test.h>
+#include <Resources/ResourceRegistry.h>
+#include <chrono>
+
+using namespace Graphics;
+
+/*
+    Looking textures up by name with 10k of them registered, against the
+    vector of names TextureManager compared one by one before the registry.
+    Lookups are random names that are all registered.
+*/
+
+#define NAMES   10000
+#define LOOKUPS 100000
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Random
+    {
+        unsigned int state;
+
+        uint32_t next(uint32_t count)
+        {
+            state = state * 1664525u + 1013904223u;
+            return (state >> 8) % count;
+        }
+    };
+}
+
+TEST(ResourceRegistry10kNames)
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < NAMES; i++)
+        names.push_back("Resources/Textures/texture" + std::to_string(i) + ".png");
+
+    ResourceRegistry registry;
+    for (std::string const & name : names)
+        registry.acquire(name);
+    REQUIRE(registry.getCount() == NAMES);
+
+    int lookups = LOOKUPS * Test::getBenchmarkScale();
+    Random random = { 10000 };
+    std::vector<uint32_t> order(lookups);
+    for (uint32_t & i : order)
+        i = random.next(NAMES);
+
+    uint64_t found = 0;
+    Clock::time_point start = Clock::now();
+    for (uint32_t i : order)
+        found += registry.getIndex(registry.find(names[i])) == i;
+    double hashed = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / lookups;
+
+    // the old way, a tenth as many lookups or it takes forever
+    int linearLookups = lookups / 10;
+    uint64_t linearFound = 0;
+    start = Clock::now();
+    for (int lookup = 0; lookup < linearLookups; lookup++)
+    {
+        std::string const & name = names[order[lookup]];
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if (names[i] == name)
+            {
+                linearFound += i == order[lookup];
+                break;
+            }
+        }
+    }
+    double linear = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / linearLookups;
+
+    printf("    %d names: %.0f ns a hashed lookup, %.0f ns a linear one\n", NAMES, hashed, linear);
+
+    CHECK(found == (uint64_t)lookups);
+    CHECK(linearFound == (uint64_t)linearLookups);
+    CHECK(hashed < linear);
+}
@@ -0,0 +1,77 @@
+#include <Test.h>
+#include <Lights/TiledLightCulling.h>
+#include "../Graphics/Projection.h"
+#include <chrono>
+#include <algorithm>
+
+using namespace Graphics;
+
+/*
+    The CPU tiled culling at the game's tile size, for the resolutions we
+    run at and more and more lights. The scene is a floor going away from
+    the camera, the lights are spread over it like projectiles and
+    explosions in a wave.
+*/
+
+#define BLOCK_SIZE  16
+#define FRAMES      3
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Random
+    {
+        unsigned int state;
+
+        float next(float min, float max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return min + (max - min) * ((state >> 8) / float(1 << 24));
+        }
+    };
+}
+
+TEST(TiledLightCullingSweep)
+{
+    uint32_t resolutions[][2] = { { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 } };
+    uint32_t lightCounts[] = { 8, 64, 256, 1024 };
+    int frames = FRAMES * Test::getBenchmarkScale();
+
+    for (auto const & resolution : resolutions)
+    {
+        uint32_t width = resolution[0], height = resolution[1];
+        float proj[16], invProj[16], view[16];
+        Projection::perspective(1.4f, width / (float)height, 0.1f, 250.f, proj);
+        Projection::invert(proj, invProj);
+        Projection::identity(view);
+
+        std::vector<float> depth(width * height);
+        for (uint32_t y = 0; y < height; y++)
+            std::fill(depth.begin() + y * width, depth.begin() + (y + 1) * width,
+                y < height / 3 ? 1.f : Projection::depthOf(proj, -(3.f + 120.f * (1.f - y / (float)height))));
+
+        TiledLightCuller culler(width, height, BLOCK_SIZE);
+        culler.buildFrustums(invProj);
+
+        for (uint32_t lightCount : lightCounts)
+        {
+            Random random = { lightCount };
+            std::vector<TiledLightCuller::CullLight> lights(lightCount);
+            for (TiledLightCuller::CullLight & light : lights)
+                light = { { random.next(-60.f, 60.f), random.next(-4.f, 4.f), random.next(-120.f, -3.f) }, random.next(1.f, 6.f) };
+
+            Clock::time_point start = Clock::now();
+            for (int frame = 0; frame < frames; frame++)
+                culler.cull(view, invProj, depth.data(), lights.data(), lights.size());
+            double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+
+            size_t tiles = culler.getTilesX() * culler.getTilesY();
+            printf("    %4ux%-4u %4u lights: %7.2f ms, %.1f lights a tile\n", width, height, lightCount, time,
+                culler.getOpaqueIndexList().size() / (double)tiles);
+
+            CHECK(culler.getOpaqueIndexList().size() <= tiles * lightCount);
+            CHECK(culler.getTransparentIndexList().size() >= culler.getOpaqueIndexList().size());
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+/*
+    The smallest test runner that does the job, so the tests build
+    anywhere without pulling in a framework. Every test file is its own
+    executable linked with TestMain.cpp, ctest runs them (see
+    Tests/CMakeLists.txt) from the Engine folder, where the game runs, so
+    Resources/ paths work like they do in the game.
+
+    A failed CHECK prints where and keeps going, a failed REQUIRE stops the
+    test it's in. The executable returns how many tests failed.
+
+    Benchmarks are tests too, they check what they measure is still right
+    and print the timings. BENCHMARK_SCALE in the environment makes them
+    run longer, ctest runs them short.
+
+    HOW TO USE:
+        TEST(SpawnSchedulerKeepsOrder)
+        {
+            REQUIRE(scheduler.getPending() == 3);
+            CHECK_NEAR(event.time, 2000.f, 0.01f);
+        }
+*/
+
+namespace Test
+{
+    typedef void(*Function)();
+
+    struct Case
+    {
+        const char * name;
+        Function function;
+    };
+
+    struct Failure {};
+
+    inline std::vector<Case> & getCases()
+    {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline int & getFailedChecks()
+    {
+        static int failed = 0;
+        return failed;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char * name, Function function)
+        {
+            getCases().push_back({ name, function });
+        }
+    };
+
+    inline void fail(const char * file, int line, const char * expression)
+    {
+        printf("    %s:%d: CHECK(%s) failed\n", file, line, expression);
+        getFailedChecks()++;
+    }
+
+    // how many times longer benchmarks run than under ctest
+    int getBenchmarkScale();
+}
+
+#define TEST(name) \
+    static void name(); \
+    static Test::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(expression) \
+    do { if (!(expression)) Test::fail(__FILE__, __LINE__, #expression); } while (0)
+
+#define REQUIRE(expression) \
+    do { if (!(expression)) { Test::fail(__FILE__, __LINE__, #expression); throw Test::Failure(); } } while (0)
+
+#define CHECK_NEAR(a, b, epsilon) \
+    CHECK(fabs((double)(a) - (double)(b)) <= (double)(epsilon))
@@ -0,0 +1,49 @@
+#include "Test.h"
+#include <stdlib.h>
+#include <string.h>
+#include <exception>
+
+int Test::getBenchmarkScale()
+{
+    const char * scale = getenv("BENCHMARK_SCALE");
+    int value = scale ? atoi(scale) : 1;
+    return value > 0 ? value : 1;
+}
+
+// every test, or only the ones named on the command line
+int main(int argc, char * argv[])
+{
+    int failedTests = 0, ran = 0;
+
+    for (Test::Case const & test : Test::getCases())
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; i++)
+            selected = strcmp(argv[i], test.name) == 0;
+        if (!selected)
+            continue;
+
+        int before = Test::getFailedChecks();
+        printf("%s\n", test.name);
+
+        try
+        {
+            test.function();
+        }
+        catch (Test::Failure const &)
+        {
+        }
+        catch (std::exception const & error)
+        {
+            printf("    threw %s\n", error.what());
+            Test::getFailedChecks()++;
+        }
+
+        if (Test::getFailedChecks() != before)
+            failedTests++;
+        ran++;
+    }
+
+    printf("%d of %d tests passed\n", ran - failedTests, ran);
+    return failedTests;
+}
@@ -0,0 +1,194 @@
+#include <Test.h>
+#include <Graphics/include/Resources/AssetArchive.h>
+#include <Graphics/include/Resources/LZ4.h>
+#include <string.h>
+
+using namespace Graphics;
+
+namespace
+{
+    struct Random
+    {
+        unsigned int state;
+
+        uint32_t next(uint32_t count)
+        {
+            state = state * 1664525u + 1013904223u;
+            return (state >> 8) % count;
+        }
+    };
+
+    // text repeats and compresses, noise doesn't
+    std::vector<char> makeText(size_t size)
+    {
+        const char line[] = "float4 PS(VSOutput input) : SV_Target { return diffuse.Sample(linearSampler, input.uv); }\n";
+        std::vector<char> bytes(size);
+        for (size_t i = 0; i < size; i++)
+            bytes[i] = line[i % (sizeof(line) - 1)];
+        return bytes;
+    }
+
+    std::vector<char> makeNoise(size_t size, unsigned int seed)
+    {
+        Random random = { seed };
+        std::vector<char> bytes(size);
+        for (char & c : bytes)
+            c = (char)random.next(256);
+        return bytes;
+    }
+
+    std::vector<AssetArchive::Input> makeInputs()
+    {
+        return
+        {
+            { "Resources/Shaders/Forward.hlsl", makeText(20000), true },
+            { "Resources/Textures/wood.jpg", makeNoise(5000, 1), true },
+            { "Resources/Data/MapHitboxes.lw", makeText(300), false },
+            { "Resources/Data/empty.lw", {}, true },
+        };
+    }
+}
+
+TEST(LZ4RoundTrips)
+{
+    std::vector<std::vector<char>> sources = { makeText(100000), makeNoise(10000, 2), makeText(3), {}, std::vector<char>(70000, 'a') };
+
+    for (std::vector<char> const & source : sources)
+    {
+        std::vector<char> compressed(LZ4::getMaxCompressedSize(source.size()));
+        size_t size = LZ4::compress(source.data(), source.size(), compressed.data(), compressed.size());
+        REQUIRE(size > 0);
+
+        std::vector<char> decompressed(source.size());
+        CHECK(LZ4::decompress(compressed.data(), size, decompressed.data(), decompressed.size()));
+        CHECK(decompressed == source);
+
+        // anything but the exact size is broken
+        std::vector<char> wrong(source.size() + 1);
+        CHECK(!LZ4::decompress(compressed.data(), size, wrong.data(), wrong.size()));
+    }
+
+    std::vector<char> text = makeText(100000), compressed(LZ4::getMaxCompressedSize(text.size()));
+    CHECK(LZ4::compress(text.data(), text.size(), compressed.data(), compressed.size()) < text.size() / 10);
+    CHECK(LZ4::compress(text.data(), text.size(), compressed.data(), 10) == 0);
+}
+
+TEST(ArchiveReadsBackWhatWasPacked)
+{
+    std::vector<AssetArchive::Input> inputs = makeInputs();
+    std::vector<char> bytes;
+    std::string errors;
+    REQUIRE(AssetArchive::build(inputs, 16, bytes, errors));
+
+    AssetArchive archive;
+    REQUIRE(archive.open(bytes.data(), bytes.size()));
+    CHECK(archive.getEntryCount() == inputs.size());
+
+    for (AssetArchive::Input const & input : inputs)
+    {
+        const AssetArchive::Entry * entry = archive.find(input.name);
+        REQUIRE(entry);
+        CHECK(entry->offset % 16 == 0);
+        CHECK(entry->size == input.bytes.size());
+        CHECK(archive.getName(*entry) == AssetArchive::normalizeName(input.name));
+
+        std::vector<char> read;
+        CHECK(archive.read(*entry, read));
+        CHECK(read == input.bytes);
+    }
+
+    // compressed only when it is asked for and saves something
+    const AssetArchive::Entry * shader = archive.find("Resources/Shaders/Forward.hlsl");
+    const AssetArchive::Entry * texture = archive.find("Resources/Textures/wood.jpg");
+    const AssetArchive::Entry * data = archive.find("Resources/Data/MapHitboxes.lw");
+    CHECK(shader->flags & AssetArchive::ENTRY_LZ4);
+    CHECK(shader->storedSize < shader->size / 4);
+    CHECK(!archive.getData(*shader));
+    CHECK(!(texture->flags & AssetArchive::ENTRY_LZ4));
+    CHECK(!(data->flags & AssetArchive::ENTRY_LZ4));
+    REQUIRE(archive.getData(*data));
+    CHECK(memcmp(archive.getData(*data), inputs[2].bytes.data(), inputs[2].bytes.size()) == 0);
+
+    CHECK(!archive.find("Resources/Data/missing.lw"));
+}
+
+TEST(NamesAreNormalized)
+{
+    CHECK(AssetArchive::normalizeName("Resources\\Textures\\Wood.JPG") == "resources/textures/wood.jpg");
+    CHECK(AssetArchive::normalizeName("./Resources/Data/Cards.lw") == "resources/data/cards.lw");
+
+    std::vector<AssetArchive::Input> inputs = makeInputs();
+    std::vector<char> bytes;
+    std::string errors;
+    REQUIRE(AssetArchive::build(inputs, 64, bytes, errors));
+    AssetArchive archive;
+    REQUIRE(archive.open(bytes.data(), bytes.size()));
+
+    CHECK(archive.find("resources\\SHADERS\\forward.hlsl") == archive.find("Resources/Shaders/Forward.hlsl"));
+    CHECK(archive.find("./Resources/Textures/wood.jpg"));
+    for (uint32_t i = 0; i < archive.getEntryCount(); i++)
+        CHECK(archive.getEntry(i).offset % 64 == 0);
+
+    // the same file twice under different spellings
+    inputs.push_back({ "resources/shaders/FORWARD.hlsl", makeText(10), true });
+    CHECK(!AssetArchive::build(inputs, 16, bytes, errors));
+    CHECK(!errors.empty());
+}
+
+TEST(ManyEntriesAreFound)
+{
+    std::vector<AssetArchive::Input> inputs;
+    for (int i = 0; i < 2000; i++)
+        inputs.push_back({ "Resources/Models/model" + std::to_string(i) + ".brf", makeText(16 + i % 50), i % 2 == 0 });
+
+    std::vector<char> bytes;
+    std::string errors;
+    REQUIRE(AssetArchive::build(inputs, 16, bytes, errors));
+    AssetArchive archive;
+    REQUIRE(archive.open(bytes.data(), bytes.size()));
+
+    for (AssetArchive::Input const & input : inputs)
+    {
+        const AssetArchive::Entry * entry = archive.find(input.name);
+        REQUIRE(entry);
+        std::vector<char> read;
+        CHECK(archive.read(*entry, read) && read == input.bytes);
+    }
+}
+
+TEST(BrokenArchivesAreRejected)
+{
+    std::vector<AssetArchive::Input> inputs = makeInputs();
+    std::vector<char> bytes;
+    std::string errors;
+    REQUIRE(AssetArchive::build(inputs, 16, bytes, errors));
+
+    AssetArchive archive;
+    CHECK(!archive.open(bytes.data(), 10));
+    CHECK(!archive.isOpen());
+    std::vector<char> noMagic = bytes;
+    noMagic[0] = 'X';
+    CHECK(!archive.open(noMagic.data(), noMagic.size()));
+
+    // random bytes changed, it is rejected or reads without going outside the archive
+    Random random = { 45 };
+    int opened = 0;
+    for (int round = 0; round < 2000; round++)
+    {
+        std::vector<char> broken = bytes;
+        for (int i = 0; i < 4; i++)
+            broken[random.next((uint32_t)broken.size())] = (char)random.next(256);
+        size_t size = random.next(4) == 0 ? random.next((uint32_t)broken.size()) : broken.size();
+
+        if (!archive.open(broken.data(), size))
+            continue;
+        opened++;
+        for (uint32_t i = 0; i < archive.getEntryCount(); i++)
+        {
+            std::vector<char> read;
+            if (archive.read(archive.getEntry(i), read))
+                CHECK(read.size() == archive.getEntry(i).size);
+        }
+    }
+    CHECK(opened > 0);
+}
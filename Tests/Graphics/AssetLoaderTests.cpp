@@ -0,0 +1,227 @@
+#include <Test.h>
+#include <Resources/AssetLoader.h>
+#include <atomic>
+#include <chrono>
+
+using namespace Graphics;
+
+namespace
+{
+    // files are their own path, "missing" ones can't be read
+    bool fakeRead(std::string const & path, std::vector<char> & bytes)
+    {
+        if (path.find("missing") != std::string::npos)
+            return false;
+        bytes.assign(path.begin(), path.end());
+        return true;
+    }
+
+    // a decoder taking a little time, different for every asset
+    bool slowDecode(AssetLoader::Asset & asset)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds((asset.id * 7919) % 500));
+        asset.decoded = std::make_shared<std::string>(asset.bytes.begin(), asset.bytes.end());
+        return asset.path.find("corrupt") == std::string::npos;
+    }
+
+    // the GPU side of a fake, what was uploaded in what order and on which thread
+    struct FakeUploader
+    {
+        std::vector<int> ids;
+        std::vector<std::string> contents;
+        std::vector<std::thread::id> threads;
+
+        AssetLoader::Uploader get()
+        {
+            return [this](AssetLoader::Asset & asset)
+            {
+                ids.push_back(asset.id);
+                contents.push_back(*std::static_pointer_cast<std::string>(asset.decoded));
+                threads.push_back(std::this_thread::get_id());
+                return asset.path.find("toobig") == std::string::npos;
+            };
+        }
+    };
+
+    // keeps a worker busy until it is let go
+    struct Gate
+    {
+        std::mutex mutex;
+        std::condition_variable signal;
+        bool open = false;
+        std::atomic<bool> entered{ false };
+
+        AssetLoader::Decoder get()
+        {
+            return [this](AssetLoader::Asset &)
+            {
+                entered = true;
+                std::unique_lock<std::mutex> lock(mutex);
+                signal.wait(lock, [this]() { return open; });
+                return true;
+            };
+        }
+
+        void release()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                open = true;
+            }
+            signal.notify_all();
+        }
+    };
+}
+
+TEST(OrderedTypesUploadInRequestOrder)
+{
+    AssetLoader loader(4);
+    FakeUploader uploader;
+    loader.setReader(fakeRead);
+    loader.setType(ASSET_MODEL, slowDecode, uploader.get(), true);
+
+    for (int i = 0; i < 64; i++)
+        loader.load(ASSET_MODEL, "model" + std::to_string(i), AssetLoader::PRIORITY_NORMAL, i);
+    loader.finish();
+
+    REQUIRE(uploader.ids.size() == 64);
+    for (int i = 0; i < 64; i++)
+    {
+        CHECK(uploader.ids[i] == i);
+        CHECK(uploader.contents[i] == "model" + std::to_string(i));
+    }
+    CHECK(loader.getFinishedCount() == 64);
+}
+
+TEST(HighestPriorityIsDecodedFirst)
+{
+    AssetLoader loader(1);
+    Gate gate;
+    std::vector<int> decoded;
+    loader.setReader(fakeRead);
+    loader.setType(ASSET_MODEL, gate.get(), nullptr);
+    loader.setType(ASSET_TEXTURE, [&decoded](AssetLoader::Asset & asset) { decoded.push_back(asset.id); return true; }, nullptr);
+
+    // the only worker is stuck on the first one while the rest are queued
+    loader.load(ASSET_MODEL, "blocker");
+    while (!gate.entered)
+        std::this_thread::yield();
+
+    loader.load(ASSET_TEXTURE, "low", AssetLoader::PRIORITY_LOW, 0);
+    loader.load(ASSET_TEXTURE, "normal", AssetLoader::PRIORITY_NORMAL, 1);
+    loader.load(ASSET_TEXTURE, "high", AssetLoader::PRIORITY_HIGH, 2);
+    loader.load(ASSET_TEXTURE, "normal again", AssetLoader::PRIORITY_NORMAL, 3);
+    gate.release();
+    loader.finish();
+
+    REQUIRE(decoded.size() == 4);
+    CHECK(decoded[0] == 2);
+    CHECK(decoded[1] == 1);
+    CHECK(decoded[2] == 3);
+    CHECK(decoded[3] == 0);
+}
+
+TEST(FailuresAreFinishedToo)
+{
+    AssetLoader loader(2);
+    FakeUploader uploader;
+    std::vector<std::pair<uint32_t, uint32_t>> progress;
+    loader.setReader(fakeRead);
+    loader.setType(ASSET_TEXTURE, slowDecode, uploader.get());
+    loader.setProgressCallback([&progress](uint32_t finished, uint32_t total) { progress.push_back({ finished, total }); });
+
+    AssetLoader::Handle good = loader.load(ASSET_TEXTURE, "good", AssetLoader::PRIORITY_NORMAL, 0);
+    AssetLoader::Handle missing = loader.load(ASSET_TEXTURE, "missing", AssetLoader::PRIORITY_NORMAL, 1);
+    AssetLoader::Handle corrupt = loader.load(ASSET_TEXTURE, "corrupt", AssetLoader::PRIORITY_NORMAL, 2);
+    AssetLoader::Handle tooBig = loader.load(ASSET_TEXTURE, "toobig", AssetLoader::PRIORITY_NORMAL, 3);
+    loader.finish();
+
+    CHECK(loader.isReady(good));
+    CHECK(loader.getState(missing) == AssetLoader::STATE_FAILED);
+    CHECK(loader.getState(corrupt) == AssetLoader::STATE_FAILED);
+    CHECK(loader.getState(tooBig) == AssetLoader::STATE_FAILED);
+
+    // only what decoded gets to the uploader
+    CHECK(uploader.ids.size() == 2);
+
+    REQUIRE(progress.size() == 4);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        CHECK(progress[i].first == i + 1);
+        CHECK(progress[i].second == 4);
+    }
+
+    CHECK(loader.load(NR_OF_ASSET_TYPES + 5, "unknown") == AssetLoader::INVALID_HANDLE);
+    CHECK(loader.getState(AssetLoader::INVALID_HANDLE) == AssetLoader::STATE_FAILED);
+}
+
+TEST(UploadsOnlyOnTheUpdateThread)
+{
+    AssetLoader loader(4);
+    FakeUploader uploader;
+    loader.setReader(fakeRead);
+    loader.setType(ASSET_TEXTURE, slowDecode, uploader.get());
+
+    std::vector<AssetLoader::Handle> handles;
+    for (int i = 0; i < 32; i++)
+        handles.push_back(loader.load(ASSET_TEXTURE, "texture" + std::to_string(i), AssetLoader::PRIORITY_NORMAL, i));
+
+    // a few a frame like the renderer does
+    int frames = 0;
+    while (loader.getFinishedCount() < 32)
+    {
+        CHECK(loader.update(4) <= 4);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        frames++;
+    }
+
+    CHECK(frames >= 8);
+    for (std::thread::id thread : uploader.threads)
+        CHECK(thread == std::this_thread::get_id());
+    for (AssetLoader::Handle handle : handles)
+        CHECK(loader.isReady(handle));
+}
+
+TEST(UploadersCanLoadMore)
+{
+    // a model asking for its textures when it is uploaded
+    AssetLoader loader(2);
+    FakeUploader textures;
+    loader.setReader(fakeRead);
+    loader.setType(ASSET_TEXTURE, slowDecode, textures.get());
+    loader.setType(ASSET_MODEL, slowDecode, [&loader](AssetLoader::Asset & asset)
+    {
+        for (int i = 0; i < 3; i++)
+            loader.load(ASSET_TEXTURE, asset.path + "_texture" + std::to_string(i), AssetLoader::PRIORITY_NORMAL, asset.id * 10 + i);
+        return true;
+    }, true);
+
+    for (int i = 0; i < 5; i++)
+        loader.load(ASSET_MODEL, "model" + std::to_string(i), AssetLoader::PRIORITY_HIGH, i);
+    loader.finish();
+
+    CHECK(loader.getRequestedCount() == 20);
+    CHECK(loader.getFinishedCount() == 20);
+    CHECK(textures.ids.size() == 15);
+}
+
+TEST(DestroyingDropsTheQueue)
+{
+    std::atomic<int> decoded(0);
+    {
+        AssetLoader loader(1);
+        loader.setReader(fakeRead);
+        loader.setType(ASSET_TEXTURE, [&decoded](AssetLoader::Asset &)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            decoded++;
+            return true;
+        }, nullptr);
+
+        for (int i = 0; i < 1000; i++)
+            loader.load(ASSET_TEXTURE, "texture");
+    }
+
+    // the worker finished the one it was on and nothing more
+    CHECK(decoded < 1000);
+}
@@ -0,0 +1,160 @@
+#include <Test.h>
+#include <Lights/ClusteredLightGrid.h>
+#include <Device/NullRenderDevice.h>
+#include <string.h>
+
+using namespace Graphics;
+using namespace DirectX::SimpleMath;
+
+/*
+    The cluster frustums at the size of the back buffer. A small light in
+    the middle of every tile, at a few depths, has to end up in that tile's
+    cluster whatever the resolution and aspect ratio.
+*/
+
+namespace
+{
+    const float DRAW_DISTANCE = 250.f;
+
+    struct Size
+    {
+        UINT width, height, tileSize;
+    };
+
+    const Size SIZES[] = {
+        { 1280, 720, 64 },      // 16:9, the game
+        { 1920, 1080, 64 },
+        { 2560, 1080, 64 },     // 21:9
+        { 1024, 768, 32 },      // 4:3
+        { 720, 1280, 64 },      // portrait
+        { 333, 201, 48 },       // tiles hanging over the edges
+    };
+
+    // view space point in the middle of a tile, the camera looks down -z from the origin
+    Vector3 tileCenter(Camera const & camera, Size const & size, UINT x, UINT y, float depth)
+    {
+        float pixelX = std::min((x + 0.5f) * size.tileSize, size.width - 0.5f);
+        float pixelY = std::min((y + 0.5f) * size.tileSize, size.height - 0.5f);
+        float ndcX = pixelX / size.width * 2.f - 1.f;
+        float ndcY = 1.f - pixelY / size.height * 2.f;
+
+        Matrix proj = camera.getProj();
+        return Vector3(ndcX * depth / proj._11, ndcY * depth / proj._22, -depth);
+    }
+
+    bool hasLight(LightClusters const & clusters, uint32_t cluster, uint32_t light)
+    {
+        LightClusters::Range const & range = clusters.getGrid()[cluster];
+        for (uint32_t i = range.offset; i < range.offset + range.count; i++)
+            if (clusters.getIndexList()[i] == light)
+                return true;
+        return false;
+    }
+}
+
+TEST(ClustersCoverTheBackBuffer)
+{
+    for (Size const & size : SIZES)
+    {
+        NullRenderDevice device;
+        Camera camera(&device, size.width, size.height, DRAW_DISTANCE);
+        camera.update(Vector3(0.f, 0.f, 0.f), Vector3(0.f, 0.f, -1.f), &device);
+
+        ClusteredLightGrid grid(&device);
+        grid.resize(size.width, size.height, size.tileSize);
+        std::vector<Light> lights;
+        grid.update(&device, &camera, lights);
+
+        LightClusters::Params params;
+        const std::vector<char> * uploaded = device.getUploaded(grid.getParamsBuffer());
+        REQUIRE(uploaded && uploaded->size() >= sizeof(params));
+        memcpy(&params, uploaded->data(), sizeof(params));
+
+        CHECK(params.tilesX == (size.width + size.tileSize - 1) / size.tileSize);
+        CHECK(params.tilesY == (size.height + size.tileSize - 1) / size.tileSize);
+        CHECK(params.tileSize == size.tileSize);
+        CHECK(params.slices == CLUSTER_SLICES);
+        CHECK_NEAR(params.farZ, DRAW_DISTANCE, 0.1f);
+        CHECK(grid.getClusters().getClusterCount() == params.tilesX * params.tilesY * CLUSTER_SLICES);
+    }
+}
+
+TEST(TileCentersLandInTheirClusters)
+{
+    const float depths[] = { 0.5f, 3.f, 12.f, 60.f, 200.f };
+
+    for (Size const & size : SIZES)
+    {
+        NullRenderDevice device;
+        Camera camera(&device, size.width, size.height, DRAW_DISTANCE);
+        camera.update(Vector3(0.f, 0.f, 0.f), Vector3(0.f, 0.f, -1.f), &device);
+
+        ClusteredLightGrid grid(&device);
+        grid.resize(size.width, size.height, size.tileSize);
+
+        UINT tilesX = (size.width + size.tileSize - 1) / size.tileSize;
+        UINT tilesY = (size.height + size.tileSize - 1) / size.tileSize;
+
+        std::vector<Light> lights;
+        std::vector<uint32_t> expected;
+        for (float depth : depths)
+        {
+            for (UINT y = 0; y < tilesY; y++)
+            {
+                for (UINT x = 0; x < tilesX; x++)
+                {
+                    Light light = {};
+                    light.positionWS = tileCenter(camera, size, x, y, depth);
+                    light.range = depth * 0.001f;
+                    lights.push_back(light);
+                    expected.push_back(x + y * tilesX);
+                }
+            }
+        }
+
+        // one update per depth, all of them together are more than MAX_LIGHTS
+        LightClusters const & clusters = grid.getClusters();
+        UINT perDepth = tilesX * tilesY;
+        int missing = 0;
+        for (size_t first = 0; first < lights.size(); first += perDepth)
+        {
+            std::vector<Light> batch(lights.begin() + first, lights.begin() + first + perDepth);
+            grid.update(&device, &camera, batch);
+
+            float depth = -batch[0].positionWS.z;
+            int slice = clusters.getSlice(depth);
+            REQUIRE(slice >= 0);
+            for (UINT i = 0; i < perDepth; i++)
+                missing += !hasLight(clusters, expected[first + i] + slice * perDepth, i);
+
+            // small lights don't spill into many neighbours
+            CHECK(clusters.getIndexList().size() <= perDepth * 8);
+        }
+        CHECK(missing == 0);
+    }
+}
+
+TEST(ResizeRebuildsTheGrid)
+{
+    NullRenderDevice device;
+    Camera camera(&device, 1280, 720, DRAW_DISTANCE);
+    ClusteredLightGrid grid(&device);
+    std::vector<Light> lights(1);
+    lights[0].positionWS = Vector3(0.f, 0.f, -10.f);
+    lights[0].range = 1.f;
+
+    grid.resize(1280, 720, 64);
+    grid.update(&device, &camera, lights);
+    CHECK(grid.getClusters().getClusterCount() == 20 * 12 * CLUSTER_SLICES);
+
+    grid.resize(1920, 1080, 32);
+    CHECK(grid.getWidth() == 1920);
+    CHECK(grid.getHeight() == 1080);
+    CHECK(grid.getTileSize() == 32);
+
+    // the projection is the same but the new clusters still need their bounds
+    grid.update(&device, &camera, lights);
+    CHECK(grid.getClusters().getClusterCount() == 60 * 34 * CLUSTER_SLICES);
+    CHECK(grid.getClusters().getIndexList().size() > 0);
+    CHECK(grid.getGridSRV() != nullptr);
+}
@@ -0,0 +1,138 @@
+#include <Test.h>
+#include <Graphics/include/Resources/FileWatcher.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace Graphics;
+namespace fs = std::filesystem;
+
+namespace
+{
+    // a folder of its own for every test, removed after
+    struct Folder
+    {
+        std::string path;
+
+        Folder(std::string const & name)
+        {
+            path = (fs::temp_directory_path() / ("FileWatcherTests-" + name)).generic_string();
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+
+        ~Folder()
+        {
+            std::error_code error;
+            fs::remove_all(path, error);
+        }
+    };
+
+    void writeFile(std::string const & path, std::string const & text)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << text;
+    }
+
+    // polls until something shows up or a second went by
+    std::vector<std::string> pollChanges(FileWatcher & watcher)
+    {
+        std::vector<std::string> changed;
+        for (int i = 0; i < 100 && changed.empty(); i++)
+        {
+            watcher.poll(changed);
+            if (changed.empty())
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        // and whatever came right after
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        watcher.poll(changed);
+        return changed;
+    }
+}
+
+TEST(WrittenFilesAreReportedOnce)
+{
+    Folder folder("written");
+    FileWatcher watcher;
+    REQUIRE(watcher.watch(folder.path));
+    CHECK(watcher.isWatching());
+
+    std::vector<std::string> changed;
+    watcher.poll(changed);
+    CHECK(changed.empty());
+
+    // an editor saving in a few writes
+    for (int i = 0; i < 3; i++)
+        writeFile(folder.path + "/Cards.lw", "version " + std::to_string(i));
+    writeFile(folder.path + "/Effects.lw", "effects");
+
+    changed = pollChanges(watcher);
+    std::sort(changed.begin(), changed.end());
+    REQUIRE(changed.size() == 2);
+    CHECK(changed[0] == folder.path + "/Cards.lw");
+    CHECK(changed[1] == folder.path + "/Effects.lw");
+
+    // nothing new, nothing reported
+    changed.clear();
+    watcher.poll(changed);
+    CHECK(changed.empty());
+}
+
+TEST(RenamedIntoPlaceIsReported)
+{
+    Folder folder("renamed");
+    writeFile(folder.path + "/Cards.lw.tmp", "saved next to it first");
+
+    FileWatcher watcher;
+    REQUIRE(watcher.watch(folder.path + "/"));
+    fs::rename(folder.path + "/Cards.lw.tmp", folder.path + "/Cards.lw");
+
+    std::vector<std::string> changed = pollChanges(watcher);
+    REQUIRE(changed.size() == 1);
+    CHECK(changed[0] == folder.path + "/Cards.lw");
+}
+
+TEST(NewFoldersAreWatchedToo)
+{
+    Folder folder("folders");
+    fs::create_directories(folder.path + "/Shaders");
+
+    FileWatcher watcher;
+    REQUIRE(watcher.watch(folder.path));
+
+    // in a folder that was there, and in one made after the watch with a file written right away
+    writeFile(folder.path + "/Shaders/Forward.hlsl", "float4 PS() : SV_Target { return 1; }");
+    fs::create_directories(folder.path + "/Shaders/Common");
+    writeFile(folder.path + "/Shaders/Common/Light.hlsl", "struct Light { };");
+
+    std::vector<std::string> changed = pollChanges(watcher);
+    CHECK(std::count(changed.begin(), changed.end(), folder.path + "/Shaders/Forward.hlsl") == 1);
+    CHECK(std::count(changed.begin(), changed.end(), folder.path + "/Shaders/Common/Light.hlsl") == 1);
+
+    // and later writes in the new folder
+    writeFile(folder.path + "/Shaders/Common/Light.hlsl", "struct Light { float3 color; };");
+    changed = pollChanges(watcher);
+    REQUIRE(changed.size() == 1);
+    CHECK(changed[0] == folder.path + "/Shaders/Common/Light.hlsl");
+}
+
+TEST(UnwatchedFoldersAreQuiet)
+{
+    Folder folder("unwatched");
+    FileWatcher watcher;
+    CHECK(!watcher.watch(folder.path + "/missing"));
+
+    REQUIRE(watcher.watch(folder.path));
+    watcher.unwatchAll();
+    CHECK(!watcher.isWatching());
+
+    writeFile(folder.path + "/Cards.lw", "cards");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::vector<std::string> changed;
+    watcher.poll(changed);
+    CHECK(changed.empty());
+}
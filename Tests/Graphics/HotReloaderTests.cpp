@@ -0,0 +1,176 @@
+#include <Test.h>
+#include <Graphics/include/Resources/HotReloader.h>
+#include <Engine/Constants.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace Graphics;
+namespace fs = std::filesystem;
+
+namespace
+{
+    void sleep(int milliseconds)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    }
+}
+
+TEST(ReloadsOnlyOnceSettled)
+{
+    HotReloader reloader;
+    reloader.setSettleTime(50);
+    std::vector<std::string> reloaded;
+    reloader.subscribe("Resources/Data/Cards.lw", [&reloaded](std::string const & path) { reloaded.push_back(path); });
+
+    reloader.queue("Resources/Data/Cards.lw");
+    CHECK(reloader.update() == 0);
+    CHECK(reloader.getPendingCount() == 1);
+
+    // written again, the wait starts over
+    sleep(30);
+    reloader.queue("Resources/Data/Cards.lw");
+    sleep(30);
+    CHECK(reloader.update() == 0);
+    CHECK(reloaded.empty());
+
+    sleep(40);
+    CHECK(reloader.update() == 1);
+    REQUIRE(reloaded.size() == 1);
+    CHECK(reloaded[0] == "Resources/Data/Cards.lw");
+    CHECK(reloader.getPendingCount() == 0);
+    CHECK(reloader.update() == 0);
+}
+
+TEST(FilesAndFoldersAreMatched)
+{
+    HotReloader reloader;
+    reloader.setSettleTime(0);
+    int cards = 0, shaders = 0;
+    std::string shaderPath;
+    reloader.subscribe("Resources/Data/Cards.lw", [&cards](std::string const &) { cards++; });
+    reloader.subscribe("Resources/Shaders/", [&](std::string const & path) { shaders++; shaderPath = path; });
+
+    // case and slashes don't matter, the callback gets the path as it was reported
+    reloader.queue("resources\\data\\CARDS.lw");
+    reloader.queue("Resources/Shaders/Common/Light.hlsl");
+    reloader.queue("Resources/Textures/wood.jpg");
+    reloader.queue("Resources/Data/Cards.lw.tmp");
+    CHECK(reloader.update() == 2);
+    CHECK(cards == 1);
+    CHECK(shaders == 1);
+    CHECK(shaderPath == "Resources/Shaders/Common/Light.hlsl");
+
+    // both spellings are one change
+    reloader.queue("Resources/Data/Cards.lw");
+    reloader.queue("RESOURCES/DATA/Cards.lw");
+    CHECK(reloader.getPendingCount() == 1);
+    CHECK(reloader.update() == 1);
+    CHECK(cards == 2);
+}
+
+TEST(ShaderCacheStoreWritesDontReload)
+{
+    // how Shader subscribes, the cache store is written into the same folder on every miss
+    HotReloader reloader;
+    reloader.setSettleTime(0);
+    int reloads = 0;
+    reloader.subscribe("Resources/Shaders/", [&reloads](std::string const &) { reloads++; }, { ".hlsl", ".h" });
+
+    reloader.queue(SHADER_CACHE_STORE);
+    reloader.queue(SHADER_CACHE_PACK);
+    CHECK(reloader.update() == 0);
+    CHECK(reloads == 0);
+
+    // the sources and includes still do, in any case
+    reloader.queue("Resources/Shaders/ForwardPlus.hlsl");
+    CHECK(reloader.update() == 1);
+    reloader.queue("Resources/Shaders/Common/LIGHT.H");
+    CHECK(reloader.update() == 1);
+    reloader.queue("Resources/Shaders/ForwardPlus.hlsl.tmp");
+    CHECK(reloader.update() == 0);
+    CHECK(reloads == 2);
+}
+
+TEST(ThrowingCallbacksDontStopTheRest)
+{
+    HotReloader reloader;
+    reloader.setSettleTime(0);
+    int after = 0;
+    reloader.subscribe("Resources/Data/Cards.lw", [](std::string const &) { throw std::runtime_error("missing field cardName"); });
+    reloader.subscribe("Resources/Data/Cards.lw", [](std::string const &) { throw "Effects.lw has a typo"; });
+    reloader.subscribe("Resources/Data/Cards.lw", [&after](std::string const &) { after++; });
+
+    reloader.queue("Resources/Data/Cards.lw");
+    CHECK(reloader.update() == 1);
+    CHECK(after == 1);
+}
+
+TEST(CallbacksCanUnsubscribe)
+{
+    HotReloader reloader;
+    reloader.setSettleTime(0);
+    int first = 0, second = 0, third = 0;
+    HotReloader::Subscription secondSubscription = HotReloader::INVALID_SUBSCRIPTION, firstSubscription;
+
+    // the first one removes itself and the one after it
+    firstSubscription = reloader.subscribe("Resources/Data/Cards.lw", [&](std::string const &)
+    {
+        first++;
+        reloader.unsubscribe(firstSubscription);
+        reloader.unsubscribe(secondSubscription);
+    });
+    secondSubscription = reloader.subscribe("Resources/Data/Cards.lw", [&second](std::string const &) { second++; });
+    HotReloader::Subscription thirdSubscription = reloader.subscribe("Resources/Data/Cards.lw", [&third](std::string const &) { third++; });
+    CHECK(firstSubscription != HotReloader::INVALID_SUBSCRIPTION);
+    CHECK(secondSubscription != firstSubscription);
+
+    reloader.queue("Resources/Data/Cards.lw");
+    CHECK(reloader.update() == 2);
+    reloader.queue("Resources/Data/Cards.lw");
+    CHECK(reloader.update() == 1);
+    CHECK(first == 1);
+    CHECK(second == 0);
+    CHECK(third == 2);
+
+    reloader.unsubscribe(thirdSubscription);
+    reloader.queue("Resources/Data/Cards.lw");
+    CHECK(reloader.update() == 0);
+}
+
+TEST(SavedFilesAreReloaded)
+{
+    // the whole way, from a write on disk to the callback
+    std::string folder = (fs::temp_directory_path() / "HotReloaderTests").generic_string();
+    fs::remove_all(folder);
+    fs::create_directories(folder + "/Data");
+
+    HotReloader reloader;
+    reloader.setSettleTime(20);
+    REQUIRE(reloader.watch(folder));
+    std::string text;
+    reloader.subscribe(folder + "/Data/Cards.lw", [&text](std::string const & path)
+    {
+        std::ifstream file(path);
+        std::getline(file, text);
+    });
+
+    {
+        std::ofstream file(folder + "/Data/Cards.lw");
+        file << "\"cardName\" : \"Healthpack\";\n";
+    }
+
+    uint32_t reloaded = 0;
+    for (int i = 0; i < 100 && reloaded == 0; i++)
+    {
+        reloaded = reloader.update();
+        sleep(10);
+    }
+    CHECK(reloaded == 1);
+    CHECK(text == "\"cardName\" : \"Healthpack\";");
+
+    reloader.unwatchAll();
+    fs::remove_all(folder);
+}
@@ -0,0 +1,283 @@
+#include <Test.h>
+#include <Resources/IndexOptimizer.h>
+#include <Resources/MeshLod.h>
+#include <Resources/BRFImportHandler.h>
+#include <Engine/Constants.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Graphics;
+
+/*
+    Every model is decoded like the game does, BRFImportHandler::decodeFile
+    builds the LODs, the cache order and the overdraw order of each, then
+    the fetch order over all of them. The triangles have to come out the
+    same with the same winding as in the file, and the cache has to do
+    better than the order the exporter wrote.
+*/
+
+namespace
+{
+    struct Random
+    {
+        uint32_t state;
+        uint32_t next() { state = state * 1664525u + 1013904223u; return state >> 8; }
+    };
+
+    // rotated so the smallest index is first, that keeps the winding
+    std::vector<unsigned int> sortedTriangles(unsigned int const * indices, size_t indexCount, unsigned int const * remap = nullptr)
+    {
+        std::vector<unsigned int> triangles;
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            unsigned int t[3];
+            for (int k = 0; k < 3; k++)
+                t[k] = remap ? remap[indices[i + k]] : indices[i + k];
+            int first = t[0] < t[1] ? (t[0] < t[2] ? 0 : 2) : (t[1] < t[2] ? 1 : 2);
+            triangles.push_back(t[first]);
+            triangles.push_back(t[(first + 1) % 3]);
+            triangles.push_back(t[(first + 2) % 3]);
+        }
+
+        std::vector<size_t> order(triangles.size() / 3);
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return std::lexicographical_compare(&triangles[a * 3], &triangles[a * 3 + 3], &triangles[b * 3], &triangles[b * 3 + 3]);
+        });
+
+        std::vector<unsigned int> sorted;
+        for (size_t i : order)
+            sorted.insert(sorted.end(), &triangles[i * 3], &triangles[i * 3 + 3]);
+        return sorted;
+    }
+
+    // size * size quads, two triangles each
+    std::vector<unsigned int> makeGrid(unsigned int size)
+    {
+        std::vector<unsigned int> indices;
+        for (unsigned int y = 0; y < size; y++)
+        {
+            for (unsigned int x = 0; x < size; x++)
+            {
+                unsigned int corner = y * (size + 1) + x;
+                unsigned int quad[6] = { corner, corner + size + 1, corner + 1, corner + 1, corner + size + 1, corner + size + 2 };
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+        return indices;
+    }
+
+    void shuffleTriangles(std::vector<unsigned int> & indices, Random & random)
+    {
+        for (size_t i = indices.size() / 3; i > 1; i--)
+        {
+            size_t j = random.next() % i;
+            for (int k = 0; k < 3; k++)
+                std::swap(indices[(i - 1) * 3 + k], indices[j * 3 + k]);
+        }
+    }
+
+    struct ModelLimits
+    {
+        const char * name;
+        float acmr;         // of the full mesh after MeshManager's ordering, a bit over what it measures today.
+                            // The boxes and the flat ones have no vertices to share between their faces
+    };
+
+    const ModelLimits MODELS[] = {
+        { "CrossBow.brf", 1.41f },
+        { "ammoBox.brf", 2.16f },
+        { "bushgreen.brf", 1.96f },
+        { "cuttlery.brf", 1.42f },
+        { "enemyGrunt.brf", 0.80f },
+        { "grapplePoint.brf", 0.70f },
+        { "grass.brf", 1.68f },
+        { "jumpPad.brf", 2.01f },
+        { "kub.brf", 2.34f },
+        { "kub2.brf", 2.01f },
+        { "kubenmedtextur.brf", 2.34f },
+        { "kubfixadtextur.brf", 2.01f },
+        { "sphere.brf", 0.71f },
+    };
+}
+
+TEST(analyzeCountsCacheMisses)
+{
+    unsigned int triangle[3] = { 0, 1, 2 };
+    VertexCacheStats stats = analyzeVertexCache(triangle, 3, 3, INDEX_CACHE_SIZE);
+    CHECK_NEAR(stats.acmr, 3.f, 1e-6f);
+    CHECK_NEAR(stats.atvr, 1.f, 1e-6f);
+
+    // the second triangle of the quad only adds one vertex
+    unsigned int quad[6] = { 0, 1, 2, 2, 1, 3 };
+    stats = analyzeVertexCache(quad, 6, 4, INDEX_CACHE_SIZE);
+    CHECK_NEAR(stats.acmr, 2.f, 1e-6f);
+    CHECK_NEAR(stats.atvr, 1.f, 1e-6f);
+
+    // a cache of 3 has pushed 0 out by the time it is used again
+    unsigned int fan[9] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    stats = analyzeVertexCache(fan, 9, 6, 3);
+    CHECK_NEAR(stats.acmr, 3.f, 1e-6f);
+    CHECK_NEAR(stats.atvr, 1.5f, 1e-6f);
+}
+
+TEST(shuffledGridGetsItsLocalityBack)
+{
+    Random random = { 3 };
+    std::vector<unsigned int> indices = makeGrid(64);
+    shuffleTriangles(indices, random);
+    size_t vertexCount = 65 * 65;
+
+    VertexCacheStats before = analyzeVertexCache(indices.data(), indices.size(), vertexCount, INDEX_CACHE_SIZE);
+    std::vector<unsigned int> original = sortedTriangles(indices.data(), indices.size());
+
+    optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+    VertexCacheStats after = analyzeVertexCache(indices.data(), indices.size(), vertexCount, INDEX_CACHE_SIZE);
+    printf("    shuffled 64x64 grid: acmr %.3f -> %.3f, atvr %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+
+    CHECK(before.acmr > 2.5f);
+    // a grid can't do better than 0.5, Forsyth gets close to 0.7 with 16 entries
+    CHECK(after.acmr < 0.8f);
+    CHECK(after.atvr < 1.45f);
+    CHECK(sortedTriangles(indices.data(), indices.size()) == original);
+}
+
+TEST(overdrawOrderKeepsTheCacheWithinThreshold)
+{
+    // a closed box of grids, so there is an outside to draw first
+    std::vector<float> positions;
+    std::vector<unsigned int> indices;
+    const unsigned int size = 16;
+    for (int face = 0; face < 6; face++)
+    {
+        unsigned int first = (unsigned int)positions.size() / 3;
+        int axis = face / 2;
+        float side = face % 2 ? 1.f : -1.f;
+        for (unsigned int y = 0; y <= size; y++)
+        {
+            for (unsigned int x = 0; x <= size; x++)
+            {
+                float p[3];
+                p[axis] = side;
+                p[(axis + 1) % 3] = x / float(size) * 2.f - 1.f;
+                p[(axis + 2) % 3] = y / float(size) * 2.f - 1.f;
+                positions.insert(positions.end(), p, p + 3);
+            }
+        }
+        std::vector<unsigned int> grid = makeGrid(size);
+        for (unsigned int & index : grid)
+            index += first;
+        indices.insert(indices.end(), grid.begin(), grid.end());
+    }
+    size_t vertexCount = positions.size() / 3;
+
+    Random random = { 11 };
+    shuffleTriangles(indices, random);
+    std::vector<unsigned int> original = sortedTriangles(indices.data(), indices.size());
+
+    optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+    VertexCacheStats cached = analyzeVertexCache(indices.data(), indices.size(), vertexCount, INDEX_CACHE_SIZE);
+    optimizeOverdraw(indices.data(), indices.size(), positions.data(), vertexCount, sizeof(float) * 3, INDEX_OVERDRAW_THRESHOLD);
+    VertexCacheStats overdraw = analyzeVertexCache(indices.data(), indices.size(), vertexCount, INDEX_CACHE_SIZE);
+    printf("    box: acmr %.3f after the cache order, %.3f after the overdraw order\n", cached.acmr, overdraw.acmr);
+
+    CHECK(overdraw.acmr <= cached.acmr * INDEX_OVERDRAW_THRESHOLD + 1e-4f);
+    CHECK(sortedTriangles(indices.data(), indices.size()) == original);
+}
+
+TEST(fetchOrderIsFirstUse)
+{
+    unsigned int indices[9] = { 5, 2, 7, 7, 2, 0, 1, 5, 7 };
+    std::vector<unsigned int> remap;
+    optimizeVertexFetch(indices, 9, 9, remap);
+
+    unsigned int expected[9] = { 0, 1, 2, 2, 1, 3, 4, 0, 2 };
+    for (int i = 0; i < 9; i++)
+        CHECK(indices[i] == expected[i]);
+
+    // a permutation, the unused 3, 4, 6 and 8 after the used ones
+    REQUIRE(remap.size() == 9);
+    std::vector<unsigned int> targets(remap);
+    std::sort(targets.begin(), targets.end());
+    for (unsigned int i = 0; i < 9; i++)
+        CHECK(targets[i] == i);
+    CHECK(remap[5] == 0 && remap[2] == 1 && remap[7] == 2 && remap[0] == 3 && remap[1] == 4);
+    CHECK(remap[3] >= 5 && remap[4] >= 5 && remap[6] >= 5 && remap[8] >= 5);
+}
+
+namespace
+{
+    // the first vertex in the file with the same value, the optimized meshes have the vertices in another order
+    std::vector<unsigned int> firstEqualVertex(std::vector<Vertex> const & file, std::vector<Vertex> const & vertices)
+    {
+        std::map<std::string, unsigned int> first;
+        for (size_t v = file.size(); v-- > 0;)
+            first[std::string((char const *)&file[v], sizeof(Vertex))] = (unsigned int)v;
+
+        std::vector<unsigned int> remap(vertices.size());
+        for (size_t v = 0; v < vertices.size(); v++)
+            remap[v] = first.at(std::string((char const *)&vertices[v], sizeof(Vertex)));
+        return remap;
+    }
+}
+
+TEST(everyModelKeepsItsTrianglesAndGetsBetter)
+{
+    for (ModelLimits const & limits : MODELS)
+    {
+        std::string path = std::string(MODEL_PATH_STR("")) + limits.name;
+        BRFImportHandler::Model exported, model;
+        REQUIRE(BRFImportHandler::decodeFile(path, true, false, false, exported, false));
+        REQUIRE(BRFImportHandler::decodeFile(path, true, false, false, model));
+        REQUIRE(exported.meshes.size() == model.meshes.size());
+
+        for (size_t m = 0; m < model.meshes.size(); m++)
+        {
+            auto const & file = exported.meshes[m];
+            auto const & mesh = model.meshes[m];
+            size_t vertexCount = file.vertices.size();
+            REQUIRE(mesh.vertices.size() == vertexCount);
+            CHECK(file.lodCount == 1 && file.lods[0].indexCount == file.indices.size());
+            VertexCacheStats before = analyzeVertexCache(file.indices.data(), file.indices.size(), vertexCount, INDEX_CACHE_SIZE);
+
+            // the LODs of the file before they are ordered, and what the cache order alone gets
+            std::vector<unsigned int> allIndices;
+            MeshLod lods[MESH_LOD_COUNT];
+            int lodCount = buildMeshLods(&file.vertices[0].position, vertexCount, sizeof(Vertex), file.indices, allIndices, lods);
+            REQUIRE(mesh.lodCount == lodCount);
+            REQUIRE(mesh.indices.size() == allIndices.size());
+
+            std::vector<unsigned int> fileVertex = firstEqualVertex(file.vertices, file.vertices);
+            std::vector<unsigned int> meshVertex = firstEqualVertex(file.vertices, mesh.vertices);
+            for (int i = 0; i < lodCount; i++)
+            {
+                CHECK(mesh.lods[i].startIndex == lods[i].startIndex);
+                CHECK(mesh.lods[i].indexCount == lods[i].indexCount);
+
+                unsigned int * lodIndices = &allIndices[lods[i].startIndex];
+                std::vector<unsigned int> lodTriangles = sortedTriangles(lodIndices, lods[i].indexCount, fileVertex.data());
+                optimizeVertexCache(lodIndices, lods[i].indexCount, vertexCount);
+                float cachedAcmr = analyzeVertexCache(lodIndices, lods[i].indexCount, vertexCount, INDEX_CACHE_SIZE).acmr;
+
+                unsigned int const * meshIndices = &mesh.indices[mesh.lods[i].startIndex];
+                VertexCacheStats stats = analyzeVertexCache(meshIndices, mesh.lods[i].indexCount, vertexCount, INDEX_CACHE_SIZE);
+                if (i == 0)
+                {
+                    printf("    %-20s acmr %.3f -> %.3f (limit %.2f), atvr %.3f -> %.3f\n", limits.name, before.acmr, stats.acmr, limits.acmr,
+                        before.atvr, stats.atvr);
+                    CHECK(stats.acmr <= before.acmr + 1e-4f);
+                    CHECK(stats.atvr <= before.atvr + 1e-4f);
+                    CHECK(stats.acmr <= limits.acmr);
+                }
+                CHECK(stats.acmr <= cachedAcmr * INDEX_OVERDRAW_THRESHOLD + 1e-4f);
+                CHECK(stats.atvr >= 1.f);
+
+                // back in the vertices of the file, the same triangles as the LOD
+                CHECK(sortedTriangles(meshIndices, mesh.lods[i].indexCount, meshVertex.data()) == lodTriangles);
+            }
+        }
+    }
+}
@@ -0,0 +1,218 @@
+#include <Test.h>
+#include <Lights/LightClusters.h>
+#include "Projection.h"
+#include <algorithm>
+#include <set>
+
+using namespace Graphics;
+
+namespace
+{
+    const float NEAR_Z = 0.1f, FAR_Z = 250.f;
+
+    struct Random
+    {
+        unsigned int state;
+
+        float next(float min, float max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return min + (max - min) * ((state >> 8) / float(1 << 24));
+        }
+    };
+
+    struct Setup
+    {
+        uint32_t width, height;
+        float proj[16], view[16];
+        LightClusters clusters;
+
+        Setup(uint32_t width, uint32_t height, uint32_t tileSize, uint32_t slices, float fieldOfView = 1.4f) :
+            width(width), height(height), clusters(width, height, tileSize, slices)
+        {
+            Projection::perspective(fieldOfView, width / (float)height, NEAR_Z, FAR_Z, proj);
+            Projection::identity(view);
+            clusters.setProjection(proj);
+        }
+
+        // -1 outside the view
+        int clusterOf(const float point[3]) const
+        {
+            LightClusters::Params const & params = clusters.getParams();
+            float depth = -point[2];
+            int slice = clusters.getSlice(depth);
+            if (slice < 0)
+                return -1;
+
+            float ndcX = point[0] * proj[0] / depth, ndcY = point[1] * proj[5] / depth;
+            if (ndcX < -1.f || ndcX >= 1.f || ndcY <= -1.f || ndcY > 1.f)
+                return -1;
+
+            uint32_t x = (uint32_t)((ndcX * 0.5f + 0.5f) * width) / params.tileSize;
+            uint32_t y = (uint32_t)((0.5f - ndcY * 0.5f) * height) / params.tileSize;
+            return int(x + (y + slice * params.tilesY) * params.tilesX);
+        }
+
+        bool has(int cluster, uint32_t light) const
+        {
+            LightClusters::Range const & range = clusters.getGrid()[cluster];
+            std::vector<uint32_t> const & list = clusters.getIndexList();
+            return std::find(list.begin() + range.offset, list.begin() + range.offset + range.count, light) != list.begin() + range.offset + range.count;
+        }
+    };
+
+    std::vector<LightClusters::ClusterLight> randomLights(Random & random, size_t count)
+    {
+        std::vector<LightClusters::ClusterLight> lights(count);
+        for (LightClusters::ClusterLight & light : lights)
+            light = { { random.next(-60.f, 60.f), random.next(-20.f, 20.f), random.next(-200.f, 10.f) }, random.next(0.2f, 12.f) };
+        return lights;
+    }
+
+    /*
+        Points inside every light land in clusters that have the light, the
+        assignment may only be too generous.
+    */
+    void checkConservative(Setup & setup, std::vector<LightClusters::ClusterLight> const & lights, Random & random)
+    {
+        setup.clusters.assign(setup.view, lights.data(), lights.size());
+
+        int tested = 0, missing = 0;
+        for (uint32_t i = 0; i < lights.size(); i++)
+        {
+            for (int sample = 0; sample < 200; sample++)
+            {
+                // in the sphere, more of them near the surface
+                float direction[3] = { random.next(-1.f, 1.f), random.next(-1.f, 1.f), random.next(-1.f, 1.f) };
+                float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+                if (length < 1e-3f || length > 1.f)
+                    continue;
+                float distance = lights[i].range * sqrtf(random.next(0.f, 0.999f)) / length;
+                float point[3];
+                for (int axis = 0; axis < 3; axis++)
+                    point[axis] = lights[i].position[axis] + direction[axis] * distance;
+
+                int cluster = setup.clusterOf(point);
+                if (cluster < 0)
+                    continue;
+                tested++;
+                missing += !setup.has(cluster, i);
+            }
+        }
+
+        CHECK(tested > 0);
+        CHECK(missing == 0);
+    }
+}
+
+TEST(RandomLightsReachTheirClusters)
+{
+    Random random = { 17 };
+    Setup setup(1280, 720, 64, 24);
+    for (int round = 0; round < 4; round++)
+        checkConservative(setup, randomLights(random, 128), random);
+}
+
+TEST(OtherResolutionsAndSlices)
+{
+    Random random = { 23 };
+    uint32_t sizes[][4] = { { 1920, 1080, 64, 24 }, { 800, 600, 32, 16 }, { 333, 777, 48, 8 }, { 2560, 1080, 128, 32 } };
+    for (auto const & size : sizes)
+    {
+        Setup setup(size[0], size[1], size[2], size[3], random.next(0.7f, 1.7f));
+        LightClusters::Params const & params = setup.clusters.getParams();
+        CHECK(params.tilesX * params.tileSize >= size[0]);
+        CHECK(params.tilesY * params.tileSize >= size[1]);
+        CHECK(setup.clusters.getClusterCount() == params.tilesX * params.tilesY * params.slices);
+        checkConservative(setup, randomLights(random, 64), random);
+    }
+}
+
+TEST(SlicesAreExponential)
+{
+    Setup setup(1280, 720, 64, 24);
+    LightClusters::Params const & params = setup.clusters.getParams();
+    CHECK_NEAR(params.nearZ, NEAR_Z, 1e-4f);
+    CHECK_NEAR(params.farZ, FAR_Z, 0.05f);
+
+    CHECK(setup.clusters.getSlice(NEAR_Z * 0.5f) == -1);
+    CHECK(setup.clusters.getSlice(FAR_Z * 2.f) == -1);
+    CHECK(setup.clusters.getSlice(params.nearZ) == 0);
+    CHECK(setup.clusters.getSlice(params.farZ) == 23);
+
+    for (int k = 1; k < 24; k++)
+    {
+        float start = params.nearZ * powf(params.farZ / params.nearZ, k / 24.f);
+        CHECK(setup.clusters.getSlice(start * 1.001f) == k);
+        CHECK(setup.clusters.getSlice(start * 0.999f) == k - 1);
+    }
+}
+
+TEST(LightsOutsideTheViewAreSkipped)
+{
+    Setup setup(640, 360, 64, 16);
+    std::vector<LightClusters::ClusterLight> lights = {
+        { { 0.f, 0.f, 20.f }, 5.f },       // behind the camera
+        { { 0.f, 0.f, -400.f }, 10.f },    // past far
+        { { 400.f, 0.f, -10.f }, 10.f },   // far to the side
+        { { 0.f, 0.f, -10.f }, 0.f },      // no range
+    };
+    setup.clusters.assign(setup.view, lights.data(), lights.size());
+    CHECK(setup.clusters.getIndexList().empty());
+}
+
+TEST(ASmallLightStaysInFewClusters)
+{
+    // the point of clustering, a light deep in the view doesn't light the tiles' whole depth
+    Setup setup(1280, 720, 64, 24);
+    std::vector<LightClusters::ClusterLight> lights = { { { 0.f, 0.f, -50.f }, 1.f } };
+    setup.clusters.assign(setup.view, lights.data(), lights.size());
+    CHECK(setup.clusters.getIndexList().size() > 0);
+    CHECK(setup.clusters.getIndexList().size() <= 8);
+}
+
+TEST(GridIsCompactAndInLightOrder)
+{
+    Random random = { 31 };
+    Setup setup(1280, 720, 64, 24);
+    std::vector<LightClusters::ClusterLight> lights = randomLights(random, 500);
+    setup.clusters.assign(setup.view, lights.data(), lights.size());
+
+    uint32_t next = 0;
+    std::vector<uint32_t> const & list = setup.clusters.getIndexList();
+    for (LightClusters::Range const & range : setup.clusters.getGrid())
+    {
+        CHECK(range.offset == next);
+        for (uint32_t i = 1; i < range.count; i++)
+            CHECK(list[range.offset + i - 1] < list[range.offset + i]);
+        next += range.count;
+    }
+    CHECK(next == list.size());
+
+    // assigning again starts over
+    setup.clusters.assign(setup.view, lights.data(), 0);
+    CHECK(setup.clusters.getIndexList().empty());
+}
+
+TEST(ViewMatrixMovesTheLights)
+{
+    // the same light, once in front of the camera and once moved into view by the view matrix
+    Setup setup(640, 360, 64, 16);
+    std::vector<LightClusters::ClusterLight> inFront = { { { 0.f, 0.f, -20.f }, 2.f } };
+    setup.clusters.assign(setup.view, inFront.data(), 1);
+    std::vector<uint32_t> expected = setup.clusters.getIndexList();
+    std::vector<LightClusters::Range> expectedGrid = setup.clusters.getGrid();
+
+    std::vector<LightClusters::ClusterLight> moved = { { { 100.f, 5.f, -20.f }, 2.f } };
+    float view[16];
+    Projection::identity(view);
+    view[12] = -100.f;
+    view[13] = -5.f;
+    setup.clusters.assign(view, moved.data(), 1);
+
+    CHECK(setup.clusters.getIndexList() == expected);
+    bool sameGrid = true;
+    for (size_t i = 0; i < expectedGrid.size(); i++)
+        sameGrid &= expectedGrid[i].count == setup.clusters.getGrid()[i].count;
+    CHECK(sameGrid);
+}
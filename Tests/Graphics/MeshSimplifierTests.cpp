@@ -0,0 +1,293 @@
+#include <Test.h>
+#include <Resources/MeshSimplifier.h>
+#include <Resources/MeshLod.h>
+#include <algorithm>
+#include <math.h>
+
+using namespace Graphics;
+
+/*
+    The simplifier's error is the area weighted distance to the planes of
+    the original triangles. What is checked here is the distance every
+    original vertex ends up from the simplified surface, it has to stay
+    within twice that.
+*/
+
+namespace
+{
+    struct Vertex
+    {
+        float x, y, z;
+        float u, v;     // so the stride isn't just the position
+    };
+
+    struct Grid
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    enum SHAPE { SPHERE, TERRAIN, PLANE };
+
+    Grid makeGrid(SHAPE shape, int size)
+    {
+        Grid grid;
+        for (int i = 0; i <= size; i++)
+        {
+            for (int j = 0; j <= size; j++)
+            {
+                float s = i / float(size), t = j / float(size);
+                Vertex vertex = { 0.f, 0.f, 0.f, s, t };
+                if (shape == SPHERE)
+                {
+                    float theta = float(M_PI) * s, phi = 2.f * float(M_PI) * t;
+                    vertex.x = sinf(theta) * cosf(phi);
+                    vertex.y = cosf(theta);
+                    vertex.z = sinf(theta) * sinf(phi);
+                }
+                else
+                {
+                    vertex.x = s * 10.f;
+                    vertex.z = t * 10.f;
+                    vertex.y = shape == TERRAIN ? 0.3f * sinf(vertex.x) * cosf(vertex.z * 1.3f) : 0.f;
+                }
+                grid.vertices.push_back(vertex);
+            }
+        }
+
+        for (int i = 0; i < size; i++)
+        {
+            for (int j = 0; j < size; j++)
+            {
+                unsigned int a = i * (size + 1) + j, b = a + 1, c = a + size + 1, d = c + 1;
+                unsigned int quad[] = { a, c, b, b, c, d };
+                grid.indices.insert(grid.indices.end(), quad, quad + 6);
+            }
+        }
+        return grid;
+    }
+
+    float distance(const float * a, const float * b)
+    {
+        float x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+        return sqrtf(x * x + y * y + z * z);
+    }
+
+    float distanceToSegment(const float * p, const float * a, const float * b)
+    {
+        float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float t = ((p[0] - a[0]) * ab[0] + (p[1] - a[1]) * ab[1] + (p[2] - a[2]) * ab[2]) /
+            std::max(ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2], 1e-20f);
+        t = std::min(std::max(t, 0.f), 1.f);
+        float closest[3] = { a[0] + ab[0] * t, a[1] + ab[1] * t, a[2] + ab[2] * t };
+        return distance(p, closest);
+    }
+
+    float distanceToTriangle(const float * p, const float * a, const float * b, const float * c)
+    {
+        float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+        float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        if (length > 1e-12f)
+        {
+            for (int i = 0; i < 3; i++)
+                n[i] /= length;
+            float d = (p[0] - a[0]) * n[0] + (p[1] - a[1]) * n[1] + (p[2] - a[2]) * n[2];
+            float q[3] = { p[0] - n[0] * d, p[1] - n[1] * d, p[2] - n[2] * d };
+
+            // inside if q is on the inner side of every edge
+            const float * corners[] = { a, b, c };
+            bool inside = true;
+            for (int i = 0; i < 3 && inside; i++)
+            {
+                const float * u = corners[i], *v = corners[(i + 1) % 3];
+                float edge[3] = { v[0] - u[0], v[1] - u[1], v[2] - u[2] };
+                float w[3] = { q[0] - u[0], q[1] - u[1], q[2] - u[2] };
+                float side = (edge[1] * w[2] - edge[2] * w[1]) * n[0] + (edge[2] * w[0] - edge[0] * w[2]) * n[1] + (edge[0] * w[1] - edge[1] * w[0]) * n[2];
+                inside = side >= 0.f;
+            }
+            if (inside)
+                return fabsf(d);
+        }
+
+        return std::min(distanceToSegment(p, a, b), std::min(distanceToSegment(p, b, c), distanceToSegment(p, c, a)));
+    }
+
+    // the farthest any original vertex is from the simplified surface
+    float measureError(Grid const & grid, std::vector<unsigned int> const & simplified)
+    {
+        float worst = 0.f;
+        for (Vertex const & vertex : grid.vertices)
+        {
+            float closest = INFINITY;
+            for (size_t i = 0; i + 2 < simplified.size(); i += 3)
+            {
+                closest = std::min(closest, distanceToTriangle(&vertex.x,
+                    &grid.vertices[simplified[i]].x, &grid.vertices[simplified[i + 1]].x, &grid.vertices[simplified[i + 2]].x));
+            }
+            worst = std::max(worst, closest);
+        }
+        return worst;
+    }
+
+    void checkIndices(Grid const & grid, std::vector<unsigned int> const & indices)
+    {
+        CHECK(indices.size() % 3 == 0);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            REQUIRE(std::max(indices[i], std::max(indices[i + 1], indices[i + 2])) < grid.vertices.size());
+            CHECK(distance(&grid.vertices[indices[i]].x, &grid.vertices[indices[i + 1]].x) > 0.f);
+            CHECK(distance(&grid.vertices[indices[i + 1]].x, &grid.vertices[indices[i + 2]].x) > 0.f);
+            CHECK(distance(&grid.vertices[indices[i + 2]].x, &grid.vertices[indices[i]].x) > 0.f);
+        }
+    }
+
+    void checkErrorBound(SHAPE shape)
+    {
+        Grid grid = makeGrid(shape, 40);
+        MeshSimplifier simplifier(grid.vertices.data(), grid.vertices.size(), sizeof(Vertex), grid.indices);
+        float maxError = simplifier.getExtent() * MESH_LOD_MAX_ERROR;
+
+        size_t target = grid.indices.size();
+        float lastError = 0.f;
+        for (int level = 1; level < MESH_LOD_COUNT + 1; level++)
+        {
+            target = target / 2 / 3 * 3;
+            std::vector<unsigned int> simplified = simplifier.simplify(target, maxError);
+            checkIndices(grid, simplified);
+
+            CHECK(simplifier.getError() <= maxError);
+            CHECK(simplifier.getError() >= lastError);
+            CHECK(measureError(grid, simplified) <= 2.f * simplifier.getError() + 1e-5f);
+            lastError = simplifier.getError();
+        }
+    }
+}
+
+TEST(SphereStaysWithinTheError)
+{
+    checkErrorBound(SPHERE);
+}
+
+TEST(TerrainStaysWithinTheError)
+{
+    checkErrorBound(TERRAIN);
+}
+
+TEST(ReachesTheTargetWhenTheErrorAllows)
+{
+    Grid grid = makeGrid(SPHERE, 40);
+    MeshSimplifier simplifier(grid.vertices.data(), grid.vertices.size(), sizeof(Vertex), grid.indices);
+
+    size_t target = grid.indices.size();
+    for (int level = 0; level < 3; level++)
+    {
+        target = target / 2 / 3 * 3;
+        std::vector<unsigned int> simplified = simplifier.simplify(target, INFINITY);
+        CHECK(simplified.size() <= target);
+        CHECK(simplified.size() > 0);
+    }
+}
+
+TEST(ZeroErrorKeepsACurvedMesh)
+{
+    Grid grid = makeGrid(SPHERE, 20);
+    MeshSimplifier simplifier(grid.vertices.data(), grid.vertices.size(), sizeof(Vertex), grid.indices);
+
+    std::vector<unsigned int> simplified = simplifier.simplify(grid.indices.size() / 4, 0.f);
+    CHECK(simplifier.getError() == 0.f);
+    CHECK(measureError(grid, simplified) < 1e-5f);
+    // only the triangles on the poles go, the rows meet in one point there and they are degenerate once welded
+    CHECK(simplified.size() > grid.indices.size() * 3 / 4);
+}
+
+TEST(FlatGridSimplifiesWithoutError)
+{
+    Grid grid = makeGrid(PLANE, 30);
+    MeshSimplifier simplifier(grid.vertices.data(), grid.vertices.size(), sizeof(Vertex), grid.indices);
+
+    std::vector<unsigned int> simplified = simplifier.simplify(0, 1e-4f);
+    checkIndices(grid, simplified);
+    CHECK(simplified.size() < grid.indices.size() / 4);
+    CHECK(simplifier.getError() < 1e-4f);
+    CHECK(measureError(grid, simplified) < 1e-4f);
+
+    // the outline is locked, every vertex on it is still used
+    std::vector<bool> used(grid.vertices.size(), false);
+    for (unsigned int index : simplified)
+        used[index] = true;
+    for (int i = 0; i <= 30; i++)
+    {
+        CHECK(used[i]);
+        CHECK(used[30 * 31 + i]);
+        CHECK(used[i * 31]);
+        CHECK(used[i * 31 + 30]);
+    }
+}
+
+TEST(SeamsAreWelded)
+{
+    // the sphere's first and last column have the same positions but their own uvs
+    Grid grid = makeGrid(SPHERE, 24);
+    MeshSimplifier simplifier(grid.vertices.data(), grid.vertices.size(), sizeof(Vertex), grid.indices);
+    std::vector<unsigned int> simplified = simplifier.simplify(grid.indices.size() / 8 / 3 * 3, INFINITY);
+    CHECK(simplified.size() <= grid.indices.size() / 8);
+}
+
+TEST(LodsGetCoarser)
+{
+    Grid grid = makeGrid(TERRAIN, 40);
+    std::vector<unsigned int> allIndices;
+    MeshLod lods[MESH_LOD_COUNT];
+    int lodCount = buildMeshLods(grid.vertices.data(), grid.vertices.size(), sizeof(Vertex), grid.indices, allIndices, lods);
+
+    REQUIRE(lodCount >= 3);
+    CHECK(lods[0].startIndex == 0);
+    CHECK(lods[0].indexCount == grid.indices.size());
+    CHECK(lods[0].error == 0.f);
+
+    size_t total = 0;
+    for (int i = 0; i < lodCount; i++)
+    {
+        CHECK(lods[i].startIndex == total);
+        total += lods[i].indexCount;
+        if (i > 0)
+        {
+            CHECK(lods[i].indexCount <= lods[i - 1].indexCount * MESH_LOD_MIN_REDUCTION);
+            CHECK(lods[i].error >= lods[i - 1].error);
+            CHECK(lods[i].error <= 10.f * MESH_LOD_MAX_ERROR);
+
+            std::vector<unsigned int> lod(allIndices.begin() + lods[i].startIndex, allIndices.begin() + lods[i].startIndex + lods[i].indexCount);
+            CHECK(measureError(grid, lod) <= 2.f * lods[i].error + 1e-5f);
+        }
+    }
+    CHECK(total == allIndices.size());
+}
+
+TEST(LodSelectionFollowsTheScreenSize)
+{
+    MeshLod lods[] = { { 0, 3000, 0.f }, { 3000, 1500, 0.01f }, { 4500, 750, 0.05f }, { 5250, 372, 0.2f } };
+
+    // close, a pixel is smaller than any error
+    CHECK(selectMeshLod(lods, 4, 1000.f, 0) == 0);
+    // far away everything fits in a pixel
+    CHECK(selectMeshLod(lods, 4, 1.f, 0) == 3);
+    // 0.05 * 15 = 0.75, the middle one
+    CHECK(selectMeshLod(lods, 4, 15.f, 2) == 2);
+    CHECK(selectMeshLod(lods, 4, 0.f, 0) == 3);
+}
+
+TEST(LodSelectionHasHysteresis)
+{
+    MeshLod lods[] = { { 0, 3000, 0.f }, { 3000, 1500, 0.1f } };
+
+    // 0.1 * 9 = 0.9 pixels, fine for LOD 1 but not below the margin to switch to it
+    CHECK(selectMeshLod(lods, 2, 9.f, 0) == 0);
+    CHECK(selectMeshLod(lods, 2, 9.f, 1) == 1);
+    // under the margin it switches
+    CHECK(selectMeshLod(lods, 2, 7.f, 0) == 1);
+    // over the threshold it goes back
+    CHECK(selectMeshLod(lods, 2, 11.f, 1) == 0);
+}
@@ -0,0 +1,242 @@
+#include <Test.h>
+#include <Utility/OcclusionCuller.h>
+#include "Projection.h"
+
+using namespace Graphics;
+
+namespace
+{
+    const float NEAR_Z = 0.1f, FAR_Z = 250.f, FIELD_OF_VIEW = 1.4f;
+    const uint32_t WIDTH = 256, HEIGHT = 144;
+
+    struct Random
+    {
+        unsigned int state;
+
+        float next(float min, float max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return min + (max - min) * ((state >> 8) / float(1 << 24));
+        }
+    };
+
+    struct Box
+    {
+        float min[3], max[3];
+    };
+
+    // the camera is at the origin looking down -z, so view * proj is only proj
+    struct Scene
+    {
+        OcclusionCuller culler;
+        float proj[16], world[16];
+        std::vector<Box> occluders;
+
+        Scene() : culler(WIDTH, HEIGHT)
+        {
+            Projection::perspective(FIELD_OF_VIEW, WIDTH / (float)HEIGHT, NEAR_Z, FAR_Z, proj);
+            Projection::identity(world);
+        }
+
+        void add(Box const & box)
+        {
+            occluders.push_back(box);
+        }
+
+        void build()
+        {
+            culler.clear(proj);
+            for (Box const & box : occluders)
+                culler.addOccluder(world, box.min, box.max);
+            culler.buildHierarchy();
+        }
+
+        bool isVisible(Box const & box) const
+        {
+            return culler.isVisible(world, box.min, box.max);
+        }
+
+        // the segment from the camera to the point goes through an occluder
+        bool isBlocked(const float point[3]) const
+        {
+            for (Box const & box : occluders)
+            {
+                float enter = 0.f, leave = 0.999f;
+                for (int axis = 0; axis < 3 && enter <= leave; axis++)
+                {
+                    if (fabsf(point[axis]) < 1e-6f)
+                    {
+                        if (box.min[axis] > 0.f || box.max[axis] < 0.f)
+                            leave = -1.f;
+                        continue;
+                    }
+                    float t0 = box.min[axis] / point[axis], t1 = box.max[axis] / point[axis];
+                    enter = fmaxf(enter, fminf(t0, t1));
+                    leave = fminf(leave, fmaxf(t0, t1));
+                }
+                if (enter <= leave)
+                    return true;
+            }
+            return false;
+        }
+
+        // blocked here or a couple of depth buffer pixels away, occluder edges are only pixel exact
+        bool isNearlyBlocked(const float point[3]) const
+        {
+            float pixel = 2.f * -point[2] * tanf(FIELD_OF_VIEW * 0.5f) / HEIGHT;
+            for (int dx = -2; dx <= 2; dx++)
+            {
+                for (int dy = -2; dy <= 2; dy++)
+                {
+                    float moved[3] = { point[0] + dx * pixel, point[1] + dy * pixel, point[2] };
+                    if (isBlocked(moved))
+                        return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    const Box WALL = { { -5.f, -3.f, -11.f }, { 5.f, 3.f, -10.f } };
+}
+
+TEST(WallHidesWhatIsBehindIt)
+{
+    Scene scene;
+    scene.add(WALL);
+    scene.build();
+
+    CHECK(!scene.isVisible({ { -1.f, -1.f, -30.f }, { 1.f, 1.f, -28.f } }));
+    CHECK(!scene.isVisible({ { -3.f, -2.f, -12.f }, { 3.f, 2.f, -11.5f } }));
+}
+
+TEST(WallDoesntHideTheRest)
+{
+    Scene scene;
+    scene.add(WALL);
+    scene.build();
+
+    // in front
+    CHECK(scene.isVisible({ { -1.f, -1.f, -8.f }, { 1.f, 1.f, -6.f } }));
+    // peeking out past the edge and above
+    CHECK(scene.isVisible({ { 12.f, -1.f, -30.f }, { 18.f, 1.f, -28.f } }));
+    CHECK(scene.isVisible({ { -1.f, 6.f, -30.f }, { 1.f, 14.f, -28.f } }));
+    // inside the wall counts as in front of its far side
+    CHECK(scene.isVisible({ { -1.f, -1.f, -10.8f }, { 1.f, 1.f, -10.2f } }));
+    // crossing the near plane
+    CHECK(scene.isVisible({ { -1.f, -1.f, -30.f }, { 1.f, 1.f, 1.f } }));
+}
+
+TEST(OffScreenIsntVisible)
+{
+    Scene scene;
+    scene.build();
+
+    CHECK(scene.isVisible({ { -1.f, -1.f, -30.f }, { 1.f, 1.f, -28.f } }));
+    // behind the camera, off to the side, past the far plane
+    CHECK(!scene.isVisible({ { -1.f, -1.f, 5.f }, { 1.f, 1.f, 7.f } }));
+    CHECK(!scene.isVisible({ { 100.f, -1.f, -30.f }, { 102.f, 1.f, -28.f } }));
+    CHECK(!scene.isVisible({ { -1.f, -1.f, -400.f }, { 1.f, 1.f, -300.f } }));
+}
+
+TEST(ClearForgetsTheOccluders)
+{
+    Scene scene;
+    scene.add(WALL);
+    scene.build();
+    CHECK(scene.culler.getTriangleCount() > 0);
+
+    Box behind = { { -1.f, -1.f, -30.f }, { 1.f, 1.f, -28.f } };
+    CHECK(!scene.isVisible(behind));
+
+    scene.occluders.clear();
+    scene.build();
+    CHECK(scene.culler.getTriangleCount() == 0);
+    CHECK(scene.isVisible(behind));
+    for (float depth : scene.culler.getDepth())
+        CHECK(depth == 1.f);
+}
+
+TEST(DepthIsTheNearestOccluder)
+{
+    Scene scene;
+    scene.add(WALL);
+    scene.add({ { -1.f, -1.f, -6.f }, { 1.f, 1.f, -5.f } });
+    scene.build();
+
+    CHECK(scene.culler.getWidth() == WIDTH);
+    CHECK(scene.culler.getHeight() == HEIGHT);
+
+    // the middle pixel sees the front face of the small box, its left neighbour too
+    std::vector<float> const & depth = scene.culler.getDepth();
+    float expected = Projection::depthOf(scene.proj, -5.f);
+    CHECK_NEAR(depth[HEIGHT / 2 * WIDTH + WIDTH / 2], expected, 1e-4f);
+    CHECK_NEAR(depth[HEIGHT / 2 * WIDTH + WIDTH / 2 - 1], expected, 1e-4f);
+
+    // beside it the wall, outside of the wall nothing
+    CHECK_NEAR(depth[HEIGHT / 2 * WIDTH + WIDTH / 2 + 20], Projection::depthOf(scene.proj, -10.f), 1e-4f);
+    CHECK(depth[4 * WIDTH + 4] == 1.f);
+}
+
+TEST(GroundKeepsItsDepthPrecision)
+{
+    // a huge thin box like the map's ground under the camera
+    Scene scene;
+    scene.add({ { -1000.f, -2.0001f, -1000.f }, { 1000.f, -2.f, 1000.f } });
+    scene.build();
+
+    // only just above the ground and only just below it
+    CHECK(scene.isVisible({ { -0.5f, -1.9f, -40.f }, { 0.5f, -1.5f, -39.f } }));
+    CHECK(!scene.isVisible({ { -0.5f, -3.f, -40.f }, { 0.5f, -2.5f, -39.f } }));
+}
+
+TEST(CulledBoxesAreHidden)
+{
+    // random walls and random boxes, nothing culled may be seen by a ray from the camera
+    Random random = { 40 };
+    int tested = 0, culled = 0, wrong = 0;
+
+    for (int round = 0; round < 20; round++)
+    {
+        Scene scene;
+        for (int i = 0; i < 12; i++)
+        {
+            float center[3] = { random.next(-30.f, 30.f), random.next(-8.f, 8.f), random.next(-60.f, -8.f) };
+            float extent[3] = { random.next(0.5f, 8.f), random.next(0.5f, 6.f), random.next(0.5f, 3.f) };
+            scene.add({ { center[0] - extent[0], center[1] - extent[1], center[2] - extent[2] },
+                        { center[0] + extent[0], center[1] + extent[1], center[2] + extent[2] } });
+        }
+        scene.build();
+
+        for (int i = 0; i < 200; i++)
+        {
+            float center[3] = { random.next(-40.f, 40.f), random.next(-10.f, 10.f), random.next(-100.f, -15.f) };
+            float extent = random.next(0.2f, 1.5f);
+            Box box = { { center[0] - extent, center[1] - extent, center[2] - extent },
+                        { center[0] + extent, center[1] + extent, center[2] + extent } };
+
+            tested++;
+            if (scene.isVisible(box))
+                continue;
+            culled++;
+
+            // the corners, the middle of every face and the center
+            for (int sample = 0; sample < 27; sample++)
+            {
+                float point[3];
+                for (int axis = 0, rest = sample; axis < 3; axis++, rest /= 3)
+                    point[axis] = rest % 3 == 0 ? box.min[axis] : rest % 3 == 1 ? center[axis] : box.max[axis];
+
+                // only what the camera sees
+                if (fabsf(point[0]) > -point[2] * tanf(FIELD_OF_VIEW * 0.5f) * WIDTH / HEIGHT ||
+                    fabsf(point[1]) > -point[2] * tanf(FIELD_OF_VIEW * 0.5f))
+                    continue;
+                wrong += !scene.isNearlyBlocked(point);
+            }
+        }
+    }
+
+    printf("    %d of %d boxes culled\n", culled, tested);
+    CHECK(culled > tested / 10);
+    CHECK(wrong == 0);
+}
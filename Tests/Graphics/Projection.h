@@ -0,0 +1,102 @@
+#pragma once
+#include <math.h>
+#include <string.h>
+
+/*
+    Row major matrices for the light tests, multiplied from the left like
+    the renderer does. Right handed, -z forward, depth 0 at near and 1 at
+    far (SimpleMath's CreatePerspectiveFieldOfView).
+*/
+
+namespace Projection
+{
+    inline void perspective(float fieldOfView, float aspect, float nearZ, float farZ, float proj[16])
+    {
+        float yScale = 1.f / tanf(fieldOfView * 0.5f);
+        float range = farZ / (nearZ - farZ);
+        memset(proj, 0, sizeof(float) * 16);
+        proj[0] = yScale / aspect;
+        proj[5] = yScale;
+        proj[10] = range;
+        proj[11] = -1.f;
+        proj[14] = range * nearZ;
+    }
+
+    inline void identity(float m[16])
+    {
+        memset(m, 0, sizeof(float) * 16);
+        m[0] = m[5] = m[10] = m[15] = 1.f;
+    }
+
+    // Gauss-Jordan with partial pivoting, false if m can't be inverted
+    inline bool invert(const float m[16], float out[16])
+    {
+        double a[4][8];
+        for (int row = 0; row < 4; row++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                a[row][column] = m[row * 4 + column];
+                a[row][column + 4] = row == column ? 1.0 : 0.0;
+            }
+        }
+
+        for (int column = 0; column < 4; column++)
+        {
+            int pivot = column;
+            for (int row = column + 1; row < 4; row++)
+                if (fabs(a[row][column]) > fabs(a[pivot][column]))
+                    pivot = row;
+            if (fabs(a[pivot][column]) < 1e-12)
+                return false;
+
+            for (int i = 0; i < 8; i++)
+            {
+                double swap = a[column][i];
+                a[column][i] = a[pivot][i];
+                a[pivot][i] = swap;
+            }
+
+            double scale = 1.0 / a[column][column];
+            for (int i = 0; i < 8; i++)
+                a[column][i] *= scale;
+
+            for (int row = 0; row < 4; row++)
+            {
+                if (row == column)
+                    continue;
+                double factor = a[row][column];
+                for (int i = 0; i < 8; i++)
+                    a[row][i] -= factor * a[column][i];
+            }
+        }
+
+        for (int row = 0; row < 4; row++)
+            for (int column = 0; column < 4; column++)
+                out[row * 4 + column] = (float)a[row][column + 4];
+        return true;
+    }
+
+    // v * m
+    inline void transform(const float v[4], const float m[16], float out[4])
+    {
+        for (int column = 0; column < 4; column++)
+            out[column] = v[0] * m[column] + v[1] * m[4 + column] + v[2] * m[8 + column] + v[3] * m[12 + column];
+    }
+
+    // what the depth buffer has for a view space z (negative in front of the camera)
+    inline float depthOf(const float proj[16], float viewZ)
+    {
+        return (viewZ * proj[10] + proj[14]) / -viewZ;
+    }
+
+    // the view space position of a pixel center at a depth
+    inline void unproject(const float invProj[16], float x, float y, float width, float height, float depth, float out[3])
+    {
+        float clip[4] = { x / width * 2.f - 1.f, (1.f - y / height) * 2.f - 1.f, depth, 1.f };
+        float view[4];
+        transform(clip, invProj, view);
+        for (int i = 0; i < 3; i++)
+            out[i] = view[i] / view[3];
+    }
+}
@@ -0,0 +1,180 @@
+#include <Test.h>
+#include <Utility/RenderCommandList.h>
+#include <algorithm>
+
+using namespace Graphics;
+
+namespace
+{
+    struct Random
+    {
+        unsigned int state;
+
+        unsigned int next(unsigned int max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return (state >> 8) % max;
+        }
+    };
+
+    uint64_t withoutDepth(uint64_t key)
+    {
+        return key & ~uint64_t((1 << 12) - 1);
+    }
+}
+
+TEST(KeyFieldsComeBackOut)
+{
+    uint64_t key = RenderCommandList::makeKey(RenderCommandList::PASS_SHADOW_2, true, 200, 40000, 65535, 3, 0.5f);
+    CHECK(RenderCommandList::getPass(key) == RenderCommandList::PASS_SHADOW_2);
+    CHECK(RenderCommandList::getCulling(key));
+    CHECK(RenderCommandList::getShader(key) == 200);
+    CHECK(RenderCommandList::getMaterial(key) == 40000);
+    CHECK(RenderCommandList::getMesh(key) == 65535);
+    CHECK(RenderCommandList::getLod(key) == 3);
+    CHECK(RenderCommandList::getDepth(key) == 2047);
+
+    key = RenderCommandList::makeKey(RenderCommandList::PASS_OPAQUE, false, 0, 0, 0, 0, 0.f);
+    CHECK(key == 0);
+}
+
+TEST(KeyFieldsDontSpillIntoEachOther)
+{
+    // too big for their fields, they are cut instead of changing the neighbours
+    uint64_t key = RenderCommandList::makeKey(0, false, 0, 0x1ffff, 0, 7, 0.f);
+    CHECK(RenderCommandList::getMaterial(key) == 0xffff);
+    CHECK(RenderCommandList::getShader(key) == 0);
+    CHECK(RenderCommandList::getLod(key) == 3);
+    CHECK(RenderCommandList::getMesh(key) == 0);
+}
+
+TEST(DepthIsClamped)
+{
+    CHECK(RenderCommandList::getDepth(RenderCommandList::makeKey(0, false, 0, 0, 0, 0, -4.f)) == 0);
+    CHECK(RenderCommandList::getDepth(RenderCommandList::makeKey(0, false, 0, 0, 0, 0, 9.f)) == 4095);
+}
+
+TEST(KeysOrderPassThenStateThenDepth)
+{
+    uint64_t opaqueFar = RenderCommandList::makeKey(RenderCommandList::PASS_OPAQUE, true, 255, 65535, 65535, 3, 1.f);
+    uint64_t shadowNear = RenderCommandList::makeKey(RenderCommandList::PASS_SHADOW_0, false, 0, 0, 0, 0, 0.f);
+    CHECK(opaqueFar < shadowNear);
+
+    uint64_t near = RenderCommandList::makeKey(0, true, 1, 2, 3, 0, 0.1f);
+    uint64_t far = RenderCommandList::makeKey(0, true, 1, 2, 3, 0, 0.9f);
+    uint64_t otherMesh = RenderCommandList::makeKey(0, true, 1, 2, 4, 0, 0.f);
+    CHECK(near < far);
+    CHECK(far < otherMesh);
+}
+
+TEST(SortMatchesStdSort)
+{
+    Random random = { 99 };
+    RenderCommandList list;
+    std::vector<RenderCommandList::Command> expected;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        uint64_t key = RenderCommandList::makeKey(random.next(RenderCommandList::NR_OF_PASSES), random.next(2) != 0,
+            random.next(3), random.next(20), random.next(300), random.next(4), random.next(1000) / 1000.f);
+        list.push(key, i);
+        expected.push_back({ key, i });
+    }
+
+    list.sort();
+    // the radix sort is stable, equal keys stay in push order
+    std::stable_sort(expected.begin(), expected.end(), [](RenderCommandList::Command const & a, RenderCommandList::Command const & b) {
+        return a.key < b.key;
+    });
+
+    REQUIRE(list.getCommands().size() == expected.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        CHECK(list.getCommands()[i].key == expected[i].key);
+        CHECK(list.getCommands()[i].index == expected[i].index);
+    }
+}
+
+TEST(SortHandlesEmptyAndEqualKeys)
+{
+    RenderCommandList list;
+    list.sort();
+    CHECK(list.getCommands().empty());
+    CHECK(list.getBatches().empty());
+
+    uint64_t key = RenderCommandList::makeKey(1, true, 2, 3, 4, 1, 0.25f);
+    for (uint32_t i = 0; i < 10; i++)
+        list.push(key, 9 - i);
+    list.sort();
+    for (uint32_t i = 0; i < 10; i++)
+        CHECK(list.getCommands()[i].index == 9 - i);
+    REQUIRE(list.getBatches().size() == 1);
+    CHECK(list.getBatches()[0].count == 10);
+}
+
+TEST(DepthNeverSplitsABatch)
+{
+    RenderCommandList list;
+    for (uint32_t i = 0; i < 100; i++)
+        list.push(RenderCommandList::makeKey(0, true, 0, 5, 7, 0, (99 - i) / 100.f), i);
+    list.push(RenderCommandList::makeKey(0, true, 0, 5, 8, 0, 0.f), 100);
+    list.sort();
+
+    REQUIRE(list.getBatches().size() == 2);
+    CHECK(list.getBatches()[0].first == 0);
+    CHECK(list.getBatches()[0].count == 100);
+    CHECK(RenderCommandList::getDepth(list.getBatches()[0].key) == 0);
+    CHECK(list.getBatches()[1].first == 100);
+
+    // front to back inside the batch
+    CHECK(list.getCommands()[0].index == 99);
+    CHECK(list.getCommands()[99].index == 0);
+}
+
+TEST(BatchesCoverEveryCommandOnce)
+{
+    Random random = { 7 };
+    RenderCommandList list;
+    for (uint32_t i = 0; i < 3000; i++)
+        list.push(RenderCommandList::makeKey(random.next(2), true, 0, random.next(8), random.next(16), random.next(4), random.next(100) / 100.f), i);
+    list.sort();
+
+    const std::vector<RenderCommandList::Command> & commands = list.getCommands();
+    uint32_t next = 0;
+    for (RenderCommandList::Batch const & batch : list.getBatches())
+    {
+        CHECK(batch.first == next);
+        for (uint32_t i = batch.first; i < batch.first + batch.count; i++)
+            CHECK(withoutDepth(commands[i].key) == batch.key);
+        next += batch.count;
+    }
+    CHECK(next == commands.size());
+
+    // neighbours have different state, or they would have been one batch
+    for (size_t i = 1; i < list.getBatches().size(); i++)
+        CHECK(list.getBatches()[i - 1].key != list.getBatches()[i].key);
+}
+
+TEST(MaxBatchSizeSplitsBatches)
+{
+    RenderCommandList list;
+    list.setMaxBatchSize(64);
+    for (uint32_t i = 0; i < 200; i++)
+        list.push(RenderCommandList::makeKey(0, true, 0, 1, 1, 0, 0.f), i);
+    list.sort();
+
+    REQUIRE(list.getBatches().size() == 4);
+    CHECK(list.getBatches()[0].count == 64);
+    CHECK(list.getBatches()[3].first == 192);
+    CHECK(list.getBatches()[3].count == 8);
+    CHECK(list.getBatches()[2].key == list.getBatches()[3].key);
+}
+
+TEST(ClearKeepsNothing)
+{
+    RenderCommandList list;
+    list.push(RenderCommandList::makeKey(0, true, 0, 1, 1, 0, 0.f), 0);
+    list.sort();
+    list.clear();
+    CHECK(list.getCommands().empty());
+    CHECK(list.getBatches().empty());
+}
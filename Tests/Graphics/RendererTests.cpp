@@ -0,0 +1,205 @@
+#include <Test.h>
+#include <Renderer.h>
+#include <Device/NullRenderDevice.h>
+
+using namespace Graphics;
+using namespace DirectX::SimpleMath;
+
+/*
+    The whole renderer on the NullRenderDevice, with the game's resources.
+    Shaders are empty without a compiler, everything else is the real path.
+*/
+
+namespace
+{
+    const int WIDTH = 1280, HEIGHT = 720;
+
+    struct Scene
+    {
+        NullRenderDevice device;
+        GpuTexture * backBuffer;
+        Camera * camera;
+        Renderer * renderer;
+
+        std::vector<RenderInfo> statics;
+        std::vector<RenderInfo> dynamics;
+
+        Scene(int staticCount, int dynamicCount) :
+            statics(staticCount), dynamics(dynamicCount)
+        {
+            TextureDesc desc = {};
+            desc.width = WIDTH;
+            desc.height = HEIGHT;
+            desc.mipLevels = 1;
+            desc.arraySize = 1;
+            desc.format = FORMAT_R8G8B8A8_UNORM;
+            desc.usage = USAGE_DEFAULT;
+            desc.bindFlags = BIND_RENDER_TARGET;
+            backBuffer = device.CreateTexture(desc, nullptr);
+
+            camera = new Camera(&device, WIDTH, HEIGHT);
+            camera->update(Vector3(0, 2, -10), Vector3(0, 0, 1), &device);
+
+            renderer = new Renderer(&device, backBuffer, camera);
+            renderer->finishLoading();
+
+            for (size_t i = 0; i < statics.size(); i++)
+            {
+                statics[i].render = true;
+                statics[i].meshId = CUBE;
+                statics[i].materialId = 0;
+                statics[i].translation = Matrix::CreateTranslation(float(i % 10) - 5, 0, float(i / 10));
+                renderer->registerStatic(&statics[i]);
+            }
+
+            for (size_t i = 0; i < dynamics.size(); i++)
+            {
+                dynamics[i].render = true;
+                dynamics[i].meshId = i % 2 ? CUBE : SPHERE;
+                dynamics[i].materialId = 0;
+                // a block in front of the camera, 40 by 40 in each layer
+                dynamics[i].translation = Matrix::CreateTranslation(float(i % 40) * 0.5f - 10, float(i / 40 % 40) * 0.5f - 10, 10 + float(i / 1600) * 0.5f);
+            }
+        }
+
+        ~Scene()
+        {
+            delete renderer;
+            delete camera;
+            SAFE_RELEASE(backBuffer);
+        }
+
+        Renderer::FrameStats frame()
+        {
+            device.beginFrame();
+            for (RenderInfo & info : dynamics)
+                renderer->queueRender(&info);
+            renderer->render(camera);
+            return renderer->getFrameStats();
+        }
+    };
+}
+
+TEST(RendererDrawsOnTheNullDevice)
+{
+    Scene scene(20, 16);
+    Renderer::FrameStats stats = scene.frame();
+
+    CHECK(stats.drawCalls > 0);
+    CHECK(scene.device.getStats().draws >= stats.drawCalls);
+    CHECK(scene.device.getStats().instances >= scene.statics.size() + scene.dynamics.size());
+}
+
+namespace
+{
+    // every command has its instance, the shadow casters are in the command list once per cascade
+    UINT expectedInstanceBytes(Renderer::FrameStats const & stats, size_t queued)
+    {
+        size_t commands = queued - stats.occlusionCulled + stats.shadowCasters;
+        return UINT(commands * sizeof(InstanceData)) + stats.staticInstanceBytesUploaded;
+    }
+}
+
+TEST(RendererUploadsStaticsOnce)
+{
+    Scene scene(20, 16);
+    const UINT staticBytes = UINT(scene.statics.size() * sizeof(InstanceData));
+
+    Renderer::FrameStats first = scene.frame();
+    CHECK(first.staticInstanceBytesUploaded == staticBytes);
+    CHECK(first.instanceBytesUploaded == expectedInstanceBytes(first, scene.dynamics.size()));
+
+    for (int i = 0; i < 4; i++)
+    {
+        Renderer::FrameStats stats = scene.frame();
+        CHECK(stats.staticInstanceBytesUploaded == 0);
+        CHECK(stats.instanceBytesUploaded == expectedInstanceBytes(stats, scene.dynamics.size()));
+        CHECK(stats.drawCalls > 0);
+    }
+}
+
+TEST(RendererClearStaticsDropsThem)
+{
+    Scene scene(20, 0);
+    scene.frame();
+    CHECK(scene.frame().staticInstanceBytesUploaded == 0);
+    UINT drawn = scene.device.getStats().instances;
+
+    // what Game does when the map is deleted, then the next map registers its own
+    scene.renderer->clearStatics();
+    Renderer::FrameStats cleared = scene.frame();
+    CHECK(cleared.instanceBytesUploaded == 0);
+    CHECK(scene.device.getStats().instances + 20 <= drawn);
+
+    for (int i = 0; i < 5; i++)
+        scene.renderer->registerStatic(&scene.statics[i]);
+    Renderer::FrameStats next = scene.frame();
+    CHECK(next.staticInstanceBytesUploaded == 5 * sizeof(InstanceData));
+    CHECK(scene.device.getStats().instances >= 5);
+    CHECK(scene.frame().staticInstanceBytesUploaded == 0);
+}
+
+TEST(RendererUploadsWhatItCounts)
+{
+    Scene scene(0, 32);
+    scene.frame();
+
+    for (int i = 0; i < 4; i++)
+    {
+        Renderer::FrameStats stats = scene.frame();
+        CHECK(stats.instanceBytesUploaded == expectedInstanceBytes(stats, scene.dynamics.size()));
+        // the instances and the constant buffers, the device saw all of it
+        CHECK(scene.device.getStats().bytesUploaded >= stats.instanceBytesUploaded);
+        printf("    frame %d: %u draws, %u instance bytes, %u bytes uploaded\n", i,
+            stats.drawCalls, stats.instanceBytesUploaded, scene.device.getStats().bytesUploaded);
+    }
+}
+
+TEST(RendererDraws100kInstances)
+{
+    const UINT count = 100000;
+    Scene scene(0, count);
+    Renderer::FrameStats stats = scene.frame();
+
+    // more than one upload fits in the instance buffer, each pass uploads its part again but nothing is dropped
+    CHECK(stats.occlusionCulled == 0);
+    CHECK(scene.device.getStats().instances >= count);
+    CHECK(stats.instanceBytesUploaded >= expectedInstanceBytes(stats, count));
+    CHECK(stats.instanceHighWaterMark >= count);
+    CHECK(stats.drawCalls > 1);
+
+    stats = scene.frame();
+    CHECK(scene.device.getStats().instances >= count);
+    CHECK(stats.instanceBytesUploaded >= expectedInstanceBytes(stats, count));
+}
+
+TEST(RendererCullsStaticsPerCascade)
+{
+    // ten statics in front of the camera, ten at the end of the shadow distance and ten far past it
+    Scene scene(30, 0);
+    scene.renderer->clearStatics();
+    const float z[] = { 0.f, 60.f, 1000.f };
+    for (size_t i = 0; i < scene.statics.size(); i++)
+    {
+        scene.statics[i].translation = Matrix::CreateTranslation(float(i % 10) - 5, 0, z[i / 10]);
+        scene.renderer->registerStatic(&scene.statics[i]);
+    }
+
+    // every cascade is updated at least once in four frames
+    UINT most[SHADOW_CASCADES] = {};
+    for (int frame = 0; frame < 4; frame++)
+    {
+        Renderer::FrameStats stats = scene.frame();
+        for (UINT i = 0; i < SHADOW_CASCADES; i++)
+        {
+            // the far ones are never drawn into a shadow map
+            CHECK(stats.staticShadowCasters[i] <= 20);
+            most[i] = std::max(most[i], stats.staticShadowCasters[i]);
+        }
+    }
+    printf("    statics per cascade: %u %u %u %u\n", most[0], most[1], most[2], most[3]);
+
+    // the first cascade only gets the near ones, the last one the ones at the end of the distance too
+    CHECK(most[0] == 10);
+    CHECK(most[SHADOW_CASCADES - 1] > 10);
+}
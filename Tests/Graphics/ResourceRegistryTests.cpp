@@ -0,0 +1,173 @@
+#include <Test.h>
+#include <Resources/ResourceRegistry.h>
+#include <unordered_map>
+
+using namespace Graphics;
+
+namespace
+{
+    struct Random
+    {
+        unsigned int state;
+
+        uint32_t next(uint32_t count)
+        {
+            state = state * 1664525u + 1013904223u;
+            return (state >> 8) % count;
+        }
+    };
+
+    std::string textureName(uint32_t i)
+    {
+        return "Resources/Textures/texture" + std::to_string(i) + ".png";
+    }
+}
+
+TEST(AcquireRegistersOnce)
+{
+    ResourceRegistry registry;
+    bool created = false;
+
+    ResourceRegistry::Handle stone = registry.acquire("stone.jpg", &created);
+    CHECK(stone != ResourceRegistry::INVALID_HANDLE);
+    CHECK(created);
+    CHECK(registry.acquire("stone.jpg", &created) == stone);
+    CHECK(!created);
+
+    ResourceRegistry::Handle wood = registry.acquire("wood.jpg", &created);
+    CHECK(created);
+    CHECK(wood != stone);
+    CHECK(registry.getIndex(wood) != registry.getIndex(stone));
+
+    CHECK(registry.find("stone.jpg") == stone);
+    CHECK(registry.find("metal.jpg") == ResourceRegistry::INVALID_HANDLE);
+    CHECK(registry.getRefCount(stone) == 2);
+    CHECK(registry.getRefCount(wood) == 1);
+    CHECK(registry.getName(wood) == "wood.jpg");
+    CHECK(registry.getHandle(registry.getIndex(wood)) == wood);
+    CHECK(registry.getCount() == 2);
+    CHECK(registry.getCapacity() == 2);
+}
+
+TEST(OnlyUnreferencedAreEvicted)
+{
+    ResourceRegistry registry;
+    ResourceRegistry::Handle stone = registry.acquire("stone.jpg");
+    ResourceRegistry::Handle wood = registry.acquire("wood.jpg");
+    CHECK(registry.addRef(stone));
+    CHECK(registry.release(stone));
+    CHECK(registry.release(wood));
+    CHECK(registry.release(wood));
+    CHECK(registry.getRefCount(wood) == 0);
+
+    std::vector<ResourceRegistry::Handle> evicted;
+    CHECK(registry.evictUnused([&evicted](ResourceRegistry::Handle handle) { evicted.push_back(handle); }) == 1);
+    REQUIRE(evicted.size() == 1);
+    CHECK(evicted[0] == wood);
+
+    CHECK(registry.isValid(stone));
+    CHECK(!registry.isValid(wood));
+    CHECK(registry.find("wood.jpg") == ResourceRegistry::INVALID_HANDLE);
+    CHECK(registry.getHandle(registry.getIndex(wood)) == ResourceRegistry::INVALID_HANDLE);
+    CHECK(registry.getCount() == 1);
+
+    registry.clear();
+    CHECK(!registry.isValid(stone));
+    CHECK(registry.getCount() == 0);
+}
+
+TEST(StaleHandlesStayStale)
+{
+    ResourceRegistry registry;
+    ResourceRegistry::Handle stone = registry.acquire("stone.jpg");
+    registry.release(stone);
+    registry.evictUnused();
+
+    // the slot is reused with a new generation
+    ResourceRegistry::Handle metal = registry.acquire("metal.jpg");
+    CHECK(registry.getIndex(metal) == registry.getIndex(stone));
+    CHECK(metal != stone);
+    CHECK(!registry.isValid(stone));
+    CHECK(!registry.addRef(stone));
+    CHECK(!registry.release(stone));
+    CHECK(registry.getRefCount(stone) == 0);
+    CHECK(registry.getRefCount(metal) == 1);
+
+    CHECK(!registry.isValid(ResourceRegistry::INVALID_HANDLE));
+    CHECK(!registry.isValid(12345));
+}
+
+TEST(GenerationsWrapPastZero)
+{
+    // one slot used over and over, a handle is never 0 and never repeats the one before
+    ResourceRegistry registry;
+    ResourceRegistry::Handle previous = ResourceRegistry::INVALID_HANDLE;
+
+    for (int i = 0; i < 10000; i++)
+    {
+        ResourceRegistry::Handle handle = registry.acquire("texture.png");
+        CHECK(handle != ResourceRegistry::INVALID_HANDLE);
+        CHECK(handle != previous);
+        CHECK(registry.getIndex(handle) == 0);
+        registry.release(handle);
+        registry.evictUnused();
+        previous = handle;
+    }
+}
+
+TEST(MatchesAnUnorderedMap)
+{
+    // random acquires, releases and evictions against the obvious implementation
+    ResourceRegistry registry;
+    std::unordered_map<std::string, std::pair<ResourceRegistry::Handle, uint32_t>> expected;
+    Random random = { 44 };
+
+    for (int step = 0; step < 200000; step++)
+    {
+        std::string name = textureName(random.next(3000));
+        uint32_t action = random.next(100);
+
+        if (action < 60)
+        {
+            bool created;
+            ResourceRegistry::Handle handle = registry.acquire(name, &created);
+            auto found = expected.find(name);
+            CHECK(created == (found == expected.end()));
+            if (found == expected.end())
+                expected[name] = { handle, 1 };
+            else
+            {
+                CHECK(found->second.first == handle);
+                found->second.second++;
+            }
+        }
+        else if (action < 98)
+        {
+            auto found = expected.find(name);
+            ResourceRegistry::Handle handle = registry.find(name);
+            CHECK((handle != ResourceRegistry::INVALID_HANDLE) == (found != expected.end()));
+            if (found != expected.end())
+            {
+                CHECK(handle == found->second.first);
+                CHECK(registry.release(handle));
+                if (found->second.second > 0)
+                    found->second.second--;
+            }
+        }
+        else
+        {
+            registry.evictUnused();
+            for (auto i = expected.begin(); i != expected.end();)
+                i = i->second.second == 0 ? expected.erase(i) : std::next(i);
+        }
+    }
+
+    CHECK(registry.getCount() == expected.size());
+    for (auto const & entry : expected)
+    {
+        ResourceRegistry::Handle handle = registry.find(entry.first);
+        CHECK(handle == entry.second.first);
+        CHECK(registry.getRefCount(handle) == entry.second.second);
+        CHECK(registry.getName(handle) == entry.first);
+    }
+}
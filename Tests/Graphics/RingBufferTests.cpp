@@ -0,0 +1,138 @@
+#include <Test.h>
+#include <Utility/RingBuffer.h>
+#include <Device/NullRenderDevice.h>
+#include <string.h>
+
+using namespace Graphics;
+
+namespace
+{
+    struct Element
+    {
+        float data[16];
+    };
+
+    // the maps recorded since beginFrame, in order
+    std::vector<NullRenderDevice::Command> getMaps(NullRenderDevice const & device)
+    {
+        std::vector<NullRenderDevice::Command> maps;
+        for (NullRenderDevice::Command const & command : device.getCommands())
+            if (command.type == NullRenderDevice::MAP)
+                maps.push_back(command);
+        return maps;
+    }
+}
+
+TEST(RingBufferSuballocatesWithNoOverwrite)
+{
+    NullRenderDevice device;
+    RingBuffer<Element> ring(&device, 100, 1000);
+    device.beginFrame();
+    ring.beginFrame();
+
+    UINT offsets[3];
+    for (int i = 0; i < 3; i++)
+    {
+        ring.map(&device, 30, offsets[i]);
+        ring.unmap(&device);
+    }
+
+    // a new buffer starts with a discard, the rest goes after it
+    CHECK(offsets[0] == 0);
+    CHECK(offsets[1] == 30);
+    CHECK(offsets[2] == 60);
+
+    std::vector<NullRenderDevice::Command> maps = getMaps(device);
+    REQUIRE(maps.size() == 3);
+    CHECK(strcmp(maps[0].name, "Map") == 0);
+    CHECK(strcmp(maps[1].name, "MapNoOverwrite") == 0);
+    CHECK(maps[1].args[1] == 30 * sizeof(Element));
+    CHECK(strcmp(maps[2].name, "MapNoOverwrite") == 0);
+    CHECK(ring.getUsedThisFrame() == 90);
+}
+
+TEST(RingBufferWrapsWithDiscard)
+{
+    NullRenderDevice device;
+    RingBuffer<Element> ring(&device, 100, 1000);
+    UINT offset;
+
+    ring.beginFrame();
+    ring.map(&device, 80, offset);
+    ring.unmap(&device);
+
+    // doesn't fit behind the last one, starts over
+    device.beginFrame();
+    ring.beginFrame();
+    ring.map(&device, 40, offset);
+    ring.unmap(&device);
+    CHECK(offset == 0);
+    CHECK(strcmp(getMaps(device)[0].name, "Map") == 0);
+    CHECK(ring.getCapacity() == 100);
+    CHECK(ring.getGrowCount() == 0);
+}
+
+TEST(RingBufferGrowsGeometrically)
+{
+    NullRenderDevice device;
+    RingBuffer<Element> ring(&device, 64, 100000);
+    UINT offset;
+
+    ring.beginFrame();
+    ring.map(&device, 100, offset);
+    ring.unmap(&device);
+    CHECK(ring.getCapacity() == 128);
+    CHECK(ring.getGrowCount() == 1);
+
+    // more than twice as big takes what was asked for
+    ring.map(&device, 1000, offset);
+    ring.unmap(&device);
+    CHECK(ring.getCapacity() == 1000);
+    CHECK(ring.getGrowCount() == 2);
+    CHECK(offset == 0);
+
+    // the old buffers are released when they're replaced
+    CHECK(device.getLiveObjects() == 2);
+}
+
+TEST(RingBufferStopsAtMaxCapacity)
+{
+    NullRenderDevice device;
+    RingBuffer<Element> ring(&device, 64, 500);
+    UINT offset;
+
+    ring.beginFrame();
+    ring.map(&device, 400, offset);
+    ring.unmap(&device);
+    CHECK(ring.getCapacity() == 400);
+
+    ring.map(&device, 450, offset);
+    ring.unmap(&device);
+    CHECK(ring.getCapacity() == 500);
+
+    // asking for more is cut to what fits, the caller splits
+    ring.map(&device, 800, offset);
+    ring.unmap(&device);
+    CHECK(ring.getCapacity() == 500);
+    CHECK(ring.getUsedThisFrame() == 400 + 450 + 500);
+}
+
+TEST(RingBufferKeepsTheHighWaterMark)
+{
+    NullRenderDevice device;
+    RingBuffer<Element> ring(&device, 1000, 1000);
+    UINT offset;
+
+    ring.beginFrame();
+    for (int i = 0; i < 5; i++)
+    {
+        ring.map(&device, 100, offset);
+        ring.unmap(&device);
+    }
+    ring.beginFrame();
+    ring.map(&device, 10, offset);
+    ring.unmap(&device);
+
+    CHECK(ring.getUsedThisFrame() == 10);
+    CHECK(ring.getHighWaterMark() == 500);
+}
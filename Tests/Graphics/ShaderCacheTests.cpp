@@ -0,0 +1,323 @@
+#include <Test.h>
+#include <Resources/ShaderCache.h>
+#include <fstream>
+#include <map>
+#include <stdio.h>
+
+using namespace Graphics;
+
+namespace
+{
+    const char STORE[] = "ShaderCacheTests.store";
+    const char PACK[] = "ShaderCacheTests.pack";
+
+    // counts its compiles, the bytecode says what it was compiled from
+    struct FakeCompiler : ShaderCompiler
+    {
+        int compiles = 0;
+
+        bool compile(ShaderPermutation const & permutation, std::vector<char> & bytecode, std::string & errors) override
+        {
+            compiles++;
+            if (permutation.entry == "Broken")
+            {
+                errors = "error X3000: syntax error";
+                return false;
+            }
+
+            std::string code = permutation.path + ":" + permutation.entry + ":" + permutation.profile;
+            for (auto const & define : permutation.defines)
+                code += ":" + define.first + "=" + define.second;
+            bytecode.assign(code.begin(), code.end());
+            return true;
+        }
+    };
+
+    // the shader sources in memory
+    struct Sources
+    {
+        std::map<std::string, std::string> files;
+
+        ShaderCache::Reader get()
+        {
+            return [this](std::string const & path, std::string & text)
+            {
+                auto found = files.find(path);
+                if (found == files.end())
+                    return false;
+                text = found->second;
+                return true;
+            };
+        }
+
+        Sources()
+        {
+            files["Shaders/Forward.hlsl"] = "#include \"Common/Light.hlsl\"\nfloat4 PS() : SV_Target { return 1; }\n";
+            files["Shaders/Common/Light.hlsl"] = "#include \"Math.hlsl\"\nstruct Light { float3 color; };\n";
+            files["Shaders/Common/Math.hlsl"] = "#include \"Light.hlsl\"\nfloat square(float x) { return x * x; }\n";
+        }
+    };
+
+    ShaderPermutation forward()
+    {
+        return { "Shaders/Forward.hlsl", "PS", "ps_5_0", { { "CLUSTERED", "1" } } };
+    }
+
+    void removeFiles()
+    {
+        remove(STORE);
+        remove(PACK);
+    }
+
+    bool get(ShaderCache & cache, ShaderPermutation const & permutation, std::string * code = nullptr)
+    {
+        std::vector<char> bytecode;
+        std::string errors;
+        bool compiled = cache.get(permutation, bytecode, errors);
+        if (code)
+            code->assign(bytecode.begin(), bytecode.end());
+        return compiled;
+    }
+}
+
+TEST(SecondGetIsAHit)
+{
+    removeFiles();
+    FakeCompiler compiler;
+    Sources sources;
+    ShaderCache cache(compiler, STORE, 0);
+    cache.setReader(sources.get());
+
+    std::string first, second;
+    CHECK(get(cache, forward(), &first));
+    CHECK(get(cache, forward(), &second));
+    CHECK(first == second);
+    CHECK(first == "Shaders/Forward.hlsl:PS:ps_5_0:CLUSTERED=1");
+    CHECK(compiler.compiles == 1);
+    CHECK(cache.getMisses() == 1);
+    CHECK(cache.getHits() == 1);
+    removeFiles();
+}
+
+TEST(EverythingInTheCompileIsInTheKey)
+{
+    removeFiles();
+    FakeCompiler compiler;
+    Sources sources;
+    ShaderCache cache(compiler, STORE, 0), debug(compiler, STORE, 1);
+    cache.setReader(sources.get());
+    debug.setReader(sources.get());
+
+    uint64_t key = cache.computeKey(forward());
+    CHECK(key != 0);
+    CHECK(cache.computeKey(forward()) == key);
+    CHECK(debug.computeKey(forward()) != key);
+
+    ShaderPermutation changed = forward();
+    changed.entry = "PS2";
+    CHECK(cache.computeKey(changed) != key);
+    changed = forward();
+    changed.profile = "ps_5_1";
+    CHECK(cache.computeKey(changed) != key);
+    changed = forward();
+    changed.defines[0].second = "0";
+    CHECK(cache.computeKey(changed) != key);
+    changed = forward();
+    changed.defines.clear();
+    CHECK(cache.computeKey(changed) != key);
+
+    // the source and the includes of includes, the include cycle doesn't hang
+    sources.files["Shaders/Common/Math.hlsl"] += "// a comment\n";
+    uint64_t edited = cache.computeKey(forward());
+    CHECK(edited != key);
+    sources.files["Shaders/Forward.hlsl"] += "\n";
+    CHECK(cache.computeKey(forward()) != edited);
+
+    // a missing include changes the key when it shows up
+    sources.files["Shaders/Forward.hlsl"] = "#include \"Shadows.hlsl\"\n";
+    uint64_t missing = cache.computeKey(forward());
+    sources.files["Shaders/Shadows.hlsl"] = "float shadow;\n";
+    CHECK(cache.computeKey(forward()) != missing);
+
+    // no source, no key
+    sources.files.erase("Shaders/Forward.hlsl");
+    CHECK(cache.computeKey(forward()) == 0);
+    removeFiles();
+}
+
+TEST(StoreSurvivesARestart)
+{
+    removeFiles();
+    FakeCompiler compiler;
+    Sources sources;
+    {
+        ShaderCache cache(compiler, STORE, 0);
+        cache.setReader(sources.get());
+        CHECK(get(cache, forward()));
+        ShaderPermutation vertex = { "Shaders/Forward.hlsl", "VS", "vs_5_0", {} };
+        CHECK(get(cache, vertex));
+    }
+    CHECK(compiler.compiles == 2);
+
+    ShaderCache cache(compiler, STORE, 0);
+    cache.setReader(sources.get());
+    std::string code;
+    CHECK(get(cache, forward(), &code));
+    CHECK(code == "Shaders/Forward.hlsl:PS:ps_5_0:CLUSTERED=1");
+    CHECK(compiler.compiles == 2);
+    CHECK(cache.getHits() == 1);
+
+    // other flags are other bytecode
+    ShaderCache debug(compiler, STORE, 1);
+    debug.setReader(sources.get());
+    CHECK(get(debug, forward()));
+    CHECK(compiler.compiles == 3);
+    removeFiles();
+}
+
+TEST(StoreCutShortKeepsWhatCameBefore)
+{
+    removeFiles();
+    FakeCompiler compiler;
+    Sources sources;
+    ShaderPermutation vertex = { "Shaders/Forward.hlsl", "VS", "vs_5_0", {} };
+    {
+        ShaderCache cache(compiler, STORE, 0);
+        cache.setReader(sources.get());
+        get(cache, forward());
+        get(cache, vertex);
+    }
+
+    // a crash in the middle of the second record
+    std::string store;
+    {
+        std::ifstream file(STORE, std::ios::binary);
+        store.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(STORE, std::ios::binary | std::ios::trunc);
+        file.write(store.data(), store.size() - 5);
+    }
+
+    compiler.compiles = 0;
+    {
+        ShaderCache cache(compiler, STORE, 0);
+        cache.setReader(sources.get());
+        CHECK(get(cache, forward()));
+        CHECK(compiler.compiles == 0);
+        CHECK(get(cache, vertex));
+        CHECK(compiler.compiles == 1);
+    }
+
+    // the one compiled again was appended after a whole record
+    ShaderCache cache(compiler, STORE, 0);
+    cache.setReader(sources.get());
+    CHECK(get(cache, forward()));
+    CHECK(get(cache, vertex));
+    CHECK(compiler.compiles == 1);
+
+    // another version or garbage is started over
+    {
+        std::ofstream file(STORE, std::ios::binary | std::ios::trunc);
+        file << "not a shader cache";
+    }
+    ShaderCache garbage(compiler, STORE, 0);
+    garbage.setReader(sources.get());
+    CHECK(get(garbage, forward()));
+    CHECK(compiler.compiles == 2);
+    removeFiles();
+}
+
+TEST(FailedCompilesArentCached)
+{
+    removeFiles();
+    FakeCompiler compiler;
+    Sources sources;
+    ShaderCache cache(compiler, STORE, 0);
+    cache.setReader(sources.get());
+
+    ShaderPermutation broken = forward();
+    broken.entry = "Broken";
+    std::vector<char> bytecode;
+    std::string errors;
+    CHECK(!cache.get(broken, bytecode, errors));
+    CHECK(errors.find("X3000") != std::string::npos);
+    CHECK(!cache.get(broken, bytecode, errors));
+    CHECK(compiler.compiles == 2);
+
+    // a source that can't be read is left to the compiler every time
+    sources.files.erase("Shaders/Forward.hlsl");
+    CHECK(get(cache, forward()));
+    CHECK(get(cache, forward()));
+    CHECK(compiler.compiles == 4);
+    removeFiles();
+}
+
+TEST(PackHasEverythingTheStoreAskedFor)
+{
+    removeFiles();
+    FakeCompiler compiler;
+    Sources sources;
+    ShaderPermutation vertex = { "Shaders/Forward.hlsl", "VS", "vs_5_0", {} };
+    {
+        ShaderCache cache(compiler, STORE, 0);
+        cache.setReader(sources.get());
+        get(cache, forward());
+        get(cache, vertex);
+
+        // the sources changed since, the pack has the current ones
+        sources.files["Shaders/Common/Light.hlsl"] += "float range;\n";
+        std::string errors;
+        CHECK(cache.buildPack(PACK, errors));
+        CHECK(errors.empty());
+        CHECK(compiler.compiles == 4);
+    }
+
+    // a game with only the pack compiles nothing
+    remove(STORE);
+    compiler.compiles = 0;
+    ShaderCache cache(compiler, STORE, 0);
+    cache.setReader([&sources](std::string const & path, std::string & text)
+    {
+        if (path == PACK)
+        {
+            std::ifstream file(PACK, std::ios::binary);
+            text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return true;
+        }
+        return sources.get()(path, text);
+    });
+    CHECK(cache.loadPack(PACK));
+    CHECK(get(cache, forward()));
+    CHECK(get(cache, vertex));
+    CHECK(compiler.compiles == 0);
+    CHECK(!cache.loadPack("missing.pack"));
+
+    // a shader that was deleted since fails the pack, the rest is still in it
+    {
+        ShaderCache store(compiler, STORE, 0);
+        sources.files["Shaders/Other.hlsl"] = "float4 PS() : SV_Target { return 0; }\n";
+        store.setReader(sources.get());
+        ShaderPermutation other = { "Shaders/Other.hlsl", "PS", "ps_5_0", {} };
+        get(store, other);
+        get(store, forward());
+        sources.files.erase("Shaders/Other.hlsl");
+
+        std::string errors;
+        CHECK(!store.buildPack(PACK, errors));
+        CHECK(errors.find("Can't read Shaders/Other.hlsl") != std::string::npos);
+    }
+    compiler.compiles = 0;
+    ShaderCache packed(compiler, "", 0);
+    packed.setReader([](std::string const & path, std::string & text)
+    {
+        std::ifstream file(path, std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return (bool)file;
+    });
+    CHECK(packed.loadPack(PACK));
+    packed.setReader(sources.get());
+    CHECK(get(packed, forward()));
+    CHECK(compiler.compiles == 0);
+    removeFiles();
+}
@@ -0,0 +1,276 @@
+#include <Test.h>
+#include <Lights/ShadowCascades.h>
+#include "Projection.h"
+
+using namespace Graphics;
+
+namespace
+{
+    const float NEAR_Z = 0.1f, FAR_Z = 250.f;
+
+    struct Random
+    {
+        unsigned int state;
+
+        float next(float min, float max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return min + (max - min) * ((state >> 8) / float(1 << 24));
+        }
+    };
+
+    // right handed look at, like SimpleMath's CreateLookAt
+    void lookAt(const float eye[3], const float forward[3], float view[16])
+    {
+        float z[3] = { -forward[0], -forward[1], -forward[2] };
+        float length = sqrtf(z[0] * z[0] + z[1] * z[1] + z[2] * z[2]);
+        for (float & v : z) v /= length;
+
+        float up[3] = { 0.f, 1.f, 0.f };
+        float x[3] = { up[1] * z[2] - up[2] * z[1], up[2] * z[0] - up[0] * z[2], up[0] * z[1] - up[1] * z[0] };
+        length = sqrtf(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+        for (float & v : x) v /= length;
+        float y[3] = { z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0] };
+
+        Projection::identity(view);
+        for (int i = 0; i < 3; i++)
+        {
+            view[i * 4] = x[i];
+            view[i * 4 + 1] = y[i];
+            view[i * 4 + 2] = z[i];
+        }
+        view[12] = -(x[0] * eye[0] + x[1] * eye[1] + x[2] * eye[2]);
+        view[13] = -(y[0] * eye[0] + y[1] * eye[1] + y[2] * eye[2]);
+        view[14] = -(z[0] * eye[0] + z[1] * eye[1] + z[2] * eye[2]);
+    }
+
+    // the world position of a point on the camera's slice at a depth
+    void sliceCorner(const float invView[16], const float proj[16], float ndcX, float ndcY, float depth, float world[3])
+    {
+        float viewPoint[4] = { ndcX * depth / proj[0], ndcY * depth / proj[5], -depth, 1.f };
+        float out[4];
+        Projection::transform(viewPoint, invView, out);
+        for (int i = 0; i < 3; i++)
+            world[i] = out[i];
+    }
+
+    // every corner of every slice is inside its cascade's box
+    int countOutside(ShadowCascades const & cascades, const float view[16], const float proj[16])
+    {
+        float invView[16] = {};
+        if (!Projection::invert(view, invView))
+            return -1;
+
+        int outside = 0;
+        for (uint32_t i = 0; i < cascades.getCascadeCount(); i++)
+        {
+            ShadowCascades::Cascade const & cascade = cascades.getCascade(i);
+            for (float depth : { cascade.nearSplit, cascade.farSplit })
+            {
+                for (float ndcX : { -1.f, 1.f })
+                {
+                    for (float ndcY : { -1.f, 1.f })
+                    {
+                        float world[3];
+                        sliceCorner(invView, proj, ndcX, ndcY, depth, world);
+                        float point[4] = { world[0], world[1], world[2], 1.f }, clip[4];
+                        Projection::transform(point, cascade.viewProjection, clip);
+
+                        const float epsilon = 1e-3f;
+                        outside += fabsf(clip[0]) > 1.f + epsilon || fabsf(clip[1]) > 1.f + epsilon ||
+                            clip[2] < -epsilon || clip[2] > 1.f + epsilon;
+                    }
+                }
+            }
+        }
+        return outside;
+    }
+}
+
+TEST(SplitsBlendUniformAndLogarithmic)
+{
+    float splits[5];
+    ShadowCascades::computeSplits(1.f, 101.f, 4, 0.f, splits);
+    for (int i = 0; i <= 4; i++)
+        CHECK_NEAR(splits[i], 1.f + 25.f * i, 1e-4f);
+
+    ShadowCascades::computeSplits(1.f, 81.f, 4, 1.f, splits);
+    CHECK_NEAR(splits[1], 3.f, 1e-4f);
+    CHECK_NEAR(splits[2], 9.f, 1e-4f);
+    CHECK_NEAR(splits[3], 27.f, 1e-3f);
+    CHECK(splits[4] == 81.f);
+
+    // in between is in between, and always increasing
+    float uniform[5], logarithmic[5];
+    ShadowCascades::computeSplits(0.1f, 100.f, 4, 0.f, uniform);
+    ShadowCascades::computeSplits(0.1f, 100.f, 4, 1.f, logarithmic);
+    ShadowCascades::computeSplits(0.1f, 100.f, 4, 0.75f, splits);
+    CHECK(splits[0] == 0.1f);
+    CHECK(splits[4] == 100.f);
+    for (int i = 1; i < 4; i++)
+    {
+        CHECK(splits[i] > splits[i - 1]);
+        CHECK(splits[i] <= uniform[i]);
+        CHECK(splits[i] >= logarithmic[i]);
+    }
+}
+
+TEST(CascadesCoverTheirSlices)
+{
+    Random random = { 8 };
+    float aspects[] = { 16.f / 9.f, 21.f / 9.f, 4.f / 3.f, 9.f / 16.f };
+
+    for (float aspect : aspects)
+    {
+        for (int round = 0; round < 10; round++)
+        {
+            float proj[16], view[16];
+            Projection::perspective(random.next(0.6f, 1.8f), aspect, NEAR_Z, FAR_Z, proj);
+            float eye[3] = { random.next(-100.f, 100.f), random.next(0.f, 30.f), random.next(-100.f, 100.f) };
+            float forward[3] = { random.next(-1.f, 1.f), random.next(-0.8f, 0.8f), random.next(-1.f, 1.f) };
+            lookAt(eye, forward, view);
+            float light[3] = { random.next(-1.f, 1.f), random.next(-1.f, -0.2f), random.next(-1.f, 1.f) };
+
+            ShadowCascades cascades(4, 2048);
+            cascades.setShadowDistance(random.next(40.f, 150.f));
+            CHECK(cascades.update(view, proj, light, 0) == 0xf);
+            CHECK(countOutside(cascades, view, proj) == 0);
+
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                ShadowCascades::Cascade const & cascade = cascades.getCascade(i);
+                CHECK(cascade.farSplit > cascade.nearSplit);
+                CHECK_NEAR(cascade.texelSize, cascade.radius * 2.f / 2048.f, 1e-6f);
+                if (i > 0)
+                    CHECK(cascade.nearSplit == cascades.getCascade(i - 1).farSplit);
+            }
+        }
+    }
+}
+
+TEST(ShadowDistanceEndsTheLastCascade)
+{
+    float proj[16], view[16];
+    Projection::perspective(1.4f, 16.f / 9.f, NEAR_Z, FAR_Z, proj);
+    Projection::identity(view);
+    float light[3] = { 0.3f, -1.f, 0.2f };
+
+    ShadowCascades cascades(3, 1024);
+    cascades.setShadowDistance(60.f);
+    cascades.update(view, proj, light, 0);
+    CHECK_NEAR(cascades.getCascade(0).nearSplit, NEAR_Z, 1e-4f);
+    CHECK_NEAR(cascades.getCascade(2).farSplit, 60.f, 1e-3f);
+
+    // never past the far plane
+    cascades.setShadowDistance(1000.f);
+    cascades.update(view, proj, light, 0);
+    CHECK_NEAR(cascades.getCascade(2).farSplit, FAR_Z, 0.1f);
+}
+
+TEST(TexelSizeDoesntChangeWhenTurning)
+{
+    float proj[16], view[16];
+    Projection::perspective(1.4f, 16.f / 9.f, NEAR_Z, FAR_Z, proj);
+    float light[3] = { 0.3f, -1.f, 0.2f };
+    float eye[3] = { 10.f, 2.f, -5.f };
+
+    ShadowCascades cascades(4, 2048);
+    float forward[3] = { 1.f, 0.f, 0.f };
+    lookAt(eye, forward, view);
+    cascades.update(view, proj, light, 0);
+    float radius[4];
+    for (uint32_t i = 0; i < 4; i++)
+        radius[i] = cascades.getCascade(i).radius;
+
+    for (int step = 1; step < 36; step++)
+    {
+        float angle = step * 0.17f;
+        float turned[3] = { cosf(angle), sinf(angle) * 0.3f, sinf(angle) };
+        lookAt(eye, turned, view);
+        cascades.update(view, proj, light, 0);
+        for (uint32_t i = 0; i < 4; i++)
+            CHECK(cascades.getCascade(i).radius == radius[i]);
+    }
+}
+
+TEST(CentersSnapToTexels)
+{
+    float proj[16], view[16];
+    Projection::perspective(1.4f, 16.f / 9.f, NEAR_Z, FAR_Z, proj);
+    float light[3] = { 0.3f, -1.f, 0.2f };
+    float forward[3] = { 0.f, 0.f, -1.f };
+
+    ShadowCascades cascades(4, 2048);
+    for (int step = 0; step < 50; step++)
+    {
+        float eye[3] = { step * 0.0137f, 1.f, step * 0.021f };
+        lookAt(eye, forward, view);
+        cascades.update(view, proj, light, 0);
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            ShadowCascades::Cascade const & cascade = cascades.getCascade(i);
+            for (int axis = 0; axis < 2; axis++)
+            {
+                float texels = cascade.center[axis] / cascade.texelSize;
+                CHECK(fabsf(texels - roundf(texels)) < 1e-2f);
+            }
+        }
+    }
+}
+
+TEST(DistantCascadesUpdateLess)
+{
+    float proj[16], view[16];
+    Projection::perspective(1.4f, 16.f / 9.f, NEAR_Z, FAR_Z, proj);
+    Projection::identity(view);
+    float light[3] = { 0.f, -1.f, 0.f };
+
+    ShadowCascades cascades(4, 1024);
+    cascades.setUpdateInterval(2, 2);
+    cascades.setUpdateInterval(3, 4);
+
+    // everything the first time, then staggered
+    CHECK(cascades.update(view, proj, light, 0) == 0xf);
+    int updates[4] = {};
+    for (uint64_t frame = 1; frame <= 16; frame++)
+    {
+        uint32_t updated = cascades.update(view, proj, light, frame);
+        for (int i = 0; i < 4; i++)
+            updates[i] += (updated >> i) & 1;
+    }
+    CHECK(updates[0] == 16);
+    CHECK(updates[1] == 16);
+    CHECK(updates[2] == 8);
+    CHECK(updates[3] == 4);
+}
+
+TEST(CastersAreFoundTowardTheLight)
+{
+    float proj[16], view[16];
+    Projection::perspective(1.4f, 16.f / 9.f, NEAR_Z, FAR_Z, proj);
+    Projection::identity(view);
+    float light[3] = { 0.f, -1.f, 0.f };
+
+    ShadowCascades cascades(4, 1024);
+    cascades.setShadowDistance(80.f);
+    cascades.setCasterDistance(50.f);
+    cascades.update(view, proj, light, 0);
+
+    // in the first slice
+    float near[3] = { 0.f, 0.f, -cascades.getCascade(0).farSplit * 0.5f };
+    CHECK(cascades.getCasterMask(near, 0.5f, 0xf) & 1);
+
+    // above the last slice, outside its box but within the caster distance
+    ShadowCascades::Cascade const & last = cascades.getCascade(3);
+    float above[3] = { 0.f, last.radius + 30.f, -(last.nearSplit + last.farSplit) * 0.5f };
+    CHECK(cascades.getCasterMask(above, 1.f, 0xf) & 8);
+    // only the cascades asked for
+    CHECK((cascades.getCasterMask(above, 1.f, 0x7) & 8) == 0);
+
+    // below the ground can't cast into anything, and behind the camera is too far for the first cascade
+    float below[3] = { 0.f, -last.radius - 10.f, -(last.nearSplit + last.farSplit) * 0.5f };
+    CHECK((cascades.getCasterMask(below, 1.f, 0xf) & 8) == 0);
+    float behind[3] = { 0.f, 0.f, 200.f };
+    CHECK(cascades.getCasterMask(behind, 1.f, 0xf) == 0);
+}
@@ -0,0 +1,246 @@
+#include <Test.h>
+#include <Resources/TextureResidency.h>
+#include <map>
+#include <set>
+
+using namespace Graphics;
+
+namespace
+{
+    // every texture is 100 bytes, "missing" ones can't be loaded
+    struct FakeLoader : TextureResidency::Loader
+    {
+        std::set<std::string *> loaded;
+        std::map<std::string, int> loads;
+
+        void * load(std::string const & path, uint64_t & bytes) override
+        {
+            if (path.find("missing") != std::string::npos)
+                return nullptr;
+
+            loads[path]++;
+            bytes = 100;
+            std::string * texture = new std::string(path);
+            loaded.insert(texture);
+            return texture;
+        }
+
+        void unload(void * texture) override
+        {
+            loaded.erase((std::string *)texture);
+            delete (std::string *)texture;
+        }
+
+        int getLoadCount() const
+        {
+            int count = 0;
+            for (auto const & load : loads)
+                count += load.second;
+            return count;
+        }
+    };
+
+    struct Menu
+    {
+        TextureResidency::Handle menu[3], hud[3];
+
+        Menu(TextureResidency & residency)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                menu[i] = residency.add("menu" + std::to_string(i) + ".png", TextureResidency::SCOPE_MENU);
+                hud[i] = residency.add("hud" + std::to_string(i) + ".png", TextureResidency::SCOPE_HUD);
+            }
+        }
+
+        // a frame of drawing what the scope has
+        void draw(TextureResidency & residency, const TextureResidency::Handle * handles)
+        {
+            residency.beginFrame();
+            for (int i = 0; i < 3; i++)
+                CHECK(residency.get(handles[i]) != nullptr);
+        }
+    };
+}
+
+TEST(ActiveScopesAreLoaded)
+{
+    FakeLoader loader;
+    TextureResidency residency(loader, 10000);
+    Menu menu(residency);
+    CHECK(loader.loaded.empty());
+
+    residency.setActiveScopes(TextureResidency::SCOPE_MENU);
+    CHECK(residency.getActiveScopes() == TextureResidency::SCOPE_MENU);
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(residency.isResident(menu.menu[i]));
+        CHECK(!residency.isResident(menu.hud[i]));
+    }
+    CHECK(residency.getStats().residentCount == 3);
+    CHECK(residency.getStats().residentBytes == 300);
+
+    menu.draw(residency, menu.menu);
+    CHECK(residency.getStats().hits == 3);
+    CHECK(residency.getStats().misses == 0);
+    CHECK(*(std::string *)residency.get(menu.menu[1]) == "menu1.png");
+
+    // added to a scope already drawn is loaded right away, the same path is the same texture
+    TextureResidency::Handle button = residency.add("button.png", TextureResidency::SCOPE_MENU);
+    CHECK(residency.isResident(button));
+    CHECK(residency.add("hud0.png", TextureResidency::SCOPE_MENU) == menu.hud[0]);
+    CHECK(residency.isResident(menu.hud[0]));
+}
+
+TEST(TexturesStayAcrossStateChanges)
+{
+    FakeLoader loader;
+    TextureResidency residency(loader, 10000);
+    Menu menu(residency);
+
+    // menu, game, menu, game again: everything is loaded once
+    for (int round = 0; round < 3; round++)
+    {
+        residency.setActiveScopes(TextureResidency::SCOPE_MENU);
+        menu.draw(residency, menu.menu);
+        residency.setActiveScopes(TextureResidency::SCOPE_HUD | TextureResidency::SCOPE_GAME);
+        menu.draw(residency, menu.hud);
+    }
+
+    CHECK(loader.getLoadCount() == 6);
+    CHECK(residency.getStats().evictions == 0);
+    CHECK(residency.getStats().misses == 0);
+    CHECK(residency.getStats().hits == 18);
+}
+
+TEST(LeastRecentlyUsedGoFirst)
+{
+    FakeLoader loader;
+    TextureResidency residency(loader, 400);
+    Menu menu(residency);
+
+    residency.setActiveScopes(TextureResidency::SCOPE_MENU);
+    residency.beginFrame();
+    residency.get(menu.menu[2]);
+    residency.beginFrame();
+    residency.get(menu.menu[0]);
+    residency.beginFrame();
+    residency.get(menu.menu[1]);
+
+    // the hud needs 300 of the 400, one menu texture fits. menu1 was used last
+    residency.setActiveScopes(TextureResidency::SCOPE_HUD);
+    residency.beginFrame();
+    residency.beginFrame();
+    CHECK(residency.getStats().residentBytes <= 400);
+    CHECK(residency.getStats().evictions == 2);
+    CHECK(!residency.isResident(menu.menu[2]));
+    CHECK(!residency.isResident(menu.menu[0]));
+    CHECK(residency.isResident(menu.menu[1]));
+    for (int i = 0; i < 3; i++)
+        CHECK(residency.isResident(menu.hud[i]));
+
+    // asked for anyway, it's loaded again and something else has to go
+    CHECK(residency.get(menu.menu[0]) != nullptr);
+    CHECK(residency.getStats().misses == 1);
+    CHECK(loader.loads["menu0.png"] == 2);
+}
+
+TEST(ActiveScopesAreNeverEvicted)
+{
+    FakeLoader loader;
+    TextureResidency residency(loader, 150);
+    Menu menu(residency);
+
+    // needs 300 with a budget of 150, it's over and stays drawable
+    residency.setActiveScopes(TextureResidency::SCOPE_MENU);
+    menu.draw(residency, menu.menu);
+    menu.draw(residency, menu.menu);
+    CHECK(residency.getStats().residentBytes == 300);
+    CHECK(residency.getStats().evictions == 0);
+
+    // what isn't active goes as soon as it can
+    residency.setActiveScopes(TextureResidency::SCOPE_HUD);
+    residency.beginFrame();
+    residency.beginFrame();
+    for (int i = 0; i < 3; i++)
+        CHECK(!residency.isResident(menu.menu[i]));
+
+    residency.setBudget(0);
+    CHECK(residency.getBudget() == 0);
+    for (int i = 0; i < 3; i++)
+        CHECK(residency.isResident(menu.hud[i]));
+}
+
+TEST(PreloadedTexturesAreReadyWhenDrawn)
+{
+    FakeLoader loader;
+    TextureResidency residency(loader, 300);
+    Menu menu(residency);
+
+    residency.setActiveScopes(TextureResidency::SCOPE_MENU);
+    menu.draw(residency, menu.menu);
+
+    // during the transition, the hud is loaded before it's drawn and isn't evicted right away
+    residency.preload(TextureResidency::SCOPE_HUD);
+    CHECK(residency.getStats().preloads == 6);
+    for (int i = 0; i < 3; i++)
+        CHECK(residency.isResident(menu.hud[i]));
+    residency.beginFrame();
+    for (int i = 0; i < 3; i++)
+        CHECK(residency.isResident(menu.hud[i]));
+
+    residency.resetStats();
+    residency.setActiveScopes(TextureResidency::SCOPE_HUD);
+    menu.draw(residency, menu.hud);
+    CHECK(residency.getStats().misses == 0);
+    CHECK(residency.getStats().hits == 3);
+    CHECK(residency.getStats().residentBytes <= 300);
+    CHECK(residency.getStats().peakBytes >= residency.getStats().residentBytes);
+}
+
+TEST(FailedTexturesArentTriedEveryFrame)
+{
+    FakeLoader loader;
+    TextureResidency residency(loader, 10000);
+    TextureResidency::Handle missing = residency.add("missing.png", TextureResidency::SCOPE_MENU);
+
+    residency.setActiveScopes(TextureResidency::SCOPE_MENU);
+    CHECK(!residency.isResident(missing));
+    for (int frame = 0; frame < 10; frame++)
+    {
+        residency.beginFrame();
+        CHECK(residency.get(missing) == nullptr);
+    }
+    CHECK(residency.getStats().failures == 1);
+
+    CHECK(residency.get(12345) == nullptr);
+    CHECK(!residency.isResident(12345));
+
+    // unloadAll tries again
+    residency.unloadAll();
+    CHECK(residency.get(missing) == nullptr);
+    CHECK(residency.getStats().failures == 2);
+}
+
+TEST(EverythingIsUnloaded)
+{
+    FakeLoader loader;
+    {
+        TextureResidency residency(loader, 10000);
+        Menu menu(residency);
+        residency.setActiveScopes(TextureResidency::SCOPE_MENU | TextureResidency::SCOPE_HUD);
+        CHECK(loader.loaded.size() == 6);
+
+        residency.unloadAll();
+        CHECK(loader.loaded.empty());
+        CHECK(residency.getStats().residentCount == 0);
+        CHECK(residency.getStats().residentBytes == 0);
+
+        // loaded again when asked for
+        CHECK(residency.get(menu.menu[0]) != nullptr);
+        CHECK(loader.loaded.size() == 1);
+    }
+
+    // and by the destructor
+    CHECK(loader.loaded.empty());
+}
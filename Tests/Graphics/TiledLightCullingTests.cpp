@@ -0,0 +1,276 @@
+#include <Test.h>
+#include <Lights/TiledLightCulling.h>
+#include "Projection.h"
+#include <algorithm>
+
+using namespace Graphics;
+
+namespace
+{
+    const float NEAR_Z = 0.1f, FAR_Z = 100.f;
+
+    struct Random
+    {
+        unsigned int state;
+
+        float next(float min, float max)
+        {
+            state = state * 1664525u + 1013904223u;
+            return min + (max - min) * ((state >> 8) / float(1 << 24));
+        }
+    };
+
+    struct View
+    {
+        uint32_t width, height;
+        float proj[16], invProj[16], view[16];
+        std::vector<float> depth;
+
+        View(uint32_t width, uint32_t height, float fieldOfView = 1.4f) :
+            width(width), height(height), depth(width * height, 1.f)
+        {
+            Projection::perspective(fieldOfView, width / (float)height, NEAR_Z, FAR_Z, proj);
+            Projection::invert(proj, invProj);
+            Projection::identity(view);
+        }
+
+        // a floor going away from the camera with random boxes standing in front of it
+        void fillScene(Random & random)
+        {
+            for (uint32_t y = 0; y < height; y++)
+            {
+                float z = -(5.f + 60.f * (1.f - y / (float)height));
+                for (uint32_t x = 0; x < width; x++)
+                    depth[x + y * width] = Projection::depthOf(proj, z);
+            }
+
+            for (int box = 0; box < 12; box++)
+            {
+                uint32_t x0 = (uint32_t)random.next(0.f, (float)width), y0 = (uint32_t)random.next(0.f, (float)height);
+                uint32_t x1 = std::min(width, x0 + (uint32_t)random.next(8.f, 120.f));
+                uint32_t y1 = std::min(height, y0 + (uint32_t)random.next(8.f, 120.f));
+                float d = Projection::depthOf(proj, -random.next(1.f, 30.f));
+                for (uint32_t y = y0; y < y1; y++)
+                    for (uint32_t x = x0; x < x1; x++)
+                        depth[x + y * width] = std::min(depth[x + y * width], d);
+            }
+        }
+    };
+
+    bool inTile(TiledLightCuller const & culler, std::vector<uint32_t> const & grid, std::vector<uint32_t> const & list, uint32_t tile, uint32_t light)
+    {
+        uint32_t offset = grid[tile * 2], count = std::min(grid[tile * 2 + 1], TiledLightCuller::MAX_TILE_LIGHTS);
+        return std::find(list.begin() + offset, list.begin() + offset + count, light) != list.begin() + offset + count;
+    }
+
+    /*
+        Every pixel a light reaches has the light in its tile, the culling
+        may only be too generous. Checks every pixel against every light.
+    */
+    void checkConservative(View const & view, uint32_t blockSize, std::vector<TiledLightCuller::CullLight> const & lights)
+    {
+        TiledLightCuller culler(view.width, view.height, blockSize);
+        culler.buildFrustums(view.invProj);
+        culler.cull(view.view, view.invProj, view.depth.data(), lights.data(), lights.size());
+
+        int missing = 0, reached = 0;
+        for (uint32_t y = 0; y < view.height; y++)
+        {
+            for (uint32_t x = 0; x < view.width; x++)
+            {
+                float d = view.depth[x + y * view.width];
+                if (d == 1.f)
+                    continue;
+
+                float position[3];
+                Projection::unproject(view.invProj, x + 0.5f, y + 0.5f, (float)view.width, (float)view.height, d, position);
+                uint32_t tile = x / blockSize + y / blockSize * culler.getTilesX();
+
+                for (uint32_t i = 0; i < lights.size(); i++)
+                {
+                    float dx = position[0] - lights[i].position[0];
+                    float dy = position[1] - lights[i].position[1];
+                    float dz = position[2] - lights[i].position[2];
+                    if (dx * dx + dy * dy + dz * dz >= lights[i].range * lights[i].range)
+                        continue;
+
+                    reached++;
+                    missing += !inTile(culler, culler.getOpaqueGrid(), culler.getOpaqueIndexList(), tile, i);
+                    missing += !inTile(culler, culler.getTransparentGrid(), culler.getTransparentIndexList(), tile, i);
+                }
+            }
+        }
+
+        CHECK(reached > 0);
+        CHECK(missing == 0);
+    }
+
+    std::vector<TiledLightCuller::CullLight> randomLights(Random & random, size_t count, float maxRange)
+    {
+        std::vector<TiledLightCuller::CullLight> lights(count);
+        for (TiledLightCuller::CullLight & light : lights)
+        {
+            light.position[0] = random.next(-40.f, 40.f);
+            light.position[1] = random.next(-10.f, 20.f);
+            light.position[2] = random.next(-70.f, 5.f);
+            light.range = random.next(0.5f, maxRange);
+        }
+        return lights;
+    }
+}
+
+TEST(RandomLightsReachOnlyTheirTiles)
+{
+    Random random = { 42 };
+    for (int round = 0; round < 4; round++)
+    {
+        View view(320, 180);
+        view.fillScene(random);
+        checkConservative(view, 16, randomLights(random, 64, 8.f));
+    }
+}
+
+TEST(OddResolutionsAndBlockSizes)
+{
+    // the last row and column of tiles hang over the edge of the screen
+    Random random = { 7 };
+    uint32_t sizes[][3] = { { 333, 101, 16 }, { 200, 200, 8 }, { 97, 250, 32 }, { 64, 48, 5 } };
+    for (auto const & size : sizes)
+    {
+        View view(size[0], size[1], random.next(0.6f, 1.8f));
+        view.fillScene(random);
+        checkConservative(view, size[2], randomLights(random, 32, 6.f));
+
+        TiledLightCuller culler(size[0], size[1], size[2]);
+        CHECK(culler.getTilesX() * size[2] >= size[0]);
+        CHECK((culler.getTilesX() - 1) * size[2] < size[0]);
+        CHECK(culler.getTilesY() * size[2] >= size[1]);
+    }
+}
+
+TEST(LightsOnTileEdges)
+{
+    // centered exactly on the corners between tiles, a tiny range and a huge one
+    View view(256, 256);
+    Random random = { 3 };
+    view.fillScene(random);
+
+    std::vector<TiledLightCuller::CullLight> lights;
+    for (int y = 1; y < 4; y++)
+    {
+        for (int x = 1; x < 4; x++)
+        {
+            float position[3];
+            Projection::unproject(view.invProj, x * 64.f, y * 64.f, 256.f, 256.f, Projection::depthOf(view.proj, -10.f), position);
+            lights.push_back({ { position[0], position[1], position[2] }, 0.05f });
+            lights.push_back({ { position[0], position[1], position[2] }, 50.f });
+        }
+    }
+    checkConservative(view, 16, lights);
+}
+
+TEST(LightsOutsideTheViewAreCulled)
+{
+    View view(160, 160);
+    Random random = { 11 };
+    view.fillScene(random);
+
+    std::vector<TiledLightCuller::CullLight> lights = {
+        { { 0.f, 0.f, 10.f }, 2.f },       // behind the camera
+        { { 0.f, 0.f, -500.f }, 10.f },    // behind everything drawn
+        { { 500.f, 0.f, -10.f }, 10.f },   // far to the side
+        { { 0.f, 0.f, -10.f }, 0.f },      // no range
+    };
+
+    TiledLightCuller culler(160, 160, 16);
+    culler.buildFrustums(view.invProj);
+    culler.cull(view.view, view.invProj, view.depth.data(), lights.data(), lights.size());
+    CHECK(culler.getOpaqueIndexList().empty());
+    CHECK(culler.getTransparentIndexList().empty());
+}
+
+TEST(EmptyTilesGetNoLights)
+{
+    // nothing drawn, every tile's depth range is just the near plane. Only a light around the camera reaches that
+    View view(128, 64);
+    std::vector<TiledLightCuller::CullLight> lights = { { { 0.f, 0.f, -50.f }, 30.f }, { { 2.f, 1.f, -5.f }, 4.f } };
+
+    TiledLightCuller culler(128, 64, 16);
+    culler.buildFrustums(view.invProj);
+    culler.cull(view.view, view.invProj, view.depth.data(), lights.data(), lights.size());
+    for (uint32_t tile = 0; tile < culler.getTilesX() * culler.getTilesY(); tile++)
+        CHECK(culler.getOpaqueGrid()[tile * 2 + 1] == 0);
+}
+
+TEST(GridRangesFollowEachOther)
+{
+    View view(200, 120);
+    Random random = { 5 };
+    view.fillScene(random);
+    std::vector<TiledLightCuller::CullLight> lights = randomLights(random, 200, 10.f);
+
+    TiledLightCuller culler(200, 120, 16);
+    culler.buildFrustums(view.invProj);
+    culler.cull(view.view, view.invProj, view.depth.data(), lights.data(), lights.size());
+
+    // row order, no gaps, and the lights in light order
+    std::vector<uint32_t> const & grid = culler.getOpaqueGrid();
+    std::vector<uint32_t> const & list = culler.getOpaqueIndexList();
+    uint32_t next = 0;
+    for (uint32_t tile = 0; tile < culler.getTilesX() * culler.getTilesY(); tile++)
+    {
+        CHECK(grid[tile * 2] == next);
+        for (uint32_t i = 1; i < grid[tile * 2 + 1]; i++)
+            CHECK(list[next + i - 1] < list[next + i]);
+        next += grid[tile * 2 + 1];
+    }
+    CHECK(next == list.size());
+
+    // transparent tiles have everything the opaque ones have
+    for (uint32_t tile = 0; tile < culler.getTilesX() * culler.getTilesY(); tile++)
+        CHECK(culler.getTransparentGrid()[tile * 2 + 1] >= grid[tile * 2 + 1]);
+}
+
+TEST(FullTilesKeepTheCount)
+{
+    // more lights than groupshared memory holds, all of them in every tile
+    View view(64, 64);
+    for (float & d : view.depth)
+        d = Projection::depthOf(view.proj, -10.f);
+
+    std::vector<TiledLightCuller::CullLight> lights(TiledLightCuller::MAX_TILE_LIGHTS + 100, { { 0.f, 0.f, -10.f }, 100.f });
+    TiledLightCuller culler(64, 64, 16);
+    culler.buildFrustums(view.invProj);
+    culler.cull(view.view, view.invProj, view.depth.data(), lights.data(), lights.size());
+
+    std::vector<uint32_t> const & grid = culler.getOpaqueGrid();
+    std::vector<uint32_t> const & list = culler.getOpaqueIndexList();
+    CHECK(grid[1] == lights.size());
+    CHECK(list[TiledLightCuller::MAX_TILE_LIGHTS - 1] == TiledLightCuller::MAX_TILE_LIGHTS - 1);
+    // what the GPU leaves undefined
+    CHECK(list[TiledLightCuller::MAX_TILE_LIGHTS] == UINT32_MAX);
+    CHECK(grid[2] == lights.size());
+}
+
+TEST(FrustumPlanesFaceIn)
+{
+    // the center of every tile at any depth is inside all four planes
+    View view(300, 200);
+    TiledLightCuller culler(300, 200, 16);
+    culler.buildFrustums(view.invProj);
+
+    for (uint32_t y = 0; y < culler.getTilesY(); y++)
+    {
+        for (uint32_t x = 0; x < culler.getTilesX(); x++)
+        {
+            float center[3];
+            Projection::unproject(view.invProj, (x + 0.5f) * 16.f, (y + 0.5f) * 16.f, 300.f, 200.f, 0.9f, center);
+            TiledLightCuller::CullFrustum const & frustum = culler.getFrustums()[x + y * culler.getTilesX()];
+            for (int i = 0; i < 4; i++)
+            {
+                TiledLightCuller::CullPlane const & plane = frustum.planes[i];
+                CHECK(plane.nx * center[0] + plane.ny * center[1] + plane.nz * center[2] >= 0.f);
+            }
+        }
+    }
+}
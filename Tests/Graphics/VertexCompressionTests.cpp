@@ -0,0 +1,240 @@
+#include <Test.h>
+#include <Resources/VertexCompression.h>
+#include <Resources/BRFImportHandler.h>
+#include <Engine/Constants.h>
+#include <math.h>
+#include <stddef.h>
+#include <vector>
+
+using namespace Graphics;
+
+/*
+    What getCompressionErrorBound promises has to hold for every model the
+    game ships, and for vertices that are worse than those: random
+    directions, big boxes and UVs far outside [0, 1].
+*/
+
+namespace
+{
+    struct Random
+    {
+        uint32_t state;
+        float next() { state = state * 1664525u + 1013904223u; return (state >> 8) / 16777216.f; }
+        float range(float low, float high) { return low + (high - low) * next(); }
+    };
+
+    void randomDirection(Random & random, float direction[3])
+    {
+        float l;
+        do
+        {
+            direction[0] = random.range(-1.f, 1.f);
+            direction[1] = random.range(-1.f, 1.f);
+            direction[2] = random.range(-1.f, 1.f);
+            l = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+        } while (l < 0.1f || l > 1.f);
+
+        for (int i = 0; i < 3; i++)
+            direction[i] /= l;
+    }
+
+    float angle(float const a[3], float const b[3])
+    {
+        float cross[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+        return atan2f(sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]), a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+    }
+
+    void findBounds(FloatVertex const * vertices, size_t count, float low[3], float high[3])
+    {
+        for (int axis = 0; axis < 3; axis++)
+            low[axis] = high[axis] = vertices[0].position[axis];
+        for (size_t i = 1; i < count; i++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                low[axis] = fminf(low[axis], vertices[i].position[axis]);
+                high[axis] = fmaxf(high[axis], vertices[i].position[axis]);
+            }
+        }
+    }
+
+    bool withinBound(VertexCompressionError const & error, VertexCompressionError const & bound)
+    {
+        return error.position <= bound.position && error.normal <= bound.normal && error.tangent <= bound.tangent &&
+            error.biTangent <= bound.biTangent && error.uv <= bound.uv;
+    }
+
+    const char * MODELS[] = {
+        "CrossBow.brf", "ammoBox.brf", "bushgreen.brf", "cuttlery.brf", "enemyGrunt.brf", "grapplePoint.brf", "grass.brf",
+        "jumpPad.brf", "kub.brf", "kub2.brf", "kubenmedtextur.brf", "kubfixadtextur.brf", "sphere.brf"
+    };
+}
+
+TEST(layoutMatchesTheShader)
+{
+    // Vertex.hlsl and COMPRESSED_VERTEX_DESC expect it packed like this
+    CHECK(sizeof(CompressedVertex) == 24);
+    CHECK(sizeof(FloatVertex) == 48);
+    CHECK(offsetof(FloatVertex, tangent) == 40);
+}
+
+TEST(everyHalfRoundTrips)
+{
+    for (uint32_t bits = 0; bits < 0x10000; bits++)
+    {
+        uint16_t half = (uint16_t)bits;
+        bool nan = (half & 0x7c00) == 0x7c00 && (half & 0x3ff);
+        if (nan)
+            CHECK(halfToFloat(half) != halfToFloat(half));
+        else
+            CHECK(floatToHalf(halfToFloat(half)) == half);
+    }
+}
+
+TEST(halfRoundsToNearestEven)
+{
+    CHECK(floatToHalf(1.f) == 0x3c00);
+    CHECK(floatToHalf(1.f + 1.f / 2048.f) == 0x3c00);             // halfway, down to even
+    CHECK(floatToHalf(1.f + 3.f / 2048.f) == 0x3c02);             // halfway, up to even
+    CHECK(floatToHalf(1.f + 1.f / 2048.f + 1.f / 65536.f) == 0x3c01);
+    CHECK(floatToHalf(-2.f) == 0xc000);
+    CHECK(floatToHalf(65504.f) == 0x7bff);
+    CHECK(floatToHalf(65520.f) == 0x7c00);                        // rounds past the largest, infinity
+    CHECK(floatToHalf(1e10f) == 0x7c00);
+    CHECK(floatToHalf(1e-10f) == 0);
+    CHECK(floatToHalf(-1e-10f) == 0x8000);
+    CHECK(halfToFloat(0x0001) == 1.f / 16777216.f);               // smallest subnormal
+}
+
+TEST(octahedralStaysWithinTheBound)
+{
+    FloatVertex zero = {};
+    VertexCompressionError bound = getCompressionErrorBound(&zero, 1, zero.position, zero.position);
+
+    Random random = { 7 };
+    float worst = 0.f;
+    for (int i = 0; i < 200000; i++)
+    {
+        float direction[3], decoded[3];
+        int16_t encoded[2];
+        randomDirection(random, direction);
+        encodeOctahedral(direction, encoded);
+        decodeOctahedral(encoded, decoded);
+        worst = fmaxf(worst, angle(direction, decoded));
+    }
+    printf("    worst of 200000 directions: %g rad, bound %g\n", worst, bound.normal);
+    CHECK(worst <= bound.normal);
+
+    // the axes are exact, the fold has to get the lower half right too
+    float axes[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    for (auto & axis : axes)
+    {
+        float decoded[3];
+        int16_t encoded[2];
+        encodeOctahedral(axis, encoded);
+        decodeOctahedral(encoded, decoded);
+        CHECK_NEAR(decoded[0], axis[0], 1e-6f);
+        CHECK_NEAR(decoded[1], axis[1], 1e-6f);
+        CHECK_NEAR(decoded[2], axis[2], 1e-6f);
+    }
+}
+
+TEST(zeroDirectionIsUp)
+{
+    float zero[3] = { 0.f, 0.f, 0.f }, decoded[3];
+    int16_t encoded[2];
+    encodeOctahedral(zero, encoded);
+    decodeOctahedral(encoded, decoded);
+    CHECK_NEAR(decoded[2], 1.f, 1e-6f);
+}
+
+TEST(randomVerticesStayWithinTheBound)
+{
+    Random random = { 42 };
+    for (int mesh = 0; mesh < 20; mesh++)
+    {
+        // from a tiny mesh far from the origin to a big one around it
+        float size = powf(10.f, random.range(-2.f, 3.f));
+        float offset = random.range(-1000.f, 1000.f);
+        float uvRange = powf(2.f, random.range(0.f, 6.f));
+
+        std::vector<FloatVertex> vertices(2000);
+        for (FloatVertex & vertex : vertices)
+        {
+            for (int axis = 0; axis < 3; axis++)
+                vertex.position[axis] = offset + random.range(0.f, size);
+            randomDirection(random, vertex.normal);
+
+            // the tangents only have x and y
+            float direction[3];
+            randomDirection(random, direction);
+            vertex.tangent[0] = direction[0] * 0.99f;
+            vertex.tangent[1] = direction[1] * 0.99f;
+            randomDirection(random, direction);
+            vertex.biTangent[0] = direction[0] * 0.99f;
+            vertex.biTangent[1] = direction[1] * 0.99f;
+
+            vertex.uv[0] = random.range(-uvRange, uvRange);
+            vertex.uv[1] = random.range(-uvRange, uvRange);
+        }
+
+        float low[3], high[3];
+        findBounds(vertices.data(), vertices.size(), low, high);
+        VertexCompressionError error = measureCompressionError(vertices.data(), (uint32_t)vertices.size(), low, high);
+        VertexCompressionError bound = getCompressionErrorBound(vertices.data(), (uint32_t)vertices.size(), low, high);
+        CHECK(withinBound(error, bound));
+        if (!withinBound(error, bound))
+            printf("    mesh %d: position %g (%g), normal %g, tangent %g, bitangent %g (%g), uv %g (%g)\n", mesh,
+                error.position, bound.position, error.normal, error.tangent, error.biTangent, bound.normal, error.uv, bound.uv);
+    }
+}
+
+TEST(decompressedPositionsAreInTheBox)
+{
+    FloatVertex vertices[2] = {};
+    vertices[0].position[0] = -1.f;
+    vertices[1].position[0] = 3.f;
+    vertices[1].position[1] = 0.5f;
+    float low[3] = { -1.f, 0.f, 0.f }, high[3] = { 3.f, 0.5f, 0.f };
+
+    CompressedVertex compressed[2];
+    compressVertices(vertices, 2, low, high, compressed);
+    CHECK(compressed[0].position[0] == 0);
+    CHECK(compressed[1].position[0] == 65535);
+    CHECK(compressed[1].position[1] == 65535);
+    CHECK(compressed[1].position[2] == 0);     // a flat box doesn't divide by zero
+    CHECK(compressed[1].position[3] == 0);
+
+    FloatVertex decompressed = decompressVertex(compressed[1], low, high);
+    CHECK(decompressed.position[0] == 3.f);
+    CHECK(decompressed.position[1] == 0.5f);
+    CHECK(decompressed.position[2] == 0.f);
+}
+
+TEST(everyModelStaysWithinTheBound)
+{
+    static_assert(sizeof(Vertex) == sizeof(FloatVertex), "Vertex has the layout of FloatVertex");
+
+    for (const char * name : MODELS)
+    {
+        BRFImportHandler::Model model;
+        REQUIRE(BRFImportHandler::decodeFile(std::string(MODEL_PATH_STR("")) + name, true, false, false, model));
+        REQUIRE(!model.meshes.empty());
+
+        for (auto const & mesh : model.meshes)
+        {
+            FloatVertex const * vertices = (FloatVertex const *)mesh.vertices.data();
+            uint32_t count = (uint32_t)mesh.vertices.size();
+            REQUIRE(count > 0);
+
+            // the same box MeshManager gives the mesh
+            float low[3], high[3];
+            findBounds(vertices, count, low, high);
+            VertexCompressionError error = measureCompressionError(vertices, count, low, high);
+            VertexCompressionError bound = getCompressionErrorBound(vertices, count, low, high);
+            printf("    %-20s position %.2g (%.2g), directions %.2g (%.2g), uv %.2g (%.2g)\n", name, error.position, bound.position,
+                fmaxf(error.normal, fmaxf(error.tangent, error.biTangent)), bound.normal, error.uv, bound.uv);
+            CHECK(withinBound(error, bound));
+        }
+    }
+}
@@ -0,0 +1,190 @@
+#include <Test.h>
+#include <Graphics/include/Resources/VirtualFileSystem.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <stdio.h>
+
+using namespace Graphics;
+namespace fs = std::filesystem;
+
+namespace
+{
+    const char ARCHIVE[] = "VirtualFileSystemTests.pak";
+    const char LOOSE[] = "VirtualFileSystemTests.lw";
+
+    std::vector<char> toBytes(std::string const & text)
+    {
+        return std::vector<char>(text.begin(), text.end());
+    }
+
+    bool writeFile(std::string const & path, std::vector<char> const & bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        return file && file.write(bytes.data(), bytes.size());
+    }
+
+    bool readFile(fs::path const & path, std::vector<char> & bytes)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // an archive with one file only it has and one that is also loose
+    bool writeArchive()
+    {
+        std::vector<AssetArchive::Input> inputs =
+        {
+            { "Packed/Data/only.lw", toBytes("in the archive only\n"), true },
+            { LOOSE, toBytes("packed version\n"), true },
+        };
+        std::vector<char> bytes;
+        std::string errors;
+        return AssetArchive::build(inputs, 16, bytes, errors) && writeFile(ARCHIVE, bytes);
+    }
+}
+
+TEST(ArchiveFilesAreRead)
+{
+    REQUIRE(writeArchive());
+    REQUIRE(writeFile(LOOSE, toBytes("loose version\n")));
+
+    VirtualFileSystem files;
+    files.setLooseOverride(false);
+    CHECK(!files.isMounted());
+    CHECK(!files.exists("Packed/Data/only.lw"));
+
+    REQUIRE(files.mount(ARCHIVE));
+    CHECK(files.isMounted());
+
+    std::string text;
+    CHECK(files.exists("packed\\data\\ONLY.lw"));
+    CHECK(files.read("Packed/Data/only.lw", text));
+    CHECK(text == "in the archive only\n");
+
+    // the archive first, loose files for what it doesn't have
+    CHECK(files.read(LOOSE, text));
+    CHECK(text == "packed version\n");
+    CHECK(files.read("Resources/Data/MapHitboxes.lw", text));
+    CHECK(!files.read("Packed/Data/missing.lw", text));
+
+    files.unmount();
+    CHECK(!files.isMounted());
+    CHECK(!files.read("Packed/Data/only.lw", text));
+    CHECK(files.read(LOOSE, text));
+    CHECK(text == "loose version\n");
+
+    CHECK(!files.mount("missing.pak"));
+    CHECK(!files.mount(LOOSE));
+    remove(ARCHIVE);
+    remove(LOOSE);
+}
+
+TEST(LooseOverrideWins)
+{
+    REQUIRE(writeArchive());
+    REQUIRE(writeFile(LOOSE, toBytes("edited\n")));
+
+    VirtualFileSystem files;
+    files.setLooseOverride(true);
+    REQUIRE(files.mount(ARCHIVE));
+
+    std::string text;
+    CHECK(files.read(LOOSE, text));
+    CHECK(text == "edited\n");
+    CHECK(files.read("Packed/Data/only.lw", text));
+    CHECK(text == "in the archive only\n");
+
+    // deleted again, back to the archive
+    remove(LOOSE);
+    CHECK(files.read(LOOSE, text));
+    CHECK(text == "packed version\n");
+    remove(ARCHIVE);
+}
+
+TEST(ArchivedFilesCanBeExtracted)
+{
+    REQUIRE(writeArchive());
+    fs::path folder = fs::temp_directory_path() / "VirtualFileSystemTests";
+    fs::create_directories(folder);
+
+    VirtualFileSystem files;
+    files.setLooseOverride(false);
+    files.setExtractFolder(folder.string());
+    REQUIRE(files.mount(ARCHIVE));
+
+    std::string localPath;
+    REQUIRE(files.getLocalPath("Packed/Data/only.lw", localPath));
+    CHECK(localPath != "Packed/Data/only.lw");
+    std::vector<char> bytes;
+    CHECK(readFile(localPath, bytes));
+    CHECK(bytes == toBytes("in the archive only\n"));
+
+    // loose files are given as they are
+    CHECK(files.getLocalPath("Resources/Data/MapHitboxes.lw", localPath));
+    CHECK(localPath == "Resources/Data/MapHitboxes.lw");
+    CHECK(!files.getLocalPath("Packed/Data/missing.lw", localPath));
+
+    files.unmount();
+    fs::remove_all(folder);
+    remove(ARCHIVE);
+}
+
+TEST(PackedResourcesReadLikeLooseOnes)
+{
+    // what the AssetPacker does with the game's folders, every file comes back byte for byte
+    const char * folders[] = { "Resources/Models", "Resources/Textures", "Resources/Shaders", "Resources/Data", "Resources/Fonts" };
+    std::vector<AssetArchive::Input> inputs;
+    for (const char * folder : folders)
+    {
+        std::error_code error;
+        for (auto const & entry : fs::recursive_directory_iterator(folder, error))
+        {
+            if (!entry.is_regular_file())
+                continue;
+            AssetArchive::Input input;
+            input.name = entry.path().generic_string();
+            input.compress = true;
+            REQUIRE(readFile(entry.path(), input.bytes));
+            inputs.push_back(std::move(input));
+        }
+    }
+    REQUIRE(inputs.size() > 10);
+
+    std::vector<char> archive;
+    std::string errors;
+    REQUIRE(AssetArchive::build(inputs, 16, archive, errors));
+    REQUIRE(writeFile(ARCHIVE, archive));
+
+    VirtualFileSystem files;
+    files.setLooseOverride(false);
+    REQUIRE(files.mount(ARCHIVE));
+
+    // from a few threads at once, like the loader workers
+    std::vector<int> wrong(4, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            for (size_t i = t; i < inputs.size(); i += 4)
+            {
+                std::vector<char> bytes;
+                if (!files.read(inputs[i].name, bytes) || bytes != inputs[i].bytes)
+                    wrong[t]++;
+            }
+        }));
+    }
+    for (std::thread & thread : threads)
+        thread.join();
+
+    printf("    %zu files, %zu bytes packed\n", inputs.size(), archive.size());
+    for (int count : wrong)
+        CHECK(count == 0);
+    files.unmount();
+    remove(ARCHIVE);
+}
@@ -0,0 +1,170 @@
+#include <Test.h>
+#include <AI/Behavior/BehaviorTree.h>
+#include <AI/Behavior/BehaviorTreeManager.h>
+
+using namespace Logic;
+
+namespace
+{
+    // an enemy standing still at position, remembers what the tree told it to do
+    class TestAgent : public BehaviorTree::Agent
+    {
+    public:
+        btVector3 position;
+        float health;
+        int ticks, moves;
+        std::vector<float> abilities; // the tick time of every useAbility
+
+        TestAgent(btVector3 const & position = btVector3(0.f, 0.f, 0.f))
+            : position(position), health(100.f), ticks(0), moves(0) {}
+
+        virtual btVector3 getPosition() const { return position; }
+        virtual float getHealth() const { return health; }
+
+        virtual void beginTick() { ticks++; }
+        virtual bool moveToPlayer(float speed, float deltaTime) { moves++; return true; }
+        virtual bool useAbility() { abilities.push_back(blackboard.lastTick); return true; }
+        virtual bool pushAway(float force) { return true; }
+    };
+
+    BehaviorTree & getRanged()
+    {
+        BehaviorTree * tree = BehaviorTreeManager::singleton().getTree("ranged");
+        REQUIRE(tree);
+        return *tree;
+    }
+
+    // ticks the agent alone on the tree for duration ms at the frame rate given
+    void run(BehaviorTree & tree, TestAgent & agent, float fps, float duration)
+    {
+        float deltaTime = 1000.f / fps, time = 0.f;
+        tree.initBlackboard(agent.blackboard, 1234u, time);
+        while (time + deltaTime <= duration)
+        {
+            time += deltaTime;
+            tree.queue(&agent);
+            tree.tickBatch(btVector3(0.f, 0.f, 0.f), deltaTime, time);
+        }
+    }
+}
+
+TEST(LoadsRangedTreeFromFile)
+{
+    BehaviorTree & tree = getRanged();
+    auto const & nodes = tree.getNodes();
+    REQUIRE(nodes.size() == 8);
+
+    CHECK(nodes[0].type == BehaviorTree::PARALLEL);
+    CHECK(nodes[1].type == BehaviorTree::SEQUENCE);
+    CHECK(nodes[2].type == BehaviorTree::CONDITION && nodes[2].id == BehaviorTree::CAN_SEE_PLAYER);
+    CHECK(nodes[3].type == BehaviorTree::CONDITION && nodes[3].id == BehaviorTree::COOLDOWN);
+    CHECK(nodes[3].slot == 0);
+    CHECK(nodes[3].value == 1000.f && nodes[3].valueMax == 2300.f);
+    CHECK(nodes[4].type == BehaviorTree::ACTION && nodes[4].id == BehaviorTree::USE_ABILITY);
+    CHECK(nodes[5].type == BehaviorTree::SEQUENCE);
+    CHECK(nodes[6].type == BehaviorTree::CONDITION && nodes[6].id == BehaviorTree::PLAYER_FURTHER_THAN);
+    CHECK(nodes[6].value == 20.f);
+    CHECK(nodes[7].type == BehaviorTree::ACTION && nodes[7].id == BehaviorTree::MOVE_TO_PLAYER);
+    CHECK(nodes[7].value == 10.f);
+
+    // every subtree ends where the next sibling starts
+    int next[] = { 8, 5, 3, 4, 5, 8, 7, 8 };
+    for (int i = 0; i < 8; i++)
+        CHECK(nodes[i].next == next[i]);
+}
+
+TEST(CompileRejectsBadTrees)
+{
+    BehaviorTree tree;
+    CHECK(tree.compile("empty", {}) == -1);
+    // a leaf can't have children
+    CHECK(tree.compile("leaf", {
+        { 0, "sequence", "", 0.f, 0.f },
+        { 1, "action", "useAbility", 0.f, 0.f },
+        { 2, "action", "useAbility", 0.f, 0.f }
+    }) == -1);
+    CHECK(tree.compile("unknown", {
+        { 0, "sequence", "", 0.f, 0.f },
+        { 1, "condition", "isHungry", 0.f, 0.f }
+    }) == -1);
+    CHECK(tree.compile("ok", {
+        { 0, "selector", "", 0.f, 0.f },
+        { 1, "condition", "healthBelow", 10.f, 0.f },
+        { 1, "action", "pushAway", 5.f, 0.f }
+    }) == 0);
+}
+
+TEST(BlackboardIsPerEnemy)
+{
+    BehaviorTree & tree = getRanged();
+    TestAgent first, second;
+    tree.initBlackboard(first.blackboard, 1u, 0.f);
+    tree.initBlackboard(second.blackboard, 2u, 0.f);
+
+    // the cooldown starts somewhere in its range, not the same for both
+    CHECK(first.blackboard.timers[0] >= 0.f && first.blackboard.timers[0] <= 2300.f);
+    CHECK(second.blackboard.timers[0] >= 0.f && second.blackboard.timers[0] <= 2300.f);
+    CHECK(first.blackboard.timers[0] != second.blackboard.timers[0]);
+
+    // ticking one leaves the other alone
+    float before = second.blackboard.timers[0];
+    tree.queue(&first);
+    tree.tickBatch(btVector3(0.f, 0.f, 0.f), 500.f, 500.f);
+    CHECK(first.blackboard.lastTick == 500.f);
+    CHECK(second.blackboard.lastTick == 0.f);
+    CHECK(second.blackboard.timers[0] == before);
+
+    // the next tick counts from its own last tick
+    tree.queue(&second);
+    tree.tickBatch(btVector3(0.f, 0.f, 0.f), 16.f, 800.f);
+    CHECK(second.blackboard.lastTick == 800.f);
+    if (second.abilities.empty())
+        CHECK(second.blackboard.timers[0] == before - 800.f);
+}
+
+TEST(TickBatchRunsEveryQueuedAgent)
+{
+    BehaviorTree & tree = getRanged();
+    TestAgent near(btVector3(0.f, 0.f, 10.f)), far(btVector3(0.f, 0.f, 50.f)), dead;
+    dead.health = 0.f;
+    tree.initBlackboard(near.blackboard, 1u, 0.f);
+    tree.initBlackboard(far.blackboard, 2u, 0.f);
+    tree.initBlackboard(dead.blackboard, 3u, 0.f);
+
+    tree.queue(&near);
+    tree.queue(&far);
+    tree.queue(&dead);
+    CHECK(tree.getQueued() == 3);
+
+    CHECK(tree.tickBatch(btVector3(0.f, 0.f, 0.f), 16.f, 16.f) == 2);
+    CHECK(tree.getQueued() == 0);
+    CHECK(near.ticks == 1 && far.ticks == 1 && dead.ticks == 0);
+
+    // only the one further than 20 walks
+    CHECK(near.moves == 0);
+    CHECK(far.moves == 1);
+
+    // nothing queued, nothing ticked
+    CHECK(tree.tickBatch(btVector3(0.f, 0.f, 0.f), 16.f, 32.f) == 0);
+    CHECK(near.ticks == 1);
+}
+
+TEST(CooldownsAreTheSameAt30And144Fps)
+{
+    BehaviorTree & tree = getRanged();
+    TestAgent slow(btVector3(0.f, 0.f, 10.f)), fast(btVector3(0.f, 0.f, 10.f));
+    run(tree, slow, 30.f, 20000.f);
+    run(tree, fast, 144.f, 20000.f);
+
+    // 20 s of 1 to 2.3 s cooldowns
+    REQUIRE(slow.abilities.size() >= 8);
+    REQUIRE(slow.abilities.size() == fast.abilities.size());
+
+    // every shot lands on the first frame after it is ready, so they are at most one slow frame apart
+    for (size_t i = 0; i < slow.abilities.size(); i++)
+    {
+        CHECK(fabs(slow.abilities[i] - fast.abilities[i]) <= 1000.f / 30.f + 0.01f);
+        if (i > 0)
+            CHECK(fast.abilities[i] - fast.abilities[i - 1] >= 1000.f - 1000.f / 144.f);
+    }
+}
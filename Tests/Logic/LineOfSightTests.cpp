@@ -0,0 +1,107 @@
+#include <Test.h>
+#include <AI/LineOfSight.h>
+#include <AI/VisibilityService.h>
+
+using namespace Logic;
+
+namespace
+{
+    bool cast(LineOfSight & lineOfSight, btVector3 const & from, btVector3 const & to)
+    {
+        LineOfSight::Ray ray = { from, false };
+        lineOfSight.castRays(&ray, 1, to);
+        return ray.visible;
+    }
+}
+
+TEST(BoxBlocksRaysThroughIt)
+{
+    BoxLineOfSight boxes;
+    boxes.addBox({ 0, 5, 0 }, { 0, 0, 0 }, { 2, 5, 2 });
+
+    CHECK(!cast(boxes, { -10, 1, 0 }, { 10, 1, 0 }));
+    CHECK(cast(boxes, { -10, 11, 0 }, { 10, 11, 0 }));
+    CHECK(cast(boxes, { -10, 1, 3 }, { 10, 1, 3 }));
+    // stops short of it
+    CHECK(cast(boxes, { -10, 1, 0 }, { -3, 1, 0 }));
+    // straight down onto the roof
+    CHECK(!cast(boxes, { 0, 20, 0 }, { 0, 1, 0 }));
+}
+
+TEST(RotatedBox)
+{
+    // a thin wall along x, turned a quarter around y it's along z
+    BoxLineOfSight boxes;
+    boxes.addBox({ 0, 0, 0 }, { 0, SIMD_HALF_PI, 0 }, { 10, 10, 0.5f });
+
+    CHECK(cast(boxes, { -5, 0, -20 }, { -5, 0, 20 }));
+    CHECK(!cast(boxes, { -20, 0, 5 }, { 20, 0, 5 }));
+}
+
+TEST(RayFromInsideIsntBlocked)
+{
+    BoxLineOfSight boxes;
+    boxes.addBox({ 0, 0, 0 }, { 0, 0, 0 }, { 2, 2, 2 });
+
+    CHECK(cast(boxes, { 0, 0, 0 }, { 10, 0, 0 }));
+    CHECK(!cast(boxes, { 10, 0, 0 }, { 0, 0, 0 }));
+}
+
+TEST(ServiceQueuesThenAnswers)
+{
+    BoxLineOfSight boxes;
+    boxes.addBox({ 0, 5, 0 }, { 0, 0, 0 }, { 2, 5, 2 });
+
+    VisibilityService visibility;
+    visibility.init(&boxes);
+
+    // not cast yet, not visible
+    visibility.beginFrame({ 10, 1, 0 });
+    CHECK(!visibility.isVisible({ -10, 1, 10 }));
+    CHECK(!visibility.isVisible({ -10, 1, 0 }));
+    CHECK(visibility.getStats().misses == 2);
+    CHECK(visibility.flush() == 2);
+
+    visibility.beginFrame({ 10, 1, 0 });
+    CHECK(visibility.isVisible({ -10, 1, 10 }));
+    CHECK(!visibility.isVisible({ -10, 1, 0 }));
+    // the same cell
+    CHECK(visibility.isVisible({ -9.5f, 1.5f, 10.5f }));
+    CHECK(visibility.getStats().hits == 3);
+    CHECK(visibility.flush() == 0);
+}
+
+TEST(ServiceDropsTheCacheWhenThePlayerMoves)
+{
+    BoxLineOfSight boxes;
+    VisibilityService visibility;
+    visibility.init(&boxes);
+
+    visibility.beginFrame({ 0, 1, 0 });
+    visibility.isVisible({ 20, 1, 0 });
+    visibility.flush();
+    CHECK(visibility.getCachedCells() == 1);
+
+    visibility.beginFrame({ 1, 1, 0 });
+    CHECK(visibility.getCachedCells() == 1);
+
+    visibility.beginFrame({ 0, 1, 10 });
+    CHECK(visibility.getCachedCells() == 0);
+}
+
+TEST(ServiceCastsOldCellsAgain)
+{
+    BoxLineOfSight boxes;
+    VisibilityService visibility(LOS_CELL_SIZE, 2);
+    visibility.init(&boxes);
+
+    int rays = 0;
+    for (int tick = 0; tick < 9; tick++)
+    {
+        visibility.beginFrame({ 0, 1, 0 });
+        visibility.isVisible({ 20, 1, 0 });
+        rays += visibility.flush();
+    }
+    // ticks 1, 4 and 7, kept for two ticks after each
+    CHECK(rays == 3);
+}
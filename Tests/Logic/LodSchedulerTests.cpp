@@ -0,0 +1,142 @@
+#include <Test.h>
+#include <AI/LodScheduler.h>
+#include <float.h>
+
+using namespace Logic;
+
+namespace
+{
+    // the frames in [1, frames] the agent thinks on, standing at position looking down +z from origin
+    std::vector<int> thinkFrames(LodScheduler & scheduler, LodScheduler::Agent & agent, btVector3 const & position, int frames)
+    {
+        std::vector<int> thinks;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            scheduler.beginFrame(btVector3(0.f, 0.f, 0.f), btVector3(0.f, 0.f, 1.f));
+            if (scheduler.schedule(agent, position))
+                thinks.push_back(scheduler.getFrame());
+        }
+        return thinks;
+    }
+}
+
+TEST(SameSeedGivesSameThinkFrames)
+{
+    LodScheduler first(42u), second(42u);
+    LodScheduler::Agent a[8], b[8];
+    for (int i = 0; i < 8; i++)
+    {
+        first.initAgent(a[i]);
+        second.initAgent(b[i]);
+        CHECK(a[i].phase == b[i].phase);
+    }
+
+    btVector3 position(0.f, 0.f, 50.f);
+    for (int i = 0; i < 8; i++)
+        CHECK(thinkFrames(first, a[i], position, 64) == thinkFrames(second, b[i], position, 64));
+
+    // and setSeed starts the sequence over
+    LodScheduler::Agent again;
+    first.setSeed(42u);
+    first.initAgent(again);
+    CHECK(again.phase == a[0].phase);
+}
+
+TEST(LoadsBandsFromAILod)
+{
+    LodScheduler scheduler;
+    REQUIRE(scheduler.loadBands() == 0);
+    REQUIRE(scheduler.getBandCount() == 3);
+
+    CHECK(scheduler.getBand(0).name == "near");
+    CHECK(scheduler.getBand(0).maxDistance == 30.f);
+    CHECK(scheduler.getBand(0).interval == 1);
+    CHECK(scheduler.getBand(0).hiddenInterval == 2);
+
+    CHECK(scheduler.getBand(1).name == "medium");
+    CHECK(scheduler.getBand(1).maxDistance == 80.f);
+    CHECK(scheduler.getBand(1).interval == 4);
+    CHECK(scheduler.getBand(1).hiddenInterval == 8);
+
+    CHECK(scheduler.getBand(2).name == "far");
+    CHECK(scheduler.getBand(2).maxDistance == FLT_MAX);
+    CHECK(scheduler.getBand(2).interval == 16);
+    CHECK(scheduler.getBand(2).hiddenInterval == 32);
+}
+
+TEST(ThinksEveryBandInterval)
+{
+    LodScheduler scheduler;
+    REQUIRE(scheduler.loadBands() == 0);
+
+    struct { btVector3 position; int band, interval; } cases[] = {
+        { btVector3(0.f, 0.f, 10.f),   0, 1 },  // near, in view
+        { btVector3(0.f, 0.f, -10.f),  0, 2 },  // near, behind
+        { btVector3(0.f, 0.f, 50.f),   1, 4 },
+        { btVector3(0.f, 0.f, -50.f),  1, 8 },
+        { btVector3(0.f, 0.f, 500.f),  2, 16 },
+        { btVector3(0.f, 0.f, -500.f), 2, 32 }
+    };
+
+    for (auto const & test : cases)
+    {
+        LodScheduler::Agent agent;
+        scheduler.initAgent(agent);
+
+        auto thinks = thinkFrames(scheduler, agent, test.position, 128);
+        CHECK(agent.band == test.band);
+        REQUIRE((int)thinks.size() == 128 / test.interval);
+        for (size_t i = 1; i < thinks.size(); i++)
+            CHECK(thinks[i] - thinks[i - 1] == test.interval);
+    }
+}
+
+TEST(AgentsInABandAreStaggered)
+{
+    LodScheduler scheduler;
+    REQUIRE(scheduler.loadBands() == 0);
+
+    const int count = 64;
+    std::vector<LodScheduler::Agent> agents(count);
+    for (auto & agent : agents)
+        scheduler.initAgent(agent);
+
+    // far band, in view: every agent thinks once per 16 frames, spread over them
+    btVector3 position(0.f, 0.f, 500.f);
+    int total = 0, busiest = 0;
+    for (int frame = 0; frame < 16; frame++)
+    {
+        scheduler.beginFrame(btVector3(0.f, 0.f, 0.f), btVector3(0.f, 0.f, 1.f));
+        for (auto & agent : agents)
+            scheduler.schedule(agent, position);
+
+        CHECK(scheduler.getAgentsInBand(2) == count);
+        total += scheduler.getThinksThisFrame();
+        if (scheduler.getThinksThisFrame() > busiest)
+            busiest = scheduler.getThinksThisFrame();
+    }
+
+    CHECK(total == count);
+    CHECK(busiest < count / 2);
+}
+
+TEST(ExtrapolatedStepsFollowTheLastThink)
+{
+    LodScheduler scheduler;
+    LodScheduler::Agent agent;
+    scheduler.initAgent(agent);
+    CHECK(LodScheduler::getExtrapolatedStep(agent, 16.f) == btVector3(0.f, 0.f, 0.f));
+
+    // the think moved the enemy 0.5 units in 16 ms, Enemy::update saves that as velocity
+    agent.velocity = btVector3(0.5f, 0.f, -0.25f) / 16.f;
+
+    // so the skipped frames in between keep the same speed, whatever their length
+    btVector3 position(0.f, 0.f, 0.f);
+    for (int frame = 0; frame < 3; frame++)
+        position += LodScheduler::getExtrapolatedStep(agent, 16.f);
+    position += LodScheduler::getExtrapolatedStep(agent, 8.f);
+
+    CHECK_NEAR(position.x(), 1.75f, 1e-5f);
+    CHECK_NEAR(position.y(), 0.f, 1e-5f);
+    CHECK_NEAR(position.z(), -0.875f, 1e-5f);
+}
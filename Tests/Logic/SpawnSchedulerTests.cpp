@@ -0,0 +1,292 @@
+#include <Test.h>
+#include <AI/SpawnScheduler.h>
+#include <AI/WaveManager.h>
+
+using namespace Logic;
+
+namespace
+{
+    WaveManager::Wave makeWave(WaveManager::SPAWN_CURVE curve)
+    {
+        WaveManager::Wave wave;
+        wave.time = 1000.f;
+        wave.spawnTime = 4000.f;
+        wave.curve = curve;
+        wave.spawns.push_back({ 0, 3, btVector3(10.f, 1.f, 0.f), 4.f });
+        wave.spawns.push_back({ 1, 1, btVector3(-10.f, 1.f, 0.f), 2.f });
+
+        WaveManager::TriggerDefinition trigger;
+        trigger.modelID = 0;
+        trigger.position = btVector3(0.f, 0.f, 5.f);
+        trigger.halfExtent = btVector3(1.f, 1.f, 1.f);
+        trigger.cooldown = 0.f;
+        trigger.reusable = true;
+        wave.triggers.push_back(trigger);
+        return wave;
+    }
+
+    // everything the wave spawns, in the order it's popped, at the frame rate given
+    std::vector<SpawnScheduler::SpawnEvent> run(SpawnScheduler & scheduler, float deltaTime, int frames, std::vector<int> * perFrame = nullptr)
+    {
+        std::vector<SpawnScheduler::SpawnEvent> popped;
+        SpawnScheduler::SpawnEvent event;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            scheduler.update(deltaTime);
+            int count = 0;
+            while (scheduler.popEvent(event))
+            {
+                popped.push_back(event);
+                count++;
+            }
+            if (perFrame)
+                perFrame->push_back(count);
+        }
+        return popped;
+    }
+}
+
+TEST(TimelineStartsWithTheTriggers)
+{
+    SpawnScheduler scheduler;
+    scheduler.start(makeWave(WaveManager::CURVE_LINEAR));
+
+    auto const & timeline = scheduler.getTimeline();
+    REQUIRE(timeline.size() == 5);
+    CHECK(timeline[0].kind == SpawnScheduler::SpawnEvent::TRIGGER);
+    CHECK(timeline[0].time == 0.f);
+    CHECK(timeline[0].position == btVector3(0.f, 0.f, 5.f));
+    CHECK(scheduler.getPending() == 5);
+}
+
+TEST(GroupsAreInterleaved)
+{
+    SpawnScheduler scheduler;
+    scheduler.start(makeWave(WaveManager::CURVE_LINEAR));
+
+    // round robin: 0 1 0 0, the single enemy of group 1 isn't last
+    auto const & timeline = scheduler.getTimeline();
+    int expected[] = { 0, 1, 0, 0 };
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(timeline[i + 1].kind == SpawnScheduler::SpawnEvent::ENEMY);
+        CHECK(timeline[i + 1].index == expected[i]);
+    }
+}
+
+TEST(LinearTimesAreEven)
+{
+    SpawnScheduler scheduler;
+    scheduler.start(makeWave(WaveManager::CURVE_LINEAR));
+
+    auto const & timeline = scheduler.getTimeline();
+    for (int i = 0; i < 4; i++)
+        CHECK_NEAR(timeline[i + 1].time, 4000.f * i / 3.f, 0.01f);
+}
+
+TEST(CurvesStayInTheSpawnTime)
+{
+    WaveManager::SPAWN_CURVE curves[] = { WaveManager::CURVE_LINEAR, WaveManager::CURVE_EASE_IN, WaveManager::CURVE_EASE_OUT, WaveManager::CURVE_BURST };
+    for (WaveManager::SPAWN_CURVE curve : curves)
+    {
+        SpawnScheduler scheduler;
+        scheduler.start(makeWave(curve));
+
+        auto const & timeline = scheduler.getTimeline();
+        for (size_t i = 1; i < timeline.size(); i++)
+        {
+            CHECK(timeline[i].time >= timeline[i - 1].time);
+            CHECK(timeline[i].time >= 0.f);
+            CHECK(timeline[i].time <= 4000.f);
+        }
+
+        if (curve == WaveManager::CURVE_BURST)
+            CHECK(timeline.back().time == 0.f);
+        else
+            CHECK_NEAR(timeline.back().time, 4000.f, 0.01f);
+    }
+
+    // ease in is late in the middle, ease out early
+    CHECK(SpawnScheduler::applyCurve(WaveManager::CURVE_EASE_IN, 0.5f) > 0.5f);
+    CHECK(SpawnScheduler::applyCurve(WaveManager::CURVE_EASE_OUT, 0.5f) < 0.5f);
+}
+
+TEST(SpawnsAreSpreadAroundTheGroup)
+{
+    SpawnScheduler scheduler;
+    scheduler.start(makeWave(WaveManager::CURVE_LINEAR));
+
+    for (auto const & event : scheduler.getTimeline())
+    {
+        if (event.kind != SpawnScheduler::SpawnEvent::ENEMY)
+            continue;
+
+        btVector3 center = event.index == 0 ? btVector3(10.f, 1.f, 0.f) : btVector3(-10.f, 1.f, 0.f);
+        float spread = event.index == 0 ? 4.f : 2.f;
+        CHECK((event.position - center).length() <= spread + 0.001f);
+        CHECK(event.position.y() == 1.f);
+    }
+}
+
+TEST(NoMoreThanTheCapAFrame)
+{
+    SpawnScheduler scheduler(2);
+    scheduler.start(makeWave(WaveManager::CURVE_BURST));
+
+    std::vector<int> perFrame;
+    auto popped = run(scheduler, 16.f, 10, &perFrame);
+
+    CHECK(popped.size() == 5);
+    CHECK(perFrame[0] == 2);
+    CHECK(perFrame[1] == 2);
+    CHECK(perFrame[2] == 1);
+    CHECK(scheduler.isDone());
+}
+
+TEST(EventsWaitForTheirTime)
+{
+    SpawnScheduler scheduler;
+    scheduler.start(makeWave(WaveManager::CURVE_LINEAR));
+
+    // 100 ms frames, the enemies are due at 0, 1333, 2667 and 4000
+    std::vector<int> perFrame;
+    auto popped = run(scheduler, 100.f, 50, &perFrame);
+    REQUIRE(popped.size() == 5);
+
+    float time = 0.f;
+    for (size_t frame = 0, event = 0; frame < perFrame.size(); frame++)
+    {
+        time += 100.f;
+        for (int i = 0; i < perFrame[frame]; i++, event++)
+            CHECK(popped[event].time <= time);
+    }
+    CHECK(perFrame[12] == 0);
+    CHECK(perFrame[13] == 1);
+}
+
+TEST(SameWaveSameTimeline)
+{
+    SpawnScheduler first, second;
+    first.start(makeWave(WaveManager::CURVE_EASE_IN));
+    second.start(makeWave(WaveManager::CURVE_EASE_IN));
+
+    auto const & a = first.getTimeline();
+    auto const & b = second.getTimeline();
+    REQUIRE(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        CHECK(a[i].time == b[i].time);
+        CHECK(a[i].index == b[i].index);
+        CHECK(a[i].position == b[i].position);
+    }
+}
+
+TEST(WaveFileTimeline)
+{
+    WaveManager waves(WAVE_FILE_NAME);
+    REQUIRE(waves.loadWaves() == 0);
+    REQUIRE(waves.getWaveCount() > 0);
+
+    float lastStart = -1.f;
+    for (int id = 1; id <= waves.getWaveCount(); id++)
+    {
+        WaveManager::Wave const * wave = waves.getWave(id);
+        REQUIRE(wave);
+        CHECK(wave->time > lastStart);
+        lastStart = wave->time;
+
+        int enemies = 0;
+        for (WaveManager::SpawnGroup const & group : wave->spawns)
+            enemies += group.count;
+        CHECK((int)waves.getEnemies(id).size() == enemies);
+
+        SpawnScheduler scheduler;
+        scheduler.start(*wave);
+        CHECK(scheduler.getPending() == enemies + (int)wave->triggers.size());
+
+        // every spawn is out by the end of the spawn time, a frame at a time
+        std::vector<int> perFrame;
+        int frames = (int)(wave->spawnTime / 16.f) + scheduler.getPending() / SPAWN_MAX_PER_FRAME + 2;
+        auto popped = run(scheduler, 16.f, frames, &perFrame);
+        CHECK((int)popped.size() == enemies + (int)wave->triggers.size());
+        CHECK(scheduler.isDone());
+        for (int count : perFrame)
+            CHECK(count <= SPAWN_MAX_PER_FRAME);
+    }
+}
+
+TEST(NextWaveKeepsWhatsLeft)
+{
+    WaveManager::Wave first = makeWave(WaveManager::CURVE_LINEAR);
+    WaveManager::Wave second = makeWave(WaveManager::CURVE_BURST);
+    second.triggers.clear();
+    second.spawns = { { 2, 2, btVector3(0.f, 1.f, 30.f), 0.f } };
+
+    SpawnScheduler scheduler;
+    scheduler.reserve(5);
+    scheduler.start(first);
+
+    // 2000 ms in, the trigger and two enemies are out, 2667 and 4000 are left
+    auto popped = run(scheduler, 100.f, 20);
+    REQUIRE(popped.size() == 3);
+    REQUIRE(scheduler.getPending() == 2);
+
+    scheduler.start(second);
+    auto const & timeline = scheduler.getTimeline();
+    REQUIRE(timeline.size() == 4);
+    for (size_t i = 1; i < timeline.size(); i++)
+        CHECK(timeline[i].time >= timeline[i - 1].time);
+
+    // the new wave's burst at 0, then the old ones at their time from now
+    CHECK(timeline[0].index == 2);
+    CHECK(timeline[1].index == 2);
+    CHECK(timeline[0].wave == &second);
+    CHECK(timeline[2].wave == &first);
+    CHECK_NEAR(timeline[2].time, 4000.f * 2 / 3 - 2000.f, 0.01f);
+    CHECK_NEAR(timeline[3].time, 2000.f, 0.01f);
+
+    popped = run(scheduler, 100.f, 30);
+    CHECK(popped.size() == 4);
+    CHECK(scheduler.isDone());
+}
+
+TEST(OverdueSpawnsGoFirst)
+{
+    WaveManager::Wave first = makeWave(WaveManager::CURVE_BURST);
+    WaveManager::Wave second = makeWave(WaveManager::CURVE_BURST);
+
+    // capped at one a frame, four of the first wave are still due when the second starts
+    SpawnScheduler scheduler(1);
+    scheduler.start(first);
+    run(scheduler, 16.f, 1);
+    REQUIRE(scheduler.getPending() == 4);
+
+    scheduler.start(second);
+    auto const & timeline = scheduler.getTimeline();
+    REQUIRE(timeline.size() == 9);
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(timeline[i].wave == &first);
+        CHECK(timeline[i].time == 0.f);
+    }
+    CHECK(timeline[4].wave == &second);
+    CHECK(timeline[4].kind == SpawnScheduler::SpawnEvent::TRIGGER);
+
+    // the trigger index still points into the wave it came from
+    SpawnScheduler::SpawnEvent event;
+    scheduler.update(16.f);
+    REQUIRE(scheduler.popEvent(event));
+    CHECK(event.kind == SpawnScheduler::SpawnEvent::ENEMY);
+    CHECK(event.wave == &first);
+}
+
+TEST(ClearDropsEverything)
+{
+    SpawnScheduler scheduler;
+    scheduler.start(makeWave(WaveManager::CURVE_LINEAR));
+    scheduler.clear();
+    CHECK(scheduler.isDone());
+
+    scheduler.start(makeWave(WaveManager::CURVE_LINEAR));
+    CHECK(scheduler.getPending() == 5);
+}
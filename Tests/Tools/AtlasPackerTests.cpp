@@ -0,0 +1,383 @@
+#include <Test.h>
+#include <Tools/AtlasPacker/AtlasBuilder.h>
+#include <Tools/AtlasPacker/MaxRectsPacker.h>
+#include <Graphics/include/Resources/DDSFile.h>
+#include <Resources/TextureAtlas.h>
+#include <Engine/Constants.h>
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+
+using namespace Graphics;
+
+/*
+    The atlas has every image where its rect says, the bleed around it is
+    its nearest edge pixel and the rest of the padding is left empty. That
+    is checked by drawing what the atlas should be and comparing every
+    pixel of it.
+*/
+
+#define ATLAS_PATH TEXTURE_PATH_SIMPLE "Cooked/UIAtlas.dds"
+
+namespace
+{
+    struct Random
+    {
+        uint32_t state;
+        uint32_t next() { state = state * 1664525u + 1013904223u; return state >> 8; }
+        uint32_t range(uint32_t low, uint32_t high) { return low + next() % (high - low + 1); }
+    };
+
+    bool readFile(const char * path, std::vector<char> & bytes)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+
+        bytes.resize((size_t)file.tellg());
+        file.seekg(0);
+        return bytes.empty() || (bool)file.read(bytes.data(), bytes.size());
+    }
+
+    bool overlaps(PackRect const & a, PackRect const & b)
+    {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    bool inside(PackRect const & rect, uint32_t width, uint32_t height)
+    {
+        return rect.x + rect.width <= width && rect.y + rect.height <= height;
+    }
+
+    // no pixel is transparent black, so an empty one is never mistaken for it
+    Image makeImage(uint32_t width, uint32_t height, Random & random)
+    {
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize((size_t)width * height * 4);
+        for (size_t i = 0; i < image.pixels.size(); i += 4)
+        {
+            image.pixels[i] = (uint8_t)random.next();
+            image.pixels[i + 1] = (uint8_t)random.next();
+            image.pixels[i + 2] = (uint8_t)random.next();
+            image.pixels[i + 3] = (uint8_t)random.range(1, 255);
+        }
+        return image;
+    }
+
+    PackRect padded(PackRect const & rect, uint32_t padding)
+    {
+        return { rect.x - padding, rect.y - padding, rect.width + padding * 2, rect.height + padding * 2 };
+    }
+
+    // the atlas as AtlasBuilder should draw it, from the rects it chose
+    std::vector<uint8_t> drawExpected(std::vector<AtlasEntry> const & entries, uint32_t width, uint32_t height, uint32_t bleed)
+    {
+        std::vector<uint8_t> pixels((size_t)width * height * 4, 0);
+        for (AtlasEntry const & entry : entries)
+        {
+            PackRect area = padded(entry.rect, bleed);
+            for (uint32_t y = area.y; y < area.y + area.height; y++)
+            {
+                for (uint32_t x = area.x; x < area.x + area.width; x++)
+                {
+                    uint32_t imageX = x < entry.rect.x ? 0 : std::min(x - entry.rect.x, entry.image->width - 1);
+                    uint32_t imageY = y < entry.rect.y ? 0 : std::min(y - entry.rect.y, entry.image->height - 1);
+                    memcpy(&pixels[((size_t)y * width + x) * 4], &entry.image->pixels[((size_t)imageY * entry.image->width + imageX) * 4], 4);
+                }
+            }
+        }
+        return pixels;
+    }
+
+    bool isPowerOfTwo(uint32_t value)
+    {
+        return value && !(value & (value - 1));
+    }
+}
+
+TEST(maxRectsFillsTheAreaExactly)
+{
+    MaxRectsPacker packer(256, 256);
+    std::vector<PackRect> placed;
+    for (int i = 0; i < 16; i++)
+    {
+        PackRect rect;
+        REQUIRE(packer.insert(64, 64, rect));
+        for (PackRect const & other : placed)
+            CHECK(!overlaps(rect, other));
+        placed.push_back(rect);
+    }
+
+    CHECK_NEAR(packer.getOccupancy(), 1.f, 1e-6f);
+    CHECK(packer.getFreeRects().empty());
+
+    PackRect rect;
+    CHECK(!packer.insert(1, 1, rect));
+}
+
+TEST(maxRectsStartsTopLeft)
+{
+    MaxRectsPacker packer(100, 100);
+    PackRect rect;
+    REQUIRE(packer.insert(30, 20, rect));
+    CHECK(rect.x == 0 && rect.y == 0 && rect.width == 30 && rect.height == 20);
+
+    // best short side fit, the 70 wide strip on the right leaves nothing over on its height
+    REQUIRE(packer.insert(70, 20, rect));
+    CHECK(rect.x == 30 && rect.y == 0);
+}
+
+TEST(maxRectsRejectsWhatDoesNotFit)
+{
+    MaxRectsPacker packer(64, 32);
+    PackRect rect;
+    CHECK(!packer.insert(0, 10, rect));
+    CHECK(!packer.insert(10, 0, rect));
+    CHECK(!packer.insert(65, 1, rect));
+    CHECK(!packer.insert(1, 33, rect));
+    // never rotated, 32x64 doesn't go in sideways
+    CHECK(!packer.insert(32, 64, rect));
+    CHECK(packer.getOccupancy() == 0.f);
+
+    CHECK(packer.insert(64, 32, rect));
+
+    MaxRectsPacker empty(0, 0);
+    CHECK(!empty.insert(1, 1, rect));
+}
+
+TEST(maxRectsNeverOverlapsAndKeepsFreeSpaceFree)
+{
+    Random random = { 5 };
+    for (int run = 0; run < 50; run++)
+    {
+        uint32_t width = random.range(64, 512), height = random.range(64, 512);
+        MaxRectsPacker packer(width, height);
+        std::vector<PackRect> placed;
+        uint64_t area = 0;
+
+        for (int i = 0; i < 200; i++)
+        {
+            uint32_t w = random.range(1, width / 3), h = random.range(1, height / 3);
+            size_t freeCount = packer.getFreeRects().size();
+            PackRect rect;
+            if (!packer.insert(w, h, rect))
+            {
+                // a failed insert changes nothing
+                CHECK(packer.getFreeRects().size() == freeCount);
+                continue;
+            }
+
+            CHECK(rect.width == w && rect.height == h);
+            CHECK(inside(rect, width, height));
+            for (PackRect const & other : placed)
+                CHECK(!overlaps(rect, other));
+            placed.push_back(rect);
+            area += (uint64_t)w * h;
+        }
+
+        CHECK_NEAR(packer.getOccupancy(), (double)area / ((uint64_t)width * height), 1e-5);
+        for (PackRect const & free : packer.getFreeRects())
+        {
+            CHECK(inside(free, width, height));
+            for (PackRect const & rect : placed)
+                CHECK(!overlaps(free, rect));
+        }
+    }
+}
+
+TEST(atlasHasPaddingAndBleed)
+{
+    Random random = { 17 };
+    for (int run = 0; run < 100; run++)
+    {
+        AtlasSettings settings;
+        settings.padding = random.range(0, 4);
+        settings.bleed = random.range(0, settings.padding);
+        settings.maxSize = 1024;
+
+        std::vector<Image> images(random.range(1, 12));
+        std::vector<AtlasEntry> entries(images.size());
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            // thin ones too, the bleed of a 1 pixel image is the same pixel all around
+            images[i] = makeImage(random.range(1, 60), random.range(1, 60), random);
+            entries[i].name = "image" + std::to_string(i);
+            entries[i].image = &images[i];
+        }
+
+        Image atlas;
+        std::string error;
+        REQUIRE(buildAtlas(entries, settings, atlas, error));
+        CHECK(isPowerOfTwo(atlas.width) && isPowerOfTwo(atlas.height));
+        REQUIRE(atlas.pixels.size() == (size_t)atlas.width * atlas.height * 4);
+
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            PackRect const & rect = entries[i].rect;
+            CHECK(rect.width == images[i].width && rect.height == images[i].height);
+
+            // the padding stays inside the atlas and no other image reaches into it
+            PackRect area = padded(rect, settings.padding);
+            CHECK(rect.x >= settings.padding && rect.y >= settings.padding);
+            CHECK(inside(area, atlas.width, atlas.height));
+            for (size_t j = 0; j < i; j++)
+                CHECK(!overlaps(area, padded(entries[j].rect, settings.padding)));
+        }
+
+        std::vector<uint8_t> expected = drawExpected(entries, atlas.width, atlas.height, settings.bleed);
+        CHECK(atlas.pixels == expected);
+    }
+}
+
+TEST(atlasDoesNotDependOnTheOrder)
+{
+    Random random = { 23 };
+    std::vector<Image> images;
+    for (int i = 0; i < 20; i++)
+        images.push_back(makeImage(random.range(4, 40), random.range(4, 40), random));
+    // two the same size, the name decides
+    images.push_back(images[0]);
+
+    std::vector<AtlasEntry> entries(images.size());
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        entries[i].name = "image" + std::to_string(i);
+        entries[i].image = &images[i];
+    }
+
+    Image first;
+    std::string error;
+    REQUIRE(buildAtlas(entries, AtlasSettings(), first, error));
+    std::vector<AtlasEntry> firstEntries = entries;
+
+    for (int run = 0; run < 5; run++)
+    {
+        for (size_t i = entries.size(); i > 1; i--)
+            std::swap(entries[i - 1], entries[random.next() % i]);
+
+        Image atlas;
+        REQUIRE(buildAtlas(entries, AtlasSettings(), atlas, error));
+        CHECK(atlas.width == first.width && atlas.height == first.height);
+        CHECK(atlas.pixels == first.pixels);
+
+        for (AtlasEntry const & entry : entries)
+        {
+            for (AtlasEntry const & other : firstEntries)
+            {
+                if (other.name == entry.name)
+                    CHECK(other.rect.x == entry.rect.x && other.rect.y == entry.rect.y);
+            }
+        }
+    }
+}
+
+TEST(atlasIsTheSmallestThatFits)
+{
+    Random random = { 29 };
+    Image image = makeImage(60, 60, random);
+    std::vector<AtlasEntry> entries = { { "a", &image } };
+
+    Image atlas;
+    std::string error;
+    REQUIRE(buildAtlas(entries, AtlasSettings(), atlas, error));
+    CHECK(atlas.width == 64 && atlas.height == 64);
+    CHECK(entries[0].rect.x == 2 && entries[0].rect.y == 2);
+
+    // 64 pixels with the padding on both sides doesn't fit in 64, the wider one is tried first
+    Image wide = makeImage(61, 60, random);
+    entries = { { "a", &wide } };
+    REQUIRE(buildAtlas(entries, AtlasSettings(), atlas, error));
+    CHECK(atlas.width == 128 && atlas.height == 64);
+}
+
+TEST(atlasFailsWithAReason)
+{
+    Random random = { 31 };
+    Image image = makeImage(8, 8, random), empty;
+    Image atlas;
+    std::string error;
+
+    AtlasSettings settings;
+    settings.bleed = 3;
+    std::vector<AtlasEntry> entries = { { "a", &image } };
+    CHECK(!buildAtlas(entries, settings, atlas, error));
+    CHECK(!error.empty());
+
+    entries = { { "a", &image }, { "a", &image } };
+    error.clear();
+    CHECK(!buildAtlas(entries, AtlasSettings(), atlas, error));
+    CHECK(error.find("named a") != std::string::npos);
+
+    entries = { { "empty", &empty } };
+    error.clear();
+    CHECK(!buildAtlas(entries, AtlasSettings(), atlas, error));
+    CHECK(error.find("no pixels") != std::string::npos);
+
+    settings = AtlasSettings();
+    settings.maxSize = 8;
+    entries = { { "a", &image } };
+    error.clear();
+    CHECK(!buildAtlas(entries, settings, atlas, error));
+    CHECK(error.find("bigger") != std::string::npos);
+
+    // each fits on its own, five of them don't
+    settings.maxSize = 16;
+    std::vector<Image> images(5, image);
+    entries.clear();
+    for (size_t i = 0; i < images.size(); i++)
+        entries.push_back({ "image" + std::to_string(i), &images[i] });
+    error.clear();
+    CHECK(!buildAtlas(entries, settings, atlas, error));
+    CHECK(error.find("don't fit") != std::string::npos);
+}
+
+TEST(shippedAtlasIsUpToDate)
+{
+    // what Tools/AtlasPacker wrote, the table and the texture are both committed
+    TextureAtlas table;
+    REQUIRE(table.load(UI_ATLAS_PATH));
+    CHECK(table.getTexture() == "Cooked/UIAtlas.dds");
+    REQUIRE(table.getRegionCount() == 3);
+
+    std::vector<char> bytes;
+    REQUIRE(readFile(ATLAS_PATH, bytes));
+    DDSFile dds;
+    REQUIRE(dds.read(bytes.data(), bytes.size()));
+    CHECK(dds.getFormat() == DDS_FORMAT_R8G8B8A8);
+    CHECK(dds.getMipCount() == 1);
+
+    const char * names[] = { "button", "crosshair", "HPbar" };
+    std::vector<Image> images(3);
+    std::vector<AtlasEntry> entries(3);
+    for (int i = 0; i < 3; i++)
+    {
+        TextureAtlas::Region const * region = table.find(names[i]);
+        REQUIRE(region);
+
+        std::string error;
+        REQUIRE(readFile((TEXTURE_PATH_SIMPLE + region->file).c_str(), bytes));
+        REQUIRE(ImageDecoder::decode(bytes.data(), bytes.size(), images[i], error));
+        entries[i].name = names[i];
+        entries[i].image = &images[i];
+
+        // the UVs cover the image exactly
+        CHECK_NEAR((region->uEnd - region->uStart) * dds.getWidth(), images[i].width, 1e-3);
+        CHECK_NEAR((region->vEnd - region->vStart) * dds.getHeight(), images[i].height, 1e-3);
+    }
+
+    // packing the images again gives the same texture, else it wasn't packed after they changed
+    Image atlas;
+    std::string error;
+    REQUIRE(buildAtlas(entries, AtlasSettings(), atlas, error));
+    REQUIRE(atlas.width == dds.getWidth() && atlas.height == dds.getHeight());
+    CHECK(memcmp(atlas.pixels.data(), dds.getData(0), atlas.pixels.size()) == 0);
+
+    for (AtlasEntry const & entry : entries)
+    {
+        TextureAtlas::Region const * region = table.find(entry.name);
+        CHECK_NEAR(region->uStart * atlas.width, entry.rect.x, 1e-3);
+        CHECK_NEAR(region->vStart * atlas.height, entry.rect.y, 1e-3);
+    }
+}
@@ -0,0 +1,224 @@
+#include <Test.h>
+#include <Tools/TextureCooker/TextureCooker.h>
+#include <Tools/TextureCooker/BlockCompression.h>
+#include <Tools/TextureCooker/CookManifest.h>
+#include <fstream>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+using namespace Graphics;
+
+#define TEXTURE_FOLDER  "Resources/Textures/"
+#define MANIFEST_PATH   "Resources/Textures/Cooked/manifest.txt"
+
+namespace
+{
+    struct Random
+    {
+        unsigned int state;
+
+        uint8_t next()
+        {
+            state = state * 1664525u + 1013904223u;
+            return (uint8_t)(state >> 24);
+        }
+    };
+
+    // smooth color and alpha ramps with a bit of noise, like a photo
+    Image makeGradient(uint32_t width, uint32_t height, bool alpha, unsigned int seed)
+    {
+        Random random = { seed };
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize((size_t)width * height * 4);
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                uint8_t * pixel = &image.pixels[((size_t)y * width + x) * 4];
+                float u = x / (float)width, v = y / (float)height;
+                int noise = random.next() % 9 - 4;
+                pixel[0] = (uint8_t)std::min(255, std::max(0, int(255 * u) + noise));
+                pixel[1] = (uint8_t)std::min(255, std::max(0, int(255 * v) + noise));
+                pixel[2] = (uint8_t)std::min(255, std::max(0, int(128 + 100 * sinf(u * 6.f + v * 3.f)) + noise));
+                pixel[3] = alpha ? (uint8_t)(255 * (1.f - u * v)) : 255;
+            }
+        }
+        return image;
+    }
+
+    // unit normals bumping around +z, xy in red and green like a normal map
+    Image makeNormals(uint32_t width, uint32_t height)
+    {
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize((size_t)width * height * 4);
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                float nx = 0.4f * sinf(x * 0.2f), ny = 0.4f * cosf(y * 0.15f);
+                float nz = sqrtf(1.f - nx * nx - ny * ny);
+                uint8_t * pixel = &image.pixels[((size_t)y * width + x) * 4];
+                pixel[0] = (uint8_t)lroundf((nx * 0.5f + 0.5f) * 255.f);
+                pixel[1] = (uint8_t)lroundf((ny * 0.5f + 0.5f) * 255.f);
+                pixel[2] = (uint8_t)lroundf((nz * 0.5f + 0.5f) * 255.f);
+                pixel[3] = 255;
+            }
+        }
+        return image;
+    }
+
+    bool readFile(std::string const & path, std::vector<char> & bytes)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+}
+
+TEST(UsageDecidesTheFormat)
+{
+    CHECK(TextureCooker::guessUsage("normalmaptree.png") == TEXTURE_NORMAL);
+    CHECK(TextureCooker::guessUsage("glowMapTree.png") == TEXTURE_GLOW);
+    CHECK(TextureCooker::guessUsage("specularmaptree.png") == TEXTURE_SPECULAR);
+    CHECK(TextureCooker::guessUsage("stone.jpg") == TEXTURE_ALBEDO);
+
+    Image opaque = makeGradient(16, 16, false, 1), transparent = makeGradient(16, 16, true, 1);
+    CHECK(TextureCooker::chooseFormat(TEXTURE_ALBEDO, opaque) == DDS_FORMAT_BC1);
+    CHECK(TextureCooker::chooseFormat(TEXTURE_ALBEDO, transparent) == DDS_FORMAT_BC3);
+    CHECK(TextureCooker::chooseFormat(TEXTURE_NORMAL, opaque) == DDS_FORMAT_BC5);
+    CHECK(TextureCooker::chooseFormat(TEXTURE_SPECULAR, opaque) == DDS_FORMAT_BC1);
+    CHECK(TextureCooker::chooseFormat(TEXTURE_GLOW, opaque) == DDS_FORMAT_BC7);
+
+    for (int usage = 0; usage < NR_OF_TEXTURE_USAGES; usage++)
+    {
+        TextureUsage parsed;
+        CHECK(TextureCooker::parseUsage(TextureCooker::getUsageName((TextureUsage)usage), parsed));
+        CHECK(parsed == usage);
+    }
+}
+
+TEST(EveryFormatKeepsItsQuality)
+{
+    // the lowest the formats should ever get on smooth images
+    struct { TextureUsage usage; bool alpha; DDSFormat format; float minimum; } cases[] =
+    {
+        { TEXTURE_ALBEDO,   false,  DDS_FORMAT_BC1,  35.f },
+        { TEXTURE_ALBEDO,   true,   DDS_FORMAT_BC3,  35.f },
+        { TEXTURE_SPECULAR, false,  DDS_FORMAT_BC1,  35.f },
+        { TEXTURE_GLOW,     true,   DDS_FORMAT_BC7,  38.f },
+    };
+
+    for (auto const & test : cases)
+    {
+        Image image = makeGradient(128, 64, test.alpha, 7);
+        DDSFile texture;
+        float psnr = 0.f;
+        REQUIRE(TextureCooker::cook(image, test.usage, texture, psnr));
+
+        CHECK(texture.getFormat() == test.format);
+        CHECK(psnr >= test.minimum);
+        CHECK(psnr < 99.f);
+        CHECK_NEAR(TextureCooker::measurePSNR(image, texture, 0), psnr, 1e-3f);
+    }
+
+    Image normals = makeNormals(128, 128);
+    DDSFile texture;
+    float psnr = 0.f;
+    REQUIRE(TextureCooker::cook(normals, TEXTURE_NORMAL, texture, psnr));
+    CHECK(texture.getFormat() == DDS_FORMAT_BC5);
+    CHECK(psnr >= 40.f);
+}
+
+TEST(FlatBlocksKeepTheirColor)
+{
+    // a color BC1 to BC5 hold exactly (565 for BC1). BC7 mode 6 endpoints share
+    // a p-bit over all channels, so 255 and 0 in one color can be 1 off
+    uint8_t rgba[64], decoded[64], block[16];
+    for (int i = 0; i < 16; i++)
+    {
+        rgba[i * 4] = 255;
+        rgba[i * 4 + 1] = 0;
+        rgba[i * 4 + 2] = 255;
+        rgba[i * 4 + 3] = 255;
+    }
+
+    DDSFormat formats[] = { DDS_FORMAT_BC1, DDS_FORMAT_BC3, DDS_FORMAT_BC4, DDS_FORMAT_BC5, DDS_FORMAT_BC7 };
+    for (DDSFormat format : formats)
+    {
+        BlockCompression::encode(format, rgba, block);
+        BlockCompression::decode(format, block, decoded);
+
+        int channels = format == DDS_FORMAT_BC4 ? 1 : format == DDS_FORMAT_BC5 ? 2 : 4;
+        int tolerance = format == DDS_FORMAT_BC7 ? 1 : 0;
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < channels; c++)
+                CHECK(abs(decoded[i * 4 + c] - rgba[i * 4 + c]) <= tolerance);
+    }
+}
+
+TEST(MipsGoDownToOnePixel)
+{
+    // stretched up to whole blocks, then the full chain
+    Image image = makeGradient(100, 30, false, 3);
+    DDSFile texture;
+    float psnr = 0.f;
+    REQUIRE(TextureCooker::cook(image, TEXTURE_ALBEDO, texture, psnr));
+
+    CHECK(texture.getWidth() == 100);
+    CHECK(texture.getHeight() == 32);
+    CHECK(texture.getMipCount() == DDSFile::getFullMipCount(100, 32));
+    CHECK(texture.getMip(texture.getMipCount() - 1).width == 1);
+    CHECK(texture.getMip(texture.getMipCount() - 1).height == 1);
+
+    // written and read back it is the same file
+    std::vector<char> bytes;
+    texture.write(bytes);
+    DDSFile read;
+    REQUIRE(read.read(bytes.data(), bytes.size()));
+    CHECK(read.getFormat() == texture.getFormat());
+    CHECK(read.getMipCount() == texture.getMipCount());
+    for (uint32_t mip = 0; mip < read.getMipCount(); mip++)
+    {
+        REQUIRE(read.getMip(mip).size == texture.getMip(mip).size);
+        CHECK(memcmp(read.getData(mip), texture.getData(mip), read.getMip(mip).size) == 0);
+    }
+
+    CHECK(!TextureCooker::cook(Image(), TEXTURE_ALBEDO, texture, psnr));
+}
+
+TEST(ShippedTexturesMatchTheManifest)
+{
+    // cooking the textures again gives the same format and at least the quality the manifest has
+    CookManifest manifest;
+    REQUIRE(manifest.load(MANIFEST_PATH));
+    REQUIRE(manifest.getEntries().size() > 0);
+
+    for (auto const & entry : manifest.getEntries())
+    {
+        std::vector<char> bytes;
+        REQUIRE(readFile(TEXTURE_FOLDER + entry.first, bytes));
+        CHECK(CookManifest::computeHash(bytes.data(), bytes.size(), entry.second.usage) == entry.second.hash);
+
+        Image image;
+        std::string error;
+        REQUIRE(ImageDecoder::decode(bytes.data(), bytes.size(), image, error));
+
+        DDSFile texture;
+        float psnr = 0.f;
+        REQUIRE(TextureCooker::cook(image, entry.second.usage, texture, psnr));
+
+        printf("    %-24s %s %6.2f dB\n", entry.first.c_str(), entry.second.format.c_str(), psnr);
+        CHECK(psnr >= entry.second.psnr - 0.01f);
+        CHECK(psnr >= 35.f);
+        CHECK(texture.getMipCount() == DDSFile::getFullMipCount(texture.getWidth(), texture.getHeight()));
+    }
+}
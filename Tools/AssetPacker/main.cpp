@@ -0,0 +1,160 @@
+// AssetPacker: resource folders into one archive for VirtualFileSystem to
+// mount, so the game opens one file at startup instead of every resource.
+//
+// Only needs a C++17 compiler, built by the CMakeLists.txt in the repository
+// root, or by hand from there:
+//     g++ -std=c++17 -O2 -I. Tools/AssetPacker/main.cpp Graphics/include/Resources/AssetArchive.cpp Graphics/include/Resources/LZ4.cpp -o AssetPacker
+//
+// From the Engine folder, where the game runs:
+//     AssetPacker Resources/Assets.pak Resources/Models Resources/Textures Resources/Shaders Resources/Data Resources/Fonts -exclude Resources/Data/Highscore.lw
+//
+// Folders are packed with everything under them, names are the paths as
+// given. Files the game writes (the highscores) have to be excluded, they
+// would be read from the archive instead of what was saved.
+//     -store        nothing is compressed
+//     -align <n>    entry alignment, 16 by default
+//     -exclude <p>  leaves out a file, or everything under a folder
+#include <Graphics/include/Resources/AssetArchive.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define DEFAULT_ALIGNMENT 16
+
+namespace fs = std::filesystem;
+using namespace Graphics;
+
+namespace
+{
+    bool readFile(fs::path const & path, std::vector<char> & bytes)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+
+        bytes.resize((size_t)file.tellg());
+        file.seekg(0);
+        return bytes.empty() || (bool)file.read(bytes.data(), bytes.size());
+    }
+
+    // already compressed, LZ4 won't get anything out of them
+    bool isCompressed(fs::path const & path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+    }
+
+    bool isExcluded(std::string const & name, std::vector<std::string> const & excluded)
+    {
+        std::string normalized = AssetArchive::normalizeName(name);
+        for (std::string const & exclude : excluded)
+        {
+            if (normalized == exclude || (normalized.compare(0, exclude.size(), exclude) == 0 && normalized[exclude.size()] == '/'))
+                return true;
+        }
+        return false;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc < 3)
+    {
+        printf("Usage: AssetPacker <archive> <folder or file>... [-store] [-align <n>] [-exclude <path>]\n");
+        return 1;
+    }
+
+    std::string archivePath = argv[1];
+    std::vector<std::string> roots, excluded;
+    uint32_t alignment = DEFAULT_ALIGNMENT;
+    bool store = false;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-store") == 0)
+            store = true;
+        else if (strcmp(argv[i], "-align") == 0 && i + 1 < argc)
+            alignment = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-exclude") == 0 && i + 1 < argc)
+            excluded.push_back(AssetArchive::normalizeName(argv[++i]));
+        else
+            roots.push_back(argv[i]);
+    }
+
+    // sorted so the same files make the same archive
+    std::vector<fs::path> files;
+    for (std::string const & root : roots)
+    {
+        std::error_code error;
+        if (fs::is_regular_file(root, error))
+        {
+            files.push_back(root);
+            continue;
+        }
+        if (!fs::is_directory(root, error))
+        {
+            printf("%s FAILED, no such file or folder\n", root.c_str());
+            return 1;
+        }
+        for (auto const & entry : fs::recursive_directory_iterator(root, error))
+        {
+            if (entry.is_regular_file())
+                files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<AssetArchive::Input> inputs;
+    size_t total = 0;
+    for (fs::path const & file : files)
+    {
+        std::string name = file.generic_string();
+        if (isExcluded(name, excluded))
+            continue;
+
+        AssetArchive::Input input;
+        input.name = name;
+        input.compress = !store && !isCompressed(file);
+        if (!readFile(file, input.bytes))
+        {
+            printf("%s FAILED, can't be read\n", name.c_str());
+            return 1;
+        }
+
+        total += input.bytes.size();
+        inputs.push_back(std::move(input));
+    }
+
+    std::vector<char> archive;
+    std::string errors;
+    if (!AssetArchive::build(inputs, alignment, archive, errors))
+    {
+        printf("FAILED, %s\n", errors.c_str());
+        return 1;
+    }
+
+    std::ofstream output(archivePath, std::ios::binary | std::ios::trunc);
+    if (!output || !output.write(archive.data(), archive.size()))
+    {
+        printf("Can't write %s\n", archivePath.c_str());
+        return 1;
+    }
+
+    // what the game will see, read back the way it reads it
+    AssetArchive check;
+    uint32_t compressed = 0;
+    if (check.open(archive.data(), archive.size()))
+    {
+        for (uint32_t i = 0; i < check.getEntryCount(); i++)
+            compressed += (check.getEntry(i).flags & AssetArchive::ENTRY_LZ4) ? 1 : 0;
+    }
+
+    printf("%zu files, %u compressed, %zu -> %zu bytes in %s\n", inputs.size(), compressed, total, archive.size(), archivePath.c_str());
+    return 0;
+}
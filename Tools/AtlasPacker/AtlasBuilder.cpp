@@ -0,0 +1,141 @@
+#include "AtlasBuilder.h"
+#include <string.h>
+#include <algorithm>
+#include <set>
+
+namespace Graphics
+{
+    namespace
+    {
+        struct AtlasSize
+        {
+            uint32_t width, height;
+        };
+
+        // every power of two size that could fit them, smallest first
+        std::vector<AtlasSize> getSizes(uint32_t minWidth, uint32_t minHeight, uint64_t area, uint32_t maxSize)
+        {
+            std::vector<AtlasSize> sizes;
+            for (uint32_t width = 1; width <= maxSize && width != 0; width <<= 1)
+                for (uint32_t height = 1; height <= maxSize && height != 0; height <<= 1)
+                    if (width >= minWidth && height >= minHeight && (uint64_t)width * height >= area)
+                        sizes.push_back({ width, height });
+
+            std::sort(sizes.begin(), sizes.end(), [](AtlasSize const & a, AtlasSize const & b)
+            {
+                uint64_t areaA = (uint64_t)a.width * a.height, areaB = (uint64_t)b.width * b.height;
+                if (areaA != areaB)
+                    return areaA < areaB;
+                uint32_t longA = std::max(a.width, a.height), longB = std::max(b.width, b.height);
+                if (longA != longB)
+                    return longA < longB;
+                return a.width > b.width;
+            });
+            return sizes;
+        }
+
+        void copyPixel(Image & atlas, uint32_t x, uint32_t y, Image const & image, uint32_t imageX, uint32_t imageY)
+        {
+            memcpy(&atlas.pixels[((size_t)y * atlas.width + x) * 4], &image.pixels[((size_t)imageY * image.width + imageX) * 4], 4);
+        }
+
+        // the image at rect, and the bleed around it from the nearest edge pixel
+        void blit(Image & atlas, PackRect const & rect, Image const & image, uint32_t bleed)
+        {
+            for (uint32_t y = 0; y < rect.height + bleed * 2; y++)
+            {
+                uint32_t imageY = y < bleed ? 0 : std::min(y - bleed, image.height - 1);
+                for (uint32_t x = 0; x < rect.width + bleed * 2; x++)
+                {
+                    uint32_t imageX = x < bleed ? 0 : std::min(x - bleed, image.width - 1);
+                    copyPixel(atlas, rect.x - bleed + x, rect.y - bleed + y, image, imageX, imageY);
+                }
+            }
+        }
+    }
+
+    bool buildAtlas(std::vector<AtlasEntry> & entries, AtlasSettings const & settings, Image & atlas, std::string & error)
+    {
+        if (settings.bleed > settings.padding)
+        {
+            error = "the bleed has to fit in the padding";
+            return false;
+        }
+
+        std::set<std::string> names;
+        uint32_t minWidth = 0, minHeight = 0;
+        uint64_t area = 0;
+
+        for (AtlasEntry const & entry : entries)
+        {
+            if (!names.insert(entry.name).second)
+            {
+                error = "two images are named " + entry.name;
+                return false;
+            }
+            if (!entry.image || entry.image->width == 0 || entry.image->height == 0 ||
+                entry.image->pixels.size() != (size_t)entry.image->width * entry.image->height * 4)
+            {
+                error = entry.name + " has no pixels";
+                return false;
+            }
+
+            uint64_t width = (uint64_t)entry.image->width + settings.padding * 2;
+            uint64_t height = (uint64_t)entry.image->height + settings.padding * 2;
+            if (width > settings.maxSize || height > settings.maxSize)
+            {
+                error = entry.name + " is bigger than the largest atlas";
+                return false;
+            }
+
+            minWidth = std::max(minWidth, (uint32_t)width);
+            minHeight = std::max(minHeight, (uint32_t)height);
+            area += width * height;
+        }
+
+        // largest side first, then area, names last so the input order doesn't matter
+        std::vector<size_t> order(entries.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&entries](size_t a, size_t b)
+        {
+            Image const & imageA = *entries[a].image;
+            Image const & imageB = *entries[b].image;
+            uint32_t longA = std::max(imageA.width, imageA.height), longB = std::max(imageB.width, imageB.height);
+            if (longA != longB)
+                return longA > longB;
+            uint64_t areaA = (uint64_t)imageA.width * imageA.height, areaB = (uint64_t)imageB.width * imageB.height;
+            if (areaA != areaB)
+                return areaA > areaB;
+            return entries[a].name < entries[b].name;
+        });
+
+        for (AtlasSize const & size : getSizes(std::max(minWidth, 1u), std::max(minHeight, 1u), area, settings.maxSize))
+        {
+            MaxRectsPacker packer(size.width, size.height);
+            bool fits = true;
+
+            for (size_t i = 0; i < order.size() && fits; i++)
+            {
+                AtlasEntry & entry = entries[order[i]];
+                PackRect placed;
+                fits = packer.insert(entry.image->width + settings.padding * 2, entry.image->height + settings.padding * 2, placed);
+                entry.rect = { placed.x + settings.padding, placed.y + settings.padding, entry.image->width, entry.image->height };
+            }
+
+            if (!fits)
+                continue;
+
+            atlas.width = size.width;
+            atlas.height = size.height;
+            atlas.pixels.assign((size_t)size.width * size.height * 4, 0);
+
+            for (AtlasEntry const & entry : entries)
+                blit(atlas, entry.rect, *entry.image, settings.bleed);
+            return true;
+        }
+
+        error = "the images don't fit in " + std::to_string(settings.maxSize) + "x" + std::to_string(settings.maxSize);
+        return false;
+    }
+}
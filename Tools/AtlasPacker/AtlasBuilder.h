@@ -0,0 +1,45 @@
+#pragma once
+#include "MaxRectsPacker.h"
+#include <Tools/TextureCooker/ImageDecoder.h>
+#include <string>
+#include <vector>
+
+namespace Graphics
+{
+    struct AtlasSettings
+    {
+        uint32_t padding = 2;   // empty pixels on every side of an image
+        uint32_t bleed = 2;     // of the padding, how much repeats the edge pixels of the image
+        uint32_t maxSize = 4096;
+    };
+
+    struct AtlasEntry
+    {
+        std::string name;
+        Image const * image;
+        PackRect rect;          // where the image is in the atlas, without the padding
+    };
+
+    /*
+        Packs the images of the entries into one RGBA image with MaxRects,
+        the smallest power of two size they fit in, squarest first.
+
+        The biggest images are placed first. Each takes its size and the
+        padding on every side, so two images are at least twice the padding
+        apart and never closer than the padding to the atlas edge. The
+        bleed copies the outermost pixels of the image out into the padding,
+        a linear sample on the edge of the rect then mixes in the same
+        color and not its neighbour or transparent black. One pixel is
+        enough for the top mip, every mip after halves it.
+
+        The same entries in any order give the same atlas.
+
+        HOW TO USE:
+            std::vector<AtlasEntry> entries = { { "button", &buttonImage } };
+            Image atlas;
+            if (!buildAtlas(entries, AtlasSettings(), atlas, error))
+                // error says why
+            // entries[0].rect is where the button is
+    */
+    bool buildAtlas(std::vector<AtlasEntry> & entries, AtlasSettings const & settings, Image & atlas, std::string & error);
+}
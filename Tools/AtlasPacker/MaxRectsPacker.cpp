@@ -0,0 +1,132 @@
+#include "MaxRectsPacker.h"
+#include <algorithm>
+
+namespace Graphics
+{
+    namespace
+    {
+        bool overlaps(PackRect const & a, PackRect const & b)
+        {
+            return a.x < b.x + b.width && b.x < a.x + a.width &&
+                   a.y < b.y + b.height && b.y < a.y + a.height;
+        }
+
+        bool contains(PackRect const & outer, PackRect const & inner)
+        {
+            return inner.x >= outer.x && inner.y >= outer.y &&
+                   inner.x + inner.width <= outer.x + outer.width &&
+                   inner.y + inner.height <= outer.y + outer.height;
+        }
+    }
+
+    MaxRectsPacker::MaxRectsPacker(uint32_t width, uint32_t height)
+        : width(width)
+        , height(height)
+        , usedArea(0)
+    {
+        if (width > 0 && height > 0)
+            freeRects.push_back({ 0, 0, width, height });
+    }
+
+    bool MaxRectsPacker::insert(uint32_t width, uint32_t height, PackRect & placed)
+    {
+        if (width == 0 || height == 0)
+            return false;
+
+        const PackRect * best = nullptr;
+        uint32_t bestShortSide = UINT32_MAX, bestLongSide = UINT32_MAX;
+
+        for (PackRect const & free : freeRects)
+        {
+            if (free.width < width || free.height < height)
+                continue;
+
+            uint32_t leftX = free.width - width, leftY = free.height - height;
+            uint32_t shortSide = std::min(leftX, leftY), longSide = std::max(leftX, leftY);
+
+            // ties go to the long side, then the top left most so the result doesn't depend on the free list order
+            bool better = shortSide < bestShortSide ||
+                (shortSide == bestShortSide && (longSide < bestLongSide ||
+                (longSide == bestLongSide && (free.y < best->y || (free.y == best->y && free.x < best->x)))));
+
+            if (better)
+            {
+                best = &free;
+                bestShortSide = shortSide;
+                bestLongSide = longSide;
+            }
+        }
+
+        if (!best)
+            return false;
+
+        placed = { best->x, best->y, width, height };
+        split(placed);
+        prune();
+
+        usedArea += (uint64_t)width * height;
+        return true;
+    }
+
+    float MaxRectsPacker::getOccupancy() const
+    {
+        uint64_t area = (uint64_t)width * height;
+        return area ? (float)((double)usedArea / area) : 0.f;
+    }
+
+    std::vector<PackRect> const & MaxRectsPacker::getFreeRects() const
+    {
+        return freeRects;
+    }
+
+    void MaxRectsPacker::split(PackRect const & placed)
+    {
+        std::vector<PackRect> remaining;
+        remaining.reserve(freeRects.size() + 4);
+
+        for (PackRect const & free : freeRects)
+        {
+            if (!overlaps(free, placed))
+            {
+                remaining.push_back(free);
+                continue;
+            }
+
+            // up to four, one for each side of placed that is inside free
+            if (placed.x > free.x)
+                remaining.push_back({ free.x, free.y, placed.x - free.x, free.height });
+            if (placed.x + placed.width < free.x + free.width)
+                remaining.push_back({ placed.x + placed.width, free.y, free.x + free.width - placed.x - placed.width, free.height });
+            if (placed.y > free.y)
+                remaining.push_back({ free.x, free.y, free.width, placed.y - free.y });
+            if (placed.y + placed.height < free.y + free.height)
+                remaining.push_back({ free.x, placed.y + placed.height, free.width, free.y + free.height - placed.y - placed.height });
+        }
+
+        freeRects.swap(remaining);
+    }
+
+    void MaxRectsPacker::prune()
+    {
+        // of two that are the same, the first one stays
+        for (size_t i = 0; i < freeRects.size(); i++)
+        {
+            for (size_t j = i + 1; j < freeRects.size();)
+            {
+                if (contains(freeRects[i], freeRects[j]))
+                {
+                    freeRects.erase(freeRects.begin() + j);
+                }
+                else if (contains(freeRects[j], freeRects[i]))
+                {
+                    freeRects.erase(freeRects.begin() + i);
+                    j = i + 1;
+                }
+                else
+                {
+                    j++;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+namespace Graphics
+{
+    struct PackRect
+    {
+        uint32_t x, y;
+        uint32_t width, height;
+    };
+
+    /*
+        Places rectangles in a fixed size area with Jukka Jylanki's MaxRects
+        ("A Thousand Ways to Pack the Bin"). The free space is kept as the
+        largest rectangles that fit in it, they overlap each other. A new
+        rectangle goes in the top left of the free one it leaves the least
+        space in on its shorter side (best short side fit), then every free
+        rectangle it overlaps is split around it and the ones inside
+        another are dropped.
+
+        Rectangles are never rotated, the UVs of a rotated image would have
+        to be too.
+
+        HOW TO USE:
+            MaxRectsPacker packer(512, 512);
+            PackRect placed;
+            if (!packer.insert(width, height, placed))
+                // doesn't fit, try a bigger area
+    */
+    class MaxRectsPacker
+    {
+    public:
+        MaxRectsPacker(uint32_t width, uint32_t height);
+
+        // false if there is no room left for it, nothing is changed then
+        bool insert(uint32_t width, uint32_t height, PackRect & placed);
+
+        // of the area, what the inserted rectangles cover
+        float getOccupancy() const;
+        std::vector<PackRect> const & getFreeRects() const;
+    private:
+        uint32_t width, height;
+        uint64_t usedArea;
+        std::vector<PackRect> freeRects;
+
+        // replaces the free rectangles placed overlaps with what is left of them
+        void split(PackRect const & placed);
+        void prune();
+    };
+}
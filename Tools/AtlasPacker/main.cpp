@@ -0,0 +1,184 @@
+// AtlasPacker: the UI textures into one atlas, so the menu and the HUD draw
+// every quad of a frame with the same texture bound.
+//
+// Only needs a C++17 compiler, built by the CMakeLists.txt in the repository
+// root, or by hand from there:
+//     g++ -std=c++17 -O2 -I. Tools/AtlasPacker/*.cpp Tools/TextureCooker/ImageDecoder.cpp Graphics/include/Resources/DDSFile.cpp -o AtlasPacker
+//
+// From the Engine folder, where the game runs:
+//     AtlasPacker Resources/Textures Resources/Textures/Cooked/UIAtlas.dds Resources/Data/UIAtlas.lw button.png crosshair.png HPbar.png
+//
+// Unlike the other cooked textures UIAtlas.dds is committed, pack it again
+// and commit it with the table when one of the images changes.
+//
+// The images are in the texture folder, each is named by its file name
+// without the extension in the table. The atlas is RGBA without mips, the
+// UI is drawn at about its size and block compression would bleed across
+// the padding. The table is a .lw file with the atlas first, then a block
+// for every image with where it is in pixels and UVs.
+//     -padding <n>  empty pixels around every image, 2 by default
+//     -bleed <n>    of the padding, how much repeats the image edge, 2 by default
+//     -max <n>      largest atlas width and height, 4096 by default
+#include "AtlasBuilder.h"
+#include <Graphics/include/Resources/DDSFile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace Graphics;
+
+namespace
+{
+    bool readFile(fs::path const & path, std::vector<char> & bytes)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+
+        bytes.resize((size_t)file.tellg());
+        file.seekg(0);
+        return bytes.empty() || (bool)file.read(bytes.data(), bytes.size());
+    }
+
+    bool writeFile(fs::path const & path, const char * bytes, size_t size)
+    {
+        std::error_code error;
+        if (path.has_parent_path())
+            fs::create_directories(path.parent_path(), error);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        return file && file.write(bytes, size);
+    }
+
+    std::string formatFloat(float value)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.9gf", value);
+        return text;
+    }
+
+    // the way Logic::FileLoader reads them, strings in quotes, floats end with an f
+    std::string writeTable(std::string const & texture, Image const & atlas, AtlasSettings const & settings, std::vector<AtlasEntry> const & entries, std::vector<std::string> const & files)
+    {
+        std::string table;
+        table += "{\n";
+        table += "\t\"texture\" : \"" + texture + "\";\n";
+        table += "\t\"width\" : " + std::to_string(atlas.width) + ";\n";
+        table += "\t\"height\" : " + std::to_string(atlas.height) + ";\n";
+        table += "\t\"padding\" : " + std::to_string(settings.padding) + ";\n";
+        table += "\t\"bleed\" : " + std::to_string(settings.bleed) + ";\n";
+        table += "}\n";
+
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            PackRect const & rect = entries[i].rect;
+            table += "\n{\n";
+            table += "\t\"name\" : \"" + entries[i].name + "\";\n";
+            table += "\t\"file\" : \"" + files[i] + "\";\n";
+            table += "\t\"x\" : " + std::to_string(rect.x) + ";\n";
+            table += "\t\"y\" : " + std::to_string(rect.y) + ";\n";
+            table += "\t\"width\" : " + std::to_string(rect.width) + ";\n";
+            table += "\t\"height\" : " + std::to_string(rect.height) + ";\n";
+            table += "\t\"uStart\" : " + formatFloat((float)rect.x / atlas.width) + ";\n";
+            table += "\t\"vStart\" : " + formatFloat((float)rect.y / atlas.height) + ";\n";
+            table += "\t\"uEnd\" : " + formatFloat((float)(rect.x + rect.width) / atlas.width) + ";\n";
+            table += "\t\"vEnd\" : " + formatFloat((float)(rect.y + rect.height) / atlas.height) + ";\n";
+            table += "}\n";
+        }
+        return table;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc < 5)
+    {
+        printf("Usage: AtlasPacker <texture folder> <atlas .dds> <table .lw> <images...> [-padding <n>] [-bleed <n>] [-max <n>]\n");
+        return 1;
+    }
+
+    fs::path sourceFolder = argv[1];
+    fs::path atlasPath = argv[2];
+    fs::path tablePath = argv[3];
+    AtlasSettings settings;
+    std::vector<std::string> files;
+
+    for (int i = 4; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-padding") == 0 && i + 1 < argc)
+            settings.padding = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-bleed") == 0 && i + 1 < argc)
+            settings.bleed = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-max") == 0 && i + 1 < argc)
+            settings.maxSize = (uint32_t)atoi(argv[++i]);
+        else
+            files.push_back(fs::path(argv[i]).generic_string());
+    }
+
+    // the game finds the atlas from TEXTURE_PATH_SIMPLE, like the images
+    std::string texture = fs::relative(atlasPath, sourceFolder).generic_string();
+    if (texture.empty() || texture.compare(0, 2, "..") == 0)
+    {
+        printf("%s has to be in %s\n", atlasPath.string().c_str(), sourceFolder.string().c_str());
+        return 1;
+    }
+
+    std::vector<Image> images(files.size());
+    std::vector<AtlasEntry> entries(files.size());
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        std::vector<char> bytes;
+        std::string error;
+        if (!readFile(sourceFolder / files[i], bytes) || !ImageDecoder::decode(bytes.data(), bytes.size(), images[i], error))
+        {
+            printf("%-28s FAILED, %s\n", files[i].c_str(), error.empty() ? "can't be read" : error.c_str());
+            return 1;
+        }
+
+        entries[i].name = fs::path(files[i]).stem().string();
+        entries[i].image = &images[i];
+    }
+
+    Image atlas;
+    std::string error;
+    if (!buildAtlas(entries, settings, atlas, error))
+    {
+        printf("Can't pack the atlas, %s\n", error.c_str());
+        return 1;
+    }
+
+    DDSFile dds;
+    dds.create(atlas.width, atlas.height, DDS_FORMAT_R8G8B8A8, 1);
+    memcpy(dds.getData(0), atlas.pixels.data(), atlas.pixels.size());
+
+    std::vector<char> ddsBytes;
+    dds.write(ddsBytes);
+    if (!writeFile(atlasPath, ddsBytes.data(), ddsBytes.size()))
+    {
+        printf("Can't write %s\n", atlasPath.string().c_str());
+        return 1;
+    }
+
+    std::string table = writeTable(texture, atlas, settings, entries, files);
+    if (!writeFile(tablePath, table.data(), table.size()))
+    {
+        printf("Can't write %s\n", tablePath.string().c_str());
+        return 1;
+    }
+
+    uint64_t used = 0;
+    for (AtlasEntry const & entry : entries)
+    {
+        used += (uint64_t)entry.rect.width * entry.rect.height;
+        printf("%-28s %4ux%-4u at %4u, %-4u\n", entry.name.c_str(), entry.rect.width, entry.rect.height, entry.rect.x, entry.rect.y);
+    }
+    printf("%ux%u atlas, %zu images, %.1f%% used, %zu bytes\n", atlas.width, atlas.height, entries.size(),
+        100.0 * used / ((uint64_t)atlas.width * atlas.height), ddsBytes.size());
+    return 0;
+}
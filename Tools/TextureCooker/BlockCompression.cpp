@@ -0,0 +1,726 @@
+#include "BlockCompression.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define BC_REFINE_ITERATIONS 3
+
+namespace Graphics
+{
+    namespace
+    {
+        const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        float clampFloat(float value, float low, float high)
+        {
+            return value < low ? low : value > high ? high : value;
+        }
+
+        // power iteration on the covariance of the pixels, channels is 3 or 4
+        void principalAxis(const float pixels[16][4], int channels, float mean[4], float axis[4])
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                mean[c] = 0;
+                for (int i = 0; i < 16; i++)
+                    mean[c] += pixels[i][c];
+                mean[c] /= 16.f;
+            }
+
+            float covariance[4][4] = {};
+            for (int i = 0; i < 16; i++)
+            {
+                for (int a = 0; a < channels; a++)
+                {
+                    for (int b = 0; b < channels; b++)
+                        covariance[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+                }
+            }
+
+            // start from the diagonal of the bounding box, it is close most of the time
+            float low[4] = { 255, 255, 255, 255 }, high[4] = { 0, 0, 0, 0 };
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < channels; c++)
+                {
+                    low[c] = fminf(low[c], pixels[i][c]);
+                    high[c] = fmaxf(high[c], pixels[i][c]);
+                }
+            }
+
+            for (int c = 0; c < 4; c++)
+                axis[c] = c < channels ? high[c] - low[c] : 0;
+
+            for (int iteration = 0; iteration < 8; iteration++)
+            {
+                float next[4] = {};
+                for (int a = 0; a < channels; a++)
+                {
+                    for (int b = 0; b < channels; b++)
+                        next[a] += covariance[a][b] * axis[b];
+                }
+
+                float length = 0;
+                for (int c = 0; c < channels; c++)
+                    length = fmaxf(length, fabsf(next[c]));
+                if (length < 1e-6f)
+                    break;
+
+                for (int c = 0; c < channels; c++)
+                    axis[c] = next[c] / length;
+            }
+
+            float length = 0;
+            for (int c = 0; c < channels; c++)
+                length += axis[c] * axis[c];
+            length = sqrtf(length);
+
+            for (int c = 0; c < channels; c++)
+                axis[c] = length > 1e-6f ? axis[c] / length : 0;
+        }
+
+        // the ends of the pixels projected on the axis
+        void axisEndpoints(const float pixels[16][4], int channels, float low[4], float high[4])
+        {
+            float mean[4], axis[4];
+            principalAxis(pixels, channels, mean, axis);
+
+            float minT = 0, maxT = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                float t = 0;
+                for (int c = 0; c < channels; c++)
+                    t += (pixels[i][c] - mean[c]) * axis[c];
+                minT = fminf(minT, t);
+                maxT = fmaxf(maxT, t);
+            }
+
+            for (int c = 0; c < 4; c++)
+            {
+                low[c] = c < channels ? clampFloat(mean[c] + axis[c] * minT, 0, 255) : 0;
+                high[c] = c < channels ? clampFloat(mean[c] + axis[c] * maxT, 0, 255) : 0;
+            }
+        }
+
+        // Least squares endpoints for the indices, weight is how much of the first endpoint
+        // each index is. False when every pixel got the same weight, there is nothing to solve
+        bool fitEndpoints(const float pixels[16][4], int channels, const uint8_t indices[16], const float * weights, float first[4], float second[4])
+        {
+            float aa = 0, ab = 0, bb = 0;
+            float ap[4] = {}, bp[4] = {};
+
+            for (int i = 0; i < 16; i++)
+            {
+                float a = weights[indices[i]];
+                float b = 1.f - a;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (int c = 0; c < channels; c++)
+                {
+                    ap[c] += a * pixels[i][c];
+                    bp[c] += b * pixels[i][c];
+                }
+            }
+
+            float determinant = aa * bb - ab * ab;
+            if (fabsf(determinant) < 1e-6f)
+                return false;
+
+            for (int c = 0; c < channels; c++)
+            {
+                first[c] = clampFloat((ap[c] * bb - bp[c] * ab) / determinant, 0, 255);
+                second[c] = clampFloat((bp[c] * aa - ap[c] * ab) / determinant, 0, 255);
+            }
+
+            return true;
+        }
+
+        void loadPixels(const uint8_t * rgba, float pixels[16][4])
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                    pixels[i][c] = rgba[i * 4 + c];
+            }
+        }
+
+        // the closest of count palette entries for every pixel, returns the squared error
+        float chooseIndices(const float pixels[16][4], int channels, const int palette[][4], int count, uint8_t indices[16])
+        {
+            float total = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                float best = 1e30f;
+                for (int p = 0; p < count; p++)
+                {
+                    float error = 0;
+                    for (int c = 0; c < channels; c++)
+                    {
+                        float difference = pixels[i][c] - palette[p][c];
+                        error += difference * difference;
+                    }
+
+                    if (error < best)
+                    {
+                        best = error;
+                        indices[i] = (uint8_t)p;
+                    }
+                }
+                total += best;
+            }
+
+            return total;
+        }
+
+        /////////////////////////////////////////////////////////////////// BC1
+
+        uint16_t pack565(const float color[4])
+        {
+            int r = (int)(color[0] * 31.f / 255.f + 0.5f);
+            int g = (int)(color[1] * 63.f / 255.f + 0.5f);
+            int b = (int)(color[2] * 31.f / 255.f + 0.5f);
+            return (uint16_t)((r << 11) | (g << 5) | b);
+        }
+
+        void unpack565(uint16_t packed, int color[4])
+        {
+            int r = packed >> 11 & 31, g = packed >> 5 & 63, b = packed & 31;
+            color[0] = (r << 3) | (r >> 2);
+            color[1] = (g << 2) | (g >> 4);
+            color[2] = (b << 3) | (b >> 2);
+            color[3] = 255;
+        }
+
+        // the 4 color palette, what BC2/3 always use and BC1 when the first endpoint is bigger
+        void paletteBC1(uint16_t first, uint16_t second, int palette[4][4], bool fourColors)
+        {
+            unpack565(first, palette[0]);
+            unpack565(second, palette[1]);
+            for (int c = 0; c < 4; c++)
+            {
+                if (fourColors)
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+                }
+                else
+                {
+                    // the last one is transparent black
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+        }
+
+        // Single colors come out best from the 2/3 entry of a pair, per channel and bit depth
+        struct SingleColorTable
+        {
+            uint8_t first[2][256];
+            uint8_t second[2][256];
+
+            SingleColorTable()
+            {
+                for (int depth = 0; depth < 2; depth++)
+                {
+                    int bits = depth == 0 ? 5 : 6;
+                    int levels = 1 << bits;
+
+                    for (int value = 0; value < 256; value++)
+                    {
+                        int bestError = 256;
+                        for (int a = 0; a < levels; a++)
+                        {
+                            for (int b = 0; b < levels; b++)
+                            {
+                                int expandedA = bits == 5 ? (a << 3) | (a >> 2) : (a << 2) | (a >> 4);
+                                int expandedB = bits == 5 ? (b << 3) | (b >> 2) : (b << 2) | (b >> 4);
+                                int error = abs((2 * expandedA + expandedB + 1) / 3 - value);
+                                if (error < bestError)
+                                {
+                                    bestError = error;
+                                    first[depth][value] = (uint8_t)a;
+                                    second[depth][value] = (uint8_t)b;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        };
+
+        void writeBC1(uint16_t first, uint16_t second, const uint8_t indices[16], uint8_t * block)
+        {
+            uint32_t bits = 0;
+            for (int i = 0; i < 16; i++)
+                bits |= (uint32_t)(indices[i] & 3) << (i * 2);
+
+            block[0] = (uint8_t)first;
+            block[1] = (uint8_t)(first >> 8);
+            block[2] = (uint8_t)second;
+            block[3] = (uint8_t)(second >> 8);
+            memcpy(block + 4, &bits, 4);
+        }
+
+        void encodeColorBlock(const uint8_t * rgba, uint8_t * block)
+        {
+            float pixels[16][4];
+            loadPixels(rgba, pixels);
+
+            bool single = true;
+            for (int i = 1; i < 16 && single; i++)
+                single = memcmp(rgba, rgba + i * 4, 3) == 0;
+
+            uint8_t indices[16];
+            if (single)
+            {
+                static const SingleColorTable table;
+                uint16_t first = (uint16_t)((table.first[0][rgba[0]] << 11) | (table.first[1][rgba[1]] << 5) | table.first[0][rgba[2]]);
+                uint16_t second = (uint16_t)((table.second[0][rgba[0]] << 11) | (table.second[1][rgba[1]] << 5) | table.second[0][rgba[2]]);
+
+                // index 2 is 2/3 of the first, 3 is 2/3 of the second
+                uint8_t index = 2;
+                if (first < second)
+                {
+                    uint16_t swap = first;
+                    first = second;
+                    second = swap;
+                    index = 3;
+                }
+                else if (first == second)
+                {
+                    index = 0;
+                }
+
+                memset(indices, index, 16);
+                writeBC1(first, second, indices, block);
+                return;
+            }
+
+            static const float WEIGHTS[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+            float low[4], high[4];
+            axisEndpoints(pixels, 3, low, high);
+
+            uint16_t bestFirst = 0, bestSecond = 0;
+            uint8_t bestIndices[16] = {};
+            float bestError = 1e30f;
+
+            float first[4] = { high[0], high[1], high[2], 0 };
+            float second[4] = { low[0], low[1], low[2], 0 };
+
+            for (int iteration = 0; iteration < BC_REFINE_ITERATIONS; iteration++)
+            {
+                uint16_t packedFirst = pack565(first), packedSecond = pack565(second);
+
+                int palette[4][4];
+                paletteBC1(packedFirst, packedSecond, palette, true);
+                float error = chooseIndices(pixels, 3, palette, 4, indices);
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestFirst = packedFirst;
+                    bestSecond = packedSecond;
+                    memcpy(bestIndices, indices, 16);
+                }
+
+                if (!fitEndpoints(pixels, 3, bestIndices, WEIGHTS, first, second))
+                    break;
+            }
+
+            // the 4 color mode needs the first endpoint bigger, swapping them flips the indices
+            if (bestFirst < bestSecond)
+            {
+                uint16_t swap = bestFirst;
+                bestFirst = bestSecond;
+                bestSecond = swap;
+                for (int i = 0; i < 16; i++)
+                    bestIndices[i] ^= 1;
+            }
+            else if (bestFirst == bestSecond)
+            {
+                memset(bestIndices, 0, 16);
+            }
+
+            writeBC1(bestFirst, bestSecond, bestIndices, block);
+        }
+
+        /////////////////////////////////////////////////////////////////// BC4
+
+        void paletteBC4(int first, int second, int palette[8])
+        {
+            palette[0] = first;
+            palette[1] = second;
+            if (first > second)
+            {
+                for (int i = 1; i < 7; i++)
+                    palette[i + 1] = ((7 - i) * first + i * second + 3) / 7;
+            }
+            else
+            {
+                for (int i = 1; i < 5; i++)
+                    palette[i + 1] = ((5 - i) * first + i * second + 2) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        int chooseIndicesBC4(const uint8_t values[16], int first, int second, uint8_t indices[16])
+        {
+            int palette[8];
+            paletteBC4(first, second, palette);
+
+            int total = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                int best = INT32_MAX;
+                for (int p = 0; p < 8; p++)
+                {
+                    int error = (values[i] - palette[p]) * (values[i] - palette[p]);
+                    if (error < best)
+                    {
+                        best = error;
+                        indices[i] = (uint8_t)p;
+                    }
+                }
+                total += best;
+            }
+
+            return total;
+        }
+
+        // values is the channel, 16 of them
+        void encodeChannelBlock(const uint8_t values[16], uint8_t * block)
+        {
+            int low = 255, high = 0;
+            int innerLow = 255, innerHigh = 0;  // without 0 and 255, what the 6 value mode has to span
+            for (int i = 0; i < 16; i++)
+            {
+                low = values[i] < low ? values[i] : low;
+                high = values[i] > high ? values[i] : high;
+                if (values[i] != 0 && values[i] != 255)
+                {
+                    innerLow = values[i] < innerLow ? values[i] : innerLow;
+                    innerHigh = values[i] > innerHigh ? values[i] : innerHigh;
+                }
+            }
+
+            int bestFirst = low, bestSecond = low;
+            uint8_t bestIndices[16] = {};
+            int bestError = INT32_MAX;
+            uint8_t indices[16];
+
+            if (low == high)
+            {
+                bestError = 0;
+            }
+            else
+            {
+                // 8 values between the ends, moved in a little to see if the levels fit better
+                for (int top = high; top >= high - 3 && top > low; top--)
+                {
+                    for (int bottom = low; bottom <= low + 3 && bottom < top; bottom++)
+                    {
+                        int error = chooseIndicesBC4(values, top, bottom, indices);
+                        if (error < bestError)
+                        {
+                            bestError = error;
+                            bestFirst = top;
+                            bestSecond = bottom;
+                            memcpy(bestIndices, indices, 16);
+                        }
+                    }
+                }
+
+                // 6 values with exact 0 and 255, for blocks that have both ends and something in between
+                if (innerLow > innerHigh)
+                {
+                    innerLow = 0;
+                    innerHigh = 0;
+                }
+
+                int error = chooseIndicesBC4(values, innerLow, innerHigh, indices);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestFirst = innerLow;
+                    bestSecond = innerHigh;
+                    memcpy(bestIndices, indices, 16);
+                }
+            }
+
+            uint64_t bits = 0;
+            for (int i = 0; i < 16; i++)
+                bits |= (uint64_t)(bestIndices[i] & 7) << (i * 3);
+
+            block[0] = (uint8_t)bestFirst;
+            block[1] = (uint8_t)bestSecond;
+            for (int i = 0; i < 6; i++)
+                block[2 + i] = (uint8_t)(bits >> (i * 8));
+        }
+
+        void decodeChannelBlock(const uint8_t * block, uint8_t * rgba, int channel)
+        {
+            int palette[8];
+            paletteBC4(block[0], block[1], palette);
+
+            uint64_t bits = 0;
+            for (int i = 0; i < 6; i++)
+                bits |= (uint64_t)block[2 + i] << (i * 8);
+
+            for (int i = 0; i < 16; i++)
+                rgba[i * 4 + channel] = (uint8_t)palette[bits >> (i * 3) & 7];
+        }
+
+        void decodeColorBlock(const uint8_t * block, uint8_t * rgba, bool alwaysFourColors)
+        {
+            uint16_t first = (uint16_t)(block[0] | (block[1] << 8));
+            uint16_t second = (uint16_t)(block[2] | (block[3] << 8));
+
+            int palette[4][4];
+            paletteBC1(first, second, palette, alwaysFourColors || first > second);
+
+            uint32_t bits;
+            memcpy(&bits, block + 4, 4);
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                    rgba[i * 4 + c] = (uint8_t)palette[bits >> (i * 2) & 3][c];
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////// BC7
+
+        class BitWriter
+        {
+        public:
+            BitWriter(uint8_t * block) : block(block), pos(0) { memset(block, 0, 16); }
+
+            void write(uint32_t value, int count)
+            {
+                for (int i = 0; i < count; i++, pos++)
+                    block[pos >> 3] |= (uint8_t)(((value >> i) & 1) << (pos & 7));
+            }
+        private:
+            uint8_t * block;
+            int pos;
+        };
+
+        class BitReader
+        {
+        public:
+            BitReader(const uint8_t * block) : block(block), pos(0) {}
+
+            uint32_t read(int count)
+            {
+                uint32_t value = 0;
+                for (int i = 0; i < count; i++, pos++)
+                    value |= (uint32_t)((block[pos >> 3] >> (pos & 7)) & 1) << i;
+                return value;
+            }
+        private:
+            const uint8_t * block;
+            int pos;
+        };
+
+        // 7 bits and the p bit as the lowest one
+        int quantizeBC7(float value, int pBit)
+        {
+            int level = (int)floorf((value - pBit) / 2.f + 0.5f);
+            level = level < 0 ? 0 : level > 127 ? 127 : level;
+            return (level << 1) | pBit;
+        }
+
+        void paletteBC7(const int first[4], const int second[4], int palette[16][4])
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                    palette[i][c] = ((64 - BC7_WEIGHTS[i]) * first[c] + BC7_WEIGHTS[i] * second[c] + 32) >> 6;
+            }
+        }
+    }
+
+    void BlockCompression::encodeBC1(const uint8_t * rgba, uint8_t * block)
+    {
+        encodeColorBlock(rgba, block);
+    }
+
+    void BlockCompression::encodeBC3(const uint8_t * rgba, uint8_t * block)
+    {
+        uint8_t alpha[16];
+        for (int i = 0; i < 16; i++)
+            alpha[i] = rgba[i * 4 + 3];
+
+        encodeChannelBlock(alpha, block);
+        encodeColorBlock(rgba, block + 8);
+    }
+
+    void BlockCompression::encodeBC4(const uint8_t * rgba, uint8_t * block)
+    {
+        uint8_t red[16];
+        for (int i = 0; i < 16; i++)
+            red[i] = rgba[i * 4];
+
+        encodeChannelBlock(red, block);
+    }
+
+    void BlockCompression::encodeBC5(const uint8_t * rgba, uint8_t * block)
+    {
+        uint8_t red[16], green[16];
+        for (int i = 0; i < 16; i++)
+        {
+            red[i] = rgba[i * 4];
+            green[i] = rgba[i * 4 + 1];
+        }
+
+        encodeChannelBlock(red, block);
+        encodeChannelBlock(green, block + 8);
+    }
+
+    void BlockCompression::encodeBC7(const uint8_t * rgba, uint8_t * block)
+    {
+        float pixels[16][4];
+        loadPixels(rgba, pixels);
+
+        // how much of the first endpoint each index is
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+            weights[i] = 1.f - BC7_WEIGHTS[i] / 64.f;
+
+        float first[4], second[4];
+        axisEndpoints(pixels, 4, first, second);
+
+        int bestFirst[4] = {}, bestSecond[4] = {};
+        uint8_t bestIndices[16] = {};
+        float bestError = 1e30f;
+        uint8_t indices[16];
+
+        for (int iteration = 0; iteration < BC_REFINE_ITERATIONS; iteration++)
+        {
+            // one p bit per endpoint, shared by its channels
+            for (int pBits = 0; pBits < 4; pBits++)
+            {
+                int quantizedFirst[4], quantizedSecond[4];
+                for (int c = 0; c < 4; c++)
+                {
+                    quantizedFirst[c] = quantizeBC7(first[c], pBits & 1);
+                    quantizedSecond[c] = quantizeBC7(second[c], pBits >> 1);
+                }
+
+                int palette[16][4];
+                paletteBC7(quantizedFirst, quantizedSecond, palette);
+                float error = chooseIndices(pixels, 4, palette, 16, indices);
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    memcpy(bestFirst, quantizedFirst, sizeof(bestFirst));
+                    memcpy(bestSecond, quantizedSecond, sizeof(bestSecond));
+                    memcpy(bestIndices, indices, 16);
+                }
+            }
+
+            if (bestError == 0 || !fitEndpoints(pixels, 4, bestIndices, weights, first, second))
+                break;
+        }
+
+        // the first index only has 3 bits, its top one is taken to be 0
+        if (bestIndices[0] >= 8)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                int swap = bestFirst[c];
+                bestFirst[c] = bestSecond[c];
+                bestSecond[c] = swap;
+            }
+            for (int i = 0; i < 16; i++)
+                bestIndices[i] = (uint8_t)(15 - bestIndices[i]);
+        }
+
+        BitWriter writer(block);
+        writer.write(1 << 6, 7);
+        for (int c = 0; c < 4; c++)
+        {
+            writer.write(bestFirst[c] >> 1, 7);
+            writer.write(bestSecond[c] >> 1, 7);
+        }
+        writer.write(bestFirst[0] & 1, 1);
+        writer.write(bestSecond[0] & 1, 1);
+
+        writer.write(bestIndices[0], 3);
+        for (int i = 1; i < 16; i++)
+            writer.write(bestIndices[i], 4);
+    }
+
+    void BlockCompression::decode(DDSFormat format, const uint8_t * block, uint8_t * rgba)
+    {
+        memset(rgba, 0, 64);
+        for (int i = 0; i < 16; i++)
+            rgba[i * 4 + 3] = 255;
+
+        switch (format)
+        {
+        case DDS_FORMAT_BC1:
+            decodeColorBlock(block, rgba, false);
+            break;
+        case DDS_FORMAT_BC3:
+            decodeColorBlock(block + 8, rgba, true);
+            decodeChannelBlock(block, rgba, 3);
+            break;
+        case DDS_FORMAT_BC4:
+            decodeChannelBlock(block, rgba, 0);
+            break;
+        case DDS_FORMAT_BC5:
+            decodeChannelBlock(block, rgba, 0);
+            decodeChannelBlock(block + 8, rgba, 1);
+            break;
+        case DDS_FORMAT_BC7:
+        {
+            BitReader reader(block);
+            if (reader.read(7) != 1 << 6)
+                break;
+
+            int first[4], second[4];
+            for (int c = 0; c < 4; c++)
+            {
+                first[c] = reader.read(7) << 1;
+                second[c] = reader.read(7) << 1;
+            }
+
+            int firstPBit = reader.read(1), secondPBit = reader.read(1);
+            for (int c = 0; c < 4; c++)
+            {
+                first[c] |= firstPBit;
+                second[c] |= secondPBit;
+            }
+
+            int palette[16][4];
+            paletteBC7(first, second, palette);
+            for (int i = 0; i < 16; i++)
+            {
+                int index = reader.read(i == 0 ? 3 : 4);
+                for (int c = 0; c < 4; c++)
+                    rgba[i * 4 + c] = (uint8_t)palette[index][c];
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void BlockCompression::encode(DDSFormat format, const uint8_t * rgba, uint8_t * block)
+    {
+        switch (format)
+        {
+        case DDS_FORMAT_BC1: encodeBC1(rgba, block); break;
+        case DDS_FORMAT_BC3: encodeBC3(rgba, block); break;
+        case DDS_FORMAT_BC4: encodeBC4(rgba, block); break;
+        case DDS_FORMAT_BC5: encodeBC5(rgba, block); break;
+        case DDS_FORMAT_BC7: encodeBC7(rgba, block); break;
+        default: break;
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+#include <Graphics/include/Resources/DDSFile.h>
+
+namespace Graphics
+{
+    /*
+        Encoders for one 4x4 block: rgba is the 16 pixels row by row, 4 bytes
+        each, block is where the 8 or 16 bytes of the format go.
+
+            BC1  color, always the opaque 4 color mode
+            BC3  BC1 color and a BC4 alpha block
+            BC4  one channel (red)
+            BC5  two channels, red and green, as two BC4 blocks
+            BC7  mode 6 only: one subset, RGBA endpoints with 16 levels.
+                 The other modes could do better on blocks with two or
+                 three colors, mode 6 is the one that is good everywhere
+
+        The endpoints are fit along the principal axis of the block and then
+        refined with least squares on the indices they got, keeping what has
+        the least squared error. Not as good as the exhaustive encoders, but
+        fast enough to cook the whole folder in a few seconds.
+
+        decode is for measuring what the encoders did, BC7 only reads mode 6.
+    */
+    class BlockCompression
+    {
+    public:
+        static void encodeBC1(const uint8_t * rgba, uint8_t * block);
+        static void encodeBC3(const uint8_t * rgba, uint8_t * block);
+        static void encodeBC4(const uint8_t * rgba, uint8_t * block);
+        static void encodeBC5(const uint8_t * rgba, uint8_t * block);
+        static void encodeBC7(const uint8_t * rgba, uint8_t * block);
+
+        // what is missing in the format is 0, alpha 255
+        static void decode(DDSFormat format, const uint8_t * block, uint8_t * rgba);
+
+        static void encode(DDSFormat format, const uint8_t * rgba, uint8_t * block);
+    };
+}
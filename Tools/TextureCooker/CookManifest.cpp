@@ -0,0 +1,102 @@
+#include "CookManifest.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+// bump when the cooker makes something different from the same source
+#define COOKER_VERSION 1
+
+namespace Graphics
+{
+    bool CookManifest::load(std::string const & path)
+    {
+        entries.clear();
+
+        std::ifstream file(path);
+        if (!file)
+            return true;
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream fields(line);
+            std::string name, usage;
+            Entry entry;
+
+            if (!(fields >> name >> usage >> std::hex >> entry.hash >> std::dec >> entry.format >> entry.psnr) ||
+                !TextureCooker::parseUsage(usage, entry.usage))
+            {
+                return false;
+            }
+
+            entries[name] = entry;
+        }
+
+        return true;
+    }
+
+    bool CookManifest::save(std::string const & path) const
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            return false;
+
+        file << "# Written by the TextureCooker. The usage can be changed by hand: albedo, normal, specular or glow\n";
+        file << "# file usage hash format psnr\n";
+
+        for (auto const & entry : entries)
+        {
+            file << entry.first << " " << TextureCooker::getUsageName(entry.second.usage) << " "
+                << std::hex << std::setw(16) << std::setfill('0') << entry.second.hash << std::dec << " "
+                << entry.second.format << " " << std::fixed << std::setprecision(2) << entry.second.psnr << "\n";
+        }
+
+        return (bool)file;
+    }
+
+    CookManifest::Entry * CookManifest::find(std::string const & file)
+    {
+        auto found = entries.find(file);
+        return found != entries.end() ? &found->second : nullptr;
+    }
+
+    void CookManifest::set(std::string const & file, Entry const & entry)
+    {
+        entries[file] = entry;
+    }
+
+    void CookManifest::remove(std::string const & file)
+    {
+        entries.erase(file);
+    }
+
+    std::map<std::string, CookManifest::Entry> const & CookManifest::getEntries() const
+    {
+        return entries;
+    }
+
+    uint64_t CookManifest::computeHash(const char * bytes, size_t size, TextureUsage usage)
+    {
+        // FNV-1a, 64 bit
+        uint64_t hash = 14695981039346656037ull;
+        auto add = [&hash](const void * data, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                hash ^= ((const unsigned char *)data)[i];
+                hash *= 1099511628211ull;
+            }
+        };
+
+        uint32_t version = COOKER_VERSION;
+        uint32_t usageValue = usage;
+        add(&version, sizeof(version));
+        add(&usageValue, sizeof(usageValue));
+        add(bytes, size);
+
+        return hash;
+    }
+}
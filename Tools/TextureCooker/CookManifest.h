@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <string>
+#include "TextureCooker.h"
+
+namespace Graphics
+{
+    /*
+        What was cooked from what, so only changed textures are cooked again.
+        A text file next to the cooked textures, one line per source:
+
+            <file> <usage> <hash> <format> <psnr>
+
+        The hash is of the source file, the usage and the cooker version.
+        The usage can be edited by hand when the name guesses wrong, the
+        next run sees a different hash and cooks it again.
+    */
+    class CookManifest
+    {
+    public:
+        struct Entry
+        {
+            TextureUsage usage;
+            uint64_t hash;
+            std::string format;
+            float psnr;
+        };
+
+        // a missing manifest is an empty one, false if it couldn't be read
+        bool load(std::string const & path);
+        bool save(std::string const & path) const;
+
+        // null if the file isn't in the manifest
+        Entry * find(std::string const & file);
+        void set(std::string const & file, Entry const & entry);
+        void remove(std::string const & file);
+        std::map<std::string, Entry> const & getEntries() const;
+
+        static uint64_t computeHash(const char * bytes, size_t size, TextureUsage usage);
+    private:
+        std::map<std::string, Entry> entries;
+    };
+}
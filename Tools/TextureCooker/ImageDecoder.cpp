@@ -0,0 +1,1330 @@
+#include "ImageDecoder.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+namespace Graphics
+{
+    namespace
+    {
+        /////////////////////////////////////////////////////////////////// inflate
+
+        // deflate bits come least significant first
+        class InflateReader
+        {
+        public:
+            InflateReader(const uint8_t * data, size_t size)
+                : data(data), size(size), pos(0), bitBuffer(0), bitCount(0), overrun(false) {}
+
+            uint32_t bits(int count)
+            {
+                while (bitCount < count)
+                {
+                    uint32_t next = 0;
+                    if (pos < size)
+                        next = data[pos++];
+                    else
+                        overrun = true;
+
+                    bitBuffer |= next << bitCount;
+                    bitCount += 8;
+                }
+
+                uint32_t value = bitBuffer & ((1u << count) - 1);
+                bitBuffer >>= count;
+                bitCount -= count;
+                return value;
+            }
+
+            void alignToByte()
+            {
+                bitBuffer = 0;
+                bitCount = 0;
+            }
+
+            bool copyBytes(std::vector<uint8_t> & output, size_t count)
+            {
+                if (size - pos < count)
+                    return false;
+
+                output.insert(output.end(), data + pos, data + pos + count);
+                pos += count;
+                return true;
+            }
+
+            bool hasOverrun() const { return overrun; }
+        private:
+            const uint8_t * data;
+            size_t size;
+            size_t pos;
+            uint32_t bitBuffer;
+            int bitCount;
+            bool overrun;
+        };
+
+        // canonical Huffman codes by length, decoded a bit at a time
+        struct InflateHuffman
+        {
+            uint16_t count[16];
+            uint16_t symbol[288];
+
+            // false if the lengths are over subscribed, incomplete codes are allowed
+            bool build(const uint8_t * lengths, int symbols)
+            {
+                memset(count, 0, sizeof(count));
+                for (int i = 0; i < symbols; i++)
+                    count[lengths[i]]++;
+
+                int left = 1;
+                for (int length = 1; length < 16; length++)
+                {
+                    left <<= 1;
+                    left -= count[length];
+                    if (left < 0)
+                        return false;
+                }
+
+                uint16_t offsets[16];
+                offsets[1] = 0;
+                for (int length = 1; length < 15; length++)
+                    offsets[length + 1] = offsets[length] + count[length];
+
+                for (int i = 0; i < symbols; i++)
+                {
+                    if (lengths[i] != 0)
+                        symbol[offsets[lengths[i]]++] = (uint16_t)i;
+                }
+
+                return true;
+            }
+
+            int decode(InflateReader & reader) const
+            {
+                int code = 0, first = 0, index = 0;
+                for (int length = 1; length < 16; length++)
+                {
+                    code |= reader.bits(1);
+                    int lengthCount = count[length];
+                    if (code - lengthCount < first)
+                        return symbol[index + (code - first)];
+
+                    index += lengthCount;
+                    first += lengthCount;
+                    first <<= 1;
+                    code <<= 1;
+                }
+
+                return -1;
+            }
+        };
+
+        const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        bool inflateBlock(InflateReader & reader, InflateHuffman const & literals, InflateHuffman const & distances, std::vector<uint8_t> & output)
+        {
+            for (;;)
+            {
+                int symbol = literals.decode(reader);
+                if (symbol < 0 || reader.hasOverrun())
+                    return false;
+
+                if (symbol < 256)
+                {
+                    output.push_back((uint8_t)symbol);
+                    continue;
+                }
+
+                if (symbol == 256)
+                    return true;
+
+                symbol -= 257;
+                if (symbol >= 29)
+                    return false;
+                size_t length = LENGTH_BASE[symbol] + reader.bits(LENGTH_EXTRA[symbol]);
+
+                int distanceSymbol = distances.decode(reader);
+                if (distanceSymbol < 0 || distanceSymbol >= 30)
+                    return false;
+                size_t distance = DISTANCE_BASE[distanceSymbol] + reader.bits(DISTANCE_EXTRA[distanceSymbol]);
+
+                if (distance > output.size())
+                    return false;
+
+                // can overlap what it is writing, byte by byte on purpose
+                size_t from = output.size() - distance;
+                for (size_t i = 0; i < length; i++)
+                    output.push_back(output[from + i]);
+            }
+        }
+
+        bool inflateDynamic(InflateReader & reader, InflateHuffman & literals, InflateHuffman & distances)
+        {
+            static const uint8_t ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+            int literalCount = reader.bits(5) + 257;
+            int distanceCount = reader.bits(5) + 1;
+            int codeCount = reader.bits(4) + 4;
+            if (literalCount > 286 || distanceCount > 30)
+                return false;
+
+            uint8_t lengths[286 + 30] = {};
+            for (int i = 0; i < codeCount; i++)
+                lengths[ORDER[i]] = (uint8_t)reader.bits(3);
+
+            InflateHuffman lengthCode;
+            if (!lengthCode.build(lengths, 19))
+                return false;
+
+            int total = literalCount + distanceCount;
+            memset(lengths, 0, sizeof(lengths));
+
+            for (int i = 0; i < total;)
+            {
+                int symbol = lengthCode.decode(reader);
+                if (symbol < 0 || reader.hasOverrun())
+                    return false;
+
+                if (symbol < 16)
+                {
+                    lengths[i++] = (uint8_t)symbol;
+                    continue;
+                }
+
+                uint8_t value = 0;
+                int repeat;
+                if (symbol == 16)
+                {
+                    if (i == 0)
+                        return false;
+                    value = lengths[i - 1];
+                    repeat = 3 + reader.bits(2);
+                }
+                else if (symbol == 17)
+                {
+                    repeat = 3 + reader.bits(3);
+                }
+                else
+                {
+                    repeat = 11 + reader.bits(7);
+                }
+
+                if (i + repeat > total)
+                    return false;
+                while (repeat--)
+                    lengths[i++] = value;
+            }
+
+            // no end of block code, nothing could ever end
+            if (lengths[256] == 0)
+                return false;
+
+            return literals.build(lengths, literalCount) && distances.build(lengths + literalCount, distanceCount);
+        }
+
+        /////////////////////////////////////////////////////////////////// png
+
+        uint32_t readBigEndian(const uint8_t * bytes)
+        {
+            return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+        }
+
+        uint8_t paeth(int a, int b, int c)
+        {
+            int p = a + b - c;
+            int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+            if (pa <= pb && pa <= pc)
+                return (uint8_t)a;
+            return (uint8_t)(pb <= pc ? b : c);
+        }
+
+        // in place, previous is null on the first row of a pass
+        bool unfilterRow(uint8_t filter, uint8_t * row, const uint8_t * previous, size_t rowBytes, size_t pixelBytes)
+        {
+            for (size_t i = 0; i < rowBytes; i++)
+            {
+                int left = i >= pixelBytes ? row[i - pixelBytes] : 0;
+                int up = previous ? previous[i] : 0;
+                int upLeft = previous && i >= pixelBytes ? previous[i - pixelBytes] : 0;
+
+                switch (filter)
+                {
+                case 0: break;
+                case 1: row[i] = (uint8_t)(row[i] + left); break;
+                case 2: row[i] = (uint8_t)(row[i] + up); break;
+                case 3: row[i] = (uint8_t)(row[i] + ((left + up) >> 1)); break;
+                case 4: row[i] = (uint8_t)(row[i] + paeth(left, up, upLeft)); break;
+                default: return false;
+                }
+            }
+
+            return true;
+        }
+
+        struct PNGInfo
+        {
+            uint32_t width, height;
+            int bitDepth;
+            int colorType;
+            int channels;
+            uint8_t palette[256][4];
+            int paletteSize;
+            bool hasKey;
+            uint16_t key[3];    // transparent gray or RGB, at the bit depth of the file
+            bool interlaced;
+        };
+
+        uint16_t readSample(const uint8_t * row, uint32_t index, int bitDepth)
+        {
+            if (bitDepth == 8)
+                return row[index];
+            if (bitDepth == 16)
+                return (uint16_t)((row[index * 2] << 8) | row[index * 2 + 1]);
+
+            uint32_t bit = index * bitDepth;
+            int shift = 8 - bitDepth - (int)(bit & 7);
+            return (uint16_t)((row[bit >> 3] >> shift) & ((1 << bitDepth) - 1));
+        }
+
+        uint8_t toByte(uint16_t sample, int bitDepth)
+        {
+            if (bitDepth == 16)
+                return (uint8_t)(sample >> 8);
+            return (uint8_t)(sample * 255 / ((1 << bitDepth) - 1));
+        }
+
+        void storePixel(PNGInfo const & info, const uint8_t * row, uint32_t x, uint8_t * out)
+        {
+            uint16_t samples[4];
+            for (int c = 0; c < info.channels; c++)
+                samples[c] = readSample(row, x * info.channels + c, info.bitDepth);
+
+            switch (info.colorType)
+            {
+            case 0:
+                out[0] = out[1] = out[2] = toByte(samples[0], info.bitDepth);
+                out[3] = info.hasKey && samples[0] == info.key[0] ? 0 : 255;
+                break;
+            case 2:
+                for (int c = 0; c < 3; c++)
+                    out[c] = toByte(samples[c], info.bitDepth);
+                out[3] = info.hasKey && samples[0] == info.key[0] && samples[1] == info.key[1] && samples[2] == info.key[2] ? 0 : 255;
+                break;
+            case 3:
+                memcpy(out, info.palette[samples[0] & 0xff], 4);
+                break;
+            case 4:
+                out[0] = out[1] = out[2] = toByte(samples[0], info.bitDepth);
+                out[3] = toByte(samples[1], info.bitDepth);
+                break;
+            case 6:
+                for (int c = 0; c < 4; c++)
+                    out[c] = toByte(samples[c], info.bitDepth);
+                break;
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////// jpeg
+
+        const uint8_t ZIGZAG[64] =
+        {
+             0,  1,  8, 16,  9,  2,  3, 10,
+            17, 24, 32, 25, 18, 11,  4,  5,
+            12, 19, 26, 33, 40, 48, 41, 34,
+            27, 20, 13,  6,  7, 14, 21, 28,
+            35, 42, 49, 56, 57, 50, 43, 36,
+            29, 22, 15, 23, 30, 37, 44, 51,
+            58, 59, 52, 45, 38, 31, 39, 46,
+            53, 60, 61, 54, 47, 55, 62, 63
+        };
+
+        struct JPEGHuffman
+        {
+            bool defined = false;
+            uint8_t symbols[256];
+            int maxCode[18];
+            int valuePointer[17];
+            int minCode[17];
+
+            bool build(const uint8_t * counts, const uint8_t * values, int total)
+            {
+                memcpy(symbols, values, total);
+
+                int code = 0, index = 0;
+                for (int length = 1; length <= 16; length++)
+                {
+                    valuePointer[length] = index;
+                    minCode[length] = code;
+                    code += counts[length - 1];
+                    index += counts[length - 1];
+                    maxCode[length] = counts[length - 1] ? code - 1 : -1;
+                    code <<= 1;
+                }
+                maxCode[17] = INT32_MAX;
+
+                defined = true;
+                return true;
+            }
+        };
+
+        // entropy coded bits, most significant first with the 0xFF 0x00 stuffing taken out.
+        // Stops in front of a marker and reads zeros from there
+        class JPEGReader
+        {
+        public:
+            JPEGReader(const uint8_t * data, size_t size, size_t pos)
+                : data(data), size(size), pos(pos), bitBuffer(0), bitCount(0) {}
+
+            int bit()
+            {
+                if (bitCount == 0)
+                    fill();
+                bitCount--;
+                return (bitBuffer >> bitCount) & 1;
+            }
+
+            int bits(int count)
+            {
+                int value = 0;
+                for (int i = 0; i < count; i++)
+                    value = (value << 1) | bit();
+                return value;
+            }
+
+            // a value of size bits, negative ones are stored with the top bit clear
+            int receiveExtend(int size)
+            {
+                if (size == 0)
+                    return 0;
+
+                int value = bits(size);
+                return value < (1 << (size - 1)) ? value - (1 << size) + 1 : value;
+            }
+
+            int decode(JPEGHuffman const & table)
+            {
+                if (!table.defined)
+                    return 0;
+
+                int code = bit();
+                int length = 1;
+                while (length <= 16 && code > table.maxCode[length])
+                {
+                    code = (code << 1) | bit();
+                    length++;
+                }
+
+                if (length > 16)
+                    return 0;
+                return table.symbols[(table.valuePointer[length] + code - table.minCode[length]) & 0xff];
+            }
+
+            // past the RSTn marker, with the bits thrown away
+            void restart()
+            {
+                bitBuffer = 0;
+                bitCount = 0;
+                while (pos + 1 < size && !(data[pos] == 0xFF && data[pos + 1] >= 0xD0 && data[pos + 1] <= 0xD7))
+                    pos++;
+                pos += 2;
+            }
+
+            // where the next marker after the scan is
+            size_t findMarker() const
+            {
+                size_t next = pos;
+                while (next + 1 < size && !(data[next] == 0xFF && data[next + 1] != 0 && !(data[next + 1] >= 0xD0 && data[next + 1] <= 0xD7)))
+                    next++;
+                return next;
+            }
+        private:
+            const uint8_t * data;
+            size_t size;
+            size_t pos;
+            uint32_t bitBuffer;
+            int bitCount;
+
+            void fill()
+            {
+                uint8_t next = 0;
+                if (pos < size && data[pos] != 0xFF)
+                {
+                    next = data[pos++];
+                }
+                else if (pos + 1 < size && data[pos] == 0xFF && data[pos + 1] == 0x00)
+                {
+                    next = 0xFF;
+                    pos += 2;
+                }
+
+                bitBuffer = next;
+                bitCount = 8;
+            }
+        };
+
+        class JPEGDecoder
+        {
+        public:
+            bool decode(const uint8_t * bytes, size_t size, Image & image, std::string & error);
+        private:
+            struct Component
+            {
+                int id;
+                int h, v;
+                int quantTable;
+                int dcTable, acTable;
+                int blocksWide, blocksHigh;     // padded to whole MCUs
+                int usedWide, usedHigh;         // what a scan of only this component covers
+                int dcPrediction;
+                std::vector<int16_t> coefficients;  // 64 per block, natural order
+            };
+
+            const uint8_t * data;
+            size_t size;
+
+            uint16_t quantTables[4][64];
+            JPEGHuffman dcTables[4];
+            JPEGHuffman acTables[4];
+            std::vector<Component> components;
+
+            uint32_t width, height;
+            int maxH, maxV;
+            int mcusWide, mcusHigh;
+            bool progressive;
+            bool frameRead;
+            int restartInterval;
+            int adobeTransform;     // -1 without an Adobe marker
+
+            // the scan being decoded
+            std::vector<int> scanComponents;
+            int spectralStart, spectralEnd, approxHigh, approxLow;
+            int endOfBandRun;
+
+            bool readFrame(const uint8_t * segment, size_t length, std::string & error);
+            bool readHuffman(const uint8_t * segment, size_t length);
+            bool readQuantization(const uint8_t * segment, size_t length);
+            bool readScan(const uint8_t * segment, size_t length, size_t & pos, std::string & error);
+
+            void decodeBlock(JPEGReader & reader, Component & component, int16_t * block);
+            void decodeBaseline(JPEGReader & reader, Component & component, int16_t * block);
+            void decodeDCFirst(JPEGReader & reader, Component & component, int16_t * block);
+            void decodeDCRefine(JPEGReader & reader, int16_t * block);
+            void decodeACFirst(JPEGReader & reader, Component & component, int16_t * block);
+            void decodeACRefine(JPEGReader & reader, Component & component, int16_t * block);
+
+            void output(Image & image);
+        };
+
+        bool JPEGDecoder::decode(const uint8_t * bytes, size_t size, Image & image, std::string & error)
+        {
+            data = bytes;
+            this->size = size;
+            memset(quantTables, 0, sizeof(quantTables));
+            progressive = false;
+            frameRead = false;
+            restartInterval = 0;
+            adobeTransform = -1;
+
+            if (size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8)
+            {
+                error = "not a JPEG";
+                return false;
+            }
+
+            size_t pos = 2;
+            while (pos + 1 < size)
+            {
+                if (bytes[pos] != 0xFF)
+                {
+                    pos++;
+                    continue;
+                }
+
+                uint8_t marker = bytes[pos + 1];
+                pos += 2;
+
+                // fill bytes, and markers without a segment
+                if (marker == 0xFF)
+                {
+                    pos--;
+                    continue;
+                }
+                if (marker == 0xD9)
+                    break;
+                if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+                    continue;
+
+                if (pos + 2 > size)
+                    break;
+                size_t length = (bytes[pos] << 8) | bytes[pos + 1];
+                if (length < 2 || pos + length > size)
+                {
+                    error = "segment past the end of the file";
+                    return false;
+                }
+
+                const uint8_t * segment = bytes + pos + 2;
+                size_t segmentLength = length - 2;
+                pos += length;
+
+                switch (marker)
+                {
+                case 0xC0:
+                case 0xC1:
+                case 0xC2:
+                    progressive = marker == 0xC2;
+                    if (!readFrame(segment, segmentLength, error))
+                        return false;
+                    break;
+                case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+                case 0xC9: case 0xCA: case 0xCB:
+                case 0xCD: case 0xCE: case 0xCF:
+                    error = "lossless, hierarchical and arithmetic coded JPEGs aren't supported";
+                    return false;
+                case 0xC4:
+                    if (!readHuffman(segment, segmentLength))
+                    {
+                        error = "broken Huffman table";
+                        return false;
+                    }
+                    break;
+                case 0xDB:
+                    if (!readQuantization(segment, segmentLength))
+                    {
+                        error = "broken quantization table";
+                        return false;
+                    }
+                    break;
+                case 0xDD:
+                    if (segmentLength < 2)
+                        return false;
+                    restartInterval = (segment[0] << 8) | segment[1];
+                    break;
+                case 0xDA:
+                    if (!readScan(segment, segmentLength, pos, error))
+                        return false;
+                    break;
+                case 0xEE:
+                    if (segmentLength >= 12 && memcmp(segment, "Adobe", 5) == 0)
+                        adobeTransform = segment[11];
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (!frameRead)
+            {
+                error = "no frame in the JPEG";
+                return false;
+            }
+
+            output(image);
+            return true;
+        }
+
+        bool JPEGDecoder::readFrame(const uint8_t * segment, size_t length, std::string & error)
+        {
+            if (length < 6 || segment[0] != 8)
+            {
+                error = "only 8 bit JPEGs are supported";
+                return false;
+            }
+
+            height = (segment[1] << 8) | segment[2];
+            width = (segment[3] << 8) | segment[4];
+            int count = segment[5];
+
+            if (width == 0 || height == 0 || (count != 1 && count != 3) || length < 6 + 3 * (size_t)count)
+            {
+                error = "only gray and three component JPEGs with a known size are supported";
+                return false;
+            }
+
+            components.assign(count, Component());
+            maxH = 1;
+            maxV = 1;
+            for (int i = 0; i < count; i++)
+            {
+                Component & component = components[i];
+                component.id = segment[6 + i * 3];
+                component.h = segment[7 + i * 3] >> 4;
+                component.v = segment[7 + i * 3] & 15;
+                component.quantTable = segment[8 + i * 3] & 3;
+
+                if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4)
+                {
+                    error = "bad sampling factors";
+                    return false;
+                }
+
+                maxH = component.h > maxH ? component.h : maxH;
+                maxV = component.v > maxV ? component.v : maxV;
+            }
+
+            mcusWide = (int)((width + 8 * maxH - 1) / (8 * maxH));
+            mcusHigh = (int)((height + 8 * maxV - 1) / (8 * maxV));
+
+            for (Component & component : components)
+            {
+                component.blocksWide = mcusWide * component.h;
+                component.blocksHigh = mcusHigh * component.v;
+
+                uint32_t samplesWide = (width * component.h + maxH - 1) / maxH;
+                uint32_t samplesHigh = (height * component.v + maxV - 1) / maxV;
+                component.usedWide = (int)((samplesWide + 7) / 8);
+                component.usedHigh = (int)((samplesHigh + 7) / 8);
+
+                component.coefficients.assign((size_t)component.blocksWide * component.blocksHigh * 64, 0);
+            }
+
+            frameRead = true;
+            return true;
+        }
+
+        bool JPEGDecoder::readHuffman(const uint8_t * segment, size_t length)
+        {
+            size_t pos = 0;
+            while (pos + 17 <= length)
+            {
+                int tableClass = segment[pos] >> 4;
+                int index = segment[pos] & 15;
+                if (tableClass > 1 || index > 3)
+                    return false;
+
+                const uint8_t * counts = segment + pos + 1;
+                int total = 0;
+                for (int i = 0; i < 16; i++)
+                    total += counts[i];
+
+                if (total > 256 || pos + 17 + total > length)
+                    return false;
+
+                JPEGHuffman & table = tableClass == 0 ? dcTables[index] : acTables[index];
+                table.build(counts, segment + pos + 17, total);
+                pos += 17 + total;
+            }
+
+            return pos == length;
+        }
+
+        bool JPEGDecoder::readQuantization(const uint8_t * segment, size_t length)
+        {
+            size_t pos = 0;
+            while (pos < length)
+            {
+                int precision = segment[pos] >> 4;
+                int index = segment[pos] & 15;
+                size_t tableSize = precision ? 128 : 64;
+                if (index > 3 || pos + 1 + tableSize > length)
+                    return false;
+
+                for (int k = 0; k < 64; k++)
+                {
+                    const uint8_t * value = segment + pos + 1 + (precision ? k * 2 : k);
+                    quantTables[index][ZIGZAG[k]] = precision ? (uint16_t)((value[0] << 8) | value[1]) : value[0];
+                }
+
+                pos += 1 + tableSize;
+            }
+
+            return true;
+        }
+
+        bool JPEGDecoder::readScan(const uint8_t * segment, size_t length, size_t & pos, std::string & error)
+        {
+            if (!frameRead || length < 1)
+            {
+                error = "scan before the frame";
+                return false;
+            }
+
+            int count = segment[0];
+            if (count < 1 || count > 4 || length < 4 + 2 * (size_t)count)
+            {
+                error = "broken scan header";
+                return false;
+            }
+
+            scanComponents.clear();
+            for (int i = 0; i < count; i++)
+            {
+                int id = segment[1 + i * 2];
+                int tables = segment[2 + i * 2];
+
+                int found = -1;
+                for (size_t c = 0; c < components.size(); c++)
+                {
+                    if (components[c].id == id)
+                        found = (int)c;
+                }
+
+                if (found < 0)
+                {
+                    error = "scan of a component not in the frame";
+                    return false;
+                }
+
+                components[found].dcTable = tables >> 4 & 3;
+                components[found].acTable = tables & 3;
+                scanComponents.push_back(found);
+            }
+
+            const uint8_t * spectral = segment + 1 + count * 2;
+            spectralStart = spectral[0];
+            spectralEnd = spectral[1];
+            approxHigh = spectral[2] >> 4;
+            approxLow = spectral[2] & 15;
+
+            if (!progressive)
+            {
+                spectralStart = 0;
+                spectralEnd = 63;
+                approxHigh = 0;
+                approxLow = 0;
+            }
+            else if (spectralEnd > 63 || spectralStart > spectralEnd || (spectralStart == 0 && spectralEnd != 0) || (spectralStart > 0 && count != 1))
+            {
+                error = "broken progressive scan";
+                return false;
+            }
+
+            for (Component & component : components)
+                component.dcPrediction = 0;
+            endOfBandRun = 0;
+
+            JPEGReader reader(data, size, pos);
+            int sinceRestart = 0;
+
+            if (count == 1)
+            {
+                // a single component is in blocks, not whole MCUs
+                Component & component = components[scanComponents[0]];
+                for (int y = 0; y < component.usedHigh; y++)
+                {
+                    for (int x = 0; x < component.usedWide; x++)
+                    {
+                        if (restartInterval && sinceRestart == restartInterval)
+                        {
+                            reader.restart();
+                            for (Component & reset : components)
+                                reset.dcPrediction = 0;
+                            endOfBandRun = 0;
+                            sinceRestart = 0;
+                        }
+
+                        decodeBlock(reader, component, &component.coefficients[((size_t)y * component.blocksWide + x) * 64]);
+                        sinceRestart++;
+                    }
+                }
+            }
+            else
+            {
+                for (int mcuY = 0; mcuY < mcusHigh; mcuY++)
+                {
+                    for (int mcuX = 0; mcuX < mcusWide; mcuX++)
+                    {
+                        if (restartInterval && sinceRestart == restartInterval)
+                        {
+                            reader.restart();
+                            for (Component & reset : components)
+                                reset.dcPrediction = 0;
+                            endOfBandRun = 0;
+                            sinceRestart = 0;
+                        }
+
+                        for (int index : scanComponents)
+                        {
+                            Component & component = components[index];
+                            for (int v = 0; v < component.v; v++)
+                            {
+                                for (int h = 0; h < component.h; h++)
+                                {
+                                    size_t x = (size_t)mcuX * component.h + h;
+                                    size_t y = (size_t)mcuY * component.v + v;
+                                    decodeBlock(reader, component, &component.coefficients[(y * component.blocksWide + x) * 64]);
+                                }
+                            }
+                        }
+
+                        sinceRestart++;
+                    }
+                }
+            }
+
+            pos = reader.findMarker();
+            return true;
+        }
+
+        void JPEGDecoder::decodeBlock(JPEGReader & reader, Component & component, int16_t * block)
+        {
+            if (!progressive)
+                decodeBaseline(reader, component, block);
+            else if (spectralStart == 0)
+                approxHigh == 0 ? decodeDCFirst(reader, component, block) : decodeDCRefine(reader, block);
+            else
+                approxHigh == 0 ? decodeACFirst(reader, component, block) : decodeACRefine(reader, component, block);
+        }
+
+        void JPEGDecoder::decodeBaseline(JPEGReader & reader, Component & component, int16_t * block)
+        {
+            int size = reader.decode(dcTables[component.dcTable]);
+            component.dcPrediction += reader.receiveExtend(size & 15);
+            block[0] = (int16_t)component.dcPrediction;
+
+            JPEGHuffman const & table = acTables[component.acTable];
+            for (int k = 1; k < 64;)
+            {
+                int symbol = reader.decode(table);
+                int run = symbol >> 4;
+                size = symbol & 15;
+
+                if (size == 0)
+                {
+                    if (run != 15)
+                        break;
+                    k += 16;
+                    continue;
+                }
+
+                k += run;
+                if (k > 63)
+                    break;
+                block[ZIGZAG[k]] = (int16_t)reader.receiveExtend(size);
+                k++;
+            }
+        }
+
+        void JPEGDecoder::decodeDCFirst(JPEGReader & reader, Component & component, int16_t * block)
+        {
+            int size = reader.decode(dcTables[component.dcTable]);
+            component.dcPrediction += reader.receiveExtend(size & 15);
+            block[0] = (int16_t)(component.dcPrediction * (1 << approxLow));
+        }
+
+        void JPEGDecoder::decodeDCRefine(JPEGReader & reader, int16_t * block)
+        {
+            if (reader.bit())
+                block[0] |= (int16_t)(1 << approxLow);
+        }
+
+        void JPEGDecoder::decodeACFirst(JPEGReader & reader, Component & component, int16_t * block)
+        {
+            if (endOfBandRun > 0)
+            {
+                endOfBandRun--;
+                return;
+            }
+
+            JPEGHuffman const & table = acTables[component.acTable];
+            for (int k = spectralStart; k <= spectralEnd;)
+            {
+                int symbol = reader.decode(table);
+                int run = symbol >> 4;
+                int size = symbol & 15;
+
+                if (size == 0)
+                {
+                    if (run < 15)
+                    {
+                        // this band and the next endOfBandRun ones are done
+                        endOfBandRun = (1 << run) - 1;
+                        if (run)
+                            endOfBandRun += reader.bits(run);
+                        break;
+                    }
+                    k += 16;
+                    continue;
+                }
+
+                k += run;
+                if (k > 63)
+                    break;
+                block[ZIGZAG[k]] = (int16_t)(reader.receiveExtend(size) * (1 << approxLow));
+                k++;
+            }
+        }
+
+        // the one from the spec (G.1.2.3), the way libjpeg does it
+        void JPEGDecoder::decodeACRefine(JPEGReader & reader, Component & component, int16_t * block)
+        {
+            int positive = 1 << approxLow;
+            int negative = -1 * (1 << approxLow);
+            int k = spectralStart;
+
+            if (endOfBandRun == 0)
+            {
+                JPEGHuffman const & table = acTables[component.acTable];
+                for (; k <= spectralEnd; k++)
+                {
+                    int symbol = reader.decode(table);
+                    int run = symbol >> 4;
+                    int size = symbol & 15;
+                    int value = 0;
+
+                    if (size)
+                    {
+                        value = reader.bit() ? positive : negative;
+                    }
+                    else if (run != 15)
+                    {
+                        endOfBandRun = 1 << run;
+                        if (run)
+                            endOfBandRun += reader.bits(run);
+                        break;
+                    }
+
+                    // skip run zeros, refining the nonzero ones on the way
+                    while (k <= spectralEnd)
+                    {
+                        int16_t & coefficient = block[ZIGZAG[k]];
+                        if (coefficient != 0)
+                        {
+                            if (reader.bit() && (coefficient & positive) == 0)
+                                coefficient = (int16_t)(coefficient + (coefficient >= 0 ? positive : negative));
+                        }
+                        else
+                        {
+                            if (--run < 0)
+                                break;
+                        }
+                        k++;
+                    }
+
+                    if (value && k <= spectralEnd)
+                        block[ZIGZAG[k]] = (int16_t)value;
+                }
+            }
+
+            if (endOfBandRun > 0)
+            {
+                for (; k <= spectralEnd; k++)
+                {
+                    int16_t & coefficient = block[ZIGZAG[k]];
+                    if (coefficient != 0 && reader.bit() && (coefficient & positive) == 0)
+                        coefficient = (int16_t)(coefficient + (coefficient >= 0 ? positive : negative));
+                }
+                endOfBandRun--;
+            }
+        }
+
+        void JPEGDecoder::output(Image & image)
+        {
+            // cos((2x + 1) u pi / 16) with the scale for u = 0
+            float idct[8][8];
+            for (int x = 0; x < 8; x++)
+            {
+                for (int u = 0; u < 8; u++)
+                    idct[x][u] = (u == 0 ? sqrtf(0.5f) : 1.f) * 0.5f * cosf((2 * x + 1) * u * 3.14159265f / 16.f);
+            }
+
+            std::vector<std::vector<uint8_t>> planes(components.size());
+            for (size_t c = 0; c < components.size(); c++)
+            {
+                Component const & component = components[c];
+                size_t planeWidth = (size_t)component.blocksWide * 8;
+                planes[c].resize(planeWidth * component.blocksHigh * 8);
+
+                const uint16_t * quant = quantTables[component.quantTable];
+                for (int by = 0; by < component.blocksHigh; by++)
+                {
+                    for (int bx = 0; bx < component.blocksWide; bx++)
+                    {
+                        const int16_t * block = &component.coefficients[((size_t)by * component.blocksWide + bx) * 64];
+
+                        float rows[64];
+                        for (int v = 0; v < 8; v++)
+                        {
+                            for (int x = 0; x < 8; x++)
+                            {
+                                float sum = 0;
+                                for (int u = 0; u < 8; u++)
+                                    sum += idct[x][u] * block[v * 8 + u] * quant[v * 8 + u];
+                                rows[v * 8 + x] = sum;
+                            }
+                        }
+
+                        for (int y = 0; y < 8; y++)
+                        {
+                            uint8_t * out = &planes[c][(by * 8 + y) * planeWidth + bx * 8];
+                            for (int x = 0; x < 8; x++)
+                            {
+                                float sum = 128.5f;
+                                for (int v = 0; v < 8; v++)
+                                    sum += idct[y][v] * rows[v * 8 + x];
+                                out[x] = (uint8_t)(sum < 0 ? 0 : sum > 255 ? 255 : sum);
+                            }
+                        }
+                    }
+                }
+            }
+
+            image.width = width;
+            image.height = height;
+            image.pixels.resize((size_t)width * height * 4);
+
+            bool ycbcr = components.size() == 3 && adobeTransform != 0;
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float samples[3];
+                    for (size_t c = 0; c < components.size(); c++)
+                    {
+                        Component const & component = components[c];
+                        size_t sx = x * component.h / maxH;
+                        size_t sy = y * component.v / maxV;
+                        samples[c] = planes[c][sy * component.blocksWide * 8 + sx];
+                    }
+
+                    uint8_t * out = &image.pixels[((size_t)y * width + x) * 4];
+                    if (components.size() == 1)
+                    {
+                        out[0] = out[1] = out[2] = (uint8_t)samples[0];
+                    }
+                    else if (ycbcr)
+                    {
+                        float luma = samples[0], cb = samples[1] - 128.f, cr = samples[2] - 128.f;
+                        float rgb[3] =
+                        {
+                            luma + 1.402f * cr,
+                            luma - 0.344136f * cb - 0.714136f * cr,
+                            luma + 1.772f * cb
+                        };
+                        for (int i = 0; i < 3; i++)
+                            out[i] = (uint8_t)(rgb[i] < 0 ? 0 : rgb[i] > 255 ? 255 : rgb[i] + 0.5f);
+                    }
+                    else
+                    {
+                        for (int i = 0; i < 3; i++)
+                            out[i] = (uint8_t)samples[i];
+                    }
+                    out[3] = 255;
+                }
+            }
+        }
+    }
+
+    bool ImageDecoder::decode(const char * bytes, size_t size, Image & image, std::string & error)
+    {
+        const uint8_t * data = (const uint8_t *)bytes;
+        if (size >= 8 && memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0)
+            return decodePNG(data, size, image, error);
+        if (size >= 2 && data[0] == 0xFF && data[1] == 0xD8)
+            return decodeJPEG(data, size, image, error);
+
+        error = "not a PNG or JPEG";
+        return false;
+    }
+
+    bool ImageDecoder::decodePNG(const uint8_t * bytes, size_t size, Image & image, std::string & error)
+    {
+        PNGInfo info = {};
+        std::vector<uint8_t> compressed;
+        bool headerRead = false;
+
+        for (int i = 0; i < 256; i++)
+        {
+            info.palette[i][0] = info.palette[i][1] = info.palette[i][2] = 0;
+            info.palette[i][3] = 255;
+        }
+
+        size_t pos = 8;
+        while (pos + 12 <= size)
+        {
+            uint32_t length = readBigEndian(bytes + pos);
+            const uint8_t * type = bytes + pos + 4;
+            const uint8_t * chunk = bytes + pos + 8;
+            if (length > size - pos - 12)
+            {
+                error = "chunk past the end of the file";
+                return false;
+            }
+            pos += 12 + length;
+
+            if (memcmp(type, "IHDR", 4) == 0 && length >= 13)
+            {
+                info.width = readBigEndian(chunk);
+                info.height = readBigEndian(chunk + 4);
+                info.bitDepth = chunk[8];
+                info.colorType = chunk[9];
+
+                static const int CHANNELS[7] = { 1, 0, 3, 1, 2, 0, 4 };
+                info.channels = info.colorType <= 6 ? CHANNELS[info.colorType] : 0;
+
+                bool depthOk = info.bitDepth == 8 || info.bitDepth == 16 ||
+                    ((info.colorType == 0 || info.colorType == 3) && (info.bitDepth == 1 || info.bitDepth == 2 || info.bitDepth == 4));
+                if (info.channels == 0 || !depthOk || (info.colorType == 3 && info.bitDepth == 16) ||
+                    chunk[10] != 0 || chunk[11] != 0 || chunk[12] > 1 || info.width == 0 || info.height == 0)
+                {
+                    error = "unsupported PNG header";
+                    return false;
+                }
+
+                info.interlaced = chunk[12] == 1;
+                headerRead = true;
+            }
+            else if (memcmp(type, "PLTE", 4) == 0)
+            {
+                info.paletteSize = (int)(length / 3 > 256 ? 256 : length / 3);
+                for (int i = 0; i < info.paletteSize; i++)
+                    memcpy(info.palette[i], chunk + i * 3, 3);
+            }
+            else if (memcmp(type, "tRNS", 4) == 0 && headerRead)
+            {
+                if (info.colorType == 3)
+                {
+                    for (uint32_t i = 0; i < length && i < 256; i++)
+                        info.palette[i][3] = chunk[i];
+                }
+                else if (info.colorType == 0 && length >= 2)
+                {
+                    info.hasKey = true;
+                    info.key[0] = (uint16_t)((chunk[0] << 8) | chunk[1]);
+                }
+                else if (info.colorType == 2 && length >= 6)
+                {
+                    info.hasKey = true;
+                    for (int c = 0; c < 3; c++)
+                        info.key[c] = (uint16_t)((chunk[c * 2] << 8) | chunk[c * 2 + 1]);
+                }
+            }
+            else if (memcmp(type, "IDAT", 4) == 0)
+            {
+                compressed.insert(compressed.end(), chunk, chunk + length);
+            }
+            else if (memcmp(type, "IEND", 4) == 0)
+            {
+                break;
+            }
+        }
+
+        if (!headerRead)
+        {
+            error = "no PNG header";
+            return false;
+        }
+
+        std::vector<uint8_t> raw;
+        if (!inflate(compressed.data(), compressed.size(), raw))
+        {
+            error = "broken PNG data";
+            return false;
+        }
+
+        image.width = info.width;
+        image.height = info.height;
+        image.pixels.assign((size_t)info.width * info.height * 4, 0);
+
+        size_t bitsPerPixel = (size_t)info.channels * info.bitDepth;
+        size_t pixelBytes = (bitsPerPixel + 7) / 8;
+        size_t offset = 0;
+
+        static const int START_X[7] = { 0, 4, 0, 2, 0, 1, 0 };
+        static const int START_Y[7] = { 0, 0, 4, 0, 2, 0, 1 };
+        static const int STEP_X[7] = { 8, 8, 4, 4, 2, 2, 1 };
+        static const int STEP_Y[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+        for (int pass = 0; pass < (info.interlaced ? 7 : 1); pass++)
+        {
+            uint32_t startX = info.interlaced ? START_X[pass] : 0, startY = info.interlaced ? START_Y[pass] : 0;
+            uint32_t stepX = info.interlaced ? STEP_X[pass] : 1, stepY = info.interlaced ? STEP_Y[pass] : 1;
+            if (startX >= info.width || startY >= info.height)
+                continue;
+
+            uint32_t passWidth = (info.width - startX + stepX - 1) / stepX;
+            uint32_t passHeight = (info.height - startY + stepY - 1) / stepY;
+            size_t rowBytes = (passWidth * bitsPerPixel + 7) / 8;
+
+            if (raw.size() - offset < (rowBytes + 1) * passHeight)
+            {
+                error = "PNG data is too short";
+                return false;
+            }
+
+            uint8_t * previous = nullptr;
+            for (uint32_t y = 0; y < passHeight; y++)
+            {
+                uint8_t filter = raw[offset];
+                uint8_t * row = &raw[offset + 1];
+                offset += rowBytes + 1;
+
+                if (!unfilterRow(filter, row, previous, rowBytes, pixelBytes))
+                {
+                    error = "unknown PNG filter";
+                    return false;
+                }
+                previous = row;
+
+                for (uint32_t x = 0; x < passWidth; x++)
+                {
+                    size_t pixel = (size_t)(startY + y * stepY) * info.width + startX + x * stepX;
+                    storePixel(info, row, x, &image.pixels[pixel * 4]);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool ImageDecoder::decodeJPEG(const uint8_t * bytes, size_t size, Image & image, std::string & error)
+    {
+        JPEGDecoder decoder;
+        return decoder.decode(bytes, size, image, error);
+    }
+
+    bool ImageDecoder::inflate(const uint8_t * bytes, size_t size, std::vector<uint8_t> & output)
+    {
+        if (size < 2 || (bytes[0] & 15) != 8 || ((bytes[0] << 8) | bytes[1]) % 31 != 0 || (bytes[1] & 0x20))
+            return false;
+
+        InflateReader reader(bytes + 2, size - 2);
+        InflateHuffman literals, distances;
+
+        bool last = false;
+        while (!last)
+        {
+            last = reader.bits(1) != 0;
+            int type = reader.bits(2);
+
+            if (type == 0)
+            {
+                reader.alignToByte();
+                uint32_t length = reader.bits(16);
+                uint32_t inverse = reader.bits(16);
+                if ((length ^ 0xffff) != inverse || !reader.copyBytes(output, length))
+                    return false;
+            }
+            else if (type == 1)
+            {
+                uint8_t lengths[288];
+                for (int i = 0; i < 288; i++)
+                    lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+                literals.build(lengths, 288);
+
+                for (int i = 0; i < 30; i++)
+                    lengths[i] = 5;
+                distances.build(lengths, 30);
+
+                if (!inflateBlock(reader, literals, distances, output))
+                    return false;
+            }
+            else if (type == 2)
+            {
+                if (!inflateDynamic(reader, literals, distances) || !inflateBlock(reader, literals, distances, output))
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (reader.hasOverrun())
+                return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace Graphics
+{
+    // 8 bit RGBA, rows top to bottom
+    struct Image
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    /*
+        The PNG and JPEG files in Resources/Textures to RGBA, so the cooker
+        doesn't need WIC (or anything else) to run on Linux.
+
+        PNG:  every color type and bit depth, interlaced or not. 16 bit
+              samples keep the high byte, gAMA/iCCP are ignored like the
+              engine ignores them.
+        JPEG: baseline, extended and progressive Huffman, gray or YCbCr
+              (RGB with an Adobe marker). Chroma is upsampled by repeating
+              samples. Arithmetic coding, 12 bit and CMYK are not read.
+    */
+    class ImageDecoder
+    {
+    public:
+        // error says why when it returns false
+        static bool decode(const char * bytes, size_t size, Image & image, std::string & error);
+
+        static bool decodePNG(const uint8_t * bytes, size_t size, Image & image, std::string & error);
+        static bool decodeJPEG(const uint8_t * bytes, size_t size, Image & image, std::string & error);
+
+        // zlib stream, output is appended
+        static bool inflate(const uint8_t * bytes, size_t size, std::vector<uint8_t> & output);
+    };
+}
@@ -0,0 +1,353 @@
+#include "TextureCooker.h"
+#include "BlockCompression.h"
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#define PSNR_LOSSLESS 99.f
+
+namespace Graphics
+{
+    namespace
+    {
+        const char * USAGE_NAMES[NR_OF_TEXTURE_USAGES] = { "albedo", "normal", "specular", "glow" };
+
+        // RGBA in floats, whatever space the usage filters in
+        struct FloatImage
+        {
+            uint32_t width;
+            uint32_t height;
+            std::vector<float> pixels;
+        };
+
+        bool isColor(TextureUsage usage)
+        {
+            return usage == TEXTURE_ALBEDO || usage == TEXTURE_GLOW;
+        }
+
+        float srgbToLinear(float value)
+        {
+            return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linearToSrgb(float value)
+        {
+            return value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.f / 2.4f) - 0.055f;
+        }
+
+        FloatImage toFilterSpace(Image const & image, TextureUsage usage)
+        {
+            float table[256];
+            for (int i = 0; i < 256; i++)
+            {
+                float value = i / 255.f;
+                table[i] = isColor(usage) ? srgbToLinear(value) : usage == TEXTURE_NORMAL ? value * 2.f - 1.f : value;
+            }
+
+            FloatImage result = { image.width, image.height, std::vector<float>(image.pixels.size()) };
+            for (size_t i = 0; i < image.pixels.size(); i += 4)
+            {
+                float alpha = image.pixels[i + 3] / 255.f;
+                for (int c = 0; c < 3; c++)
+                    result.pixels[i + c] = table[image.pixels[i + c]] * (usage == TEXTURE_NORMAL ? 1.f : alpha);
+                result.pixels[i + 3] = alpha;
+            }
+
+            return result;
+        }
+
+        uint8_t toByte(float value)
+        {
+            value = value * 255.f + 0.5f;
+            return (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+        }
+
+        // the premultiplied colors of the visible pixels around, returns the alpha they add up to
+        float bleedNeighbours(FloatImage const & image, size_t pixel, float rgb[3])
+        {
+            uint32_t x = (uint32_t)(pixel % image.width), y = (uint32_t)(pixel / image.width);
+            float alpha = 0;
+
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int nx = (int)x + dx, ny = (int)y + dy;
+                    if (nx < 0 || ny < 0 || nx >= (int)image.width || ny >= (int)image.height)
+                        continue;
+
+                    const float * neighbour = &image.pixels[((size_t)ny * image.width + nx) * 4];
+                    if (toByte(neighbour[3]) == 0)
+                        continue;
+
+                    for (int c = 0; c < 3; c++)
+                        rgb[c] += neighbour[c];
+                    alpha += neighbour[3];
+                }
+            }
+
+            return alpha;
+        }
+
+        Image fromFilterSpace(FloatImage const & image, TextureUsage usage)
+        {
+            Image result;
+            result.width = image.width;
+            result.height = image.height;
+            result.pixels.resize(image.pixels.size());
+
+            for (size_t i = 0; i < image.pixels.size(); i += 4)
+            {
+                const float * pixel = &image.pixels[i];
+                float alpha = pixel[3];
+                float rgb[3] = { pixel[0], pixel[1], pixel[2] };
+
+                // Invisible, but bilinear filtering still blends it into the edge. The color of the
+                // visible neighbours instead of black, or the edges of the leaves get dark
+                float coverage = alpha;
+                if (usage != TEXTURE_NORMAL && toByte(alpha) == 0)
+                    coverage = bleedNeighbours(image, i / 4, rgb);
+
+                if (usage == TEXTURE_NORMAL)
+                {
+                    float length = sqrtf(rgb[0] * rgb[0] + rgb[1] * rgb[1] + rgb[2] * rgb[2]);
+                    for (int c = 0; c < 3; c++)
+                        rgb[c] = length > 1e-6f ? rgb[c] / length * 0.5f + 0.5f : c == 2 ? 1.f : 0.5f;
+                }
+                else
+                {
+                    for (int c = 0; c < 3; c++)
+                    {
+                        rgb[c] = coverage > 0 ? rgb[c] / coverage : 0;
+                        if (isColor(usage))
+                            rgb[c] = linearToSrgb(rgb[c] < 0 ? 0 : rgb[c] > 1 ? 1 : rgb[c]);
+                    }
+                }
+
+                for (int c = 0; c < 3; c++)
+                    result.pixels[i + c] = toByte(rgb[c]);
+                result.pixels[i + 3] = toByte(alpha);
+            }
+
+            return result;
+        }
+
+        // Weights of the source pixels covered by each destination pixel, box filter on the
+        // exact areas. Works both ways, going up is close to nearest
+        void areaWeights(uint32_t source, uint32_t destination, std::vector<std::vector<std::pair<uint32_t, float>>> & weights)
+        {
+            weights.assign(destination, {});
+            double scale = (double)source / destination;
+
+            for (uint32_t i = 0; i < destination; i++)
+            {
+                double start = i * scale, end = (i + 1) * scale;
+                double total = 0;
+
+                for (uint32_t s = (uint32_t)start; s < source && s < end; s++)
+                {
+                    double covered = std::min(end, (double)s + 1) - std::max(start, (double)s);
+                    if (covered <= 0)
+                        continue;
+                    weights[i].push_back({ s, (float)covered });
+                    total += covered;
+                }
+
+                for (auto & weight : weights[i])
+                    weight.second = (float)(weight.second / total);
+            }
+        }
+
+        FloatImage resize(FloatImage const & image, uint32_t width, uint32_t height)
+        {
+            std::vector<std::vector<std::pair<uint32_t, float>>> horizontal, vertical;
+            areaWeights(image.width, width, horizontal);
+            areaWeights(image.height, height, vertical);
+
+            FloatImage wide = { width, image.height, std::vector<float>((size_t)width * image.height * 4, 0.f) };
+            for (uint32_t y = 0; y < image.height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float * out = &wide.pixels[((size_t)y * width + x) * 4];
+                    for (auto const & weight : horizontal[x])
+                    {
+                        const float * in = &image.pixels[((size_t)y * image.width + weight.first) * 4];
+                        for (int c = 0; c < 4; c++)
+                            out[c] += in[c] * weight.second;
+                    }
+                }
+            }
+
+            FloatImage result = { width, height, std::vector<float>((size_t)width * height * 4, 0.f) };
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (auto const & weight : vertical[y])
+                {
+                    const float * in = &wide.pixels[(size_t)weight.first * width * 4];
+                    float * out = &result.pixels[(size_t)y * width * 4];
+                    for (size_t i = 0; i < (size_t)width * 4; i++)
+                        out[i] += in[i] * weight.second;
+                }
+            }
+
+            return result;
+        }
+
+        // the 4x4 block at x, y with the edge pixels repeated past the image
+        void readBlock(Image const & image, uint32_t x, uint32_t y, uint8_t rgba[64])
+        {
+            for (uint32_t by = 0; by < 4; by++)
+            {
+                for (uint32_t bx = 0; bx < 4; bx++)
+                {
+                    uint32_t px = std::min(x + bx, image.width - 1);
+                    uint32_t py = std::min(y + by, image.height - 1);
+                    memcpy(&rgba[(by * 4 + bx) * 4], &image.pixels[((size_t)py * image.width + px) * 4], 4);
+                }
+            }
+        }
+
+        void compressMip(Image const & image, DDSFile & output, uint32_t mip)
+        {
+            DDSFile::Mip const & info = output.getMip(mip);
+            uint8_t * data = (uint8_t *)output.getData(mip);
+            uint32_t blockSize = DDSFile::getBytesPerElement(output.getFormat());
+
+            for (uint32_t row = 0; row < info.rows; row++)
+            {
+                for (uint32_t column = 0; column < info.rowPitch / blockSize; column++)
+                {
+                    uint8_t rgba[64];
+                    readBlock(image, column * 4, row * 4, rgba);
+                    BlockCompression::encode(output.getFormat(), rgba, data + (size_t)row * info.rowPitch + column * blockSize);
+                }
+            }
+        }
+    }
+
+    const char * TextureCooker::getUsageName(TextureUsage usage)
+    {
+        return usage >= 0 && usage < NR_OF_TEXTURE_USAGES ? USAGE_NAMES[usage] : "unknown";
+    }
+
+    bool TextureCooker::parseUsage(std::string const & name, TextureUsage & usage)
+    {
+        for (int i = 0; i < NR_OF_TEXTURE_USAGES; i++)
+        {
+            if (name == USAGE_NAMES[i])
+            {
+                usage = (TextureUsage)i;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    TextureUsage TextureCooker::guessUsage(std::string const & fileName)
+    {
+        std::string name = fileName;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        if (name.find("normal") != std::string::npos)
+            return TEXTURE_NORMAL;
+        if (name.find("glow") != std::string::npos || name.find("emissive") != std::string::npos)
+            return TEXTURE_GLOW;
+        if (name.find("spec") != std::string::npos)
+            return TEXTURE_SPECULAR;
+
+        return TEXTURE_ALBEDO;
+    }
+
+    DDSFormat TextureCooker::chooseFormat(TextureUsage usage, Image const & image)
+    {
+        switch (usage)
+        {
+        case TEXTURE_NORMAL:
+            return DDS_FORMAT_BC5;
+        case TEXTURE_GLOW:
+            return DDS_FORMAT_BC7;
+        case TEXTURE_SPECULAR:
+            return DDS_FORMAT_BC1;
+        default:
+            for (size_t i = 3; i < image.pixels.size(); i += 4)
+            {
+                if (image.pixels[i] != 255)
+                    return DDS_FORMAT_BC3;
+            }
+            return DDS_FORMAT_BC1;
+        }
+    }
+
+    bool TextureCooker::cook(Image const & image, TextureUsage usage, DDSFile & output, float & psnr)
+    {
+        if (image.width == 0 || image.height == 0 || image.pixels.size() != (size_t)image.width * image.height * 4)
+            return false;
+
+        uint32_t width = (image.width + 3) & ~3u;
+        uint32_t height = (image.height + 3) & ~3u;
+        output.create(width, height, chooseFormat(usage, image));
+
+        FloatImage level = toFilterSpace(image, usage);
+        if (width != image.width || height != image.height)
+            level = resize(level, width, height);
+
+        for (uint32_t mip = 0; mip < output.getMipCount(); mip++)
+        {
+            DDSFile::Mip const & info = output.getMip(mip);
+
+            // each mip from the one above, it is always half or the last pixel
+            if (mip > 0)
+                level = resize(level, info.width, info.height);
+
+            Image pixels = fromFilterSpace(level, usage);
+            compressMip(pixels, output, mip);
+
+            if (mip == 0)
+                psnr = measurePSNR(pixels, output, 0);
+        }
+
+        return true;
+    }
+
+    float TextureCooker::measurePSNR(Image const & reference, DDSFile const & compressed, uint32_t mip)
+    {
+        DDSFile::Mip const & info = compressed.getMip(mip);
+        DDSFormat format = compressed.getFormat();
+        uint32_t blockSize = DDSFile::getBytesPerElement(format);
+
+        int channels = format == DDS_FORMAT_BC5 ? 2 : format == DDS_FORMAT_BC4 ? 1 : format == DDS_FORMAT_BC1 ? 3 : 4;
+        double squaredError = 0;
+
+        for (uint32_t row = 0; row < info.rows; row++)
+        {
+            for (uint32_t column = 0; column < info.rowPitch / blockSize; column++)
+            {
+                uint8_t decoded[64];
+                const uint8_t * block = (const uint8_t *)compressed.getData(mip) + (size_t)row * info.rowPitch + column * blockSize;
+                BlockCompression::decode(format, block, decoded);
+
+                for (uint32_t y = 0; y < 4 && row * 4 + y < reference.height; y++)
+                {
+                    for (uint32_t x = 0; x < 4 && column * 4 + x < reference.width; x++)
+                    {
+                        const uint8_t * original = &reference.pixels[((size_t)(row * 4 + y) * reference.width + column * 4 + x) * 4];
+                        for (int c = 0; c < channels; c++)
+                        {
+                            double difference = (double)original[c] - decoded[(y * 4 + x) * 4 + c];
+                            squaredError += difference * difference;
+                        }
+                    }
+                }
+            }
+        }
+
+        double mean = squaredError / ((double)reference.width * reference.height * channels);
+        if (mean <= 0)
+            return PSNR_LOSSLESS;
+
+        return (float)std::min(10.0 * log10(255.0 * 255.0 / mean), (double)PSNR_LOSSLESS);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include "ImageDecoder.h"
+#include <Graphics/include/Resources/DDSFile.h>
+
+namespace Graphics
+{
+    // what the texture is for in a material, it decides how it is filtered and compressed
+    enum TextureUsage
+    {
+        TEXTURE_ALBEDO = 0,     // BC1, BC3 with alpha. Filtered in linear light
+        TEXTURE_NORMAL,         // BC5, x and y, the shader rebuilds z. Renormalized in every mip
+        TEXTURE_SPECULAR,       // BC1, data so filtered as it is
+        TEXTURE_GLOW,           // BC7, glow gets blurred and added so banding shows. Linear light
+        NR_OF_TEXTURE_USAGES
+    };
+
+    /*
+        An image to a block compressed DDS with every mip.
+
+        The top mip is stretched to a multiple of 4 first, D3D11 wants block
+        compressed textures to start out in whole blocks. The UVs are 0-1 so
+        the few pixels it adds don't move anything.
+
+        Color is premultiplied by alpha while the mips are filtered, so fully
+        transparent pixels don't bleed into the edges of the leaves.
+    */
+    class TextureCooker
+    {
+    public:
+        static const char * getUsageName(TextureUsage usage);
+        // false if the name isn't one of getUsageName
+        static bool parseUsage(std::string const & name, TextureUsage & usage);
+        // from the file name: normal, glow/emissive, spec, anything else is albedo
+        static TextureUsage guessUsage(std::string const & fileName);
+
+        static DDSFormat chooseFormat(TextureUsage usage, Image const & image);
+
+        // psnr is how close the compressed top mip is to the uncompressed one, in dB
+        static bool cook(Image const & image, TextureUsage usage, DDSFile & output, float & psnr);
+
+        // over the channels the format has, 99 when nothing was lost
+        static float measurePSNR(Image const & reference, DDSFile const & compressed, uint32_t mip);
+    };
+}
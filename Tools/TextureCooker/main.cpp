@@ -0,0 +1,188 @@
+// TextureCooker: the PNG and JPEG textures to block compressed DDS files
+// with mips, for TextureManager to load as they are.
+//
+// Only needs a C++17 compiler, built by the CMakeLists.txt in the repository
+// root, or by hand from there:
+//     g++ -std=c++17 -O2 -I. Tools/TextureCooker/*.cpp Graphics/include/Resources/DDSFile.cpp -o TextureCooker
+//
+// From the Engine folder, where the game runs:
+//     TextureCooker Resources/Textures Resources/Textures/Cooked [-all]
+//
+// Textures that haven't changed since the manifest in the output folder
+// was written are skipped, -all cooks everything again.
+#include "ImageDecoder.h"
+#include "TextureCooker.h"
+#include "CookManifest.h"
+#include <Graphics/include/Resources/DDSFile.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <vector>
+
+#define MANIFEST_NAME "manifest.txt"
+
+namespace fs = std::filesystem;
+using namespace Graphics;
+
+namespace
+{
+    bool readFile(fs::path const & path, std::vector<char> & bytes)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+
+        bytes.resize((size_t)file.tellg());
+        file.seekg(0);
+        return bytes.empty() || (bool)file.read(bytes.data(), bytes.size());
+    }
+
+    bool isSource(fs::path const & path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+    }
+
+    const char * getFormatName(DDSFormat format)
+    {
+        switch (format)
+        {
+        case DDS_FORMAT_BC1: return "BC1";
+        case DDS_FORMAT_BC3: return "BC3";
+        case DDS_FORMAT_BC4: return "BC4";
+        case DDS_FORMAT_BC5: return "BC5";
+        case DDS_FORMAT_BC7: return "BC7";
+        default: return "unknown";
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc < 3)
+    {
+        printf("Usage: TextureCooker <texture folder> <output folder> [-all]\n");
+        return 1;
+    }
+
+    fs::path sourceFolder = argv[1];
+    fs::path outputFolder = argv[2];
+    bool all = argc > 3 && strcmp(argv[3], "-all") == 0;
+
+    std::error_code error;
+    fs::create_directories(outputFolder, error);
+
+    CookManifest manifest;
+    std::string manifestPath = (outputFolder / MANIFEST_NAME).string();
+    if (!manifest.load(manifestPath))
+    {
+        printf("%s is broken, everything is cooked again\n", manifestPath.c_str());
+        manifest = CookManifest();
+    }
+
+    // sorted so the output and the manifest are the same every run
+    std::vector<fs::path> sources;
+    for (auto const & entry : fs::directory_iterator(sourceFolder, error))
+    {
+        if (entry.is_regular_file() && isSource(entry.path()))
+            sources.push_back(entry.path());
+    }
+    std::sort(sources.begin(), sources.end());
+
+    std::map<std::string, std::string> outputs;     // output name, the source that made it
+    std::set<std::string> present;
+    int cooked = 0, skipped = 0, failed = 0;
+
+    for (fs::path const & source : sources)
+    {
+        std::string name = source.filename().string();
+        std::string outputName = source.stem().string() + ".dds";
+        fs::path outputPath = outputFolder / outputName;
+        present.insert(name);
+
+        if (outputs.count(outputName))
+        {
+            printf("%-28s FAILED, %s is already cooked to %s\n", name.c_str(), outputs[outputName].c_str(), outputName.c_str());
+            failed++;
+            continue;
+        }
+        outputs[outputName] = name;
+
+        std::vector<char> bytes;
+        if (!readFile(source, bytes))
+        {
+            printf("%-28s FAILED, can't be read\n", name.c_str());
+            failed++;
+            continue;
+        }
+
+        CookManifest::Entry * previous = manifest.find(name);
+        TextureUsage usage = previous ? previous->usage : TextureCooker::guessUsage(name);
+        uint64_t hash = CookManifest::computeHash(bytes.data(), bytes.size(), usage);
+
+        if (!all && previous && previous->hash == hash && fs::exists(outputPath))
+        {
+            skipped++;
+            continue;
+        }
+
+        Image image;
+        std::string decodeError;
+        if (!ImageDecoder::decode(bytes.data(), bytes.size(), image, decodeError))
+        {
+            printf("%-28s FAILED, %s\n", name.c_str(), decodeError.c_str());
+            failed++;
+            continue;
+        }
+
+        DDSFile texture;
+        float psnr = 0;
+        std::vector<char> ddsBytes;
+        if (!TextureCooker::cook(image, usage, texture, psnr))
+        {
+            printf("%-28s FAILED to cook\n", name.c_str());
+            failed++;
+            continue;
+        }
+
+        texture.write(ddsBytes);
+        std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+        if (!output || !output.write(ddsBytes.data(), ddsBytes.size()))
+        {
+            printf("%-28s FAILED, can't write %s\n", name.c_str(), outputPath.string().c_str());
+            failed++;
+            continue;
+        }
+
+        size_t uncompressed = (size_t)image.width * image.height * 4;
+        printf("%-28s %-8s %s %4ux%-4u %2u mips  %6.2f dB  %7zu -> %7zu bytes\n", name.c_str(), TextureCooker::getUsageName(usage),
+            getFormatName(texture.getFormat()), texture.getWidth(), texture.getHeight(), texture.getMipCount(), psnr, uncompressed, ddsBytes.size());
+
+        manifest.set(name, { usage, hash, getFormatName(texture.getFormat()), psnr });
+        cooked++;
+    }
+
+    // sources that are gone, the cooked file is left for whoever removed it to clean up
+    std::vector<std::string> removed;
+    for (auto const & entry : manifest.getEntries())
+    {
+        if (!present.count(entry.first))
+            removed.push_back(entry.first);
+    }
+    for (std::string const & name : removed)
+        manifest.remove(name);
+
+    if (!manifest.save(manifestPath))
+    {
+        printf("Can't write %s\n", manifestPath.c_str());
+        return 1;
+    }
+
+    printf("%d cooked, %d up to date, %d failed\n", cooked, skipped, failed);
+    return failed > 0 ? 1 : 0;
+}